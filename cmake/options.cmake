@@ -3,4 +3,6 @@
 option(MIR_DOUBLE_PRECISION "use double precision everywhere; will also enable MEMBRANE_DOUBLE and ROD_DOUBLE" OFF)
 option(MIR_MEMBRANE_DOUBLE  "compute membrane forces in double precision" OFF)
 option(MIR_ROD_DOUBLE       "compute rod forces in double precision" OFF)
+option(MIR_PAIRWISE_DOUBLE_ACCUMULATION "sum the pairwise forces of each particle in double precision" OFF)
+option(MIR_PAIRWISE_KAHAN_ACCUMULATION  "sum the pairwise forces of each particle with compensated (Kahan) summation" OFF)
 option(MIR_USE_NVTX         "enable NVTX profiling" OFF)
@@ -107,7 +107,7 @@ class MembraneForces(Interaction):
     
     """
     def __init__():
-        r"""__init__(name: str, shear_desc: str, bending_desc: str, filter_desc: str='keep_all', stress_free: bool=False, **kwargs) -> None
+        r"""__init__(name: str, shear_desc: str, bending_desc: str, filter_desc: str='keep_all', stress_free: bool=False, assembly_desc: str='vertex', **kwargs) -> None
 
 
              Args:
@@ -116,6 +116,8 @@ class MembraneForces(Interaction):
                  bending_desc: a string describing what bending force is used
                  filter_desc: a string describing which membranes are concerned
                  stress_free: if True, stress Free shape is used for the shear parameters
+                 assembly_desc: a string describing how the forces are assembled: ``"vertex"`` (one thread per vertex)
+                     or ``"element"`` (one thread per triangle, dihedral or edge; the forces are reproducible from run to run)
 
              kwargs:
 
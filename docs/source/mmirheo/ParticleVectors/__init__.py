@@ -35,13 +35,15 @@ class Mesh:
         r"""__init__(*args, **kwargs)
 Overloaded function.
 
-1. __init__(off_filename: str) -> None
+1. __init__(off_filename: str, cache_folder: str = '') -> None
 
 
         Create a mesh by reading the OFF file
 
         Args:
             off_filename: path of the OFF file
+            cache_folder: if not empty, the mesh is stored in a binary cache file in this folder and read back from it
+                as long as the OFF file is unchanged (see :any:`MembraneMesh`)
     
 
 2. __init__(vertices: List[real3], faces: List[int3]) -> None
@@ -219,30 +221,39 @@ class MembraneMesh(Mesh):
         Internally used class for desctibing a triangular mesh that can be used with the Membrane Interactions.
         In contrast with the simple :any:`Mesh`, this class precomputes some required quantities on the mesh,
         including connectivity structures and stress-free quantities.
+
+        When created from OFF files with a cache folder, these quantities are stored in a binary cache file
+        (``<cache folder>/<off file name>.<path hash>.membrane.mcache``) on first load and read back on subsequent loads,
+        as long as the OFF files are unchanged. The name contains a hash of the absolute path of the OFF files,
+        so that files with the same name in different folders do not share a cache file.
+        If ``cache_folder`` is empty, the ``MIRHEO_MESH_CACHE_DIR`` environment variable is used instead; if neither is set, there is no cache.
+        Only the rank 0 of ``MPI_COMM_WORLD`` writes the cache files.
     
     """
     def __init__():
         r"""__init__(*args, **kwargs)
 Overloaded function.
 
-1. __init__(off_filename: str) -> None
+1. __init__(off_initial_mesh: str, off_stress_free_mesh: str, cache_folder: str = '') -> None
 
 
-            Create a mesh by reading the OFF file.
-            The stress free shape is the input initial mesh
+            Create a mesh by reading the OFF file, with a different stress free shape.
 
             Args:
-                off_filename: path of the OFF file
+                off_initial_mesh: path of the OFF file : initial mesh
+                off_stress_free_mesh: path of the OFF file : stress-free mesh)
+                cache_folder: folder of the binary cache files
         
 
-2. __init__(off_initial_mesh: str, off_stress_free_mesh: str) -> None
+2. __init__(off_filename: str, cache_folder: str = '') -> None
 
 
-            Create a mesh by reading the OFF file, with a different stress free shape.
+            Create a mesh by reading the OFF file.
+            The stress free shape is the input initial mesh
 
             Args:
-                off_initial_mesh: path of the OFF file : initial mesh
-                off_stress_free_mesh: path of the OFF file : stress-free mesh)
+                off_filename: path of the OFF file
+                cache_folder: folder of the binary cache files
         
 
 3. __init__(vertices: List[real3], faces: List[int3]) -> None
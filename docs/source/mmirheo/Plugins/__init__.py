@@ -251,7 +251,7 @@ def createDensityOutlet():
     pass
 
 def createDumpAverage():
-    r"""createDumpAverage(state: MirState, name: str, pvs: List[ParticleVectors.ParticleVector], sample_every: int, dump_every: int, bin_size: real3=real3(1.0, 1.0, 1.0), channels: List[str], path: str='xdmf/') -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
+    r"""createDumpAverage(state: MirState, name: str, pvs: List[ParticleVectors.ParticleVector], sample_every: int, dump_every: int, bin_size: real3=real3(1.0, 1.0, 1.0), channels: List[str], path: str='xdmf/', compression: Dict[str, str]={}) -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
 
 
         This plugin will project certain quantities of the particle vectors on the grid (by simple binning),
@@ -274,13 +274,20 @@ def createDumpAverage():
             bin_size: bin size for sampling. The resulting quantities will be *cell-centered*
             path: Path and filename prefix for the dumps. For every dump two files will be created: <path>_NNNNN.xmf and <path>_NNNNN.h5
             channels: list of channel names. See :ref:`user-pv-reserved`.
+            compression: storage of the HDF5 data sets, as a dictionary from channel name to a comma separated list of options:
+                ``"deflate=<1-9>"`` (lossless zlib compression), ``"shuffle"`` (byte shuffling, improves the compression of floating point data)
+                and ``"mantissa=<bits>"`` (lossy: round floating point data to that many mantissa bits).
+                Deflate and shuffle store the data sets in chunks and require HDF5 1.10.2 or newer.
+                Mantissa rounding alone keeps the data sets contiguous and does not reduce the file size; combine it with deflate.
+                The files remain readable by standard HDF5 tools.
+                Valid channel names are "number_densities" and the names in **channels**.
     
 
     """
     pass
 
 def createDumpAverageRelative():
-    r"""createDumpAverageRelative(state: MirState, name: str, pvs: List[ParticleVectors.ParticleVector], relative_to_ov: ParticleVectors.ObjectVector, relative_to_id: int, sample_every: int, dump_every: int, bin_size: real3=real3(1.0, 1.0, 1.0), channels: List[str], path: str='xdmf/') -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
+    r"""createDumpAverageRelative(state: MirState, name: str, pvs: List[ParticleVectors.ParticleVector], relative_to_ov: ParticleVectors.ObjectVector, relative_to_id: int, sample_every: int, dump_every: int, bin_size: real3=real3(1.0, 1.0, 1.0), channels: List[str], path: str='xdmf/', compression: Dict[str, str]={}) -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
 
 
         This plugin acts just like the regular flow dumper, with one difference.
@@ -306,6 +313,7 @@ def createDumpAverageRelative():
             channels: list of channel names. See :ref:`user-pv-reserved`.
             relative_to_ov: take an object governing the frame of reference from this :any:`ObjectVector`
             relative_to_id: take an object governing the frame of reference with the specific ID
+            compression: storage of the HDF5 data sets, see createDumpAverage()
     
 
     """
@@ -360,7 +368,7 @@ def createDumpObjectStats():
     pass
 
 def createDumpParticles():
-    r"""createDumpParticles(state: MirState, name: str, pv: ParticleVectors.ParticleVector, dump_every: int, channel_names: List[str], path: str) -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
+    r"""createDumpParticles(state: MirState, name: str, pv: ParticleVectors.ParticleVector, dump_every: int, channel_names: List[str], path: str, compression: Dict[str, str]={}) -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
 
 
         This plugin will dump positions, velocities and optional attached data of all the particles of the specified Particle Vector.
@@ -373,6 +381,14 @@ def createDumpParticles():
             dump_every: write files every this many time-steps
             channel_names: list of channel names to be dumped.
             path: Path and filename prefix for the dumps. For every dump two files will be created: <path>_NNNNN.xmf and <path>_NNNNN.h5
+            compression: storage of the HDF5 data sets, as a dictionary from channel name to a comma separated list of options:
+                ``"deflate=<1-9>"`` (lossless zlib compression), ``"shuffle"`` (byte shuffling, improves the compression of floating point data)
+                and ``"mantissa=<bits>"`` (lossy: round floating point data to that many mantissa bits).
+                Deflate and shuffle store the data sets in chunks and require HDF5 1.10.2 or newer.
+                Mantissa rounding alone keeps the data sets contiguous and does not reduce the file size; combine it with deflate.
+                The files remain readable by standard HDF5 tools.
+                Valid channel names are "position", "velocity", "id" and the names in **channel_names**.
+                Example: ``compression={"velocity": "mantissa=12,shuffle,deflate=4", "id": "shuffle,deflate=4"}``.
     
 
     """
@@ -548,18 +564,28 @@ def createImposeVelocity():
     pass
 
 def createMagneticDipoleInteractions():
-    r"""createMagneticDipoleInteractions(state: MirState, name: str, rov: ParticleVectors.RigidObjectVector, moment: real3, mu0: float, periodic: bool=True) -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
+    r"""createMagneticDipoleInteractions(state: MirState, name: str, rov: ParticleVectors.RigidObjectVector, moment: real3, mu0: float, periodic: bool=True, mode: str='direct', theta: float=0.5) -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
 
 
         This plugin computes the forces and torques resulting from pairwise dipole-dipole interactions between rigid objects.
         All rigid objects are assumed to be the same with a constant magnetic moment in their frame of reference.
 
+        Two summation methods are available:
+
+            * **direct**: every rank gathers all objects and sums all pairs, in O(N^2).
+            * **tree**: the objects of the neighbouring ranks are summed on the CPU with a Barnes-Hut tree, in O(N log N).
+              The other ranks only send clusters of their objects, represented by their total moment at their mean position.
+              A cluster of size s at distance d is used as a whole if s < theta * d.
+              theta = 0 gives the same result as the direct sum; the error of the forces decreases roughly linearly with theta.
+
         Args:
             name: name of the plugin
             rov: :class:`RigidObjectVector` with which the magnetic field will interact
             moment: magnetic moment per object
             mu0: magnetic permeability of the medium
             periodic: if True, compute the interactions from the closest periodic image of each object.
+            mode: summation method, either "direct" or "tree"
+            theta: opening angle of the tree, only used in "tree" mode
     
 
     """
@@ -583,7 +609,7 @@ def createMembraneExtraForce():
     pass
 
 def createMsd():
-    r"""createMsd(state: MirState, name: str, pv: ParticleVectors.ParticleVector, start_time: float, end_time: float, dump_every: int, path: str) -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
+    r"""createMsd(state: MirState, name: str, pv: ParticleVectors.ParticleVector, start_time: float, end_time: float, dump_every: int, path: str, num_levels: int = 0, block_length: int = 16) -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
 
 
         This plugin computes the mean square displacement of th particles of a given :any:`ParticleVector`.
@@ -596,6 +622,13 @@ def createMsd():
             end_time: End time until which to compute the MSD.
             dump_every: Report MSD every this many time-steps.
             path: The folder name in which the file will be dumped.
+            num_levels: If positive, use a multiple-tau correlator with this number of levels:
+                the displacements are sampled at every time-step and all time origins after start_time are used.
+                The values stored per particle (3 * block_length * num_levels numbers) are kept in persistent channels and migrate with it.
+                The lags are spaced logarithmically up to about block_length * 2^(num_levels-1) time-steps,
+                and the file is rewritten with the current estimate every dump_every time-steps.
+                If 0, start_time is the only time origin.
+            block_length: Number of lags per level of the multiple-tau correlator; must be even.
     
 
     """
@@ -787,7 +820,7 @@ def createRdf():
     pass
 
 def createRmacf():
-    r"""createRmacf(state: MirState, name: str, cv: ParticleVectors.ChainVector, start_time: float, end_time: float, dump_every: int, path: str) -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
+    r"""createRmacf(state: MirState, name: str, cv: ParticleVectors.ChainVector, start_time: float, end_time: float, dump_every: int, path: str, num_levels: int = 0, block_length: int = 16) -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
 
 
         This plugin computes the mean Rouse mode autocorrelation over time from a given :any:`ChainVector`.
@@ -800,6 +833,13 @@ def createRmacf():
             end_time: End time until which to compute the RMACF.
             dump_every: Report the RMACF every this many time-steps.
             path: The folder name in which the file will be dumped.
+            num_levels: If positive, use a multiple-tau correlator with this number of levels:
+                the Rouse modes are sampled at every time-step and all time origins after start_time are used.
+                The values stored per chain and mode (3 * block_length * num_levels numbers) are kept in persistent channels and migrate with it.
+                The lags are spaced logarithmically up to about block_length * 2^(num_levels-1) time-steps,
+                and the file is rewritten with the current estimate every dump_every time-steps.
+                If 0, start_time is the only time origin.
+            block_length: Number of lags per level of the multiple-tau correlator; must be even.
     
 
     """
@@ -879,7 +919,7 @@ def createTemperaturize():
     pass
 
 def createVacf():
-    r"""createVacf(state: MirState, name: str, pv: ParticleVectors.ParticleVector, start_time: float, end_time: float, dump_every: int, path: str) -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
+    r"""createVacf(state: MirState, name: str, pv: ParticleVectors.ParticleVector, start_time: float, end_time: float, dump_every: int, path: str, num_levels: int = 0, block_length: int = 16) -> Tuple[Plugins.SimulationPlugin, Plugins.PostprocessPlugin]
 
 
         This plugin computes the mean velocity autocorrelation over time from a given :any:`ParticleVector`.
@@ -892,6 +932,13 @@ def createVacf():
             end_time: End time until which to compute the VACF.
             dump_every: Report the VACF every this many time-steps.
             path: The folder name in which the file will be dumped.
+            num_levels: If positive, use a multiple-tau correlator with this number of levels:
+                the velocities are sampled at every time-step and all time origins after start_time are used.
+                The values stored per particle (3 * block_length * num_levels numbers) are kept in persistent channels and migrate with it.
+                The lags are spaced logarithmically up to about block_length * 2^(num_levels-1) time-steps,
+                and the file is rewritten with the current estimate every dump_every time-steps.
+                If 0, start_time is the only time origin.
+            block_length: Number of lags per level of the multiple-tau correlator; must be even.
     
 
     """
@@ -125,6 +125,98 @@ class DomainInfo:
         """
         pass
 
+class Ensemble:
+    r"""
+        Several independent replicas of a simulation, advanced together within the same job.
+        Each replica is a :any:`Mirheo` coordinator with its own objects and plugins.
+    
+    """
+    def __init__():
+        r"""__init__(nreplicas: int, nranks: int3, domain: real3, log_filename: str='log', debug_level: int=-1, checkpoint_every: int=0, checkpoint_folder: str='restart/', checkpoint_mode: str='PingPong', max_obj_half_length: float=0.0, cuda_aware_mpi: bool=False, no_splash: bool=False, comm_ptr: int=0, checkpoint_async: bool=False) -> None
+
+
+Create an ensemble of Mirheo coordinators.
+
+All replicas share the ranks, the domain decomposition and the log files.
+The checkpoint files of the replica ``i`` are stored in the sub-folder ``replica_XXX/`` of ``checkpoint_folder``, where ``XXX`` is ``i`` padded with zeros.
+
+Args:
+    nreplicas: number of replicas
+    nranks: number of MPI simulation tasks per axis: x,y,z, see :any:`Mirheo`
+    domain: size of the simulation domain in x,y,z, the same for all replicas
+    log_filename: prefix of the log files that will be created, see :any:`Mirheo`
+    debug_level: Debug level from 0 to 8, see :any:`Mirheo`
+    checkpoint_every: save state of the simulation components every this many time steps
+    checkpoint_folder: base folder of the checkpoint files of the replicas
+    checkpoint_mode: set to "PingPong" to keep only the last 2 checkpoint states; set to "Incremental" to keep all checkpoint states.
+    max_obj_half_length: Half of the maximum size of all objects.
+    cuda_aware_mpi: enable CUDA Aware MPI. The MPI library must support that feature, otherwise it may fail.
+    no_splash: don't display the splash screen when at the start-up.
+    comm_ptr: pointer to communicator. By default MPI_COMM_WORLD will be used
+    checkpoint_async: if True, the particle data of the checkpoints is written by the postprocess ranks, see :any:`Mirheo`
+        
+
+        """
+        pass
+
+    def get_num_replicas():
+        r"""get_num_replicas(self: Ensemble) -> int
+
+
+             Returns:
+                 the number of replicas
+        
+
+        """
+        pass
+
+    def get_replica():
+        r"""get_replica(self: Ensemble, i: int) -> Mirheo
+
+
+             Get the coordinator of a replica.
+             The objects created afterwards (particle vectors, interactions, plugins...) belong to this replica,
+             until another replica is selected.
+
+             Args:
+                 i: index of the replica
+
+             Returns:
+                 the :any:`Mirheo` coordinator of the replica
+        
+
+        """
+        pass
+
+    def get_replica_folder():
+        r"""get_replica_folder(i: int) -> str
+
+
+             Args:
+                 i: index of the replica
+
+             Returns:
+                 the sub-folder ``replica_XXX/`` holding the files of the replica ``i``, to prefix the outputs of its plugins
+        
+
+        """
+        pass
+
+    def run():
+        r"""run(self: Ensemble, niters: int, dt: float) -> None
+
+
+             Advance all replicas by the same amount of time steps.
+             The replicas are advanced in lockstep; their tasks are executed concurrently when each replica runs on a single rank.
+
+             Args:
+                 niters: number of time steps to advance
+                 dt: time step duration
+        
+
+        """
+        pass
+
 class MirState:
     r"""
         state of the simulation shared by all simulation objects.
@@ -169,7 +261,7 @@ class Mirheo:
     
     """
     def __init__():
-        r"""__init__(nranks: int3, domain: real3, log_filename: str='log', debug_level: int=-1, checkpoint_every: int=0, checkpoint_folder: str='restart/', checkpoint_mode: str='PingPong', max_obj_half_length: float=0.0, cuda_aware_mpi: bool=False, no_splash: bool=False, comm_ptr: int=0) -> None
+        r"""__init__(nranks: int3, domain: real3, log_filename: str='log', debug_level: int=-1, checkpoint_every: int=0, checkpoint_folder: str='restart/', checkpoint_mode: str='PingPong', max_obj_half_length: float=0.0, cuda_aware_mpi: bool=False, no_splash: bool=False, comm_ptr: int=0, checkpoint_async: bool=False) -> None
 
 
 Create the Mirheo coordinator.
@@ -193,6 +285,10 @@ Create the Mirheo coordinator.
     The default debug level may be modified by setting the ``MIRHEO_DEBUG_LEVEL`` environment variable to the desired value.
     This variable may be useful when Mirheo is linked as part of other codes, in which case the ``debug_level`` variable affects only parts of the execution.
 
+    On large runs, the particle, mesh and checkpoint dumps may be written by a subset of the ranks:
+    setting the ``MIRHEO_IO_RANKS_PER_WRITER`` environment variable to ``N`` gathers the data of every ``N`` consecutive ranks to one writer rank,
+    and setting it to ``node`` uses one writer rank per node.
+
 
 Args:
     nranks: number of MPI simulation tasks per axis: x,y,z. If postprocess is enabled, the same number of the postprocess tasks will be running
@@ -214,6 +310,8 @@ Args:
     cuda_aware_mpi: enable CUDA Aware MPI. The MPI library must support that feature, otherwise it may fail.
     no_splash: don't display the splash screen when at the start-up.
     comm_ptr: pointer to communicator. By default MPI_COMM_WORLD will be used
+    checkpoint_async: if True, the particle data of the checkpoints is copied to the host and sent to the postprocess ranks, which write the files while the simulation goes on.
+        The files are the same as with synchronous checkpoints. Requires postprocess ranks; ignored otherwise.
         
 
         """
@@ -324,14 +422,14 @@ Returns ``True`` if the current rank is the root
         pass
 
     def makeFrozenRigidParticles():
-        r"""makeFrozenRigidParticles(checker: mirheo::ObjectBelongingChecker, shape: mirheo::ObjectVector, icShape: mirheo::InitialConditions, interactions: List[mirheo::Interaction], integrator: mirheo::Integrator, number_density: float, mass: float=1.0, dt: float, nsteps: int=1000) -> mirheo::ParticleVector
+        r"""makeFrozenRigidParticles(checker: mirheo::ObjectBelongingChecker, shape: mirheo::ObjectVector, icShape: mirheo::InitialConditions, interactions: List[mirheo::Interaction], integrator: mirheo::Integrator, number_density: float, mass: float=1.0, dt: float, nsteps: int=1000, cache_folder: str='', refresh_cache: bool=False) -> mirheo::ParticleVector
 
 
                 Create particles frozen inside object.
 
                 .. note::
                     A separate simulation will be run for every call to this function, which may take certain amount of time.
-                    If you want to save time, consider using restarting mechanism instead
+                    If you want to save time, consider using restarting mechanism instead, or set ``cache_folder``
 
                 Args:
                     checker: object belonging checker
@@ -343,6 +441,10 @@ Returns ``True`` if the current rank is the root
                     mass: the mass of a single frozen particle
                     dt: time step
                     nsteps: run this many steps to achieve equilibrium
+                    cache_folder: if not empty, the equilibrated particles are stored in this folder and reused by
+                        subsequent calls with the same domain, interactions, integrator and parameters.
+                        Only the equilibration is cached; the particles are selected again from the walls or the shape at every call.
+                    refresh_cache: if ``True``, run the equilibration even if it is cached and overwrite the cache entry
 
                 Returns:
                     New :any:`ParticleVector` that will contain particles that are close to the wall boundary, but still inside the wall.
@@ -353,14 +455,14 @@ Returns ``True`` if the current rank is the root
         pass
 
     def makeFrozenWallParticles():
-        r"""makeFrozenWallParticles(pvName: str, walls: List[mirheo::Wall], interactions: List[mirheo::Interaction], integrator: mirheo::Integrator, number_density: float, mass: float=1.0, dt: float, nsteps: int=1000) -> mirheo::ParticleVector
+        r"""makeFrozenWallParticles(pvName: str, walls: List[mirheo::Wall], interactions: List[mirheo::Interaction], integrator: mirheo::Integrator, number_density: float, mass: float=1.0, dt: float, nsteps: int=1000, cache_folder: str='', refresh_cache: bool=False) -> mirheo::ParticleVector
 
 
                 Create particles frozen inside the walls.
 
                 .. note::
                     A separate simulation will be run for every call to this function, which may take certain amount of time.
-                    If you want to save time, consider using restarting mechanism instead
+                    If you want to save time, consider using restarting mechanism instead, or set ``cache_folder``
 
                 Args:
                     pvName: name of the created particle vector
@@ -371,6 +473,10 @@ Returns ``True`` if the current rank is the root
                     mass: the mass of a single frozen particle
                     dt: time step
                     nsteps: run this many steps to achieve equilibrium
+                    cache_folder: if not empty, the equilibrated particles are stored in this folder and reused by
+                        subsequent calls with the same domain, interactions, integrator and parameters.
+                        Only the equilibration is cached; the particles are selected again from the walls or the shape at every call.
+                    refresh_cache: if ``True``, run the equilibration even if it is cached and overwrite the cache entry
 
                 Returns:
                     New :any:`ParticleVector` that will contain particles that are close to the wall boundary, but still inside the wall.
@@ -581,6 +687,75 @@ Register Plugins
         """
         pass
 
+    def set_cell_ordering():
+        r"""set_cell_ordering(ordering: str) -> None
+
+
+             Choose the order in which the cells of the cell-lists are stored.
+             The particles of the :any:`ParticleVector` that are reordered by their cell-lists follow the same order,
+             which affects the memory locality of the interactions, packers and plugins.
+             The cells of a row along x are always contiguous; the rows are ordered as follows:
+
+             Args:
+                 ordering: one of
+
+                     * ``row_major``: by y, then by z (default)
+                     * ``morton``: along a Morton (Z) curve in tiles of 8 x 8 rows of the (y, z) plane
+                     * ``hilbert``: along a Hilbert curve in tiles of 8 x 8 rows of the (y, z) plane
+
+             .. note::
+                 This must be called before :py:meth:`mmirheo.Mirheo.run`.
+        
+
+        """
+        pass
+
+    def set_deterministic_forces():
+        r"""set_deterministic_forces(deterministic: bool=True) -> None
+
+
+             Accumulate the forces in a fixed order, so that two runs with the same seeds and the same domain decomposition
+             give bit-identical trajectories.
+             The pairwise interactions are then evaluated twice per pair, without atomic operations,
+             the membrane forces use the element assembly and the local and halo interactions are serialized;
+             expect a slower time step.
+
+             Args:
+                 deterministic: enable or disable the deterministic mode
+
+             .. note::
+                 This must be called before :py:meth:`mmirheo.Mirheo.run`.
+        
+
+        """
+        pass
+
+    def set_incremental_cell_lists():
+        r"""set_incremental_cell_lists(incremental: bool=True, max_migrated_fraction: float=0.1) -> None
+
+
+             Only move the particles that changed cell since the last build of the cell-lists, instead of sorting all
+             particles at every time step.
+             The particles that stay in their cell keep their relative order; the ones that arrived in a cell are placed
+             after them. When no particle changed cell, the particles are not reordered at all.
+             The cell-lists are rebuilt from scratch when the number of particles changed or when too many particles changed cell.
+             The number of particles that changed cell is reported in the debug log.
+
+             Args:
+                 incremental: enable or disable the incremental builds
+                 max_migrated_fraction: fraction of the particles that changed cell above which the cell-lists are rebuilt from scratch
+
+             .. note::
+                 In deterministic mode (see :py:meth:`set_deterministic_forces`), the particles are still not reordered when
+                 no particle changed cell, but any other build is done from scratch.
+
+             .. note::
+                 This must be called before :py:meth:`mmirheo.Mirheo.run`.
+        
+
+        """
+        pass
+
     def start_profiler():
         r"""start_profiler(self: Mirheo) -> None
 
@@ -139,6 +139,30 @@ def decorate_coordinator(f):
     return wrapper
 
 
+def decorate_ensemble(f):
+    """Wrap the creation of an ensemble; the replicas are the coordinators."""
+    @functools.wraps(f)
+    def wrapper(self, *args, **kwargs):
+        f(self, *args, **kwargs)
+
+        if __coordinator is not None and  __coordinator() is not None:
+           raise Exception('There can only be one coordinator at a time!')
+
+    return wrapper
+
+
+def decorate_ensemble_replica(f):
+    """Make the selected replica the coordinator of the objects created afterwards."""
+    @functools.wraps(f)
+    def wrapper(self, i):
+        global __coordinator
+        replica = f(self, i)
+        __coordinator = weakref.ref(replica)
+        return replica
+
+    return wrapper
+
+
 def decorate_func_with_plugin_arg(f):
     """Decorate a function that takes a plugin as an argument.
 
@@ -245,5 +269,9 @@ def __init__():
     Mirheo.registerPlugins = decorate_func_with_plugin_arg(Mirheo.registerPlugins)
     Mirheo.deregisterPlugins = decorate_func_with_plugin_arg(Mirheo.deregisterPlugins)
 
+    unit_conversion_decorator(Ensemble)
+    Ensemble.__init__ = decorate_ensemble(Ensemble.__init__)
+    Ensemble.get_replica = decorate_ensemble_replica(Ensemble.get_replica)
+
 
 __init__()
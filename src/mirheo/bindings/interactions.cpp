@@ -46,12 +46,12 @@ castToMap(const py::kwargs& kwargs, const std::string& intName)
 static std::shared_ptr<BaseMembraneInteraction>
 createInteractionMembrane(const MirState *state, std::string name,
                           std::string shearDesc, std::string bendingDesc, std::string filterDesc,
-                          bool stressFree, py::kwargs kwargs)
+                          bool stressFree, std::string assemblyDesc, py::kwargs kwargs)
 {
     auto parameters = castToMap(kwargs, name);
 
     return interaction_factory::createInteractionMembrane
-        (state, name, shearDesc, bendingDesc, filterDesc, parameters, stressFree);
+        (state, name, shearDesc, bendingDesc, filterDesc, parameters, stressFree, assemblyDesc);
 }
 
 static std::shared_ptr<BaseRodInteraction>
@@ -443,13 +443,15 @@ void exportInteractions(py::module& m)
     pyMembraneForces.def(py::init(&createInteractionMembrane),
                          "state"_a, "name"_a,
                          "shear_desc"_a, "bending_desc"_a, "filter_desc"_a = "keep_all",
-                         "stress_free"_a=false, R"(
+                         "stress_free"_a=false, "assembly_desc"_a="vertex", R"(
              Args:
                  name: name of the interaction
                  shear_desc: a string describing what shear force is used
                  bending_desc: a string describing what bending force is used
                  filter_desc: a string describing which membranes are concerned
                  stress_free: if True, stress Free shape is used for the shear parameters
+                 assembly_desc: a string describing how the forces are assembled: ``"vertex"`` (one thread per vertex)
+                     or ``"element"`` (one thread per triangle, dihedral or edge; the forces are reproducible from run to run)
 
              kwargs:
 
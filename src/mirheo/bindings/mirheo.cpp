@@ -3,6 +3,8 @@
 #include "class_wrapper.h"
 
 #include <mirheo/core/bouncers/interface.h>
+#include <mirheo/core/celllist.h>
+#include <mirheo/core/ensemble.h>
 #include <mirheo/core/initial_conditions/interface.h>
 #include <mirheo/core/integrators/interface.h>
 #include <mirheo/core/interactions/interface.h>
@@ -100,12 +102,12 @@ void exportMirheo(py::module& m)
         .def(py::init( [] (int3 nranks, real3 domain,
                            std::string log, int debuglvl,
                            int checkpointEvery, std::string checkpointFolder, std::string checkpointModeStr,
-                           real maxObjHalfLength, bool cudaMPI, bool noSplash, long commPtr)
+                           real maxObjHalfLength, bool cudaMPI, bool noSplash, long commPtr, bool checkpointAsync)
             {
                 LogInfo logInfo(log, debuglvl, noSplash);
                 CheckpointInfo checkpointInfo(
                         checkpointEvery, checkpointFolder,
-                        getCheckpointMode(checkpointModeStr));
+                        getCheckpointMode(checkpointModeStr), checkpointAsync);
 
                 if (commPtr == 0)
                 {
@@ -123,7 +125,8 @@ void exportMirheo(py::module& m)
              py::return_value_policy::take_ownership,
              "nranks"_a, "domain"_a, "log_filename"_a="log", "debug_level"_a=-1,
              "checkpoint_every"_a=0, "checkpoint_folder"_a="restart/", "checkpoint_mode"_a="PingPong",
-             "max_obj_half_length"_a=0.0_r, "cuda_aware_mpi"_a=false, "no_splash"_a=false, "comm_ptr"_a=0, R"(
+             "max_obj_half_length"_a=0.0_r, "cuda_aware_mpi"_a=false, "no_splash"_a=false, "comm_ptr"_a=0,
+             "checkpoint_async"_a=false, R"(
 Create the Mirheo coordinator.
 
 .. warning::
@@ -145,6 +148,10 @@ Create the Mirheo coordinator.
     The default debug level may be modified by setting the ``MIRHEO_DEBUG_LEVEL`` environment variable to the desired value.
     This variable may be useful when Mirheo is linked as part of other codes, in which case the ``debug_level`` variable affects only parts of the execution.
 
+    On large runs, the particle, mesh and checkpoint dumps may be written by a subset of the ranks:
+    setting the ``MIRHEO_IO_RANKS_PER_WRITER`` environment variable to ``N`` gathers the data of every ``N`` consecutive ranks to one writer rank,
+    and setting it to ``node`` uses one writer rank per node.
+
 
 Args:
     nranks: number of MPI simulation tasks per axis: x,y,z. If postprocess is enabled, the same number of the postprocess tasks will be running
@@ -166,6 +173,8 @@ Args:
     cuda_aware_mpi: enable CUDA Aware MPI. The MPI library must support that feature, otherwise it may fail.
     no_splash: don't display the splash screen when at the start-up.
     comm_ptr: pointer to communicator. By default MPI_COMM_WORLD will be used
+    checkpoint_async: if True, the particle data of the checkpoints is copied to the host and sent to the postprocess ranks, which write the files while the simulation goes on.
+        The files are the same as with synchronous checkpoints. Requires postprocess ranks; ignored otherwise.
         )")
 
         .def("registerParticleVector", &Mirheo::registerParticleVector,
@@ -302,12 +311,13 @@ Args:
         )")
 
         .def("makeFrozenWallParticles", &Mirheo::makeFrozenWallParticles,
-             "pvName"_a, "walls"_a, "interactions"_a, "integrator"_a, "number_density"_a, "mass"_a=1.0_r, "dt"_a, "nsteps"_a=1000, R"(
+             "pvName"_a, "walls"_a, "interactions"_a, "integrator"_a, "number_density"_a, "mass"_a=1.0_r, "dt"_a, "nsteps"_a=1000,
+             "cache_folder"_a="", "refresh_cache"_a=false, R"(
                 Create particles frozen inside the walls.
 
                 .. note::
                     A separate simulation will be run for every call to this function, which may take certain amount of time.
-                    If you want to save time, consider using restarting mechanism instead
+                    If you want to save time, consider using restarting mechanism instead, or set ``cache_folder``
 
                 Args:
                     pvName: name of the created particle vector
@@ -318,6 +328,10 @@ Args:
                     mass: the mass of a single frozen particle
                     dt: time step
                     nsteps: run this many steps to achieve equilibrium
+                    cache_folder: if not empty, the equilibrated particles are stored in this folder and reused by
+                        subsequent calls with the same domain, interactions, integrator and parameters.
+                        Only the equilibration is cached; the particles are selected again from the walls or the shape at every call.
+                    refresh_cache: if ``True``, run the equilibration even if it is cached and overwrite the cache entry
 
                 Returns:
                     New :any:`ParticleVector` that will contain particles that are close to the wall boundary, but still inside the wall.
@@ -325,12 +339,13 @@ Args:
         )")
 
         .def("makeFrozenRigidParticles", &Mirheo::makeFrozenRigidParticles,
-             "checker"_a, "shape"_a, "icShape"_a, "interactions"_a, "integrator"_a, "number_density"_a, "mass"_a=1.0_r, "dt"_a, "nsteps"_a=1000, R"(
+             "checker"_a, "shape"_a, "icShape"_a, "interactions"_a, "integrator"_a, "number_density"_a, "mass"_a=1.0_r, "dt"_a, "nsteps"_a=1000,
+             "cache_folder"_a="", "refresh_cache"_a=false, R"(
                 Create particles frozen inside object.
 
                 .. note::
                     A separate simulation will be run for every call to this function, which may take certain amount of time.
-                    If you want to save time, consider using restarting mechanism instead
+                    If you want to save time, consider using restarting mechanism instead, or set ``cache_folder``
 
                 Args:
                     checker: object belonging checker
@@ -342,6 +357,10 @@ Args:
                     mass: the mass of a single frozen particle
                     dt: time step
                     nsteps: run this many steps to achieve equilibrium
+                    cache_folder: if not empty, the equilibrated particles are stored in this folder and reused by
+                        subsequent calls with the same domain, interactions, integrator and parameters.
+                        Only the equilibration is cached; the particles are selected again from the walls or the shape at every call.
+                    refresh_cache: if ``True``, run the equilibration even if it is cached and overwrite the cache entry
 
                 Returns:
                     New :any:`ParticleVector` that will contain particles that are close to the wall boundary, but still inside the wall.
@@ -377,6 +396,93 @@ Args:
              .. warning::
                  if current is set to True, this must be called **after** :py:meth:`mmirheo.Mirheo.run`.
          )")
+        .def("enable_task_profiling", &Mirheo::enableTaskProfiling,
+             "fname"_a, "stream_events"_a = false, R"(
+             Record the execution time of every task of the simulation time-step.
+             At the end of each :py:meth:`mmirheo.Mirheo.run`, the root rank writes the per-task min/mean/max timings
+             to ``fname.csv`` and ``fname.json``, together with the critical path of the task graph,
+             and a `GraphML <http://graphml.graphdrawing.org/>`_ file ``fname.graphml`` annotated with these timings.
+
+             Args:
+                 fname: the base name of the output files (without extension)
+                 stream_events: if True, also measure the durations of the tasks on their CUDA streams
+
+             .. note::
+                 This must be called before :py:meth:`mmirheo.Mirheo.run`.
+         )")
+        .def("set_exchange_engine", [](Mirheo *mir, const std::string& engine)
+             {
+                 mir->setExchangeEngine(stringToExchangeEngineType(engine));
+             }, "engine"_a, R"(
+             Choose the communication engine used for the halo exchanges and the redistributions between the ranks.
+
+             Args:
+                 engine: one of
+
+                     * ``default``: MPI with separate exchange of the sizes and the data (single node engine if there is only one rank)
+                     * ``mpi``: same as ``default``
+                     * ``mpi_persistent``: MPI with persistent receives, the sizes being sent together with the data in a single message.
+                       Reduces the latency per exchange when the messages are small.
+                     * ``mpi_neighbor_collective``: MPI neighbourhood collectives over a distributed graph topology;
+                       all messages of one exchange are aggregated in a single collective call.
+
+             .. note::
+                 This must be called before :py:meth:`mmirheo.Mirheo.run`.
+         )")
+        .def("set_deterministic_forces", &Mirheo::setDeterministicForces,
+             "deterministic"_a = true, R"(
+             Accumulate the forces in a fixed order, so that two runs with the same seeds and the same domain decomposition
+             give bit-identical trajectories.
+             The pairwise interactions are then evaluated twice per pair, without atomic operations,
+             the membrane forces use the element assembly and the local and halo interactions are serialized;
+             expect a slower time step.
+
+             Args:
+                 deterministic: enable or disable the deterministic mode
+
+             .. note::
+                 This must be called before :py:meth:`mmirheo.Mirheo.run`.
+         )")
+        .def("set_cell_ordering", [](Mirheo *mir, const std::string& ordering)
+             {
+                 mir->setCellOrdering(stringToCellOrdering(ordering));
+             },
+             "ordering"_a, R"(
+             Choose the order in which the cells of the cell-lists are stored.
+             The particles of the :any:`ParticleVector` that are reordered by their cell-lists follow the same order,
+             which affects the memory locality of the interactions, packers and plugins.
+             The cells of a row along x are always contiguous; the rows are ordered as follows:
+
+             Args:
+                 ordering: one of
+
+                     * ``row_major``: by y, then by z (default)
+                     * ``morton``: along a Morton (Z) curve in tiles of 8 x 8 rows of the (y, z) plane
+                     * ``hilbert``: along a Hilbert curve in tiles of 8 x 8 rows of the (y, z) plane
+
+             .. note::
+                 This must be called before :py:meth:`mmirheo.Mirheo.run`.
+         )")
+        .def("set_incremental_cell_lists", &Mirheo::setIncrementalCellLists,
+             "incremental"_a = true, "max_migrated_fraction"_a = 0.1, R"(
+             Only move the particles that changed cell since the last build of the cell-lists, instead of sorting all
+             particles at every time step.
+             The particles that stay in their cell keep their relative order; the ones that arrived in a cell are placed
+             after them. When no particle changed cell, the particles are not reordered at all.
+             The cell-lists are rebuilt from scratch when the number of particles changed or when too many particles changed cell.
+             The number of particles that changed cell is reported in the debug log.
+
+             Args:
+                 incremental: enable or disable the incremental builds
+                 max_migrated_fraction: fraction of the particles that changed cell above which the cell-lists are rebuilt from scratch
+
+             .. note::
+                 In deterministic mode (see :py:meth:`set_deterministic_forces`), the particles are still not reordered when
+                 no particle changed cell, but any other build is done from scratch.
+
+             .. note::
+                 This must be called before :py:meth:`mmirheo.Mirheo.run`.
+         )")
         .def("run", &Mirheo::run,
              "niters"_a, "dt"_a, R"(
              Advance the system for a given amount of time steps.
@@ -389,6 +495,91 @@ Args:
              R"(
              output compile times options in the log
         )");
+
+
+    py::handlers_class<Ensemble>(m, "Ensemble", R"(
+        Several independent replicas of a simulation, advanced together within the same job.
+        Each replica is a :any:`Mirheo` coordinator with its own objects and plugins.
+    )")
+        .def(py::init( [] (int nreplicas, int3 nranks, real3 domain,
+                           std::string log, int debuglvl,
+                           int checkpointEvery, std::string checkpointFolder, std::string checkpointModeStr,
+                           real maxObjHalfLength, bool cudaMPI, bool noSplash, long commPtr, bool checkpointAsync)
+            {
+                LogInfo logInfo(log, debuglvl, noSplash);
+                CheckpointInfo checkpointInfo(
+                        checkpointEvery, checkpointFolder,
+                        getCheckpointMode(checkpointModeStr), checkpointAsync);
+
+                if (commPtr == 0)
+                {
+                    return std::make_unique<Ensemble> (nreplicas, nranks, domain, logInfo,
+                                                       checkpointInfo, maxObjHalfLength, cudaMPI);
+                }
+                else
+                {
+                    MPI_Comm comm = *(MPI_Comm *)commPtr;
+                    return std::make_unique<Ensemble> (comm, nreplicas, nranks, domain, logInfo,
+                                                       checkpointInfo, maxObjHalfLength, cudaMPI);
+                }
+            } ),
+             py::return_value_policy::take_ownership,
+             "nreplicas"_a, "nranks"_a, "domain"_a, "log_filename"_a="log", "debug_level"_a=-1,
+             "checkpoint_every"_a=0, "checkpoint_folder"_a="restart/", "checkpoint_mode"_a="PingPong",
+             "max_obj_half_length"_a=0.0_r, "cuda_aware_mpi"_a=false, "no_splash"_a=false, "comm_ptr"_a=0,
+             "checkpoint_async"_a=false, R"(
+Create an ensemble of Mirheo coordinators.
+
+All replicas share the ranks, the domain decomposition and the log files.
+The checkpoint files of the replica ``i`` are stored in the sub-folder ``replica_XXX/`` of ``checkpoint_folder``, where ``XXX`` is ``i`` padded with zeros.
+
+Args:
+    nreplicas: number of replicas
+    nranks: number of MPI simulation tasks per axis: x,y,z, see :any:`Mirheo`
+    domain: size of the simulation domain in x,y,z, the same for all replicas
+    log_filename: prefix of the log files that will be created, see :any:`Mirheo`
+    debug_level: Debug level from 0 to 8, see :any:`Mirheo`
+    checkpoint_every: save state of the simulation components every this many time steps
+    checkpoint_folder: base folder of the checkpoint files of the replicas
+    checkpoint_mode: set to "PingPong" to keep only the last 2 checkpoint states; set to "Incremental" to keep all checkpoint states.
+    max_obj_half_length: Half of the maximum size of all objects.
+    cuda_aware_mpi: enable CUDA Aware MPI. The MPI library must support that feature, otherwise it may fail.
+    no_splash: don't display the splash screen when at the start-up.
+    comm_ptr: pointer to communicator. By default MPI_COMM_WORLD will be used
+    checkpoint_async: if True, the particle data of the checkpoints is written by the postprocess ranks, see :any:`Mirheo`
+        )")
+        .def("get_num_replicas", &Ensemble::getNumReplicas, R"(
+             Returns:
+                 the number of replicas
+        )")
+        .def("get_replica", &Ensemble::getReplica, "i"_a,
+             py::return_value_policy::reference_internal, R"(
+             Get the coordinator of a replica.
+             The objects created afterwards (particle vectors, interactions, plugins...) belong to this replica,
+             until another replica is selected.
+
+             Args:
+                 i: index of the replica
+
+             Returns:
+                 the :any:`Mirheo` coordinator of the replica
+        )")
+        .def_static("get_replica_folder", &Ensemble::getReplicaFolder, "i"_a, R"(
+             Args:
+                 i: index of the replica
+
+             Returns:
+                 the sub-folder ``replica_XXX/`` holding the files of the replica ``i``, to prefix the outputs of its plugins
+        )")
+        .def("run", &Ensemble::run,
+             "niters"_a, "dt"_a, R"(
+             Advance all replicas by the same amount of time steps.
+             The replicas are advanced in lockstep; their tasks are executed concurrently when each replica runs on a single rank.
+
+             Args:
+                 niters: number of time steps to advance
+                 dt: time step duration
+        )");
 }
 
 } // namespace mirheo
@@ -221,11 +221,13 @@ void exportParticleVectors(py::module& m)
         Internally used class for describing a simple triangular mesh
     )");
 
-    pymesh.def(py::init<const std::string&>(), "off_filename"_a, R"(
+    pymesh.def(py::init<const std::string&, const std::string&>(), "off_filename"_a, "cache_folder"_a="", R"(
         Create a mesh by reading the OFF file
 
         Args:
             off_filename: path of the OFF file
+            cache_folder: if not empty, the mesh is stored in a binary cache file in this folder and read back from it
+                as long as the OFF file is unchanged (see :any:`MembraneMesh`)
     )")
         .def(py::init<const std::vector<real3>&, const std::vector<int3>&>(),
              "vertices"_a, "faces"_a, R"(
@@ -247,21 +249,33 @@ void exportParticleVectors(py::module& m)
         Internally used class for desctibing a triangular mesh that can be used with the Membrane Interactions.
         In contrast with the simple :any:`Mesh`, this class precomputes some required quantities on the mesh,
         including connectivity structures and stress-free quantities.
-    )")
-        .def(py::init<const std::string&>(), "off_filename"_a, R"(
-            Create a mesh by reading the OFF file.
-            The stress free shape is the input initial mesh
 
-            Args:
-                off_filename: path of the OFF file
-        )")
-        .def(py::init<const std::string&, const std::string&>(),
-             "off_initial_mesh"_a, "off_stress_free_mesh"_a, R"(
+        When created from OFF files with a cache folder, these quantities are stored in a binary cache file
+        (``<cache folder>/<off file name>.<path hash>.membrane.mcache``) on first load and read back on subsequent loads,
+        as long as the OFF files are unchanged. The name contains a hash of the absolute path of the OFF files,
+        so that files with the same name in different folders do not share a cache file.
+        If ``cache_folder`` is empty, the ``MIRHEO_MESH_CACHE_DIR`` environment variable is used instead; if neither is set, there is no cache.
+        Only the rank 0 of ``MPI_COMM_WORLD`` writes the cache files.
+    )")
+        .def(py::init<const std::string&, const std::string&, const std::string&>(),
+             "off_initial_mesh"_a, "off_stress_free_mesh"_a, "cache_folder"_a="", R"(
             Create a mesh by reading the OFF file, with a different stress free shape.
 
             Args:
                 off_initial_mesh: path of the OFF file : initial mesh
                 off_stress_free_mesh: path of the OFF file : stress-free mesh)
+                cache_folder: folder of the binary cache files
+        )")
+        .def(py::init([](const std::string& offFilename, const std::string& cacheFolder)
+        {
+            return std::make_shared<MembraneMesh>(offFilename, offFilename, cacheFolder);
+        }), "off_filename"_a, "cache_folder"_a="", R"(
+            Create a mesh by reading the OFF file.
+            The stress free shape is the input initial mesh
+
+            Args:
+                off_filename: path of the OFF file
+                cache_folder: folder of the binary cache files
         )")
         .def(py::init<const std::vector<real3>&, const std::vector<int3>&>(),
              "vertices"_a, "faces"_a, R"(
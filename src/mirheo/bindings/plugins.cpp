@@ -235,7 +235,8 @@ void exportPlugins(py::module& m)
 
     m.def("__createDumpAverage", &plugin_factory::createDumpAveragePlugin,
           "compute_task"_a, "state"_a, "name"_a, "pvs"_a, "sample_every"_a, "dump_every"_a,
-          "bin_size"_a = real3{1.0, 1.0, 1.0}, "channels"_a, "path"_a = "xdmf/", R"(
+          "bin_size"_a = real3{1.0, 1.0, 1.0}, "channels"_a, "path"_a = "xdmf/",
+          "compression"_a = std::map<std::string, std::string>{}, R"(
         This plugin will project certain quantities of the particle vectors on the grid (by simple binning),
         perform time-averaging of the grid and dump it in `XDMF <http://www.xdmf.org/index.php/XDMF_Model_and_Format>`_ format
         with `HDF5 <https://www.hdfgroup.org/solutions/hdf5/>`_ backend.
@@ -256,6 +257,13 @@ void exportPlugins(py::module& m)
             bin_size: bin size for sampling. The resulting quantities will be *cell-centered*
             path: Path and filename prefix for the dumps. For every dump two files will be created: <path>_NNNNN.xmf and <path>_NNNNN.h5
             channels: list of channel names. See :ref:`user-pv-reserved`.
+            compression: storage of the HDF5 data sets, as a dictionary from channel name to a comma separated list of options:
+                ``"deflate=<1-9>"`` (lossless zlib compression), ``"shuffle"`` (byte shuffling, improves the compression of floating point data)
+                and ``"mantissa=<bits>"`` (lossy: round floating point data to that many mantissa bits).
+                Deflate and shuffle store the data sets in chunks and require HDF5 1.10.2 or newer.
+                Mantissa rounding alone keeps the data sets contiguous and does not reduce the file size; combine it with deflate.
+                The files remain readable by standard HDF5 tools.
+                Valid channel names are "number_densities" and the names in **channels**.
     )");
 
     m.def("__createDumpAverageRelative", &plugin_factory::createDumpAverageRelativePlugin,
@@ -263,6 +271,7 @@ void exportPlugins(py::module& m)
           "relative_to_ov"_a, "relative_to_id"_a,
           "sample_every"_a, "dump_every"_a,
           "bin_size"_a = real3{1.0, 1.0, 1.0}, "channels"_a, "path"_a = "xdmf/",
+          "compression"_a = std::map<std::string, std::string>{},
           R"(
         This plugin acts just like the regular flow dumper, with one difference.
         It will assume a coordinate system attached to the center of mass of a specific object.
@@ -287,6 +296,7 @@ void exportPlugins(py::module& m)
             channels: list of channel names. See :ref:`user-pv-reserved`.
             relative_to_ov: take an object governing the frame of reference from this :any:`ObjectVector`
             relative_to_id: take an object governing the frame of reference with the specific ID
+            compression: storage of the HDF5 data sets, see createDumpAverage()
     )");
 
     m.def("__createDumpMesh", &plugin_factory::createDumpMeshPlugin,
@@ -329,7 +339,7 @@ void exportPlugins(py::module& m)
 
     m.def("__createDumpParticles", &plugin_factory::createDumpParticlesPlugin,
           "compute_task"_a, "state"_a, "name"_a, "pv"_a, "dump_every"_a,
-          "channel_names"_a, "path"_a, R"(
+          "channel_names"_a, "path"_a, "compression"_a = std::map<std::string, std::string>{}, R"(
         This plugin will dump positions, velocities and optional attached data of all the particles of the specified Particle Vector.
         The data is dumped into hdf5 format. An additional xdfm file is dumped to describe the data and make it readable by visualization tools.
         If a channel from object data or bisegment data is provided, the data will be scattered to particles before being dumped as normal particle data.
@@ -340,6 +350,14 @@ void exportPlugins(py::module& m)
             dump_every: write files every this many time-steps
             channel_names: list of channel names to be dumped.
             path: Path and filename prefix for the dumps. For every dump two files will be created: <path>_NNNNN.xmf and <path>_NNNNN.h5
+            compression: storage of the HDF5 data sets, as a dictionary from channel name to a comma separated list of options:
+                ``"deflate=<1-9>"`` (lossless zlib compression), ``"shuffle"`` (byte shuffling, improves the compression of floating point data)
+                and ``"mantissa=<bits>"`` (lossy: round floating point data to that many mantissa bits).
+                Deflate and shuffle store the data sets in chunks and require HDF5 1.10.2 or newer.
+                Mantissa rounding alone keeps the data sets contiguous and does not reduce the file size; combine it with deflate.
+                The files remain readable by standard HDF5 tools.
+                Valid channel names are "position", "velocity", "id" and the names in **channel_names**.
+                Example: ``compression={"velocity": "mantissa=12,shuffle,deflate=4", "id": "shuffle,deflate=4"}``.
     )");
 
     m.def("__createDumpParticlesWithMesh", &plugin_factory::createDumpParticlesWithMeshPlugin,
@@ -469,16 +487,27 @@ void exportPlugins(py::module& m)
     )");
 
     m.def("__createMagneticDipoleInteractions", &plugin_factory::createMagneticDipoleInteractionsPlugin,
-          "compute_task"_a, "state"_a, "name"_a, "rov"_a, "moment"_a, "mu0"_a, "periodic"_a=true, R"(
+          "compute_task"_a, "state"_a, "name"_a, "rov"_a, "moment"_a, "mu0"_a, "periodic"_a=true,
+          "mode"_a="direct", "theta"_a=0.5_r, R"(
         This plugin computes the forces and torques resulting from pairwise dipole-dipole interactions between rigid objects.
         All rigid objects are assumed to be the same with a constant magnetic moment in their frame of reference.
 
+        Two summation methods are available:
+
+            * **direct**: every rank gathers all objects and sums all pairs, in O(N^2).
+            * **tree**: the objects of the neighbouring ranks are summed on the CPU with a Barnes-Hut tree, in O(N log N).
+              The other ranks only send clusters of their objects, represented by their total moment at their mean position.
+              A cluster of size s at distance d is used as a whole if s < theta * d.
+              theta = 0 gives the same result as the direct sum; the error of the forces decreases roughly linearly with theta.
+
         Args:
             name: name of the plugin
             rov: :class:`RigidObjectVector` with which the magnetic field will interact
             moment: magnetic moment per object
             mu0: magnetic permeability of the medium
             periodic: if True, compute the interactions from the closest periodic image of each object.
+            mode: summation method, either "direct" or "tree"
+            theta: opening angle of the tree, only used in "tree" mode
     )");
 
     m.def("__createMembraneExtraForce", &plugin_factory::createMembraneExtraForcePlugin,
@@ -494,7 +523,8 @@ void exportPlugins(py::module& m)
     )");
 
     m.def("__createMsd", &plugin_factory::createMsdPlugin,
-          "compute_task"_a, "state"_a, "name"_a, "pv"_a, "start_time"_a, "end_time"_a, "dump_every"_a, "path"_a, R"(
+          "compute_task"_a, "state"_a, "name"_a, "pv"_a, "start_time"_a, "end_time"_a, "dump_every"_a, "path"_a,
+          "num_levels"_a=0, "block_length"_a=16, R"(
         This plugin computes the mean square displacement of th particles of a given :any:`ParticleVector`.
         The reference position` is that of the given :any:`ParticleVector` at the given start time.
 
@@ -505,6 +535,13 @@ void exportPlugins(py::module& m)
             end_time: End time until which to compute the MSD.
             dump_every: Report MSD every this many time-steps.
             path: The folder name in which the file will be dumped.
+            num_levels: If positive, use a multiple-tau correlator with this number of levels:
+                the displacements are sampled at every time-step and all time origins after start_time are used.
+                The values stored per particle (3 * block_length * num_levels numbers) are kept in persistent channels and migrate with it.
+                The lags are spaced logarithmically up to about block_length * 2^(num_levels-1) time-steps,
+                and the file is rewritten with the current estimate every dump_every time-steps.
+                If 0, start_time is the only time origin.
+            block_length: Number of lags per level of the multiple-tau correlator; must be even.
     )");
 
     m.def("__createParticleChannelAverager", &plugin_factory::createParticleChannelAveragerPlugin,
@@ -627,7 +664,8 @@ void exportPlugins(py::module& m)
     )");
 
     m.def("__createRmacf", &plugin_factory::createRmacfPlugin,
-          "compute_task"_a, "state"_a, "name"_a, "cv"_a, "start_time"_a, "end_time"_a, "dump_every"_a, "path"_a, R"(
+          "compute_task"_a, "state"_a, "name"_a, "cv"_a, "start_time"_a, "end_time"_a, "dump_every"_a, "path"_a,
+          "num_levels"_a=0, "block_length"_a=16, R"(
         This plugin computes the mean Rouse mode autocorrelation over time from a given :any:`ChainVector`.
         The reference modes are that of the :any:`ChainVector` at the given start time.
 
@@ -638,6 +676,13 @@ void exportPlugins(py::module& m)
             end_time: End time until which to compute the RMACF.
             dump_every: Report the RMACF every this many time-steps.
             path: The folder name in which the file will be dumped.
+            num_levels: If positive, use a multiple-tau correlator with this number of levels:
+                the Rouse modes are sampled at every time-step and all time origins after start_time are used.
+                The values stored per chain and mode (3 * block_length * num_levels numbers) are kept in persistent channels and migrate with it.
+                The lags are spaced logarithmically up to about block_length * 2^(num_levels-1) time-steps,
+                and the file is rewritten with the current estimate every dump_every time-steps.
+                If 0, start_time is the only time origin.
+            block_length: Number of lags per level of the multiple-tau correlator; must be even.
     )");
 
     m.def("__createShearField", &plugin_factory::createShearFieldPlugin,
@@ -694,7 +739,8 @@ void exportPlugins(py::module& m)
     )");
 
     m.def("__createVacf", &plugin_factory::createVacfPlugin,
-          "compute_task"_a, "state"_a, "name"_a, "pv"_a, "start_time"_a, "end_time"_a, "dump_every"_a, "path"_a, R"(
+          "compute_task"_a, "state"_a, "name"_a, "pv"_a, "start_time"_a, "end_time"_a, "dump_every"_a, "path"_a,
+          "num_levels"_a=0, "block_length"_a=16, R"(
         This plugin computes the mean velocity autocorrelation over time from a given :any:`ParticleVector`.
         The reference velocity `v0` is that of the given :any:`ParticleVector` at the given start time.
 
@@ -705,6 +751,13 @@ void exportPlugins(py::module& m)
             end_time: End time until which to compute the VACF.
             dump_every: Report the VACF every this many time-steps.
             path: The folder name in which the file will be dumped.
+            num_levels: If positive, use a multiple-tau correlator with this number of levels:
+                the velocities are sampled at every time-step and all time origins after start_time are used.
+                The values stored per particle (3 * block_length * num_levels numbers) are kept in persistent channels and migrate with it.
+                The lags are spaced logarithmically up to about block_length * 2^(num_levels-1) time-steps,
+                and the file is rewritten with the current estimate every dump_every time-steps.
+                If 0, start_time is the only time origin.
+            block_length: Number of lags per level of the multiple-tau correlator; must be even.
     )");
 
     m.def("__createVelocityControl", &plugin_factory::createVelocityControlPlugin,
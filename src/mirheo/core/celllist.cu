@@ -66,6 +66,170 @@ __global__ void reorderPositionsAndCreateMap(PVview view, CellListInfo cinfo, re
     cinfo.order[pid] = dstId;
 }
 
+__global__ void fillSlotCells(CellListInfo cinfo, int *slotCells)
+{
+    const int cid = blockIdx.x * blockDim.x + threadIdx.x;
+    if (cid >= cinfo.totcells) return;
+
+    for (int i = cinfo.cellStarts[cid]; i < cinfo.cellStarts[cid+1]; ++i)
+        slotCells[i] = cid;
+}
+
+__global__ void detectMigrations(PVview view, CellListInfo cinfo, const int *slots, int numOldSlots, const int *slotCells,
+                                 int *newCells, int *leaving, int *numMigrated)
+{
+    const int pid = blockIdx.x * blockDim.x + threadIdx.x;
+    if (pid >= view.size) return;
+
+    const real4 pos = view.readPositionNoCache(pid);
+
+    //  XXX: relying here only on redistribution
+    const int newCell = outgoingParticle(pos) ? INVALID : cinfo.getCellId<CellListsProjection::Clamp>(pos);
+    const int oldSlot = cell_list_incremental::getOldSlot(slots, numOldSlots, pid);
+    const int oldCell = oldSlot == INVALID ? INVALID : slotCells[oldSlot];
+
+    newCells[pid] = newCell;
+
+    // arrivals always count, even if already leaving: they need an entry in the new order
+    if (newCell == oldCell && oldSlot != INVALID) return;
+
+    if (oldSlot != INVALID)
+        leaving[oldSlot] = 1;
+
+    atomicAggInc(numMigrated);
+}
+
+__global__ void updateCellSizes(int n, CellListInfo cinfo, const int *slots, int numOldSlots, const int *slotCells,
+                                const int *newCells)
+{
+    const int pid = blockIdx.x * blockDim.x + threadIdx.x;
+    if (pid >= n) return;
+
+    const int newCell = newCells[pid];
+    const int oldSlot = cell_list_incremental::getOldSlot(slots, numOldSlots, pid);
+    const int oldCell = oldSlot == INVALID ? INVALID : slotCells[oldSlot];
+
+    if (newCell == oldCell) return;
+
+    if (oldCell != INVALID) atomicSub(cinfo.cellSizes + oldCell, 1);
+    if (newCell != INVALID) atomicAdd(cinfo.cellSizes + newCell, 1);
+}
+
+__global__ void reorderPositionsIncrementally(PVview view, CellListInfo cinfo, const int *slots, int numOldSlots, const int *slotCells,
+                                              const int *newCells, const int *oldCellStarts, const int *leavingScan,
+                                              int *arrivals, real4 *outPositions)
+{
+    const int pid = blockIdx.x * blockDim.x + threadIdx.x;
+    if (pid >= view.size) return;
+
+    const int newCell = newCells[pid];
+    // slots may alias cinfo.order: read before it is overwritten
+    const int oldSlot = cell_list_incremental::getOldSlot(slots, numOldSlots, pid);
+    const int oldCell = oldSlot == INVALID ? INVALID : slotCells[oldSlot];
+
+    int dstId = INVALID;
+
+    if (newCell != INVALID)
+    {
+        if (newCell == oldCell)
+            dstId = cell_list_incremental::getStayingSlot(newCell, oldSlot, oldCellStarts, cinfo.cellStarts, leavingScan);
+        else
+            dstId = cell_list_incremental::getArrivingSlot(newCell, atomicAdd(arrivals + newCell, 1),
+                                                           oldCellStarts, cinfo.cellStarts, leavingScan);
+
+        writeNoCache(outPositions + dstId, view.readPositionNoCache(pid));
+    }
+
+    cinfo.order[pid] = dstId;
+}
+
+__global__ void invertOrder(int n, CellListInfo cinfo, int *sourceIds)
+{
+    const int pid = blockIdx.x * blockDim.x + threadIdx.x;
+    if (pid >= n) return;
+
+    const int dstId = cinfo.order[pid];
+    if (dstId != INVALID)
+        sourceIds[dstId] = pid;
+}
+
+/// Insertion sort of ids[start, end) with the comparison function less; cells contain only a few particles.
+template <typename Less>
+__device__ inline void insertionSort(int *ids, int start, int end, Less less)
+{
+    for (int i = start + 1; i < end; ++i)
+    {
+        const int id = ids[i];
+        int j = i - 1;
+        while (j >= start && less(id, ids[j]))
+        {
+            ids[j+1] = ids[j];
+            --j;
+        }
+        ids[j+1] = id;
+    }
+}
+
+__global__ void sortCellsByParticleId(PVview view, CellListInfo cinfo, int *sourceIds, real4 *outPositions)
+{
+    const int cid = blockIdx.x * blockDim.x + threadIdx.x;
+    if (cid >= cinfo.totcells) return;
+
+    const int start = cinfo.cellStarts[cid];
+    const int end   = cinfo.cellStarts[cid+1];
+
+    insertionSort(sourceIds, start, end, [&](int a, int b)
+    {
+        const auto ia = Real3_int(view.readPosition(a)).i;
+        const auto ib = Real3_int(view.readPosition(b)).i;
+        return ia < ib || (ia == ib && a < b);
+    });
+
+    for (int dstId = start; dstId < end; ++dstId)
+    {
+        const int srcId = sourceIds[dstId];
+        outPositions[dstId] = view.readPosition(srcId);
+        cinfo.order[srcId] = dstId;
+    }
+}
+
+__global__ void computeHaloCellSizes(PVview view, CellListInfo cinfo)
+{
+    const int pid = blockIdx.x * blockDim.x + threadIdx.x;
+    if (pid >= view.size) return;
+
+    const int cid = cinfo.getCellId<CellListsProjection::NoClamp>(view.readPositionNoCache(pid));
+    if (cid != INVALID)
+        atomicAdd(cinfo.cellSizes + cid, 1);
+}
+
+__global__ void placeHaloParticles(PVview view, CellListInfo cinfo, int *sortedIds)
+{
+    const int pid = blockIdx.x * blockDim.x + threadIdx.x;
+    if (pid >= view.size) return;
+
+    const int cid = cinfo.getCellId<CellListsProjection::NoClamp>(view.readPositionNoCache(pid));
+    if (cid != INVALID)
+        sortedIds[cinfo.cellStarts[cid] + atomicAdd(cinfo.cellSizes + cid, 1)] = pid;
+}
+
+__global__ void sortHaloCells(PVview view, CellListInfo cinfo, int *sortedIds)
+{
+    const int cid = blockIdx.x * blockDim.x + threadIdx.x;
+    if (cid >= cinfo.totcells) return;
+
+    // periodic images of the same particle have the same id but different positions
+    insertionSort(sortedIds, cinfo.cellStarts[cid], cinfo.cellStarts[cid+1], [&](int a, int b)
+    {
+        const Real3_int ra(view.readPosition(a));
+        const Real3_int rb(view.readPosition(b));
+        if (ra.i   != rb.i  ) return ra.i   < rb.i;
+        if (ra.v.x != rb.v.x) return ra.v.x < rb.v.x;
+        if (ra.v.y != rb.v.y) return ra.v.y < rb.v.y;
+        return ra.v.z < rb.v.z;
+    });
+}
+
 template <typename T>
 __global__ void reorderExtraDataPerParticle(int n, const T *inExtraData, CellListInfo cinfo, T *outExtraData)
 {
@@ -119,6 +283,16 @@ CellListInfo::CellListInfo(real3 h_, real3 localDomainSize_) :
     rc = std::min( {h.x, h.y, h.z} );
 }
 
+CellOrdering stringToCellOrdering(const std::string& name)
+{
+    if (name == "row_major") return CellOrdering::RowMajor;
+    if (name == "morton")    return CellOrdering::Morton;
+    if (name == "hilbert")   return CellOrdering::Hilbert;
+
+    die("Unknown cell ordering '%s'", name.c_str());
+    return CellOrdering::RowMajor;
+}
+
 //=================================================================================
 // Basic cell-lists
 //=================================================================================
@@ -142,10 +316,15 @@ CellList::CellList(ParticleVector *pv, int3 resolution, real3 localDomainSize_)
 void CellList::_initialize()
 {
     localPV_ = particlesDataContainer_.get();
+    ordering = pv_->getState()->cellOrdering;
 
     cellSizes. resize_anew(totcells + 1);
     cellStarts.resize_anew(totcells + 1);
 
+    oldCellStarts_.resize_anew(totcells + 1);
+    arrivals_.     resize_anew(totcells);
+    numMigrated_.  resize_anew(1);
+
     cellSizes. clear(defaultStream);
     cellStarts.clear(defaultStream);
     CUDA_Check( cudaStreamSynchronize(defaultStream) );
@@ -153,7 +332,13 @@ void CellList::_initialize()
     debug("Initialized %s cell-list with %dx%dx%d cells and cut-off %f", pv_->getCName(), ncells.x, ncells.y, ncells.z, rc);
 }
 
-CellList::~CellList() = default;
+CellList::~CellList()
+{
+    if (stats_.numChecks > 0)
+        info("%s: %ld builds (%ld full, %ld incremental, %ld without reordering), %.2f particles changed cell per check",
+             _makeName().c_str(), stats_.numBuilds, stats_.numFullBuilds, stats_.numIncrementalBuilds,
+             stats_.numSkippedReorders, static_cast<double>(stats_.numMigratedTotal) / stats_.numChecks);
+}
 
 bool CellList::_checkNeedBuild() const
 {
@@ -241,6 +426,25 @@ void CellList::_reorderPositionsAndCreateMap(cudaStream_t stream)
         view, cellInfo(), particlesDataContainer_->positions().devPtr() );
 }
 
+void CellList::_sortCellsByParticleId(cudaStream_t stream)
+{
+    debug2("%s : sorting the cells by particle id", _makeName().c_str());
+
+    PVview view(pv_, pv_->local());
+    sourceIds_.resize_anew(view.size);
+
+    const int nthreads = 128;
+    SAFE_KERNEL_LAUNCH(
+        cell_list_kernels::invertOrder,
+        getNblocks(view.size, nthreads), nthreads, 0, stream,
+        view.size, cellInfo(), sourceIds_.devPtr() );
+
+    SAFE_KERNEL_LAUNCH(
+        cell_list_kernels::sortCellsByParticleId,
+        getNblocks(totcells, nthreads), nthreads, 0, stream,
+        view, cellInfo(), sourceIds_.devPtr(), particlesDataContainer_->positions().devPtr() );
+}
+
 void CellList::_reorderExtraDataEntry(const std::string& channelName,
                                       const DataManager::ChannelDescription *channelDesc,
                                       cudaStream_t stream)
@@ -278,13 +482,161 @@ void CellList::_reorderPersistentData(cudaStream_t stream)
     }
 }
 
-void CellList::_build(cudaStream_t stream)
+CellList::BuildKind CellList::_detectMigrations(cudaStream_t stream)
 {
-    _computeCellSizes(stream);
+    const MirState *state = pv_->getState();
+    PVview view(pv_, pv_->local());
+
+    // the redistribution marks the leaving particles in place and appends the arriving ones,
+    // so the particles of the last build keep their index unless some were removed
+    if (!state->incrementalCellLists || builtSize_ < 0 || view.size < builtSize_)
+        return BuildKind::Full;
+
+    const int *slots = _isParticleVectorReordered() ? nullptr : order.devPtr();
+
+    newCells_.resize_anew(view.size);
+    leaving_ .resize_anew(builtSize_ + 1);
+    leaving_.clear(stream);
+    numMigrated_.clear(stream);
+
+    const int nthreads = 128;
+    SAFE_KERNEL_LAUNCH(
+        cell_list_kernels::detectMigrations,
+        getNblocks(view.size, nthreads), nthreads, 0, stream,
+        view, cellInfo(), slots, builtSize_, slotCells_.devPtr(),
+        newCells_.devPtr(), leaving_.devPtr(), numMigrated_.devPtr() );
+
+    numMigrated_.downloadFromDevice(stream);
+    const int numMigrated = numMigrated_[0];
+
+    ++stats_.numChecks;
+    stats_.numMigratedLast = numMigrated;
+    stats_.numMigratedTotal += numMigrated;
+
+    debug2("%s : %d out of %d particles changed cell (%d appended)",
+           _makeName().c_str(), numMigrated, view.size, view.size - builtSize_);
+
+    if (numMigrated == 0)
+        return BuildKind::NoReorder;
+
+    // arrivals are placed with atomics, which would break the order by particle id
+    if (state->deterministicForces || numMigrated > state->incrementalCellListsMaxMigration * view.size)
+        return BuildKind::Full;
+
+    return BuildKind::Incremental;
+}
+
+void CellList::_reorderPositionsIncrementally(cudaStream_t stream)
+{
+    debug2("Incrementally reordering %d %s particles", pv_->local()->size(), pv_->getCName());
+
+    PVview view(pv_, pv_->local());
+
+    // keep the slots of the last build, the appended particles have none
+    order.resize(view.size, stream);
+    const int *slots = _isParticleVectorReordered() ? nullptr : order.devPtr();
+    const int nslots = builtSize_ + 1;
+
+    leavingScan_.resize_anew(nslots);
+
+    size_t bufSize = 0;
+    cub::DeviceScan::ExclusiveSum(nullptr, bufSize, leaving_.devPtr(), leavingScan_.devPtr(), nslots, stream);
+    if (bufSize > leavingScanBuffer_.size())
+        leavingScanBuffer_.resize_anew(bufSize);
+    cub::DeviceScan::ExclusiveSum(leavingScanBuffer_.devPtr(), bufSize,
+                                  leaving_.devPtr(), leavingScan_.devPtr(), nslots, stream);
+
+    CUDA_Check( cudaMemcpyAsync(oldCellStarts_.devPtr(), cellStarts.devPtr(), (totcells + 1) * sizeof(int),
+                                cudaMemcpyDeviceToDevice, stream) );
+
+    const int nthreads = 128;
+    SAFE_KERNEL_LAUNCH(
+        cell_list_kernels::updateCellSizes,
+        getNblocks(view.size, nthreads), nthreads, 0, stream,
+        view.size, cellInfo(), slots, builtSize_, slotCells_.devPtr(), newCells_.devPtr() );
+
     _computeCellStarts(stream);
-    _reorderPositionsAndCreateMap(stream);
-    _reorderPersistentData(stream);
 
+    particlesDataContainer_->resize_anew(view.size);
+    arrivals_.clear(stream);
+
+    SAFE_KERNEL_LAUNCH(
+        cell_list_kernels::reorderPositionsIncrementally,
+        getNblocks(view.size, nthreads), nthreads, 0, stream,
+        view, cellInfo(), slots, builtSize_, slotCells_.devPtr(), newCells_.devPtr(),
+        oldCellStarts_.devPtr(), leavingScan_.devPtr(), arrivals_.devPtr(),
+        particlesDataContainer_->positions().devPtr() );
+}
+
+void CellList::_copyPersistentDataWithCurrentMap(cudaStream_t stream)
+{
+    debug2("%s : no particle changed cell, copying the data with the current map", _makeName().c_str());
+
+    auto srcExtraData = &pv_->local()->dataPerParticle;
+
+    for (const auto& namedChannel : srcExtraData->getSortedChannels())
+    {
+        const auto& name = namedChannel.first;
+        const auto& desc = namedChannel.second;
+        if (desc->persistence != DataManager::PersistenceMode::Active)
+            continue;
+        _reorderExtraDataEntry(name, desc, stream);
+    }
+}
+
+void CellList::_computeSlotCells(cudaStream_t stream)
+{
+    slotCells_.resize_anew(pv_->local()->size());
+
+    const int nthreads = 128;
+    SAFE_KERNEL_LAUNCH(
+        cell_list_kernels::fillSlotCells,
+        getNblocks(totcells, nthreads), nthreads, 0, stream,
+        cellInfo(), slotCells_.devPtr() );
+}
+
+bool CellList::_isParticleVectorReordered() const
+{
+    return false;
+}
+
+void CellList::_build(cudaStream_t stream)
+{
+    const MirState *state = pv_->getState();
+
+    lastBuildKind_ = _detectMigrations(stream);
+
+    switch (lastBuildKind_)
+    {
+    case BuildKind::Full:
+        _computeCellSizes(stream);
+        _computeCellStarts(stream);
+        _reorderPositionsAndCreateMap(stream);
+        if (state->deterministicForces)
+            _sortCellsByParticleId(stream);
+        _reorderPersistentData(stream);
+        ++stats_.numFullBuilds;
+        break;
+
+    case BuildKind::Incremental:
+        _reorderPositionsIncrementally(stream);
+        _reorderPersistentData(stream);
+        ++stats_.numIncrementalBuilds;
+        break;
+
+    case BuildKind::NoReorder:
+        // the particles of a primary cell-list are already in place
+        if (!_isParticleVectorReordered())
+            _copyPersistentDataWithCurrentMap(stream);
+        ++stats_.numSkippedReorders;
+        break;
+    }
+
+    if (state->incrementalCellLists && lastBuildKind_ != BuildKind::NoReorder)
+        _computeSlotCells(stream);
+
+    ++stats_.numBuilds;
+    builtSize_ = pv_->local()->size();
     changedStamp_ = pv_->cellListStamp;
 }
 
@@ -308,6 +660,11 @@ void CellList::build(cudaStream_t stream)
     _build(stream);
 }
 
+const CellList::BuildStatistics& CellList::getBuildStatistics() const
+{
+    return stats_;
+}
+
 static void accumulateIfHasAddOperator(__UNUSED GPUcontainer *src,
                                        __UNUSED GPUcontainer *dst,
                                        __UNUSED int n, __UNUSED CellListInfo cinfo,
@@ -383,6 +740,15 @@ void CellList::clearChannels(const std::vector<std::string>& channelNames, cudaS
 
 LocalParticleVector* CellList::getLocalParticleVector() {return localPV_;}
 
+HaloCellList* CellList::buildHaloCellList(cudaStream_t stream)
+{
+    if (!haloCellList_)
+        haloCellList_ = std::make_unique<HaloCellList>(pv_, h, localDomainSize);
+
+    haloCellList_->build(stream);
+    return haloCellList_.get();
+}
+
 std::string CellList::getName() const
 {
     return _makeName();
@@ -394,6 +760,68 @@ std::string CellList::_makeName() const
 }
 
 
+//=================================================================================
+// Halo cell-lists
+//=================================================================================
+
+HaloCellList::HaloCellList(ParticleVector *pv, real3 h_, real3 localDomainSize_) :
+    CellListInfo(h_, localDomainSize_ + 2.0_r * h_),
+    pv_(pv)
+{
+    cellSizes_. resize_anew(totcells + 1);
+    cellStarts_.resize_anew(totcells + 1);
+}
+
+void HaloCellList::build(cudaStream_t stream)
+{
+    PVview view(pv_, pv_->halo());
+    debug2("Sorting %d halo particles of '%s'", view.size, pv_->getCName());
+
+    sortedIds_.resize_anew(view.size);
+    cellSizes_.clear(stream);
+
+    const int nthreads = 128;
+    SAFE_KERNEL_LAUNCH(
+        cell_list_kernels::computeHaloCellSizes,
+        getNblocks(view.size, nthreads), nthreads, 0, stream,
+        view, cellInfo() );
+
+    size_t bufSize = scanBuffer_.size();
+    if (bufSize == 0)
+    {
+        cub::DeviceScan::ExclusiveSum(nullptr, bufSize, cellSizes_.devPtr(), cellStarts_.devPtr(), totcells+1, stream);
+        scanBuffer_.resize_anew(bufSize);
+    }
+    cub::DeviceScan::ExclusiveSum(scanBuffer_.devPtr(), bufSize,
+                                  cellSizes_.devPtr(), cellStarts_.devPtr(), totcells+1, stream);
+
+    cellSizes_.clear(stream);
+
+    SAFE_KERNEL_LAUNCH(
+        cell_list_kernels::placeHaloParticles,
+        getNblocks(view.size, nthreads), nthreads, 0, stream,
+        view, cellInfo(), sortedIds_.devPtr() );
+
+    SAFE_KERNEL_LAUNCH(
+        cell_list_kernels::sortHaloCells,
+        getNblocks(totcells, nthreads), nthreads, 0, stream,
+        view, cellInfo(), sortedIds_.devPtr() );
+}
+
+CellListInfo HaloCellList::cellInfo()
+{
+    CellListInfo::cellSizes  = cellSizes_.devPtr();
+    CellListInfo::cellStarts = cellStarts_.devPtr();
+    CellListInfo::order      = nullptr;
+
+    return *static_cast<CellListInfo*>(this);
+}
+
+const int* HaloCellList::getSortedIds() const
+{
+    return sortedIds_.devPtr();
+}
+
 //=================================================================================
 // Primary cell-lists
 //=================================================================================
@@ -431,6 +859,10 @@ void PrimaryCellList::build(cudaStream_t stream)
         return;
     }
 
+    // the particles did not change cell: they are already in the cell-list order
+    if (lastBuildKind_ == BuildKind::NoReorder)
+        return;
+
     // Now we need the new size of particles array.
     int newSize;
     CUDA_Check( cudaMemcpyAsync(&newSize, cellStarts.devPtr() + totcells, sizeof(int), cudaMemcpyDeviceToHost, stream) );
@@ -444,6 +876,7 @@ void PrimaryCellList::build(cudaStream_t stream)
     _swapPersistentExtraData();
 
     pv_->local()->resize(newSize, stream);
+    builtSize_ = newSize;
 }
 
 void PrimaryCellList::accumulateChannels(__UNUSED const std::vector<std::string>& channelNames, __UNUSED cudaStream_t stream)
@@ -486,6 +919,11 @@ void PrimaryCellList::_swapPersistentExtraData()
     }
 }
 
+bool PrimaryCellList::_isParticleVectorReordered() const
+{
+    return true;
+}
+
 std::string PrimaryCellList::_makeName() const
 {
     return "Primary " + CellList::_makeName();
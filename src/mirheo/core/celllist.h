@@ -7,6 +7,7 @@
 #include <mirheo/core/pvs/particle_vector.h>
 #include <mirheo/core/pvs/views/pv.h>
 #include <mirheo/core/utils/cuda_common.h>
+#include <mirheo/core/utils/space_filling_curves.h>
 
 namespace mirheo
 {
@@ -44,16 +45,18 @@ public:
      */
     CellListInfo(real rc, real3 localDomainSize);
 
-#ifdef __CUDACC__
     /** \brief map 3D cell indices to linear cell index.
         \param [in] ix Cell index in the x direction
         \param [in] iy Cell index in the y direction
         \param [in] iz Cell index in the z direction
         \return Linear cell index
+
+        The cells of a row along x always have consecutive indices, so that the cells [x-1, x+1] of a row
+        can be traversed as a single range of particles. The order of the rows depends on \c ordering.
      */
     __device__ __host__ inline int encode(int ix, int iy, int iz) const
     {
-        return (iz*ncells.y + iy)*ncells.x + ix;
+        return _encodeRow(iy, iz) * ncells.x + ix;
     }
 
     /** \brief map linear cell index to 3D cell indices.
@@ -64,9 +67,9 @@ public:
      */
     __device__ __host__ inline void decode(int cid, int& ix, int& iy, int& iz) const
     {
-        ix = cid % ncells.x;
-        iy = (cid / ncells.x) % ncells.y;
-        iz = cid / (ncells.x * ncells.y);
+        const int row = cid / ncells.x;
+        ix = cid - row * ncells.x;
+        _decodeRow(row, iy, iz);
     }
 
     /// see encode()
@@ -126,9 +129,13 @@ public:
 
         return encode(cid3);
     }
-#endif
 
 public:
+    /// log2 of the size of the tiles of rows ordered along a space-filling curve, see CellOrdering
+    static constexpr int rowTileBits = 3;
+    /// size of the tiles of rows ordered along a space-filling curve, see CellOrdering
+    static constexpr int rowTileSize = 1 << rowTileBits;
+
     int3 ncells;   ///< Number of cells along each direction in the local domain
     int  totcells; ///< total number of cells in the local domain
     real3 localDomainSize; ///< dimensions of the subdomain
@@ -142,10 +149,190 @@ public:
     /// \c order[pid] is the destination index of the particle with index \c pid before reordering
     int *order {nullptr};
 
+    /** The order of the rows of cells along x.
+        With CellOrdering::Morton and CellOrdering::Hilbert, the (y, z) plane is split in tiles of
+        rowTileSize x rowTileSize rows; the tiles are stored one after the other in row-major order,
+        and the rows inside a full tile follow the space-filling curve.
+        The rows of incomplete tiles at the boundaries are in row-major order.
+     */
+    CellOrdering ordering {CellOrdering::RowMajor};
+
 private:
+    /// \return the position of the row (iy, iz) in the ordering
+    __device__ __host__ inline int _encodeRow(int iy, int iz) const
+    {
+        if (ordering == CellOrdering::RowMajor)
+            return iz * ncells.y + iy;
+
+        const int by = iy >> rowTileBits;
+        const int bz = iz >> rowTileBits;
+        const int ly = iy - (by << rowTileBits);
+        const int lz = iz - (bz << rowTileBits);
+
+        // tiles of the last layers may be incomplete
+        const int tileSizeY = math::min(rowTileSize, ncells.y - (by << rowTileBits));
+        const int tileSizeZ = math::min(rowTileSize, ncells.z - (bz << rowTileBits));
+        const int tileStart = (bz << rowTileBits) * ncells.y + (by << rowTileBits) * tileSizeZ;
+
+        if (tileSizeY < rowTileSize || tileSizeZ < rowTileSize)
+            return tileStart + lz * tileSizeY + ly;
+
+        if (ordering == CellOrdering::Morton)
+            return tileStart + space_filling_curves::mortonEncode(ly, lz, rowTileBits);
+        else
+            return tileStart + space_filling_curves::hilbertEncode(ly, lz, rowTileSize);
+    }
+
+    /// inverse of _encodeRow()
+    __device__ __host__ inline void _decodeRow(int row, int& iy, int& iz) const
+    {
+        if (ordering == CellOrdering::RowMajor)
+        {
+            iy = row % ncells.y;
+            iz = row / ncells.y;
+            return;
+        }
+
+        const int bz = row / (rowTileSize * ncells.y);
+        const int tileSizeZ = math::min(rowTileSize, ncells.z - (bz << rowTileBits));
+        const int rowInLayer = row - (bz << rowTileBits) * ncells.y;
+
+        const int by = rowInLayer / (rowTileSize * tileSizeZ);
+        const int tileSizeY = math::min(rowTileSize, ncells.y - (by << rowTileBits));
+        const int rowInTile = rowInLayer - (by << rowTileBits) * tileSizeZ;
+
+        int ly, lz;
+        if (tileSizeY < rowTileSize || tileSizeZ < rowTileSize)
+        {
+            ly = rowInTile % tileSizeY;
+            lz = rowInTile / tileSizeY;
+        }
+        else if (ordering == CellOrdering::Morton)
+        {
+            space_filling_curves::mortonDecode(rowInTile, rowTileBits, ly, lz);
+        }
+        else
+        {
+            space_filling_curves::hilbertDecode(rowInTile, rowTileSize, ly, lz);
+        }
+
+        iy = (by << rowTileBits) + ly;
+        iz = (bz << rowTileBits) + lz;
+    }
+
     real3 invh_; ///< 1 / h
 };
 
+/** \brief Convert a string to a CellOrdering.
+    \param name One of "row_major", "morton", "hilbert".
+    \return The corresponding ordering. Dies if \p name is not known.
+ */
+CellOrdering stringToCellOrdering(const std::string& name);
+
+/** \brief Helpers for the incremental builds of the cell-lists, see MirState::incrementalCellLists.
+
+    The particles that stay in their cell keep their relative order, the ones that left a cell are removed from it
+    and the ones that arrived in a cell are appended after the staying particles of that cell.
+    With \c leavingScan the exclusive prefix sum over the old slots of the flags "the particle of this slot left its cell",
+    the new slot of every particle is known from the old and new cell starts only.
+ */
+namespace cell_list_incremental
+{
+
+/** \param [in] slots The slot of each particle at the last build, or \c nullptr if the particles are stored in the cell-list order
+    \param [in] numOldSlots The number of particles at the last build
+    \param [in] pid The particle index
+    \return the slot of \p pid at the last build, or -1 if it was not in the cell-list.
+    The particles appended after the last build (arrivals of the redistribution) have no old slot.
+ */
+__HD__ inline int getOldSlot(const int *slots, int numOldSlots, int pid)
+{
+    if (pid >= numOldSlots)
+        return -1;
+    return slots ? slots[pid] : pid;
+}
+
+/** \param [in] cid The cell index
+    \param [in] oldCellStarts The cell starts at the last build
+    \param [in] leavingScan The exclusive prefix sum of the leaving flags over the old slots
+    \return the number of particles of the last build that are still in the cell \p cid
+ */
+__HD__ inline int getNumStaying(int cid, const int *oldCellStarts, const int *leavingScan)
+{
+    const int start = oldCellStarts[cid];
+    const int end   = oldCellStarts[cid+1];
+    return (end - start) - (leavingScan[end] - leavingScan[start]);
+}
+
+/** \param [in] cid The cell of the particle, unchanged since the last build
+    \param [in] oldSlot The slot of the particle at the last build
+    \param [in] oldCellStarts The cell starts at the last build
+    \param [in] newCellStarts The new cell starts
+    \param [in] leavingScan The exclusive prefix sum of the leaving flags over the old slots
+    \return the new slot of a particle that stayed in its cell
+ */
+__HD__ inline int getStayingSlot(int cid, int oldSlot, const int *oldCellStarts, const int *newCellStarts,
+                                 const int *leavingScan)
+{
+    const int start = oldCellStarts[cid];
+    return newCellStarts[cid] + (oldSlot - start) - (leavingScan[oldSlot] - leavingScan[start]);
+}
+
+/** \param [in] cid The new cell of the particle
+    \param [in] arrivalRank The rank of the particle among the ones that arrived in \p cid
+    \param [in] oldCellStarts The cell starts at the last build
+    \param [in] newCellStarts The new cell starts
+    \param [in] leavingScan The exclusive prefix sum of the leaving flags over the old slots
+    \return the new slot of a particle that arrived in the cell \p cid
+ */
+__HD__ inline int getArrivingSlot(int cid, int arrivalRank, const int *oldCellStarts, const int *newCellStarts,
+                                  const int *leavingScan)
+{
+    return newCellStarts[cid] + getNumStaying(cid, oldCellStarts, leavingScan) + arrivalRank;
+}
+
+} // namespace cell_list_incremental
+
+
+/** \brief Cell-lists of the halo particles of a ParticleVector.
+
+    The cells are the ones of a CellList of the same ParticleVector, extended by one layer in every direction.
+    Halo particles outside of this grid cannot interact with local particles and are discarded.
+    The particles are not copied: \c sortedIds gives the halo index of the particle in each slot.
+
+    Within a cell, the particles are sorted by global id (and position, to distinguish periodic images),
+    so that traversing the cells does not depend on the order in which the halo was received.
+    Used by the pairwise interactions when MirState::deterministicForces is set.
+ */
+class HaloCellList : public CellListInfo
+{
+public:
+    /** \brief Construct a HaloCellList object
+        \param [in] pv The ParticleVector whose halo is sorted
+        \param [in] h The size of the cells of the local cell-lists
+        \param [in] localDomainSize The size of the local subdomain
+     */
+    HaloCellList(ParticleVector *pv, real3 h, real3 localDomainSize);
+
+    /** \brief Sort the current halo particles of the attached ParticleVector.
+        \param [in] stream The stream used to execute the process
+     */
+    void build(cudaStream_t stream);
+
+    /// \return the device-compatible handler; \c order is not used.
+    CellListInfo cellInfo();
+
+    /// \return device pointer to the halo index of the particle in each slot
+    const int* getSortedIds() const;
+
+private:
+    ParticleVector *pv_;
+    DeviceBuffer<char> scanBuffer_;
+    DeviceBuffer<int> cellStarts_;
+    DeviceBuffer<int> cellSizes_;
+    DeviceBuffer<int> sortedIds_;
+};
+
 
 /** \brief Contains the cell-list data for a given ParticleVector.
 
@@ -174,14 +361,36 @@ public:
 
     virtual ~CellList();
 
+    /// Counters of the builds of a CellList
+    struct BuildStatistics
+    {
+        long numBuilds {0};            ///< total number of builds
+        long numFullBuilds {0};        ///< number of builds from scratch
+        long numIncrementalBuilds {0}; ///< number of builds that only moved the particles that changed cell
+        long numSkippedReorders {0};   ///< number of builds where no particle changed cell
+        long numChecks {0};            ///< number of builds preceded by the detection of the particles that changed cell
+        long numMigratedTotal {0};     ///< number of particles that changed cell, summed over the checks
+        int numMigratedLast {-1};      ///< number of particles that changed cell at the last check; -1 if unknown
+    };
+
     /// \return the device-compatible handler
     CellListInfo cellInfo();
 
     /** \brief construct the cell-list associated with the attached ParticleVector
         \param [in] stream The stream used to execute the process
+
+        With MirState::incrementalCellLists, the particles that changed cell since the last build are detected first.
+        If there is none, the particles are not reordered at all; if there are only a few, only these are moved,
+        otherwise the cell-list is built from scratch.
+        The particles appended since the last build (see ParticleRedistributor) are treated as arrivals;
+        if the number of particles decreased, the cell-list is built from scratch.
+        The detection synchronizes \p stream.
      */
     virtual void build(cudaStream_t stream);
 
+    /// \return the counters of the builds of this cell-list
+    const BuildStatistics& getBuildStatistics() const;
+
     /** \brief Accumulate the channels from the data contained inside the cell-list
         container to the attached ParticleVector.
         \param [in] channelNames List that contains the names of all the channels to accumulate
@@ -228,6 +437,12 @@ public:
     /// \return the name of the cell-list.
     std::string getName() const;
 
+    /** \brief Build the cell-lists of the halo particles of the attached ParticleVector.
+        \param [in] stream The stream used to execute the process
+        \return The halo cell-lists, with the cells of this cell-list extended by one layer in every direction
+     */
+    HaloCellList* buildHaloCellList(cudaStream_t stream);
+
 protected:
     /// initialize internal buffers; used in the constructor
     void _initialize();
@@ -242,9 +457,30 @@ protected:
     void _computeCellStarts(cudaStream_t stream);
     /// reorder the positions and create \c order. requires cell starts
     void _reorderPositionsAndCreateMap(cudaStream_t stream);
+    /// sort the particles of each cell by global id, see MirState::deterministicForces; requires \c order
+    void _sortCellsByParticleId(cudaStream_t stream);
     /// reorder the rest of the data that is persistent; requires \c order
     void _reorderPersistentData(cudaStream_t stream);
 
+    /// The kind of build performed by _build()
+    enum class BuildKind
+    {
+        Full,        ///< all particles are sorted from scratch
+        Incremental, ///< only the particles that changed cell are moved
+        NoReorder    ///< no particle changed cell; the slots of the last build are kept
+    };
+
+    /// find the particles that changed cell since the last build and choose the kind of build; synchronizes \p stream
+    BuildKind _detectMigrations(cudaStream_t stream);
+    /// update the cell sizes and starts and reorder the positions after _detectMigrations(); creates \c order
+    void _reorderPositionsIncrementally(cudaStream_t stream);
+    /// copy the positions and the persistent data with the \c order of the last build
+    void _copyPersistentDataWithCurrentMap(cudaStream_t stream);
+    /// store the cell of each slot, used by the next _detectMigrations(); requires cell starts
+    void _computeSlotCells(cudaStream_t stream);
+    /// \return \c true if the attached ParticleVector is stored in the cell-list order (see PrimaryCellList)
+    virtual bool _isParticleVectorReordered() const;
+
     /// build cell lists (uses the above functions)
     void _build(cudaStream_t stream);
 
@@ -272,11 +508,26 @@ protected:
     DeviceBuffer<int> cellStarts; ///< Container of the cell starts
     DeviceBuffer<int> cellSizes; ///< Container of the cell sizes
     DeviceBuffer<int> order; ///< container of the reorder map
+    DeviceBuffer<int> sourceIds_; ///< index before reordering of the particle in each slot (deterministic mode only)
+
+    BuildKind lastBuildKind_ {BuildKind::Full}; ///< The kind of the last build
+    BuildStatistics stats_; ///< counters of the builds
+    int builtSize_ {-1}; ///< the number of particles of the attached ParticleVector after the last build, i.e. the number of old slots
+    DeviceBuffer<int> slotCells_; ///< cell of each slot at the last build (incremental mode only)
+    DeviceBuffer<int> newCells_; ///< current cell of each particle, or -1 if it is leaving (incremental mode only)
+    DeviceBuffer<int> leaving_; ///< 1 for the old slots whose particle left its cell, over builtSize_ + 1 slots (incremental mode only)
+    DeviceBuffer<int> leavingScan_; ///< exclusive prefix sum of \c leaving_ (incremental mode only)
+    DeviceBuffer<int> oldCellStarts_; ///< cell starts of the last build (incremental mode only)
+    DeviceBuffer<int> arrivals_; ///< number of particles that arrived in each cell (incremental mode only)
+    DeviceBuffer<char> leavingScanBuffer_; ///< work space to perform the prefix sum of \c leaving_
+    PinnedBuffer<int> numMigrated_; ///< number of particles that changed cell
 
     std::unique_ptr<LocalParticleVector> particlesDataContainer_; ///< local data that holds reordered copy of the attached particle data
     LocalParticleVector *localPV_; ///< will point to particlesDataContainer or pv->local() if Primary
 
     ParticleVector *pv_; ///< The attached ParticleVector
+
+    std::unique_ptr<HaloCellList> haloCellList_; ///< created by buildHaloCellList()
 };
 
 /** \brief Contains the cell-list map for a given ParticleVector.
@@ -313,6 +564,7 @@ public:
 protected:
     /// swap data between the internal container with the attached particle data
     void _swapPersistentExtraData();
+    bool _isParticleVectorReordered() const override;
     std::string _makeName() const override;
 };
 
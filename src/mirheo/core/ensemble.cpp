@@ -0,0 +1,156 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "ensemble.h"
+
+#include <mirheo/core/logger.h>
+#include <mirheo/core/postproc.h>
+#include <mirheo/core/simulation.h>
+#include <mirheo/core/utils/path.h>
+
+namespace mirheo
+{
+
+Ensemble::Ensemble(int nreplicas, int3 nranks3D, real3 globalDomainSize,
+                   LogInfo logInfo, CheckpointInfo checkpointInfo,
+                   real maxObjHalfLength, bool gpuAwareMPI)
+{
+    MPI_Init(nullptr, nullptr);
+    MPI_Comm_dup(MPI_COMM_WORLD, &comm_);
+    initializedMpi_ = true;
+
+    init(nreplicas, nranks3D, globalDomainSize, logInfo,
+         checkpointInfo, maxObjHalfLength, gpuAwareMPI);
+}
+
+Ensemble::Ensemble(MPI_Comm comm, int nreplicas, int3 nranks3D, real3 globalDomainSize,
+                   LogInfo logInfo, CheckpointInfo checkpointInfo,
+                   real maxObjHalfLength, bool gpuAwareMPI)
+{
+    MPI_Comm_dup(comm, &comm_);
+
+    init(nreplicas, nranks3D, globalDomainSize, logInfo,
+         checkpointInfo, maxObjHalfLength, gpuAwareMPI);
+}
+
+void Ensemble::init(int nreplicas, int3 nranks3D, real3 globalDomainSize,
+                    LogInfo logInfo, CheckpointInfo checkpointInfo,
+                    real maxObjHalfLength, bool gpuAwareMPI)
+{
+    if (nreplicas <= 0)
+        die("An ensemble needs at least one replica, got %d", nreplicas);
+
+    const std::string baseFolder = makePath(checkpointInfo.folder);
+
+    for (int i = 0; i < nreplicas; ++i)
+    {
+        // the first replica sets up the logger shared by all of them
+        const bool ownLogger = (i == 0);
+        LogInfo replicaLogInfo = logInfo;
+        replicaLogInfo.noSplash = logInfo.noSplash || !ownLogger;
+
+        CheckpointInfo replicaCheckpointInfo = checkpointInfo;
+        replicaCheckpointInfo.folder = baseFolder + getReplicaFolder(i);
+
+        // Mirheo's constructor is private for replicas, hence no make_unique
+        replicas_.emplace_back(new Mirheo(comm_, nranks3D, globalDomainSize, replicaLogInfo,
+                                          replicaCheckpointInfo, maxObjHalfLength, gpuAwareMPI, ownLogger));
+    }
+
+    info("Created an ensemble of %d replicas", nreplicas);
+}
+
+Ensemble::~Ensemble()
+{
+    replicas_.clear();
+
+    if (comm_ != MPI_COMM_NULL)
+        MPI_Check( MPI_Comm_free(&comm_) );
+
+    if (initializedMpi_)
+        MPI_Finalize();
+}
+
+int Ensemble::getNumReplicas() const
+{
+    return static_cast<int>(replicas_.size());
+}
+
+Mirheo* Ensemble::getReplica(int i)
+{
+    if (i < 0 || i >= getNumReplicas())
+        die("Replica %d is out of range: the ensemble has %d replicas", i, getNumReplicas());
+    return replicas_[i].get();
+}
+
+std::string Ensemble::getReplicaFolder(int i)
+{
+    constexpr int zeroPadding = 3;
+    return "replica_" + createStrZeroPadded(i, zeroPadding) + "/";
+}
+
+void Ensemble::run(MirState::StepType niters, real dt)
+{
+    struct DtGuard {
+        ~DtGuard() noexcept {
+            for (auto state : states)
+                state->setDt((real)MirState::InvalidDt);
+        }
+
+        std::vector<MirState*> states;
+    };
+    DtGuard guard;  // Reset dt even in case of an exception.
+
+    for (auto& replica : replicas_)
+    {
+        if (auto state = replica->getState())
+        {
+            state->setDt(dt);
+            guard.states.push_back(state);
+        }
+        // Both sides set up the replicas in the same order, hence the plugin handshakes match.
+        replica->setup();
+    }
+
+    if (replicas_[0]->isComputeTask())
+    {
+        std::vector<Simulation*> simulations;
+        for (auto& replica : replicas_)
+        {
+            replica->sim_->startRun(niters);
+            simulations.push_back(replica->sim_.get());
+        }
+
+        // The tasks of a replica may block on the messages of the other ranks (exchanges, reductions).
+        // Interleaving the tasks of several replicas could then deadlock if the ranks do not interleave them
+        // in the same order, so they are executed concurrently only when every replica runs on a single rank.
+        int nranks;
+        MPI_Check( MPI_Comm_size(replicas_[0]->sim_->getCartComm(), &nranks) );
+
+        for (MirState::StepType i = 0; i < niters; ++i)
+        {
+            if (nranks == 1)
+            {
+                Simulation::runStep(simulations);
+            }
+            else
+            {
+                for (auto sim : simulations)
+                    sim->runStep();
+            }
+        }
+
+        for (auto sim : simulations)
+            sim->finishRun();
+    }
+    else
+    {
+        std::vector<Postprocess*> postprocesses;
+        for (auto& replica : replicas_)
+            postprocesses.push_back(replica->post_.get());
+
+        Postprocess::run(postprocesses);
+    }
+
+    MPI_Check( MPI_Barrier(comm_) );
+}
+
+} // namespace mirheo
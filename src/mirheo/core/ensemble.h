@@ -0,0 +1,78 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <mirheo/core/mirheo.h>
+
+#include <memory>
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace mirheo
+{
+
+/** \brief Run several independent replicas of a simulation within the same job.
+
+    Each replica is a full \c Mirheo object with its own particle vectors, plugins and task graph,
+    all sharing the same communicator, the same domain decomposition and the same GPU.
+    The replicas are set up by the user through getReplica(), typically with different seeds or parameters,
+    and are then advanced in lockstep by run().
+    When each replica runs on a single rank, the tasks of all replicas are executed concurrently on their own streams
+    (see Simulation::runStep()); otherwise, one time step of each replica is performed in turn.
+
+    This saves the startup of one job per replica and lets small simulations share a GPU that a single one
+    would not fill. The files of replica \c i are written in the sub-folder getReplicaFolder() \c (i)
+    of the checkpoint folder; the outputs of the plugins should be placed in the same way.
+ */
+class Ensemble
+{
+public:
+    /** \brief Construct an \c Ensemble with the given number of replicas.
+        \param comm The communicator shared by all replicas; the ranks are split as in \c Mirheo.
+               MPI will NOT be initialized; the destructor will NOT finalize MPI.
+        \param nreplicas The number of replicas; must be positive.
+        \param nranks3D Number of ranks along each cartesian direction, for each replica.
+        \param globalDomainSize The full domain dimensions in length units, for each replica.
+        \param logInfo Information about logging; all replicas log to the same file.
+        \param checkpointInfo Information about checkpoint; the folder is suffixed by getReplicaFolder() for each replica.
+        \param maxObjHalfLength Half of the maximum length of all objects.
+        \param gpuAwareMPI \c true to use RDMA (must be compile with a MPI version that supports it)
+     */
+    Ensemble(MPI_Comm comm, int nreplicas, int3 nranks3D, real3 globalDomainSize,
+             LogInfo logInfo, CheckpointInfo checkpointInfo,
+             real maxObjHalfLength, bool gpuAwareMPI=false);
+
+    /** \brief Construct an \c Ensemble using MPI_COMM_WORLD.
+        \note MPI will be initialized internally and finalized by the destructor.
+        See the constructor with a communicator for the other parameters.
+     */
+    Ensemble(int nreplicas, int3 nranks3D, real3 globalDomainSize,
+             LogInfo logInfo, CheckpointInfo checkpointInfo,
+             real maxObjHalfLength, bool gpuAwareMPI=false);
+
+    ~Ensemble();
+
+    int getNumReplicas() const; ///< \return the number of replicas
+    Mirheo* getReplica(int i);  ///< \return the \c Mirheo object of the replica \p i
+
+    /// \return the sub-folder "replica_XXX/" that holds the files of the replica \p i
+    static std::string getReplicaFolder(int i);
+
+    /** \brief advance all replicas by the same number of time steps.
+        \param niters number of interations
+        \param dt time step duration, the same for all replicas
+     */
+    void run(MirState::StepType niters, real dt);
+
+private:
+    void init(int nreplicas, int3 nranks3D, real3 globalDomainSize,
+              LogInfo logInfo, CheckpointInfo checkpointInfo,
+              real maxObjHalfLength, bool gpuAwareMPI);
+
+private:
+    bool initializedMpi_ = false;
+    MPI_Comm comm_ {MPI_COMM_NULL};
+    std::vector<std::unique_ptr<Mirheo>> replicas_;
+};
+
+} // namespace mirheo
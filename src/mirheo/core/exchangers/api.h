@@ -4,7 +4,9 @@
 #include "interface.h"
 #include "engines/interface.h"
 
+#include "engines/factory.h"
 #include "engines/mpi.h"
+#include "engines/neighbor_collective.h"
 #include "engines/single_node.h"
 
 #include "particle_halo_exchanger.h"
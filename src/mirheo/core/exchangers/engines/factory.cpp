@@ -0,0 +1,51 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "factory.h"
+#include "mpi.h"
+#include "neighbor_collective.h"
+#include "single_node.h"
+
+#include <mirheo/core/exchangers/interface.h>
+#include <mirheo/core/logger.h>
+
+namespace mirheo
+{
+
+ExchangeEngineType stringToExchangeEngineType(const std::string& name)
+{
+    if (name == "default")        return ExchangeEngineType::Default;
+    if (name == "mpi")            return ExchangeEngineType::MPI;
+    if (name == "mpi_persistent") return ExchangeEngineType::MPIPersistent;
+    if (name == "mpi_neighbor_collective") return ExchangeEngineType::MPINeighborCollective;
+
+    die("Unknown exchange engine '%s'", name.c_str());
+    return ExchangeEngineType::Default;
+}
+
+std::unique_ptr<ExchangeEngine> createExchangeEngine(ExchangeEngineType type,
+                                                     std::unique_ptr<Exchanger>&& exchanger,
+                                                     MPI_Comm comm, bool gpuAwareMPI)
+{
+    int nranks;
+    MPI_Check( MPI_Comm_size(comm, &nranks) );
+
+    // If we're on one node, use a singleNode engine
+    if (nranks == 1)
+        return std::make_unique<SingleNodeExchangeEngine> (std::move(exchanger));
+
+    switch (type)
+    {
+    case ExchangeEngineType::Default:
+    case ExchangeEngineType::MPI:
+        return std::make_unique<MPIExchangeEngine> (std::move(exchanger), comm, gpuAwareMPI);
+    case ExchangeEngineType::MPIPersistent:
+        return std::make_unique<MPIExchangeEngine> (std::move(exchanger), comm, gpuAwareMPI,
+                                                    MPIExchangeEngine::Protocol::Persistent);
+    case ExchangeEngineType::MPINeighborCollective:
+        return std::make_unique<NeighborCollectiveExchangeEngine> (std::move(exchanger), comm, gpuAwareMPI);
+    }
+
+    die("Unknown exchange engine type");
+    return nullptr;
+}
+
+} // namespace mirheo
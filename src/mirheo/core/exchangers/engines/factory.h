@@ -0,0 +1,43 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include "interface.h"
+
+#include <mpi.h>
+#include <memory>
+#include <string>
+
+namespace mirheo
+{
+
+class Exchanger;
+
+/// The kind of ExchangeEngine used to communicate between the simulation subdomains
+enum class ExchangeEngineType
+{
+    Default,      ///< SingleNodeExchangeEngine on a single rank, MPI otherwise
+    MPI,          ///< MPIExchangeEngine with MPIExchangeEngine::Protocol::SizesThenData
+    MPIPersistent,        ///< MPIExchangeEngine with MPIExchangeEngine::Protocol::Persistent
+    MPINeighborCollective ///< NeighborCollectiveExchangeEngine
+};
+
+/** \brief Convert a string to an ExchangeEngineType.
+    \param name One of "default", "mpi", "mpi_persistent", "mpi_neighbor_collective".
+    \return The corresponding engine type. Dies if \p name is not known.
+ */
+ExchangeEngineType stringToExchangeEngineType(const std::string& name);
+
+/** \brief Create an ExchangeEngine.
+    \param type The kind of engine to create.
+    \param exchanger The \c Exchanger object that will prepare the data to communicate.
+    \param comm The cartesian communicator that represents the simulation domain.
+    \param gpuAwareMPI \c true to enable RDMA implementation, if supported by the engine.
+    \return The engine.
+
+    A SingleNodeExchangeEngine is always returned if \p comm has a single rank.
+ */
+std::unique_ptr<ExchangeEngine> createExchangeEngine(ExchangeEngineType type,
+                                                     std::unique_ptr<Exchanger>&& exchanger,
+                                                     MPI_Comm comm, bool gpuAwareMPI);
+
+} // namespace mirheo
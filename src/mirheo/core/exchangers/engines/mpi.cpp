@@ -8,20 +8,37 @@
 #include <mirheo/core/utils/timer.h>
 
 #include <algorithm>
+#include <cstring>
 
 namespace mirheo
 {
 
 MPIExchangeEngine::MPIExchangeEngine(std::unique_ptr<Exchanger>&& exchanger,
                                      MPI_Comm comm, bool gpuAwareMPI) :
+    MPIExchangeEngine(std::move(exchanger), comm, gpuAwareMPI, Protocol::SizesThenData)
+{}
+
+MPIExchangeEngine::MPIExchangeEngine(std::unique_ptr<Exchanger>&& exchanger,
+                                     MPI_Comm comm, bool gpuAwareMPI,
+                                     Protocol protocol, size_t initialCapacity) :
     ExchangeEngine(std::move(exchanger)),
     dir2rank_   (fragment_mapping::numFragments),
     dir2sendTag_(fragment_mapping::numFragments),
     dir2recvTag_(fragment_mapping::numFragments),
-    gpuAwareMPI_(gpuAwareMPI)
+    gpuAwareMPI_(gpuAwareMPI),
+    protocol_(protocol),
+    initialCapacity_(initialCapacity)
 {
     MPI_Check( MPI_Comm_dup(comm, &haloComm_) );
 
+    if (protocol_ == Protocol::Persistent)
+    {
+        MPI_Check( MPI_Comm_dup(comm, &overflowComm_) );
+
+        if (gpuAwareMPI_)
+            warn("GPU aware MPI is not used by the persistent exchange protocol");
+    }
+
     int dims[3], periods[3], coords[3];
     MPI_Check( MPI_Cart_get (haloComm_, 3, dims, periods, coords) );
 
@@ -44,9 +61,25 @@ MPIExchangeEngine::MPIExchangeEngine(std::unique_ptr<Exchanger>&& exchanger,
 
 MPIExchangeEngine::~MPIExchangeEngine()
 {
+    for (auto& links : persistentLinks_)
+        for (auto& req : links.recvRequests)
+            if (req != MPI_REQUEST_NULL)
+                MPI_Check( MPI_Request_free(&req) );
+
+    if (overflowComm_ != MPI_COMM_NULL)
+        MPI_Check( MPI_Comm_free(&overflowComm_) );
+
     MPI_Check( MPI_Comm_free(&haloComm_) );
 }
 
+size_t MPIExchangeEngine::computeGrownCapacity(size_t capacity, size_t requiredBytes)
+{
+    // grow geometrically, with some margin over the current requirement to avoid overflowing at every step
+    constexpr size_t alignment = 64;
+    const size_t capacityWithMargin = std::max(2 * capacity, requiredBytes + requiredBytes / 4);
+    return ((capacityWithMargin + alignment - 1) / alignment) * alignment;
+}
+
 void MPIExchangeEngine::init(cudaStream_t stream)
 {
     const size_t numExchangeEntities = exchanger_->getNumExchangeEntities();
@@ -55,6 +88,39 @@ void MPIExchangeEngine::init(cudaStream_t stream)
         if (!exchanger_->needExchange(i))
             debug("Exchange of PV '%s' is skipped", exchanger_->getExchangeEntity(i)->getCName());
 
+    if (protocol_ == Protocol::Persistent)
+    {
+        persistentLinks_.resize(numExchangeEntities);
+        persistentReady_.resize(numExchangeEntities, false);
+
+        // Restart the persistent receives first: they are ready for the fused messages of the neighbours
+        for (size_t i = 0; i < numExchangeEntities; ++i)
+        {
+            if (!exchanger_->needExchange(i))
+                continue;
+
+            if (!persistentReady_[i])
+                _initPersistent(i);
+
+            auto& reqs = persistentLinks_[i].recvRequests;
+            MPI_Check( MPI_Startall((int) reqs.size(), reqs.data()) );
+        }
+
+        for (size_t i = 0; i < numExchangeEntities; ++i)
+            if (exchanger_->needExchange(i))
+                exchanger_->prepareSizes(i, stream);
+
+        for (size_t i = 0; i < numExchangeEntities; ++i)
+            if (exchanger_->needExchange(i))
+                exchanger_->prepareData(i, stream);
+
+        for (size_t i = 0; i < numExchangeEntities; ++i)
+            if (exchanger_->needExchange(i))
+                _sendFused(exchanger_->getExchangeEntity(i), persistentLinks_[i], stream);
+
+        return;
+    }
+
     // Post irecv for sizes
     for (size_t i = 0; i < numExchangeEntities; ++i)
         if (exchanger_->needExchange(i))
@@ -94,6 +160,23 @@ void MPIExchangeEngine::finalize(cudaStream_t stream)
 {
     const size_t numExchangeEntities = exchanger_->getNumExchangeEntities();
 
+    if (protocol_ == Protocol::Persistent)
+    {
+        for (size_t i = 0; i < numExchangeEntities; ++i)
+            if (exchanger_->needExchange(i))
+                _waitFused(exchanger_->getExchangeEntity(i), persistentLinks_[i], stream);
+
+        for (size_t i = 0; i < numExchangeEntities; ++i)
+            if (exchanger_->needExchange(i))
+                _waitSendsFused(persistentLinks_[i]);
+
+        for (size_t i = 0; i < numExchangeEntities; ++i)
+            if (exchanger_->needExchange(i))
+                exchanger_->combineAndUploadData(i, stream);
+
+        return;
+    }
+
     // Wait for the irecvs to finish
     for (size_t i = 0; i < numExchangeEntities; ++i)
         if (exchanger_->needExchange(i))
@@ -342,4 +425,192 @@ void MPIExchangeEngine::_send(ExchangeEntity *helper, cudaStream_t stream)
     debug("Sent total %d '%s' entities", totSent, pvName.c_str());
 }
 
+//================================================================================================
+// Persistent protocol
+//================================================================================================
+
+/// The header of the fused messages: the number of entities sent through the link
+using FusedHeader = int;
+static constexpr size_t headerBytes = sizeof(FusedHeader);
+
+void MPIExchangeEngine::_initPersistent(size_t entityId)
+{
+    auto helper = exchanger_->getExchangeEntity(entityId);
+    auto& links = persistentLinks_[entityId];
+    const int nBuffers = helper->nBuffers;
+
+    links.sendCapacity.assign(nBuffers, initialCapacity_);
+    links.recvCapacity.assign(nBuffers, initialCapacity_);
+    links.sendSlots.resize(nBuffers);
+    links.recvSlots.resize(nBuffers);
+    links.recvRequests.clear();
+
+    for (int i = 0; i < nBuffers; ++i)
+    {
+        if (i == helper->bulkId) continue;
+        links.sendSlots[i].resize(headerBytes + initialCapacity_);
+        links.recvRequests.push_back(MPI_REQUEST_NULL);
+        _resetRecvRequest(helper, links, i);
+    }
+
+    persistentReady_[entityId] = true;
+
+    debug("Initialized persistent exchange links of '%s' with capacity %zu bytes",
+          helper->getCName(), initialCapacity_);
+}
+
+/// \return the index of the request of buffer bufId, skipping the bulk
+static int getRequestId(const ExchangeEntity *helper, int bufId)
+{
+    return bufId < helper->bulkId ? bufId : bufId - 1;
+}
+
+void MPIExchangeEngine::_resetRecvRequest(ExchangeEntity *helper, PersistentLinks& links, int bufId)
+{
+    auto& req = links.recvRequests[getRequestId(helper, bufId)];
+    if (req != MPI_REQUEST_NULL)
+        MPI_Check( MPI_Request_free(&req) );
+
+    auto& slot = links.recvSlots[bufId];
+    slot.resize(headerBytes + links.recvCapacity[bufId]);
+
+    const int tag = helper->nBuffers * helper->getUniqueId() + dir2recvTag_[bufId];
+    MPI_Check( MPI_Recv_init(slot.data(), (int) slot.size(), MPI_BYTE,
+                             dir2rank_[bufId], tag, haloComm_, &req) );
+}
+
+/**
+ * Expects helper->sendSizes and helper->sendOffsets to be ON HOST
+ * helper->sendBuf data is ON DEVICE
+ */
+void MPIExchangeEngine::_sendFused(ExchangeEntity *helper, PersistentLinks& links, cudaStream_t stream)
+{
+    const int nBuffers = helper->nBuffers;
+    const auto sSizes        = helper->send.sizes.       hostPtr();
+    const auto sSizesBytes   = helper->send.sizesBytes.  hostPtr();
+    const auto sOffsetsBytes = helper->send.offsetsBytes.hostPtr();
+
+    helper->send.buffer.downloadFromDevice(stream);
+
+    links.sendRequests.clear();
+    links.sendOverflows.clear();
+    links.sendOverflowBytes.clear();
+
+    for (int i = 0; i < nBuffers; ++i)
+    {
+        if (i == helper->bulkId) continue;
+
+        const int tag = nBuffers * helper->getUniqueId() + dir2sendTag_[i];
+        const size_t bytes = sSizesBytes[i];
+        const bool fits = bytes <= links.sendCapacity[i];
+        char *slot = links.sendSlots[i].data();
+        const char *payload = helper->send.buffer.hostPtr() + sOffsetsBytes[i];
+
+        const FusedHeader header = sSizes[i];
+        memcpy(slot, &header, headerBytes);
+
+        if (fits)
+            memcpy(slot + headerBytes, payload, bytes);
+
+        MPI_Request req;
+        MPI_Check( MPI_Isend(slot, (int) (headerBytes + (fits ? bytes : 0)), MPI_BYTE,
+                             dir2rank_[i], tag, haloComm_, &req) );
+        links.sendRequests.push_back(req);
+
+        if (!fits)
+        {
+            debug("Persistent link %d of '%s' overflows: %zu bytes for a capacity of %zu",
+                  i, helper->getCName(), bytes, links.sendCapacity[i]);
+
+            MPI_Check( MPI_Isend(payload, (int) bytes, MPI_BYTE,
+                                 dir2rank_[i], tag, overflowComm_, &req) );
+            links.sendRequests.push_back(req);
+            links.sendOverflows.push_back(i);
+            links.sendOverflowBytes.push_back(bytes);
+        }
+    }
+}
+
+/**
+ * helper->recvBuf will contain all the data, ON DEVICE already
+ */
+void MPIExchangeEngine::_waitFused(ExchangeEntity *helper, PersistentLinks& links, cudaStream_t stream)
+{
+    const int nBuffers = helper->nBuffers;
+    const auto rSizes        = helper->recv.sizes.       hostPtr();
+    const auto rSizesBytes   = helper->recv.sizesBytes.  hostPtr();
+    const auto rOffsetsBytes = helper->recv.offsetsBytes.hostPtr();
+
+    mTimer tm;
+    tm.start();
+    safeWaitAll((int) links.recvRequests.size(), links.recvRequests.data());
+    double waitTime = tm.elapsed();
+
+    helper->recv.sizes.clearHost();
+    for (int i = 0; i < nBuffers; ++i)
+    {
+        if (i == helper->bulkId) continue;
+        FusedHeader header;
+        memcpy(&header, links.recvSlots[i].data(), headerBytes);
+        rSizes[i] = header;
+    }
+
+    helper->computeRecvOffsets();
+    helper->resizeRecvBuf();
+
+    std::vector<MPI_Request> overflowRequests;
+    std::vector<int> overflows;
+
+    for (int i = 0; i < nBuffers; ++i)
+    {
+        if (i == helper->bulkId) continue;
+
+        const size_t bytes = rSizesBytes[i];
+        char *dst = helper->recv.buffer.hostPtr() + rOffsetsBytes[i];
+
+        if (bytes <= links.recvCapacity[i])
+        {
+            memcpy(dst, links.recvSlots[i].data() + headerBytes, bytes);
+        }
+        else
+        {
+            const int tag = nBuffers * helper->getUniqueId() + dir2recvTag_[i];
+            MPI_Request req;
+            MPI_Check( MPI_Irecv(dst, (int) bytes, MPI_BYTE, dir2rank_[i], tag, overflowComm_, &req) );
+            overflowRequests.push_back(req);
+            overflows.push_back(i);
+        }
+    }
+
+    tm.start();
+    safeWaitAll((int) overflowRequests.size(), overflowRequests.data());
+    waitTime += tm.elapsed();
+
+    // the persistent requests are inactive at this point: safe to replace them
+    for (int i : overflows)
+    {
+        links.recvCapacity[i] = computeGrownCapacity(links.recvCapacity[i], rSizesBytes[i]);
+        _resetRecvRequest(helper, links, i);
+    }
+
+    helper->recv.uploadInfosToDevice(stream);
+    helper->recv.buffer.uploadToDevice(stream);
+
+    debug("Completed fused receive for '%s' (%zu overflows), waiting took %f ms",
+          helper->getCName(), overflows.size(), waitTime);
+}
+
+void MPIExchangeEngine::_waitSendsFused(PersistentLinks& links)
+{
+    safeWaitAll((int) links.sendRequests.size(), links.sendRequests.data());
+
+    // the slots are not used anymore by MPI: safe to grow them
+    for (size_t j = 0; j < links.sendOverflows.size(); ++j)
+    {
+        const int i = links.sendOverflows[j];
+        links.sendCapacity[i] = computeGrownCapacity(links.sendCapacity[i], links.sendOverflowBytes[j]);
+        links.sendSlots[i].resize(headerBytes + links.sendCapacity[i]);
+    }
+}
+
 } // namespace mirheo
@@ -18,6 +18,17 @@ class ExchangeEntity;
     - init() prepares the data into buffers, exchange the sizes, allocate recv buffers and post
       the asynchronous communication calls.
     - finalize() waits for the communication to finish and unpacks the data.
+
+    Two protocols are available (see Protocol):
+    - Protocol::SizesThenData: the sizes are exchanged first (blocking sends), then the data are
+      received directly into the recv buffer, of the right size.
+    - Protocol::Persistent: every link (neighbour and exchange entity) owns a preallocated host slot,
+      made of a small header (the number of entities) and a payload of fixed capacity.
+      The receives are persistent requests (\c MPI_Recv_init) restarted every step, and the sizes are
+      sent together with the data in a single message, which removes one latency per step.
+      When the data do not fit in the capacity, only the header is sent with the fused message
+      and the payload follows in a second message; both sides then grow the capacity of the link
+      in the same deterministic way. The data is staged through the host in this protocol.
  */
 class MPIExchangeEngine : public ExchangeEngine
 {
@@ -28,8 +39,39 @@ public:
         \param gpuAwareMPI \c true to enable RDMA implementation. Only works if the MPI library has this feature implemented.
      */
     MPIExchangeEngine(std::unique_ptr<Exchanger>&& exchanger, MPI_Comm comm, bool gpuAwareMPI);
+
+    /// The communication protocol used by the engine
+    enum class Protocol
+    {
+        SizesThenData, ///< exchange the sizes, then the data
+        Persistent     ///< fused sizes and data, persistent receives
+    };
+
+    /** \brief Construct a MPIExchangeEngine.
+        \param exchanger The class responsible to pack and unpack the data.
+        \param comm The cartesian communicator that represents the simulation domain.
+        \param gpuAwareMPI \c true to enable RDMA implementation. Ignored with Protocol::Persistent.
+        \param protocol The communication protocol.
+        \param initialCapacity The initial payload capacity of each link in bytes. Only used with Protocol::Persistent.
+     */
+    MPIExchangeEngine(std::unique_ptr<Exchanger>&& exchanger, MPI_Comm comm, bool gpuAwareMPI,
+                      Protocol protocol, size_t initialCapacity = defaultInitialCapacity);
+
     ~MPIExchangeEngine();
 
+    /// default payload capacity of the links in persistent mode, in bytes
+    static constexpr size_t defaultInitialCapacity = 16384;
+
+    /** \brief Compute the new capacity of a link that overflowed.
+        \param capacity The current capacity in bytes.
+        \param requiredBytes The size of the message that did not fit.
+        \return The new capacity, at least \p requiredBytes.
+
+        Both ends of a link call this function with the same arguments, so that they stay consistent
+        without additional communication.
+     */
+    static size_t computeGrownCapacity(size_t capacity, size_t requiredBytes);
+
     void init(cudaStream_t stream)     override;
     void finalize(cudaStream_t stream) override;
 
@@ -40,6 +82,23 @@ private:
     void _wait        (ExchangeEntity *helper, cudaStream_t stream);
     void _send        (ExchangeEntity *helper, cudaStream_t stream);
 
+    /// Host buffers and requests of all the links of one exchange entity, used with Protocol::Persistent
+    struct PersistentLinks
+    {
+        std::vector<size_t> sendCapacity, recvCapacity; ///< payload capacity of each link, in bytes
+        std::vector<std::vector<char>> sendSlots, recvSlots; ///< header + payload of each link
+        std::vector<MPI_Request> recvRequests; ///< persistent receives of the fused messages
+        std::vector<MPI_Request> sendRequests; ///< fused and overflow sends of the current step
+        std::vector<int> sendOverflows;        ///< links whose last send did not fit in the capacity
+        std::vector<size_t> sendOverflowBytes; ///< size of the corresponding payloads
+    };
+
+    void _initPersistent    (size_t entityId);
+    void _resetRecvRequest  (ExchangeEntity *helper, PersistentLinks& links, int bufId);
+    void _sendFused         (ExchangeEntity *helper, PersistentLinks& links, cudaStream_t stream);
+    void _waitFused         (ExchangeEntity *helper, PersistentLinks& links, cudaStream_t stream);
+    void _waitSendsFused    (PersistentLinks& links);
+
 private:
     std::vector<int> dir2rank_;
     std::vector<int> dir2sendTag_;
@@ -49,6 +108,12 @@ private:
 
     MPI_Comm haloComm_;
     static constexpr int singleCopyThreshold_ = 4000000;
+
+    Protocol protocol_;
+    size_t initialCapacity_;
+    MPI_Comm overflowComm_ {MPI_COMM_NULL}; ///< separate channel for the payloads that overflow the slots
+    std::vector<PersistentLinks> persistentLinks_; ///< one per exchange entity
+    std::vector<bool> persistentReady_;            ///< whether the requests of an entity are initialized
 };
 
 } // namespace mirheo
@@ -0,0 +1,199 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "neighbor_collective.h"
+#include "../exchange_entity.h"
+#include "../utils/fragments_mapping.h"
+
+#include <mirheo/core/exchangers/interface.h>
+#include <mirheo/core/logger.h>
+#include <mirheo/core/utils/timer.h>
+
+namespace mirheo
+{
+
+NeighborCollectiveExchangeEngine::NeighborCollectiveExchangeEngine(std::unique_ptr<Exchanger>&& exchanger,
+                                                                   MPI_Comm comm, bool gpuAwareMPI) :
+    ExchangeEngine(std::move(exchanger)),
+    gpuAwareMPI_(gpuAwareMPI)
+{
+    int dims[3], periods[3], coords[3];
+    MPI_Check( MPI_Cart_get (comm, 3, dims, periods, coords) );
+
+    auto getNeighbourRank = [&](int fragId)
+    {
+        const int3 d = fragment_mapping::getDir(fragId);
+        const int coordsNeigh[3] = {coords[0] + d.x, coords[1] + d.y, coords[2] + d.z};
+        int rank;
+        MPI_Check( MPI_Cart_rank(comm, coordsNeigh, &rank) );
+        return rank;
+    };
+
+    std::vector<int> sources, destinations;
+
+    // Edges are sorted by the fragment id on the sender side.
+    // The data sent as fragment i is received as fragment -i, from the neighbour in direction -i.
+    for (int i = 0; i < fragment_mapping::numFragments; ++i)
+    {
+        if (i == fragment_mapping::bulkId) continue;
+
+        const int3 d = fragment_mapping::getDir(i);
+        const int recvFragId = fragment_mapping::getId(-d.x, -d.y, -d.z);
+
+        edge2sendFragment_.push_back(i);
+        destinations      .push_back(getNeighbourRank(i));
+
+        edge2recvFragment_.push_back(recvFragId);
+        sources           .push_back(getNeighbourRank(recvFragId));
+    }
+
+    constexpr int reorder = 0;
+    MPI_Check( MPI_Dist_graph_create_adjacent(comm,
+                                              (int) sources.size(), sources.data(), MPI_UNWEIGHTED,
+                                              (int) destinations.size(), destinations.data(), MPI_UNWEIGHTED,
+                                              MPI_INFO_NULL, reorder, &graphComm_) );
+}
+
+NeighborCollectiveExchangeEngine::~NeighborCollectiveExchangeEngine()
+{
+    MPI_Check( MPI_Comm_free(&graphComm_) );
+}
+
+void NeighborCollectiveExchangeEngine::init(cudaStream_t stream)
+{
+    const size_t numExchangeEntities = exchanger_->getNumExchangeEntities();
+    messages_.resize(numExchangeEntities);
+
+    for (size_t i = 0; i < numExchangeEntities; ++i)
+        if (!exchanger_->needExchange(i))
+            debug("Exchange of PV '%s' is skipped", exchanger_->getExchangeEntity(i)->getCName());
+
+    // Derived class determines what to send
+    for (size_t i = 0; i < numExchangeEntities; ++i)
+        if (exchanger_->needExchange(i))
+            exchanger_->prepareSizes(i, stream);
+
+    for (size_t i = 0; i < numExchangeEntities; ++i)
+        if (exchanger_->needExchange(i))
+            _startSizes(exchanger_->getExchangeEntity(i), messages_[i]);
+
+    // Derived class determines what to send
+    for (size_t i = 0; i < numExchangeEntities; ++i)
+        if (exchanger_->needExchange(i))
+            exchanger_->prepareData(i, stream);
+
+    // CUDA-aware MPI will work in a separate stream, need to synchronize
+    if (gpuAwareMPI_)
+        CUDA_Check( cudaStreamSynchronize(stream) );
+
+    for (size_t i = 0; i < numExchangeEntities; ++i)
+        if (exchanger_->needExchange(i))
+            _startData(exchanger_->getExchangeEntity(i), messages_[i], stream);
+}
+
+void NeighborCollectiveExchangeEngine::finalize(cudaStream_t stream)
+{
+    const size_t numExchangeEntities = exchanger_->getNumExchangeEntities();
+
+    for (size_t i = 0; i < numExchangeEntities; ++i)
+        if (exchanger_->needExchange(i))
+            _wait(exchanger_->getExchangeEntity(i), messages_[i], stream);
+
+    // Derived class unpack implementation
+    for (size_t i = 0; i < numExchangeEntities; ++i)
+        if (exchanger_->needExchange(i))
+            exchanger_->combineAndUploadData(i, stream);
+}
+
+/**
+ * Expects helper->sendSizes to be ON HOST
+ */
+void NeighborCollectiveExchangeEngine::_startSizes(ExchangeEntity *helper, Messages& msg)
+{
+    const int nEdges = (int) edge2sendFragment_.size();
+    const auto sSizes = helper->send.sizes.hostPtr();
+
+    msg.sendSizes.resize(nEdges);
+    msg.recvSizes.resize(nEdges);
+
+    for (int e = 0; e < nEdges; ++e)
+        msg.sendSizes[e] = sSizes[edge2sendFragment_[e]];
+
+    MPI_Check( MPI_Ineighbor_alltoall(msg.sendSizes.data(), 1, MPI_INT,
+                                      msg.recvSizes.data(), 1, MPI_INT,
+                                      graphComm_, &msg.sizesRequest) );
+}
+
+/**
+ * Expects helper->sendSizes and helper->sendOffsets to be ON HOST
+ * helper->sendBuf data is ON DEVICE
+ */
+void NeighborCollectiveExchangeEngine::_startData(ExchangeEntity *helper, Messages& msg, cudaStream_t stream)
+{
+    const int nEdges = (int) edge2sendFragment_.size();
+
+    mTimer tm;
+    tm.start();
+    MPI_Check( MPI_Wait(&msg.sizesRequest, MPI_STATUS_IGNORE) );
+    debug("Waiting for sizes of '%s' took %f ms", helper->getCName(), tm.elapsed());
+
+    // Prepare offsets and resize
+    const auto rSizes = helper->recv.sizes.hostPtr();
+    helper->recv.sizes.clearHost();
+    for (int e = 0; e < nEdges; ++e)
+        rSizes[edge2recvFragment_[e]] = msg.recvSizes[e];
+
+    helper->computeRecvOffsets();
+    helper->resizeRecvBuf();
+
+    const auto sSizesBytes   = helper->send.sizesBytes  .hostPtr();
+    const auto sOffsetsBytes = helper->send.offsetsBytes.hostPtr();
+    const auto rSizesBytes   = helper->recv.sizesBytes  .hostPtr();
+    const auto rOffsetsBytes = helper->recv.offsetsBytes.hostPtr();
+
+    msg.sendCounts.resize(nEdges);
+    msg.sendDispls.resize(nEdges);
+    msg.recvCounts.resize(nEdges);
+    msg.recvDispls.resize(nEdges);
+
+    for (int e = 0; e < nEdges; ++e)
+    {
+        const int sendFragId = edge2sendFragment_[e];
+        const int recvFragId = edge2recvFragment_[e];
+
+        msg.sendCounts[e] = (int) sSizesBytes  [sendFragId];
+        msg.sendDispls[e] = (int) sOffsetsBytes[sendFragId];
+        msg.recvCounts[e] = (int) rSizesBytes  [recvFragId];
+        msg.recvDispls[e] = (int) rOffsetsBytes[recvFragId];
+    }
+
+    if (!gpuAwareMPI_)
+        helper->send.buffer.downloadFromDevice(stream);
+
+    auto sendPtr = gpuAwareMPI_ ? helper->send.buffer.devPtr() : helper->send.buffer.hostPtr();
+    auto recvPtr = gpuAwareMPI_ ? helper->recv.buffer.devPtr() : helper->recv.buffer.hostPtr();
+
+    MPI_Check( MPI_Ineighbor_alltoallv(sendPtr, msg.sendCounts.data(), msg.sendDispls.data(), MPI_BYTE,
+                                       recvPtr, msg.recvCounts.data(), msg.recvDispls.data(), MPI_BYTE,
+                                       graphComm_, &msg.dataRequest) );
+
+    debug("Started neighbourhood exchange of %d '%s' entities",
+          helper->recv.offsets[fragment_mapping::numFragments], helper->getCName());
+}
+
+/**
+ * helper->recvBuf will contain all the data, ON DEVICE already
+ */
+void NeighborCollectiveExchangeEngine::_wait(ExchangeEntity *helper, Messages& msg, cudaStream_t stream)
+{
+    mTimer tm;
+    tm.start();
+    MPI_Check( MPI_Wait(&msg.dataRequest, MPI_STATUS_IGNORE) );
+    const double waitTime = tm.elapsed();
+
+    helper->recv.uploadInfosToDevice(stream);
+    if (!gpuAwareMPI_)
+        helper->recv.buffer.uploadToDevice(stream);
+
+    debug("Completed neighbourhood exchange for '%s', waiting took %f ms", helper->getCName(), waitTime);
+}
+
+} // namespace mirheo
@@ -0,0 +1,67 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include "interface.h"
+
+#include <mpi.h>
+#include <vector>
+
+namespace mirheo
+{
+
+class ExchangeEntity;
+
+/** \brief Engine implementing the communication with MPI neighbourhood collectives.
+
+    A distributed graph topology is built from the cartesian communicator: every rank has one
+    edge per neighbouring fragment (26 in 3D).
+    All the messages of one exchange entity are then communicated with a single collective call,
+    which lets the MPI library aggregate them:
+    - init() prepares the data into buffers and starts a non-blocking exchange of the sizes
+      (\c MPI_Ineighbor_alltoall); once the sizes are known, it allocates the recv buffers and starts
+      the exchange of the data (\c MPI_Ineighbor_alltoallv).
+    - finalize() waits for the communication to finish and unpacks the data.
+
+    Several edges may connect the same pair of ranks (e.g. with only two ranks along one direction).
+    The receive edges are therefore ordered by the fragment id of the sender, so that the n-th message
+    between two ranks always corresponds to the same fragment on both sides.
+ */
+class NeighborCollectiveExchangeEngine : public ExchangeEngine
+{
+public:
+    /** \brief Construct a NeighborCollectiveExchangeEngine.
+        \param exchanger The class responsible to pack and unpack the data.
+        \param comm The cartesian communicator that represents the simulation domain.
+        \param gpuAwareMPI \c true to enable RDMA implementation. Only works if the MPI library has this feature implemented.
+     */
+    NeighborCollectiveExchangeEngine(std::unique_ptr<Exchanger>&& exchanger, MPI_Comm comm, bool gpuAwareMPI);
+    ~NeighborCollectiveExchangeEngine();
+
+    void init(cudaStream_t stream)     override;
+    void finalize(cudaStream_t stream) override;
+
+private:
+    /// Counts and displacements of the collective calls for one exchange entity, in edge order
+    struct Messages
+    {
+        std::vector<int> sendSizes, recvSizes; ///< number of entities per edge
+        std::vector<int> sendCounts, sendDispls; ///< bytes per edge
+        std::vector<int> recvCounts, recvDispls; ///< bytes per edge
+        MPI_Request sizesRequest {MPI_REQUEST_NULL};
+        MPI_Request dataRequest  {MPI_REQUEST_NULL};
+    };
+
+    void _startSizes(ExchangeEntity *helper, Messages& msg);
+    void _startData (ExchangeEntity *helper, Messages& msg, cudaStream_t stream);
+    void _wait      (ExchangeEntity *helper, Messages& msg, cudaStream_t stream);
+
+private:
+    std::vector<int> edge2sendFragment_; ///< fragment sent through each destination edge
+    std::vector<int> edge2recvFragment_; ///< fragment received through each source edge
+
+    bool gpuAwareMPI_;
+    MPI_Comm graphComm_;
+    std::vector<Messages> messages_; ///< one per exchange entity
+};
+
+} // namespace mirheo
@@ -0,0 +1,284 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "execution_backend.h"
+
+#include <mirheo/core/logger.h>
+
+namespace mirheo
+{
+
+ExecutionBackend::~ExecutionBackend() = default;
+
+//================================================================================================
+// CUDA streams
+//================================================================================================
+
+CudaStreamBackend::CudaStreamBackend()
+{
+    CUDA_Check( cudaDeviceGetStreamPriorityRange(&cudaPriorityLow_, &cudaPriorityHigh_) );
+}
+
+CudaStreamBackend::~CudaStreamBackend()
+{
+    auto destroyStreams = [](std::queue<cudaStream_t>& streams)
+    {
+        while (!streams.empty())
+        {
+            CUDA_Check( cudaStreamDestroy(streams.front()) );
+            streams.pop();
+        }
+    };
+
+    destroyStreams(streamsLo_);
+    destroyStreams(streamsHi_);
+}
+
+void CudaStreamBackend::launch(JobID id, const std::string& label, bool highPriority, Work work)
+{
+    auto streams = highPriority ? &streamsHi_ : &streamsLo_;
+    const int priority = highPriority ? cudaPriorityHigh_ : cudaPriorityLow_;
+
+    cudaStream_t stream;
+    if (streams->empty())
+    {
+        CUDA_Check( cudaStreamCreateWithPriority(&stream, cudaStreamNonBlocking, priority) );
+    }
+    else
+    {
+        stream = streams->front();
+        streams->pop();
+    }
+
+    debug("Executing group %s on stream %lld with priority %d",
+          label.c_str(), (long long)stream, priority);
+    workMap_.push_back({stream, id, &label, streams});
+
+    work(stream);
+}
+
+void CudaStreamBackend::waitCompleted(std::vector<JobID>& completed)
+{
+    const size_t initialSize = completed.size();
+
+    while (completed.size() == initialSize)
+        pollCompleted(completed);
+}
+
+void CudaStreamBackend::pollCompleted(std::vector<JobID>& completed)
+{
+    for (auto it = workMap_.begin(); it != workMap_.end(); )
+    {
+        const auto result = cudaStreamQuery(it->stream);
+        if ( result == cudaSuccess )
+        {
+            debug("Completed group %s ", it->label->c_str());
+
+            // Return freed stream back to the corresponding queue
+            it->streams->push(it->stream);
+            completed.push_back(it->id);
+            it = workMap_.erase(it);
+        }
+        else if (result == cudaErrorNotReady)
+        {
+            ++it;
+        }
+        else
+        {
+            error("Group '%s' raised an error", it->label->c_str());
+            CUDA_Check( result );
+        }
+    }
+}
+
+void CudaStreamBackend::synchronize()
+{
+    CUDA_Check( cudaDeviceSynchronize() );
+}
+
+//================================================================================================
+// Thread pool
+//================================================================================================
+
+static int getDefaultNumThreads()
+{
+    const int n = static_cast<int>(std::thread::hardware_concurrency());
+    return n > 0 ? n : 1;
+}
+
+ThreadPoolBackend::ThreadPoolBackend(int nthreads, bool useStreams) :
+    useStreams_(useStreams)
+{
+    if (nthreads <= 0)
+        nthreads = getDefaultNumThreads();
+
+    for (int i = 0; i < nthreads; ++i)
+    {
+        auto w = std::make_unique<Worker>();
+        if (useStreams_)
+            CUDA_Check( cudaStreamCreateWithFlags(&w->stream, cudaStreamNonBlocking) );
+        workers_.push_back(std::move(w));
+    }
+
+    // start the threads only once all workers exist, since they may steal from each other
+    for (int i = 0; i < nthreads; ++i)
+        workers_[i]->thread = std::thread([this, i]() {_workerLoop(i);});
+
+    debug("Created a thread pool with %d workers", nthreads);
+}
+
+ThreadPoolBackend::~ThreadPoolBackend()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stop_ = true;
+    }
+    sleepCv_.notify_all();
+
+    for (auto& w : workers_)
+    {
+        w->thread.join();
+        if (useStreams_)
+            CUDA_Check( cudaStreamDestroy(w->stream) );
+    }
+}
+
+int ThreadPoolBackend::getNumThreads() const
+{
+    return static_cast<int>(workers_.size());
+}
+
+void ThreadPoolBackend::launch(JobID id, const std::string& label, bool highPriority, Work work)
+{
+    const int workerId = nextWorker_;
+    nextWorker_ = (nextWorker_ + 1) % getNumThreads();
+
+    debug("Executing group %s on worker %d with %s priority",
+          label.c_str(), workerId, highPriority ? "high" : "low");
+
+    {
+        auto& w = *workers_[workerId];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        w.queues[highPriority ? 0 : 1].push_back({id, std::move(work)});
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        ++pending_;
+    }
+    sleepCv_.notify_one();
+}
+
+bool ThreadPoolBackend::_tryPop(int workerId, Job& job)
+{
+    const int n = getNumThreads();
+
+    for (int priority = 0; priority < 2; ++priority)
+    {
+        // own jobs first, most recent first
+        {
+            auto& w = *workers_[workerId];
+            std::lock_guard<std::mutex> lock(w.mutex);
+            auto& q = w.queues[priority];
+            if (!q.empty())
+            {
+                job = std::move(q.back());
+                q.pop_back();
+                return true;
+            }
+        }
+
+        // steal the oldest job of the other workers
+        for (int i = 1; i < n; ++i)
+        {
+            auto& w = *workers_[(workerId + i) % n];
+            std::lock_guard<std::mutex> lock(w.mutex);
+            auto& q = w.queues[priority];
+            if (!q.empty())
+            {
+                job = std::move(q.front());
+                q.pop_front();
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPoolBackend::_workerLoop(int workerId)
+{
+    const cudaStream_t stream = workers_[workerId]->stream;
+
+    while (true)
+    {
+        Job job;
+        if (_tryPop(workerId, job))
+        {
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex_);
+                --pending_;
+            }
+
+            std::exception_ptr exception;
+            try
+            {
+                job.work(stream);
+                if (useStreams_)
+                    CUDA_Check( cudaStreamSynchronize(stream) );
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+            _complete(job.id, exception);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepCv_.wait(lock, [this]() {return stop_ || pending_ > 0;});
+
+        if (stop_ && pending_ == 0)
+            return;
+    }
+}
+
+void ThreadPoolBackend::_complete(JobID id, std::exception_ptr exception)
+{
+    {
+        std::lock_guard<std::mutex> lock(completedMutex_);
+        completed_.push_back(id);
+        if (exception && !exception_)
+            exception_ = exception;
+    }
+    completedCv_.notify_one();
+}
+
+void ThreadPoolBackend::waitCompleted(std::vector<JobID>& completed)
+{
+    std::unique_lock<std::mutex> lock(completedMutex_);
+    completedCv_.wait(lock, [this]() {return !completed_.empty();});
+    _takeCompleted(completed);
+}
+
+void ThreadPoolBackend::pollCompleted(std::vector<JobID>& completed)
+{
+    std::lock_guard<std::mutex> lock(completedMutex_);
+    _takeCompleted(completed);
+}
+
+void ThreadPoolBackend::_takeCompleted(std::vector<JobID>& completed)
+{
+    completed.insert(completed.end(), completed_.begin(), completed_.end());
+    completed_.clear();
+
+    if (exception_)
+    {
+        auto e = exception_;
+        exception_ = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void ThreadPoolBackend::synchronize()
+{
+    // Jobs are completed only after their stream was synchronized: nothing left to wait for.
+}
+
+} // namespace mirheo
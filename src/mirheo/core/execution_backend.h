@@ -0,0 +1,172 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cuda_runtime.h>
+
+namespace mirheo
+{
+
+/** \brief Execution resource used by the TaskScheduler to run the tasks of a compiled graph.
+
+    The scheduler resolves the dependencies and launches the ready jobs through launch().
+    It then waits for the completion of (some of) these jobs with waitCompleted() to release the
+    jobs that depend on them.
+    All methods are called from the thread that owns the TaskScheduler.
+ */
+class ExecutionBackend
+{
+public:
+    /// Represents the function performed by a job. Will be executed on the given stream.
+    using Work = std::function<void(cudaStream_t)>;
+    /// Identifier of a job, chosen by the caller.
+    using JobID = int;
+
+    virtual ~ExecutionBackend();
+
+    /** \brief Start the execution of a job.
+        \param [in] id Identifier of the job, reported by waitCompleted() when the job is completed.
+        \param [in] label Name of the job, for logging. Must stay alive until the job is completed.
+        \param [in] highPriority Whether the job must be executed with high priority.
+        \param [in] work The function to execute.
+     */
+    virtual void launch(JobID id, const std::string& label, bool highPriority, Work work) = 0;
+
+    /** \brief Block until at least one of the launched jobs is completed.
+        \param [out] completed The ids of the completed jobs are appended to this list.
+
+        Every launched job is reported exactly once.
+        Must not be called when no job is in flight.
+     */
+    virtual void waitCompleted(std::vector<JobID>& completed) = 0;
+
+    /** \brief Report the jobs that completed so far, without blocking.
+        \param [out] completed The ids of the completed jobs are appended to this list.
+
+        Every launched job is reported exactly once, by either this method or waitCompleted().
+     */
+    virtual void pollCompleted(std::vector<JobID>& completed) = 0;
+
+    /// Block until all work submitted by the jobs (including asynchronous device work) is done.
+    virtual void synchronize() = 0;
+};
+
+
+/** \brief Execute the jobs on concurrent CUDA streams.
+
+    The job functions are called on the calling thread, and are expected to submit asynchronous work
+    on the given stream. A job is completed when all the work on its stream is done.
+    Streams are reused across jobs; the high priority jobs are executed on high priority streams.
+ */
+class CudaStreamBackend : public ExecutionBackend
+{
+public:
+    CudaStreamBackend();
+    ~CudaStreamBackend();
+
+    void launch(JobID id, const std::string& label, bool highPriority, Work work) override;
+    void waitCompleted(std::vector<JobID>& completed) override;
+    void pollCompleted(std::vector<JobID>& completed) override;
+    void synchronize() override;
+
+private:
+    struct InFlight
+    {
+        cudaStream_t stream;
+        JobID id;
+        const std::string *label;
+        std::queue<cudaStream_t> *streams;
+    };
+
+    std::queue<cudaStream_t> streamsLo_, streamsHi_;
+    int cudaPriorityLow_, cudaPriorityHigh_;
+    std::vector<InFlight> workMap_;
+};
+
+
+/** \brief Execute the jobs on a pool of host threads with work stealing.
+
+    Each worker owns two deques of jobs (high and low priority). New jobs are distributed
+    in a round robin fashion over the workers. An idle worker takes the most recent job of its own
+    deques, or steals the oldest job of another worker. High priority jobs are always taken before
+    low priority ones, including when stealing.
+
+    By default the jobs receive the null stream: this is suited for host-only jobs and does not require a GPU.
+    Optionally, every worker owns a CUDA stream, which is synchronized after each job; a job is then completed
+    when its function returned and its device work is done.
+
+    An exception thrown by a job is rethrown by waitCompleted().
+
+    \rst
+    .. note::
+        This backend is not used by Simulation, Postprocess or Mirheo, and cannot be selected from them:
+        the tasks of a time step call MPI and the CUDA runtime from the thread that owns the scheduler,
+        and are not safe to run on other threads.
+        It serves host-only task graphs, e.g. in the unit tests of the TaskScheduler.
+    \endrst
+ */
+class ThreadPoolBackend : public ExecutionBackend
+{
+public:
+    /** \brief Construct a ThreadPoolBackend.
+        \param [in] nthreads Number of worker threads. If not positive, uses the number of hardware threads.
+        \param [in] useStreams If \c true, create one CUDA stream per worker.
+     */
+    ThreadPoolBackend(int nthreads, bool useStreams = false);
+    ~ThreadPoolBackend();
+
+    void launch(JobID id, const std::string& label, bool highPriority, Work work) override;
+    void waitCompleted(std::vector<JobID>& completed) override;
+    void pollCompleted(std::vector<JobID>& completed) override;
+    void synchronize() override;
+
+    /// \return the number of worker threads
+    int getNumThreads() const;
+
+private:
+    struct Job
+    {
+        JobID id;
+        Work work;
+    };
+
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Job> queues[2]; ///< 0: high priority; 1: low priority
+        cudaStream_t stream {nullptr};
+        std::thread thread;
+    };
+
+    bool _tryPop(int workerId, Job& job);
+    void _workerLoop(int workerId);
+    void _complete(JobID id, std::exception_ptr exception);
+    void _takeCompleted(std::vector<JobID>& completed); ///< requires completedMutex_
+
+private:
+    const bool useStreams_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    int nextWorker_ {0};
+
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCv_;
+    int pending_ {0};   ///< number of jobs queued but not taken by a worker; protected by sleepMutex_
+    bool stop_ {false}; ///< protected by sleepMutex_
+
+    std::mutex completedMutex_;
+    std::condition_variable completedCv_;
+    std::vector<JobID> completed_;
+    std::exception_ptr exception_;
+};
+
+} // namespace mirheo
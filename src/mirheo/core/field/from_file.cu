@@ -1,12 +1,11 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #include "from_file.h"
+#include "from_file_io.h"
 
 #include <cassert>
-#include <fstream>
 #include <texture_types.h>
 #include <mirheo/core/utils/kernel_launch.h>
 #include <mirheo/core/utils/cuda_common.h>
-#include <mirheo/core/utils/mpi_types.h>
 
 namespace mirheo {
 namespace interpolate_kernels {
@@ -84,179 +83,8 @@ __global__ void cubicInterpolate3D(const T *in, int3 inDims, float3 inH,
 } // interpolate_kernels
 
 
-struct HeaderInfo
-{
-    int3 resolution;
-    float3 extents;
-    int64_t fullSize_byte;
-    int64_t endHeader_byte;
-};
-
 inline auto multiplyComps(int3 v) {return v.x * v.y * v.z;}
 
-inline int getRank(const MPI_Comm& comm)
-{
-    int rank;
-    MPI_Check( MPI_Comm_rank(comm, &rank) );
-    return rank;
-}
-
-inline int getNranks(const MPI_Comm& comm)
-{
-    int size;
-    MPI_Check( MPI_Comm_size(comm, &size) );
-    return size;
-}
-
-template<class T>
-static HeaderInfo readHeader(const std::string& fileName, const MPI_Comm& comm)
-{
-    HeaderInfo info;
-    constexpr int root = 0;
-
-    if (getRank(comm) == root)
-    {
-        std::ifstream file(fileName);
-        if (!file.good())
-            die("'%s': file not found or not accessible", fileName.c_str());
-
-        auto fstart = file.tellg();
-
-        file >> info.extents.x >> info.extents.y >> info.extents.z >>
-            info.resolution.x >> info.resolution.y >> info.resolution.z;
-        info.fullSize_byte = (int64_t) multiplyComps(info.resolution) * sizeof(T);
-
-        info("Using field file '%s' of size %.2fx%.2fx%.2f and resolution %dx%dx%d",
-             fileName.c_str(), info.extents.x, info.extents.y, info.extents.z,
-             info.resolution.x, info.resolution.y, info.resolution.z);
-
-        file.seekg( 0, std::ios::end );
-        auto fend = file.tellg();
-
-        info.endHeader_byte = (fend - fstart) - info.fullSize_byte;
-
-        file.close();
-    }
-
-    MPI_Check( MPI_Bcast(&info.extents,        3, MPI_FLOAT,     root, comm) );
-    MPI_Check( MPI_Bcast(&info.resolution,     3, MPI_INT,       root, comm) );
-    MPI_Check( MPI_Bcast(&info.fullSize_byte,  1, MPI_INT64_T,   root, comm) );
-    MPI_Check( MPI_Bcast(&info.endHeader_byte, 1, MPI_INT64_T,   root, comm) );
-
-    return info;
-}
-
-static std::vector<float> readScalarField(const std::string& fileName,
-                                          const MPI_Comm& comm,
-                                          const HeaderInfo& info)
-{
-    const int rank   = getRank  (comm);
-    const int nranks = getNranks(comm);
-
-    // Read part and allgather
-    const int64_t readPerProc_byte = (info.fullSize_byte + nranks - 1) / (int64_t)nranks;
-    std::vector<char> readBuffer(readPerProc_byte);
-
-    // Limits in bytes
-    const int64_t readStart = readPerProc_byte * rank + info.endHeader_byte;
-    const int64_t readEnd   = std::min( readStart + readPerProc_byte, info.fullSize_byte + info.endHeader_byte);
-
-    MPI_File fh;
-    MPI_Status status;
-    MPI_Check( MPI_File_open(comm, fileName.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) );  // TODO: MPI_Info
-    MPI_Check( MPI_File_read_at_all(fh, readStart, readBuffer.data(), static_cast<int>(readEnd - readStart), MPI_BYTE, &status) );
-    // TODO: check that we read just what we asked
-    // MPI_Get_count only return int though
-
-    const size_t n = readPerProc_byte * nranks / sizeof(float); // May be bigger than fullSdfSize, to make gather easier
-    std::vector<float> fullSdfData(n);
-    MPI_Check( MPI_Allgather(readBuffer.data(), static_cast<int>(readPerProc_byte), MPI_BYTE,
-                             fullSdfData.data(), static_cast<int>(readPerProc_byte), MPI_BYTE, comm) );
-
-    MPI_Check( MPI_File_close(&fh) );
-
-    return fullSdfData;
-}
-
-
-static std::vector<float4> readVectorField(const std::string& fileName,
-                                           const MPI_Comm& comm,
-                                           const HeaderInfo& info)
-{
-    const int rank   = getRank  (comm);
-    const int nranks = getNranks(comm);
-
-    // Read part and allgather
-    const int64_t readPerProc_byte = (info.fullSize_byte + nranks - 1) / (int64_t)nranks;
-    std::vector<char> readBuffer(readPerProc_byte);
-
-    // Limits in bytes
-    const int64_t readStart = readPerProc_byte * rank + info.endHeader_byte;
-    const int64_t readEnd   = std::min( readStart + readPerProc_byte, info.fullSize_byte + info.endHeader_byte);
-
-    MPI_File fh;
-    MPI_Status status;
-    MPI_Check( MPI_File_open(comm, fileName.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) );  // TODO: MPI_Info
-    MPI_Check( MPI_File_read_at_all(fh, readStart, readBuffer.data(), static_cast<int>(readEnd - readStart), MPI_BYTE, &status) );
-    // TODO: check that we read just what we asked
-    // MPI_Get_count only return int though
-
-    const size_t n = readPerProc_byte * nranks / sizeof(float4); // May be bigger than fullSdfSize, to make gather easier
-    std::vector<float4> fullFieldData(n);
-    MPI_Check( MPI_Allgather(readBuffer.data(), static_cast<int>(readPerProc_byte), MPI_BYTE,
-                             fullFieldData.data(), static_cast<int>(readPerProc_byte), MPI_BYTE, comm) );
-
-    MPI_Check( MPI_File_close(&fh) );
-
-    return fullFieldData;
-}
-
-template<class T>
-struct LocalFieldPiece
-{
-    PinnedBuffer<T> data;
-    float3 offset;
-    int3 resolution;
-};
-
-template<class T>
-static LocalFieldPiece<T> prepareRelevantFieldPiece(const std::vector<T>& fullFieldData,
-                                                    float3 extendedDomainStart, float3 extendedDomainSize,
-                                                    float3 initialH, int3 initialResolution)
-{
-    LocalFieldPiece<T> fieldPiece;
-    // Find your relevant chunk of data
-    // We cannot send big files directly, so we'll carve a piece now
-
-    constexpr int margin = 3; // +2 from cubic interpolation, +1 from possible round-off errors
-    const int3 startId = make_int3( math::floor( extendedDomainStart                     / initialH) ) - margin;
-    const int3 endId   = make_int3( math::ceil ((extendedDomainStart+extendedDomainSize) / initialH) ) + margin;
-
-    const float3 startInLocalCoord = make_float3(startId)*initialH - (extendedDomainStart + 0.5*extendedDomainSize);
-
-    fieldPiece.offset = -0.5*extendedDomainSize - startInLocalCoord;
-    fieldPiece.resolution = endId - startId;
-
-    fieldPiece.data.resize_anew( multiplyComps(fieldPiece.resolution) );
-
-    auto locFieldDataPtr = fieldPiece.data.hostPtr();
-
-    for (int k = 0; k < fieldPiece.resolution.z; ++k) {
-        for (int j = 0; j < fieldPiece.resolution.y; ++j) {
-            for (int i = 0; i < fieldPiece.resolution.x; ++i) {
-                const int origIx = (i+startId.x + initialResolution.x) % initialResolution.x;
-                const int origIy = (j+startId.y + initialResolution.y) % initialResolution.y;
-                const int origIz = (k+startId.z + initialResolution.z) % initialResolution.z;
-
-                const auto dstId = (k*fieldPiece.resolution.y + j)*fieldPiece.resolution.x + i;
-                const auto srcId = (origIz*initialResolution.y + origIy)*initialResolution.x + origIx;
-                locFieldDataPtr[ dstId ] = fullFieldData[ srcId ];
-            }
-        }
-    }
-    return fieldPiece;
-}
-
 ScalarFieldFromFile::ScalarFieldFromFile(const MirState *state, std::string name,
                                          std::string fieldFileName, real3 h, real3 margin) :
     ScalarField(state, name, h, margin),
@@ -281,21 +109,19 @@ void ScalarFieldFromFile::setup(const MPI_Comm& comm)
     CUDA_Check( cudaDeviceSynchronize() );
 
     // Read header
-    auto headerInfo = readHeader<float>(fieldFileName_, comm);
+    auto headerInfo = from_file_io::readHeader<float>(fieldFileName_, comm);
     const float3 initialH = make_float3(domain.globalSize) / make_float3(headerInfo.resolution-1);
 
-    // Read heavy data
-    const auto fullScalarFieldData = readScalarField(fieldFileName_, comm, headerInfo);
-
     const float3 scale3 = make_float3(domain.globalSize) / headerInfo.extents;
     if ( !componentsAreEqual(scale3) )
         die("Sdf size and domain size mismatch");
     const float lenScalingFactor = (scale3.x + scale3.y + scale3.z) / 3;
 
-    auto scalarFieldPiece = prepareRelevantFieldPiece(fullScalarFieldData,
-                                                      make_float3(domain.globalStart - margin3_),
-                                                      make_float3(extendedDomainSize_),
-                                                      initialH, headerInfo.resolution);
+    // Read heavy data: only the part relevant to this rank
+    auto scalarFieldPiece = from_file_io::readFieldPiece<float>(fieldFileName_, comm, headerInfo,
+                                                                make_float3(domain.globalStart - margin3_),
+                                                                make_float3(extendedDomainSize_),
+                                                                initialH);
 
     // Interpolate
     DeviceBuffer<float> fieldRawData (multiplyComps(resolution_));
@@ -340,20 +166,19 @@ void VectorFieldFromFile::setup(const MPI_Comm& comm)
     CUDA_Check( cudaDeviceSynchronize() );
 
     // Read header
-    auto headerInfo = readHeader<float4>(fieldFileName_, comm);
+    auto headerInfo = from_file_io::readHeader<float4>(fieldFileName_, comm);
     const float3 initialH = make_float3(domain.globalSize) / make_float3(headerInfo.resolution-1);
 
-    // Read heavy data
-    const auto fullFieldData = readVectorField(fieldFileName_, comm, headerInfo);
-
     const float3 scale3 = make_float3(domain.globalSize) / headerInfo.extents;
     if ( !componentsAreEqual(scale3) )
         die("Sdf size and domain size mismatch");
     const float lenScalingFactor = (scale3.x + scale3.y + scale3.z) / 3;
 
-    auto fieldPiece = prepareRelevantFieldPiece(fullFieldData,
-                                                make_float3(domain.globalStart - margin3_), make_float3(extendedDomainSize_),
-                                                initialH, headerInfo.resolution);
+    // Read heavy data: only the part relevant to this rank
+    auto fieldPiece = from_file_io::readFieldPiece<float4>(fieldFileName_, comm, headerInfo,
+                                                           make_float3(domain.globalStart - margin3_),
+                                                           make_float3(extendedDomainSize_),
+                                                           initialH);
 
     // Interpolate
     DeviceBuffer<float4> fieldRawData (multiplyComps(resolution_));
@@ -0,0 +1,258 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "from_file_io.h"
+
+#include <mirheo/core/logger.h>
+#include <mirheo/core/utils/helper_math.h>
+
+#include <fstream>
+
+namespace mirheo
+{
+namespace from_file_io
+{
+
+inline int64_t multiplyComps(int3 v) {return (int64_t) v.x * (int64_t) v.y * (int64_t) v.z;}
+
+inline int getRank(MPI_Comm comm)
+{
+    int rank;
+    MPI_Check( MPI_Comm_rank(comm, &rank) );
+    return rank;
+}
+
+template<class T>
+HeaderInfo readHeader(const std::string& fileName, MPI_Comm comm)
+{
+    HeaderInfo info;
+    constexpr int root = 0;
+
+    if (getRank(comm) == root)
+    {
+        std::ifstream file(fileName);
+        if (!file.good())
+            die("'%s': file not found or not accessible", fileName.c_str());
+
+        auto fstart = file.tellg();
+
+        file >> info.extents.x >> info.extents.y >> info.extents.z >>
+            info.resolution.x >> info.resolution.y >> info.resolution.z;
+        info.fullSize_byte = multiplyComps(info.resolution) * (int64_t) sizeof(T);
+
+        info("Using field file '%s' of size %.2fx%.2fx%.2f and resolution %dx%dx%d",
+             fileName.c_str(), info.extents.x, info.extents.y, info.extents.z,
+             info.resolution.x, info.resolution.y, info.resolution.z);
+
+        file.seekg( 0, std::ios::end );
+        auto fend = file.tellg();
+
+        info.endHeader_byte = (fend - fstart) - info.fullSize_byte;
+
+        file.close();
+    }
+
+    MPI_Check( MPI_Bcast(&info.extents,        3, MPI_FLOAT,     root, comm) );
+    MPI_Check( MPI_Bcast(&info.resolution,     3, MPI_INT,       root, comm) );
+    MPI_Check( MPI_Bcast(&info.fullSize_byte,  1, MPI_INT64_T,   root, comm) );
+    MPI_Check( MPI_Bcast(&info.endHeader_byte, 1, MPI_INT64_T,   root, comm) );
+
+    return info;
+}
+
+/// Index range of the grid points needed by the local domain, possibly out of [0, resolution)
+struct PieceBounds
+{
+    int3 startId, endId;
+    float3 offset;
+};
+
+static PieceBounds computePieceBounds(float3 extendedDomainStart, float3 extendedDomainSize, float3 initialH)
+{
+    constexpr int margin = 3; // +2 from cubic interpolation, +1 from possible round-off errors
+
+    PieceBounds b;
+    b.startId = make_int3( math::floor( extendedDomainStart                     / initialH) ) - margin;
+    b.endId   = make_int3( math::ceil ((extendedDomainStart+extendedDomainSize) / initialH) ) + margin;
+
+    const float3 startInLocalCoord = make_float3(b.startId)*initialH - (extendedDomainStart + 0.5f*extendedDomainSize);
+    b.offset = -0.5f*extendedDomainSize - startInLocalCoord;
+    return b;
+}
+
+static inline int wrap(int i, int n)
+{
+    return ((i % n) + n) % n;
+}
+
+template<class T>
+LocalFieldPiece<T> cropFieldPiece(const std::vector<T>& fullFieldData,
+                                  float3 extendedDomainStart, float3 extendedDomainSize,
+                                  float3 initialH, int3 initialResolution)
+{
+    const auto bounds = computePieceBounds(extendedDomainStart, extendedDomainSize, initialH);
+
+    LocalFieldPiece<T> fieldPiece;
+    fieldPiece.offset     = bounds.offset;
+    fieldPiece.resolution = bounds.endId - bounds.startId;
+    fieldPiece.data.resize_anew( multiplyComps(fieldPiece.resolution) );
+
+    auto locFieldDataPtr = fieldPiece.data.hostPtr();
+
+    for (int k = 0; k < fieldPiece.resolution.z; ++k) {
+        for (int j = 0; j < fieldPiece.resolution.y; ++j) {
+            for (int i = 0; i < fieldPiece.resolution.x; ++i) {
+                const int origIx = wrap(i + bounds.startId.x, initialResolution.x);
+                const int origIy = wrap(j + bounds.startId.y, initialResolution.y);
+                const int origIz = wrap(k + bounds.startId.z, initialResolution.z);
+
+                const auto dstId = ((int64_t) k*fieldPiece.resolution.y + j)*fieldPiece.resolution.x + i;
+                const auto srcId = ((int64_t) origIz*initialResolution.y + origIy)*initialResolution.x + origIx;
+                locFieldDataPtr[ dstId ] = fullFieldData[ srcId ];
+            }
+        }
+    }
+
+    fieldPiece.peakMemory_byte = (fullFieldData.size() + fieldPiece.data.size()) * sizeof(T);
+    return fieldPiece;
+}
+
+/** The grid indices needed along one direction.
+    The indices of the file are sorted, unique, and grouped in contiguous runs.
+ */
+struct AxisSelection
+{
+    std::vector<int> runStarts;  ///< first index of each run in the file
+    std::vector<int> runLengths; ///< length of each run
+    std::vector<int> localToRead; ///< for each index of the piece, its position within the read data
+    int numRead {0};             ///< number of indices read
+};
+
+static AxisSelection selectAxis(int start, int end, int n)
+{
+    std::vector<int> position(n, -1);
+    for (int i = start; i < end; ++i)
+        position[wrap(i, n)] = 0;
+
+    AxisSelection s;
+    for (int i = 0; i < n; ++i)
+    {
+        if (position[i] < 0)
+            continue;
+
+        position[i] = s.numRead++;
+
+        if (!s.runStarts.empty() && s.runStarts.back() + s.runLengths.back() == i)
+        {
+            ++s.runLengths.back();
+        }
+        else
+        {
+            s.runStarts .push_back(i);
+            s.runLengths.push_back(1);
+        }
+    }
+
+    for (int i = start; i < end; ++i)
+        s.localToRead.push_back(position[wrap(i, n)]);
+
+    return s;
+}
+
+/// Create a type selecting the runs of sel among n consecutive entries of type base, with an extent of n entries
+static MPI_Datatype createAxisType(const AxisSelection& sel, MPI_Datatype base, int n)
+{
+    MPI_Aint lb, extent;
+    MPI_Check( MPI_Type_get_extent(base, &lb, &extent) );
+
+    MPI_Datatype indexed, resized;
+    MPI_Check( MPI_Type_indexed((int) sel.runStarts.size(), sel.runLengths.data(), sel.runStarts.data(),
+                                base, &indexed) );
+    MPI_Check( MPI_Type_create_resized(indexed, 0, n * extent, &resized) );
+    MPI_Check( MPI_Type_free(&indexed) );
+    return resized;
+}
+
+template<class T>
+LocalFieldPiece<T> readFieldPiece(const std::string& fileName, MPI_Comm comm, const HeaderInfo& info,
+                                  float3 extendedDomainStart, float3 extendedDomainSize, float3 initialH)
+{
+    const auto bounds = computePieceBounds(extendedDomainStart, extendedDomainSize, initialH);
+    const int3 n = info.resolution;
+
+    const auto selx = selectAxis(bounds.startId.x, bounds.endId.x, n.x);
+    const auto sely = selectAxis(bounds.startId.y, bounds.endId.y, n.y);
+    const auto selz = selectAxis(bounds.startId.z, bounds.endId.z, n.z);
+
+    // File view: the cartesian product of the selected indices along each direction.
+    // The indices are increasing, hence the data is read in file order.
+    MPI_Datatype elementType, rowType, planeType, fileType;
+    MPI_Check( MPI_Type_contiguous(sizeof(T), MPI_BYTE, &elementType) );
+    MPI_Check( MPI_Type_commit(&elementType) );
+    rowType   = createAxisType(selx, elementType, n.x);
+    planeType = createAxisType(sely, rowType,     n.y);
+    fileType  = createAxisType(selz, planeType,   n.z);
+    MPI_Check( MPI_Type_commit(&fileType) );
+
+    const int64_t numRead = (int64_t) selx.numRead * sely.numRead * selz.numRead;
+    std::vector<T> readData(numRead);
+
+    MPI_File fh;
+    MPI_Status status;
+    MPI_Check( MPI_File_open(comm, fileName.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &fh) );
+    MPI_Check( MPI_File_set_view(fh, info.endHeader_byte, elementType, fileType, "native", MPI_INFO_NULL) );
+    MPI_Check( MPI_File_read_all(fh, readData.data(), static_cast<int>(numRead), elementType, &status) );
+    MPI_Check( MPI_File_close(&fh) );
+
+    int count;
+    MPI_Check( MPI_Get_count(&status, elementType, &count) );
+    if (count != numRead)
+        die("'%s': could only read %d grid values out of %lld", fileName.c_str(), count, (long long) numRead);
+
+    MPI_Check( MPI_Type_free(&fileType) );
+    MPI_Check( MPI_Type_free(&planeType) );
+    MPI_Check( MPI_Type_free(&rowType) );
+    MPI_Check( MPI_Type_free(&elementType) );
+
+    // Unfold the (possibly periodic) piece from the data read
+    LocalFieldPiece<T> fieldPiece;
+    fieldPiece.offset     = bounds.offset;
+    fieldPiece.resolution = bounds.endId - bounds.startId;
+    fieldPiece.data.resize_anew( multiplyComps(fieldPiece.resolution) );
+
+    auto locFieldDataPtr = fieldPiece.data.hostPtr();
+
+    for (int k = 0; k < fieldPiece.resolution.z; ++k) {
+        for (int j = 0; j < fieldPiece.resolution.y; ++j) {
+            for (int i = 0; i < fieldPiece.resolution.x; ++i) {
+                const auto dstId = ((int64_t) k*fieldPiece.resolution.y + j)*fieldPiece.resolution.x + i;
+                const auto srcId = ((int64_t) selz.localToRead[k]*sely.numRead + sely.localToRead[j])*selx.numRead + selx.localToRead[i];
+                locFieldDataPtr[ dstId ] = readData[ srcId ];
+            }
+        }
+    }
+
+    fieldPiece.peakMemory_byte = (readData.size() + fieldPiece.data.size()) * sizeof(T);
+
+    int64_t peakMemory = fieldPiece.peakMemory_byte;
+    MPI_Check( MPI_Allreduce(MPI_IN_PLACE, &peakMemory, 1, MPI_INT64_T, MPI_MAX, comm) );
+
+    info("Read %lld of %lld grid values from '%s'; peak host memory per rank: %.2f MB (%.2f MB for the whole grid)",
+         (long long) numRead, (long long) multiplyComps(n), fileName.c_str(),
+         static_cast<double>(peakMemory) / (1024.0 * 1024.0),
+         static_cast<double>(info.fullSize_byte) / (1024.0 * 1024.0));
+
+    return fieldPiece;
+}
+
+#define INSTANTIATE(T)                                                  \
+    template HeaderInfo readHeader<T>(const std::string&, MPI_Comm);   \
+    template LocalFieldPiece<T> readFieldPiece<T>(const std::string&, MPI_Comm, const HeaderInfo&, \
+                                                  float3, float3, float3); \
+    template LocalFieldPiece<T> cropFieldPiece<T>(const std::vector<T>&, float3, float3, float3, int3);
+
+INSTANTIATE(float)
+INSTANTIATE(float4)
+
+#undef INSTANTIATE
+
+} // namespace from_file_io
+} // namespace mirheo
@@ -0,0 +1,80 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <mirheo/core/containers.h>
+
+#include <cstdint>
+#include <mpi.h>
+#include <string>
+#include <vector>
+#include <vector_types.h>
+
+namespace mirheo
+{
+
+/// Helpers to read the grid files used by ScalarFieldFromFile and VectorFieldFromFile
+namespace from_file_io
+{
+
+/// The information contained in the header of a field file
+struct HeaderInfo
+{
+    int3 resolution;        ///< number of grid points in each direction
+    float3 extents;         ///< size of the domain covered by the grid
+    int64_t fullSize_byte;  ///< size of the grid data in bytes
+    int64_t endHeader_byte; ///< position of the grid data in the file, in bytes
+};
+
+/// The part of a field grid that is relevant to one rank
+template<class T>
+struct LocalFieldPiece
+{
+    PinnedBuffer<T> data; ///< grid values (x is the fast running index)
+    float3 offset;        ///< position of the first grid point relative to the start of the extended local domain
+    int3 resolution;      ///< number of grid points in each direction
+    size_t peakMemory_byte {0}; ///< host memory used while constructing the piece
+};
+
+/** \brief Read the header of a field file on the root rank and broadcast it.
+    \tparam T The type of the grid values.
+    \param [in] fileName The field file name.
+    \param [in] comm The communicator; the call is collective.
+    \return The header information.
+ */
+template<class T>
+HeaderInfo readHeader(const std::string& fileName, MPI_Comm comm);
+
+/** \brief Read the part of the grid that covers the given local domain, with periodic wrapping.
+    \tparam T The type of the grid values.
+    \param [in] fileName The field file name.
+    \param [in] comm The communicator; the call is collective.
+    \param [in] info The header of the file, see readHeader().
+    \param [in] extendedDomainStart The start of the local domain including margins, in global coordinates.
+    \param [in] extendedDomainSize The size of the local domain including margins.
+    \param [in] initialH The grid spacing of the file.
+    \return The local piece of the grid.
+
+    Every rank reads only the grid points it needs (plus a margin for the cubic interpolation),
+    through a MPI-IO file view.
+    The whole grid is never stored on a single rank.
+ */
+template<class T>
+LocalFieldPiece<T> readFieldPiece(const std::string& fileName, MPI_Comm comm, const HeaderInfo& info,
+                                  float3 extendedDomainStart, float3 extendedDomainSize, float3 initialH);
+
+/** \brief Extract the part of a full grid that covers the given local domain, with periodic wrapping.
+    \tparam T The type of the grid values.
+    \param [in] fullFieldData All the values of the grid.
+    \param [in] extendedDomainStart The start of the local domain including margins, in global coordinates.
+    \param [in] extendedDomainSize The size of the local domain including margins.
+    \param [in] initialH The grid spacing of \p fullFieldData.
+    \param [in] initialResolution The number of grid points of \p fullFieldData.
+    \return The local piece of the grid, same as readFieldPiece().
+ */
+template<class T>
+LocalFieldPiece<T> cropFieldPiece(const std::vector<T>& fullFieldData,
+                                  float3 extendedDomainStart, float3 extendedDomainSize,
+                                  float3 initialH, int3 initialResolution);
+
+} // namespace from_file_io
+} // namespace mirheo
@@ -0,0 +1,151 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "frozen_particles_cache.h"
+
+#include <mirheo/core/integrators/interface.h>
+#include <mirheo/core/interactions/interface.h>
+#include <mirheo/core/logger.h>
+#include <mirheo/core/pvs/particle_vector.h>
+#include <mirheo/core/utils/path.h>
+#include <mirheo/core/utils/strprintf.h>
+#include <mirheo/core/version.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace mirheo
+{
+
+static const std::string definitionFileName = "definition.txt";
+static const std::string checkpointFolder = "particles";
+
+static uint64_t hashString(const std::string& s)
+{
+    // FNV-1a
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (unsigned char c : s)
+        h = (h ^ c) * 0x100000001b3ULL;
+    return h;
+}
+
+FrozenParticlesCache::FrozenParticlesCache(MPI_Comm comm, const std::string& folder, const ParticleVector *pv,
+                                           const std::vector<std::shared_ptr<Interaction>>& interactions,
+                                           const Integrator *integrator, real numDensity, real dt, int nsteps) :
+    comm_(comm)
+{
+    if (folder.empty())
+        return;
+
+    const real3 L = pv->getState()->domain.globalSize;
+
+    // the name of the particle vector sets the seed of the initial conditions
+    definition_ = strprintf("mirheo %s frozen particles\n", Version::mir_version.c_str());
+    // the checkpoint stores the particles in the precision of real
+    definition_ += strprintf("real %zu bytes\n", sizeof(real));
+    definition_ += strprintf("pv '%s' mass %a\n", pv->getCName(), static_cast<double>(pv->getMassPerParticle()));
+    definition_ += strprintf("domain %a %a %a\n", static_cast<double>(L.x), static_cast<double>(L.y), static_cast<double>(L.z));
+    definition_ += strprintf("number_density %a dt %a nsteps %d\n", static_cast<double>(numDensity), static_cast<double>(dt), nsteps);
+
+    if (integrator->getDefinition().empty())
+    {
+        warn("Frozen particles cache disabled: the integrator '%s' has no definition", integrator->getCName());
+        return;
+    }
+    definition_ += "integrator " + integrator->getDefinition() + "\n";
+
+    for (const auto& interaction : interactions)
+    {
+        if (interaction->getDefinition().empty())
+        {
+            warn("Frozen particles cache disabled: the interaction '%s' has no definition", interaction->getCName());
+            return;
+        }
+        definition_ += "interaction " + interaction->getDefinition() + "\n";
+    }
+
+    path_ = makePath(joinPaths(folder, strprintf("%016llx", static_cast<unsigned long long>(hashString(definition_)))));
+    enabled_ = true;
+}
+
+bool FrozenParticlesCache::isEnabled() const
+{
+    return enabled_;
+}
+
+const std::string& FrozenParticlesCache::getPath() const
+{
+    return path_;
+}
+
+std::string FrozenParticlesCache::_readDefinition() const
+{
+    std::ifstream f(joinPaths(path_, definitionFileName));
+    if (!f.good())
+        return "";
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+bool FrozenParticlesCache::load(ParticleVector *pv) const
+{
+    if (!enabled_)
+        return false;
+
+    int rank;
+    MPI_Check( MPI_Comm_rank(comm_, &rank) );
+
+    int found = 0;
+    if (rank == 0)
+        found = _readDefinition() == definition_;
+    MPI_Check( MPI_Bcast(&found, 1, MPI_INT, 0, comm_) );
+
+    if (!found)
+    {
+        info("No entry in the frozen particles cache '%s'", path_.c_str());
+        return false;
+    }
+
+    info("Loading equilibrated particles for '%s' from the cache '%s'", pv->getCName(), path_.c_str());
+    pv->restart(comm_, makePath(joinPaths(path_, checkpointFolder)));
+    return true;
+}
+
+void FrozenParticlesCache::store(ParticleVector *pv) const
+{
+    if (!enabled_)
+        return;
+
+    int rank;
+    MPI_Check( MPI_Comm_rank(comm_, &rank) );
+
+    const std::string definitionFile = joinPaths(path_, definitionFileName);
+    const std::string particlesPath = makePath(joinPaths(path_, checkpointFolder));
+
+    // invalidate the entry first, so that an interrupted store never leaves a valid-looking entry
+    if (rank == 0)
+        std::remove(definitionFile.c_str());
+
+    if (!createFoldersCollective(comm_, particlesPath))
+    {
+        warn("Could not create the frozen particles cache folder '%s'", particlesPath.c_str());
+        return;
+    }
+
+    pv->checkpoint(comm_, particlesPath, 0);
+    MPI_Check( MPI_Barrier(comm_) );
+
+    if (rank == 0)
+    {
+        std::ofstream f(definitionFile);
+        f << definition_;
+        if (!f.good())
+            warn("Could not write '%s'", definitionFile.c_str());
+    }
+    MPI_Check( MPI_Barrier(comm_) );
+
+    info("Stored equilibrated particles for '%s' in the cache '%s'", pv->getCName(), path_.c_str());
+}
+
+} // namespace mirheo
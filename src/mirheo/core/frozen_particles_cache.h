@@ -0,0 +1,75 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <mirheo/core/datatypes.h>
+
+#include <memory>
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace mirheo
+{
+
+class Integrator;
+class Interaction;
+class ParticleVector;
+
+/** \brief Content-addressed on-disk cache of the equilibrated particles used to create frozen particles.
+
+    Creating frozen particles (see Mirheo::makeFrozenWallParticles() and Mirheo::makeFrozenRigidParticles())
+    runs a bulk equilibration that depends only on the interactions, the integrator, the number density,
+    the mass, the time step, the number of steps, the domain and the floating point precision.
+    The entries of the cache are keyed on the definitions of all these (see MirObject::getDefinition());
+    the walls and shapes are applied to the cached particles afterwards, so they are not part of the key.
+
+    Each entry is a folder that contains the particles in the checkpoint format and a text file with the full definition,
+    written last, which is compared on load to guard against hash collisions and incomplete entries.
+ */
+class FrozenParticlesCache
+{
+public:
+    /** \brief Construct a FrozenParticlesCache for one equilibration.
+        \param comm The communicator of the simulation ranks.
+        \param folder The root folder of the cache; an empty string disables the cache.
+        \param pv The particles to equilibrate; its name, mass and domain are part of the key.
+        \param interactions The interactions used to equilibrate the particles.
+        \param integrator The integrator used to equilibrate the particles.
+        \param numDensity The number density of the particles.
+        \param dt The equilibration time step.
+        \param nsteps The number of equilibration steps.
+
+        The cache is disabled with a warning if one of the interactions or the integrator has no definition.
+     */
+    FrozenParticlesCache(MPI_Comm comm, const std::string& folder, const ParticleVector *pv,
+                         const std::vector<std::shared_ptr<Interaction>>& interactions,
+                         const Integrator *integrator, real numDensity, real dt, int nsteps);
+
+    /// \return \c true if the cache can be used.
+    bool isEnabled() const;
+
+    /// \return The folder of the entry of this equilibration.
+    const std::string& getPath() const;
+
+    /** \brief Load the equilibrated particles from the cache; collective.
+        \param pv The particles to set.
+        \return \c true if a valid entry was found and loaded.
+     */
+    bool load(ParticleVector *pv) const;
+
+    /** \brief Store the equilibrated particles in the cache, replacing any existing entry; collective.
+        \param pv The equilibrated particles.
+     */
+    void store(ParticleVector *pv) const;
+
+private:
+    std::string _readDefinition() const;
+
+private:
+    MPI_Comm comm_;
+    bool enabled_ {false};
+    std::string definition_;
+    std::string path_;
+};
+
+} // namespace mirheo
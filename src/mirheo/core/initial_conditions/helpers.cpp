@@ -1,18 +1,18 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #include <functional>
 #include <random>
+#include <vector>
 
 #include <mirheo/core/logger.h>
 #include <mirheo/core/pvs/particle_vector.h>
 #include <mirheo/core/utils/common.h>
+#include <mirheo/core/utils/parallel_for.h>
 
 #include "helpers.h"
 
 namespace mirheo
 {
 
-using PositionFilter = std::function<bool(real3)>;
-
 static long genSeed(const MPI_Comm& comm, const std::string& name)
 {
     int rank;
@@ -37,7 +37,8 @@ static Particle genParticle(real3 h, int i, int j, int k, const DomainInfo& doma
     return p;
 }
 
-void setUniformParticles(real numberDensity, const MPI_Comm& comm, ParticleVector *pv, PositionFilter filterIn, cudaStream_t stream)
+void setUniformParticles(real numberDensity, const MPI_Comm& comm, ParticleVector *pv, PositionFilter filterIn, cudaStream_t stream,
+                         bool filterIsThreadSafe, int numThreads)
 {
     const auto domain = pv->getState()->domain;
 
@@ -54,12 +55,9 @@ void setUniformParticles(real numberDensity, const MPI_Comm& comm, ParticleVecto
     std::mt19937 gen(seed);
     std::uniform_real_distribution<float> udistr(0, 1); // use float to get the same refs for tests
 
-    double3 avgMomentum {0,0,0};
-    int mycount {0};
-
-    std::vector<real4> pos, vel;
-    pos.reserve(ncells.x * ncells.y * ncells.z * static_cast<int>(math::ceil(numPartsPerCell)));
-    vel.reserve(ncells.x * ncells.y * ncells.z * static_cast<int>(math::ceil(numPartsPerCell)));
+    // draw all the candidates first: the random stream is sequential
+    std::vector<Particle> candidates;
+    candidates.reserve(ncells.x * ncells.y * ncells.z * static_cast<int>(math::ceil(numPartsPerCell)));
 
     for (int i = 0; i < ncells.x; ++i) {
         for (int j = 0; j < ncells.y; ++j) {
@@ -70,23 +68,44 @@ void setUniformParticles(real numberDensity, const MPI_Comm& comm, ParticleVecto
                     ++nparts;
 
                 for (int p = 0; p < nparts; ++p)
-                {
-                    const Particle part = genParticle(h, i, j, k, domain, udistr, gen);
+                    candidates.push_back(genParticle(h, i, j, k, domain, udistr, gen));
+            }
+        }
+    }
 
-                    if (! filterIn(domain.local2global(part.r)))
-                        continue;
+    // the filter may be expensive (e.g. SDF walls, python functions): evaluate it in parallel when allowed
+    const int ncandidates = static_cast<int>(candidates.size());
+    std::vector<char> isInside(ncandidates);
 
-                    pos.push_back(part.r2Real4());
-                    vel.push_back(part.u2Real4());
+    if (!filterIsThreadSafe)
+        numThreads = 1;
 
-                    avgMomentum.x += part.u.x;
-                    avgMomentum.y += part.u.y;
-                    avgMomentum.z += part.u.z;
+    parallelFor(ncandidates, numThreads, [&](int i)
+    {
+        isInside[i] = filterIn(domain.local2global(candidates[i].r));
+    });
 
-                    mycount++;
-                }
-            }
-        }
+    double3 avgMomentum {0,0,0};
+    int mycount {0};
+
+    std::vector<real4> pos, vel;
+    pos.reserve(ncandidates);
+    vel.reserve(ncandidates);
+
+    for (int i = 0; i < ncandidates; ++i)
+    {
+        if (!isInside[i])
+            continue;
+
+        const Particle& part = candidates[i];
+        pos.push_back(part.r2Real4());
+        vel.push_back(part.u2Real4());
+
+        avgMomentum.x += part.u.x;
+        avgMomentum.y += part.u.y;
+        avgMomentum.z += part.u.z;
+
+        mycount++;
     }
 
     pv->local()->resize(mycount, stream);
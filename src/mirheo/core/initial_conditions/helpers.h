@@ -18,9 +18,17 @@ class ParticleVector;
     \param [in] numberDensity The target number density of particles to generate.
     \param [in] comm MPI communicator with Cartesian topology.
     \param [in,out] pv ParticleVector that will store the new particles.
-    \param [in] filterOut Indicator function that is true inside the considered domain.
+    \param [in] filterIn Indicator function that is true inside the considered domain.
     \param [in] stream The stream used to upload data.
+    \param [in] filterIsThreadSafe If \c false, \p filterIn is only called from the calling thread
+                                   (e.g. for filters implemented in python).
+    \param [in] numThreads Number of host threads used to evaluate the filter; the hardware concurrency if not positive.
+
+    The candidate particles are drawn serially, with the same random stream as the serial implementation;
+    only the evaluation of \p filterIn, usually the expensive part, is distributed over the host threads.
+    The generated particles thus do not depend on the number of threads.
  */
-void setUniformParticles(real numberDensity, const MPI_Comm& comm, ParticleVector *pv, PositionFilter filterOut, cudaStream_t stream);
+void setUniformParticles(real numberDensity, const MPI_Comm& comm, ParticleVector *pv, PositionFilter filterIn, cudaStream_t stream,
+                         bool filterIsThreadSafe = true, int numThreads = 0);
 
 } // namespace mirheo
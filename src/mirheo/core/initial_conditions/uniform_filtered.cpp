@@ -15,7 +15,9 @@ UniformFilteredIC::~UniformFilteredIC() = default;
 
 void UniformFilteredIC::exec(const MPI_Comm& comm, ParticleVector *pv, cudaStream_t stream)
 {
-    setUniformParticles(numDensity_, comm, pv, filter_, stream);
+    // the filter may be a python function
+    const bool filterIsThreadSafe = false;
+    setUniformParticles(numDensity_, comm, pv, filter_, stream, filterIsThreadSafe);
 }
 
 
@@ -16,6 +16,11 @@
 #include "vv.h"
 #include "vv_pol_chain.h"
 
+#include <mirheo/core/interactions/interface.h>
+#include <mirheo/core/utils/strprintf.h>
+
+#include <initializer_list>
+#include <string>
 #include <vector_types.h>
 
 #include <memory>
@@ -23,24 +28,41 @@
 namespace mirheo {
 namespace integrator_factory {
 
+namespace details
+{
+/// Set the definition of an integrator (see MirObject::setDefinition()) from its type and parameters.
+template <class T>
+inline std::shared_ptr<T> define(std::shared_ptr<T> integrator, const std::string& type, std::initializer_list<real> params)
+{
+    std::string definition = type;
+    for (auto p : params)
+        definition += strprintf(" %a", static_cast<double>(p));
+    integrator->setDefinition(definition);
+    return integrator;
+}
+} // namespace details
+
 inline std::shared_ptr<IntegratorMinimize>
 createMinimize(const MirState *state, const std::string& name, real maxDisplacement)
 {
-    return std::make_shared<IntegratorMinimize> (state, name, maxDisplacement);
+    return details::define(std::make_shared<IntegratorMinimize> (state, name, maxDisplacement),
+                           "minimize", {maxDisplacement});
 }
 
 inline std::shared_ptr<IntegratorVV<ForcingTermNone>>
 createVV(const MirState *state, const std::string& name)
 {
     ForcingTermNone forcing;
-    return std::make_shared<IntegratorVV<ForcingTermNone>> (state, name, forcing);
+    return details::define(std::make_shared<IntegratorVV<ForcingTermNone>> (state, name, forcing),
+                           "vv", {});
 }
 
 inline std::shared_ptr<IntegratorVV<ForcingTermConstDP>>
 createVV_constDP(const MirState *state, const std::string& name, real3 extraForce)
 {
     ForcingTermConstDP forcing(extraForce);
-    return std::make_shared<IntegratorVV<ForcingTermConstDP>> (state, name, forcing);
+    return details::define(std::make_shared<IntegratorVV<ForcingTermConstDP>> (state, name, forcing),
+                           "vv_const_dp", {extraForce.x, extraForce.y, extraForce.z});
 }
 
 inline std::shared_ptr<IntegratorVV<ForcingTermPeriodicPoiseuille>>
@@ -53,44 +75,53 @@ createVV_PeriodicPoiseuille(const MirState *state, const std::string& name, real
     else die("Direction can only be 'x' or 'y' or 'z'");
 
     ForcingTermPeriodicPoiseuille forcing(force, dir);
-    return std::make_shared<IntegratorVV<ForcingTermPeriodicPoiseuille>> (state, name, forcing);
+    return details::define(std::make_shared<IntegratorVV<ForcingTermPeriodicPoiseuille>> (state, name, forcing),
+                           "vv_periodic_poiseuille_" + direction, {force});
 }
 
 inline std::shared_ptr<IntegratorVVPolChain>
 createVVPolChain(const MirState *state, const std::string& name)
 {
-    return std::make_shared<IntegratorVVPolChain> (state, name);
+    return details::define(std::make_shared<IntegratorVVPolChain> (state, name),
+                           "vv_pol_chain", {});
 }
 
 
 inline std::shared_ptr<IntegratorConstOmega>
 createConstOmega(const MirState *state, const std::string& name, real3 center, real3 omega)
 {
-    return std::make_shared<IntegratorConstOmega> (state, name, center, omega);
+    return details::define(std::make_shared<IntegratorConstOmega> (state, name, center, omega),
+                           "const_omega", {center.x, center.y, center.z, omega.x, omega.y, omega.z});
 }
 
 inline std::shared_ptr<IntegratorShear>
 createShear(const MirState *state, const std::string& name, std::array<real,9> shear, real3 origin)
 {
-    return std::make_shared<IntegratorShear> (state, name, shear, origin);
+    return details::define(std::make_shared<IntegratorShear> (state, name, shear, origin),
+                           "shear", {shear[0], shear[1], shear[2], shear[3], shear[4], shear[5], shear[6], shear[7], shear[8],
+                                     origin.x, origin.y, origin.z});
 }
 
 inline std::shared_ptr<IntegratorShearPolChain>
 createShearPolChain(const MirState *state, const std::string& name, std::array<real,9> shear, real3 origin)
 {
-    return std::make_shared<IntegratorShearPolChain> (state, name, shear, origin);
+    return details::define(std::make_shared<IntegratorShearPolChain> (state, name, shear, origin),
+                           "shear_pol_chain", {shear[0], shear[1], shear[2], shear[3], shear[4], shear[5], shear[6], shear[7], shear[8],
+                                               origin.x, origin.y, origin.z});
 }
 
 inline std::shared_ptr<IntegratorTranslate>
 createTranslate(const MirState *state, const std::string& name, real3 velocity)
 {
-    return std::make_shared<IntegratorTranslate> (state, name, velocity);
+    return details::define(std::make_shared<IntegratorTranslate> (state, name, velocity),
+                           "translate", {velocity.x, velocity.y, velocity.z});
 }
 
 inline std::shared_ptr<IntegratorOscillate>
 createOscillating(const MirState *state, const std::string& name, real3 velocity, real period)
 {
-    return std::make_shared<IntegratorOscillate> (state, name, velocity, period);
+    return details::define(std::make_shared<IntegratorOscillate> (state, name, velocity, period),
+                           "oscillate", {velocity.x, velocity.y, velocity.z, period});
 }
 
 inline std::shared_ptr<IntegratorSubStepShardlowSweep>
@@ -103,14 +134,26 @@ createSubstepShardlowSweep(const MirState *state, const std::string& name, int s
 inline std::shared_ptr<IntegratorVVRigid>
 createRigidVV(const MirState *state, const std::string& name)
 {
-    return std::make_shared<IntegratorVVRigid> (state, name);
+    return details::define(std::make_shared<IntegratorVVRigid> (state, name),
+                           "rigid_vv", {});
 }
 
 inline std::shared_ptr<IntegratorSubStep>
 createSubStep(const MirState *state, const std::string& name, int substeps,
               const std::vector<Interaction*>& fastForces)
 {
-    return std::make_shared<IntegratorSubStep> (state, name, substeps, fastForces);
+    auto integrator = std::make_shared<IntegratorSubStep> (state, name, substeps, fastForces);
+
+    // only defined if all the fast forces are
+    std::string definition = strprintf("substep %d", substeps);
+    for (const auto *interaction : fastForces)
+    {
+        if (interaction->getDefinition().empty())
+            return integrator;
+        definition += " {" + interaction->getDefinition() + "}";
+    }
+    integrator->setDefinition(definition);
+    return integrator;
 }
 
 } // namespace integrator_factory
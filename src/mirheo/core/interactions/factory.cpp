@@ -13,6 +13,7 @@
 #include "rod/factory.h"
 
 #include <mirheo/core/logger.h>
+#include <mirheo/core/utils/strprintf.h>
 
 namespace mirheo {
 namespace interaction_factory {
@@ -97,7 +98,7 @@ std::shared_ptr<BaseMembraneInteraction>
 createInteractionMembrane(const MirState *state, std::string name,
                           std::string shearDesc, std::string bendingDesc,
                           std::string filterDesc, const MapParams& parameters,
-                          bool stressFree)
+                          bool stressFree, const std::string& assemblyDesc)
 {
     VarBendingParams varBendingParams;
     VarShearParams varShearParams;
@@ -122,6 +123,11 @@ createInteractionMembrane(const MirState *state, std::string name,
     else if (filterDesc == "by_type_id") varFilter = readFilterKeepByTypeId(desc);
     else                                 die("No such filter parameters: '%s'", filterDesc.c_str());
 
+    MembraneForceAssembly assembly;
+    if      (assemblyDesc == "vertex")  assembly = MembraneForceAssembly::Vertex;
+    else if (assemblyDesc == "element") assembly = MembraneForceAssembly::Element;
+    else                                die("No such membrane force assembly: '%s'", assemblyDesc.c_str());
+
     if (desc.exists<real>("grow_until") || desc.exists<real>("init_length_fraction"))
     {
         growUntil          = desc.read<real>("grow_until");
@@ -131,7 +137,7 @@ createInteractionMembrane(const MirState *state, std::string name,
     desc.checkAllRead();
     return createInteractionMembrane(
                                      state, name, commonPrms, varBendingParams, varShearParams, stressFree,
-                                     initLengthFraction, growUntil, varFilter);
+                                     initLengthFraction, growUntil, varFilter, assembly);
 }
 
 std::shared_ptr<ChainInteraction>
@@ -228,7 +234,10 @@ std::shared_ptr<BasePairwiseInteraction>
 createPairwiseInteraction(const MirState *state, std::string name, real rc, const std::string type, const MapParams& parameters)
 {
     ParametersWrap desc {parameters};
-    return createInteractionPairwise(state, name, rc, type, desc);
+    auto interaction = createInteractionPairwise(state, name, rc, type, desc);
+    interaction->setDefinition(strprintf("pairwise %s rc=%a %s", type.c_str(), static_cast<double>(rc),
+                                         ParametersWrap::toString(parameters).c_str()));
+    return interaction;
 }
 
 std::shared_ptr<ObjectBindingInteraction>
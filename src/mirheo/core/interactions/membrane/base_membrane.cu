@@ -33,8 +33,23 @@ __global__ void computeAreaAndVolume(OVviewWithAreaVolume view, MeshView mesh)
 
     a_v = warpReduce( a_v, [] (real a, real b) { return a+b; } );
 
+    // the partial sums of the warps are added in a fixed order so that the result is reproducible
+    __shared__ real2 warpSums[32];
+    const int warpId = threadIdx.x / warpSize;
+
     if (laneId() == 0)
+        warpSums[warpId] = a_v;
+
+    __syncthreads();
+
+    if (threadIdx.x == 0)
     {
+        const int nwarps = (blockDim.x + warpSize - 1) / warpSize;
+        for (int i = 1; i < nwarps; ++i)
+        {
+            a_v.x += warpSums[i].x;
+            a_v.y += warpSums[i].y;
+        }
         atomicAdd(&view.area_volumes[objId].x, a_v.x);
         atomicAdd(&view.area_volumes[objId].y, a_v.y);
     }
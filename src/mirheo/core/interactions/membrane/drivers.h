@@ -1,9 +1,7 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #pragma once
 
-#include "force_kernels/common.h"
-
-#include <mirheo/core/utils/cuda_rng.h>
+#include "element_forces.h"
 
 namespace mirheo
 {
@@ -11,48 +9,6 @@ namespace mirheo
 namespace membrane_forces_kernels
 {
 
-/// Device compatible structure that holds the parameters for area and volume constraints
-struct GPUConstraintMembraneParameters
-{
-    mReal totArea0;   ///< total area at equilibrium
-    mReal totVolume0; ///< total volume at equilibrium
-    mReal ka0; ///< energy magnitude for total area constraint
-    mReal kv0; ///< energy magnitude for total volume constraint
-};
-
-/// Device compatible structure that holds the viscous and fluctuation parameters
-struct GPUViscMembraneParameters
-{
-    mReal gammaC;    ///< viscous coefficient
-    mReal seed;      ///< seed that is used for rng; must be changed at every time interation
-    mReal sigma_rnd; ///< random force coefficient
-};
-
-__device__ inline mReal3 _fconstrainArea(mReal3 v1, mReal3 v2, mReal3 v3, mReal totArea,
-                                         const GPUConstraintMembraneParameters& parameters)
-{
-    const mReal3 x21 = v2 - v1;
-    const mReal3 x32 = v3 - v2;
-    const mReal3 x31 = v3 - v1;
-
-    const mReal3 normal = cross(x21, x31);
-
-    const mReal area = 0.5_mr * length(normal);
-    const mReal area_1 = 1.0_mr / max(area, 1e-6_mr);
-
-    const mReal coef = -0.25_mr * parameters.ka0 * (totArea - parameters.totArea0) * area_1;
-
-    return coef * cross(normal, x32);
-}
-
-__device__ inline mReal3 _fconstrainVolume(mReal3 v1, mReal3 v2, mReal3 v3, mReal totVolume,
-                                          const GPUConstraintMembraneParameters& parameters)
-{
-    const mReal coeff = parameters.kv0 * (totVolume - parameters.totVolume0);
-    return coeff * cross(v3, v2);
-}
-
-
 template <class TriangleInteraction>
 __device__ inline mReal3 triangleForce(
         const TriangleInteraction& triangleInteraction,
@@ -174,25 +130,6 @@ __global__ void computeMembraneForces(TriangleInteraction triangleInteraction,
 
 
 
-__device__ inline mReal3 _fvisc(ParticleMReal p1, ParticleMReal p2,
-                               const GPUViscMembraneParameters& parameters)
-{
-    const mReal3 du = p2.u - p1.u;
-    const mReal3 dr = p1.r - p2.r;
-
-    return dr * (parameters.gammaC * dot(du, dr) / max(dot(dr, dr), 1e-6_mr));
-}
-
-__device__ inline mReal3 _ffluct(mReal3 v1, mReal3 v2, int i1, int i2,
-                                 const GPUViscMembraneParameters& parameters)
-{
-    constexpr mReal sqrt_12 = 3.4641016151_mr;
-    const mReal mean0var1 = sqrt_12 * (Saru::uniform01(parameters.seed, math::min(i1, i2), math::max(i1, i2)) - 0.5_mr);
-
-    const mReal3 x21 = v2 - v1;
-    return (mean0var1 * parameters.sigma_rnd / length(x21)) * x21;
-}
-
 __device__ inline mReal3 bondForces(
         const ParticleMReal& p, int locId, int rbcId,
         const OVview& view,
@@ -242,5 +179,112 @@ __global__ void computeMembraneViscousFluctForces(OVview view,
     atomicAdd(view.forces + pid, make_real3(f));
 }
 
+
+/** \brief Get the force accumulators of the membrane of the current block and set them to zero.
+    \param [in] nvertices Number of vertices per membrane
+    \param [in] globalForces Accumulators in global memory, nvertices per membrane; if \c nullptr, shared memory is used
+    \param [in] sharedForces Accumulators in shared memory
+    \return The accumulators of the current membrane
+ */
+__device__ inline mReal3* initElementAccumulators(int nvertices, mReal3 *globalForces, mReal3 *sharedForces)
+{
+    mReal3 *forces = globalForces ? globalForces + blockIdx.x * nvertices : sharedForces;
+    for (int i = threadIdx.x; i < nvertices; i += blockDim.x)
+        forces[i] = make_mReal3(0.0_mr);
+    return forces;
+}
+
+/// Add the accumulated forces of the membrane of the current block to the vertex forces; one atomic per vertex
+__device__ inline void flushElementAccumulators(const OVview& view, int nvertices, const mReal3 *forces)
+{
+    const int offset = blockIdx.x * nvertices;
+    for (int i = threadIdx.x; i < nvertices; i += blockDim.x)
+        atomicAdd(view.forces + offset + i, make_real3(forces[i]));
+}
+
+/** \brief Element-centric version of computeMembraneForces(): one block per membrane.
+
+    The elements of each color are processed in parallel; the colors are processed one after the other,
+    so that the forces are accumulated without atomics and in an order that does not depend on the scheduling.
+    The accumulators are stored in dynamic shared memory unless \p globalForces is not \c nullptr.
+ */
+template <class TriangleInteraction, class DihedralInteraction, class Filter>
+__global__ void computeMembraneForcesPerElement(TriangleInteraction triangleInteraction,
+                                                DihedralInteraction dihedralInteraction,
+                                                typename DihedralInteraction::ViewType dihedralView,
+                                                OVviewWithAreaVolume view,
+                                                MembraneMeshView mesh,
+                                                MembraneMeshElementsView elements,
+                                                GPUConstraintMembraneParameters parameters,
+                                                Filter filter,
+                                                mReal3 *globalForces)
+{
+    extern __shared__ mReal3 sharedForces[];
+
+    assert(view.objSize == mesh.nvertices);
+    const int rbcId = blockIdx.x;
+    const int offset = rbcId * mesh.nvertices;
+
+    if (!filter.inWhiteList(rbcId)) return;
+
+    mReal3 *forces = initElementAccumulators(mesh.nvertices, globalForces, sharedForces);
+
+    const mReal totArea   = view.area_volumes[rbcId].x;
+    const mReal totVolume = view.area_volumes[rbcId].y;
+    dihedralInteraction.computeInternalCommonQuantities(dihedralView, rbcId);
+
+    __syncthreads();
+
+    for (int color = 0; color < elements.nTriangleColors; ++color)
+    {
+        const int end = elements.triangleColorStarts[color + 1];
+        for (int i = elements.triangleColorStarts[color] + threadIdx.x; i < end; i += blockDim.x)
+            addTriangleForces(triangleInteraction, elements.triangles[i], offset, view, mesh,
+                              parameters, totArea, totVolume, forces);
+        __syncthreads();
+    }
+
+    for (int color = 0; color < elements.nDihedralColors; ++color)
+    {
+        const int end = elements.dihedralColorStarts[color + 1];
+        for (int i = elements.dihedralColorStarts[color] + threadIdx.x; i < end; i += blockDim.x)
+            addDihedralForces(dihedralInteraction, elements.dihedrals[i], offset, dihedralView, forces);
+        __syncthreads();
+    }
+
+    flushElementAccumulators(view, mesh.nvertices, forces);
+}
+
+/// Element-centric version of computeMembraneViscousFluctForces(); see computeMembraneForcesPerElement().
+template <class Filter>
+__global__ void computeMembraneViscousFluctForcesPerElement(OVview view,
+                                                            MembraneMeshView mesh,
+                                                            MembraneMeshElementsView elements,
+                                                            GPUViscMembraneParameters parameters,
+                                                            Filter filter,
+                                                            mReal3 *globalForces)
+{
+    extern __shared__ mReal3 sharedForces[];
+
+    assert(view.objSize == mesh.nvertices);
+    const int rbcId = blockIdx.x;
+    const int offset = rbcId * mesh.nvertices;
+
+    if (!filter.inWhiteList(rbcId)) return;
+
+    mReal3 *forces = initElementAccumulators(mesh.nvertices, globalForces, sharedForces);
+    __syncthreads();
+
+    for (int color = 0; color < elements.nEdgeColors; ++color)
+    {
+        const int end = elements.edgeColorStarts[color + 1];
+        for (int i = elements.edgeColorStarts[color] + threadIdx.x; i < end; i += blockDim.x)
+            addBondForces(elements.edges[i], offset, view, parameters, forces);
+        __syncthreads();
+    }
+
+    flushElementAccumulators(view, mesh.nvertices, forces);
+}
+
 } // namespace membrane_forces_kernels
 } // namespace mirheo
@@ -0,0 +1,217 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include "force_kernels/common.h"
+
+#include <mirheo/core/mesh/membrane_elements.h>
+#include <mirheo/core/utils/cuda_rng.h>
+
+namespace mirheo
+{
+
+namespace membrane_forces_kernels
+{
+
+/// Device compatible structure that holds the parameters for area and volume constraints
+struct GPUConstraintMembraneParameters
+{
+    mReal totArea0;   ///< total area at equilibrium
+    mReal totVolume0; ///< total volume at equilibrium
+    mReal ka0; ///< energy magnitude for total area constraint
+    mReal kv0; ///< energy magnitude for total volume constraint
+};
+
+/// Device compatible structure that holds the viscous and fluctuation parameters
+struct GPUViscMembraneParameters
+{
+    mReal gammaC;    ///< viscous coefficient
+    mReal seed;      ///< seed that is used for rng; must be changed at every time interation
+    mReal sigma_rnd; ///< random force coefficient
+};
+
+__D__ inline mReal3 _fconstrainArea(mReal3 v1, mReal3 v2, mReal3 v3, mReal totArea,
+                                    const GPUConstraintMembraneParameters& parameters)
+{
+    const mReal3 x21 = v2 - v1;
+    const mReal3 x32 = v3 - v2;
+    const mReal3 x31 = v3 - v1;
+
+    const mReal3 normal = cross(x21, x31);
+
+    const mReal area = 0.5_mr * length(normal);
+    const mReal area_1 = 1.0_mr / math::max(area, 1e-6_mr);
+
+    const mReal coef = -0.25_mr * parameters.ka0 * (totArea - parameters.totArea0) * area_1;
+
+    return coef * cross(normal, x32);
+}
+
+__D__ inline mReal3 _fconstrainVolume(mReal3 v1, mReal3 v2, mReal3 v3, mReal totVolume,
+                                      const GPUConstraintMembraneParameters& parameters)
+{
+    const mReal coeff = parameters.kv0 * (totVolume - parameters.totVolume0);
+    return coeff * cross(v3, v2);
+}
+
+__D__ inline mReal3 _fvisc(ParticleMReal p1, ParticleMReal p2,
+                           const GPUViscMembraneParameters& parameters)
+{
+    const mReal3 du = p2.u - p1.u;
+    const mReal3 dr = p1.r - p2.r;
+
+    return dr * (parameters.gammaC * dot(du, dr) / math::max(dot(dr, dr), 1e-6_mr));
+}
+
+__D__ inline mReal3 _ffluct(mReal3 v1, mReal3 v2, int i1, int i2,
+                            const GPUViscMembraneParameters& parameters)
+{
+    constexpr mReal sqrt_12 = 3.4641016151_mr;
+    const mReal mean0var1 = sqrt_12 * (Saru::uniform01(parameters.seed, math::min(i1, i2), math::max(i1, i2)) - 0.5_mr);
+
+    const mReal3 x21 = v2 - v1;
+    return (mean0var1 * parameters.sigma_rnd / length(x21)) * x21;
+}
+
+
+/** \brief Add the forces of one triangle (shear, area and volume constraints) to its three vertices.
+    \param [in] triangleInteraction The triangle force kernel
+    \param [in] t The triangle
+    \param [in] offset Index of the first vertex of the membrane in \p view
+    \param [in] view The membrane vertices, with areas and volumes
+    \param [in] mesh The mesh
+    \param [in] parameters The constraint parameters
+    \param [in] totArea Current area of the membrane
+    \param [in] totVolume Current volume of the membrane
+    \param [in,out] forces The forces of the vertices of the membrane; the forces of \p t are added (not atomically).
+
+    The triangle is evaluated once: the quantities common to its three corners (normal, area) are computed once,
+    and its forces are scattered to its three vertices.
+ */
+template <class TriangleInteraction>
+__D__ inline void addTriangleForces(const TriangleInteraction& triangleInteraction,
+                                    const MembraneTriangle& t, int offset,
+                                    const OVviewWithAreaVolume& view, const MembraneMeshView& mesh,
+                                    const GPUConstraintMembraneParameters& parameters,
+                                    mReal totArea, mReal totVolume, mReal3 *forces)
+{
+    const mReal3 r0 = fetchPosition(view, offset + t.vertices.x);
+    const mReal3 r1 = fetchPosition(view, offset + t.vertices.y);
+    const mReal3 r2 = fetchPosition(view, offset + t.vertices.z);
+
+    const auto eq0 = triangleInteraction.getEquilibriumDesc(mesh, t.adjFirst.x, t.adjSecond.x);
+    const auto eq1 = triangleInteraction.getEquilibriumDesc(mesh, t.adjFirst.y, t.adjSecond.y);
+    const auto eq2 = triangleInteraction.getEquilibriumDesc(mesh, t.adjFirst.z, t.adjSecond.z);
+
+    mReal3 f0, f1, f2;
+    triangleInteraction.computeElementForces(r0, r1, r2, eq0, eq1, eq2, f0, f1, f2);
+
+    // area and volume constraints, see _fconstrainArea() and _fconstrainVolume()
+    const mReal3 normal = cross(r1 - r0, r2 - r0);
+    const mReal area = 0.5_mr * length(normal);
+    const mReal area_1 = 1.0_mr / math::max(area, 1e-6_mr);
+    const mReal coefArea = -0.25_mr * parameters.ka0 * (totArea - parameters.totArea0) * area_1;
+    const mReal coefVolume = parameters.kv0 * (totVolume - parameters.totVolume0);
+
+    forces[t.vertices.x] += f0 + coefArea * cross(normal, r2 - r1) + coefVolume * cross(r2, r1);
+    forces[t.vertices.y] += f1 + coefArea * cross(normal, r0 - r2) + coefVolume * cross(r0, r2);
+    forces[t.vertices.z] += f2 + coefArea * cross(normal, r1 - r0) + coefVolume * cross(r1, r0);
+}
+
+/** \brief Add the bending forces of one dihedral to its four vertices.
+    \param [in] dihedralInteraction The dihedral force kernel; its common quantities must be computed for this membrane
+    \param [in] d The dihedral (see MembraneMeshElements)
+    \param [in] offset Index of the first vertex of the membrane in \p view
+    \param [in] view The view compatible with \p dihedralInteraction
+    \param [in,out] forces The forces of the vertices of the membrane; the forces of \p d are added (not atomically).
+
+    The dihedral is evaluated once, and its forces are scattered to its four vertices.
+ */
+template <class DihedralInteraction>
+__D__ inline void addDihedralForces(const DihedralInteraction& dihedralInteraction, int4 d, int offset,
+                                    const typename DihedralInteraction::ViewType& view, mReal3 *forces)
+{
+    const auto v0 = dihedralInteraction.fetchVertex(view, offset + d.x);
+    const auto v1 = dihedralInteraction.fetchVertex(view, offset + d.y);
+    const auto v2 = dihedralInteraction.fetchVertex(view, offset + d.z);
+    const auto v3 = dihedralInteraction.fetchVertex(view, offset + d.w);
+
+    mReal3 f0, f1, f2, f3;
+    dihedralInteraction.computeElementForces(v0, v1, v2, v3, f0, f1, f2, f3);
+
+    forces[d.x] += f0;
+    forces[d.y] += f1;
+    forces[d.z] += f2;
+    forces[d.w] += f3;
+}
+
+/** \brief Add the viscous and random forces of one edge to its two vertices.
+    \param [in] e The edge
+    \param [in] offset Index of the first vertex of the membrane in \p view
+    \param [in] view The membrane vertices
+    \param [in] parameters The viscous and random force parameters
+    \param [in,out] forces The forces of the vertices of the membrane; the forces of \p e are added (not atomically).
+
+    The force is antisymmetric, so it is evaluated once per edge instead of once per vertex in bondForces().
+ */
+__D__ inline void addBondForces(int2 e, int offset, const OVview& view,
+                                const GPUViscMembraneParameters& parameters, mReal3 *forces)
+{
+    const int id0 = offset + e.x;
+    const int id1 = offset + e.y;
+    const auto p0 = fetchParticle(view, id0);
+    const auto p1 = fetchParticle(view, id1);
+
+    const mReal3 f = _fvisc (p0,   p1,           parameters)
+        +            _ffluct(p0.r, p1.r, id0, id1, parameters);
+
+    forces[e.x] += f;
+    forces[e.y] -= f;
+}
+
+
+/** \brief Host reference of the element-centric membrane forces (triangles and dihedrals).
+    \param [in] triangleInteraction The triangle force kernel
+    \param [in] dihedralInteraction The dihedral force kernel
+    \param [in] dihedralView The view compatible with \p dihedralInteraction; must point to host memory
+    \param [in] view The membrane vertices, with areas and volumes; must point to host memory
+    \param [in] mesh The mesh; must point to host memory
+    \param [in] elements The colored elements of the mesh; must point to host memory
+    \param [in] parameters The constraint parameters
+    \param [out] forces The membrane forces of all vertices of all membranes
+
+    The elements are processed in the same order as in computeMembraneForcesPerElement(),
+    so the forces are summed in the same order as on the device.
+ */
+template <class TriangleInteraction, class DihedralInteraction>
+void computeMembraneForcesPerElementHost(const TriangleInteraction& triangleInteraction,
+                                         DihedralInteraction dihedralInteraction,
+                                         const typename DihedralInteraction::ViewType& dihedralView,
+                                         const OVviewWithAreaVolume& view,
+                                         const MembraneMeshView& mesh,
+                                         const MembraneMeshElementsView& elements,
+                                         const GPUConstraintMembraneParameters& parameters,
+                                         mReal3 *forces)
+{
+    for (int rbcId = 0; rbcId < view.nObjects; ++rbcId)
+    {
+        const int offset = rbcId * mesh.nvertices;
+        mReal3 *objForces = forces + offset;
+
+        for (int i = 0; i < mesh.nvertices; ++i)
+            objForces[i] = make_mReal3(0.0_mr);
+
+        const mReal totArea   = view.area_volumes[rbcId].x;
+        const mReal totVolume = view.area_volumes[rbcId].y;
+        dihedralInteraction.computeInternalCommonQuantities(dihedralView, rbcId);
+
+        for (int i = 0; i < elements.triangleColorStarts[elements.nTriangleColors]; ++i)
+            addTriangleForces(triangleInteraction, elements.triangles[i], offset, view, mesh,
+                              parameters, totArea, totVolume, objForces);
+
+        for (int i = 0; i < elements.dihedralColorStarts[elements.nDihedralColors]; ++i)
+            addDihedralForces(dihedralInteraction, elements.dihedrals[i], offset, dihedralView, objForces);
+    }
+}
+
+} // namespace membrane_forces_kernels
+} // namespace mirheo
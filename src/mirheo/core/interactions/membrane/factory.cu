@@ -18,7 +18,8 @@ std::shared_ptr<BaseMembraneInteraction>
 createInteractionMembrane(const MirState *state, const std::string& name,
                           CommonMembraneParameters commonParams,
                           VarBendingParams varBendingParams, VarShearParams varShearParams,
-                          bool stressFree, real initLengthFraction, real growUntil, VarMembraneFilter varFilter)
+                          bool stressFree, real initLengthFraction, real growUntil, VarMembraneFilter varFilter,
+                          MembraneForceAssembly assembly)
 {
     std::shared_ptr<BaseMembraneInteraction> impl;
 
@@ -31,14 +32,14 @@ createInteractionMembrane(const MirState *state, const std::string& name,
             using TriangleForce = typename decltype(shearParams)::TriangleForce <StressFreeState::Active>;
 
             impl = std::make_shared<MembraneInteraction<TriangleForce, DihedralForce, decltype(filter)>>
-                (state, name, commonParams, shearParams, bendingParams, initLengthFraction, growUntil, filter);
+                (state, name, commonParams, shearParams, bendingParams, initLengthFraction, growUntil, filter, assembly);
         }
         else
         {
             using TriangleForce = typename decltype(shearParams)::TriangleForce <StressFreeState::Inactive>;
 
             impl = std::make_shared<MembraneInteraction<TriangleForce, DihedralForce, decltype(filter)>>
-                (state, name, commonParams, shearParams, bendingParams, initLengthFraction, growUntil, filter);
+                (state, name, commonParams, shearParams, bendingParams, initLengthFraction, growUntil, filter, assembly);
         }
     }, varBendingParams, varShearParams, varFilter);
 
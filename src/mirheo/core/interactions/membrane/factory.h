@@ -31,12 +31,14 @@ using VarShearParams   = std::variant<WLCParameters, LimParameters>;
     \param [in] initLengthFraction Initial length scale of the parameters, will linearly increase up to 1 after \p growUntil time
     \param [in] growUntil Time interval during which the parameters will be linearly scaled in length
     \param [in] varFilter The filter kernel
+    \param [in] assembly How the forces of the elements are assembled into vertex forces
     \return A MembraneInteraction with template parameters corresponding to all above variants
  */
 std::shared_ptr<BaseMembraneInteraction>
 createInteractionMembrane(const MirState *state, const std::string& name,
                           CommonMembraneParameters commonParams,
                           VarBendingParams varBendingParams, VarShearParams varShearParams,
-                          bool stressFree, real initLengthFraction, real growUntil, VarMembraneFilter varFilter);
+                          bool stressFree, real initLengthFraction, real growUntil, VarMembraneFilter varFilter,
+                          MembraneForceAssembly assembly = MembraneForceAssembly::Vertex);
 
 } // namespace mirheo
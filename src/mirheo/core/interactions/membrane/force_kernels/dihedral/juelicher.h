@@ -74,6 +74,57 @@ public:
         return f0;
     }
 
+    /** \brief Compute the dihedral forces on its four vertices at once.
+        \param [in] v0 vertex 0
+        \param [in] v1 vertex 1
+        \param [in] v2 vertex 2
+        \param [in] v3 vertex 3
+        \param [out] f0 force acting on \p v0
+        \param [out] f1 force acting on \p v1
+        \param [out] f2 force acting on \p v2
+        \param [out] f3 force acting on \p v3
+
+        Same as operator() called on (v0, v1, v2, v3) and (v2, v3, v0, v1), with the angle and the normals computed once:
+        the angle is the same in both orientations, and the second call only swaps the two normals.
+     */
+    __D__ inline void computeElementForces(VertexType v0, VertexType v1, VertexType v2, VertexType v3,
+                                           mReal3& f0, mReal3& f1, mReal3& f2, mReal3& f3) const
+    {
+        constexpr mReal eps = 1e-6_mr;
+        const mReal theta = supplementaryDihedralAngle(v0.r, v1.r, v2.r, v3.r);
+        const mReal coef = kb_ * (v0.H + v2.H - 2*H0_)  +  kadPi_ * scurv_;
+
+        const mReal3 v20 = v0.r - v2.r;
+        const mReal3 v21 = v1.r - v2.r;
+        const mReal3 v23 = v3.r - v2.r;
+
+        // normals of the triangles (v0, v2, v1) and (v0, v3, v2)
+        const mReal3 n = cross(v21, v20);
+        const mReal3 k = cross(v20, v23);
+
+        const mReal inv_lenn = math::rsqrt(math::max(dot(n,n), eps));
+        const mReal inv_lenk = math::rsqrt(math::max(dot(k,k), eps));
+
+        const mReal len20_2 = dot(v20, v20);
+
+        // length term
+        const mReal3 fLen = -coef * theta * normalize(v20);
+
+        // angle term, from v2 for (v0, v1) and from v0 for (v2, v3)
+        const mReal cotangent2n = dot(v20, v21) * inv_lenn;
+        const mReal cotangent2k = dot(v23, v20) * inv_lenk;
+        const mReal cotangent0n = dot(v20, v20 - v21) * inv_lenn;
+        const mReal cotangent0k = dot(v20, v20 - v23) * inv_lenk;
+
+        const mReal3 d0 = (-cotangent2n * inv_lenn) * n + (-cotangent2k * inv_lenk) * k;
+        const mReal3 d2 = (-cotangent0k * inv_lenk) * k + (-cotangent0n * inv_lenn) * n;
+
+        f0 = fLen - coef * d0 + _forceArea(v0, v1, v2);
+        f1 = -coef * (len20_2 * inv_lenn*inv_lenn) * n;
+        f2 = -fLen - coef * d2 + _forceArea(v2, v3, v0);
+        f3 = -coef * (len20_2 * inv_lenk*inv_lenk) * k;
+    }
+
 private:
     __D__ inline mReal3 _forceLen(mReal theta, VertexType v0, VertexType v2) const
     {
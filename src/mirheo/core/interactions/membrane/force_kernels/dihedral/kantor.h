@@ -56,6 +56,34 @@ public:
         return _kantor(v1, v0, v2, v3, f1);
     }
 
+    /** \brief Compute the dihedral forces on its four vertices at once.
+        \param [in] v0 vertex 0
+        \param [in] v1 vertex 1
+        \param [in] v2 vertex 2
+        \param [in] v3 vertex 3
+        \param [out] f0 force acting on \p v0
+        \param [out] f1 force acting on \p v1
+        \param [out] f2 force acting on \p v2
+        \param [out] f3 force acting on \p v3
+
+        Same as operator() called on (v0, v1, v2, v3) and (v2, v3, v0, v1), with the normals and the angle computed once:
+        the second call only swaps the two normals.
+     */
+    __D__ inline void computeElementForces(VertexType v0, VertexType v1, VertexType v2, VertexType v3,
+                                           mReal3& f0, mReal3& f1, mReal3& f2, mReal3& f3) const
+    {
+        const mReal3 ksi   = cross(v1 - v0, v1 - v2);
+        const mReal3 dzeta = cross(v2 - v3, v0 - v3);
+
+        mReal b11, b12, b22;
+        _coefficients(ksi, dzeta, v3 - v1, b11, b12, b22);
+
+        f0 = cross(ksi, v1 - v2)*b11 + ( cross(ksi, v2 - v3) + cross(dzeta, v1 - v2) )*b12 + cross(dzeta, v2 - v3)*b22;
+        f1 = cross(ksi, v2 - v0)*b11 + cross(dzeta, v2 - v0)*b12;
+        f2 = cross(dzeta, v3 - v0)*b22 + ( cross(dzeta, v0 - v1) + cross(ksi, v3 - v0) )*b12 + cross(ksi, v0 - v1)*b11;
+        f3 = cross(dzeta, v0 - v2)*b22 + cross(ksi, v0 - v2)*b12;
+    }
+
 private:
 
     __D__ inline mReal3 _kantor(VertexType v1, VertexType v2, VertexType v3, VertexType v4, mReal3 &f1) const
@@ -63,23 +91,30 @@ private:
         const mReal3 ksi   = cross(v1 - v2, v1 - v3);
         const mReal3 dzeta = cross(v3 - v4, v2 - v4);
 
+        mReal b11, b12, b22;
+        _coefficients(ksi, dzeta, v4 - v1, b11, b12, b22);
+
+        f1 = cross(ksi, v3 - v2)*b11 + cross(dzeta, v3 - v2)*b12;
+
+        return cross(ksi, v1 - v3)*b11 + ( cross(ksi, v3 - v4) + cross(dzeta, v1 - v3) )*b12 + cross(dzeta, v3 - v4)*b22;
+    }
+
+    /// coefficients of the forces, given the normals \p ksi and \p dzeta of the two triangles and the vector between the two wings
+    __D__ inline void _coefficients(mReal3 ksi, mReal3 dzeta, mReal3 v41, mReal& b11, mReal& b12, mReal& b22) const
+    {
         const mReal overIksiI   = math::rsqrt(dot(ksi, ksi));
         const mReal overIdzetaI = math::rsqrt(dot(dzeta, dzeta));
 
         const mReal cosTheta = dot(ksi, dzeta) * overIksiI * overIdzetaI;
         const mReal IsinThetaI2 = 1.0_mr - cosTheta*cosTheta;
 
-        const mReal rawST_1 = math::rsqrt(max(IsinThetaI2, 1.0e-6_mr));
-        const mReal sinTheta_1 = copysignf( rawST_1, dot(ksi - dzeta, v4 - v1) ); // because the normals look inside
+        const mReal rawST_1 = math::rsqrt(math::max(IsinThetaI2, 1.0e-6_mr));
+        const mReal sinTheta_1 = copysignf( rawST_1, dot(ksi - dzeta, v41) ); // because the normals look inside
         const mReal beta = cost0kb_ - cosTheta * sint0kb_ * sinTheta_1;
 
-        const mReal b11 = -beta * cosTheta *  overIksiI   * overIksiI;
-        const mReal b12 =  beta *             overIksiI   * overIdzetaI;
-        const mReal b22 = -beta * cosTheta *  overIdzetaI * overIdzetaI;
-
-        f1 = cross(ksi, v3 - v2)*b11 + cross(dzeta, v3 - v2)*b12;
-
-        return cross(ksi, v1 - v3)*b11 + ( cross(ksi, v3 - v4) + cross(dzeta, v1 - v3) )*b12 + cross(dzeta, v3 - v4)*b22;
+        b11 = -beta * cosTheta *  overIksiI   * overIksiI;
+        b12 =  beta *             overIksiI   * overIdzetaI;
+        b22 = -beta * cosTheta *  overIdzetaI * overIdzetaI;
     }
 
     mReal cost0kb_; ///< kb * cos(theta_0)
@@ -13,6 +13,13 @@ enum class StressFreeState
     Inactive
 };
 
+/// Describes how the forces of the membrane elements are assembled into the vertex forces
+enum class MembraneForceAssembly
+{
+    Vertex, ///< one thread per vertex evaluates the terms of all adjacent elements that act on that vertex
+    Element ///< one thread per element evaluates its terms on all its vertices; deterministic, see MembraneMeshElements
+};
+
 // predeclaration for convenience
 
 template <StressFreeState stressFreeState> class TriangleWLCForce;
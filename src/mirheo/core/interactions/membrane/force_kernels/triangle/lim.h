@@ -99,14 +99,47 @@ public:
         \return The triangle force acting on \p v1
      */
     __D__ inline mReal3 operator()(mReal3 v1, mReal3 v2, mReal3 v3, EquilibriumTriangleDesc eq) const
+    {
+        const mReal3 normalArea2 = cross(v2 - v1, v3 - v1);
+        return _cornerForce(v1, v2, v3, eq, normalArea2, 0.5_mr * length(normalArea2));
+    }
+
+    /** \brief Compute the triangle forces on its three vertices at once.
+        \param [in] v1 vertex 1
+        \param [in] v2 vertex 2
+        \param [in] v3 vertex 3
+        \param [in] eq1 The reference triangle information seen from \p v1
+        \param [in] eq2 The reference triangle information seen from \p v2
+        \param [in] eq3 The reference triangle information seen from \p v3
+        \param [out] f1 The triangle force acting on \p v1
+        \param [out] f2 The triangle force acting on \p v2
+        \param [out] f3 The triangle force acting on \p v3
+
+        Same as operator() called from each corner, with the normal and the area of the triangle computed once.
+     */
+    __D__ inline void computeElementForces(mReal3 v1, mReal3 v2, mReal3 v3,
+                                           EquilibriumTriangleDesc eq1, EquilibriumTriangleDesc eq2, EquilibriumTriangleDesc eq3,
+                                           mReal3& f1, mReal3& f2, mReal3& f3) const
+    {
+        const mReal3 normalArea2 = cross(v2 - v1, v3 - v1);
+        const mReal area = 0.5_mr * length(normalArea2);
+
+        f1 = _cornerForce(v1, v2, v3, eq1, normalArea2, area);
+        f2 = _cornerForce(v2, v3, v1, eq2, normalArea2, area);
+        f3 = _cornerForce(v3, v1, v2, eq3, normalArea2, area);
+    }
+
+private:
+
+    /// triangle force on \p v1, given the (twice area) normal of the triangle and its area
+    __D__ inline mReal3 _cornerForce(mReal3 v1, mReal3 v2, mReal3 v3, EquilibriumTriangleDesc eq,
+                                     mReal3 normalArea2, mReal area) const
     {
         const mReal3 x12 = v2 - v1;
         const mReal3 x13 = v3 - v1;
         const mReal3 x32 = v2 - v3;
 
-        const mReal3 normalArea2 = cross(x12, x13);
-        const mReal area = 0.5_mr * length(normalArea2);
-        const mReal area_inv = 1.0_mr / max(area, 1e-6_mr);
+        const mReal area_inv = 1.0_mr / math::max(area, 1e-6_mr);
         const mReal area0_inv = 1.0_mr / eq.a;
 
         const mReal3 derArea  = (0.25_mr * area_inv) * cross(normalArea2, x32);
@@ -142,8 +175,6 @@ public:
         return fArea + fShear;
     }
 
-private:
-
     mReal ka_;
     mReal mu_;
     mReal a3_;
@@ -95,6 +95,31 @@ public:
         return _areaForce(v1, v2, v3, eq.a) + _bondForce(v1, v2, eq.l);
     }
 
+    /** \brief Compute the triangle forces on its three vertices at once.
+        \param [in] v1 vertex 1
+        \param [in] v2 vertex 2
+        \param [in] v3 vertex 3
+        \param [in] eq1 The reference triangle information seen from \p v1
+        \param [in] eq2 The reference triangle information seen from \p v2
+        \param [in] eq3 The reference triangle information seen from \p v3
+        \param [out] f1 The triangle force acting on \p v1
+        \param [out] f2 The triangle force acting on \p v2
+        \param [out] f3 The triangle force acting on \p v3
+
+        Same as operator() called from each corner, with the normal and the area of the triangle computed once.
+     */
+    __D__ inline void computeElementForces(mReal3 v1, mReal3 v2, mReal3 v3,
+                                           EquilibriumTriangleDesc eq1, EquilibriumTriangleDesc eq2, EquilibriumTriangleDesc eq3,
+                                           mReal3& f1, mReal3& f2, mReal3& f3) const
+    {
+        const mReal3 normalArea2 = cross(v2 - v1, v3 - v1);
+        const mReal area = 0.5_mr * length(normalArea2);
+
+        f1 = _areaForceFromNormal(normalArea2, area, v3 - v2, eq1.a) + _bondForce(v1, v2, eq1.l);
+        f2 = _areaForceFromNormal(normalArea2, area, v1 - v3, eq2.a) + _bondForce(v2, v3, eq2.l);
+        f3 = _areaForceFromNormal(normalArea2, area, v2 - v1, eq3.a) + _bondForce(v3, v1, eq3.l);
+    }
+
 private:
 
     __D__ mReal3 _bondForce(mReal3 v1, mReal3 v2, mReal l0) const
@@ -128,6 +153,12 @@ private:
 
         const mReal area = 0.5_mr * length(normalArea2);
 
+        return _areaForceFromNormal(normalArea2, area, x32, area0);
+    }
+
+    /// area force on the vertex opposite to the edge \p x32, given the (twice area) normal of the triangle and its area
+    __D__ mReal3 _areaForceFromNormal(mReal3 normalArea2, mReal area, mReal3 x32, mReal area0) const
+    {
         const mReal coef = kd_ * (area - area0) / (area * area0);
 
         return -0.25_mr * coef * cross(normalArea2, x32);
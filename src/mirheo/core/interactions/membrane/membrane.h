@@ -8,12 +8,16 @@
 
 #include <mirheo/core/interactions/interface.h>
 #include <mirheo/core/interactions/utils/step_random_gen.h>
+#include <mirheo/core/mesh/membrane_elements.h>
 #include <mirheo/core/pvs/membrane_vector.h>
 #include <mirheo/core/pvs/views/ov.h>
 #include <mirheo/core/utils/cuda_common.h>
 #include <mirheo/core/utils/kernel_launch.h>
 #include <mirheo/core/utils/restart_helpers.h>
 
+#include <map>
+#include <memory>
+
 namespace mirheo
 {
 
@@ -85,6 +89,7 @@ public:
         \param [in] initLengthFraction The membrane will grow from this fraction of its size to its full size in \p growUntil time
         \param [in] growUntil The membrane will grow from \p initLengthFraction fraction of its size to its full size in this amount of time
         \param [in] filter Describes which membranes to apply the interactions
+        \param [in] assembly How the forces of the elements are assembled into vertex forces
         \param [in] seed Random seed for rng
 
         More information can be found on \p growUntil in _scaleFromTime().
@@ -92,7 +97,8 @@ public:
     MembraneInteraction(const MirState *state, std::string name, CommonMembraneParameters parameters,
                         typename TriangleInteraction::ParametersType triangleParams,
                         typename DihedralInteraction::ParametersType dihedralParams,
-                        real initLengthFraction, real growUntil, Filter filter, long seed = 42424242) :
+                        real initLengthFraction, real growUntil, Filter filter,
+                        MembraneForceAssembly assembly = MembraneForceAssembly::Vertex, long seed = 42424242) :
         BaseMembraneInteraction(state, name),
         parameters_(parameters),
         initLengthFraction_(initLengthFraction),
@@ -100,6 +106,7 @@ public:
         dihedralParams_(dihedralParams),
         triangleParams_(triangleParams),
         filter_(filter),
+        assembly_(assembly),
         stepGen_(seed)
     {}
 
@@ -131,15 +138,55 @@ public:
         auto mesh = static_cast<MembraneMesh *>(mv->mesh.get());
         MembraneMeshView meshView(mesh);
 
-        const int nthreads = 128;
-        const int nblocks  = getNblocks(view.size, nthreads);
-
         const auto devConstraintParams = getConstraintParams(currentParams);
 
         DihedralInteraction dihedralInteraction(dihedralParams_, scale);
         TriangleInteraction triangleInteraction(triangleParams_, mesh, scale);
         filter_.setup(mv);
 
+        const auto devViscParams = getViscParams(currentParams, stepGen_, getState());
+        const bool hasViscousForces = !(devViscParams.sigma_rnd == 0 && devViscParams.gammaC == 0);
+
+        if (_useElementAssembly())
+        {
+            const int nthreads = 128;
+            const int nblocks  = view.nObjects;
+            if (nblocks == 0)
+                return;
+
+            MembraneMeshElementsView elementsView(_getElements(mesh));
+
+            // accumulators in shared memory if they fit, in global memory otherwise
+            constexpr size_t maxSharedMemBytes = 48 * 1024;
+            size_t sharedMemBytes = mesh->getNvertices() * sizeof(mReal3);
+            mReal3 *globalForces = nullptr;
+            if (sharedMemBytes > maxSharedMemBytes)
+            {
+                elementForces_.resize_anew(view.nObjects * mesh->getNvertices());
+                globalForces = elementForces_.devPtr();
+                sharedMemBytes = 0;
+            }
+
+            SAFE_KERNEL_LAUNCH(
+                membrane_forces_kernels::computeMembraneForcesPerElement,
+                nblocks, nthreads, sharedMemBytes, stream,
+                triangleInteraction,
+                dihedralInteraction, dihedralView,
+                view, meshView, elementsView, devConstraintParams, filter_, globalForces);
+
+            if (!hasViscousForces)
+                return;
+
+            SAFE_KERNEL_LAUNCH(
+                membrane_forces_kernels::computeMembraneViscousFluctForcesPerElement,
+                nblocks, nthreads, sharedMemBytes, stream,
+                view, meshView, elementsView, devViscParams, filter_, globalForces);
+            return;
+        }
+
+        const int nthreads = 128;
+        const int nblocks  = getNblocks(view.size, nthreads);
+
         SAFE_KERNEL_LAUNCH(
             membrane_forces_kernels::computeMembraneForces,
             nblocks, nthreads, 0, stream,
@@ -147,10 +194,7 @@ public:
             dihedralInteraction, dihedralView,
             view, meshView, devConstraintParams, filter_);
 
-        const auto devViscParams = getViscParams(currentParams, stepGen_, getState());
-
-        if (devViscParams.sigma_rnd == 0 &&
-            devViscParams.gammaC == 0)
+        if (!hasViscousForces)
             return;
 
         SAFE_KERNEL_LAUNCH(
@@ -171,6 +215,9 @@ public:
             setPrerequisitesPerEnergy(dihedralParams_, mv);
             setPrerequisitesPerEnergy(triangleParams_, mv);
             filter_.setPrerequisites(mv);
+
+            if (_useElementAssembly())
+                _getElements(static_cast<MembraneMesh*>(mv->mesh.get()));
         }
         else
         {
@@ -202,6 +249,21 @@ private:
         precomputeQuantitiesPerEnergy(triangleParams_, mv, stream);
     }
 
+    /// \return \c true if the forces are assembled per element; this is always the case in deterministic mode.
+    bool _useElementAssembly() const
+    {
+        return assembly_ == MembraneForceAssembly::Element || getState()->deterministicForces;
+    }
+
+    /// \return The colored elements of \p mesh; they are computed on the first call for each mesh.
+    const MembraneMeshElements* _getElements(const MembraneMesh *mesh)
+    {
+        auto& elements = meshToElements_[mesh];
+        if (!elements)
+            elements = std::make_unique<MembraneMeshElements>(mesh);
+        return elements.get();
+    }
+
     /** Get a scaling factor for transforming the length scale of all the parameters
         (see also rescaleParameters())
         \param [in] t The simulation time (must be positive)
@@ -223,6 +285,9 @@ private:
     typename DihedralInteraction::ParametersType dihedralParams_; ///< dihedral forces parameters
     typename TriangleInteraction::ParametersType triangleParams_; ///< traingle forces parameters
     Filter filter_; ///< describes the cells to apply the forces to
+    MembraneForceAssembly assembly_; ///< how the element forces are assembled
+    std::map<const MembraneMesh*, std::unique_ptr<MembraneMeshElements>> meshToElements_; ///< colored elements, used by the element assembly
+    DeviceBuffer<mReal3> elementForces_; ///< force accumulators of the element assembly, if they do not fit in shared memory
     StepRandomGen stepGen_; ///< RNG
 };
 
@@ -31,13 +31,14 @@ __device__ inline mReal compute_lenTheta(mReal3 v0, mReal3 v1, mReal3 v2, mReal3
 __global__ void computeAreasAndCurvatures(OVviewWithJuelicherQuants view, MembraneMeshView mesh)
 {
     const int rbcId = blockIdx.y;
-    const int idv0  = blockIdx.x * blockDim.x + threadIdx.x;
     const int offset = rbcId * mesh.nvertices;
 
-    mReal lenTheta = 0;
+    mReal lenThetaSum = 0;
 
-    if (idv0 < mesh.nvertices)
+    for (int idv0 = blockIdx.x * blockDim.x + threadIdx.x; idv0 < mesh.nvertices; idv0 += gridDim.x * blockDim.x)
     {
+        mReal lenTheta = 0;
+
         const int startId = mesh.maxDegree * idv0;
         const int degree = mesh.degrees[idv0];
 
@@ -65,12 +66,29 @@ __global__ void computeAreasAndCurvatures(OVviewWithJuelicherQuants view, Membra
 
         view.vertexAreas          [offset + idv0] = area;
         view.vertexMeanCurvatures [offset + idv0] = lenTheta / max(4 * area, 1e-6_mr);
+        lenThetaSum += lenTheta;
     }
 
-    lenTheta = warpReduce( lenTheta, [] (mReal a, mReal b) { return a+b; } );
+    lenThetaSum = warpReduce( lenThetaSum, [] (mReal a, mReal b) { return a+b; } );
+
+    // the partial sums of the warps are added in a fixed order;
+    // with a single block per membrane (deterministic mode) the total is thus reproducible
+    __shared__ mReal warpSums[32];
+    const int warpId = threadIdx.x / warpSize;
 
     if (laneId() == 0)
-        atomicAdd(&view.lenThetaTot[rbcId], (real) lenTheta);
+        warpSums[warpId] = lenThetaSum;
+
+    __syncthreads();
+
+    if (threadIdx.x == 0)
+    {
+        const int nwarps = (blockDim.x + warpSize - 1) / warpSize;
+        for (int i = 1; i < nwarps; ++i)
+            lenThetaSum += warpSums[i];
+
+        atomicAdd(&view.lenThetaTot[rbcId], (real) lenThetaSum);
+    }
 }
 } // namespace interaction_membrane_juelicher_kernels
 
@@ -89,7 +107,9 @@ void precomputeQuantitiesPerEnergy(const JuelicherBendingParameters&, MembraneVe
     const int nthreads = 128;
 
     const dim3 threads(nthreads, 1);
-    const dim3 blocks(getNblocks(mesh.nvertices, nthreads), view.nObjects);
+    // one block per membrane gives a single atomic update per membrane
+    const int nblocksPerObject = mv->getState()->deterministicForces ? 1 : getNblocks(mesh.nvertices, nthreads);
+    const dim3 blocks(nblocksPerObject, view.nObjects);
 
     SAFE_KERNEL_LAUNCH(
         interaction_membrane_juelicher_kernels::computeAreasAndCurvatures,
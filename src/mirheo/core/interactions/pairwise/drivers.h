@@ -1,6 +1,7 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #pragma once
 
+#include "gather.h"
 #include "kernels/type_traits.h"
 
 #include <mirheo/core/celllist.h>
@@ -495,4 +496,51 @@ __global__ void computeExternalInteractionsSkipPairs_1tpp(
     accumulator.atomicAddToDst(accumulator.get(), dstView, dstId);
 }
 
+
+/** \brief Deterministic version of computeSelfInteractions().
+    \tparam Interaction The pairwise interaction kernel
+
+    \param [in] cinfo cell-list data
+    \param [in,out] view The view that contains the particle data
+    \param [in] interaction The pairwise interaction kernel
+
+    Mapping is one thread per particle. The thread traverses all the neighbouring cells
+    and accumulates the output of its particle only, see pairwise_gather.
+ */
+template<typename Interaction>
+__launch_bounds__(128, 16)
+__global__ void computeSelfInteractionsGather(
+        CellListInfo cinfo, typename Interaction::ViewType view, Interaction interaction)
+{
+    const int dstId = blockIdx.x * blockDim.x + threadIdx.x;
+    if (dstId >= view.size) return;
+
+    pairwise_gather::gatherSelfInteractions(cinfo, view, interaction, dstId);
+}
+
+/** \brief Deterministic version of computeExternalInteractions_1tpp(), with the output on the destination only.
+    \tparam Interaction The pairwise interaction kernel
+    \tparam SrcIds Map from the cell slots to the source particles, see pairwise_gather
+
+    \param [in,out] dstView Destination particles data
+    \param [in] srcCinfo Cell-lists info of the source particles
+    \param [in] srcView Source particles data
+    \param [in] srcIds Map from the cell slots to the source particles
+    \param [in] interaction Instance of the pairwise kernel functor
+
+    Mapping is one thread per destination particle.
+    The output of the source particles is obtained with a second launch where the roles are swapped.
+ */
+template<typename Interaction, typename SrcIds>
+__launch_bounds__(128, 16)
+__global__ void computeExternalInteractionsGather(
+        typename Interaction::ViewType dstView, CellListInfo srcCinfo,
+        typename Interaction::ViewType srcView, SrcIds srcIds, Interaction interaction)
+{
+    const int dstId = blockIdx.x * blockDim.x + threadIdx.x;
+    if (dstId >= dstView.size) return;
+
+    pairwise_gather::gatherExternalInteractions(dstView, srcCinfo, srcView, srcIds, interaction, dstId);
+}
+
 } // namespace mirheo
@@ -0,0 +1,179 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include "kernels/type_traits.h"
+
+#include <mirheo/core/celllist.h>
+#include <mirheo/core/utils/cpu_gpu_defines.h>
+#include <mirheo/core/utils/cuda_common.h>
+
+namespace mirheo
+{
+
+/** \brief Helpers for the deterministic evaluation of pairwise interactions (see MirState::deterministicForces).
+
+    Each output is written by exactly one thread: the thread of a destination particle visits all its neighbours
+    and sums the contributions in a register, in a fixed order:
+    the neighbouring cells are traversed by increasing z, y and x, and the particles of each cell in their cell-list order.
+    Each pair is thus evaluated twice (once per particle), instead of once with an atomic update of the source particle.
+    The same kernels are used when the forces are summed more accurately than the working precision
+    (see isAccurateForceAccumulator), since the whole force of a particle is then summed by its own accumulator.
+
+    This relies on the symmetry of the pairwise kernels: `interaction(a, b)` is the contribution of \c b on \c a.
+
+    All functions are host-compatible, so that the same order of summation can be reproduced on the CPU.
+ */
+namespace pairwise_gather
+{
+
+/// The source particles are stored in the order of the cells (CellList).
+struct DirectIds
+{
+    /// \return the particle index of slot \p i
+    __D__ inline int operator()(int i) const {return i;}
+};
+
+/// The source particles are accessed through a map from slots to particle indices (HaloCellList).
+struct IndirectIds
+{
+    /// \return the particle index of slot \p i
+    __D__ inline int operator()(int i) const {return ids[i];}
+
+    const int *ids; ///< particle index of each slot
+};
+
+/** \brief Sum the contributions of all source particles in the 27 cells around \p cell0 on one destination particle.
+    \tparam Interaction The pairwise interaction kernel
+    \tparam Accumulator Used to accumulate the output of the kernel
+    \tparam SrcIds Map from cell slots to source particle indices (DirectIds or IndirectIds)
+
+    \param [in] srcCinfo Cell-lists of the source particles
+    \param [in] cell0 Cell of the destination particle in \p srcCinfo (may be outside of the grid)
+    \param [in] dstP destination particle
+    \param [in] dstId destination particle index
+    \param [in] excludeId source index that is skipped (the destination particle itself for self interactions), or -1
+    \param [in] srcView The view of the source particles
+    \param [in] srcIds Map from cell slots to source indices
+    \param [in] interaction The pairwise interaction kernel
+    \param [in,out] accumulator Receives the contributions
+ */
+template <typename Interaction, typename Accumulator, typename SrcIds>
+__D__ inline void gatherNeighbours(const CellListInfo& srcCinfo, int3 cell0,
+                                   const typename Interaction::ParticleType& dstP, int dstId, int excludeId,
+                                   const typename Interaction::ViewType& srcView, SrcIds srcIds,
+                                   const Interaction& interaction, Accumulator& accumulator)
+{
+    const int cellXStart = math::max(cell0.x - 1, 0);
+    const int cellXEnd   = math::min(cell0.x + 1, srcCinfo.ncells.x - 1);
+
+    if (cellXStart > cellXEnd)
+        return;
+
+    for (int cellZ = cell0.z-1; cellZ <= cell0.z+1; ++cellZ)
+    {
+        for (int cellY = cell0.y-1; cellY <= cell0.y+1; ++cellY)
+        {
+            if ( !(cellY >= 0 && cellY < srcCinfo.ncells.y && cellZ >= 0 && cellZ < srcCinfo.ncells.z) ) continue;
+
+            // the cells of one row are contiguous
+            const int pstart = srcCinfo.cellStarts[srcCinfo.encode(cellXStart, cellY, cellZ)];
+            const int pend   = srcCinfo.cellStarts[srcCinfo.encode(cellXEnd,   cellY, cellZ) + 1];
+
+            for (int i = pstart; i < pend; ++i)
+            {
+                const int srcId = srcIds(i);
+                if (srcId == excludeId)
+                    continue;
+
+                typename Interaction::ParticleType srcP;
+                interaction.readCoordinates(srcP, srcView, srcId);
+
+                if (!interaction.withinCutoff(srcP, dstP))
+                    continue;
+
+                interaction.readExtraData(srcP, srcView, srcId);
+                accumulator.add(interaction(dstP, dstId, srcP, srcId));
+            }
+        }
+    }
+}
+
+/** \brief Compute the interactions of one particle with all the particles of the same ParticleVector.
+    \param [in] cinfo cell-list data
+    \param [in,out] view The view that contains the particle data, in cell-list order
+    \param [in] interaction The pairwise interaction kernel
+    \param [in] dstId The particle index
+ */
+template <typename Interaction>
+__D__ inline void gatherSelfInteractions(const CellListInfo& cinfo, typename Interaction::ViewType& view,
+                                         const Interaction& interaction, int dstId)
+{
+    const auto dstP = interaction.read(view, dstId);
+    auto accumulator = interaction.getZeroedAccumulator();
+
+    const int3 cell0 = cinfo.getCellIdAlongAxes(interaction.getPosition(dstP));
+
+    gatherNeighbours(cinfo, cell0, dstP, dstId, dstId, view, DirectIds{}, interaction, accumulator);
+
+    if (needSelfInteraction<Interaction>::value)
+        accumulator.add(interaction(dstP, dstId, dstP, dstId));
+
+    accumulator.atomicAddToDst(accumulator.get(), view, dstId);
+}
+
+/** \brief Compute the interactions of one destination particle with the particles of another ParticleVector.
+    \param [in,out] dstView The view of the destination particles
+    \param [in] srcCinfo cell-list data of the source particles
+    \param [in] srcView The view of the source particles, in cell-list order
+    \param [in] srcIds Map from cell slots to source indices
+    \param [in] interaction The pairwise interaction kernel
+    \param [in] dstId The destination particle index
+
+    Only the destination particle is modified.
+ */
+template <typename Interaction, typename SrcIds>
+__D__ inline void gatherExternalInteractions(typename Interaction::ViewType& dstView, const CellListInfo& srcCinfo,
+                                             const typename Interaction::ViewType& srcView, SrcIds srcIds,
+                                             const Interaction& interaction, int dstId)
+{
+    const auto dstP = interaction.read(dstView, dstId);
+    auto accumulator = interaction.getZeroedAccumulator();
+
+    const int3 cell0 = srcCinfo.getCellIdAlongAxes<CellListsProjection::NoClamp>(interaction.getPosition(dstP));
+
+    gatherNeighbours(srcCinfo, cell0, dstP, dstId, -1, srcView, srcIds, interaction, accumulator);
+
+    accumulator.atomicAddToDst(accumulator.get(), dstView, dstId);
+}
+
+/** \brief Host reference of computeSelfInteractionsGather().
+    \param [in] cinfo cell-list data; must point to host memory
+    \param [in,out] view The view that contains the particle data; must point to host memory
+    \param [in] interaction The pairwise interaction kernel
+
+    The outputs are summed in the same order as on the device.
+ */
+template <typename Interaction>
+void computeSelfInteractionsGatherHost(const CellListInfo& cinfo, typename Interaction::ViewType view,
+                                       const Interaction& interaction)
+{
+    for (int dstId = 0; dstId < view.size; ++dstId)
+        gatherSelfInteractions(cinfo, view, interaction, dstId);
+}
+
+/** \brief Host reference of computeExternalInteractionsGather().
+    \param [in,out] dstView The view of the destination particles; must point to host memory
+    \param [in] srcCinfo cell-list data of the source particles; must point to host memory
+    \param [in] srcView The view of the source particles; must point to host memory
+    \param [in] interaction The pairwise interaction kernel
+ */
+template <typename Interaction>
+void computeExternalInteractionsGatherHost(typename Interaction::ViewType dstView, const CellListInfo& srcCinfo,
+                                           typename Interaction::ViewType srcView, const Interaction& interaction)
+{
+    for (int dstId = 0; dstId < dstView.size; ++dstId)
+        gatherExternalInteractions(dstView, srcCinfo, srcView, DirectIds{}, interaction, dstId);
+}
+
+} // namespace pairwise_gather
+} // namespace mirheo
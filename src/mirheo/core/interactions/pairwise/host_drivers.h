@@ -0,0 +1,326 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include "kernels/accumulators/force.h"
+#include "kernels/type_traits.h"
+
+#include <mirheo/core/celllist.h>
+#include <mirheo/core/logger.h>
+#include <mirheo/core/utils/cpu_gpu_defines.h>
+#include <mirheo/core/utils/cuda_common.h>
+
+#include <type_traits>
+#include <vector>
+
+namespace mirheo
+{
+
+/** \brief Host (CPU) drivers of the pairwise interactions, parallelized with OpenMP.
+
+    The same kernels as the CUDA drivers (drivers.h) are used, hence these functions can only be called from
+    translation units compiled by the host compiler, in which the kernels are host functions.
+    All data (cell-lists and views) must point to host memory, the particles being stored in cell-list order.
+
+    Each pair is evaluated once (half stencil), its output being added to both particles.
+    The cells are processed in parallel by colors, such that the cells of the same color never update the same particles;
+    the kernel outputs can thus be added without atomic operations.
+    When the forces are summed more accurately than the working precision (see isAccurateForceAccumulator),
+    the cell-list drivers evaluate each pair once per particle instead (full stencil), so that each particle sums
+    its whole force in its own accumulator.
+    The distances between one particle and a row of neighbouring cells are first computed in a vectorizable loop
+    over a structure-of-arrays copy of the positions; the kernels are only evaluated for the pairs within the cut-off.
+ */
+namespace pairwise_host
+{
+
+/// Positions stored as a structure of arrays, for vectorizable distance computations
+struct SoAPositions
+{
+    /** \brief Copy the positions of particles
+        \param [in] positions The positions of the particles
+        \param [in] n The number of particles
+     */
+    SoAPositions(const real4 *positions, int n) :
+        x(n), y(n), z(n)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            x[i] = positions[i].x;
+            y[i] = positions[i].y;
+            z[i] = positions[i].z;
+        }
+    }
+
+    std::vector<real> x; ///< x coordinates
+    std::vector<real> y; ///< y coordinates
+    std::vector<real> z; ///< z coordinates
+};
+
+/** \brief Collect the particles of the range [\p pstart, \p pend) that are within a distance \p rc of \p r0.
+    \param [in] pos The positions of the particles
+    \param [in] pstart The first particle of the range
+    \param [in] pend One past the last particle of the range
+    \param [in] r0 The center of the search
+    \param [in] rc2 The square of the search radius
+    \param [out] inside Work array of size at least (\p pend - \p pstart)
+    \param [out] neighbours The indices of the neighbours; must be of size at least (\p pend - \p pstart)
+    \return The number of neighbours
+ */
+inline int findNeighbours(const SoAPositions& pos, int pstart, int pend, real3 r0, real rc2,
+                          int *inside, int *neighbours)
+{
+    const real *x = pos.x.data();
+    const real *y = pos.y.data();
+    const real *z = pos.z.data();
+    const int n = pend - pstart;
+
+#pragma omp simd
+    for (int i = 0; i < n; ++i)
+    {
+        const real dx = x[pstart + i] - r0.x;
+        const real dy = y[pstart + i] - r0.y;
+        const real dz = z[pstart + i] - r0.z;
+        inside[i] = (dx*dx + dy*dy + dz*dz < rc2) ? 1 : 0;
+    }
+
+    int nneighbours = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        neighbours[nneighbours] = pstart + i;
+        nneighbours += inside[i];
+    }
+    return nneighbours;
+}
+
+namespace details
+{
+
+/// Interact one destination particle with the source particles of the range [pstart, pend), if they are within the cut-off.
+template <typename Interaction, typename Accumulator>
+inline void computeRow(int pstart, int pend, const SoAPositions& srcPos, real rc2, std::vector<int>& work,
+                       const typename Interaction::ParticleType& dstP, int dstId,
+                       typename Interaction::ViewType& srcView, const Interaction& interaction,
+                       Accumulator& accumulator)
+{
+    const int n = pend - pstart;
+    if (n <= 0)
+        return;
+
+    if (static_cast<int>(work.size()) < 2 * n)
+        work.resize(2 * n);
+
+    int *inside = work.data();
+    int *neighbours = work.data() + n;
+    const int nneighbours = findNeighbours(srcPos, pstart, pend, interaction.getPosition(dstP), rc2, inside, neighbours);
+
+    for (int k = 0; k < nneighbours; ++k)
+    {
+        const int srcId = neighbours[k];
+
+        typename Interaction::ParticleType srcP;
+        interaction.readCoordinates(srcP, srcView, srcId);
+
+        if (!interaction.withinCutoff(srcP, dstP))
+            continue;
+
+        interaction.readExtraData(srcP, srcView, srcId);
+        const auto val = interaction(dstP, dstId, srcP, srcId);
+
+        accumulator.add(val);
+        if (!isAccurateForceAccumulator<Accumulator>::value)
+            accumulator.atomicAddToSrc(val, srcView, srcId);
+    }
+}
+
+/// \return The start of the particles of the cells [cellXStart, cellXEnd] of a row, and one past its end
+inline int2 getRowRange(const CellListInfo& cinfo, int cellXStart, int cellXEnd, int cellY, int cellZ)
+{
+    cellXStart = math::max(cellXStart, 0);
+    cellXEnd   = math::min(cellXEnd, cinfo.ncells.x - 1);
+
+    if (cellY < 0 || cellY >= cinfo.ncells.y || cellZ < 0 || cellZ >= cinfo.ncells.z || cellXStart > cellXEnd)
+        return {0, 0};
+
+    return {cinfo.cellStarts[cinfo.encode(cellXStart, cellY, cellZ)],
+            cinfo.cellStarts[cinfo.encode(cellXEnd,   cellY, cellZ) + 1]};
+}
+
+/** Call \p processCell(cell) on all cells of \p cinfo, in parallel by colors.
+    Two cells of the same color are at least \p stride cells apart along one dimension.
+ */
+template <typename ProcessCell>
+inline void forEachCellByColor(const CellListInfo& cinfo, int3 stride, ProcessCell&& processCell)
+{
+    const int3 ncells = cinfo.ncells;
+
+    // number of cells of one color along each dimension
+    const int3 n {(ncells.x + stride.x - 1) / stride.x,
+                  (ncells.y + stride.y - 1) / stride.y,
+                  (ncells.z + stride.z - 1) / stride.z};
+    const int ncellsPerColor = n.x * n.y * n.z;
+
+#pragma omp parallel
+    for (int colorZ = 0; colorZ < stride.z; ++colorZ)
+    for (int colorY = 0; colorY < stride.y; ++colorY)
+    for (int colorX = 0; colorX < stride.x; ++colorX)
+    {
+        // implicit barrier at the end: the colors are processed one after the other
+#pragma omp for schedule(dynamic, 4)
+        for (int i = 0; i < ncellsPerColor; ++i)
+        {
+            const int3 cell {colorX + stride.x * (i % n.x),
+                             colorY + stride.y * ((i / n.x) % n.y),
+                             colorZ + stride.z * (i / (n.x * n.y))};
+
+            if (cell.x < ncells.x && cell.y < ncells.y && cell.z < ncells.z)
+                processCell(cell);
+        }
+    }
+}
+
+} // namespace details
+
+/** \brief Compute the interactions between all pairs of particles of one ParticleVector.
+    \tparam Interaction The pairwise interaction kernel
+    \param [in] cinfo cell-list data; must point to host memory
+    \param [in,out] view The view that contains the particle data, in cell-list order; must point to host memory
+    \param [in] interaction The pairwise interaction kernel
+    \param [in] rc The cut-off radius of \p interaction
+
+    Equivalent to computeSelfInteractions(). Each cell interacts with itself and with the 13 cells of its lower half stencil
+    (same neighbouring cells as in the CUDA driver); it thus updates the particles of the cells at
+    x offsets [-1, 1], y offsets [-1, 0] and z offsets [-1, 1], which gives 3 x 2 x 3 colors.
+ */
+template <typename Interaction>
+void computeSelfInteractions(const CellListInfo& cinfo, typename Interaction::ViewType view,
+                             const Interaction& interaction, real rc)
+{
+    const SoAPositions pos(view.positions, view.size);
+    // the exact cut-off test is done by the kernel; this one must only not miss any pair
+    const real rc2 = rc * rc * (1.0_r + 1e-4_r);
+
+    details::forEachCellByColor(cinfo, {3, 2, 3}, [&](int3 cell)
+    {
+        thread_local std::vector<int> work;
+        const int cellId = cinfo.encode(cell.x, cell.y, cell.z);
+
+        for (int dstId = cinfo.cellStarts[cellId]; dstId < cinfo.cellStarts[cellId+1]; ++dstId)
+        {
+            const auto dstP = interaction.read(view, dstId);
+            auto accumulator = interaction.getZeroedAccumulator();
+
+            if (isAccurateForceAccumulator<decltype(accumulator)>::value)
+            {
+                // rows of the full stencil, without the particle itself
+                for (int dz = -1; dz <= 1; ++dz)
+                {
+                    for (int dy = -1; dy <= 1; ++dy)
+                    {
+                        const int2 range = details::getRowRange(cinfo, cell.x-1, cell.x+1, cell.y+dy, cell.z+dz);
+                        const bool withDst = dy == 0 && dz == 0;
+                        details::computeRow(range.x, withDst ? dstId : range.y, pos, rc2, work, dstP, dstId, view, interaction, accumulator);
+                        if (withDst)
+                            details::computeRow(dstId+1, range.y, pos, rc2, work, dstP, dstId, view, interaction, accumulator);
+                    }
+                }
+            }
+            else
+            {
+                // rows of the lower half stencil
+                for (int dz = -1; dz <= 1; ++dz)
+                {
+                    const int2 range = details::getRowRange(cinfo, cell.x-1, cell.x+1, cell.y-1, cell.z+dz);
+                    details::computeRow(range.x, range.y, pos, rc2, work, dstP, dstId, view, interaction, accumulator);
+                }
+                {
+                    const int2 range = details::getRowRange(cinfo, cell.x-1, cell.x+1, cell.y, cell.z-1);
+                    details::computeRow(range.x, range.y, pos, rc2, work, dstP, dstId, view, interaction, accumulator);
+                }
+
+                // previous cell of the row and particles of the same cell with a lower index
+                const int2 range = details::getRowRange(cinfo, cell.x-1, cell.x, cell.y, cell.z);
+                details::computeRow(range.x, dstId, pos, rc2, work, dstP, dstId, view, interaction, accumulator);
+            }
+
+            if (needSelfInteraction<Interaction>::value)
+                accumulator.add(interaction(dstP, dstId, dstP, dstId));
+
+            accumulator.atomicAddToDst(accumulator.get(), view, dstId);
+        }
+    });
+}
+
+namespace details
+{
+
+/// Add the interactions of the source particles to the destination particles; see computeExternalInteractions()
+template <typename Interaction>
+void computeExternalRows(const CellListInfo& dstCinfo, const CellListInfo& srcCinfo,
+                         typename Interaction::ViewType dstView, typename Interaction::ViewType srcView,
+                         const Interaction& interaction, real rc)
+{
+    const SoAPositions pos(srcView.positions, srcView.size);
+    const real rc2 = rc * rc * (1.0_r + 1e-4_r);
+
+    forEachCellByColor(dstCinfo, {3, 3, 3}, [&](int3 cell)
+    {
+        thread_local std::vector<int> work;
+        const int cellId = dstCinfo.encode(cell.x, cell.y, cell.z);
+
+        for (int dstId = dstCinfo.cellStarts[cellId]; dstId < dstCinfo.cellStarts[cellId+1]; ++dstId)
+        {
+            const auto dstP = interaction.read(dstView, dstId);
+            auto accumulator = interaction.getZeroedAccumulator();
+
+            for (int dz = -1; dz <= 1; ++dz)
+            {
+                for (int dy = -1; dy <= 1; ++dy)
+                {
+                    const int2 range = getRowRange(srcCinfo, cell.x-1, cell.x+1, cell.y+dy, cell.z+dz);
+                    computeRow(range.x, range.y, pos, rc2, work, dstP, dstId, srcView, interaction, accumulator);
+                }
+            }
+
+            accumulator.atomicAddToDst(accumulator.get(), dstView, dstId);
+        }
+    });
+}
+
+} // namespace details
+
+/** \brief Compute the interactions between all pairs of particles of two different ParticleVector.
+    \tparam Interaction The pairwise interaction kernel
+    \param [in] dstCinfo cell-list data of the destination particles; must point to host memory
+    \param [in] srcCinfo cell-list data of the source particles; must point to host memory
+    \param [in,out] dstView The view of the destination particles, in cell-list order; must point to host memory
+    \param [in,out] srcView The view of the source particles, in cell-list order; must point to host memory
+    \param [in] interaction The pairwise interaction kernel
+    \param [in] rc The cut-off radius of \p interaction
+
+    Equivalent to computeExternalInteractions_1tpp() with outputs on both sides.
+    The two cell-lists must have the same cells. Each cell of destination particles interacts with the 27 surrounding cells
+    of source particles, which gives 3 x 3 x 3 colors.
+    With an accurate accumulator, the source particles gather the contributions of the destination particles in a second pass.
+ */
+template <typename Interaction>
+void computeExternalInteractions(const CellListInfo& dstCinfo, const CellListInfo& srcCinfo,
+                                 typename Interaction::ViewType dstView, typename Interaction::ViewType srcView,
+                                 const Interaction& interaction, real rc)
+{
+    if (dstCinfo.ncells.x != srcCinfo.ncells.x ||
+        dstCinfo.ncells.y != srcCinfo.ncells.y ||
+        dstCinfo.ncells.z != srcCinfo.ncells.z)
+        die("Host pairwise interactions: the two cell-lists must have the same cells; got %d %d %d and %d %d %d",
+            dstCinfo.ncells.x, dstCinfo.ncells.y, dstCinfo.ncells.z,
+            srcCinfo.ncells.x, srcCinfo.ncells.y, srcCinfo.ncells.z);
+
+    using Accumulator = std::decay_t<decltype(interaction.getZeroedAccumulator())>;
+
+    details::computeExternalRows(dstCinfo, srcCinfo, dstView, srcView, interaction, rc);
+
+    if (isAccurateForceAccumulator<Accumulator>::value)
+        details::computeExternalRows(srcCinfo, dstCinfo, srcView, dstView, interaction, rc);
+}
+
+} // namespace pairwise_host
+} // namespace mirheo
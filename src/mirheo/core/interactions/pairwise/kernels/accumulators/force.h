@@ -1,21 +1,32 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #pragma once
 
+#include "sum.h"
+
 #include <mirheo/core/datatypes.h>
 #include <mirheo/core/pvs/views/pv.h>
 #include <mirheo/core/utils/cpu_gpu_defines.h>
 #include <mirheo/core/utils/helper_math.h>
 
+#include <type_traits>
+
 namespace mirheo
 {
-/// \brief Accumulate forces on device
-class ForceAccumulator
+/** \brief Accumulate forces on device
+    \tparam Sum The sum used for the force of the current particle, e.g. PlainSum3, KahanSum3 or DoubleSum3.
+
+    The pairwise forces are computed in the working precision; only their sum over the neighbours of one particle
+    may be carried in a more accurate way.
+    The atomic updates (atomicAddToDst(), atomicAddToSrc()) are always done in the working precision;
+    with a more accurate Sum, the drivers thus evaluate each pair once per particle and never call atomicAddToSrc(),
+    see isAccurateForceAccumulator.
+ */
+template <class Sum>
+class BasicForceAccumulator
 {
 public:
-    /// \brief Initialize the ForceAccumulator
-    __D__ ForceAccumulator() :
-        frc_({0._r, 0._r, 0._r})
-    {}
+    /// \brief Initialize the BasicForceAccumulator
+    __D__ BasicForceAccumulator() {}
 
     /** \brief Atomically add the force \p f to the destination \p view at id \p id.
         \param [in] f The force, directed from src to dst
@@ -38,15 +49,42 @@ public:
     }
 
     /// \return the internal accumulated force
-    __D__ real3 get() const {return frc_;}
+    __D__ real3 get() const {return frc_.get();}
 
     /// add \p f to the internal force
-    __D__ void add(real3 f) {frc_ += f;}
+    __D__ void add(real3 f) {frc_.add(f);}
 
 private:
-    real3 frc_;  ///< internal accumulated force
+    Sum frc_;  ///< internal accumulated force
 };
 
+/// The accumulator of the pairwise forces; the precision of the sum is chosen at compile time, see ForceSum3
+using ForceAccumulator = BasicForceAccumulator<ForceSum3>;
+
+/** \brief A type trait that states if an accumulator sums the forces more accurately than the working precision.
+    \tparam T The accumulator type
+
+    The drivers of such accumulators do not scatter the pair forces to the source particles, which would be
+    summed by float atomics; instead, every particle sums all its pair forces in its own accumulator
+    (see pairwise_gather).
+ */
+template <typename T>
+struct isAccurateForceAccumulator
+{
+    /// default type trait value
+    static constexpr bool value = false;
+};
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS // warnings in breathe
+
+template <class Sum>
+struct isAccurateForceAccumulator<BasicForceAccumulator<Sum>>
+{
+    static constexpr bool value = !std::is_same<Sum, PlainSum3>::value;
+};
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /** Get the force from a generalized force.
     \return force vector
  */
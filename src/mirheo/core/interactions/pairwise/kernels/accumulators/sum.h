@@ -0,0 +1,74 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <mirheo/core/datatypes.h>
+#include <mirheo/core/utils/cpu_gpu_defines.h>
+#include <mirheo/core/utils/helper_math.h>
+
+namespace mirheo
+{
+
+/// Sum of real3 values in the working precision
+class PlainSum3
+{
+public:
+    /// add \p v to the sum
+    __HD__ void add(real3 v) {sum_ += v;}
+
+    /// \return the sum
+    __HD__ real3 get() const {return sum_;}
+
+private:
+    real3 sum_ {0.0_r, 0.0_r, 0.0_r}; ///< current sum
+};
+
+/** \brief Compensated (Kahan) sum of real3 values.
+
+    The rounding error of each addition is kept and subtracted from the next term,
+    so that the error of the sum does not grow with the number of terms.
+    Must not be compiled with flags that allow the compiler to reassociate floating point operations
+    (e.g. -ffast-math on the host; nvcc does not reassociate, even with --use_fast_math).
+ */
+class KahanSum3
+{
+public:
+    /// add \p v to the sum
+    __HD__ void add(real3 v)
+    {
+        const real3 y = v - compensation_;
+        const real3 t = sum_ + y;
+        compensation_ = (t - sum_) - y;
+        sum_ = t;
+    }
+
+    /// \return the sum
+    __HD__ real3 get() const {return sum_;}
+
+private:
+    real3 sum_          {0.0_r, 0.0_r, 0.0_r}; ///< current sum
+    real3 compensation_ {0.0_r, 0.0_r, 0.0_r}; ///< rounding error of the last addition
+};
+
+/// Sum of real3 values in double precision
+class DoubleSum3
+{
+public:
+    /// add \p v to the sum
+    __HD__ void add(real3 v) {sum_ += make_double3(v);}
+
+    /// \return the sum, rounded to the working precision
+    __HD__ real3 get() const {return make_real3(sum_);}
+
+private:
+    double3 sum_ {0.0, 0.0, 0.0}; ///< current sum
+};
+
+#if defined(MIRHEO_PAIRWISE_ACCUMULATION_DOUBLE)
+using ForceSum3 = DoubleSum3; ///< The sum used to accumulate the pairwise forces of one particle
+#elif defined(MIRHEO_PAIRWISE_ACCUMULATION_KAHAN)
+using ForceSum3 = KahanSum3;  ///< The sum used to accumulate the pairwise forces of one particle
+#else
+using ForceSum3 = PlainSum3;  ///< The sum used to accumulate the pairwise forces of one particle
+#endif
+
+} // namespace mirheo
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "drivers.h"
+#include "kernels/accumulators/force.h"
 #include "stress.h"
 
 #include <mirheo/core/celllist.h>
@@ -36,6 +37,68 @@ do{ debug2("Dispatched to "#TPP" thread(s) per particle variant");
     else                            { DISPATCH_EXTERNAL(P1, P2, P3, 1,  INTERACTION_FUNCTION); } } while(0)
 
 
+/** \return \c true if the interactions of \p pair must be computed with the gather kernels (see pairwise_gather).
+
+    This is the case for deterministic forces (see MirState::deterministicForces), and when the forces are summed more
+    accurately than the working precision (see isAccurateForceAccumulator): the contributions to the source particles
+    would otherwise be added with atomics in the working precision.
+*/
+template<class PairwiseKernel>
+inline bool needsGather(const MirState *state, PairwiseKernel& pair)
+{
+    using Accumulator = std::decay_t<decltype(pair.handler().getZeroedAccumulator())>;
+    return state->deterministicForces || isAccurateForceAccumulator<Accumulator>::value;
+}
+
+/** \brief Gather version of computeLocal(), see needsGather().
+
+    Every particle accumulates its own output; for external interactions,
+    the kernel is launched once for each ParticleVector.
+*/
+template<class PairwiseKernel>
+void computeLocalGather(const MirState *state, PairwiseKernel& pair,
+                        ParticleVector *pv1, ParticleVector *pv2,
+                        CellList *cl1, CellList *cl2, cudaStream_t stream)
+{
+    using ViewType = typename PairwiseKernel::ViewType;
+    const int nth = 128;
+
+    if (pv1 == pv2)
+    {
+        pair.setup(pv1->local(), pv2->local(), cl1, cl2, state);
+
+        auto view = cl1->getView<ViewType>();
+        debug("Computing internal forces for %s (%d particles, gather)", pv1->getCName(), view.size);
+
+        SAFE_KERNEL_LAUNCH(
+                           computeSelfInteractionsGather,
+                           getNblocks(view.size, nth), nth, 0, stream,
+                           cl1->cellInfo(), view, pair.handler());
+    }
+    else
+    {
+        auto view1 = cl1->getView<ViewType>();
+        auto view2 = cl2->getView<ViewType>();
+        debug("Computing external forces for %s - %s (%d - %d particles, gather)",
+              pv1->getCName(), pv2->getCName(), view1.size, view2.size);
+
+        if (view1.size == 0 || view2.size == 0)
+            return;
+
+        pair.setup(pv1->local(), pv2->local(), cl1, cl2, state);
+        SAFE_KERNEL_LAUNCH(
+                           computeExternalInteractionsGather,
+                           getNblocks(view1.size, nth), nth, 0, stream,
+                           view1, cl2->cellInfo(), view2, pairwise_gather::DirectIds{}, pair.handler());
+
+        pair.setup(pv2->local(), pv1->local(), cl2, cl1, state);
+        SAFE_KERNEL_LAUNCH(
+                           computeExternalInteractionsGather,
+                           getNblocks(view2.size, nth), nth, 0, stream,
+                           view2, cl1->cellInfo(), view1, pairwise_gather::DirectIds{}, pair.handler());
+    }
+}
+
 /** \brief Compute forces between all the pairs of particles that are closer
     than rc to each other.
 
@@ -50,6 +113,12 @@ void computeLocal(const MirState *state, PairwiseKernel& pair,
 {
     using ViewType = typename PairwiseKernel::ViewType;
 
+    if (needsGather(state, pair))
+    {
+        computeLocalGather(state, pair, pv1, pv2, cl1, cl2, stream);
+        return;
+    }
+
     pair.setup(pv1->local(), pv2->local(), cl1, cl2, state);
 
     /*  Self interaction */
@@ -87,6 +156,50 @@ void computeLocal(const MirState *state, PairwiseKernel& pair,
     }
 }
 
+/** \brief Gather version of computeHalo(), see needsGather().
+
+    The local particles of \p pv2 gather the contributions of the halo particles of \p pv1,
+    sorted in a HaloCellList. For objects, the halo particles gather the contributions of the local ones.
+*/
+template<class PairwiseKernel>
+void computeHaloGather(const MirState *state, PairwiseKernel& pair,
+                       ParticleVector *pv1, ParticleVector *pv2,
+                       CellList *cl1, CellList *cl2,
+                       cudaStream_t stream)
+{
+    using ViewType = typename PairwiseKernel::ViewType;
+    const int nth = 128;
+
+    ViewType haloView(pv1, pv1->halo());
+    auto localView = cl2->getView<ViewType>();
+
+    debug("Computing halo forces for %s(halo) - %s (%d - %d particles) with rc = %g, gather",
+          pv1->getCName(), pv2->getCName(), haloView.size, localView.size, cl2->rc);
+
+    if (haloView.size == 0 || localView.size == 0)
+        return;
+
+    const bool isOV1 = dynamic_cast<ObjectVector *>(pv1) != nullptr;
+
+    if (isOV1)
+    {
+        pair.setup(pv1->halo(), pv2->local(), cl1, cl2, state);
+        SAFE_KERNEL_LAUNCH(
+                           computeExternalInteractionsGather,
+                           getNblocks(haloView.size, nth), nth, 0, stream,
+                           haloView, cl2->cellInfo(), localView, pairwise_gather::DirectIds{}, pair.handler());
+    }
+
+    auto haloCells = cl1->buildHaloCellList(stream);
+
+    pair.setup(pv2->local(), pv1->halo(), cl2, cl1, state);
+    SAFE_KERNEL_LAUNCH(
+                       computeExternalInteractionsGather,
+                       getNblocks(localView.size, nth), nth, 0, stream,
+                       localView, haloCells->cellInfo(), haloView,
+                       pairwise_gather::IndirectIds{haloCells->getSortedIds()}, pair.handler());
+}
+
 /** \brief Compute halo forces
 
     Note: for ObjectVector objects, the forces will be computed even for halos, except when it's the same ObjectVector.
@@ -101,6 +214,12 @@ void computeHalo(const MirState *state, PairwiseKernel& pair,
 {
     using ViewType = typename PairwiseKernel::ViewType;
 
+    if (needsGather(state, pair))
+    {
+        computeHaloGather(state, pair, pv1, pv2, cl1, cl2, stream);
+        return;
+    }
+
     pair.setup(pv1->halo(), pv2->local(), cl1, cl2, state);
 
     const int np1 = pv1->halo()->size();  // note halo here
@@ -24,6 +24,12 @@ struct GPU_RodBoundsParameters
     real ksFrame;  ///< energy constraint coefficient within the material frame
 };
 
+/// \return The number of elements of each color when \p nPerRod elements of a rod are split into \p nColors colors
+__HD__ inline int getNumPerColor(int nPerRod, int nColors)
+{
+    return (nPerRod + nColors - 1) / nColors;
+}
+
 namespace rod_forces_kernels
 {
 
@@ -40,15 +46,42 @@ __device__ inline rReal3 fbound(const rReal3& r0, const rReal3& r1, const real k
     return (linv * fmagn) * dr;
 }
 
-__global__ void computeRodBoundForces(RVview view, GPU_RodBoundsParameters params)
+/** \brief Map a thread to an element (segment or bisegment) of a given color.
+    \param [in] i The thread index
+    \param [in] nPerRod Number of elements per rod
+    \param [in] color The color of the elements processed by the current launch
+    \param [in] nColors Total number of colors
+    \param [out] rodId The rod index
+    \param [out] elementId The index of the element within its rod
+    \return \c false if the thread has no element
+
+    The elements of color \p color are \p color, \p color + \p nColors, ...
+    With enough colors, the elements of one launch do not share any particle (see MirState::deterministicForces).
+    With a single color, all elements are processed by the same launch.
+ */
+__device__ inline bool getColoredElement(int i, int nPerRod, int color, int nColors, const RVview& view,
+                                         int& rodId, int& elementId)
 {
-    const int i = threadIdx.x + blockIdx.x * blockDim.x;
-    const int rodId     = i / view.nSegments;
-    const int segmentId = i % view.nSegments;
-    const int start = view.objSize * rodId + segmentId * 5;
+    const int nPerColor = getNumPerColor(nPerRod, nColors);
+    rodId     = i / nPerColor;
+    elementId = color + nColors * (i % nPerColor);
+
+    return rodId < view.nObjects && elementId < nPerRod;
+}
+
+/// Number of colors needed for the segments of a rod (a segment shares particles with its 2 neighbours)
+constexpr int numSegmentColors = 2;
+/// Number of colors needed for the bisegments of a rod (a bisegment shares particles with its 4 neighbours)
+constexpr int numBiSegmentColors = 3;
+
+__global__ void computeRodBoundForces(RVview view, GPU_RodBoundsParameters params, int color, int nColors)
+{
+    int rodId, segmentId;
+    if (!getColoredElement(threadIdx.x + blockIdx.x * blockDim.x, view.nSegments,
+                           color, nColors, view, rodId, segmentId))
+        return;
 
-    if (rodId     >= view.nObjects ) return;
-    if (segmentId >= view.nSegments) return;
+    const int start = view.objSize * rodId + segmentId * 5;
 
     auto r0 = fetchPosition(view, start + 0);
     auto u0 = fetchPosition(view, start + 1);
@@ -105,17 +138,19 @@ __device__ inline int getState(const RVview& view, int i)
 }
 
 template <int Nstates>
-__global__ void computeRodBiSegmentForces(RVview view, GPU_RodBiSegmentParameters<Nstates> params, bool saveEnergies)
+__global__ void computeRodBiSegmentForces(RVview view, GPU_RodBiSegmentParameters<Nstates> params, bool saveEnergies,
+                                          int color, int nColors)
 {
     constexpr int stride = 5;
-    const int i = threadIdx.x + blockIdx.x * blockDim.x;
     const int nBiSegments = view.nSegments - 1;
-    const int rodId       = i / nBiSegments;
-    const int biSegmentId = i % nBiSegments;
-    const int start = view.objSize * rodId + biSegmentId * stride;
 
-    if (rodId       >= view.nObjects ) return;
-    if (biSegmentId >= nBiSegments   ) return;
+    int rodId, biSegmentId;
+    if (!getColoredElement(threadIdx.x + blockIdx.x * blockDim.x, nBiSegments,
+                           color, nColors, view, rodId, biSegmentId))
+        return;
+
+    const int i = rodId * nBiSegments + biSegmentId;
+    const int start = view.objSize * rodId + biSegmentId * stride;
 
     const BiSegment<Nstates> bisegment(view, start);
 
@@ -145,17 +180,19 @@ __global__ void computeRodBiSegmentForces(RVview view, GPU_RodBiSegmentParameter
 }
 
 __global__ void computeRodCurvatureSmoothing(RVview view, real kbi,
-                                             const real4 *kappa, const real2 *tau_l)
+                                             const real4 *kappa, const real2 *tau_l,
+                                             int color, int nColors)
 {
     constexpr int stride = 5;
-    const int i = threadIdx.x + blockIdx.x * blockDim.x;
     const int nBiSegments = view.nSegments - 1;
-    const int rodId       = i / nBiSegments;
-    const int biSegmentId = i % nBiSegments;
-    const int start = view.objSize * rodId + biSegmentId * stride;
 
-    if (rodId       >= view.nObjects ) return;
-    if (biSegmentId >= nBiSegments   ) return;
+    int rodId, biSegmentId;
+    if (!getColoredElement(threadIdx.x + blockIdx.x * blockDim.x, nBiSegments,
+                           color, nColors, view, rodId, biSegmentId))
+        return;
+
+    const int i = rodId * nBiSegments + biSegmentId;
+    const int start = view.objSize * rodId + biSegmentId * stride;
 
     const BiSegment<0> bisegment(view, start);
 
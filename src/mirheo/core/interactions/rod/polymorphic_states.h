@@ -39,12 +39,14 @@ static void updateStatesAndApplyForces(RodVector *rv,
                        nblocks, nthreads, 0, stream,
                        view, devParams, kappa, tau_l);
 
+    const int nColors = rv->getState()->deterministicForces ? rod_forces_kernels::numBiSegmentColors : 1;
     nthreads = 128;
-    nblocks  = getNblocks(view.nObjects * (view.nSegments-1), nthreads);
+    nblocks  = getNblocks(view.nObjects * getNumPerColor(view.nSegments-1, nColors), nthreads);
 
-    SAFE_KERNEL_LAUNCH(rod_forces_kernels::computeRodCurvatureSmoothing,
-                       nblocks, nthreads, 0, stream,
-                       view, stateParams.kSmoothing, kappa, tau_l);
+    for (int color = 0; color < nColors; ++color)
+        SAFE_KERNEL_LAUNCH(rod_forces_kernels::computeRodCurvatureSmoothing,
+                           nblocks, nthreads, 0, stream,
+                           view, stateParams.kSmoothing, kappa, tau_l, color, nColors);
 }
 
 static auto getGPUParams(StatesSpinParameters& p)
@@ -117,14 +117,16 @@ private:
     {
         RVview view(rv, rv->local());
 
+        const int nColors = _getNumColors(rod_forces_kernels::numSegmentColors);
         const int nthreads = 128;
-        const int nblocks  = getNblocks(view.nObjects * view.nSegments, nthreads);
+        const int nblocks  = getNblocks(view.nObjects * getNumPerColor(view.nSegments, nColors), nthreads);
 
         auto devParams = getBoundParams(parameters_);
 
-        SAFE_KERNEL_LAUNCH(rod_forces_kernels::computeRodBoundForces,
-                           nblocks, nthreads, 0, stream,
-                           view, devParams);
+        for (int color = 0; color < nColors; ++color)
+            SAFE_KERNEL_LAUNCH(rod_forces_kernels::computeRodBoundForces,
+                               nblocks, nthreads, 0, stream,
+                               view, devParams, color, nColors);
     }
 
     void _updatePolymorphicStatesAndApplyForces(RodVector *rv, cudaStream_t stream)
@@ -153,12 +155,20 @@ private:
         RVview view(rv, rv->local());
         auto devParams = getBiSegmentParams<Nstates>(parameters_);
 
+        const int nColors = _getNumColors(rod_forces_kernels::numBiSegmentColors);
         const int nthreads = 128;
-        const int nblocks  = getNblocks(view.nObjects * (view.nSegments-1), nthreads);
+        const int nblocks  = getNblocks(view.nObjects * getNumPerColor(view.nSegments-1, nColors), nthreads);
 
-        SAFE_KERNEL_LAUNCH(rod_forces_kernels::computeRodBiSegmentForces<Nstates>,
-                           nblocks, nthreads, 0, stream,
-                           view, devParams, saveEnergies_);
+        for (int color = 0; color < nColors; ++color)
+            SAFE_KERNEL_LAUNCH(rod_forces_kernels::computeRodBiSegmentForces<Nstates>,
+                               nblocks, nthreads, 0, stream,
+                               view, devParams, saveEnergies_, color, nColors);
+    }
+
+    /// In deterministic mode, the elements sharing particles are processed by separate launches.
+    int _getNumColors(int nColorsDeterministic) const
+    {
+        return getState()->deterministicForces ? nColorsDeterministic : 1;
     }
 
 private:
@@ -1,6 +1,8 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #include "parameters_wrap.h"
 
+#include <mirheo/core/utils/strprintf.h>
+
 namespace mirheo
 {
 
@@ -18,6 +20,39 @@ void ParametersWrap::checkAllRead() const
             die("invalid parameter '%s'", p.first.c_str());
 }
 
+namespace
+{
+struct ParamToString
+{
+    std::string operator()(real v) const {return strprintf("%a", static_cast<double>(v));}
+    std::string operator()(bool v) const {return v ? "true" : "false";}
+    std::string operator()(const std::string& v) const {return "'" + v + "'";}
+    std::string operator()(const std::vector<real>& v) const
+    {
+        std::string s = "[";
+        for (auto x : v)
+            s += (*this)(x) + ",";
+        return s + "]";
+    }
+    std::string operator()(const std::vector<real2>& v) const
+    {
+        std::string s = "[";
+        for (auto x : v)
+            s += "(" + (*this)(x.x) + "," + (*this)(x.y) + "),";
+        return s + "]";
+    }
+};
+} // anonymous namespace
+
+std::string ParametersWrap::toString(const MapParams& params)
+{
+    // std::map: the keys are sorted, so the string does not depend on the insertion order
+    std::string s;
+    for (const auto& p : params)
+        s += p.first + "=" + std::visit(ParamToString{}, p.second) + ";";
+    return s;
+}
+
 real2 ParametersWrap::_read(const std::string& key, ParametersWrap::Identity<real2>)
 {
     const auto v = read<std::vector<real>>(key);
@@ -49,6 +49,12 @@ public:
     /// \brief Die if some keys were not read (see read())
     void checkAllRead() const;
 
+    /** \brief Describe all parameters in a string.
+        \param [in] params The parameters.
+        \return A string that contains all keys and values; reals are written exactly.
+     */
+    static std::string toString(const MapParams& params);
+
     /** \brief Fetch a parameter value for a given key.
         \tparam T the type of the parameter to read.
         \param [in] key the parameter name to read.
@@ -67,7 +67,7 @@ std::vector<int> computeEdgeColors(const MembraneMesh *mesh)
 
 MeshDistinctEdgeSets::MeshDistinctEdgeSets(const MembraneMesh *mesh)
 {
-    const auto colors = computeEdgeColors(mesh);
+    const auto& colors = mesh->getEdgeColors();
     const int maxColor = *std::max_element(colors.begin(), colors.end());
     const int numColors = maxColor + 1;
 
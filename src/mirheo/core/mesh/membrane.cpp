@@ -1,5 +1,8 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #include "membrane.h"
+#include "edge_colors.h"
+#include "mesh_cache.h"
+#include "off.h"
 
 #include <mirheo/core/utils/cuda_common.h>
 #include <mirheo/core/utils/file_wrapper.h>
@@ -19,13 +22,24 @@ MembraneMesh::MembraneMesh()
 {}
 
 MembraneMesh::MembraneMesh(const std::string& initialMesh) :
-    Mesh(initialMesh)
-{
-    _findAdjacent();
-    _computeInitialQuantities(vertices_);
-}
+    MembraneMesh(initialMesh, initialMesh)
+{}
 
+MembraneMesh::MembraneMesh(const std::string& initialMesh, const std::string& stressFreeMesh,
+                           const std::string& cacheFolder) :
+    MembraneMesh(initialMesh, stressFreeMesh,
+                 mesh_cache::getEntry(mesh_cache::Content::Membrane, initialMesh, stressFreeMesh, cacheFolder))
+{}
 
+static std::tuple<std::vector<real3>, std::vector<int3>>
+readGeometry(const std::string& fileName, const mesh_cache::Entry& entry)
+{
+    const mesh_cache::Reader cache(entry.fileName, entry.key);
+    if (cache.has(mesh_cache::Section::Vertices) && cache.has(mesh_cache::Section::Faces))
+        return {cache.get<real3>(mesh_cache::Section::Vertices),
+                cache.get<int3> (mesh_cache::Section::Faces)};
+    return readOff(fileName);
+}
 
 static bool sameFaces(const PinnedBuffer<int3>& facesA, const PinnedBuffer<int3>& facesB)
 {
@@ -46,19 +60,66 @@ static bool sameFaces(const PinnedBuffer<int3>& facesA, const PinnedBuffer<int3>
     return true;
 }
 
-MembraneMesh::MembraneMesh(const std::string& initialMesh, const std::string& stressFreeMesh) :
-    Mesh(initialMesh)
+MembraneMesh::MembraneMesh(const std::string& initialMesh, const std::string& stressFreeMesh,
+                           const mesh_cache::Entry& entry) :
+    Mesh(readGeometry(initialMesh, entry))
 {
-    Mesh stressFree(stressFreeMesh);
-
-    if (!sameFaces(this->getFaces(), stressFree.getFaces()))
-        die("Must pass meshes with same connectivity for initial positions and stressFree vertices");
+    using mesh_cache::Section;
+    const mesh_cache::Reader cache(entry.fileName, entry.key);
 
-    if (this->getNvertices() != stressFree.getNvertices())
-        die("Must pass same number of vertices for initial positions and stressFree vertices");
+    if (cache.has(Section::Adjacent) && cache.getMaxDegree() == getMaxDegree())
+    {
+        cache.copyTo(Section::Adjacent,           adjacent_);
+        cache.copyTo(Section::Degrees,            degrees_);
+        cache.copyTo(Section::InitialLengths,     initialLengths_);
+        cache.copyTo(Section::InitialAreas,       initialAreas_);
+        cache.copyTo(Section::InitialDotProducts, initialDotProducts_);
+        edgeColors_ = cache.get<int>(Section::EdgeColors);
+
+        adjacent_          .uploadToDevice(defaultStream);
+        degrees_           .uploadToDevice(defaultStream);
+        initialLengths_    .uploadToDevice(defaultStream);
+        initialAreas_      .uploadToDevice(defaultStream);
+        initialDotProducts_.uploadToDevice(defaultStream);
+        return;
+    }
 
     _findAdjacent();
-    _computeInitialQuantities(stressFree.getVertices());
+
+    if (stressFreeMesh == initialMesh)
+    {
+        _computeInitialQuantities(vertices_);
+    }
+    else
+    {
+        Mesh stressFree(readOff(stressFreeMesh));
+
+        if (!sameFaces(this->getFaces(), stressFree.getFaces()))
+            die("Must pass meshes with same connectivity for initial positions and stressFree vertices");
+
+        if (this->getNvertices() != stressFree.getNvertices())
+            die("Must pass same number of vertices for initial positions and stressFree vertices");
+
+        _computeInitialQuantities(stressFree.getVertices());
+    }
+
+    if (entry.fileName.empty())
+        return;
+
+    std::vector<real3> vertices(getNvertices());
+    for (int i = 0; i < getNvertices(); ++i)
+        vertices[i] = make_real3(vertices_[i]);
+
+    mesh_cache::Writer writer(getMaxDegree());
+    writer.add(Section::Vertices,           vertices);
+    writer.add(Section::Faces,              faces_);
+    writer.add(Section::Adjacent,           adjacent_);
+    writer.add(Section::Degrees,            degrees_);
+    writer.add(Section::InitialLengths,     initialLengths_);
+    writer.add(Section::InitialAreas,       initialAreas_);
+    writer.add(Section::InitialDotProducts, initialDotProducts_);
+    writer.add(Section::EdgeColors,         getEdgeColors());
+    writer.write(entry.fileName, entry.key);
 }
 
 MembraneMesh::MembraneMesh(const std::vector<real3>& vertices,
@@ -126,6 +187,13 @@ static void findNearestNeighbours(const EdgeMapPerVertex& adjacentPairs, int max
     }
 }
 
+const std::vector<int>& MembraneMesh::getEdgeColors() const
+{
+    if (edgeColors_.empty())
+        edgeColors_ = computeEdgeColors(this);
+    return edgeColors_;
+}
+
 void MembraneMesh::_findAdjacent()
 {
     /*
@@ -236,14 +304,14 @@ void MembraneMesh::_computeInitialDotProducts(const PinnedBuffer<real4>& vertice
 }
 
 
-MembraneMeshView::MembraneMeshView(const MembraneMesh *m) :
-    MeshView(m),
+MembraneMeshView::MembraneMeshView(const MembraneMesh *m, bool onDevice) :
+    MeshView(m, onDevice),
     maxDegree          (m->getMaxDegree()),
-    adjacent           (m->adjacent_.devPtr()),
-    degrees            (m->degrees_.devPtr()),
-    initialLengths     (m->initialLengths_.devPtr()),
-    initialAreas       (m->initialAreas_.devPtr()),
-    initialDotProducts (m->initialDotProducts_.devPtr())
+    adjacent           (onDevice ? m->adjacent_.devPtr()           : m->adjacent_.hostPtr()),
+    degrees            (onDevice ? m->degrees_.devPtr()            : m->degrees_.hostPtr()),
+    initialLengths     (onDevice ? m->initialLengths_.devPtr()     : m->initialLengths_.hostPtr()),
+    initialAreas       (onDevice ? m->initialAreas_.devPtr()       : m->initialAreas_.hostPtr()),
+    initialDotProducts (onDevice ? m->initialDotProducts_.devPtr() : m->initialDotProducts_.hostPtr())
 {}
 
 } // namespace mirheo
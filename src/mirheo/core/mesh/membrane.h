@@ -5,9 +5,14 @@
 
 #include <mirheo/core/containers.h>
 
+#include <string>
+#include <vector>
+
 namespace mirheo
 {
 
+namespace mesh_cache { struct Entry; }
+
 /** \brief A triangle mesh with face connectivity, adjacent vertices and geometric precomputed values.
     This class was designed to assist MembraneInteraction.
 
@@ -36,9 +41,11 @@ public:
     /** \brief Construct a MembraneMesh from an off file
         \param initialMesh File (in off format) that contains the mesh information.
         \param stressFreeMesh File (in off format) that contains the stress free state of the mesh.
+        \param cacheFolder The folder of the binary mesh cache (see mesh_cache).
         \note \p initialMesh and \p stressFreeMesh must have the same topology.
     */
-    MembraneMesh(const std::string& initialMesh, const std::string& stressFreeMesh);
+    MembraneMesh(const std::string& initialMesh, const std::string& stressFreeMesh,
+                 const std::string& cacheFolder = "");
 
     /** \brief Construct a MembraneMesh from a list of vertices and faces
         \param vertices The vertex coordinates of the mesh
@@ -68,7 +75,14 @@ public:
     /// \return The degree of each vertex
     const PinnedBuffer<int>& getDegrees() const {return degrees_; }
 
+    /// \return The color of all edges, in the adjacency list order (see computeEdgeColors()); computed on first call.
+    const std::vector<int>& getEdgeColors() const;
+
 private:
+    /// construct from off files, using the mesh cache \p entry if it is valid
+    MembraneMesh(const std::string& initialMesh, const std::string& stressFreeMesh,
+                 const mesh_cache::Entry& entry);
+
     /// compute the adjacent vertices lists of all vertices
     void _findAdjacent();
 
@@ -88,6 +102,7 @@ private:
     PinnedBuffer<real> initialLengths_; ///< length of each edge in the stress-free state; data layout is the same as adjacent_
     PinnedBuffer<real> initialAreas_;    ///< length of each triangle in the stress-free state; data layout is the same as adjacent_
     PinnedBuffer<real> initialDotProducts_;  ///< dot product between two consecutive edges in the stress-free state; data layout is the same as adjacent_
+    mutable std::vector<int> edgeColors_; ///< edge colors; empty until needed
 };
 
 /// A device-compatible structure that represents a data stored in a MembraneMesh additionally to its topology
@@ -102,8 +117,8 @@ struct MembraneMeshView : public MeshView
     real *initialAreas;       ///< areas of each face in the stress-free state
     real *initialDotProducts; ///< do products between adjacent edges in the stress-free state
 
-    /// Construct a MembraneMeshView from a MembraneMesh object
-    MembraneMeshView(const MembraneMesh *m);
+    /// Construct a MembraneMeshView from a MembraneMesh object; \p onDevice selects the device or host pointers
+    MembraneMeshView(const MembraneMesh *m, bool onDevice = true);
 };
 
 } // namespace mirheo
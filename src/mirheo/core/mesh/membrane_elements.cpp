@@ -0,0 +1,248 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "membrane_elements.h"
+#include "membrane.h"
+
+#include <mirheo/core/logger.h>
+#include <mirheo/core/utils/cuda_common.h>
+
+#include <algorithm>
+#include <array>
+
+namespace mirheo
+{
+
+namespace
+{
+/// Helper to navigate in the adjacency lists of a MembraneMesh.
+class Adjacency
+{
+public:
+    Adjacency(const MembraneMesh *mesh) :
+        adj_(mesh->getAdjacents()),
+        deg_(mesh->getDegrees()),
+        maxDegree_(mesh->getMaxDegree())
+    {}
+
+    int vertex(int adjId) const {return adj_[adjId];}
+    int degree(int v) const {return deg_[v];}
+    int adjId(int v, int d) const {return maxDegree_ * v + d;}
+
+    int next(int v, int adjId) const
+    {
+        const int start = maxDegree_ * v;
+        return start + (adjId - start + 1) % deg_[v];
+    }
+
+    int prev(int v, int adjId) const
+    {
+        const int start = maxDegree_ * v;
+        return start + (adjId - start + deg_[v] - 1) % deg_[v];
+    }
+
+    /// \return the index of \p to in the adjacency list of \p from
+    int find(int from, int to) const
+    {
+        for (int d = 0; d < deg_[from]; ++d)
+        {
+            const int i = adjId(from, d);
+            if (adj_[i] == to)
+                return i;
+        }
+        die("Vertex %d is not adjacent to vertex %d", to, from);
+        return -1;
+    }
+
+private:
+    const PinnedBuffer<int>& adj_;
+    const PinnedBuffer<int>& deg_;
+    int maxDegree_;
+};
+
+/** Greedy coloring of elements made of N vertices: elements that share a vertex get different colors.
+    \return The color of each element
+ */
+template <size_t N>
+std::vector<int> colorElements(const std::vector<std::array<int, N>>& elements, int nvertices)
+{
+    std::vector<std::vector<bool>> usedColors(nvertices);
+    std::vector<int> colors;
+    colors.reserve(elements.size());
+
+    for (const auto& e : elements)
+    {
+        int color = 0;
+        auto isUsed = [&](int c)
+        {
+            for (int v : e)
+                if (c < static_cast<int>(usedColors[v].size()) && usedColors[v][c])
+                    return true;
+            return false;
+        };
+
+        while (isUsed(color))
+            ++color;
+
+        for (int v : e)
+        {
+            if (static_cast<int>(usedColors[v].size()) <= color)
+                usedColors[v].resize(color + 1, false);
+            usedColors[v][color] = true;
+        }
+        colors.push_back(color);
+    }
+    return colors;
+}
+
+/// Sort the elements by color (stable) and compute the start of each color.
+template <class T>
+void sortByColor(const std::vector<T>& elements, const std::vector<int>& colors,
+                 PinnedBuffer<T>& sorted, PinnedBuffer<int>& colorStarts)
+{
+    const int numColors = colors.empty() ? 0 : 1 + *std::max_element(colors.begin(), colors.end());
+
+    std::vector<int> starts(numColors + 1, 0);
+    for (int c : colors)
+        ++starts[c + 1];
+    for (int c = 0; c < numColors; ++c)
+        starts[c + 1] += starts[c];
+
+    sorted.resize_anew(elements.size());
+    std::vector<int> offsets(starts.begin(), starts.end() - 1);
+    for (size_t i = 0; i < elements.size(); ++i)
+        sorted[offsets[colors[i]]++] = elements[i];
+
+    colorStarts.resize_anew(starts.size());
+    std::copy(starts.begin(), starts.end(), colorStarts.begin());
+
+    sorted     .uploadToDevice(defaultStream);
+    colorStarts.uploadToDevice(defaultStream);
+}
+} // anonymous namespace
+
+MembraneMeshElements::MembraneMeshElements(const MembraneMesh *mesh)
+{
+    const Adjacency adj(mesh);
+    const int nv = mesh->getNvertices();
+
+    for (int v = 0; v < nv; ++v)
+        if (adj.degree(v) < 3)
+            die("Membrane elements: vertex %d has degree %d; the mesh must be closed", v, adj.degree(v));
+
+    // triangles, each one is stored once from its vertex with the smallest index
+    std::vector<MembraneTriangle> triangles;
+    std::vector<std::array<int, 3>> triangleVertices;
+
+    for (int a = 0; a < nv; ++a)
+    {
+        for (int d = 0; d < adj.degree(a); ++d)
+        {
+            const int ab = adj.adjId(a, d);
+            const int ac = adj.next(a, ab);
+            const int b = adj.vertex(ab);
+            const int c = adj.vertex(ac);
+
+            if (b < a || c < a)
+                continue;
+
+            const int bc = adj.find(b, c);
+            const int ca = adj.find(c, a);
+            const int ba = adj.next(b, bc);
+            const int cb = adj.next(c, ca);
+
+            if (adj.vertex(ba) != a || adj.vertex(cb) != b)
+                die("Membrane elements: triangle (%d %d %d) is not consistently oriented", a, b, c);
+
+            triangles.push_back({{a, b, c}, {ab, bc, ca}, {ac, ba, cb}});
+            triangleVertices.push_back({a, b, c});
+        }
+    }
+
+    // dihedrals, each one is stored once from the smallest vertex of its shared edge
+    std::vector<int4> dihedrals;
+    std::vector<std::array<int, 4>> dihedralVertices;
+
+    for (int v0 = 0; v0 < nv; ++v0)
+    {
+        for (int d = 0; d < adj.degree(v0); ++d)
+        {
+            const int i02 = adj.adjId(v0, d);
+            const int v2 = adj.vertex(i02);
+
+            if (v2 < v0)
+                continue;
+
+            const int v1 = adj.vertex(adj.prev(v0, i02));
+            const int v3 = adj.vertex(adj.next(v0, i02));
+
+            const int i20 = adj.find(v2, v0);
+            if (adj.vertex(adj.prev(v2, i20)) != v3 || adj.vertex(adj.next(v2, i20)) != v1)
+                die("Membrane elements: dihedral (%d %d %d %d) is not consistently oriented", v0, v1, v2, v3);
+
+            dihedrals.push_back({v0, v1, v2, v3});
+            dihedralVertices.push_back({v0, v1, v2, v3});
+        }
+    }
+
+    // edges, with the colors of the mesh
+    const auto& edgeColors = mesh->getEdgeColors();
+    std::vector<int2> edges;
+    std::vector<int> edgeColorsSorted;
+
+    for (int v = 0; v < nv; ++v)
+    {
+        for (int d = 0; d < adj.degree(v); ++d)
+        {
+            const int i = adj.adjId(v, d);
+            const int w = adj.vertex(i);
+
+            if (w < v)
+                continue;
+
+            if (edgeColors[i] < 0)
+                die("Membrane elements: edge (%d %d) has no color", v, w);
+
+            edges.push_back({v, w});
+            edgeColorsSorted.push_back(edgeColors[i]);
+        }
+    }
+
+    sortByColor(triangles, colorElements(triangleVertices, nv), triangles_, triangleColorStarts_);
+    sortByColor(dihedrals, colorElements(dihedralVertices, nv), dihedrals_, dihedralColorStarts_);
+    sortByColor(edges, edgeColorsSorted, edges_, edgeColorStarts_);
+
+    debug("Membrane elements: %d triangle colors, %d dihedral colors, %d edge colors",
+          getNumTriangleColors(), getNumDihedralColors(), getNumEdgeColors());
+}
+
+int MembraneMeshElements::getNumTriangleColors() const {return static_cast<int>(triangleColorStarts_.size()) - 1;}
+int MembraneMeshElements::getNumDihedralColors() const {return static_cast<int>(dihedralColorStarts_.size()) - 1;}
+int MembraneMeshElements::getNumEdgeColors()     const {return static_cast<int>(edgeColorStarts_    .size()) - 1;}
+
+const PinnedBuffer<MembraneTriangle>& MembraneMeshElements::getTriangles() const {return triangles_;}
+const PinnedBuffer<int4>& MembraneMeshElements::getDihedrals() const {return dihedrals_;}
+const PinnedBuffer<int2>& MembraneMeshElements::getEdges() const {return edges_;}
+
+const PinnedBuffer<int>& MembraneMeshElements::getTriangleColorStarts() const {return triangleColorStarts_;}
+const PinnedBuffer<int>& MembraneMeshElements::getDihedralColorStarts() const {return dihedralColorStarts_;}
+const PinnedBuffer<int>& MembraneMeshElements::getEdgeColorStarts()     const {return edgeColorStarts_;}
+
+
+template <class T>
+static const T* getPtr(const PinnedBuffer<T>& buffer, bool onDevice)
+{
+    return onDevice ? buffer.devPtr() : buffer.hostPtr();
+}
+
+MembraneMeshElementsView::MembraneMeshElementsView(const MembraneMeshElements *elements, bool onDevice) :
+    nTriangleColors(elements->getNumTriangleColors()),
+    nDihedralColors(elements->getNumDihedralColors()),
+    nEdgeColors    (elements->getNumEdgeColors()),
+    triangles(getPtr(elements->getTriangles(), onDevice)),
+    dihedrals(getPtr(elements->getDihedrals(), onDevice)),
+    edges    (getPtr(elements->getEdges(),     onDevice)),
+    triangleColorStarts(getPtr(elements->getTriangleColorStarts(), onDevice)),
+    dihedralColorStarts(getPtr(elements->getDihedralColorStarts(), onDevice)),
+    edgeColorStarts    (getPtr(elements->getEdgeColorStarts(),     onDevice))
+{}
+
+} // namespace mirheo
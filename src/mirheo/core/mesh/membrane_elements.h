@@ -0,0 +1,88 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <mirheo/core/containers.h>
+#include <mirheo/core/datatypes.h>
+
+#include <vector>
+
+namespace mirheo
+{
+
+class MembraneMesh;
+
+/** \brief A triangle of a MembraneMesh, with the adjacency information of its three corners.
+
+    The vertices are ordered as in the adjacency lists: for each corner, the next vertex (cyclically)
+    follows the previous one in the adjacency list of that corner.
+ */
+struct MembraneTriangle
+{
+    int3 vertices; ///< vertex indices
+    int3 adjFirst;  ///< for each corner, index (in the adjacency list space) of the next vertex
+    int3 adjSecond; ///< for each corner, index (in the adjacency list space) of the next-next vertex
+};
+
+/** \brief The elements (triangles, dihedrals and edges) of a MembraneMesh, grouped by colors.
+
+    Two elements of the same color never share a vertex, so that the forces of all elements of one color
+    can be accumulated in parallel without atomic operations.
+    Accumulating the colors one after the other gives forces that do not depend on the scheduling of the threads.
+
+    A dihedral is stored as the four vertices (v0, v1, v2, v3) of the two triangles (v0, v1, v2) and (v0, v2, v3)
+    that share the edge (v0, v2).
+    The edges are colored as in computeEdgeColors().
+ */
+class MembraneMeshElements
+{
+public:
+    /** \brief Construct a MembraneMeshElements.
+        \param [in] mesh The mesh with adjacency lists; it must be closed and consistently oriented.
+     */
+    MembraneMeshElements(const MembraneMesh *mesh);
+
+    int getNumTriangleColors() const; ///< \return the number of colors of the triangles
+    int getNumDihedralColors() const; ///< \return the number of colors of the dihedrals
+    int getNumEdgeColors() const;     ///< \return the number of colors of the edges
+
+    const PinnedBuffer<MembraneTriangle>& getTriangles() const; ///< \return the triangles, sorted by color
+    const PinnedBuffer<int4>& getDihedrals() const;             ///< \return the dihedrals, sorted by color
+    const PinnedBuffer<int2>& getEdges() const;                 ///< \return the edges, sorted by color
+
+    /// \return the start of each color in getTriangles(), followed by the number of triangles
+    const PinnedBuffer<int>& getTriangleColorStarts() const;
+    /// \return the start of each color in getDihedrals(), followed by the number of dihedrals
+    const PinnedBuffer<int>& getDihedralColorStarts() const;
+    /// \return the start of each color in getEdges(), followed by the number of edges
+    const PinnedBuffer<int>& getEdgeColorStarts() const;
+
+private:
+    PinnedBuffer<MembraneTriangle> triangles_;
+    PinnedBuffer<int4> dihedrals_;
+    PinnedBuffer<int2> edges_;
+
+    PinnedBuffer<int> triangleColorStarts_;
+    PinnedBuffer<int> dihedralColorStarts_;
+    PinnedBuffer<int> edgeColorStarts_;
+};
+
+/// A device-compatible view of a MembraneMeshElements.
+struct MembraneMeshElementsView
+{
+    int nTriangleColors; ///< number of triangle colors
+    int nDihedralColors; ///< number of dihedral colors
+    int nEdgeColors;     ///< number of edge colors
+
+    const MembraneTriangle *triangles; ///< triangles sorted by color
+    const int4 *dihedrals;             ///< dihedrals sorted by color
+    const int2 *edges;                 ///< edges sorted by color
+
+    const int *triangleColorStarts; ///< start of each triangle color
+    const int *dihedralColorStarts; ///< start of each dihedral color
+    const int *edgeColorStarts;     ///< start of each edge color
+
+    /// Construct a view of a MembraneMeshElements; \p onDevice selects the device or host pointers.
+    MembraneMeshElementsView(const MembraneMeshElements *elements, bool onDevice = true);
+};
+
+} // namespace mirheo
@@ -1,7 +1,7 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #include "mesh.h"
 
-#include <mirheo/core/mesh/off.h>
+#include <mirheo/core/mesh/mesh_cache.h>
 #include <mirheo/core/utils/cuda_common.h>
 #include <mirheo/core/utils/helper_math.h>
 #include <mirheo/core/utils/path.h>
@@ -16,8 +16,8 @@ namespace mirheo
 Mesh::Mesh()
 {}
 
-Mesh::Mesh(const std::string& fileName) :
-    Mesh(readOff(fileName))
+Mesh::Mesh(const std::string& fileName, const std::string& cacheFolder) :
+    Mesh(mesh_cache::readOff(fileName, cacheFolder))
 {}
 
 Mesh::Mesh(const std::tuple<std::vector<real3>, std::vector<int3>>& mesh) :
@@ -113,10 +113,10 @@ void Mesh::_check() const
     }
 }
 
-MeshView::MeshView(const Mesh *m) :
+MeshView::MeshView(const Mesh *m, bool onDevice) :
     nvertices  (m->getNvertices()),
     ntriangles (m->getNtriangles()),
-    triangles  (m->getFaces().devPtr())
+    triangles  (onDevice ? m->getFaces().devPtr() : m->getFaces().hostPtr())
 {}
 
 } // namespace mirheo
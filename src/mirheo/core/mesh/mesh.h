@@ -24,8 +24,9 @@ public:
 
     /** Construct a \c Mesh from a off file
         \param fileName The name of the file (contains the extension).
+        \param cacheFolder The folder of the binary mesh cache (see mesh_cache).
      */
-    Mesh(const std::string& fileName);
+    Mesh(const std::string& fileName, const std::string& cacheFolder = "");
     /// Construct a \c Mesh from a list of vertices and faces.
     Mesh(const std::tuple<std::vector<real3>, std::vector<int3>>& mesh);
     /// Construct a \c Mesh from a list of vertices and faces.
@@ -71,8 +72,8 @@ struct MeshView
     int ntriangles;  ///< number of faces
     int3 *triangles; ///< list of faces
 
-    /// Construct a MeshView from a \c Mesh
-    MeshView(const Mesh *m);
+    /// Construct a MeshView from a \c Mesh; \p onDevice selects the device or host pointers
+    MeshView(const Mesh *m, bool onDevice = true);
 };
 
 } // namespace mirheo
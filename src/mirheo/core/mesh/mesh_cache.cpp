@@ -0,0 +1,361 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "mesh_cache.h"
+#include "off.h"
+
+#include <mirheo/core/logger.h>
+#include <mirheo/core/utils/path.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <random>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mirheo
+{
+namespace mesh_cache
+{
+
+static constexpr char magic[8] = {'M', 'I', 'R', 'M', 'E', 'S', 'H', '\0'};
+static constexpr uint32_t version = 1;
+static constexpr int numSections = static_cast<int>(Section::NumSections);
+
+namespace
+{
+/// Fixed-size header of the cache files; the arrays follow, each aligned to alignment bytes.
+struct Header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t realSize;
+    uint64_t key;
+    int32_t maxDegree;
+    int32_t padding;
+    uint64_t offsets[numSections]; ///< in bytes from the start of the file; 0 if not stored
+    uint64_t counts [numSections]; ///< number of elements
+    uint64_t elementSizes[numSections];
+};
+
+constexpr size_t alignment = 64;
+
+size_t alignUp(size_t n)
+{
+    return (n + alignment - 1) / alignment * alignment;
+}
+
+// FNV-1a, one 64-bit word at a time for speed
+uint64_t hashBytes(const char *data, size_t n, uint64_t h)
+{
+    constexpr uint64_t prime = 0x100000001b3ULL;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t))
+    {
+        uint64_t w;
+        memcpy(&w, data + i, sizeof(w));
+        h = (h ^ w) * prime;
+    }
+    for (; i < n; ++i)
+        h = (h ^ static_cast<uint64_t>(static_cast<unsigned char>(data[i]))) * prime;
+    return h;
+}
+
+uint64_t hashFile(const std::string& fileName, uint64_t h)
+{
+    FILE *f = fopen(fileName.c_str(), "rb");
+    if (f == nullptr)
+        die("off file '%s' not found", fileName.c_str());
+
+    std::vector<char> buffer(1 << 20);
+    size_t n;
+    while ((n = fread(buffer.data(), 1, buffer.size(), f)) > 0)
+        h = hashBytes(buffer.data(), n, h);
+
+    fclose(f);
+    return h;
+}
+/// create a folder and its parents, as "mkdir -p"; \return false on failure
+bool createFolder(const std::string& path)
+{
+    for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1))
+    {
+        const std::string sub = path.substr(0, pos);
+        if (!sub.empty() && mkdir(sub.c_str(), 0755) != 0 && errno != EEXIST)
+            return false;
+        if (pos == std::string::npos)
+            return true;
+    }
+}
+} // anonymous namespace
+
+uint64_t computeKey(const std::string& initialMesh, const std::string& stressFreeMesh)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    const uint64_t layout[] = {version, sizeof(real), sizeof(Header)};
+    h = hashBytes(reinterpret_cast<const char*>(layout), sizeof(layout), h);
+    h = hashFile(initialMesh, h);
+    if (stressFreeMesh != initialMesh)
+        h = hashFile(stressFreeMesh, h);
+    return h;
+}
+
+static std::string getAbsolutePath(const std::string& fileName)
+{
+    char *path = realpath(fileName.c_str(), nullptr);
+    if (path == nullptr)
+        return fileName;
+    std::string result(path);
+    free(path);
+    return result;
+}
+
+std::string getFileName(Content content, const std::string& initialMesh, const std::string& stressFreeMesh,
+                        const std::string& cacheFolder)
+{
+    std::string folder = cacheFolder;
+    if (folder.empty())
+    {
+        const char *dir = std::getenv("MIRHEO_MESH_CACHE_DIR");
+        if (dir != nullptr)
+            folder = dir;
+    }
+
+    if (folder.empty())
+        return "";
+
+    std::string paths = getAbsolutePath(initialMesh);
+    std::string name = getBaseName(initialMesh);
+    if (stressFreeMesh != initialMesh)
+    {
+        paths += '\n' + getAbsolutePath(stressFreeMesh);
+        name += "." + getBaseName(stressFreeMesh);
+    }
+
+    char pathHash[32];
+    snprintf(pathHash, sizeof(pathHash), "%016llx",
+             static_cast<unsigned long long>(hashBytes(paths.data(), paths.size(), 0xcbf29ce484222325ULL)));
+
+    name += std::string(".") + pathHash;
+    name += content == Content::Geometry ? ".mesh.mcache" : ".membrane.mcache";
+
+    return joinPaths(folder, name);
+}
+
+Entry getEntry(Content content, const std::string& initialMesh, const std::string& stressFreeMesh,
+               const std::string& cacheFolder)
+{
+    Entry entry;
+    entry.fileName = getFileName(content, initialMesh, stressFreeMesh, cacheFolder);
+    if (!entry.fileName.empty())
+        entry.key = computeKey(initialMesh, stressFreeMesh);
+    return entry;
+}
+
+
+Reader::Reader(const std::string& fileName, uint64_t key)
+{
+    if (fileName.empty())
+        return;
+
+    const int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header))
+    {
+        close(fd);
+        return;
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+    void *ptr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (ptr == MAP_FAILED)
+    {
+        size_ = 0;
+        return;
+    }
+    data_ = static_cast<const char*>(ptr);
+
+    const auto *header = reinterpret_cast<const Header*>(data_);
+
+    valid_ = memcmp(header->magic, magic, sizeof(magic)) == 0 &&
+        header->version == version &&
+        header->realSize == sizeof(real) &&
+        header->key == key;
+
+    for (int i = 0; valid_ && i < numSections; ++i)
+        valid_ = header->offsets[i] + header->counts[i] * header->elementSizes[i] <= size_;
+
+    if (valid_)
+        debug("Using mesh cache file '%s'", fileName.c_str());
+    else
+        debug("Mesh cache file '%s' is outdated", fileName.c_str());
+}
+
+Reader::~Reader()
+{
+    if (data_)
+        munmap(const_cast<char*>(data_), size_);
+}
+
+bool Reader::isValid() const
+{
+    return valid_;
+}
+
+bool Reader::has(Section section) const
+{
+    return valid_ && reinterpret_cast<const Header*>(data_)->offsets[static_cast<int>(section)] != 0;
+}
+
+int Reader::getMaxDegree() const
+{
+    return valid_ ? reinterpret_cast<const Header*>(data_)->maxDegree : 0;
+}
+
+size_t Reader::_getSize(Section section, size_t elementSize) const
+{
+    if (!has(section))
+        return 0;
+
+    const auto *header = reinterpret_cast<const Header*>(data_);
+    const int i = static_cast<int>(section);
+
+    if (header->elementSizes[i] != elementSize)
+        die("Mesh cache: section %d has elements of %zu bytes, expected %zu",
+            i, static_cast<size_t>(header->elementSizes[i]), elementSize);
+
+    return header->counts[i];
+}
+
+const char* Reader::_getData(Section section) const
+{
+    if (!has(section))
+        return nullptr;
+    return data_ + reinterpret_cast<const Header*>(data_)->offsets[static_cast<int>(section)];
+}
+
+
+Writer::Writer(int maxDegree) :
+    maxDegree_(maxDegree),
+    arrays_(numSections)
+{}
+
+void Writer::add(Section section, const void *data, size_t n, size_t elementSize)
+{
+    arrays_[static_cast<int>(section)] = {data, n, elementSize};
+}
+
+void Writer::write(const std::string& fileName, uint64_t key) const
+{
+    if (fileName.empty())
+        return;
+
+    int initialized = 0;
+    MPI_Check( MPI_Initialized(&initialized) );
+    if (initialized)
+    {
+        int rank = 0;
+        MPI_Check( MPI_Comm_rank(MPI_COMM_WORLD, &rank) );
+        if (rank != 0)
+            return;
+    }
+
+    const std::string folder = getParentPath(fileName);
+    if (!createFolder(folder))
+    {
+        warn("Could not create the mesh cache folder '%s'", folder.c_str());
+        return;
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.realSize = sizeof(real);
+    header.key = key;
+    header.maxDegree = maxDegree_;
+
+    size_t offset = alignUp(sizeof(Header));
+    for (int i = 0; i < numSections; ++i)
+    {
+        const auto& a = arrays_[i];
+        if (a.data == nullptr)
+            continue;
+        header.offsets[i] = offset;
+        header.counts[i] = a.n;
+        header.elementSizes[i] = a.elementSize;
+        offset = alignUp(offset + a.n * a.elementSize);
+    }
+
+    // unique temporary name: several processes may write the same cache concurrently
+    const std::string tmpName = fileName + ".tmp." + std::to_string(getpid()) + "." + std::to_string(std::random_device{}());
+
+    FILE *f = fopen(tmpName.c_str(), "wb");
+    if (f == nullptr)
+    {
+        warn("Could not write mesh cache file '%s'; choose a writable cache folder", fileName.c_str());
+        return;
+    }
+
+    const std::vector<char> zeros(alignment, 0);
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    size_t pos = sizeof(header);
+
+    for (int i = 0; ok && i < numSections; ++i)
+    {
+        const auto& a = arrays_[i];
+        if (a.data == nullptr)
+            continue;
+
+        ok = fwrite(zeros.data(), 1, header.offsets[i] - pos, f) == header.offsets[i] - pos;
+        const size_t bytes = a.n * a.elementSize;
+        ok = ok && fwrite(a.data, 1, bytes, f) == bytes;
+        pos = header.offsets[i] + bytes;
+    }
+
+    ok = (fclose(f) == 0) && ok;
+    ok = ok && std::rename(tmpName.c_str(), fileName.c_str()) == 0;
+
+    if (ok)
+    {
+        debug("Wrote mesh cache file '%s'", fileName.c_str());
+    }
+    else
+    {
+        std::remove(tmpName.c_str());
+        warn("Could not write mesh cache file '%s'", fileName.c_str());
+    }
+}
+
+
+std::tuple<std::vector<real3>, std::vector<int3>> readOff(const std::string& fileName, const std::string& cacheFolder)
+{
+    const Entry entry = getEntry(Content::Geometry, fileName, fileName, cacheFolder);
+    if (entry.fileName.empty())
+        return mirheo::readOff(fileName);
+
+    {
+        const Reader reader(entry.fileName, entry.key);
+        if (reader.has(Section::Vertices) && reader.has(Section::Faces))
+            return {reader.get<real3>(Section::Vertices), reader.get<int3>(Section::Faces)};
+    }
+
+    auto mesh = mirheo::readOff(fileName);
+
+    Writer writer;
+    writer.add(Section::Vertices, std::get<0>(mesh));
+    writer.add(Section::Faces,    std::get<1>(mesh));
+    writer.write(entry.fileName, entry.key);
+
+    return mesh;
+}
+
+} // namespace mesh_cache
+} // namespace mirheo
@@ -0,0 +1,205 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <mirheo/core/datatypes.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace mirheo
+{
+
+/** \brief Binary cache of a triangle mesh read from off files, together with its derived quantities.
+
+    Parsing off files and computing the adjacency lists of a MembraneMesh is costly for large meshes.
+    The first time a mesh is loaded, its data is written to a binary cache file;
+    subsequent loads memory-map that file instead of parsing the off file.
+    The cache is keyed on the content of the off files, so a modified off file is never served stale data.
+
+    The cache files are stored in a cache folder, given explicitly when loading the mesh or,
+    if empty, by the environment variable \c MIRHEO_MESH_CACHE_DIR.
+    Caching is disabled if neither is set: the folder that contains the off files is never written to.
+    Only the rank 0 of \c MPI_COMM_WORLD writes the cache files; all ranks may read them.
+ */
+namespace mesh_cache
+{
+
+/// The arrays that can be stored in a cache file.
+enum class Section
+{
+    Vertices,           ///< real3 vertex coordinates
+    Faces,              ///< int3 vertex indices of the faces
+    Adjacent,           ///< int adjacency lists (see MembraneMesh)
+    Degrees,            ///< int degree of the vertices
+    InitialLengths,     ///< real stress-free edge lengths
+    InitialAreas,       ///< real stress-free areas
+    InitialDotProducts, ///< real stress-free dot products
+    EdgeColors,         ///< int edge colors (see computeEdgeColors())
+    NumSections
+};
+
+/// The content of a cache file; each kind has its own file, so that they never overwrite each other.
+enum class Content
+{
+    Geometry, ///< vertices and faces only (see Mesh)
+    Membrane  ///< all the arrays of a MembraneMesh
+};
+
+/// Location and key of a cache file.
+struct Entry
+{
+    std::string fileName; ///< The name of the cache file; empty if caching is disabled.
+    uint64_t key {0};     ///< The key of the cache (see computeKey()); not computed if caching is disabled.
+};
+
+/** \brief Compute the key of a mesh cache from the content of its source files.
+    \param initialMesh The off file that contains the mesh.
+    \param stressFreeMesh The off file that contains the stress-free state (may be the same as \p initialMesh).
+    \return A hash of the content of both files and of the binary layout of the cache.
+
+    This method will die if one of the files can not be read.
+ */
+uint64_t computeKey(const std::string& initialMesh, const std::string& stressFreeMesh);
+
+/** \brief Get the name of the cache file associated to off files.
+    \param content What is stored in the cache file.
+    \param initialMesh The off file that contains the mesh.
+    \param stressFreeMesh The off file that contains the stress-free state (may be the same as \p initialMesh).
+    \param cacheFolder The folder of the cache files; if empty, \c MIRHEO_MESH_CACHE_DIR is used.
+    \return The name of the cache file; an empty string if caching is disabled.
+
+    The name contains a hash of the absolute paths of the off files,
+    so that off files with the same name in different folders have different cache files.
+ */
+std::string getFileName(Content content, const std::string& initialMesh, const std::string& stressFreeMesh,
+                        const std::string& cacheFolder = "");
+
+/** \brief Get the name and the key of the cache file associated to off files.
+    \param content What is stored in the cache file.
+    \param initialMesh The off file that contains the mesh.
+    \param stressFreeMesh The off file that contains the stress-free state (may be the same as \p initialMesh).
+    \param cacheFolder The folder of the cache files (see getFileName()).
+    \return The cache entry; the off files are only read to compute the key if caching is enabled.
+ */
+Entry getEntry(Content content, const std::string& initialMesh, const std::string& stressFreeMesh,
+               const std::string& cacheFolder = "");
+
+
+/// Read-only, memory-mapped view of a mesh cache file.
+class Reader
+{
+public:
+    /** \brief Map a cache file.
+        \param fileName The name of the cache file; may be empty.
+        \param key The expected key of the cache (see computeKey()).
+
+        The reader is invalid if the file does not exist, is corrupted or has a different key.
+     */
+    Reader(const std::string& fileName, uint64_t key);
+    ~Reader();
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    bool isValid() const; ///< \return \c true if the file was mapped and matches the key
+    bool has(Section section) const; ///< \return \c true if the given array is stored in the file
+    int getMaxDegree() const; ///< \return the maximum degree of the vertices stored in the file
+
+    /** \brief Copy an array of the cache.
+        \tparam T The element type of the section (see Section).
+        \param section The array to read.
+        \return A copy of the array; empty if the section is not stored.
+     */
+    template <class T>
+    std::vector<T> get(Section section) const
+    {
+        const size_t n = _getSize(section, sizeof(T));
+        const auto *src = reinterpret_cast<const T*>(_getData(section));
+        return std::vector<T>(src, src + n);
+    }
+
+    /** \brief Copy an array of the cache into a container.
+        \param section The array to read.
+        \param dst The destination container; it must support resize_anew(), data() and value_type.
+     */
+    template <class Container>
+    void copyTo(Section section, Container& dst) const
+    {
+        using T = typename Container::value_type;
+        const size_t n = _getSize(section, sizeof(T));
+        dst.resize_anew(n);
+        const auto *src = reinterpret_cast<const T*>(_getData(section));
+        std::copy(src, src + n, dst.data());
+    }
+
+private:
+    size_t _getSize(Section section, size_t elementSize) const;
+    const char* _getData(Section section) const;
+
+private:
+    const char *data_ {nullptr};
+    size_t size_ {0};
+    bool valid_ {false};
+};
+
+/// Collects the arrays of a mesh and writes them into a cache file.
+class Writer
+{
+public:
+    /// \param maxDegree The maximum degree of the vertices; ignored if the mesh has no adjacency information.
+    explicit Writer(int maxDegree = 0);
+
+    /** \brief Add an array to the cache.
+        \param section The kind of array.
+        \param data The array; it is not copied and must stay alive until write() is called.
+        \param n The number of elements.
+        \param elementSize The size of one element, in bytes.
+     */
+    void add(Section section, const void *data, size_t n, size_t elementSize);
+
+    /// \brief Add a vector to the cache (see add()).
+    template <class Container>
+    void add(Section section, const Container& v)
+    {
+        add(section, v.data(), v.size(), sizeof(typename Container::value_type));
+    }
+
+    /** \brief Write the cache file.
+        \param fileName The name of the cache file; nothing is written if empty.
+        \param key The key of the cache (see computeKey()).
+
+        Only the rank 0 of \c MPI_COMM_WORLD writes the file (if MPI is initialized); the other ranks return immediately.
+        The cache folder is created if needed.
+        The file is written to a temporary file first and then renamed, so that concurrent writers
+        (e.g. several simulations loading the same mesh) and readers never see a partially written file.
+        Failures are reported as warnings only: the cache is an optimization.
+     */
+    void write(const std::string& fileName, uint64_t key) const;
+
+private:
+    struct Array
+    {
+        const void *data {nullptr};
+        size_t n {0};
+        size_t elementSize {0};
+    };
+
+    int maxDegree_;
+    std::vector<Array> arrays_;
+};
+
+/** \brief Read the vertices and faces of an off file, using the cache if possible.
+    \param fileName The off file.
+    \param cacheFolder The folder of the cache files (see getFileName()).
+    \return The vertex coordinates and the faces of the mesh.
+
+    If the cache is invalid, the off file is parsed and the cache file is written.
+ */
+std::tuple<std::vector<real3>, std::vector<int3>> readOff(const std::string& fileName, const std::string& cacheFolder = "");
+
+} // namespace mesh_cache
+} // namespace mirheo
@@ -2,6 +2,7 @@
 #include "mirheo.h"
 
 #include <mirheo/core/bouncers/interface.h>
+#include <mirheo/core/frozen_particles_cache.h>
 #include <mirheo/core/initial_conditions/interface.h>
 #include <mirheo/core/initial_conditions/uniform.h>
 #include <mirheo/core/integrators/interface.h>
@@ -179,10 +180,18 @@ Mirheo::Mirheo(int3 nranks3D, real3 globalDomainSize,
 
 Mirheo::Mirheo(MPI_Comm comm, int3 nranks3D, real3 globalDomainSize,
                LogInfo logInfo, CheckpointInfo checkpointInfo,
-               real maxObjHalfLength, bool gpuAwareMPI)
+               real maxObjHalfLength, bool gpuAwareMPI) :
+    Mirheo(comm, nranks3D, globalDomainSize, logInfo, checkpointInfo,
+           maxObjHalfLength, gpuAwareMPI, true)
+{}
+
+Mirheo::Mirheo(MPI_Comm comm, int3 nranks3D, real3 globalDomainSize,
+               LogInfo logInfo, CheckpointInfo checkpointInfo,
+               real maxObjHalfLength, bool gpuAwareMPI, bool ownLogger)
 {
     MPI_Comm_dup(comm, &comm_);
-    initLogger(comm_, logInfo);
+    if (ownLogger)
+        initLogger(comm_, logInfo);
     init(nranks3D, globalDomainSize, logInfo,
          checkpointInfo, maxObjHalfLength, gpuAwareMPI);
 }
@@ -400,12 +409,30 @@ double Mirheo::computeVolumeInsideWalls(std::vector<std::shared_ptr<Wall>> walls
     return wall_helpers::volumeInsideWalls(sdfWalls, state_->domain, sim_->getCartComm(), nSamplesPerRank);
 }
 
+/// Run the equilibration of the particles used to create frozen particles, or load them from the cache.
+static void equilibrateFrozenParticles(Simulation& sim, const FrozenParticlesCache& cache, ParticleVector *pv,
+                                       int nsteps, bool refreshCache)
+{
+    const double start = MPI_Wtime();
+
+    if (!refreshCache && cache.load(pv))
+    {
+        info("Loaded equilibrated particles '%s' in %g s", pv->getCName(), MPI_Wtime() - start);
+        return;
+    }
+
+    sim.run(nsteps);
+    info("Equilibrated particles '%s' in %g s", pv->getCName(), MPI_Wtime() - start);
+    cache.store(pv);
+}
+
 std::shared_ptr<ParticleVector> Mirheo::makeFrozenWallParticles(
         std::string pvName,
         std::vector<std::shared_ptr<Wall>> walls,
         std::vector<std::shared_ptr<Interaction>> interactions,
         std::shared_ptr<Integrator> integrator,
-        real numDensity, real mass, real dt, int nsteps)
+        real numDensity, real mass, real dt, int nsteps,
+        const std::string& cacheFolder, bool refreshCache)
 {
     ensureNotInitialized();
 
@@ -457,7 +484,10 @@ std::shared_ptr<ParticleVector> Mirheo::makeFrozenWallParticles(
     wallsim.init();
 
     const real effectiveCutoff = wallsim.getMaxEffectiveCutoff();
-    wallsim.run(nsteps);
+
+    const FrozenParticlesCache cache(sim_->getCartComm(), cacheFolder, pv.get(), interactions,
+                                     integrator.get(), numDensity, dt, nsteps);
+    equilibrateFrozenParticles(wallsim, cache, pv.get(), nsteps, refreshCache);
 
     constexpr real wallThicknessTolerance = 0.2_r;
     constexpr real wallLevelSet = 0.0_r;
@@ -485,7 +515,8 @@ std::shared_ptr<ParticleVector> Mirheo::makeFrozenRigidParticles(
         std::shared_ptr<InitialConditions> icShape,
         std::vector<std::shared_ptr<Interaction>> interactions,
         std::shared_ptr<Integrator> integrator,
-        real numDensity, real mass, real dt, int nsteps)
+        real numDensity, real mass, real dt, int nsteps,
+        const std::string& cacheFolder, bool refreshCache)
 {
     ensureNotInitialized();
 
@@ -518,7 +549,10 @@ std::shared_ptr<ParticleVector> Mirheo::makeFrozenRigidParticles(
         }
 
         eqsim.init();
-        eqsim.run(nsteps);
+
+        const FrozenParticlesCache cache(sim_->getCartComm(), cacheFolder, pv.get(), interactions,
+                                         integrator.get(), numDensity, dt, nsteps);
+        equilibrateFrozenParticles(eqsim, cache, pv.get(), nsteps, refreshCache);
     }
 
     Simulation freezesim(sim_->getCartComm(), MPI_COMM_NULL, getState(), CheckpointInfo{}, 0.0_r);
@@ -640,6 +674,42 @@ void Mirheo::dumpDependencyGraphToGraphML(const std::string& fname, bool current
         sim_->dumpDependencyGraphToGraphML(fname, current);
 }
 
+void Mirheo::enableTaskProfiling(const std::string& fname, bool useStreamEvents)
+{
+    if (isComputeTask())
+        sim_->setTaskProfiling(fname, useStreamEvents);
+}
+
+void Mirheo::setExchangeEngine(ExchangeEngineType type)
+{
+    if (isComputeTask())
+        sim_->setExchangeEngine(type);
+}
+
+void Mirheo::setDeterministicForces(bool deterministic)
+{
+    if (isComputeTask())
+        state_->deterministicForces = deterministic;
+}
+
+void Mirheo::setCellOrdering(CellOrdering ordering)
+{
+    if (isComputeTask())
+        state_->cellOrdering = ordering;
+}
+
+void Mirheo::setIncrementalCellLists(bool incremental, real maxMigratedFraction)
+{
+    if (maxMigratedFraction < 0.0_r || maxMigratedFraction > 1.0_r)
+        die("The fraction of migrated particles must be in [0, 1], got %g", maxMigratedFraction);
+
+    if (isComputeTask())
+    {
+        state_->incrementalCellLists = incremental;
+        state_->incrementalCellListsMaxMigration = maxMigratedFraction;
+    }
+}
+
 void Mirheo::startProfiler()
 {
     if (isComputeTask())
@@ -681,6 +751,8 @@ void Mirheo::logCompileOptions() const
     info("MIRHEO_MIRHEO_DOUBLE   : %d", compile_options.useDouble     );
     info("MIRHEO_MEMBRANE_DOUBLE : %d", compile_options.membraneDouble);
     info("MIRHEO_ROD_DOUBLE      : %d", compile_options.rodDouble     );
+    info("MIRHEO_PAIRWISE_ACCUMULATION_DOUBLE : %d", compile_options.pairwiseDoubleAccumulation);
+    info("MIRHEO_PAIRWISE_ACCUMULATION_KAHAN  : %d", compile_options.pairwiseKahanAccumulation );
     info("MIRHEO_USE_NVTX        : %d", compile_options.useNvtx       );
 }
 
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <mirheo/core/datatypes.h>
+#include <mirheo/core/exchangers/engines/factory.h>
 #include <mirheo/core/logger.h>
 #include <mirheo/core/mirheo_state.h>
 #include <mirheo/core/utils/common.h>
@@ -91,6 +92,38 @@ public:
     */
     void dumpDependencyGraphToGraphML(const std::string& fname, bool current) const;
 
+    /** \brief record the execution time of every task of the simulation.
+        \param fname The base name of the report files (without extension).
+        \param useStreamEvents if \c true, also measure the durations on the streams with CUDA events.
+        \see Simulation::setTaskProfiling()
+    */
+    void enableTaskProfiling(const std::string& fname, bool useStreamEvents);
+
+    /** \brief choose the engine used for the communication between the subdomains.
+        \param type The kind of engine.
+        \see Simulation::setExchangeEngine()
+    */
+    void setExchangeEngine(ExchangeEngineType type);
+
+    /** \brief choose whether the forces are accumulated in a reproducible order.
+        \param deterministic if \c true, two runs with the same seeds and domain decomposition give bit-identical results.
+        \see MirState::deterministicForces
+    */
+    void setDeterministicForces(bool deterministic);
+
+    /** \brief choose the order in which the cells of the cell-lists, hence the particles, are stored.
+        \param ordering The ordering of the cells.
+        \see MirState::cellOrdering
+    */
+    void setCellOrdering(CellOrdering ordering);
+
+    /** \brief choose whether the cell-lists only move the particles that changed cell since their last build.
+        \param incremental enable or disable the incremental builds
+        \param maxMigratedFraction fraction of particles that changed cell above which the cell-lists are rebuilt from scratch
+        \see MirState::incrementalCellLists
+    */
+    void setIncrementalCellLists(bool incremental, real maxMigratedFraction);
+
     /** \brief advance the system for a given number of time steps
         \param niters number of interations
         \param dt time step duration
@@ -217,6 +250,8 @@ public:
         \param mass The mass of one particle
         \param dt Equilibration time step
         \param nsteps Number of equilibration steps
+        \param cacheFolder If not empty, the equilibrated particles are stored in and reused from this folder (see FrozenParticlesCache)
+        \param refreshCache If \c true, the equilibration is run and the cache entry is overwritten
         \return The frozen particles
 
         This will run a simulation of "bulk" particles and select the particles that are inside the effective
@@ -226,7 +261,8 @@ public:
                                                             std::vector<std::shared_ptr<Wall>> walls,
                                                             std::vector<std::shared_ptr<Interaction>> interactions,
                                                             std::shared_ptr<Integrator> integrator,
-                                                            real numDensity, real mass, real dt, int nsteps);
+                                                            real numDensity, real mass, real dt, int nsteps,
+                                                            const std::string& cacheFolder = "", bool refreshCache = false);
 
     /** \brief Create frozen particles inside the given objects.
         \param checker The ObjectBelongingChecker to split inside particles
@@ -238,6 +274,8 @@ public:
         \param mass The mass of one particle
         \param dt Equilibration time step
         \param nsteps Number of equilibration steps
+        \param cacheFolder If not empty, the equilibrated particles are stored in and reused from this folder (see FrozenParticlesCache)
+        \param refreshCache If \c true, the equilibration is run and the cache entry is overwritten
         \return The frozen particles, with name "inside_" + name of \p shape
 
         This will run a simulation of "bulk" particles and select the particles that are inside \p shape.
@@ -248,7 +286,8 @@ public:
                                                              std::shared_ptr<InitialConditions> icShape,
                                                              std::vector<std::shared_ptr<Interaction>> interactions,
                                                              std::shared_ptr<Integrator>   integrator,
-                                                             real numDensity, real mass, real dt, int nsteps);
+                                                             real numDensity, real mass, real dt, int nsteps,
+                                                            const std::string& cacheFolder = "", bool refreshCache = false);
 
     /** \brief Enable a registered ObjectBelongingChecker to split particles of a registered ParticleVector.
         \param checker The ObjectBelongingChecker (will die if it is not registered)
@@ -273,6 +312,16 @@ public:
     /// print the list of all compile options and their current value in the logs
     void logCompileOptions() const;
 
+private:
+    friend class Ensemble;
+
+    /** \brief Construct a replica of an \c Ensemble.
+        Same as the public constructor with a communicator, but \p ownLogger set to \c false keeps the current logger.
+     */
+    Mirheo(MPI_Comm comm, int3 nranks3D, real3 globalDomainSize,
+           LogInfo logInfo, CheckpointInfo checkpointInfo,
+           real maxObjHalfLength, bool gpuAwareMPI, bool ownLogger);
+
 private:
     std::unique_ptr<Simulation> sim_;
     std::unique_ptr<Postprocess> post_;
@@ -21,6 +21,11 @@ MirObject::~MirObject()
 void MirObject::checkpoint(__UNUSED MPI_Comm comm, __UNUSED const std::string& path, __UNUSED int checkpointId) {}
 void MirObject::restart   (__UNUSED MPI_Comm comm, __UNUSED const std::string& path) {}
 
+void MirObject::setDefinition(const std::string& definition)
+{
+    definition_ = definition;
+}
+
 static void appendIfNonEmpty(std::string& base, const std::string& toAppend)
 {
     if (toAppend != "")
@@ -60,9 +65,8 @@ void MirObject::createCheckpointSymlink(MPI_Comm comm, const std::string& path,
     if (rank == 0) {
         const std::string lnname = createCheckpointName      (path, identifier, extension);
         const std::string  fname = createCheckpointNameWithId(path, identifier, extension, checkpointId);
-        const std::string command = "ln -f " + fname + " " + lnname;
 
-        if ( system(command.c_str()) != 0 )
+        if ( !createHardLink(fname, lnname) )
             error("Could not create symlink '%s' for checkpoint file '%s'",
                   lnname.c_str(), fname.c_str());
     }
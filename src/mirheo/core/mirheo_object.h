@@ -68,8 +68,19 @@ public:
     */
     void createCheckpointSymlink(MPI_Comm comm, const std::string& path, const std::string& identifier, const std::string& extension, int checkpointId) const;
 
+    /** \brief Set a description of the type and parameters the object was created with.
+        \param [in] definition The description; objects with equal definitions behave identically.
+
+        This is typically set by the factories and used to identify equivalent objects across runs.
+     */
+    void setDefinition(const std::string& definition);
+
+    /// \brief Return the description set by setDefinition(); empty if unknown.
+    const std::string& getDefinition() const noexcept {return definition_;}
+
 private:
     const std::string name_; ///< Name of the object.
+    std::string definition_; ///< Type and parameters of the object; empty if unknown.
 };
 
 /** \brief Base class for the objects of Mirheo simulation task.
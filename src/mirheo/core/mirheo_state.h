@@ -3,6 +3,7 @@
 
 #include "domain.h"
 #include "utils/common.h"
+#include "utils/space_filling_curves.h"
 
 #include <mpi.h>
 #include <string>
@@ -58,6 +59,28 @@ public:
     TimeType currentTime; ///< Current simulation time
     StepType currentStep; ///< Current simulation step
 
+    /** If \c true, the cell-lists and the force kernels accumulate their contributions in a fixed order,
+        so that two runs with the same seeds and domain decomposition give bit-identical results.
+        This is slower than the default (atomic) accumulation.
+     */
+    bool deterministicForces {false};
+
+    /** The order of the cells of the cell-lists, hence of the particles of the ParticleVector objects
+        that are reordered by a PrimaryCellList. See CellListInfo::ordering.
+     */
+    CellOrdering cellOrdering {CellOrdering::RowMajor};
+
+    /** If \c true, the cell-lists detect the particles that changed cell since their last build and only move these
+        particles, keeping the others in place (see CellList::build()).
+        When no particle changed cell, the reordering is skipped altogether.
+     */
+    bool incrementalCellLists {false};
+
+    /** The fraction of particles that changed cell above which the cell-lists are rebuilt from scratch,
+        when incrementalCellLists is set.
+     */
+    real incrementalCellListsMaxMigration {0.1_r};
+
 private:
     void _dieInvalidDt [[noreturn]]() const; // To avoid including logger here.
     real dt_; ///< time step
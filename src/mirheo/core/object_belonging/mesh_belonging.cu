@@ -14,135 +14,63 @@ namespace mirheo
 namespace mesh_belonging_kernels
 {
 
-const real tolerance = 1e-6_r;
-
-/// https://en.wikipedia.org/wiki/M%C3%B6ller%E2%80%93Trumbore_intersection_algorithm
-__device__ static inline bool doesRayIntersectTriangle(
-        real3 rayOrigin,
-        real3 rayVector,
-        real3 v0, real3 v1, real3 v2)
-{
-    real3 edge1, edge2, h, s, q;
-    real a,f,u,v;
-
-    edge1 = v1 - v0;
-    edge2 = v2 - v0;
-    h = cross(rayVector, edge2);
-    a = dot(edge1, h);
-    if (math::abs(a) < tolerance)
-        return false;
-
-    f = 1.0_r / a;
-    s = rayOrigin - v0;
-    u = f * (dot(s, h));
-    if (u < 0.0_r || u > 1.0_r)
-        return false;
-
-    q = cross(s, edge1);
-    v = f * dot(rayVector, q);
-    if (v < 0.0_r || u + v > 1.0_r)
-        return false;
-
-    // At this stage we can compute t to find out where the intersection point is on the line.
-    real t = f * dot(edge2, q);
-
-    if (t > tolerance) // ray intersection
-        return true;
-    else
-        return false; // This means that there is a line intersection but not a ray intersection.
-}
-
-
-__device__ static inline real3 fetchPosition(const real4 *vertices, int i)
-{
-    auto v = vertices[i];
-    return {v.x, v.y, v.z};
-}
-
 /**
- * One warp works on one particle
+ * Refit the boxes of one level of the tree for all objects.
+ * The boxes are expressed relative to the center of mass of the objects, for precision.
  */
-__device__ static inline BelongingTags oneParticleInsideMesh(int pid, real3 r, int objId, const real3 com, const MeshView mesh, const real4* vertices)
+__global__ void refitLevel(const OVview ovView, const MeshBVHView bvh, int levelStart, int levelSize,
+                           const real4 *vertices, MeshBVH::Box *boxes)
 {
-    // Work in obj reference frame for simplicity
-    r = r - com;
+    const int i = blockIdx.x * blockDim.x + threadIdx.x;
+    const int objId  = i / levelSize;
+    const int nodeId = levelStart + i % levelSize;
 
-    // shoot 3 rays in different directions, count intersections
-    constexpr int nRays = 3;
-    constexpr real3 rays[nRays] = { {0,1,0}, {0,1,0}, {0,1,0} };
-    int counters[nRays] = {0, 0, 0};
-
-    for (int i = laneId(); i < mesh.ntriangles; i += warpSize)
-    {
-        int3 trid = mesh.triangles[i];
-
-        real3 v0 = fetchPosition(vertices, objId*mesh.nvertices + trid.x) - com;
-        real3 v1 = fetchPosition(vertices, objId*mesh.nvertices + trid.y) - com;
-        real3 v2 = fetchPosition(vertices, objId*mesh.nvertices + trid.z) - com;
-
-        for (int c = 0; c < nRays; c++)
-            if (doesRayIntersectTriangle(r, rays[c], v0, v1, v2))
-                counters[c]++;
-    }
-
-    // counter is odd if the particle is inside
-    // however, realing-point precision sometimes yields in errors
-    // so we choose what the majority(!) of the rays say
-    int intersecting = 0;
-    for (int c = 0; c < nRays; c++)
-    {
-        counters[c] = warpReduce(counters[c], [] (int a, int b) { return a+b; });
-        if ( (counters[c] % 2) != 0 )
-            intersecting++;
-    }
+    if (objId >= ovView.nObjects) return;
 
-    if (intersecting > (nRays/2))
-        return BelongingTags::Inside;
-    else
-        return BelongingTags::Outside;
+    mesh_bvh::refitNode(bvh, nodeId, vertices + objId * bvh.nvertices, ovView.comAndExtents[objId].com,
+                        boxes + objId * bvh.nNodes);
 }
 
 /**
+ * One thread works on one cell of the bounding box of one object, and tests the particles of that cell.
+ * The objects are distributed along blockIdx.x, the cells of an object along blockIdx.y and threadIdx.x.
  * OVview view is only used to provide # of objects and extent information
  * Actual data is in \p vertices
  * @param cinfo is the cell-list sync'd with the target ParticleVector data
  */
-template<int WARPS_PER_OBJ>
-__global__ void insideMesh(const OVview ovView, const MeshView mesh, const real4 *vertices, CellListInfo cinfo, PVview pvView, BelongingTags* tags)
+__global__ void insideMesh(const OVview ovView, const MeshBVHView bvh, const real4 *vertices, const MeshBVH::Box *boxes,
+                           CellListInfo cinfo, PVview pvView, BelongingTags* tags)
 {
-    const int gid = blockIdx.x*blockDim.x + threadIdx.x;
-    const int wid = gid / warpSize;
-    const int objId = wid / WARPS_PER_OBJ;
-
-    const int locWid = wid % WARPS_PER_OBJ;
+    const int objId = blockIdx.x;
 
     if (objId >= ovView.nObjects) return;
 
-    const int3 cidLow  = cinfo.getCellIdAlongAxes(ovView.comAndExtents[objId].low  - 0.5_r);
-    const int3 cidHigh = cinfo.getCellIdAlongAxes(ovView.comAndExtents[objId].high + 0.5_r);
+    const auto comAndExtent = ovView.comAndExtents[objId];
+    const real4 *objVertices = vertices + objId * bvh.nvertices;
+    const MeshBVH::Box *objBoxes = boxes + objId * bvh.nNodes;
+
+    const int3 cidLow  = cinfo.getCellIdAlongAxes(comAndExtent.low  - 0.5_r);
+    const int3 cidHigh = cinfo.getCellIdAlongAxes(comAndExtent.high + 0.5_r);
 
     const int3 span = cidHigh - cidLow + make_int3(1,1,1);
     const int totCells = span.x * span.y * span.z;
 
-    for (int i = locWid; i < totCells; i += WARPS_PER_OBJ)
+    for (int i = blockIdx.y * blockDim.x + threadIdx.x; i < totCells; i += gridDim.y * blockDim.x)
     {
         const int3 cid3 = make_int3( i % span.x, (i/span.x) % span.y, i / (span.x*span.y) ) + cidLow;
         const int  cid = cinfo.encode(cid3);
         if (cid < 0 || cid >= cinfo.totcells) continue;
 
-        int pstart = cinfo.cellStarts[cid];
-        int pend   = cinfo.cellStarts[cid+1];
+        const int pstart = cinfo.cellStarts[cid];
+        const int pend   = cinfo.cellStarts[cid+1];
 
-#pragma unroll 3
         for (int pid = pstart; pid < pend; pid++)
         {
-            const Particle p(pvView.readParticle(pid));
-
-            auto tag = oneParticleInsideMesh(pid, p.r, objId, ovView.comAndExtents[objId].com, mesh, vertices);
+            const real3 r = make_real3(pvView.readPosition(pid));
 
             // Only tag particles inside, default is outside anyways
-            if (laneId() == 0 && tag != BelongingTags::Outside)
-                tags[pid] = tag;
+            if (mesh_bvh::isInside(bvh, objVertices, comAndExtent.com, objBoxes, r))
+                tags[pid] = BelongingTags::Inside;
         }
     }
 }
@@ -154,26 +82,55 @@ void MeshBelongingChecker::_tagInner(ParticleVector *pv, CellList *cl, cudaStrea
     tags_.resize_anew(pv->local()->size());
     tags_.clearDevice(stream);
 
+    if (!bvh_)
+        bvh_ = std::make_unique<MeshBVH>(ov_->mesh.get(), stream);
+
+    const MeshBVHView bvhView(bvh_.get());
+
+    // number of cells covered by an object of the reference shape;
+    // deformed objects that cover more cells are handled by a grid-stride loop
+    const real3 h = cl->cellInfo().h;
+    const int3 refSpan = make_int3(math::ceil((bvh_->getExtent() + make_real3(1.0_r)) / h)) + 1;
+    const int refCells = refSpan.x * refSpan.y * refSpan.z;
+
     auto computeTags = [&](ParticleVectorLocality locality)
     {
         ov_->findExtentAndCOM(stream, locality);
 
         auto lov = ov_->get(locality);
         auto view = OVview(ov_, lov);
-        auto vertices = lov->getMeshVertices(stream);
-        auto meshView = MeshView(ov_->mesh.get());
+        auto vertices = reinterpret_cast<const real4*>(lov->getMeshVertices(stream)->devPtr());
 
         debug("Computing inside/outside tags (against mesh) for %d %s objects '%s' and %d '%s' particles",
               view.nObjects, getParticleVectorLocalityStr(locality).c_str(),
               ov_->getCName(), pv->local()->size(), pv->getCName());
 
+        if (view.nObjects == 0)
+            return;
+
+        boxes_.resize_anew(view.nObjects * bvhView.nNodes);
+
         constexpr int nthreads = 128;
-        constexpr int warpsPerObject = 1024;
+        constexpr int maxBlocksPerObject = 65535;
+
+        // bottom-up: the children must be refitted before their parents
+        for (int level = bvh_->getDepth() - 1; level >= 0; --level)
+        {
+            const int levelStart = bvh_->getLevelStart(level);
+            const int levelSize  = bvh_->getLevelStart(level + 1) - levelStart;
+
+            SAFE_KERNEL_LAUNCH(
+                mesh_belonging_kernels::refitLevel,
+                getNblocks(levelSize * view.nObjects, nthreads), nthreads, 0, stream,
+                view, bvhView, levelStart, levelSize, vertices, boxes_.devPtr());
+        }
+
+        const dim3 blocks(view.nObjects, std::min(getNblocks(refCells, nthreads), maxBlocksPerObject));
 
         SAFE_KERNEL_LAUNCH(
-            mesh_belonging_kernels::insideMesh<warpsPerObject>,
-            getNblocks(warpsPerObject*32*view.nObjects, nthreads), nthreads, 0, stream,
-            view, meshView, reinterpret_cast<real4*>(vertices->devPtr()),
+            mesh_belonging_kernels::insideMesh,
+            blocks, nthreads, 0, stream,
+            view, bvhView, vertices, boxes_.devPtr(),
             cl->cellInfo(), cl->getView<PVview>(), tags_.devPtr());
     };
 
@@ -2,10 +2,17 @@
 #pragma once
 
 #include "object_belonging.h"
+#include "mesh_bvh.h"
+
+#include <memory>
 
 namespace mirheo
 {
-/// \brief Check in/out status of particles against an ObjectVector with a triangle mesh.
+/** \brief Check in/out status of particles against an ObjectVector with a triangle mesh.
+
+    The triangles of each object are organized in a bounding volume hierarchy (see MeshBVH),
+    refitted to the current shape of the objects before each check.
+ */
 class MeshBelongingChecker : public ObjectVectorBelongingChecker
 {
 public:
@@ -13,6 +20,10 @@ public:
 
 protected:
     void _tagInner(ParticleVector *pv, CellList *cl, cudaStream_t stream) override;
+
+private:
+    std::unique_ptr<MeshBVH> bvh_; ///< Tree topology, shared by all objects; built on first use.
+    DeviceBuffer<MeshBVH::Box> boxes_; ///< Bounding boxes of the nodes of all objects.
 };
 
 } // namespace mirheo
@@ -0,0 +1,207 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "mesh_bvh.h"
+
+#include <mirheo/core/logger.h>
+#include <mirheo/core/mesh/mesh.h>
+#include <mirheo/core/utils/cuda_common.h>
+#include <mirheo/core/utils/parallel_for.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace mirheo
+{
+
+static std::vector<real3> getVertices(const Mesh *mesh)
+{
+    std::vector<real3> vertices;
+    vertices.reserve(mesh->getNvertices());
+    for (const auto& v : mesh->getVertices())
+        vertices.push_back(make_real3(v));
+    return vertices;
+}
+
+MeshBVH::MeshBVH(const Mesh *mesh, cudaStream_t stream) :
+    MeshBVH(getVertices(mesh), std::vector<int3>(mesh->getFaces().begin(), mesh->getFaces().end()), stream)
+{}
+
+MeshBVH::MeshBVH(const std::vector<real3>& vertices, const std::vector<int3>& faces, cudaStream_t stream) :
+    nvertices_(static_cast<int>(vertices.size()))
+{
+    const int ntriangles = static_cast<int>(faces.size());
+    if (ntriangles == 0)
+        die("Can not build a bounding volume hierarchy of a mesh without triangles");
+
+    real3 lo = vertices[0], hi = vertices[0];
+    for (const auto& v : vertices)
+    {
+        lo = math::min(lo, v);
+        hi = math::max(hi, v);
+    }
+    extent_ = hi - lo;
+
+    std::vector<real3> centroids(ntriangles);
+    for (int i = 0; i < ntriangles; ++i)
+    {
+        const int3 t = faces[i];
+        centroids[i] = (vertices[t.x] + vertices[t.y] + vertices[t.z]) / 3.0_r;
+    }
+
+    std::vector<int> order(ntriangles);
+    std::iota(order.begin(), order.end(), 0);
+
+    struct Range {int begin, end;};
+    std::vector<Range> level {{0, ntriangles}};
+    std::vector<Node> nodes;
+
+    // breadth-first construction; inner nodes are split at the median of the centroids along their longest axis
+    while (!level.empty())
+    {
+        levelStarts_.push_back(static_cast<int>(nodes.size()));
+        const int nextStart = static_cast<int>(nodes.size() + level.size());
+        std::vector<Range> next;
+
+        for (const auto& range : level)
+        {
+            const int count = range.end - range.begin;
+            if (count <= maxLeafSize)
+            {
+                nodes.push_back({range.begin, count});
+                continue;
+            }
+
+            real3 lo = centroids[order[range.begin]], hi = lo;
+            for (int i = range.begin; i < range.end; ++i)
+            {
+                lo = math::min(lo, centroids[order[i]]);
+                hi = math::max(hi, centroids[order[i]]);
+            }
+            const real3 extent = hi - lo;
+            const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+            auto coordinate = [&](int i) {return axis == 0 ? centroids[i].x : (axis == 1 ? centroids[i].y : centroids[i].z);};
+
+            const int mid = range.begin + count / 2;
+            std::nth_element(order.begin() + range.begin, order.begin() + mid, order.begin() + range.end,
+                             [&](int a, int b) {return coordinate(a) < coordinate(b);});
+
+            nodes.push_back({nextStart + static_cast<int>(next.size()), 0});
+            next.push_back({range.begin, mid});
+            next.push_back({mid, range.end});
+        }
+        level = std::move(next);
+    }
+    levelStarts_.push_back(static_cast<int>(nodes.size()));
+
+    // the traversal stack holds at most one node per level plus one
+    constexpr int maxDepth = 60;
+    if (getDepth() > maxDepth)
+        die("Bounding volume hierarchy is too deep: %d levels", getDepth());
+
+    nodes_.resize_anew(nodes.size());
+    std::copy(nodes.begin(), nodes.end(), nodes_.begin());
+
+    triangles_.resize_anew(ntriangles);
+    for (int i = 0; i < ntriangles; ++i)
+        triangles_[i] = faces[order[i]];
+
+    nodes_    .uploadToDevice(stream);
+    triangles_.uploadToDevice(stream);
+
+    debug("Built a bounding volume hierarchy of %d nodes and %d levels over %d triangles",
+          getNumNodes(), getDepth(), ntriangles);
+}
+
+int MeshBVH::getNumNodes() const
+{
+    return static_cast<int>(nodes_.size());
+}
+
+int MeshBVH::getNumVertices() const
+{
+    return nvertices_;
+}
+
+int MeshBVH::getDepth() const
+{
+    return static_cast<int>(levelStarts_.size()) - 1;
+}
+
+real3 MeshBVH::getExtent() const
+{
+    return extent_;
+}
+
+int MeshBVH::getLevelStart(int level) const
+{
+    return levelStarts_[level];
+}
+
+const PinnedBuffer<MeshBVH::Node>& MeshBVH::getNodes() const
+{
+    return nodes_;
+}
+
+const PinnedBuffer<int3>& MeshBVH::getTriangles() const
+{
+    return triangles_;
+}
+
+
+MeshBVHView::MeshBVHView(const MeshBVH *bvh, bool onDevice) :
+    nNodes    (bvh->getNumNodes()),
+    nvertices (bvh->getNumVertices()),
+    nodes     (onDevice ? bvh->getNodes().devPtr()     : bvh->getNodes().hostPtr()),
+    triangles (onDevice ? bvh->getTriangles().devPtr() : bvh->getTriangles().hostPtr())
+{}
+
+
+namespace mesh_bvh
+{
+
+void tagInsideHost(const MeshBVH& bvh, int nObjects, const real4 *vertices,
+                   int nPoints, const real3 *points, int *inside)
+{
+    const MeshBVHView view(&bvh, false);
+    const int nNodes = view.nNodes;
+    const int nv = view.nvertices;
+    const int numThreads = 0; // hardware concurrency
+
+    std::vector<MeshBVH::Box> boxes(static_cast<size_t>(nObjects) * nNodes);
+    std::vector<real3> origins(nObjects);
+
+    parallelFor(nObjects, numThreads, [&](int objId)
+    {
+        const real4 *objVertices = vertices + static_cast<size_t>(objId) * nv;
+        real3 com {0.0_r, 0.0_r, 0.0_r};
+        for (int i = 0; i < nv; ++i)
+            com += make_real3(objVertices[i]);
+        origins[objId] = com / static_cast<real>(nv);
+
+        refitAll(view, objVertices, origins[objId], boxes.data() + static_cast<size_t>(objId) * nNodes);
+    });
+
+    parallelFor(nPoints, numThreads, [&](int pid)
+    {
+        inside[pid] = -1;
+        for (int objId = 0; objId < nObjects; ++objId)
+        {
+            const MeshBVH::Box *objBoxes = boxes.data() + static_cast<size_t>(objId) * nNodes;
+            const real3 r = points[pid] - origins[objId];
+            const auto& root = objBoxes[0];
+
+            if (r.x < root.lo.x || r.y < root.lo.y || r.z < root.lo.z ||
+                r.x > root.hi.x || r.y > root.hi.y || r.z > root.hi.z)
+                continue;
+
+            if (isInside(view, vertices + static_cast<size_t>(objId) * nv, origins[objId], objBoxes, points[pid]))
+            {
+                inside[pid] = objId;
+                break;
+            }
+        }
+    });
+}
+
+} // namespace mesh_bvh
+} // namespace mirheo
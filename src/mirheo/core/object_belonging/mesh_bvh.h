@@ -0,0 +1,297 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <mirheo/core/containers.h>
+#include <mirheo/core/datatypes.h>
+#include <mirheo/core/utils/cpu_gpu_defines.h>
+#include <mirheo/core/utils/helper_math.h>
+
+#include <vector>
+
+namespace mirheo
+{
+
+class Mesh;
+
+/** \brief Bounding volume hierarchy over the triangles of a mesh.
+
+    The topology of the tree is built once from the reference shape of the mesh and shared by all objects.
+    Each object stores its own bounding boxes, which are refitted to the current vertex positions
+    before every query; this keeps the tree valid for deformable objects.
+
+    The nodes are stored in breadth-first order: the nodes of one level are contiguous,
+    the two children of an inner node are consecutive and have larger indices than their parent.
+ */
+class MeshBVH
+{
+public:
+    /// A node of the tree.
+    struct Node
+    {
+        int first; ///< index of the left child (right child is first+1) if count == 0, first triangle otherwise
+        int count; ///< number of triangles of a leaf; 0 for inner nodes
+    };
+
+    /// Axis-aligned bounding box of a node.
+    struct Box
+    {
+        real3 lo; ///< lower corner
+        real3 hi; ///< upper corner
+    };
+
+    /// Maximum number of triangles in a leaf.
+    static constexpr int maxLeafSize = 8;
+
+    /** \brief Build the tree from the reference shape of a mesh.
+        \param mesh The mesh; its vertices are used to build the tree.
+        \param stream The stream used to upload the tree to the device.
+     */
+    MeshBVH(const Mesh *mesh, cudaStream_t stream);
+
+    /** \brief Build the tree from a list of vertices and faces.
+        \param vertices The vertex coordinates used to build the tree.
+        \param faces The triangles.
+        \param stream The stream used to upload the tree to the device.
+     */
+    MeshBVH(const std::vector<real3>& vertices, const std::vector<int3>& faces, cudaStream_t stream);
+
+    int getNumNodes() const; ///< \return the number of nodes of the tree
+    int getNumVertices() const; ///< \return the number of vertices of the mesh
+    int getDepth() const; ///< \return the number of levels of the tree
+    real3 getExtent() const; ///< \return the size of the bounding box of the vertices used to build the tree
+
+    /// \return the first node of the given level; level getDepth() is the end of the node array
+    int getLevelStart(int level) const;
+
+    const PinnedBuffer<Node>& getNodes() const; ///< \return the nodes, in breadth-first order
+    const PinnedBuffer<int3>& getTriangles() const; ///< \return the triangles, in the order referenced by the leaves
+
+private:
+    int nvertices_;
+    real3 extent_;
+    std::vector<int> levelStarts_;
+    PinnedBuffer<Node> nodes_;
+    PinnedBuffer<int3> triangles_;
+};
+
+/// A device-compatible view of a MeshBVH.
+struct MeshBVHView
+{
+    int nNodes;      ///< number of nodes
+    int nvertices;   ///< number of vertices per object
+    const MeshBVH::Node *nodes; ///< nodes of the tree
+    const int3 *triangles;      ///< triangles sorted by leaf
+
+    /// Construct a view of a MeshBVH; \p onDevice selects the device or host pointers.
+    MeshBVHView(const MeshBVH *bvh, bool onDevice = true);
+};
+
+namespace mesh_bvh
+{
+
+/// tolerance of the ray-triangle intersection test
+constexpr real tolerance = 1e-6_r;
+
+/// absolute padding of the leaf boxes
+constexpr real boxPadding = 1e-4_r;
+
+/// The rays used to count intersections; distinct and not aligned with the axes nor with each other.
+__HD__ inline real3 getRayDirection(int i)
+{
+    const real3 rays[3] = {{ 0.5347_r,  0.8012_r, 0.2687_r},
+                           {-0.7191_r,  0.1531_r, 0.6779_r},
+                           { 0.2290_r, -0.6624_r, 0.7133_r}};
+    return rays[i];
+}
+
+/// number of rays used in the majority vote
+constexpr int nRays = 3;
+
+/// https://en.wikipedia.org/wiki/M%C3%B6ller%E2%80%93Trumbore_intersection_algorithm
+__HD__ inline bool doesRayIntersectTriangle(real3 rayOrigin, real3 rayVector,
+                                            real3 v0, real3 v1, real3 v2)
+{
+    const real3 edge1 = v1 - v0;
+    const real3 edge2 = v2 - v0;
+    const real3 h = cross(rayVector, edge2);
+    const real a = dot(edge1, h);
+    if (math::abs(a) < tolerance)
+        return false;
+
+    const real f = 1.0_r / a;
+    const real3 s = rayOrigin - v0;
+    const real u = f * dot(s, h);
+    if (u < 0.0_r || u > 1.0_r)
+        return false;
+
+    const real3 q = cross(s, edge1);
+    const real v = f * dot(rayVector, q);
+    if (v < 0.0_r || u + v > 1.0_r)
+        return false;
+
+    // only intersections in front of the origin count
+    const real t = f * dot(edge2, q);
+    return t > tolerance;
+}
+
+/// \return \c true if the ray intersects the box; slab test
+__HD__ inline bool doesRayIntersectBox(real3 rayOrigin, real3 invRayVector, const MeshBVH::Box& box)
+{
+    const real3 t0 = (box.lo - rayOrigin) * invRayVector;
+    const real3 t1 = (box.hi - rayOrigin) * invRayVector;
+    const real3 tmin = math::min(t0, t1);
+    const real3 tmax = math::max(t0, t1);
+    const real enter = math::max(math::max(tmin.x, tmin.y), tmin.z);
+    const real exit  = math::min(math::min(tmax.x, tmax.y), tmax.z);
+    return exit >= math::max(enter, 0.0_r);
+}
+
+__HD__ inline real3 fetchPosition(const real4 *vertices, int i, real3 origin)
+{
+    const real4 v = vertices[i];
+    return real3 {v.x, v.y, v.z} - origin;
+}
+
+/** \brief Recompute the bounding box of one node of one object.
+    \param bvh The tree.
+    \param nodeId The node to refit; the boxes of its children must be up to date.
+    \param vertices The vertices of the object.
+    \param origin Reference point subtracted from all coordinates (e.g. the center of mass of the object).
+    \param boxes The boxes of the object.
+ */
+__HD__ inline void refitNode(const MeshBVHView& bvh, int nodeId, const real4 *vertices, real3 origin, MeshBVH::Box *boxes)
+{
+    const MeshBVH::Node node = bvh.nodes[nodeId];
+    MeshBVH::Box box;
+
+    if (node.count == 0)
+    {
+        const MeshBVH::Box l = boxes[node.first];
+        const MeshBVH::Box r = boxes[node.first + 1];
+        box.lo = math::min(l.lo, r.lo);
+        box.hi = math::max(l.hi, r.hi);
+    }
+    else
+    {
+        box.lo = box.hi = fetchPosition(vertices, bvh.triangles[node.first].x, origin);
+        for (int i = node.first; i < node.first + node.count; ++i)
+        {
+            const int3 t = bvh.triangles[i];
+            const real3 v0 = fetchPosition(vertices, t.x, origin);
+            const real3 v1 = fetchPosition(vertices, t.y, origin);
+            const real3 v2 = fetchPosition(vertices, t.z, origin);
+            box.lo = math::min(box.lo, math::min(v0, math::min(v1, v2)));
+            box.hi = math::max(box.hi, math::max(v0, math::max(v1, v2)));
+        }
+        // guard against round-off in the ray-box test
+        box.lo -= make_real3(boxPadding);
+        box.hi += make_real3(boxPadding);
+    }
+    boxes[nodeId] = box;
+}
+
+/// Refit all the boxes of one object, sequentially; see refitNode()
+__HD__ inline void refitAll(const MeshBVHView& bvh, const real4 *vertices, real3 origin, MeshBVH::Box *boxes)
+{
+    for (int nodeId = bvh.nNodes - 1; nodeId >= 0; --nodeId)
+        refitNode(bvh, nodeId, vertices, origin, boxes);
+}
+
+/// \return the number of triangles of one object crossed by a ray
+__HD__ inline int countIntersections(const MeshBVHView& bvh, const real4 *vertices, real3 origin,
+                                     const MeshBVH::Box *boxes, real3 r, real3 ray)
+{
+    constexpr int maxStackSize = 64;
+    int stack[maxStackSize];
+    int stackSize = 0;
+    int count = 0;
+
+    const real3 invRay = 1.0_r / ray;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const int nodeId = stack[--stackSize];
+        if (!doesRayIntersectBox(r, invRay, boxes[nodeId]))
+            continue;
+
+        const MeshBVH::Node node = bvh.nodes[nodeId];
+        if (node.count == 0)
+        {
+            stack[stackSize++] = node.first;
+            stack[stackSize++] = node.first + 1;
+            continue;
+        }
+
+        for (int i = node.first; i < node.first + node.count; ++i)
+        {
+            const int3 t = bvh.triangles[i];
+            const real3 v0 = fetchPosition(vertices, t.x, origin);
+            const real3 v1 = fetchPosition(vertices, t.y, origin);
+            const real3 v2 = fetchPosition(vertices, t.z, origin);
+            count += doesRayIntersectTriangle(r, ray, v0, v1, v2);
+        }
+    }
+    return count;
+}
+
+/** \brief Check if a point is inside a closed mesh.
+    \param bvh The tree.
+    \param vertices The vertices of the object.
+    \param origin Reference point subtracted from all coordinates; must be the same as in refitNode().
+    \param boxes The refitted boxes of the object.
+    \param r The point, in the same frame as the vertices.
+    \return \c true if the point is inside.
+
+    A point is inside if a ray crosses the mesh an odd number of times.
+    Rays that graze an edge or a vertex may miscount; the majority of nRays distinct rays is used.
+ */
+__HD__ inline bool isInside(const MeshBVHView& bvh, const real4 *vertices, real3 origin,
+                            const MeshBVH::Box *boxes, real3 r)
+{
+    r = r - origin;
+    int votes = 0;
+    for (int i = 0; i < nRays; ++i)
+        votes += countIntersections(bvh, vertices, origin, boxes, r, getRayDirection(i)) % 2;
+    return votes > nRays / 2;
+}
+
+/** \brief Reference implementation without the tree: every triangle is tested.
+    \see isInside()
+ */
+__HD__ inline bool isInsideBruteForce(int ntriangles, const int3 *triangles, const real4 *vertices, real3 r)
+{
+    int votes = 0;
+    for (int i = 0; i < nRays; ++i)
+    {
+        const real3 ray = getRayDirection(i);
+        int count = 0;
+        for (int j = 0; j < ntriangles; ++j)
+        {
+            const int3 t = triangles[j];
+            count += doesRayIntersectTriangle(r, ray,
+                                              fetchPosition(vertices, t.x, {0.0_r, 0.0_r, 0.0_r}),
+                                              fetchPosition(vertices, t.y, {0.0_r, 0.0_r, 0.0_r}),
+                                              fetchPosition(vertices, t.z, {0.0_r, 0.0_r, 0.0_r}));
+        }
+        votes += count % 2;
+    }
+    return votes > nRays / 2;
+}
+
+/** \brief Host implementation of the inside test for many points and objects.
+    \param bvh The tree.
+    \param nObjects Number of objects.
+    \param vertices The vertices of all objects, bvh.nvertices per object.
+    \param nPoints Number of points to test.
+    \param points The points to test.
+    \param inside Output: for each point, the index of an object that contains it, or -1.
+
+    The objects are processed in parallel with std::thread.
+    This does not require a GPU and serves as a reference for the device implementation.
+ */
+void tagInsideHost(const MeshBVH& bvh, int nObjects, const real4 *vertices,
+                   int nPoints, const real3 *points, int *inside);
+
+} // namespace mesh_bvh
+} // namespace mirheo
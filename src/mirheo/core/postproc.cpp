@@ -2,12 +2,14 @@
 #include "postproc.h"
 
 #include <mirheo/core/logger.h>
+#include <mirheo/core/pvs/checkpoint/writer.h>
 #include <mirheo/core/utils/common.h>
 #include <mirheo/core/utils/compile_options.h>
 #include <mirheo/core/utils/path.h>
 
 #include <mpi.h>
 
+#include <algorithm>
 #include <cassert>
 #include <vector>
 
@@ -60,15 +62,22 @@ void Postprocess::init()
     }
 }
 
-static std::vector<int> findGloballyReady(std::vector<MPI_Request>& requests, std::vector<MPI_Status>& statuses, MPI_Comm comm)
+/** Wait until a request completed on at least one rank and complete the requests of all ranks accordingly.
+    Collective over \p comm.
+ */
+static std::vector<int> findGloballyReady(std::vector<MPI_Request>& requests, std::vector<MPI_Status>& statuses,
+                                          MPI_Comm comm)
 {
-    int index;
+    int index {MPI_UNDEFINED};
     MPI_Status stat;
     MPI_Check( MPI_Waitany((int) requests.size(), requests.data(), &index, &stat) );
-    statuses[index] = stat;
 
     std::vector<int> mask(requests.size(), 0);
-    mask[index] = 1;
+    if (index != MPI_UNDEFINED)
+    {
+        statuses[index] = stat;
+        mask[index] = 1;
+    }
     MPI_Check( MPI_Allreduce(MPI_IN_PLACE, mask.data(), (int) mask.size(), MPI_INT, MPI_MAX, comm) );
 
     std::vector<int> ids;
@@ -94,53 +103,115 @@ static void safeCancelAndFreeRequest(MPI_Request& req)
 
 void Postprocess::run()
 {
-    int endMsg {0}, checkpointId {0};
+    run({this});
+}
+
+void Postprocess::run(const std::vector<Postprocess*>& postprocesses)
+{
+    for (auto post : postprocesses)
+        post->_startListening();
 
+    std::vector<Postprocess*> running = postprocesses;
     std::vector<MPI_Request> requests;
+    std::vector<MPI_Status> statuses;
+
+    while (!running.empty())
+    {
+        // wait for the messages of all postprocesses at once
+        requests.clear();
+        for (auto post : running)
+            requests.insert(requests.end(), post->requests_.begin(), post->requests_.end());
+        statuses.resize(requests.size());
+
+        // the postprocesses share the same ranks and stop in the same order on all of them
+        const auto readyIds = findGloballyReady(requests, statuses, running[0]->comm_);
+
+        std::vector<Postprocess*> stillRunning;
+        int offset = 0;
+
+        for (auto post : running)
+        {
+            const int n = static_cast<int>(post->requests_.size());
+
+            // the completed requests were reset by MPI: give the handles back to their owner
+            std::copy(requests.begin() + offset, requests.begin() + offset + n, post->requests_.begin());
+            std::copy(statuses.begin() + offset, statuses.begin() + offset + n, post->statuses_.begin());
+
+            bool stopped = false;
+            for (const auto& index : readyIds)
+                if (!stopped && index >= offset && index < offset + n)
+                    stopped = post->_processMessage(index - offset);
+
+            if (!stopped)
+                stillRunning.push_back(post);
+            offset += n;
+        }
+
+        running = std::move(stillRunning);
+    }
+}
+
+void Postprocess::_startListening()
+{
+    requests_.clear();
     for (auto& pl : plugins_)
-        requests.push_back(pl->waitData());
+        requests_.push_back(pl->waitData());
 
-    const int stoppingReqIndex = static_cast<int>(requests.size());
-    requests.push_back( _listenSimulation(stoppingTag, &endMsg) );
+    // must be before the stopping request: pending checkpoint data is written before stopping
+    checkpointDataReqIndex_ = static_cast<int>(requests_.size());
+    requests_.push_back( _listenCheckpointData(checkpointDataHeader_) );
 
-    const int checkpointReqIndex = static_cast<int>(requests.size());
-    requests.push_back( _listenSimulation(checkpointTag, &checkpointId) );
+    stoppingReqIndex_ = static_cast<int>(requests_.size());
+    requests_.push_back( _listenSimulation(stoppingTag, &endMsg_) );
 
-    std::vector<MPI_Status> statuses(requests.size());
+    checkpointReqIndex_ = static_cast<int>(requests_.size());
+    requests_.push_back( _listenSimulation(checkpointTag, &checkpointId_) );
+
+    statuses_.resize(requests_.size());
 
     info("Postprocess is listening to messages now");
-    while (true)
+}
+
+bool Postprocess::_processMessage(int index)
+{
+    if (index == stoppingReqIndex_)
     {
-        const auto readyIds = findGloballyReady(requests, statuses, comm_);
+        if (endMsg_ != stoppingMsg) die("Received wrong stopping message");
 
-        for (const auto& index : readyIds)
-        {
-            if (index == stoppingReqIndex)
-            {
-                if (endMsg != stoppingMsg) die("Received wrong stopping message");
-
-                info("Postprocess got a stopping message and will stop now");
-
-                for (auto& req : requests)
-                    safeCancelAndFreeRequest(req);
-
-                return;
-            }
-            else if (index == checkpointReqIndex)
-            {
-                debug2("Postprocess got a request for checkpoint, executing now");
-                checkpoint(checkpointId);
-                requests[index] = _listenSimulation(checkpointTag, &checkpointId);
-            }
-            else
-            {
-                debug2("Postprocess got a request from plugin '%s', executing now", plugins_[index]->getCName());
-                plugins_[index]->recv();
-                plugins_[index]->deserialize();
-                requests[index] = plugins_[index]->waitData();
-            }
-        }
+        info("Postprocess got a stopping message and will stop now");
+
+        // The simulation waits for the checkpoint data to be matched before stopping,
+        // hence the request is either complete on all ranks or on none.
+        int checkpointDataReady {0};
+        MPI_Check( MPI_Test(&requests_[checkpointDataReqIndex_], &checkpointDataReady, MPI_STATUS_IGNORE) );
+        if (checkpointDataReady)
+            receiveAndWriteCheckpoint(comm_, interComm_, checkpointDataHeader_);
+
+        for (auto& req : requests_)
+            safeCancelAndFreeRequest(req);
+
+        return true;
+    }
+    else if (index == checkpointDataReqIndex_)
+    {
+        debug2("Postprocess got checkpoint data, writing now");
+        receiveAndWriteCheckpoint(comm_, interComm_, checkpointDataHeader_);
+        requests_[index] = _listenCheckpointData(checkpointDataHeader_);
+    }
+    else if (index == checkpointReqIndex_)
+    {
+        debug2("Postprocess got a request for checkpoint, executing now");
+        checkpoint(checkpointId_);
+        requests_[index] = _listenSimulation(checkpointTag, &checkpointId_);
     }
+    else
+    {
+        debug2("Postprocess got a request from plugin '%s', executing now", plugins_[index]->getCName());
+        plugins_[index]->recv();
+        plugins_[index]->deserialize();
+        requests_[index] = plugins_[index]->waitData();
+    }
+    return false;
 }
 
 MPI_Request Postprocess::_listenSimulation(int tag, int *msg) const
@@ -154,6 +225,17 @@ MPI_Request Postprocess::_listenSimulation(int tag, int *msg) const
     return req;
 }
 
+MPI_Request Postprocess::_listenCheckpointData(int64_t header[2]) const
+{
+    int rank;
+    MPI_Request req;
+
+    MPI_Check( MPI_Comm_rank(comm_, &rank) );
+    MPI_Check( MPI_Irecv(header, 2, MPI_INT64_T, rank, checkpointDataTag, interComm_, &req) );
+
+    return req;
+}
+
 void Postprocess::restart(const std::string& folder)
 {
     info("Reading postprocess state, from folder %s", folder.c_str());
@@ -4,8 +4,10 @@
 #include <mirheo/core/mirheo_object.h>
 #include <mirheo/core/plugins.h>
 
+#include <cstdint>
 #include <memory>
 #include <mpi.h>
+#include <vector>
 
 namespace mirheo
 {
@@ -50,6 +52,14 @@ public:
     /// Start the postprocess. Will run until a termination notification is sent by the simulation.
     void run();
 
+    /** \brief Serve several postprocesses, e.g. the replicas of an \c Ensemble.
+        \param postprocesses The initialized postprocesses; they must have the same ranks.
+
+        Blocks until a message arrives for any of them, executes it, and so on until all the simulations
+        sent their termination notification. Collective over the postprocess ranks.
+     */
+    static void run(const std::vector<Postprocess*>& postprocesses);
+
     /** \brief Restore the state from checkpoint information.
         \param folder The path containing the checkpoint files
      */
@@ -61,7 +71,12 @@ public:
     void checkpoint(int checkpointId);
 
 private:
+    void _startListening();
+    /// execute the message of the completed request \p index; \return \c true if it is the termination notification
+    bool _processMessage(int index);
+
     MPI_Request _listenSimulation(int tag, int *msg) const;
+    MPI_Request _listenCheckpointData(int64_t header[2]) const;
 
     using MirObject::restart;
     using MirObject::checkpoint;
@@ -74,6 +89,16 @@ private:
     std::vector< std::shared_ptr<PostprocessPlugin> > plugins_;
 
     std::string checkpointFolder_;
+
+    // state of the receives posted by _startListening()
+    std::vector<MPI_Request> requests_;
+    std::vector<MPI_Status> statuses_;
+    int checkpointDataReqIndex_ {-1};
+    int stoppingReqIndex_ {-1};
+    int checkpointReqIndex_ {-1};
+    int endMsg_ {0};
+    int checkpointId_ {0};
+    int64_t checkpointDataHeader_[2] {0, 0};
 };
 
 } // namespace mirheo
@@ -0,0 +1,333 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "writer.h"
+
+#include <mirheo/core/logger.h>
+#include <mirheo/core/utils/common.h>
+#include <mirheo/core/utils/file_wrapper.h>
+#include <mirheo/core/utils/path.h>
+#include <mirheo/core/xdmf/xdmf.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace mirheo
+{
+
+static int getRank(MPI_Comm comm)
+{
+    int rank;
+    MPI_Check( MPI_Comm_rank(comm, &rank) );
+    return rank;
+}
+
+static void writeRootFile(MPI_Comm comm, const std::string& filename, const void *data, size_t sizeBytes)
+{
+    if (getRank(comm) != 0)
+        return;
+
+    FileWrapper f;
+    if (f.open(filename, "wb") != FileWrapper::Status::Success)
+        die("Could not open file '%s'", filename.c_str());
+    fwrite(data, 1, sizeBytes, f.get());
+}
+
+static void createRootLink(MPI_Comm comm, const std::string& fname, const std::string& lnname)
+{
+    if (getRank(comm) != 0)
+        return;
+
+    if ( !createHardLink(fname, lnname) )
+        error("Could not create symlink '%s' for checkpoint file '%s'",
+              lnname.c_str(), fname.c_str());
+}
+
+CheckpointWriter::~CheckpointWriter() = default;
+
+//================================================================================================
+// Direct
+//================================================================================================
+
+void DirectCheckpointWriter::writeVertexData(MPI_Comm comm, const std::string& filename,
+                                             std::shared_ptr<std::vector<real3>> positions,
+                                             const std::vector<XDMF::Channel>& channels)
+{
+    XDMF::VertexGrid grid(std::move(positions), comm);
+    XDMF::write(filename, &grid, channels, comm);
+}
+
+void DirectCheckpointWriter::writeRootData(MPI_Comm comm, const std::string& filename,
+                                           const void *data, size_t sizeBytes)
+{
+    writeRootFile(comm, filename, data, sizeBytes);
+}
+
+void DirectCheckpointWriter::createLink(MPI_Comm comm, const std::string& fname, const std::string& lnname)
+{
+    createRootLink(comm, fname, lnname);
+}
+
+//================================================================================================
+// Offload to postprocess
+//================================================================================================
+
+namespace
+{
+enum class OperationType : int64_t {VertexData, RootData, Link};
+
+class Packer
+{
+public:
+    Packer(std::vector<char>& buffer) : buffer_(buffer) {}
+
+    void bytes(const void *data, int64_t sizeBytes)
+    {
+        pod(sizeBytes);
+        const auto *src = static_cast<const char*>(data);
+        buffer_.insert(buffer_.end(), src, src + sizeBytes);
+    }
+
+    template <class T>
+    void pod(const T& value)
+    {
+        const auto *src = reinterpret_cast<const char*>(&value);
+        buffer_.insert(buffer_.end(), src, src + sizeof(T));
+    }
+
+    void string(const std::string& s)
+    {
+        bytes(s.data(), static_cast<int64_t>(s.size()));
+    }
+
+private:
+    std::vector<char>& buffer_;
+};
+
+class Unpacker
+{
+public:
+    Unpacker(const std::vector<char>& buffer) : buffer_(buffer) {}
+
+    /// \return the size of the data and a pointer to it, valid as long as the buffer
+    std::pair<int64_t, const char*> bytes()
+    {
+        const auto sizeBytes = pod<int64_t>();
+        const char *data = _advance(sizeBytes);
+        return {sizeBytes, data};
+    }
+
+    template <class T>
+    T pod()
+    {
+        T value;
+        std::memcpy(&value, _advance(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string string()
+    {
+        const auto b = bytes();
+        return std::string(b.second, b.second + b.first);
+    }
+
+private:
+    const char* _advance(int64_t n)
+    {
+        if (position_ + n > static_cast<int64_t>(buffer_.size()))
+            die("Corrupted checkpoint data: reading %lld bytes at position %lld out of %lld",
+                (long long) n, (long long) position_, (long long) buffer_.size());
+        const char *ptr = buffer_.data() + position_;
+        position_ += n;
+        return ptr;
+    }
+
+    const std::vector<char>& buffer_;
+    int64_t position_ {0};
+};
+} // anonymous namespace
+
+OffloadCheckpointWriter::OffloadCheckpointWriter(MPI_Comm interComm) :
+    interComm_(interComm)
+{}
+
+OffloadCheckpointWriter::~OffloadCheckpointWriter()
+{
+    if (hasPendingOperations())
+        error("%d checkpoint operations were never sent to the postprocess", numOperations_);
+    wait();
+}
+
+void OffloadCheckpointWriter::writeVertexData(__UNUSED MPI_Comm comm, const std::string& filename,
+                                              std::shared_ptr<std::vector<real3>> positions,
+                                              const std::vector<XDMF::Channel>& channels)
+{
+    const auto n = static_cast<int64_t>(positions->size());
+
+    Packer packer(buffer_);
+    packer.pod(OperationType::VertexData);
+    packer.string(filename);
+    packer.pod(n);
+    packer.bytes(positions->data(), n * static_cast<int64_t>(sizeof(real3)));
+    packer.pod(static_cast<int64_t>(channels.size()));
+
+    for (const auto& ch : channels)
+    {
+        packer.string(ch.name);
+        packer.string(XDMF::dataFormToDescription(ch.dataForm));
+        packer.pod(ch.numberType);
+        packer.string(typeDescriptorToString(ch.type));
+        packer.pod(ch.needShift);
+        packer.pod(ch.compression);
+        packer.bytes(ch.data, n * ch.nComponents() * ch.precision());
+    }
+    ++numOperations_;
+}
+
+void OffloadCheckpointWriter::writeRootData(MPI_Comm comm, const std::string& filename,
+                                            const void *data, size_t sizeBytes)
+{
+    // only the root rank of the postprocess writes the file
+    if (getRank(comm) != 0)
+        sizeBytes = 0;
+
+    Packer packer(buffer_);
+    packer.pod(OperationType::RootData);
+    packer.string(filename);
+    packer.bytes(data, static_cast<int64_t>(sizeBytes));
+    ++numOperations_;
+}
+
+void OffloadCheckpointWriter::createLink(__UNUSED MPI_Comm comm, const std::string& fname, const std::string& lnname)
+{
+    Packer packer(buffer_);
+    packer.pod(OperationType::Link);
+    packer.string(fname);
+    packer.string(lnname);
+    ++numOperations_;
+}
+
+bool OffloadCheckpointWriter::hasPendingOperations() const
+{
+    return numOperations_ > 0;
+}
+
+void OffloadCheckpointWriter::send(MPI_Comm comm)
+{
+    wait();
+
+    std::swap(sendBuffer_, buffer_);
+    buffer_.clear();
+
+    const int rank = getRank(comm);
+    const auto sizeBytes = static_cast<int64_t>(sendBuffer_.size());
+    sendHeader_[0] = numOperations_;
+    sendHeader_[1] = sizeBytes;
+    numOperations_ = 0;
+
+    debug("Sending %lld checkpoint operations (%lld bytes) to the postprocess",
+          (long long) sendHeader_[0], (long long) sizeBytes);
+
+    // synchronous mode: the header is matched once the send completes (see Simulation::run)
+    MPI_Request req;
+    MPI_Check( MPI_Issend(sendHeader_, 2, MPI_INT64_T, rank, checkpointDataTag, interComm_, &req) );
+    sendRequests_.push_back(req);
+
+    for (int64_t start = 0; start < sizeBytes; start += maxChunkSizeBytes)
+    {
+        const int count = static_cast<int>(std::min(maxChunkSizeBytes, sizeBytes - start));
+        MPI_Check( MPI_Isend(sendBuffer_.data() + start, count, MPI_BYTE, rank,
+                             checkpointChunkTag, interComm_, &req) );
+        sendRequests_.push_back(req);
+    }
+}
+
+void OffloadCheckpointWriter::wait()
+{
+    if (sendRequests_.empty())
+        return;
+
+    MPI_Check( MPI_Waitall(static_cast<int>(sendRequests_.size()), sendRequests_.data(), MPI_STATUSES_IGNORE) );
+    sendRequests_.clear();
+}
+
+void receiveAndWriteCheckpoint(MPI_Comm comm, MPI_Comm interComm, const int64_t header[2])
+{
+    const int rank = getRank(comm);
+    const int64_t numOperations = header[0];
+    const int64_t sizeBytes     = header[1];
+
+    info("Receiving %lld checkpoint operations (%lld bytes) from the simulation",
+         (long long) numOperations, (long long) sizeBytes);
+
+    std::vector<char> buffer(sizeBytes);
+    for (int64_t start = 0; start < sizeBytes; start += OffloadCheckpointWriter::maxChunkSizeBytes)
+    {
+        const int count = static_cast<int>(std::min(OffloadCheckpointWriter::maxChunkSizeBytes, sizeBytes - start));
+        MPI_Check( MPI_Recv(buffer.data() + start, count, MPI_BYTE, rank,
+                            checkpointChunkTag, interComm, MPI_STATUS_IGNORE) );
+    }
+
+    Unpacker unpacker(buffer);
+    DirectCheckpointWriter writer;
+
+    for (int64_t op = 0; op < numOperations; ++op)
+    {
+        const auto type = unpacker.pod<OperationType>();
+
+        switch (type)
+        {
+        case OperationType::VertexData:
+        {
+            const auto filename = unpacker.string();
+            const auto n = unpacker.pod<int64_t>();
+            const auto pos = unpacker.bytes();
+
+            auto positions = std::make_shared<std::vector<real3>>(n);
+            std::memcpy(positions->data(), pos.second, pos.first);
+
+            const auto numChannels = unpacker.pod<int64_t>();
+            std::vector<XDMF::Channel> channels;
+            std::vector<std::vector<char>> channelsData;
+            channelsData.reserve(numChannels);
+
+            for (int64_t i = 0; i < numChannels; ++i)
+            {
+                XDMF::Channel ch;
+                ch.name       = unpacker.string();
+                ch.dataForm   = XDMF::descriptionToDataForm(unpacker.string());
+                ch.numberType = unpacker.pod<XDMF::Channel::NumberType>();
+                ch.type       = stringToTypeDescriptor(unpacker.string());
+                ch.needShift  = unpacker.pod<XDMF::Channel::NeedShift>();
+                ch.compression = unpacker.pod<XDMF::Channel::Compression>();
+
+                const auto data = unpacker.bytes();
+                channelsData.emplace_back(data.second, data.second + data.first);
+                ch.data = channelsData.back().data();
+                channels.push_back(std::move(ch));
+            }
+
+            writer.writeVertexData(comm, filename, std::move(positions), channels);
+            break;
+        }
+        case OperationType::RootData:
+        {
+            const auto filename = unpacker.string();
+            const auto data = unpacker.bytes();
+            writer.writeRootData(comm, filename, data.second, data.first);
+            break;
+        }
+        case OperationType::Link:
+        {
+            const auto fname  = unpacker.string();
+            const auto lnname = unpacker.string();
+            writer.createLink(comm, fname, lnname);
+            break;
+        }
+        default:
+            die("Corrupted checkpoint data: unknown operation type %lld", (long long) type);
+        }
+    }
+
+    debug("Offloaded checkpoint successfully written");
+}
+
+} // namespace mirheo
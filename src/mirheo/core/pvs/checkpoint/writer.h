@@ -0,0 +1,127 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <mirheo/core/datatypes.h>
+
+#include <cstdint>
+#include <memory>
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace mirheo
+{
+
+namespace XDMF {struct Channel;}
+
+/** \brief Destination of the particle data written at checkpoint time.
+
+    The particle vectors describe what must be written; the writer decides when and by which ranks
+    the files are actually written.
+    The operations are performed in the order of the calls.
+ */
+class CheckpointWriter
+{
+public:
+    virtual ~CheckpointWriter();
+
+    /** \brief Write vertex data to a pair of xmf+hdf5 files.
+        \param [in] comm The communicator of the simulation ranks; the call is collective.
+        \param [in] filename Destination file name, without extension.
+        \param [in] positions Vertex positions, in global coordinates.
+        \param [in] channels Additional data per vertex. The pointed data must be valid only during the call.
+     */
+    virtual void writeVertexData(MPI_Comm comm, const std::string& filename,
+                                 std::shared_ptr<std::vector<real3>> positions,
+                                 const std::vector<XDMF::Channel>& channels) = 0;
+
+    /** \brief Write raw bytes to a file from the root rank.
+        \param [in] comm The communicator of the simulation ranks; the call is collective.
+        \param [in] filename Destination file name.
+        \param [in] data The content of the file, only used on the root rank.
+        \param [in] sizeBytes Number of bytes of \p data.
+     */
+    virtual void writeRootData(MPI_Comm comm, const std::string& filename,
+                               const void *data, size_t sizeBytes) = 0;
+
+    /** \brief Link a checkpoint file to its name without id, once the file is written.
+        \param [in] comm The communicator of the simulation ranks; the call is collective.
+        \param [in] fname The checkpoint file name (with id).
+        \param [in] lnname The name of the link.
+     */
+    virtual void createLink(MPI_Comm comm, const std::string& fname, const std::string& lnname) = 0;
+};
+
+/// Write the checkpoint files immediately, from the simulation ranks.
+class DirectCheckpointWriter : public CheckpointWriter
+{
+public:
+    void writeVertexData(MPI_Comm comm, const std::string& filename,
+                         std::shared_ptr<std::vector<real3>> positions,
+                         const std::vector<XDMF::Channel>& channels) override;
+    void writeRootData(MPI_Comm comm, const std::string& filename,
+                       const void *data, size_t sizeBytes) override;
+    void createLink(MPI_Comm comm, const std::string& fname, const std::string& lnname) override;
+};
+
+/** \brief Copy the checkpoint data into host buffers and send it to the postprocess ranks.
+
+    The simulation ranks only pay for the device to host copy and the packing;
+    the (collective) file writes are performed by the postprocess ranks with
+    receiveAndWriteCheckpoint(), while the simulation goes on.
+    The written files are identical to the ones of DirectCheckpointWriter.
+
+    The operations are accumulated until send() is called.
+    The buffers of one send() are kept alive until the next send() or wait().
+ */
+class OffloadCheckpointWriter : public CheckpointWriter
+{
+public:
+    /** \brief Construct a OffloadCheckpointWriter.
+        \param [in] interComm The inter communicator between simulation and postprocess ranks.
+     */
+    OffloadCheckpointWriter(MPI_Comm interComm);
+    ~OffloadCheckpointWriter();
+
+    void writeVertexData(MPI_Comm comm, const std::string& filename,
+                         std::shared_ptr<std::vector<real3>> positions,
+                         const std::vector<XDMF::Channel>& channels) override;
+    void writeRootData(MPI_Comm comm, const std::string& filename,
+                       const void *data, size_t sizeBytes) override;
+    void createLink(MPI_Comm comm, const std::string& fname, const std::string& lnname) override;
+
+    /** \brief Send all the accumulated operations to the postprocess rank with the same rank as the caller.
+        \param [in] comm The communicator of the simulation ranks.
+
+        Waits for the completion of the previous send first.
+     */
+    void send(MPI_Comm comm);
+
+    /// Wait until the postprocess rank has received the data of the last send().
+    void wait();
+
+    /// \return \c true if there are operations that are not sent yet.
+    bool hasPendingOperations() const;
+
+    /// Maximum size of one message, in bytes.
+    static constexpr int64_t maxChunkSizeBytes = 1 << 30;
+
+private:
+    std::vector<char> buffer_; ///< packed operations that are not sent yet
+    int numOperations_ {0};    ///< number of operations in buffer_
+
+    std::vector<char> sendBuffer_;         ///< data being sent
+    int64_t sendHeader_[2];                ///< number of operations and size of sendBuffer_
+    std::vector<MPI_Request> sendRequests_;
+
+    MPI_Comm interComm_;
+};
+
+/** \brief Receive the operations sent by a OffloadCheckpointWriter and perform them.
+    \param [in] comm The communicator of the postprocess ranks; the call is collective.
+    \param [in] interComm The inter communicator between simulation and postprocess ranks.
+    \param [in] header The header received from the simulation rank with tag \c checkpointDataTag.
+ */
+void receiveAndWriteCheckpoint(MPI_Comm comm, MPI_Comm interComm, const int64_t header[2]);
+
+} // namespace mirheo
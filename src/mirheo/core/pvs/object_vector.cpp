@@ -2,6 +2,7 @@
 #include "object_vector.h"
 
 #include "checkpoint/helpers.h"
+#include "checkpoint/writer.h"
 #include "restart/helpers.h"
 #include "utils/compute_com_extents.h"
 
@@ -154,7 +155,8 @@ static std::vector<real3> getCom(DomainInfo domain,
     return pos;
 }
 
-void ObjectVector::_snapshotObjectData(MPI_Comm comm, const std::string& filename)
+void ObjectVector::_snapshotObjectData(MPI_Comm comm, const std::string& filename,
+                                       CheckpointWriter& writer)
 {
     CUDA_Check( cudaDeviceSynchronize() );
 
@@ -167,21 +169,22 @@ void ObjectVector::_snapshotObjectData(MPI_Comm comm, const std::string& filenam
 
     auto positions = std::make_shared<std::vector<real3>>(getCom(getState()->domain, *coms_extents));
 
-    XDMF::VertexGrid grid(positions, comm);
-
     auto channels = checkpoint_helpers::extractShiftPersistentData(getState()->domain,
                                                                   local()->dataPerObject);
 
-    XDMF::write(filename, &grid, channels, comm);
+    writer.writeVertexData(comm, filename, std::move(positions), channels);
 
     debug("Checkpoint for object vector '%s' successfully written", getCName());
 }
 
-void ObjectVector::_checkpointObjectData(MPI_Comm comm, const std::string& path, int checkpointId)
+void ObjectVector::_checkpointObjectData(MPI_Comm comm, const std::string& path, int checkpointId,
+                                         CheckpointWriter& writer)
 {
     auto filename = createCheckpointNameWithId(path, RestartOVIdentifier, "", checkpointId);
-    _snapshotObjectData(comm, filename);
-    createCheckpointSymlink(comm, path, RestartOVIdentifier, "xmf", checkpointId);
+    _snapshotObjectData(comm, filename, writer);
+    writer.createLink(comm,
+                      createCheckpointNameWithId(path, RestartOVIdentifier, "xmf", checkpointId),
+                      createCheckpointName      (path, RestartOVIdentifier, "xmf"));
     debug("Created a symlink for object vector '%s'", getCName());
 }
 
@@ -210,10 +213,11 @@ void ObjectVector::_restartObjectData(MPI_Comm comm, const std::string& path,
     info("Successfully read object infos of '%s'", getCName());
 }
 
-void ObjectVector::checkpoint(MPI_Comm comm, const std::string& path, int checkpointId)
+void ObjectVector::checkpoint(MPI_Comm comm, const std::string& path, int checkpointId,
+                              CheckpointWriter& writer)
 {
-    _checkpointParticleData(comm, path, checkpointId);
-    _checkpointObjectData  (comm, path, checkpointId);
+    _checkpointParticleData(comm, path, checkpointId, writer);
+    _checkpointObjectData  (comm, path, checkpointId, writer);
 }
 
 void ObjectVector::restart(MPI_Comm comm, const std::string& path)
@@ -95,7 +95,8 @@ public:
     }
 
 
-    void checkpoint (MPI_Comm comm, const std::string& path, int checkpointId) override;
+    using ParticleVector::checkpoint;
+    void checkpoint (MPI_Comm comm, const std::string& path, int checkpointId, CheckpointWriter& writer) override;
     void restart    (MPI_Comm comm, const std::string& path) override;
 
 
@@ -133,8 +134,10 @@ protected:
         \param [in] comm MPI Cartesian comm used to perform I/O and exchange data across ranks
         \param [in] path Destination folder
         \param [in] checkpointId The Id of the dump
+        \param [in,out] writer Performs (or schedules) the file writes
      */
-    virtual void _checkpointObjectData(MPI_Comm comm, const std::string& path, int checkpointId);
+    virtual void _checkpointObjectData(MPI_Comm comm, const std::string& path, int checkpointId,
+                                       CheckpointWriter& writer);
 
     /** Load object data from a file
         \param [in] comm MPI Cartesian comm used to perform I/O and exchange data across ranks
@@ -144,7 +147,7 @@ protected:
     virtual void _restartObjectData(MPI_Comm comm, const std::string& path, const ExchMapSize& ms);
 
 private:
-    void _snapshotObjectData(MPI_Comm comm, const std::string& filename);
+    void _snapshotObjectData(MPI_Comm comm, const std::string& filename, CheckpointWriter& writer);
 
     template<typename T>
     void _requireDataPerObject(LocalObjectVector* lov, const std::string& name,
@@ -1,6 +1,7 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #include "particle_vector.h"
 #include "checkpoint/helpers.h"
+#include "checkpoint/writer.h"
 #include "restart/helpers.h"
 
 #include <mirheo/core/utils/cuda_common.h>
@@ -184,7 +185,8 @@ void ParticleVector::setForces_vector(const std::vector<real3>& forces)
     local()->forces().uploadToDevice(defaultStream);
 }
 
-void ParticleVector::_snapshotParticleData(MPI_Comm comm, const std::string& filename)
+void ParticleVector::_snapshotParticleData(MPI_Comm comm, const std::string& filename,
+                                           CheckpointWriter& writer)
 {
     CUDA_Check( cudaDeviceSynchronize() );
 
@@ -204,8 +206,6 @@ void ParticleVector::_snapshotParticleData(MPI_Comm comm, const std::string& fil
     std::tie(*positions, velocities, ids) = checkpoint_helpers::splitAndShiftPosVel(getState()->domain,
                                                                                    pos4, vel4);
 
-    XDMF::VertexGrid grid(positions, comm);
-
     // do not dump positions and velocities, they are already there
     const std::set<std::string> blackList {{channel_names::positions, channel_names::velocities}};
 
@@ -225,17 +225,20 @@ void ParticleVector::_snapshotParticleData(MPI_Comm comm, const std::string& fil
                                          DataTypeWrapper<int64_t>(),
                                          XDMF::Channel::NeedShift::False});
 
-    XDMF::write(filename, &grid, channels, comm);
+    writer.writeVertexData(comm, filename, std::move(positions), channels);
 
     debug("Checkpoint for particle vector '%s' successfully written", getCName());
 }
 
-void ParticleVector::_checkpointParticleData(MPI_Comm comm, const std::string& path, int checkpointId)
+void ParticleVector::_checkpointParticleData(MPI_Comm comm, const std::string& path, int checkpointId,
+                                             CheckpointWriter& writer)
 {
     auto filename = createCheckpointNameWithId(path, RestartPVIdentifier, "", checkpointId);
-    _snapshotParticleData(comm, filename);
+    _snapshotParticleData(comm, filename, writer);
 
-    createCheckpointSymlink(comm, path, RestartPVIdentifier, "xmf", checkpointId);
+    writer.createLink(comm,
+                      createCheckpointNameWithId(path, RestartPVIdentifier, "xmf", checkpointId),
+                      createCheckpointName      (path, RestartPVIdentifier, "xmf"));
     debug("Created a symlink for particle vector '%s'", getCName());
 }
 
@@ -286,7 +289,14 @@ ParticleVector::ExchMapSize ParticleVector::_restartParticleData(MPI_Comm comm,
 
 void ParticleVector::checkpoint(MPI_Comm comm, const std::string& path, int checkpointId)
 {
-    _checkpointParticleData(comm, path, checkpointId);
+    DirectCheckpointWriter writer;
+    checkpoint(comm, path, checkpointId, writer);
+}
+
+void ParticleVector::checkpoint(MPI_Comm comm, const std::string& path, int checkpointId,
+                                CheckpointWriter& writer)
+{
+    _checkpointParticleData(comm, path, checkpointId, writer);
 }
 
 void ParticleVector::restart(MPI_Comm comm, const std::string& path)
@@ -13,6 +13,7 @@
 namespace mirheo
 {
 
+class CheckpointWriter;
 class ParticleVector;
 
 /// Designs local or halo data
@@ -130,6 +131,16 @@ public:
     void checkpoint(MPI_Comm comm, const std::string& path, int checkpointId) override;
     void restart   (MPI_Comm comm, const std::string& path) override;
 
+    /** \brief Save the particle data through a given writer.
+        \param [in] comm MPI Cartesian comm used to perform I/O and exchange data across ranks
+        \param [in] path Destination folder
+        \param [in] checkpointId The Id of the dump
+        \param [in,out] writer Performs (or schedules) the file writes
+
+        checkpoint(MPI_Comm, const std::string&, int) writes the files immediately.
+     */
+    virtual void checkpoint(MPI_Comm comm, const std::string& path, int checkpointId, CheckpointWriter& writer);
+
 
     /** Python getters / setters
         Use default blocking stream
@@ -182,15 +193,18 @@ protected:
     /** Dump particle data into a file
         \param [in] comm MPI Cartesian comm used to perform I/O and exchange data across ranks
         \param [in] filename Destination file.
+        \param [in,out] writer Performs (or schedules) the file writes
      */
-    void _snapshotParticleData(MPI_Comm comm, const std::string& filename);
+    void _snapshotParticleData(MPI_Comm comm, const std::string& filename, CheckpointWriter& writer);
 
     /** Dump particle data into a file
         \param [in] comm MPI Cartesian comm used to perform I/O and exchange data across ranks
         \param [in] path Destination folder
         \param [in] checkpointId The Id of the dump
+        \param [in,out] writer Performs (or schedules) the file writes
      */
-    virtual void _checkpointParticleData(MPI_Comm comm, const std::string& path, int checkpointId);
+    virtual void _checkpointParticleData(MPI_Comm comm, const std::string& path, int checkpointId,
+                                         CheckpointWriter& writer);
 
     /** Load particle data from a file
         \param [in] comm MPI Cartesian comm used to perform I/O and exchange data across ranks
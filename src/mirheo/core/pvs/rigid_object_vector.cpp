@@ -1,6 +1,7 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #include "restart/helpers.h"
 #include "checkpoint/helpers.h"
+#include "checkpoint/writer.h"
 #include "rigid_object_vector.h"
 #include "views/rov.h"
 
@@ -101,18 +102,6 @@ RigidObjectVector::RigidObjectVector(const MirState *state, const std::string& n
 
 RigidObjectVector::~RigidObjectVector() = default;
 
-static void writeInitialPositions(MPI_Comm comm, const std::string& filename,
-                                  const PinnedBuffer<real4>& positions)
-{
-    int rank;
-    MPI_Check( MPI_Comm_rank(comm, &rank) );
-    if (rank != 0) return;
-
-    FileWrapper f;
-    f.open(filename, "wb");
-    fwrite(positions.data(), sizeof(positions[0]), positions.size(), f.get());
-}
-
 static PinnedBuffer<real4> readInitialPositions(MPI_Comm comm, const std::string& filename,
                                                  int objSize)
 {
@@ -136,7 +125,7 @@ static PinnedBuffer<real4> readInitialPositions(MPI_Comm comm, const std::string
 
 
 void RigidObjectVector::_snapshotObjectData(MPI_Comm comm, const std::string& xdmfFilename,
-                                            const std::string& ipFilename)
+                                            const std::string& ipFilename, CheckpointWriter& writer)
 {
     CUDA_Check( cudaDeviceSynchronize() );
 
@@ -154,8 +143,6 @@ void RigidObjectVector::_snapshotObjectData(MPI_Comm comm, const std::string& xd
     std::tie(*positions, quaternion, vel, omega, force, torque)
         = checkpoint_helpers::splitAndShiftMotions(getState()->domain, *motions);
 
-    XDMF::VertexGrid grid(positions, comm);
-
     auto rigidType = XDMF::getNumberType<RigidReal>();
 
     const std::set<std::string> blackList {channel_names::motions};
@@ -189,21 +176,25 @@ void RigidObjectVector::_snapshotObjectData(MPI_Comm comm, const std::string& xd
                                          rigidType, DataTypeWrapper<RigidReal3>(),
                                          XDMF::Channel::NeedShift::False});
 
-    XDMF::write(xdmfFilename, &grid, channels, comm);
+    writer.writeVertexData(comm, xdmfFilename, std::move(positions), channels);
 
-    writeInitialPositions(comm, ipFilename, initialPositions);
+    writer.writeRootData(comm, ipFilename, initialPositions.data(),
+                         initialPositions.size() * sizeof(initialPositions[0]));
 
     debug("Checkpoint for rigid object vector '%s' successfully written", getCName());
 }
 
 
-void RigidObjectVector::_checkpointObjectData(MPI_Comm comm, const std::string& path, int checkpointId)
+void RigidObjectVector::_checkpointObjectData(MPI_Comm comm, const std::string& path, int checkpointId,
+                                              CheckpointWriter& writer)
 {
     auto xdmfFilename = createCheckpointNameWithId(path, RestartROVIdentifier, "", checkpointId);
     auto ipFilename   = createCheckpointNameWithId(path, RestartIPIdentifier, "coords", checkpointId);
-    _snapshotObjectData(comm, xdmfFilename, ipFilename);
-    createCheckpointSymlink(comm, path, RestartROVIdentifier, "xmf", checkpointId);
-    createCheckpointSymlink(comm, path, RestartIPIdentifier, "coords", checkpointId);
+    _snapshotObjectData(comm, xdmfFilename, ipFilename, writer);
+    writer.createLink(comm,
+                      createCheckpointNameWithId(path, RestartROVIdentifier, "xmf", checkpointId),
+                      createCheckpointName      (path, RestartROVIdentifier, "xmf"));
+    writer.createLink(comm, ipFilename, createCheckpointName(path, RestartIPIdentifier, "coords"));
     debug("Symbolic links for rigid object vector '%s' created", getCName());
 }
 
@@ -75,12 +75,13 @@ public:
 
 protected:
 
-    void _checkpointObjectData(MPI_Comm comm, const std::string& path, int checkpointId) override;
+    void _checkpointObjectData(MPI_Comm comm, const std::string& path, int checkpointId,
+                               CheckpointWriter& writer) override;
     void _restartObjectData   (MPI_Comm comm, const std::string& path, const ExchMapSize& ms) override;
 
 private:
     void _snapshotObjectData(MPI_Comm comm, const std::string& filename,
-                             const std::string& initialPosFilename);
+                             const std::string& initialPosFilename, CheckpointWriter& writer);
 
 public:
     PinnedBuffer<real4> initialPositions; ///< Coordinates of the frozen particles in the frame of reference of the object
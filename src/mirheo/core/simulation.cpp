@@ -11,6 +11,7 @@
 #include <mirheo/core/mirheo_state.h>
 #include <mirheo/core/object_belonging/interface.h>
 #include <mirheo/core/plugins.h>
+#include <mirheo/core/pvs/checkpoint/writer.h>
 #include <mirheo/core/pvs/particle_vector.h>
 #include <mirheo/core/pvs/rigid_object_vector.h>
 #include <mirheo/core/task_scheduler.h>
@@ -103,6 +104,8 @@ struct RunData {
     std::map<ParticleVector*, std::vector< std::unique_ptr<CellList> >> cellListMap;
 
     std::vector<std::function<void(cudaStream_t)>> regularBouncers, haloBouncers;
+
+    MirState::StepType nsteps {0}; ///< number of steps of the current run, see Simulation::startRun()
 };
 
 static void checkCartesianTopology(const MPI_Comm& cartComm)
@@ -152,6 +155,14 @@ Simulation::Simulation(const MPI_Comm &cartComm, const MPI_Comm &interComm, MirS
     if (checkpointInfo_.needDump())
         createFoldersCollective(cartComm_, checkpointInfo_.folder);
 
+    if (checkpointInfo_.asynchronous)
+    {
+        if (interComm_ != MPI_COMM_NULL)
+            checkpointWriter_ = std::make_unique<OffloadCheckpointWriter>(interComm_);
+        else
+            warn("Asynchronous checkpoints require postprocess ranks; the checkpoints will be written directly");
+    }
+
     const auto &domain = state_->domain;
     if (domain.globalSize.x <= 0 || domain.globalSize.y <= 0 || domain.globalSize.z <= 0) {
         die("Invalid domain size: [%f %f %f]",
@@ -872,22 +883,9 @@ void Simulation::_prepareEngines()
         }
     }
 
-    std::function< std::unique_ptr<ExchangeEngine>(std::unique_ptr<Exchanger>) > makeEngine;
-
-    // If we're on one node, use a singleNode engine
-    // otherwise use MPI
-    if (nranks3D_.x * nranks3D_.y * nranks3D_.z == 1)
-    {
-        makeEngine = [this] (std::unique_ptr<Exchanger> exch) {
-            return std::make_unique<SingleNodeExchangeEngine> (std::move(exch));
-        };
-    }
-    else
-    {
-        makeEngine = [this] (std::unique_ptr<Exchanger> exch) {
-            return std::make_unique<MPIExchangeEngine> (std::move(exch), cartComm_, gpuAwareMPI_);
-        };
-    }
+    auto makeEngine = [this] (std::unique_ptr<Exchanger> exch) {
+        return createExchangeEngine(exchangeEngineType_, std::move(exch), cartComm_, gpuAwareMPI_);
+    };
 
     run_->partRedistributor          = makeEngine(std::move(partRedistImp));
     run_->partHaloFinal              = makeEngine(std::move(partHaloFinalImp));
@@ -1219,7 +1217,7 @@ static void createTasksDummy(TaskScheduler *scheduler, SimulationTasks *tasks)
 #undef DUMMY_TASK
 }
 
-static void buildDependencies(TaskScheduler *scheduler, SimulationTasks *tasks)
+static void buildDependencies(TaskScheduler *scheduler, SimulationTasks *tasks, bool deterministicForces)
 {
     scheduler->addDependency(tasks->pluginsBeforeCellLists, { tasks->cellLists }, {});
 
@@ -1259,6 +1257,13 @@ static void buildDependencies(TaskScheduler *scheduler, SimulationTasks *tasks)
     scheduler->addDependency(tasks->haloForces, {}, {tasks->partHaloFinalFinalize, tasks->objHaloIntermediateFinalize});
     scheduler->addDependency(tasks->accumulateInteractionFinal, {tasks->integration}, {tasks->haloForces, tasks->localForces});
 
+    // the local and halo interactions add to the same particles; they must not run concurrently in deterministic mode
+    if (deterministicForces)
+    {
+        scheduler->addDependency(tasks->haloIntermediate, {}, {tasks->localIntermediate});
+        scheduler->addDependency(tasks->haloForces,       {}, {tasks->localForces});
+    }
+
     scheduler->addDependency(tasks->pluginsBeforeIntegration, {tasks->integration}, {tasks->accumulateInteractionFinal});
     scheduler->addDependency(tasks->wallBounce, {}, {tasks->integration});
     scheduler->addDependency(tasks->wallCheck, {tasks->partRedistributeInit}, {tasks->wallBounce});
@@ -1321,10 +1326,23 @@ void Simulation::init()
     info("Time-step is set to %f", getCurrentDt());
 
     _createTasks();
-    buildDependencies(&run_->scheduler, &run_->tasks);
+    buildDependencies(&run_->scheduler, &run_->tasks, state_->deterministicForces);
+
+    if (!taskProfilingFileName_.empty())
+        run_->scheduler.enableProfiling(taskProfilingStreamEvents_);
 }
 
 void Simulation::run(MirState::StepType nsteps)
+{
+    startRun(nsteps);
+
+    for (MirState::StepType i = 0; i < nsteps; ++i)
+        runStep();
+
+    finishRun();
+}
+
+void Simulation::startRun(MirState::StepType nsteps)
 {
     // Initial preparation
     run_->scheduler.forceExec( run_->tasks.objHaloFinalInit,     defaultStream );
@@ -1333,31 +1351,60 @@ void Simulation::run(MirState::StepType nsteps)
     run_->scheduler.forceExec( run_->tasks.objClearLocalForces,  defaultStream );
     _execSplitters();
 
-    const MirState::StepType begin = state_->currentStep;
-    const MirState::StepType end = state_->currentStep + nsteps;
+    run_->nsteps = nsteps;
 
     info("Will run %lld iterations now", nsteps);
+}
 
+void Simulation::runStep()
+{
+    runStep({this});
+}
+
+void Simulation::runStep(const std::vector<Simulation*>& simulations)
+{
+    std::vector<TaskScheduler*> schedulers;
 
-    for (state_->currentStep = begin; state_->currentStep < end; state_->currentStep++)
+    for (auto sim : simulations)
     {
         debug("===============================================================================\n"
-                "Timestep: %lld, simulation time: %f", state_->currentStep, state_->currentTime);
+              "Timestep: %lld, simulation time: %f", sim->state_->currentStep, sim->state_->currentTime);
+        schedulers.push_back(&sim->run_->scheduler);
+    }
 
-        run_->scheduler.run();
+    TaskScheduler::run(schedulers);
 
-        state_->currentTime += state_->getDt();
+    for (auto sim : simulations)
+    {
+        sim->state_->currentTime += sim->state_->getDt();
+        sim->state_->currentStep++;
     }
+}
 
+void Simulation::finishRun()
+{
     // Finish the redistribution by rebuilding the cell-lists
     run_->scheduler.forceExec( run_->tasks.cellLists, defaultStream );
 
-    info("Finished with %lld iterations", nsteps);
+    info("Finished with %lld iterations", run_->nsteps);
+
+    if (!taskProfilingFileName_.empty() && rank_ == 0)
+    {
+        const auto& steps = run_->scheduler.getProfiler().getStepStats();
+        info("Task profiling: one scheduler run takes %f ms on average, dumping report to '%s'",
+             steps.mean(), taskProfilingFileName_.c_str());
+        run_->scheduler.dumpProfile(taskProfilingFileName_);
+    }
+
     MPI_Check( MPI_Barrier(cartComm_) );
 
     for (auto& pl : plugins)
         pl->finalize();
 
+    // the postprocess must have received the checkpoint data before the stopping message
+    if (checkpointWriter_)
+        checkpointWriter_->wait();
+
     notifyPostProcess(stoppingTag, stoppingMsg);
 
     _cleanup();
@@ -1388,14 +1435,14 @@ void Simulation::_restartState(const std::string& folder)
     if (!good) die("failed to read '%s'\n", filename.c_str());
 }
 
-void Simulation::_checkpointState()
+void Simulation::_checkpointState(CheckpointWriter& writer)
 {
     auto filename = createCheckpointNameWithId(checkpointInfo_.folder, "state", "txt", checkpointId_);
 
     if (rank_ == 0)
         text_IO::write(filename, state_->currentTime, state_->currentStep, checkpointId_);
 
-    createCheckpointSymlink(cartComm_, checkpointInfo_.folder, "state", "txt", checkpointId_);
+    writer.createLink(cartComm_, filename, createCheckpointName(checkpointInfo_.folder, "state", "txt"));
 }
 
 
@@ -1455,14 +1502,21 @@ void Simulation::restart(const std::string& folder)
 
 void Simulation::checkpoint()
 {
-    this->_checkpointState();
+    DirectCheckpointWriter directWriter;
+    CheckpointWriter& writer = checkpointWriter_ ? *checkpointWriter_ : static_cast<CheckpointWriter&>(directWriter);
 
     CUDA_Check( cudaDeviceSynchronize() );
 
     info("Writing simulation state, into folder %s", checkpointInfo_.folder.c_str());
 
     for (auto& pv : particleVectors_)
-        pv->checkpoint(cartComm_, checkpointInfo_.folder, checkpointId_);
+        pv->checkpoint(cartComm_, checkpointInfo_.folder, checkpointId_, writer);
+
+    // the state is linked last, so that it never refers to particle data that is not written yet
+    this->_checkpointState(writer);
+
+    if (checkpointWriter_)
+        checkpointWriter_->send(cartComm_);
 
     for (auto& handler : bouncerMap_)
         handler.second->checkpoint(cartComm_, checkpointInfo_.folder, checkpointId_);
@@ -1503,10 +1557,21 @@ void Simulation::dumpDependencyGraphToGraphML(const std::string& fname, bool cur
         SimulationTasks t;
 
         createTasksDummy(&s, &t);
-        buildDependencies(&s, &t);
+        buildDependencies(&s, &t, state_->deterministicForces);
 
         s.dumpGraphToGraphML(fname);
     }
 }
 
+void Simulation::setTaskProfiling(const std::string& fname, bool useStreamEvents)
+{
+    taskProfilingFileName_ = fname;
+    taskProfilingStreamEvents_ = useStreamEvents;
+}
+
+void Simulation::setExchangeEngine(ExchangeEngineType type)
+{
+    exchangeEngineType_ = type;
+}
+
 } // namespace mirheo
@@ -4,6 +4,7 @@
 #include <mirheo/core/containers.h>
 #include <mirheo/core/datatypes.h>
 #include <mirheo/core/exchangers/interface.h>
+#include <mirheo/core/exchangers/engines/factory.h>
 #include <mirheo/core/mirheo_object.h>
 
 #include <functional>
@@ -27,6 +28,8 @@ class InitialConditions;
 class Bouncer;
 class ObjectBelongingChecker;
 class SimulationPlugin;
+class CheckpointWriter;
+class OffloadCheckpointWriter;
 struct SimulationTasks;
 struct RunData;
 
@@ -177,6 +180,22 @@ public:
     void init(); ///< setup all the simulation tasks from the registered objects and their relation. Must be called after all the register and set methods.
     void run(MirState::StepType nsteps); ///< advance the system for a given number of time steps. Must be called after init()
 
+    /** \brief Prepare the system to be advanced step by step with runStep(); run() split in three parts.
+        \param nsteps The number of steps that will be performed before finishRun(); only used for logging.
+
+        Must be called after init(). This allows to interleave the steps of several simulations, see \c Ensemble.
+     */
+    void startRun(MirState::StepType nsteps);
+    void runStep();   ///< advance the system by one time step. Must be called between startRun() and finishRun()
+
+    /** \brief Advance several simulations by one time step, with the tasks of all of them executed concurrently.
+        \param simulations The simulations to advance; each one must be between startRun() and finishRun().
+
+        Equivalent to calling runStep() on each simulation, see TaskScheduler::run().
+     */
+    static void runStep(const std::vector<Simulation*>& simulations);
+    void finishRun(); ///< finalize the plugins, stop the \c Postprocess and release the run data. Must be called after startRun()
+
     /** \brief Send a tagged message to the \c Postprocess rank.
         This is useful to pass special messages, e.g. termination or checkpoint.
      */
@@ -228,6 +247,22 @@ public:
      */
     void dumpDependencyGraphToGraphML(const std::string& fname, bool current) const;
 
+    /** \brief record the execution time of every task during run().
+        \param fname The base name of the report files (without extension).
+        \param useStreamEvents if \c true, also measure the durations on the streams with CUDA events.
+
+        At the end of each run(), the root rank dumps the timings in csv, json and annotated graphML formats.
+        See TaskScheduler::dumpProfile().
+     */
+    void setTaskProfiling(const std::string& fname, bool useStreamEvents);
+
+    /** \brief Choose the engine used for all the halo exchanges and redistributions.
+        \param type The kind of engine. See createExchangeEngine().
+
+        Must be called before init(), or takes effect at the next init().
+     */
+    void setExchangeEngine(ExchangeEngineType type);
+
 private:
     std::vector<std::string> _getExtraDataToExchange(ObjectVector *ov) const;
     std::vector<std::string> _getDataToSendBack(const std::vector<std::string>& extraOut, ObjectVector *ov) const;
@@ -248,7 +283,7 @@ private:
     using MirObject::checkpoint;
 
     void _restartState(const std::string& folder);
-    void _checkpointState();
+    void _checkpointState(CheckpointWriter& writer);
 
     /**
        \return true if the given ObjectVector interacts with itself through a pairwise interaction.
@@ -323,6 +358,9 @@ private:
     const CheckpointInfo checkpointInfo_;
     const int rank_;
 
+    /// Sends the particle data to the postprocess ranks; nullptr if checkpoints are written directly.
+    std::unique_ptr<OffloadCheckpointWriter> checkpointWriter_;
+
     /// Data constructed in init() and used during the execution of run().
     std::unique_ptr<RunData> run_;
 
@@ -330,6 +368,11 @@ private:
 
     real maxObjHalfLength_;
 
+    std::string taskProfilingFileName_; ///< empty if task profiling is disabled
+    bool taskProfilingStreamEvents_ {false};
+
+    ExchangeEngineType exchangeEngineType_ {ExchangeEngineType::Default};
+
     std::map<std::string, int> pvIdMap_;
     std::vector< std::shared_ptr<ParticleVector> > particleVectors_;
     std::vector< ObjectVector* >   objectVectors_;
@@ -0,0 +1,300 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "task_profiler.h"
+
+#include <mirheo/core/logger.h>
+#include <mirheo/core/utils/file_wrapper.h>
+
+#include <algorithm>
+#include <queue>
+
+namespace mirheo
+{
+
+void TaskProfiler::Stats::add(double x)
+{
+    ++count;
+    sum += x;
+    min = std::min(min, x);
+    max = std::max(max, x);
+}
+
+double TaskProfiler::Stats::mean() const
+{
+    return count > 0 ? sum / static_cast<double>(count) : 0.0;
+}
+
+TaskProfiler::TaskProfiler() = default;
+
+void TaskProfiler::registerTask(TaskID id, const std::string& label)
+{
+    if (id < 0)
+        die("Invalid task id %d", id);
+
+    if (id >= static_cast<TaskID>(tasks_.size()))
+    {
+        tasks_     .resize(id + 1);
+        registered_.resize(id + 1, false);
+    }
+
+    tasks_[id] = TaskStats{};
+    tasks_[id].label = label;
+    registered_[id] = true;
+}
+
+void TaskProfiler::_checkTaskExistsOrDie(TaskID id) const
+{
+    if (id < 0 || id >= static_cast<TaskID>(tasks_.size()) || !registered_[id])
+        die("No such profiled task with id %d", id);
+}
+
+void TaskProfiler::addSample(TaskID id, const Sample& sample)
+{
+    _checkTaskExistsOrDie(id);
+    auto& t = tasks_[id];
+
+    t.launch.add(sample.launch);
+    t.wall  .add(sample.wall);
+
+    if (sample.device >= 0.0)
+        t.device.add(sample.device);
+}
+
+void TaskProfiler::addStep(double ms)
+{
+    steps_.add(ms);
+}
+
+void TaskProfiler::clear()
+{
+    for (auto& t : tasks_)
+    {
+        const std::string label = t.label;
+        t = TaskStats{};
+        t.label = label;
+    }
+    steps_ = Stats{};
+}
+
+const TaskProfiler::TaskStats& TaskProfiler::getStats(TaskID id) const
+{
+    _checkTaskExistsOrDie(id);
+    return tasks_[id];
+}
+
+const TaskProfiler::Stats& TaskProfiler::getStepStats() const
+{
+    return steps_;
+}
+
+bool TaskProfiler::hasDeviceTimings() const
+{
+    for (const auto& t : tasks_)
+        if (t.device.count > 0)
+            return true;
+    return false;
+}
+
+TaskProfiler::Metric TaskProfiler::getDefaultMetric() const
+{
+    return hasDeviceTimings() ? Metric::Device : Metric::Wall;
+}
+
+const TaskProfiler::Stats& TaskProfiler::_getMetricStats(TaskID id, Metric metric) const
+{
+    const auto& t = getStats(id);
+    switch (metric)
+    {
+    case Metric::Launch: return t.launch;
+    case Metric::Wall:   return t.wall;
+    case Metric::Device: return t.device;
+    }
+    return t.wall;
+}
+
+TaskProfiler::Path TaskProfiler::computeCriticalPath(const std::vector<TaskID>& nodes,
+                                                     const std::vector<std::pair<TaskID,TaskID>>& edges,
+                                                     Metric metric) const
+{
+    // Longest path in a DAG: relax the nodes in topological order (Kahn's algorithm)
+
+    const int n = static_cast<int>(nodes.size());
+    std::vector<int> localIds(tasks_.size(), -1);
+
+    for (int i = 0; i < n; ++i)
+    {
+        _checkTaskExistsOrDie(nodes[i]);
+        localIds[nodes[i]] = i;
+    }
+
+    std::vector<std::vector<int>> successors(n);
+    std::vector<int> inDegree(n, 0);
+
+    for (const auto& e : edges)
+    {
+        _checkTaskExistsOrDie(e.first);
+        _checkTaskExistsOrDie(e.second);
+        const int src = localIds[e.first];
+        const int dst = localIds[e.second];
+
+        if (src < 0 || dst < 0)
+            die("Edge %d -> %d refers to a task that is not part of the graph", e.first, e.second);
+
+        successors[src].push_back(dst);
+        ++inDegree[dst];
+    }
+
+    std::vector<double> weight(n), distance(n);
+    std::vector<int> previous(n, -1);
+    std::queue<int> ready;
+
+    for (int i = 0; i < n; ++i)
+    {
+        weight[i] = _getMetricStats(nodes[i], metric).mean();
+        distance[i] = weight[i];
+        if (inDegree[i] == 0)
+            ready.push(i);
+    }
+
+    int nvisited = 0;
+    while (!ready.empty())
+    {
+        const int i = ready.front();
+        ready.pop();
+        ++nvisited;
+
+        for (int j : successors[i])
+        {
+            if (distance[i] + weight[j] > distance[j])
+            {
+                distance[j] = distance[i] + weight[j];
+                previous[j] = i;
+            }
+            if (--inDegree[j] == 0)
+                ready.push(j);
+        }
+    }
+
+    if (nvisited != n)
+        die("Can not compute the critical path: the task graph contains cycles");
+
+    Path path;
+    if (n == 0)
+        return path;
+
+    int last = static_cast<int>(std::max_element(distance.begin(), distance.end()) - distance.begin());
+    path.length = distance[last];
+
+    for (int i = last; i >= 0; i = previous[i])
+        path.ids.push_back(nodes[i]);
+
+    std::reverse(path.ids.begin(), path.ids.end());
+    return path;
+}
+
+static const char* metricToStr(TaskProfiler::Metric metric)
+{
+    switch (metric)
+    {
+    case TaskProfiler::Metric::Launch: return "launch";
+    case TaskProfiler::Metric::Wall:   return "wall";
+    case TaskProfiler::Metric::Device: return "device";
+    }
+    return "unknown";
+}
+
+static std::string escapeJSON(const std::string& s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static void writeStatsJSON(FILE *f, const char *name, const TaskProfiler::Stats& s)
+{
+    if (s.count > 0)
+        fprintf(f, "\"%s\": {\"count\": %lld, \"min_ms\": %g, \"mean_ms\": %g, \"max_ms\": %g}",
+                name, s.count, s.min, s.mean(), s.max);
+    else
+        fprintf(f, "\"%s\": {\"count\": 0}", name);
+}
+
+void TaskProfiler::dumpCSV(const std::string& fname) const
+{
+    FileWrapper file;
+    if (file.open(fname, "w") != FileWrapper::Status::Success)
+        die("Could not open file '%s'", fname.c_str());
+    auto f = file.get();
+
+    fprintf(f, "id,label,count,"
+            "launch_min_ms,launch_mean_ms,launch_max_ms,"
+            "wall_min_ms,wall_mean_ms,wall_max_ms,"
+            "device_count,device_min_ms,device_mean_ms,device_max_ms\n");
+
+    auto writeStats = [f](const Stats& s)
+    {
+        if (s.count > 0) fprintf(f, ",%g,%g,%g", s.min, s.mean(), s.max);
+        else             fprintf(f, ",,,");
+    };
+
+    for (TaskID id = 0; id < static_cast<TaskID>(tasks_.size()); ++id)
+    {
+        if (!registered_[id])
+            continue;
+
+        const auto& t = tasks_[id];
+        fprintf(f, "%d,\"%s\",%lld", id, t.label.c_str(), t.wall.count);
+        writeStats(t.launch);
+        writeStats(t.wall);
+        fprintf(f, ",%lld", t.device.count);
+        writeStats(t.device);
+        fprintf(f, "\n");
+    }
+}
+
+void TaskProfiler::dumpJSON(const std::string& fname, const std::vector<TaskID>& nodes,
+                            const std::vector<std::pair<TaskID,TaskID>>& edges) const
+{
+    FileWrapper file;
+    if (file.open(fname, "w") != FileWrapper::Status::Success)
+        die("Could not open file '%s'", fname.c_str());
+    auto f = file.get();
+
+    fprintf(f, "{\n  ");
+    writeStatsJSON(f, "steps", steps_);
+    fprintf(f, ",\n  \"tasks\": [");
+
+    bool first = true;
+    for (TaskID id : nodes)
+    {
+        const auto& t = getStats(id);
+        fprintf(f, "%s\n    {\"id\": %d, \"label\": \"%s\", ",
+                first ? "" : ",", id, escapeJSON(t.label).c_str());
+        writeStatsJSON(f, "launch", t.launch); fprintf(f, ", ");
+        writeStatsJSON(f, "wall",   t.wall);   fprintf(f, ", ");
+        writeStatsJSON(f, "device", t.device); fprintf(f, "}");
+        first = false;
+    }
+    fprintf(f, "\n  ],\n");
+
+    const Metric metric = getDefaultMetric();
+    const Path path = computeCriticalPath(nodes, edges, metric);
+
+    fprintf(f, "  \"critical_path\": {\"metric\": \"%s\", \"length_ms\": %g, \"tasks\": [",
+            metricToStr(metric), path.length);
+
+    first = true;
+    for (TaskID id : path.ids)
+    {
+        fprintf(f, "%s\"%s\"", first ? "" : ", ", escapeJSON(tasks_[id].label).c_str());
+        first = false;
+    }
+    fprintf(f, "]}\n}\n");
+}
+
+} // namespace mirheo
@@ -0,0 +1,140 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mirheo
+{
+
+/** \brief Collect execution timings of the tasks of a TaskScheduler.
+
+    The profiler is independent of CUDA: it only receives durations measured
+    by the scheduler (or by any other source, e.g. a host-only test) and
+    aggregates them per task.
+    It can then report per-task statistics and the critical path through the
+    task dependency graph, weighted by the measured mean durations.
+ */
+class TaskProfiler
+{
+public:
+    /// Represents the unique id of a task; same as TaskScheduler::TaskID
+    using TaskID = int;
+
+    /// The different durations recorded for every task execution
+    enum class Metric
+    {
+        Launch, ///< host time spent inside the task functions
+        Wall,   ///< host time between the start of the task and the detection of its completion
+        Device  ///< time measured on the stream between the start and the end of the task
+    };
+
+    /// One measurement of a task execution. Times are in milliseconds.
+    struct Sample
+    {
+        double launch; ///< \see Metric::Launch
+        double wall;   ///< \see Metric::Wall
+        double device; ///< \see Metric::Device; negative if not available
+    };
+
+    /// Running statistics of a quantity
+    struct Stats
+    {
+        void add(double x); ///< add a new sample
+        double mean() const; ///< \return the mean of the samples, 0 if there are none
+
+        long long count {0}; ///< number of samples
+        double sum {0.0};    ///< sum of the samples
+        double min {std::numeric_limits<double>::max()};    ///< minimum sample
+        double max {std::numeric_limits<double>::lowest()}; ///< maximum sample
+    };
+
+    /// The statistics of all the durations of a given task
+    struct TaskStats
+    {
+        std::string label; ///< name of the task
+        Stats launch;      ///< \see Metric::Launch
+        Stats wall;        ///< \see Metric::Wall
+        Stats device;      ///< \see Metric::Device
+    };
+
+    /// A path through the task graph
+    struct Path
+    {
+        std::vector<TaskID> ids; ///< the tasks of the path, in order of execution
+        double length {0.0};     ///< the sum of the mean durations of the tasks on the path
+    };
+
+    /// Construct an empty profiler
+    TaskProfiler();
+
+    /** \brief Register a task to profile.
+        \param [in] id The task id, must be non negative.
+        \param [in] label The name of the task, used in the reports.
+     */
+    void registerTask(TaskID id, const std::string& label);
+
+    /** \brief Add a measurement of one execution of a task.
+        \param [in] id The task id. Must have been registered.
+        \param [in] sample The measured durations.
+     */
+    void addSample(TaskID id, const Sample& sample);
+
+    /** \brief Add a measurement of the total time of one execution of the whole graph.
+        \param [in] ms Duration in milliseconds.
+     */
+    void addStep(double ms);
+
+    /// Remove all recorded samples but keep the registered tasks.
+    void clear();
+
+    /// \return the statistics of the given task
+    const TaskStats& getStats(TaskID id) const;
+
+    /// \return the statistics of the whole graph executions
+    const Stats& getStepStats() const;
+
+    /// \return \c true if at least one sample contains a device timing
+    bool hasDeviceTimings() const;
+
+    /** \brief Compute the longest path through a directed acyclic graph, weighted by the mean durations.
+        \param [in] nodes The tasks of the graph.
+        \param [in] edges The dependencies (source, target): source must be executed before target.
+        \param [in] metric The duration used to weight the nodes.
+        \return The critical path.
+
+        This method will die if the graph contains cycles.
+     */
+    Path computeCriticalPath(const std::vector<TaskID>& nodes,
+                             const std::vector<std::pair<TaskID,TaskID>>& edges,
+                             Metric metric) const;
+
+    /** \brief Dump the statistics of all tasks in csv format (one line per task).
+        \param [in] fname The file name, with extension.
+     */
+    void dumpCSV(const std::string& fname) const;
+
+    /** \brief Dump the statistics of all tasks and the critical path in json format.
+        \param [in] fname The file name, with extension.
+        \param [in] nodes The tasks of the graph (see computeCriticalPath()).
+        \param [in] edges The dependencies of the graph (see computeCriticalPath()).
+     */
+    void dumpJSON(const std::string& fname, const std::vector<TaskID>& nodes,
+                  const std::vector<std::pair<TaskID,TaskID>>& edges) const;
+
+    /// \return The metric used to weight the critical path: Device if available, Wall otherwise.
+    Metric getDefaultMetric() const;
+
+private:
+    void _checkTaskExistsOrDie(TaskID id) const;
+    const Stats& _getMetricStats(TaskID id, Metric metric) const;
+
+private:
+    std::vector<TaskStats> tasks_;
+    std::vector<bool> registered_;
+    Stats steps_;
+};
+
+} // namespace mirheo
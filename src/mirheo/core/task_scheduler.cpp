@@ -6,6 +6,7 @@
 #include <extern/pugixml/src/pugixml.hpp>
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <memory>
 #include <queue>
@@ -15,24 +16,27 @@
 namespace mirheo
 {
 
-TaskScheduler::TaskScheduler()
+/// \return the current host time in ms, measured from an arbitrary origin
+static double getHostTimeMs()
 {
-    CUDA_Check( cudaDeviceGetStreamPriorityRange(&cudaPriorityLow_, &cudaPriorityHigh_) );
+    using Clock = std::chrono::steady_clock;
+    return std::chrono::duration<double, std::milli>(Clock::now().time_since_epoch()).count();
 }
 
+TaskScheduler::TaskScheduler(std::unique_ptr<ExecutionBackend> backend) :
+    backend_(std::move(backend))
+{}
+
 TaskScheduler::~TaskScheduler()
 {
-    auto destroyStreams = [](std::queue<cudaStream_t>& streams)
-    {
-        while (!streams.empty())
-        {
-            CUDA_Check( cudaStreamDestroy(streams.front()) );
-            streams.pop();
-        }
-    };
+    _destroyProfilingEvents();
+}
 
-    destroyStreams(streamsLo_);
-    destroyStreams(streamsHi_);
+void TaskScheduler::setExecutionBackend(std::unique_ptr<ExecutionBackend> backend)
+{
+    if (!backend)
+        die("Execution backend must not be null");
+    backend_ = std::move(backend);
 }
 
 TaskScheduler::TaskID TaskScheduler::createTask(const std::string& label)
@@ -44,7 +48,7 @@ TaskScheduler::TaskID TaskScheduler::createTask(const std::string& label)
     id = static_cast<int>(tasks_.size());
     label2taskId_[label] = id;
 
-    Task task(label, id, cudaPriorityLow_);
+    Task task(label, id, false);
     tasks_.push_back(task);
 
     return id;
@@ -112,7 +116,7 @@ void TaskScheduler::addDependency(TaskID id, std::vector<TaskID> before, std::ve
 void TaskScheduler::setHighPriority(TaskID id)
 {
     _checkTaskExistsOrDie(id);
-    tasks_[id].priority = cudaPriorityHigh_;
+    tasks_[id].highPriority = true;
 }
 
 void TaskScheduler::forceExec(TaskID id, cudaStream_t stream)
@@ -131,20 +135,12 @@ void TaskScheduler::_createNodes()
 
     for (auto& t : tasks_)
     {
-        auto node = std::make_unique<Node>(t.id, t.priority);
+        auto node = std::make_unique<Node>(t.id, t.highPriority);
         nodes_.push_back(std::move(node));
     }
 
     for (auto& n : nodes_)
     {
-        // Set streams member according to priority
-        if      (n->priority == cudaPriorityLow_)
-            n->streams = &streamsLo_;
-        else if (n->priority == cudaPriorityHigh_)
-            n->streams = &streamsHi_;
-        else
-            n->streams = &streamsLo_;
-
         // Set dependencies
         for (auto dep : tasks_[n->id].before)
         {
@@ -258,117 +254,247 @@ void TaskScheduler::_logDepsGraph()
 
 void TaskScheduler::compile()
 {
+    _destroyProfilingEvents();
     _createNodes();
     _removeEmptyNodes();
     _logDepsGraph();
-}
 
+    for (size_t i = 0; i < nodes_.size(); ++i)
+        nodes_[i]->index = static_cast<int>(i);
 
+    for (const auto& t : tasks_)
+        profiler_.registerTask(t.id, t.label);
+}
 
-void TaskScheduler::run()
+void TaskScheduler::enableProfiling(bool useStreamEvents)
 {
-    // Kahn's algorithm
-    // https://en.wikipedia.org/wiki/Topological_sorting
+    profiling_ = true;
+    profileStreamEvents_ = useStreamEvents;
+}
 
-    auto compareNodes = [] (Node *a, Node *b) {
-        // lower number means higher priority
-        return a->priority < b->priority;
-    };
-    std::priority_queue<Node*, std::vector<Node*>, decltype(compareNodes)> S(compareNodes);
-    std::vector<std::pair<cudaStream_t, Node*>> workMap;
+const TaskProfiler& TaskScheduler::getProfiler() const
+{
+    return profiler_;
+}
 
+void TaskScheduler::_destroyProfilingEvents()
+{
     for (auto& n : nodes_)
     {
-        n->from = n->from_backup;
+        if (n->evStart) CUDA_Check( cudaEventDestroy(n->evStart) );
+        if (n->evEnd)   CUDA_Check( cudaEventDestroy(n->evEnd  ) );
+        n->evStart = n->evEnd = nullptr;
+    }
+}
 
-        if (n->from.empty())
-            S.push(n.get());
+void TaskScheduler::_collectProfilingSamples()
+{
+    for (auto& n : nodes_)
+    {
+        if (!n->executed)
+            continue;
+
+        if (profileStreamEvents_)
+        {
+            float ms {0.0f};
+            CUDA_Check( cudaEventElapsedTime(&ms, n->evStart, n->evEnd) );
+            n->sample.device = static_cast<double>(ms);
+        }
+
+        profiler_.addSample(n->id, n->sample);
+        n->executed = false;
     }
+}
 
-    int completed = 0;
-    const int total = static_cast<int>(nodes_.size());
+std::vector<TaskScheduler::TaskID> TaskScheduler::_getGraphNodes() const
+{
+    std::vector<TaskID> ids;
+    for (const auto& n : nodes_)
+        ids.push_back(n->id);
+    return ids;
+}
 
-    while (true)
+std::vector<std::pair<TaskScheduler::TaskID, TaskScheduler::TaskID>> TaskScheduler::_getGraphEdges() const
+{
+    std::vector<std::pair<TaskID,TaskID>> edges;
+    for (const auto& n : nodes_)
     {
-        // Check the status of all running kernels
-        while (completed < total && S.empty())
+        for (auto dep : n->to)
+            edges.push_back({n->id, dep->id});
+
+        for (auto dep : n->from_backup)
+            edges.push_back({dep->id, n->id});
+    }
+
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    return edges;
+}
+
+
+
+void TaskScheduler::_execNode(Node *node, cudaStream_t stream)
+{
+    auto& task = tasks_[node->id];
+    NvtxCreateRange(range, task.label.c_str());
+
+    if (profiling_)
+    {
+        node->executed = false;
+        for (auto& func_every : task.funcs)
+            if (nExecutions_ % func_every.second == 0)
+                node->executed = true;
+
+        node->tStart = getHostTimeMs();
+        if (node->executed && profileStreamEvents_)
+            CUDA_Check( cudaEventRecord(node->evStart, stream) );
+    }
+
+    for (auto& func_every : task.funcs)
+        if (nExecutions_ % func_every.second == 0)
+            func_every.first(stream);
+
+    if (node->executed)
+    {
+        node->tLaunched = getHostTimeMs();
+        node->sample = {node->tLaunched - node->tStart, 0.0, -1.0};
+
+        if (profileStreamEvents_)
+            CUDA_Check( cudaEventRecord(node->evEnd, stream) );
+    }
+}
+
+void TaskScheduler::run()
+{
+    run({this});
+}
+
+void TaskScheduler::run(const std::vector<TaskScheduler*>& schedulers)
+{
+    for (auto sched : schedulers)
+        sched->_startRun();
+
+    auto isDone = [](const TaskScheduler *sched)
+    {
+        return sched->numCompleted_ == static_cast<int>(sched->nodes_.size());
+    };
+
+    std::vector<ExecutionBackend::JobID> completedJobs;
+
+    while (!std::all_of(schedulers.begin(), schedulers.end(), isDone))
+    {
+        // Launch everything that is ready
+        for (auto sched : schedulers)
+            sched->_launchReady();
+
+        // Wait for some of the running tasks and release their dependencies.
+        // With several schedulers, poll all of them so that none waits for the others
+        bool progress = false;
+        while (!progress)
         {
-            for (auto streamNode_it = workMap.begin(); streamNode_it != workMap.end(); )
+            for (auto sched : schedulers)
             {
-                auto result = cudaStreamQuery(streamNode_it->first);
-                if ( result == cudaSuccess )
-                {
-                    auto node = streamNode_it->second;
-
-                    debug("Completed group %s ", tasks_[node->id].label.c_str());
-
-                    // Return freed stream back to the corresponding queue
-                    node->streams->push(streamNode_it->first);
-
-                    // Remove resolved dependencies
-                    for (auto dep : node->to)
-                    {
-                        if (!dep->from.empty())
-                        {
-                            dep->from.remove(node);
-                            if (dep->from.empty())
-                                S.push(dep);
-                        }
-                    }
-
-                    // Remove task from the list of currently in progress
-                    completed++;
-                    streamNode_it = workMap.erase(streamNode_it);
-                }
-                else if (result == cudaErrorNotReady)
-                {
-                    streamNode_it++;
-                }
+                if (isDone(sched))
+                    continue;
+
+                completedJobs.clear();
+                if (schedulers.size() == 1)
+                    sched->backend_->waitCompleted(completedJobs);
                 else
+                    sched->backend_->pollCompleted(completedJobs);
+
+                if (!completedJobs.empty())
                 {
-                    error("Group '%s' raised an error",  tasks_[streamNode_it->second->id].label.c_str());
-                    CUDA_Check( result );
+                    progress = true;
+                    sched->_releaseCompleted(completedJobs);
                 }
             }
         }
+    }
+
+    for (auto sched : schedulers)
+        sched->_finishRun();
+}
 
-        if (completed == total)
-            break;
+void TaskScheduler::_startRun()
+{
+    // Kahn's algorithm
+    // https://en.wikipedia.org/wiki/Topological_sorting
 
-        Node* node = S.top();
-        S.pop();
+    if (!backend_)
+        backend_ = std::make_unique<CudaStreamBackend>();
 
-        cudaStream_t stream;
-        if (node->streams->empty())
-        {
-            CUDA_Check( cudaStreamCreateWithPriority(&stream, cudaStreamNonBlocking, node->priority) );
-        }
-        else
+    ready_ = {};
+
+    for (auto& n : nodes_)
+    {
+        n->from = n->from_backup;
+
+        if (n->from.empty())
+            ready_.push(n.get());
+
+        if (profileStreamEvents_ && n->evStart == nullptr)
         {
-            stream = node->streams->front();
-            node->streams->pop();
+            CUDA_Check( cudaEventCreate(&n->evStart) );
+            CUDA_Check( cudaEventCreate(&n->evEnd) );
         }
+    }
 
-        debug("Executing group %s on stream %lld with priority %d",
-              tasks_[node->id].label.c_str(), (long long)stream, node->priority);
-        workMap.push_back({stream, node});
+    tRunStart_ = profiling_ ? getHostTimeMs() : 0.0;
+    numCompleted_ = 0;
+}
 
-        {
-            auto& task = tasks_[node->id];
-            NvtxCreateRange(range, task.label.c_str());
+void TaskScheduler::_launchReady()
+{
+    while (!ready_.empty())
+    {
+        Node* node = ready_.top();
+        ready_.pop();
 
-            for (auto& func_every : task.funcs)
-                if (nExecutions_ % func_every.second == 0)
-                    func_every.first(stream);
+        const auto jobId = static_cast<ExecutionBackend::JobID>(node->index);
+        backend_->launch(jobId, tasks_[node->id].label, node->highPriority,
+                         [this, node](cudaStream_t stream) {_execNode(node, stream);});
+    }
+}
+
+void TaskScheduler::_releaseCompleted(const std::vector<ExecutionBackend::JobID>& completedJobs)
+{
+    for (auto jobId : completedJobs)
+    {
+        Node *node = nodes_[jobId].get();
+
+        if (node->executed)
+            node->sample.wall = getHostTimeMs() - node->tStart;
+
+        // Remove resolved dependencies
+        for (auto dep : node->to)
+        {
+            if (!dep->from.empty())
+            {
+                dep->from.remove(node);
+                if (dep->from.empty())
+                    ready_.push(dep);
+            }
         }
+
+        numCompleted_++;
     }
+}
 
+void TaskScheduler::_finishRun()
+{
     nExecutions_++;
-    CUDA_Check( cudaDeviceSynchronize() );
+    backend_->synchronize();
+
+    if (profiling_)
+    {
+        _collectProfilingSamples();
+        profiler_.addStep(getHostTimeMs() - tRunStart_);
+    }
 }
 
 
-static void add_node(pugi::xml_node& graph, int id, std::string label)
+static pugi::xml_node add_node(pugi::xml_node& graph, int id, std::string label)
 {
     auto node = graph.append_child("node");
     node.append_attribute("id") = std::to_string(id).c_str();
@@ -376,18 +502,36 @@ static void add_node(pugi::xml_node& graph, int id, std::string label)
     auto data = node.append_child("data");
     data.append_attribute("key") = "label";
     data.text()                  = label.c_str();
+    return node;
 }
 
-static void add_edge(pugi::xml_node& graph, int sourceId, int targetId)
+static pugi::xml_node add_edge(pugi::xml_node& graph, int sourceId, int targetId)
 {
     auto edge = graph.append_child("edge");
     edge.append_attribute("source") = std::to_string(sourceId).c_str();
     edge.append_attribute("target") = std::to_string(targetId).c_str();
+    return edge;
 }
 
-void TaskScheduler::dumpGraphToGraphML(const std::string& fname) const
+static void add_key(pugi::xml_node& root, const char *id, const char *domain, const char *type)
+{
+    auto key = root.append_child("key");
+    key.append_attribute("id")        = id;
+    key.append_attribute("for")       = domain;
+    key.append_attribute("attr.name") = id;
+    key.append_attribute("attr.type") = type;
+}
+
+template <typename T>
+static void add_data(pugi::xml_node& node, const char *key, T value)
+{
+    auto data = node.append_child("data");
+    data.append_attribute("key") = key;
+    data.text()                  = value;
+}
+
+static pugi::xml_node init_graphml(pugi::xml_document& doc)
 {
-    pugi::xml_document doc;
     auto root = doc.append_child("graphml");
 
     root.append_attribute("xmlns")              = "http://graphml.graphdrawing.org/xmlns";
@@ -395,11 +539,14 @@ void TaskScheduler::dumpGraphToGraphML(const std::string& fname) const
     root.append_attribute("xsi:schemaLocation") = "http://graphml.graphdrawing.org/xmlns "
                                                   "http://graphml.graphdrawing.org/xmlns/1.0/graphml.xsd";
 
-    auto key = root.append_child("key");
-    key.append_attribute("id")        = "label";
-    key.append_attribute("for")       = "node";
-    key.append_attribute("attr.name") = "label";
-    key.append_attribute("attr.type") = "string";
+    add_key(root, "label", "node", "string");
+    return root;
+}
+
+void TaskScheduler::dumpGraphToGraphML(const std::string& fname) const
+{
+    pugi::xml_document doc;
+    auto root = init_graphml(doc);
 
     auto graph = root.append_child("graph");
     graph.append_attribute("id")          = "Task graph";
@@ -423,15 +570,71 @@ void TaskScheduler::dumpGraphToGraphML(const std::string& fname) const
     doc.save_file(filename.c_str());
 }
 
-TaskScheduler::Task::Task(const std::string& label_, TaskID id_, int priority_) :
+void TaskScheduler::dumpProfile(const std::string& fname) const
+{
+    const auto nodes = _getGraphNodes();
+    const auto edges = _getGraphEdges();
+
+    profiler_.dumpCSV (fname + ".csv");
+    profiler_.dumpJSON(fname + ".json", nodes, edges);
+
+    const auto metric = profiler_.getDefaultMetric();
+    const auto path = profiler_.computeCriticalPath(nodes, edges, metric);
+
+    auto onPath = [&path](TaskID id)
+    {
+        return std::find(path.ids.begin(), path.ids.end(), id) != path.ids.end();
+    };
+
+    pugi::xml_document doc;
+    auto root = init_graphml(doc);
+
+    add_key(root, "count",     "node", "long");
+    add_key(root, "launch_ms", "node", "double");
+    add_key(root, "wall_ms",   "node", "double");
+    add_key(root, "device_ms", "node", "double");
+    add_key(root, "critical",  "all",  "boolean");
+
+    auto graph = root.append_child("graph");
+    graph.append_attribute("id")          = "Task graph";
+    graph.append_attribute("edgedefault") = "directed";
+
+    for (auto id : nodes)
+    {
+        const auto& stats = profiler_.getStats(id);
+        auto node = add_node(graph, id, tasks_[id].label);
+        add_data(node, "count",     stats.wall.count);
+        add_data(node, "launch_ms", stats.launch.mean());
+        add_data(node, "wall_ms",   stats.wall.mean());
+        if (stats.device.count > 0)
+            add_data(node, "device_ms", stats.device.mean());
+        add_data(node, "critical",  onPath(id));
+    }
+
+    for (size_t i = 0; i < path.ids.size(); ++i)
+        debug("Critical path [%zu]: %s", i, tasks_[path.ids[i]].label.c_str());
+
+    for (const auto& e : edges)
+    {
+        auto edge = add_edge(graph, e.first, e.second);
+        const auto it = std::find(path.ids.begin(), path.ids.end(), e.first);
+        const bool critical = it != path.ids.end() && (it+1) != path.ids.end() && *(it+1) == e.second;
+        add_data(edge, "critical", critical);
+    }
+
+    auto filename = fname + ".graphml";
+    doc.save_file(filename.c_str());
+}
+
+TaskScheduler::Task::Task(const std::string& label_, TaskID id_, bool highPriority_) :
     label(label_),
     id(id_),
-    priority(priority_)
+    highPriority(highPriority_)
 {}
 
-TaskScheduler::Node::Node(TaskID id_, int priority_) :
+TaskScheduler::Node::Node(TaskID id_, bool highPriority_) :
     id(id_),
-    priority(priority_)
+    highPriority(highPriority_)
 {}
 
 } // namespace mirheo
@@ -1,4 +1,7 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
+#include <mirheo/core/execution_backend.h>
+#include <mirheo/core/task_profiler.h>
+
 #include <functional>
 #include <list>
 #include <memory>
@@ -17,6 +20,11 @@ namespace mirheo
     Manages task dependencies and run them concurrently on different CUDA streams.
     This is designed to be run in a time stepping scheme, e.g. all the tasks of a
     single time step must be described here before calling the run() method repetitively.
+
+    The execution resource is abstracted by an ExecutionBackend: by default, the tasks are
+    launched from the calling thread on concurrent CUDA streams (CudaStreamBackend).
+    The same compiled graph can also be executed on a pool of host threads (ThreadPoolBackend);
+    this is only meant for host-only graphs, the simulation always uses the CudaStreamBackend.
  */
 class TaskScheduler
 {
@@ -29,8 +37,11 @@ public:
     /// Special task id value to represent invalid tasks
     static constexpr TaskID invalidTaskId {static_cast<TaskID>(-1)};
 
-    /// Default constructor
-    TaskScheduler();
+    /** \brief Construct a TaskScheduler
+        \param [in] backend The execution resource used by run(). If \c nullptr, a CudaStreamBackend
+                   is created at the first call to run().
+     */
+    TaskScheduler(std::unique_ptr<ExecutionBackend> backend = nullptr);
     ~TaskScheduler();
 
     /** \brief Create and register an empty task named \p label
@@ -78,6 +89,11 @@ public:
      */
     void setHighPriority(TaskID id);
 
+    /** \brief Set the execution resource used by run().
+        \param [in] backend The new backend. Must not be \c nullptr.
+     */
+    void setExecutionBackend(std::unique_ptr<ExecutionBackend> backend);
+
     /** \brief Prepare the internal state so that the scheduler can perform execution of all tasks.
         No other calls related to task creation / modification / dependencies must be performed after
         calling this function.
@@ -89,11 +105,43 @@ public:
      */
     void run();
 
+    /** \brief Execute the tasks of several schedulers together, as one run() of each of them.
+        \param [in] schedulers The compiled schedulers to run. Must not share their ExecutionBackend.
+
+        The tasks of every scheduler are launched on its own backend as soon as their dependencies are resolved,
+        so that the tasks of independent task graphs (e.g. the replicas of an \c Ensemble) run concurrently.
+        A task that blocks the calling thread (e.g. waiting for a MPI message) also delays the other schedulers.
+     */
+    static void run(const std::vector<TaskScheduler*>& schedulers);
+
     /** Dump a representation of the tasks and their dependencies in graphML format.
         \param [in] fname The file name to dump the graph to (without extension).
      */
     void dumpGraphToGraphML(const std::string& fname) const;
 
+    /** \brief Record the duration of every task executed in run().
+        \param [in] useStreamEvents If \c true, also record the duration of the tasks on their streams with CUDA events.
+
+        Host timings are always recorded: the launch time (time spent in the task functions)
+        and the wall time (time between the launch and the detection of the task completion).
+        Tasks for which no function is executed in a given run() call are not recorded.
+     */
+    void enableProfiling(bool useStreamEvents);
+
+    /// \return the profiler that holds the timings recorded so far.
+    const TaskProfiler& getProfiler() const;
+
+    /** \brief Dump the recorded timings.
+        \param [in] fname The base file name (without extension).
+
+        Creates three files:
+        - <fname>.csv: per task min/mean/max timings
+        - <fname>.json: same as the csv, with the critical path of the task graph
+        - <fname>.graphml: the task graph (see dumpGraphToGraphML()) annotated with the mean timings and the critical path
+        Must be called after compile().
+     */
+    void dumpProfile(const std::string& fname) const;
+
     /** Execute a given task on a given stream
         \param [in] id the task to execute
         \param [in] stream The stream to execute the task
@@ -104,11 +152,11 @@ private:
 
     struct Task
     {
-        Task(const std::string& label, TaskID id, int priority);
+        Task(const std::string& label, TaskID id, bool highPriority);
 
         std::string label;
         TaskID id;
-        int priority;
+        bool highPriority;
 
         std::vector< std::pair<Function, int> > funcs;
         std::vector<TaskID> before, after;
@@ -117,27 +165,45 @@ private:
     struct Node;
     struct Node
     {
-        Node(TaskID id, int priority);
+        Node(TaskID id, bool highPriority);
         TaskID id;
+        int index; ///< position in nodes_; used as job id by the backend
 
         std::list<Node*> to, from, from_backup;
 
-        int priority;
-        std::queue<cudaStream_t>* streams;
+        bool highPriority;
+
+        // profiling data of the current run
+        bool executed {false};
+        double tStart, tLaunched;
+        TaskProfiler::Sample sample;
+        cudaEvent_t evStart {nullptr}, evEnd {nullptr};
     };
 
     std::vector<Task> tasks_;
     std::vector< std::unique_ptr<Node> > nodes_;
 
-    // Ordered sets of parallel work
-    std::queue<cudaStream_t> streamsLo_, streamsHi_;
+    /// high priority nodes are on top of the queue
+    struct LowerPriority
+    {
+        bool operator()(const Node *a, const Node *b) const {return a->highPriority < b->highPriority;}
+    };
+
+    std::unique_ptr<ExecutionBackend> backend_;
 
-    int cudaPriorityLow_, cudaPriorityHigh_;
+    // state of the current run
+    std::priority_queue<Node*, std::vector<Node*>, LowerPriority> ready_; ///< nodes whose dependencies are resolved
+    int numCompleted_ {0};
+    double tRunStart_ {0.0};
 
     int nExecutions_{0};
 
     std::unordered_map<std::string, TaskID> label2taskId_;
 
+    bool profiling_ {false};
+    bool profileStreamEvents_ {false};
+    TaskProfiler profiler_;
+
     void _checkTaskExistsOrDie(TaskID id) const;
     Node* _getNode     (TaskID id);
     Node* _getNodeOrDie(TaskID id);
@@ -146,6 +212,17 @@ private:
     void _removeEmptyNodes();
     void _logDepsGraph();
 
+    void _startRun();
+    void _launchReady();
+    void _releaseCompleted(const std::vector<ExecutionBackend::JobID>& completedJobs);
+    void _finishRun();
+
+    void _execNode(Node *node, cudaStream_t stream);
+    void _destroyProfilingEvents();
+    void _collectProfilingSamples();
+    std::vector<TaskID> _getGraphNodes() const;
+    std::vector<std::pair<TaskID,TaskID>> _getGraphEdges() const;
+
 };
 
 } // namespace mirheo
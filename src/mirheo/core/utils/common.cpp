@@ -85,10 +85,11 @@ const std::string torque     = "torques";
 } // namespace channel_names
 
 CheckpointInfo::CheckpointInfo(int every_, const std::string& folder_,
-                               CheckpointIdAdvanceMode mode_) :
+                               CheckpointIdAdvanceMode mode_, bool asynchronous_) :
     every(every_),
     folder(folder_),
-    mode(mode_)
+    mode(mode_),
+    asynchronous(asynchronous_)
 {}
 
 bool CheckpointInfo::needDump() const
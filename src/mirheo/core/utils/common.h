@@ -94,7 +94,8 @@ struct CheckpointInfo
 {
     /// Constructor
     CheckpointInfo(int every = 0, const std::string& folder = "restart/",
-                   CheckpointIdAdvanceMode mode = CheckpointIdAdvanceMode::PingPong);
+                   CheckpointIdAdvanceMode mode = CheckpointIdAdvanceMode::PingPong,
+                   bool asynchronous = false);
 
     /// \return \c true if there will be at least one dump
     bool needDump() const;
@@ -102,6 +103,7 @@ struct CheckpointInfo
     int every; ///< The checkpoint data will be dumped every this many time steps
     std::string folder; ///< target directory (for checkpoints)
     CheckpointIdAdvanceMode mode; ///< The mehod to increment the checkpoint index
+    bool asynchronous; ///< If \c true, the particle data is written by the postprocess ranks while the simulation goes on
 };
 
 
@@ -109,5 +111,7 @@ constexpr int stoppingTag = 424242; ///< tag to notify the postprocess ranks to
 constexpr int stoppingMsg = -1;     ///< stopping value
 
 constexpr int checkpointTag = 434343; ///< tag to notify the postprocess ranks to perform checkpoint
+constexpr int checkpointDataTag  = 444444; ///< tag to send the header of offloaded checkpoint data to the postprocess ranks
+constexpr int checkpointChunkTag = 454545; ///< tag to send the offloaded checkpoint data to the postprocess ranks
 
 } // namespace mirheo
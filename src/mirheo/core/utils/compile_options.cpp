@@ -17,6 +17,16 @@ const CompileOptions compile_options{
 #else
     false,
 #endif
+#ifdef MIRHEO_PAIRWISE_ACCUMULATION_DOUBLE
+    true,
+#else
+    false,
+#endif
+#ifdef MIRHEO_PAIRWISE_ACCUMULATION_KAHAN
+    true,
+#else
+    false,
+#endif
 #ifdef MIRHEO_USE_NVTX
     true,
 #else
@@ -19,6 +19,8 @@ struct CompileOptions
     // order, don't forget to update the .cpp file!
     bool membraneDouble; ///< \c true if the membrane forces are computed in double precision
     bool rodDouble;      ///< \c true if the rod forces are computed in double precision
+    bool pairwiseDoubleAccumulation; ///< \c true if the pairwise forces of each particle are summed in double precision
+    bool pairwiseKahanAccumulation;  ///< \c true if the pairwise forces of each particle are summed with Kahan summation
     bool useNvtx;        ///< \c true if NVTX information are enabled (for profiling)
 };
 
@@ -30,6 +32,8 @@ extern const CompileOptions compile_options;
     OP(useNvtx)                                 \
     OP(useDouble)                               \
     OP(membraneDouble)                          \
-    OP(rodDouble)
+    OP(rodDouble)                               \
+    OP(pairwiseDoubleAccumulation)              \
+    OP(pairwiseKahanAccumulation)
 
 } // namespace mirheo
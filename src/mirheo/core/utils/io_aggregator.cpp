@@ -0,0 +1,133 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "io_aggregator.h"
+
+#include <mirheo/core/logger.h>
+
+#include <cstdlib>
+#include <limits>
+
+namespace mirheo
+{
+
+static int getRanksPerWriterFromEnvironment()
+{
+    const char *var = std::getenv("MIRHEO_IO_RANKS_PER_WRITER");
+    if (var != nullptr && var[0] != '\0')
+    {
+        if (strcmp(var, "node") == 0)
+            return IOAggregator::onePerNode;
+
+        int n;
+        if (1 == sscanf(var, "%d", &n) && n > 0)
+            return n;
+
+        warn("MIRHEO_IO_RANKS_PER_WRITER should be a positive integer or \"node\", got \"%s\". Ignoring.", var);
+    }
+    return 1;
+}
+
+static int getNumRanksPerNode(MPI_Comm comm)
+{
+    MPI_Comm nodeComm;
+    MPI_Check( MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &nodeComm) );
+
+    int nodeSize;
+    MPI_Check( MPI_Comm_size(nodeComm, &nodeSize) );
+    MPI_Check( MPI_Comm_free(&nodeComm) );
+
+    // all ranks must agree on the group size
+    MPI_Check( MPI_Allreduce(MPI_IN_PLACE, &nodeSize, 1, MPI_INT, MPI_MAX, comm) );
+    return nodeSize;
+}
+
+IOAggregator::IOAggregator(MPI_Comm comm, int ranksPerWriter) :
+    writerComm_(comm)
+{
+    if (ranksPerWriter < 0)
+        die("Invalid number of ranks per writer: %d", ranksPerWriter);
+
+    if (ranksPerWriter == onePerNode)
+        ranksPerWriter = getNumRanksPerNode(comm);
+
+    if (ranksPerWriter <= 1)
+        return;
+
+    int rank;
+    MPI_Check( MPI_Comm_rank(comm, &rank) );
+
+    active_ = true;
+    const int group = rank / ranksPerWriter;
+    MPI_Check( MPI_Comm_split(comm, group, rank, groupCommStorage_.reset_and_get_address()) );
+    groupComm_ = groupCommStorage_;
+
+    int groupRank;
+    MPI_Check( MPI_Comm_rank(groupComm_, &groupRank) );
+    isWriter_ = groupRank == 0;
+
+    MPI_Check( MPI_Comm_split(comm, isWriter_ ? 0 : MPI_UNDEFINED, rank,
+                              writerCommStorage_.reset_and_get_address()) );
+    writerComm_ = writerCommStorage_;
+
+    debug2("I/O aggregation: %d ranks per writer", ranksPerWriter);
+}
+
+IOAggregator::IOAggregator(MPI_Comm comm) :
+    IOAggregator(comm, getRanksPerWriterFromEnvironment())
+{}
+
+bool IOAggregator::isActive() const
+{
+    return active_;
+}
+
+bool IOAggregator::isWriter() const
+{
+    return isWriter_;
+}
+
+MPI_Comm IOAggregator::getWriterComm() const
+{
+    return writerComm_;
+}
+
+std::vector<char> IOAggregator::gatherBytes(const void *data, size_t n, size_t elementSize) const
+{
+    if (!active_)
+    {
+        const char *src = static_cast<const char*>(data);
+        return std::vector<char>(src, src + n * elementSize);
+    }
+
+    int groupSize;
+    MPI_Check( MPI_Comm_size(groupComm_, &groupSize) );
+
+    if (n > static_cast<size_t>(std::numeric_limits<int>::max()))
+        die("Too many elements to gather: %zu", n);
+
+    const int localCount = static_cast<int>(n);
+    std::vector<int> counts(isWriter_ ? groupSize : 0);
+    MPI_Check( MPI_Gather(&localCount, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, groupComm_) );
+
+    std::vector<int> displs(counts.size());
+    size_t total = 0;
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        if (total > static_cast<size_t>(std::numeric_limits<int>::max()))
+            die("Too many elements to gather on one writer: %zu", total);
+        displs[i] = static_cast<int>(total);
+        total += counts[i];
+    }
+
+    MPI_Datatype elementType;
+    MPI_Check( MPI_Type_contiguous(static_cast<int>(elementSize), MPI_BYTE, &elementType) );
+    MPI_Check( MPI_Type_commit(&elementType) );
+
+    std::vector<char> result(total * elementSize);
+    MPI_Check( MPI_Gatherv(data, localCount, elementType,
+                           result.data(), counts.data(), displs.data(), elementType, 0, groupComm_) );
+
+    MPI_Check( MPI_Type_free(&elementType) );
+    return result;
+}
+
+} // namespace mirheo
@@ -0,0 +1,86 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include "unique_mpi_comm.h"
+
+#include <cstddef>
+#include <cstring>
+#include <mpi.h>
+#include <vector>
+
+namespace mirheo
+{
+
+/** \brief Two-level parallel I/O: the data of a group of consecutive ranks is gathered to one writer rank per group.
+
+    Only the writer ranks take part in the (collective) file operations, with larger contiguous pieces of data.
+    The groups are made of consecutive ranks so that the gathered data keeps the global rank order,
+    i.e. the written files are identical to the ones written by all ranks.
+ */
+class IOAggregator
+{
+public:
+    /// Special value of the number of ranks per writer: one writer per node.
+    static constexpr int onePerNode = 0;
+
+    /** \brief Construct an IOAggregator; collective over \p comm.
+        \param comm The communicator of all the ranks that hold data.
+        \param ranksPerWriter Number of consecutive ranks gathered to one writer;
+                              onePerNode uses the number of ranks per node; 1 disables aggregation.
+     */
+    IOAggregator(MPI_Comm comm, int ranksPerWriter);
+
+    /** \brief Construct an IOAggregator configured by the environment variable \c MIRHEO_IO_RANKS_PER_WRITER.
+        \param comm The communicator of all the ranks that hold data.
+
+        The variable can be set to a positive number of ranks per writer or to \c "node".
+        Aggregation is disabled if the variable is not set.
+     */
+    explicit IOAggregator(MPI_Comm comm);
+
+    IOAggregator(const IOAggregator&) = delete;
+    IOAggregator& operator=(const IOAggregator&) = delete;
+
+    /// \return \c true if the data is gathered; \c false if every rank writes its own data.
+    bool isActive() const;
+
+    /// \return \c true if the current rank performs the file operations.
+    bool isWriter() const;
+
+    /// \return The communicator of the writer ranks; \c MPI_COMM_NULL on other ranks.
+    MPI_Comm getWriterComm() const;
+
+    /** \brief Gather data to the writer of the group, in rank order; collective over the group.
+        \param data The local data.
+        \param n Number of local elements.
+        \param elementSize Size of one element in bytes.
+        \return The data of the whole group on the writer rank, an empty vector on the other ranks.
+     */
+    std::vector<char> gatherBytes(const void *data, size_t n, size_t elementSize) const;
+
+    /** \brief Gather data to the writer of the group, in rank order; collective over the group.
+        \tparam T Trivially copyable element type.
+        \param data The local data.
+        \return The data of the whole group on the writer rank, an empty vector on the other ranks.
+     */
+    template <class T>
+    std::vector<T> gather(const std::vector<T>& data) const
+    {
+        const auto bytes = gatherBytes(data.data(), data.size(), sizeof(T));
+        std::vector<T> result(bytes.size() / sizeof(T));
+        if (!bytes.empty())
+            std::memcpy(result.data(), bytes.data(), bytes.size());
+        return result;
+    }
+
+private:
+    bool active_ {false};
+    bool isWriter_ {true};
+
+    UniqueMPIComm groupCommStorage_;
+    UniqueMPIComm writerCommStorage_;
+    MPI_Comm groupComm_ {MPI_COMM_NULL}; ///< ranks gathered to the same writer
+    MPI_Comm writerComm_;               ///< the writers; the whole communicator if not active
+};
+
+} // namespace mirheo
@@ -0,0 +1,49 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace mirheo
+{
+
+/** \brief Call func(i) for all i in [0, n), distributed in contiguous blocks over host threads.
+    \param [in] n Number of iterations.
+    \param [in] numThreads Number of threads; the hardware concurrency if not positive.
+    \param [in] func The body of the loop; must be thread safe if more than one thread is used.
+
+    The calling thread does all the work when a single thread is requested.
+ */
+template <class Func>
+void parallelFor(int n, int numThreads, Func&& func)
+{
+    if (numThreads <= 0)
+        numThreads = static_cast<int>(std::thread::hardware_concurrency());
+
+    numThreads = std::max(1, std::min(numThreads, n));
+
+    if (numThreads == 1)
+    {
+        for (int i = 0; i < n; ++i)
+            func(i);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    for (int t = 0; t < numThreads; ++t)
+    {
+        threads.emplace_back([&func, t, numThreads, n]()
+        {
+            const int begin = static_cast<int>((static_cast<long>(n) *  t     ) / numThreads);
+            const int end   = static_cast<int>((static_cast<long>(n) * (t + 1)) / numThreads);
+            for (int i = begin; i < end; ++i)
+                func(i);
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+}
+
+} // namespace mirheo
@@ -3,6 +3,7 @@
 
 #include <mirheo/core/logger.h>
 
+#include <cstdlib>
 #include <fstream>
 #include <sstream>
 
@@ -131,4 +132,10 @@ void copyFile(const std::string& srcFilename, const std::string& dstFilename)
     dst.flush();
 }
 
+bool createHardLink(const std::string& fname, const std::string& lnname)
+{
+    const std::string command = "ln -f " + fname + " " + lnname;
+    return system(command.c_str()) == 0;
+}
+
 } // namespace mirheo
@@ -81,4 +81,11 @@ std::string setExtensionOrDie(std::string path, const std::string ext);
  */
 void copyFile(const std::string& srcFilename, const std::string& dstFilename);
 
+/** \brief Create a hard link to a file, replacing the link if it already exists.
+    \param fname The name of the existing file.
+    \param lnname The name of the link.
+    \return \c true if the operation was successful, \c false otherwise
+ */
+bool createHardLink(const std::string& fname, const std::string& lnname);
+
 } // namespace mirheo
@@ -0,0 +1,115 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <mirheo/core/utils/cpu_gpu_defines.h>
+
+namespace mirheo
+{
+
+/// The order in which the cells of a CellListInfo are stored, see CellListInfo::encode()
+enum class CellOrdering
+{
+    RowMajor, ///< x fastest, then y, then z
+    Morton,   ///< rows of cells along x ordered on a 2D Morton (Z) curve in tiles of the (y, z) plane
+    Hilbert   ///< rows of cells along x ordered on a 2D Hilbert curve in tiles of the (y, z) plane
+};
+
+/// 2D space-filling curves over square grids of size n x n, where n is a power of 2
+namespace space_filling_curves
+{
+
+/** \brief Map 2D coordinates to their index along the Morton curve.
+    \param [in] x coordinate in [0, n)
+    \param [in] y coordinate in [0, n)
+    \param [in] nbits log2(n)
+    \return the index along the curve, in [0, n * n)
+ */
+__HD__ inline int mortonEncode(int x, int y, int nbits)
+{
+    int d = 0;
+    for (int i = 0; i < nbits; ++i)
+    {
+        d |= ((x >> i) & 1) << (2 * i);
+        d |= ((y >> i) & 1) << (2 * i + 1);
+    }
+    return d;
+}
+
+/** \brief Inverse of mortonEncode().
+    \param [in] d index along the curve
+    \param [in] nbits log2(n)
+    \param [out] x coordinate
+    \param [out] y coordinate
+ */
+__HD__ inline void mortonDecode(int d, int nbits, int& x, int& y)
+{
+    x = y = 0;
+    for (int i = 0; i < nbits; ++i)
+    {
+        x |= ((d >> (2 * i))     & 1) << i;
+        y |= ((d >> (2 * i + 1)) & 1) << i;
+    }
+}
+
+namespace details
+{
+/// rotate/flip a quadrant of the Hilbert curve
+__HD__ inline void hilbertRotate(int n, int& x, int& y, int rx, int ry)
+{
+    if (ry == 0)
+    {
+        if (rx == 1)
+        {
+            x = n - 1 - x;
+            y = n - 1 - y;
+        }
+        const int t = x;
+        x = y;
+        y = t;
+    }
+}
+} // namespace details
+
+/** \brief Map 2D coordinates to their index along the Hilbert curve.
+    \param [in] x coordinate in [0, n)
+    \param [in] y coordinate in [0, n)
+    \param [in] n size of the grid; must be a power of 2
+    \return the index along the curve, in [0, n * n)
+
+    The curve starts at (0, 0) and ends at (n-1, 0).
+ */
+__HD__ inline int hilbertEncode(int x, int y, int n)
+{
+    int d = 0;
+    for (int s = n / 2; s > 0; s /= 2)
+    {
+        const int rx = (x & s) > 0;
+        const int ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+        details::hilbertRotate(n, x, y, rx, ry);
+    }
+    return d;
+}
+
+/** \brief Inverse of hilbertEncode().
+    \param [in] d index along the curve
+    \param [in] n size of the grid; must be a power of 2
+    \param [out] x coordinate
+    \param [out] y coordinate
+ */
+__HD__ inline void hilbertDecode(int d, int n, int& x, int& y)
+{
+    x = y = 0;
+    for (int s = 1; s < n; s *= 2)
+    {
+        const int rx = 1 & (d / 2);
+        const int ry = 1 & (d ^ rx);
+        details::hilbertRotate(s, x, y, rx, ry);
+        x += s * rx;
+        y += s * ry;
+        d /= 4;
+    }
+}
+
+} // namespace space_filling_curves
+} // namespace mirheo
@@ -2,6 +2,7 @@
 #include "channel.h"
 
 #include <mirheo/core/logger.h>
+#include <mirheo/core/utils/path.h>
 
 namespace mirheo
 {
@@ -9,6 +10,11 @@ namespace mirheo
 namespace XDMF
 {
 
+bool Channel::Compression::isNone() const
+{
+    return deflateLevel == 0 && !shuffle && mantissaBits < 0;
+}
+
 int Channel::nComponents() const
 {
     return dataFormToNcomponents(dataForm);
@@ -87,7 +93,7 @@ Channel::DataForm descriptionToDataForm(const std::string& str)
     if (str == "Tensor6")     return Channel::Tensor6{};
     if (str == "Tensor")      return Channel::Tensor9{};
     if (str == "Quaternion")  return Channel::Quaternion{};
-    if (str == "Trianle")     return Channel::Triangle{};
+    if (str == "Triangle")    return Channel::Triangle{};
     if (str == "Vector4")     return Channel::Vector4{};
     if (str == "RigidMotion") return Channel::RigidMotion{};
 
@@ -147,6 +153,30 @@ Channel::NumberType infoToNumberType(const std::string& str, int precision)
     return Channel::NumberType::Float;
 }
 
+Channel::Compression stringToCompression(const std::string& str)
+{
+    Channel::Compression compression;
+
+    if (str == "" || str == "none")
+        return compression;
+
+    for (const auto& option : splitByDelim(str, ','))
+    {
+        int value {0};
+
+        if (option == "shuffle")
+            compression.shuffle = true;
+        else if (1 == sscanf(option.c_str(), "deflate=%d", &value) && value >= 0 && value <= 9)
+            compression.deflateLevel = value;
+        else if (1 == sscanf(option.c_str(), "mantissa=%d", &value) && value >= 0)
+            compression.mantissaBits = value;
+        else
+            die("Invalid compression option '%s' in '%s'; expected 'deflate=<0-9>', 'shuffle' or 'mantissa=<bits>'",
+                option.c_str(), str.c_str());
+    }
+    return compression;
+}
+
 } // namespace XDMF
 
 } // namespace mirheo
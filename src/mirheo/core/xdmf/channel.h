@@ -41,12 +41,31 @@ struct Channel
     /// If the data depends on the coordinates
     enum class NeedShift { True, False };
 
+    /** \brief Storage of the channel in the HDF5 file.
+
+        By default the data is stored uncompressed in a contiguous dataset.
+        Deflate and shuffle store the data in chunks and pass it through the corresponding HDF5 filters;
+        this requires HDF5 1.10.2 or newer, since older versions can not write filtered data sets in parallel.
+        Mantissa rounding alone does not change the layout: the data set stays contiguous and the file is not smaller;
+        it only makes the data more compressible when combined with deflate.
+     */
+    struct Compression
+    {
+        int deflateLevel {0};      ///< zlib compression level, from 1 (fastest) to 9 (smallest); 0 disables it
+        bool shuffle {false};      ///< reorder the bytes of the elements before compression; improves the ratio of floating point data
+        int mantissaBits {-1};     ///< if non negative, round floating point data to this many mantissa bits (lossy); -1 keeps full precision
+
+        /// \return \c true if the data is stored as is
+        bool isNone() const;
+    };
+
     std::string name;       ///< Name of the channel
     void *data;             ///< pointer to the data that needs to be dumped
     DataForm dataForm;      ///< topology of one element
     NumberType numberType;  ///< data type (enum version)
     TypeDescriptor type;    ///< data type (variant version)
     NeedShift needShift;    ///< wether the data depends on the coordinates or not
+    Compression compression {}; ///< how the data is stored in the HDF5 file
 
     int nComponents() const; ///< Number of component in each element (e.g. Vector has 3)
     int precision() const;   ///< Number of bytes of each component in one element
@@ -72,6 +91,13 @@ int                         numberTypeToPrecision (Channel::NumberType nt);
 /// reverse of numberTypeToString() and numberTypeToPrecision()
 Channel::NumberType infoToNumberType(const std::string& str, int precision);
 
+/** \brief Parse a Channel::Compression description.
+    \param str Comma separated list of options: \c "deflate=<level>", \c "shuffle", \c "mantissa=<bits>".
+                An empty string or \c "none" means no compression.
+    \return The corresponding Channel::Compression.
+ */
+Channel::Compression stringToCompression(const std::string& str);
+
 } // namespace XDMF
 
 } // namespace mirheo
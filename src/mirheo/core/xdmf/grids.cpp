@@ -5,6 +5,7 @@
 #include "type_map.h"
 
 #include <mirheo/core/logger.h>
+#include <mirheo/core/utils/io_aggregator.h>
 
 namespace mirheo {
 namespace XDMF {
@@ -22,6 +23,17 @@ bool GridDims::localEmpty()  const { return product(getLocalSize ()) == 0; }
 bool GridDims::globalEmpty() const { return product(getGlobalSize()) == 0; }
 int  GridDims::getDims()     const { return (int) getLocalSize().size();   }
 
+bool Grid::supportsAggregation() const
+{
+    return false;
+}
+
+std::unique_ptr<Grid> Grid::aggregate(__UNUSED const IOAggregator& aggregator) const
+{
+    die("This grid does not support I/O aggregation");
+    return nullptr;
+}
+
 //
 // Uniform Grid
 //
@@ -165,6 +177,7 @@ void VertexGrid::writeToHDF5(hid_t file_id, __UNUSED MPI_Comm comm) const
     Channel posCh {positionChannelName_, (void*) positions_->data(),
                    Channel::Vector{}, XDMF::getNumberType<real>(),
                    DataTypeWrapper<real>(), Channel::NeedShift::True};
+    posCh.compression = positionsCompression_;
 
     HDF5::writeDataSet(file_id, getGridDims(), posCh);
 }
@@ -251,6 +264,33 @@ void VertexGrid::readFromHDF5(hid_t file_id, __UNUSED MPI_Comm comm)
     HDF5::readDataSet(file_id, getGridDims(), posCh);
 }
 
+bool VertexGrid::supportsAggregation() const
+{
+    return true;
+}
+
+std::shared_ptr<std::vector<real3>> VertexGrid::_aggregatePositions(const IOAggregator& aggregator) const
+{
+    auto positions = std::make_shared<std::vector<real3>>(aggregator.gather(*positions_));
+    return aggregator.isWriter() ? positions : nullptr;
+}
+
+std::unique_ptr<Grid> VertexGrid::aggregate(const IOAggregator& aggregator) const
+{
+    auto positions = _aggregatePositions(aggregator);
+    if (!aggregator.isWriter())
+        return nullptr;
+
+    auto grid = std::make_unique<VertexGrid>(std::move(positions), aggregator.getWriterComm());
+    grid->setPositionsCompression(positionsCompression_);
+    return grid;
+}
+
+void VertexGrid::setPositionsCompression(const Channel::Compression& compression)
+{
+    positionsCompression_ = compression;
+}
+
 void VertexGrid::_writeTopology(pugi::xml_node& topoNode, __UNUSED const std::string& h5filename) const
 {
     topoNode.append_attribute("TopologyType") = "Polyvertex";
@@ -282,6 +322,19 @@ void TriangleMeshGrid::writeToHDF5(hid_t file_id, MPI_Comm comm) const
     HDF5::writeDataSet(file_id, &dimsTriangles_, triCh);
 }
 
+std::unique_ptr<Grid> TriangleMeshGrid::aggregate(const IOAggregator& aggregator) const
+{
+    auto positions = _aggregatePositions(aggregator);
+    // the connectivity holds global indices, which are not affected by the aggregation
+    auto triangles = std::make_shared<std::vector<int3>>(aggregator.gather(*triangles_));
+    if (!aggregator.isWriter())
+        return nullptr;
+
+    auto grid = std::make_unique<TriangleMeshGrid>(std::move(positions), std::move(triangles), aggregator.getWriterComm());
+    grid->setPositionsCompression(positionsCompression_);
+    return grid;
+}
+
 void TriangleMeshGrid::_writeTopology(pugi::xml_node& topoNode, const std::string& h5filename) const
 {
     topoNode.append_attribute("TopologyType") = "Triangle";
@@ -329,6 +382,19 @@ void PolylineMeshGrid::writeToHDF5(hid_t file_id, MPI_Comm comm) const
     HDF5::writeDataSet(file_id, &dimsPolylines_, ch);
 }
 
+std::unique_ptr<Grid> PolylineMeshGrid::aggregate(const IOAggregator& aggregator) const
+{
+    auto positions = _aggregatePositions(aggregator);
+    auto polylines = std::make_shared<std::vector<int>>(aggregator.gather(*polylines_));
+    if (!aggregator.isWriter())
+        return nullptr;
+
+    auto grid = std::make_unique<PolylineMeshGrid>(std::move(positions), std::move(polylines),
+                                                   chainSize_, aggregator.getWriterComm());
+    grid->setPositionsCompression(positionsCompression_);
+    return grid;
+}
+
 void PolylineMeshGrid::_writeTopology(pugi::xml_node& topoNode, const std::string& h5filename) const
 {
     topoNode.append_attribute("TopologyType") = "Polyline";
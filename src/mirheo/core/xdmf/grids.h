@@ -12,6 +12,9 @@
 #include <vector>
 
 namespace mirheo {
+
+class IOAggregator;
+
 namespace XDMF {
 
 /** \brief Interface to represent the dimensions of the geometry data
@@ -73,6 +76,17 @@ public:
         \note must be called after splitReadAccess()
      */
     virtual void readFromHDF5(hid_t file_id, MPI_Comm comm) = 0;
+
+    /// \return \c true if the data of this geometry can be gathered to writer ranks with aggregate().
+    virtual bool supportsAggregation() const;
+
+    /** \brief Gather the geometry of each group of ranks to its writer rank.
+        \param aggregator Describes the groups of ranks; the call is collective over all the ranks of the grid.
+        \return On the writer ranks, the geometry of the gathered data, defined on the writer communicator;
+                \c nullptr on the other ranks.
+        \note must only be called if supportsAggregation() returns \c true.
+     */
+    virtual std::unique_ptr<Grid> aggregate(const IOAggregator& aggregator) const;
 };
 
 /** \brief Representation of a uniform grid geometry.
@@ -145,7 +159,21 @@ public:
     void splitReadAccess(MPI_Comm comm, int chunkSize = 1)                        override;
     void readFromHDF5(hid_t file_id, MPI_Comm comm)                               override;
 
+    bool supportsAggregation() const override;
+    std::unique_ptr<Grid> aggregate(const IOAggregator& aggregator) const override;
+
+    /// Set the compression of the positions data set, see Channel::Compression.
+    void setPositionsCompression(const Channel::Compression& compression);
+
 protected:
+    /** \brief Gather the positions of each group of ranks to its writer rank.
+        \param aggregator Describes the groups of ranks.
+        \return The positions of the group on the writer ranks, \c nullptr on the other ranks.
+     */
+    std::shared_ptr<std::vector<real3>> _aggregatePositions(const IOAggregator& aggregator) const;
+
+    Channel::Compression positionsCompression_; ///< storage of the positions data set
+
     /// dimensions of the vertex geometry representation
     class VertexGridDims : public GridDims
     {
@@ -197,6 +225,7 @@ public:
     TriangleMeshGrid(std::shared_ptr<std::vector<real3>> positions, std::shared_ptr<std::vector<int3>> triangles, MPI_Comm comm);
 
     void writeToHDF5(hid_t file_id, MPI_Comm comm) const override;
+    std::unique_ptr<Grid> aggregate(const IOAggregator& aggregator) const override;
 
 private:
     static const std::string triangleChannelName_;
@@ -228,6 +257,7 @@ public:
                      MPI_Comm comm);
 
     void writeToHDF5(hid_t file_id, MPI_Comm comm) const override;
+    std::unique_ptr<Grid> aggregate(const IOAggregator& aggregator) const override;
 
 private:
     static const std::string polylineChannelName_;
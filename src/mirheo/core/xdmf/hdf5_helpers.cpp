@@ -4,8 +4,11 @@
 #include <mirheo/core/logger.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <numeric>
 
 namespace mirheo
 {
@@ -69,6 +72,111 @@ hid_t openReadOnly(const std::string& filename, MPI_Comm comm)
     return file_id;
 }
 
+template <typename UInt, int NumMantissaBits>
+static void roundMantissa(UInt *data, size_t n, int mantissaBits)
+{
+    if (mantissaBits >= NumMantissaBits)
+        return;
+
+    constexpr int numExponentBits = 8 * sizeof(UInt) - NumMantissaBits - 1;
+    constexpr UInt exponentMask = ((UInt(1) << numExponentBits) - 1) << NumMantissaBits;
+
+    const int dropBits = NumMantissaBits - mantissaBits;
+    const UInt mask = ~((UInt(1) << dropBits) - 1);
+    const UInt half = UInt(1) << (dropBits - 1);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        // inf and nan are kept as is
+        if ((data[i] & exponentMask) == exponentMask)
+            continue;
+
+        // the carry may propagate to the exponent, which is the correct rounding
+        const UInt rounded = (data[i] + half) & mask;
+
+        // do not round to inf
+        if ((rounded & exponentMask) != exponentMask)
+            data[i] = rounded;
+        else
+            data[i] &= mask;
+    }
+}
+
+void roundMantissa(Channel::NumberType numberType, void *data, size_t n, int mantissaBits)
+{
+    if (mantissaBits < 0)
+        return;
+
+    switch (numberType)
+    {
+    case Channel::NumberType::Float:
+        static_assert(sizeof(float) == sizeof(uint32_t), "unexpected float size");
+        roundMantissa<uint32_t, 23>(static_cast<uint32_t*>(data), n, mantissaBits);
+        break;
+    case Channel::NumberType::Double:
+        static_assert(sizeof(double) == sizeof(uint64_t), "unexpected double size");
+        roundMantissa<uint64_t, 52>(static_cast<uint64_t*>(data), n, mantissaBits);
+        break;
+    default:
+        break;
+    }
+}
+
+static hsize_t product(const std::vector<hsize_t>& v)
+{
+    return std::accumulate(v.begin(), v.end(), hsize_t(1), std::multiplies<hsize_t>());
+}
+
+/** Dataset creation properties for a given compression.
+    The chunk dimensions only depend on the global size, so they are identical on all ranks,
+    as required by parallel HDF5 (filtered datasets can only be written collectively).
+ */
+static hid_t createDataSetProperties(const std::vector<hsize_t>& globalSize, size_t elementSize,
+                                     const Channel::Compression& compression)
+{
+    constexpr hsize_t targetChunkSizeBytes = 1 << 20;
+
+    hid_t dcpl_id = H5Pcreate(H5P_DATASET_CREATE);
+
+    if (compression.deflateLevel == 0 && !compression.shuffle)
+        return dcpl_id;
+
+#if !H5_VERSION_GE(1, 10, 2)
+    // parallel HDF5 can not write filtered data sets before 1.10.2
+    static bool warned = false;
+    if (!warned)
+        warn("Compression of XDMF data sets requires HDF5 1.10.2 or newer (found %d.%d.%d); writing uncompressed data",
+             H5_VERS_MAJOR, H5_VERS_MINOR, H5_VERS_RELEASE);
+    warned = true;
+    return dcpl_id;
+#endif
+
+    std::vector<hsize_t> chunk = globalSize;
+    for (auto& c : chunk)
+        c = std::max(c, hsize_t(1));
+
+    // halve the slowest dimensions first so that a chunk is a contiguous piece of the data
+    for (size_t d = 0; d + 1 < chunk.size(); ++d)
+        while (chunk[d] > 1 && product(chunk) * elementSize > targetChunkSizeBytes)
+            chunk[d] = (chunk[d] + 1) / 2;
+
+    H5Pset_chunk(dcpl_id, static_cast<int>(chunk.size()), chunk.data());
+    H5Pset_fill_time(dcpl_id, H5D_FILL_TIME_NEVER);
+
+    if (compression.shuffle)
+        H5Pset_shuffle(dcpl_id);
+
+    if (compression.deflateLevel > 0)
+    {
+        if (H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0)
+            H5Pset_deflate(dcpl_id, static_cast<unsigned>(compression.deflateLevel));
+        else
+            warn("The deflate filter is not available in this HDF5 installation; writing uncompressed data");
+    }
+
+    return dcpl_id;
+}
+
 void writeDataSet(hid_t file_id, const GridDims *gridDims, const Channel& channel)
 {
     debug2("Writing channel '%s'", channel.name.c_str());
@@ -90,7 +198,12 @@ void writeDataSet(hid_t file_id, const GridDims *gridDims, const Channel& channe
 
     hid_t filespace_simple = H5Screate_simple(ndims, globalSize.data(), nullptr);
 
-    hid_t dset_id = H5Dcreate(file_id, channel.name.c_str(), numberType, filespace_simple, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    const auto& compression = channel.compression;
+    hid_t dcpl_id = H5P_DEFAULT;
+    if (!compression.isNone() && !gridDims->globalEmpty())
+        dcpl_id = createDataSetProperties(globalSize, channel.precision(), compression);
+
+    hid_t dset_id = H5Dcreate(file_id, channel.name.c_str(), numberType, filespace_simple, H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
     hid_t xfer_plist_id = H5Pcreate(H5P_DATASET_XFER);
 
     H5Pset_dxpl_mpio(xfer_plist_id, H5FD_MPIO_COLLECTIVE);
@@ -105,12 +218,26 @@ void writeDataSet(hid_t file_id, const GridDims *gridDims, const Channel& channe
 
     hid_t mspace_id = H5Screate_simple(ndims, localSize.data(), nullptr);
 
+    const void *data = channel.data;
+    std::vector<char> roundedData;
+
+    if (compression.mantissaBits >= 0 && !gridDims->localEmpty())
+    {
+        const size_t n = product(localSize);
+        const char *src = static_cast<const char*>(channel.data);
+        roundedData.assign(src, src + n * channel.precision());
+        roundMantissa(channel.numberType, roundedData.data(), n, compression.mantissaBits);
+        data = roundedData.data();
+    }
+
     if (!gridDims->globalEmpty())
-        H5Dwrite(dset_id, numberType, mspace_id, dspace_id, xfer_plist_id, channel.data);
+        H5Dwrite(dset_id, numberType, mspace_id, dspace_id, xfer_plist_id, data);
 
     H5Sclose(mspace_id);
     H5Sclose(dspace_id);
     H5Pclose(xfer_plist_id);
+    if (dcpl_id != H5P_DEFAULT)
+        H5Pclose(dcpl_id);
     H5Dclose(dset_id);
 }
 
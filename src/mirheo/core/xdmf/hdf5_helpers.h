@@ -20,6 +20,17 @@ namespace HDF5
 hid_t create      (const std::string& filename, MPI_Comm comm);
 hid_t openReadOnly(const std::string& filename, MPI_Comm comm);
 
+/** \brief Round floating point data to a reduced number of mantissa bits, in place.
+    \param [in] numberType The type of the data; only Float and Double are modified.
+    \param [in,out] data The values to round.
+    \param [in] n The number of values.
+    \param [in] mantissaBits The number of explicit mantissa bits to keep.
+
+    The dropped bits are set to zero, so that the data compresses well with a lossless filter.
+    The rounding is to nearest; inf and nan values are kept unchanged.
+ */
+void roundMantissa(Channel::NumberType numberType, void *data, size_t n, int mantissaBits);
+
 void writeDataSet(hid_t file_id, const GridDims *gridDims, const Channel& channel);
 void writeData   (hid_t file_id, const GridDims *gridDims, const std::vector<Channel>& channels);
 
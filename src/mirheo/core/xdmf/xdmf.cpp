@@ -7,6 +7,7 @@
 
 #include <mirheo/core/logger.h>
 #include <mirheo/core/utils/cuda_common.h>
+#include <mirheo/core/utils/io_aggregator.h>
 #include <mirheo/core/utils/path.h>
 #include <mirheo/core/utils/timer.h>
 
@@ -17,26 +18,65 @@ namespace mirheo
 
 namespace XDMF
 {
-void write(const std::string& filename, const Grid *grid,
-           const std::vector<Channel>& channels, MPI_Comm comm)
+inline long getLocalNumElements(const GridDims *gridDims)
+{
+    long n = 1;
+    for (auto i : gridDims->getLocalSize())  n *= i;
+    return n;
+}
+
+static void writeFiles(const std::string& filename, const Grid *grid,
+                       const std::vector<Channel>& channels, MPI_Comm comm)
 {
     std::string h5Filename  = filename + ".h5";
     std::string xmfFilename = filename + ".xmf";
 
-    info("Writing XDMF data to %s[.h5,.xmf]", filename.c_str());
-
-    mTimer timer;
-    timer.start();
     XMF::write(xmfFilename, getBaseName(h5Filename), comm, grid, channels);
     HDF5::write(h5Filename, comm, grid, channels);
-    info("Writing took %f ms", timer.elapsed());
 }
 
-inline long getLocalNumElements(const GridDims *gridDims)
+void write(const std::string& filename, const Grid *grid,
+           const std::vector<Channel>& channels, MPI_Comm comm)
 {
-    long n = 1;
-    for (auto i : gridDims->getLocalSize())  n *= i;
-    return n;
+    const IOAggregator aggregator(comm);
+    write(filename, grid, channels, comm, aggregator);
+}
+
+void write(const std::string& filename, const Grid *grid,
+           const std::vector<Channel>& channels, MPI_Comm comm, const IOAggregator& aggregator)
+{
+    info("Writing XDMF data to %s[.h5,.xmf]", filename.c_str());
+
+    mTimer timer;
+    timer.start();
+
+    if (!aggregator.isActive() || !grid->supportsAggregation())
+    {
+        writeFiles(filename, grid, channels, comm);
+    }
+    else
+    {
+        const auto aggregatedGrid = grid->aggregate(aggregator);
+        const long nElements = getLocalNumElements(grid->getGridDims());
+
+        std::vector<Channel> aggregatedChannels = channels;
+        std::vector<std::vector<char>> aggregatedData;
+        aggregatedData.reserve(channels.size());
+
+        for (auto& ch : aggregatedChannels)
+        {
+            aggregatedData.push_back(aggregator.gatherBytes(ch.data, nElements, ch.nComponents() * ch.precision()));
+            ch.data = aggregatedData.back().data();
+        }
+
+        if (aggregator.isWriter())
+            writeFiles(filename, aggregatedGrid.get(), aggregatedChannels, aggregator.getWriterComm());
+
+        // the files are complete on all ranks when returning, as without aggregation
+        MPI_Check( MPI_Barrier(comm) );
+    }
+
+    info("Writing took %f ms", timer.elapsed());
 }
 
 VertexChannelsData readVertexData(const std::string& filename, MPI_Comm comm, int chunkSize)
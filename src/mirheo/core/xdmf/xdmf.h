@@ -25,6 +25,16 @@ namespace XDMF
 void write(const std::string& filename, const Grid *grid,
            const std::vector<Channel>& channels, MPI_Comm comm);
 
+/** \brief Same as above, but with an IOAggregator created once over \p comm by the caller.
+    \param filename Base file name (without extension); two files will be created: xmf and hdf5
+    \param grid The geometry description of the data. See \c Grid.
+    \param channels A list of channel descriptions and associated data to dump
+    \param comm MPI communicator shared by all ranks containing the data (simulation OR postprocess ranks)
+    \param aggregator The aggregator of the ranks of \p comm; creating one is collective, so repeated dumps should reuse it.
+ */
+void write(const std::string& filename, const Grid *grid,
+           const std::vector<Channel>& channels, MPI_Comm comm, const IOAggregator& aggregator);
+
 /** \brief the data read by readVertexData()
 
     Represents particles data
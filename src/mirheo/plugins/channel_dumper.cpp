@@ -6,15 +6,18 @@
 #include <mirheo/core/utils/path.h>
 #include <mirheo/core/xdmf/type_map.h>
 
+#include <algorithm>
 #include <string>
 #include <memory>
 
 namespace mirheo
 {
 
-UniformCartesianDumper::UniformCartesianDumper(std::string name, std::string path) :
+UniformCartesianDumper::UniformCartesianDumper(std::string name, std::string path,
+                                               std::map<std::string, XDMF::Channel::Compression> compression) :
     PostprocessPlugin(name),
-    path_(path)
+    path_(path),
+    compression_(std::move(compression))
 {}
 
 UniformCartesianDumper::~UniformCartesianDumper() = default;
@@ -63,9 +66,22 @@ void UniformCartesianDumper::handshake()
         }
     }
 
+    for (const auto& entry : compression_)
+    {
+        auto it = std::find_if(channels_.begin(), channels_.end(),
+                               [&](const XDMF::Channel& ch) {return ch.name == entry.first;});
+
+        if (it == channels_.end())
+            die("Plugin '%s': cannot compress unknown channel '%s'", getCName(), entry.first.c_str());
+
+        it->compression = entry.second;
+    }
+
     // Create the required folder
     createFoldersCollective(comm_, getParentPath(path_));
 
+    aggregator_ = std::make_unique<IOAggregator>(cartComm_);
+
     debug2("Plugin %s was set up to dump channels %s. Resolution is %dx%dx%d, path is %s", getCName(),
             allNames.c_str(), resolution.x, resolution.y, resolution.z, path_.c_str());
 }
@@ -97,7 +113,7 @@ void UniformCartesianDumper::deserialize()
     }
 
     const std::string fname = path_ + createStrZeroPadded(timeStamp, zeroPadding_);
-    XDMF::write(fname, grid_.get(), channels_, cartComm_);
+    XDMF::write(fname, grid_.get(), channels_, cartComm_, *aggregator_);
 }
 
 XDMF::Channel UniformCartesianDumper::getChannelOrDie(std::string chname) const
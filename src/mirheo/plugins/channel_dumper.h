@@ -2,9 +2,11 @@
 #pragma once
 
 #include <mirheo/core/plugins.h>
+#include <mirheo/core/utils/io_aggregator.h>
 #include <mirheo/core/utils/unique_mpi_comm.h>
 #include <mirheo/core/xdmf/xdmf.h>
 
+#include <map>
 #include <memory>
 #include <mpi.h>
 #include <vector>
@@ -21,8 +23,10 @@ public:
     /** Create a UniformCartesianDumper.
         \param [in] name The name of the plugin.
         \param [in] path The files will be dumped to `pathXXXXX.[xmf,h5]`, where `XXXXX` is the time stamp.
+        \param [in] compression Storage of the HDF5 data sets, per channel name. Channels that are not listed are stored uncompressed.
      */
-    UniformCartesianDumper(std::string name, std::string path);
+    UniformCartesianDumper(std::string name, std::string path,
+                           std::map<std::string, XDMF::Channel::Compression> compression = {});
     ~UniformCartesianDumper();
 
     void deserialize() override;
@@ -51,8 +55,10 @@ private:
 
     std::string path_;
     static constexpr int zeroPadding_ = 5;
+    std::map<std::string, XDMF::Channel::Compression> compression_;
 
     UniqueMPIComm cartComm_;
+    std::unique_ptr<IOAggregator> aggregator_; ///< created once over cartComm_, reused by every dump
 };
 
 } // namespace mirheo
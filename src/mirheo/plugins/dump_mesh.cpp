@@ -8,6 +8,7 @@
 #include <mirheo/core/pvs/particle_vector.h>
 #include <mirheo/core/simulation.h>
 #include <mirheo/core/utils/cuda_common.h>
+#include <mirheo/core/utils/io_aggregator.h>
 #include <mirheo/core/utils/path.h>
 
 #include <regex>
@@ -83,23 +84,12 @@ template<typename T> inline std::string getTypeStr();
 template<> inline std::string getTypeStr<float> () {return "float";}
 template<> inline std::string getTypeStr<double>() {return "double";}
 
-static void writePLY(
-        MPI_Comm comm, std::string fname,
-        int nvertices, int nverticesPerObject,
-        int ntriangles, int ntrianglesPerObject,
-        int nObjects,
-        const std::vector<int3>& mesh,
-        const std::vector<real3>& vertices)
+static void writePLYData(MPI_Comm comm, const std::string& fname, int totalVerts, int totalTriangles,
+                         const std::vector<real3>& vertices, const std::vector<int4>& connectivity)
 {
     int rank;
     MPI_Check( MPI_Comm_rank(comm, &rank) );
 
-    int totalVerts = 0;
-    MPI_Check( MPI_Reduce(&nvertices, &totalVerts, 1, MPI_INT, MPI_SUM, 0, comm) );
-
-    int totalTriangles = 0;
-    MPI_Check( MPI_Reduce(&ntriangles, &totalTriangles, 1, MPI_INT, MPI_SUM, 0, comm) );
-
     MPI_File f;
     MPI_Check( MPI_File_open(comm, fname.c_str(), MPI_MODE_CREATE|MPI_MODE_DELETE_ON_CLOSE|MPI_MODE_WRONLY, MPI_INFO_NULL, &f) );
     MPI_Check( MPI_File_close(&f) );
@@ -133,7 +123,19 @@ static void writePLY(
     fileOffset += headerSize;
 
     fileOffset += writeToMPI(vertices, f, fileOffset, comm);
+    fileOffset += writeToMPI(connectivity, f, fileOffset, comm);
 
+    MPI_Check( MPI_File_close(&f));
+}
+
+static void writePLY(
+        MPI_Comm comm, const IOAggregator& aggregator, std::string fname,
+        int nvertices, int nverticesPerObject,
+        int ntriangles, int ntrianglesPerObject,
+        int nObjects,
+        const std::vector<int3>& mesh,
+        const std::vector<real3>& vertices)
+{
     int verticesOffset = 0;
     MPI_Check( MPI_Exscan(&nvertices, &verticesOffset, 1, MPI_INT, MPI_SUM, comm));
 
@@ -145,12 +147,32 @@ static void writePLY(
             connectivity.push_back({3, vertIds.x, vertIds.y, vertIds.z});
         }
 
-    fileOffset += writeToMPI(connectivity, f, fileOffset, comm);
+    // only needed on the root rank, which is always a writer
+    int totalVerts = 0;
+    MPI_Check( MPI_Reduce(&nvertices, &totalVerts, 1, MPI_INT, MPI_SUM, 0, comm) );
 
-    MPI_Check( MPI_File_close(&f));
+    int totalTriangles = 0;
+    MPI_Check( MPI_Reduce(&ntriangles, &totalTriangles, 1, MPI_INT, MPI_SUM, 0, comm) );
+
+    if (!aggregator.isActive())
+    {
+        writePLYData(comm, fname, totalVerts, totalTriangles, vertices, connectivity);
+        return;
+    }
+
+    // the connectivity holds global indices, so it can be gathered as is
+    const auto aggregatedVertices     = aggregator.gather(vertices);
+    const auto aggregatedConnectivity = aggregator.gather(connectivity);
+
+    if (aggregator.isWriter())
+        writePLYData(aggregator.getWriterComm(), fname, totalVerts, totalTriangles,
+                     aggregatedVertices, aggregatedConnectivity);
+
+    MPI_Check( MPI_Barrier(comm) );
 }
 
 
+
 MeshDumper::MeshDumper(std::string name, std::string path) :
     PostprocessPlugin(name),
     path_(makePath(path))
@@ -162,6 +184,7 @@ void MeshDumper::setup(const MPI_Comm& comm, const MPI_Comm& interComm)
 {
     PostprocessPlugin::setup(comm, interComm);
     activated_ = createFoldersCollective(comm, path_);
+    aggregator_ = std::make_unique<IOAggregator>(comm);
 }
 
 void MeshDumper::deserialize()
@@ -177,7 +200,7 @@ void MeshDumper::deserialize()
     if (activated_)
     {
         const int nObjects = static_cast<int>(vertices_.size()) / nvertices;
-        writePLY(comm_, currentFname,
+        writePLY(comm_, *aggregator_, currentFname,
                 nvertices * nObjects, nvertices,
                 ntriangles*nObjects, ntriangles,
                 nObjects,
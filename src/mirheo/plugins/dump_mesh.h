@@ -4,7 +4,9 @@
 #include <mirheo/core/containers.h>
 #include <mirheo/core/datatypes.h>
 #include <mirheo/core/plugins.h>
+#include <mirheo/core/utils/io_aggregator.h>
 
+#include <memory>
 #include <vector>
 
 namespace mirheo
@@ -70,6 +72,8 @@ private:
 
     std::vector<int3> connectivity_;
     std::vector<real3> vertices_;
+
+    std::unique_ptr<IOAggregator> aggregator_; ///< created once in setup(), reused by every dump
 };
 
 } // namespace mirheo
@@ -10,6 +10,8 @@
 #include <mirheo/core/utils/kernel_launch.h>
 #include <mirheo/core/xdmf/type_map.h>
 
+#include <algorithm>
+
 namespace mirheo
 {
 
@@ -237,10 +239,12 @@ void ParticleSenderPlugin::serializeAndSend(__UNUSED cudaStream_t stream)
 
 
 
-ParticleDumperPlugin::ParticleDumperPlugin(std::string name, std::string path) :
+ParticleDumperPlugin::ParticleDumperPlugin(std::string name, std::string path,
+                                           std::map<std::string, XDMF::Channel::Compression> compression) :
     PostprocessPlugin(name),
     path_(path),
-    positions_(std::make_shared<std::vector<real3>>())
+    positions_(std::make_shared<std::vector<real3>>()),
+    compression_(std::move(compression))
 {}
 
 ParticleDumperPlugin::~ParticleDumperPlugin() = default;
@@ -284,9 +288,25 @@ void ParticleDumperPlugin::handshake()
         allNames += ", '" + name + "'";
     }
 
+    for (const auto& entry : compression_)
+    {
+        if (entry.first == "position")
+            continue;
+
+        auto it = std::find_if(channels_.begin(), channels_.end(),
+                               [&](const XDMF::Channel& ch) {return ch.name == entry.first;});
+
+        if (it == channels_.end())
+            die("Plugin '%s': cannot compress unknown channel '%s'", getCName(), entry.first.c_str());
+
+        it->compression = entry.second;
+    }
+
     // Create the required folder
     createFoldersCollective(comm_, getParentPath(path_));
 
+    aggregator_ = std::make_unique<IOAggregator>(comm_);
+
     debug2("Plugin '%s' was set up to dump channels %s. Path is %s",
            getCName(), allNames.c_str(), path_.c_str());
 }
@@ -332,7 +352,12 @@ void ParticleDumperPlugin::deserialize()
     std::string fname = path_ + createStrZeroPadded(timeStamp, zeroPadding_);
 
     XDMF::VertexGrid grid(positions_, comm_);
-    XDMF::write(fname, &grid, channels_, comm_);
+
+    auto posCompression = compression_.find("position");
+    if (posCompression != compression_.end())
+        grid.setPositionsCompression(posCompression->second);
+
+    XDMF::write(fname, &grid, channels_, comm_, *aggregator_);
 }
 
 } // namespace mirheo
@@ -4,9 +4,12 @@
 #include <mirheo/core/containers.h>
 #include <mirheo/core/datatypes.h>
 #include <mirheo/core/plugins.h>
+#include <mirheo/core/utils/io_aggregator.h>
 
 #include <mirheo/core/xdmf/xdmf.h>
 
+#include <map>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -65,8 +68,11 @@ public:
     /** Create a ParticleDumperPlugin object.
         \param [in] name The name of the plugin.
         \param [in] path Particle data will be dumped to `pathXXXXX.[xmf,h5]`.
+        \param [in] compression Storage of the HDF5 data sets, per channel name (including "position", "velocity" and "id").
+                    Channels that are not listed are stored uncompressed.
     */
-    ParticleDumperPlugin(std::string name, std::string path);
+    ParticleDumperPlugin(std::string name, std::string path,
+                         std::map<std::string, XDMF::Channel::Compression> compression = {});
 
     ~ParticleDumperPlugin();
 
@@ -90,8 +96,11 @@ protected:
     std::vector<int64_t> ids_; ///< Processed ids.
     std::shared_ptr<std::vector<real3>> positions_; ///< Processed positions.
 
+    std::map<std::string, XDMF::Channel::Compression> compression_; ///< Storage of the data sets per channel name.
     std::vector<XDMF::Channel> channels_; ///< List of received channel descriptions.
     std::vector<std::vector<char>> channelData_; ///< List of received channel data.
+
+    std::unique_ptr<IOAggregator> aggregator_; ///< Created once over the postprocess ranks in handshake(), reused by every dump.
 };
 
 } // namespace mirheo
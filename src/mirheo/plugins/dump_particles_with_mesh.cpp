@@ -99,7 +99,7 @@ void ParticleWithMeshDumperPlugin::deserialize()
     const std::string fname = path_ + createStrZeroPadded(timeStamp, zeroPadding_);
 
     const XDMF::TriangleMeshGrid grid(positions_, allTriangles_, comm_);
-    XDMF::write(fname, &grid, channels_, comm_);
+    XDMF::write(fname, &grid, channels_, comm_, *aggregator_);
 }
 
 } // namespace mirheo
@@ -98,7 +98,7 @@ void ParticleWithPolylinesDumperPlugin::deserialize()
     const std::string fname = path_ + createStrZeroPadded(timeStamp, zeroPadding_);
 
     const XDMF::PolylineMeshGrid grid(positions_, allPolylines_, chainSize_, comm_);
-    XDMF::write(fname, &grid, channels_, comm_);
+    XDMF::write(fname, &grid, channels_, comm_, *aggregator_);
 }
 
 } // namespace mirheo
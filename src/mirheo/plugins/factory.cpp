@@ -62,6 +62,15 @@ static std::vector<std::string> extractPVNames(const std::vector<ParticleVector*
     return pvNames;
 }
 
+static std::map<std::string, XDMF::Channel::Compression>
+parseCompression(const std::map<std::string, std::string>& compression)
+{
+    std::map<std::string, XDMF::Channel::Compression> result;
+    for (const auto& entry : compression)
+        result[entry.first] = XDMF::stringToCompression(entry.second);
+    return result;
+}
+
 PairPlugin createAddFourRollMillForcePlugin(bool computeTask, const MirState *state,
                                             std::string name, ParticleVector *pv, real intensity)
 {
@@ -215,13 +224,14 @@ PairPlugin createRateOutletPlugin(bool computeTask, const MirState *state, std::
 
 PairPlugin createDumpAveragePlugin(bool computeTask, const MirState *state, std::string name, std::vector<ParticleVector*> pvs,
                                    int sampleEvery, int dumpEvery, real3 binSize,
-                                   std::vector<std::string> channelNames, std::string path)
+                                   std::vector<std::string> channelNames, std::string path,
+                                   const std::map<std::string, std::string>& compression)
 {
     auto simPl  = computeTask ?
         std::make_shared<Average3D> (state, name, extractPVNames(pvs), channelNames, sampleEvery, dumpEvery, binSize) :
         nullptr;
 
-    auto postPl = computeTask ? nullptr : std::make_shared<UniformCartesianDumper> (name, path);
+    auto postPl = computeTask ? nullptr : std::make_shared<UniformCartesianDumper> (name, path, parseCompression(compression));
 
     return { simPl, postPl };
 }
@@ -229,7 +239,8 @@ PairPlugin createDumpAveragePlugin(bool computeTask, const MirState *state, std:
 PairPlugin createDumpAverageRelativePlugin(bool computeTask, const MirState *state, std::string name, std::vector<ParticleVector*> pvs,
                                            ObjectVector* relativeToOV, int relativeToId,
                                            int sampleEvery, int dumpEvery, real3 binSize,
-                                           std::vector<std::string> channelNames, std::string path)
+                                           std::vector<std::string> channelNames, std::string path,
+                                           const std::map<std::string, std::string>& compression)
 {
     auto simPl  = computeTask ?
         std::make_shared<AverageRelative3D> (state, name, extractPVNames(pvs),
@@ -237,7 +248,7 @@ PairPlugin createDumpAverageRelativePlugin(bool computeTask, const MirState *sta
                                              binSize, relativeToOV->getName(), relativeToId) :
         nullptr;
 
-    auto postPl = computeTask ? nullptr : std::make_shared<UniformCartesianDumper> (name, path);
+    auto postPl = computeTask ? nullptr : std::make_shared<UniformCartesianDumper> (name, path, parseCompression(compression));
 
     return { simPl, postPl };
 }
@@ -251,10 +262,11 @@ PairPlugin createDumpMeshPlugin(bool computeTask, const MirState *state, std::st
 }
 
 PairPlugin createDumpParticlesPlugin(bool computeTask, const MirState *state, std::string name, ParticleVector *pv, int dumpEvery,
-                                     const std::vector<std::string>& channelNames, std::string path)
+                                     const std::vector<std::string>& channelNames, std::string path,
+                                     const std::map<std::string, std::string>& compression)
 {
     auto simPl  = computeTask ? std::make_shared<ParticleSenderPlugin> (state, name, pv->getName(), dumpEvery, channelNames) : nullptr;
-    auto postPl = computeTask ? nullptr : std::make_shared<ParticleDumperPlugin> (name, path);
+    auto postPl = computeTask ? nullptr : std::make_shared<ParticleDumperPlugin> (name, path, parseCompression(compression));
 
     return { simPl, postPl };
 }
@@ -353,11 +365,24 @@ PairPlugin createImposeVelocityPlugin(bool computeTask,  const MirState *state,
     return { simPl, nullptr };
 }
 
+static MagneticDipoleInteractionsPlugin::Mode getMagneticDipoleMode(const std::string& mode)
+{
+    if (mode == "direct")
+        return MagneticDipoleInteractionsPlugin::Mode::Direct;
+    if (mode == "tree")
+        return MagneticDipoleInteractionsPlugin::Mode::Tree;
+
+    die("Unknown magnetic dipole interactions mode '%s'\n", mode.c_str());
+    return MagneticDipoleInteractionsPlugin::Mode::Direct;
+}
+
 PairPlugin createMagneticDipoleInteractionsPlugin(bool computeTask, const MirState *state, std::string name,
-                                                  RigidObjectVector *rov, real3 moment, real mu0, bool periodic)
+                                                  RigidObjectVector *rov, real3 moment, real mu0, bool periodic,
+                                                  const std::string& mode, real theta)
 {
     auto simPl = computeTask ?
-        std::make_shared<MagneticDipoleInteractionsPlugin>(state, name, rov->getName(), moment, mu0, periodic)
+        std::make_shared<MagneticDipoleInteractionsPlugin>(state, name, rov->getName(), moment, mu0, periodic,
+                                                           getMagneticDipoleMode(mode), theta)
         : nullptr;
 
     return { simPl, nullptr };
@@ -372,9 +397,11 @@ PairPlugin createMembraneExtraForcePlugin(bool computeTask, const MirState *stat
 }
 
 PairPlugin createMsdPlugin(bool computeTask, const MirState *state, std::string name, ParticleVector *pv,
-                           MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery, std::string path)
+                           MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery, std::string path,
+                           int numLevels, int blockLength)
 {
-    auto simPl  = computeTask ? std::make_shared<MsdPlugin> (state, name, pv->getName(), startTime, endTime, dumpEvery)
+    auto simPl  = computeTask ? std::make_shared<MsdPlugin> (state, name, pv->getName(), startTime, endTime, dumpEvery,
+                                                     numLevels, blockLength)
         : nullptr;
     auto postPl = computeTask ? nullptr : std::make_shared<MsdDumper> (name, path);
     return { simPl, postPl };
@@ -467,9 +494,11 @@ PairPlugin createRdfPlugin(bool computeTask, const MirState *state, std::string
 }
 
 PairPlugin createRmacfPlugin(bool computeTask, const MirState *state, std::string name, ChainVector *cv,
-                             MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery, std::string path)
+                             MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery, std::string path,
+                             int numLevels, int blockLength)
 {
-    auto simPl  = computeTask ? std::make_shared<RmacfPlugin> (state, name, cv->getName(), startTime, endTime, dumpEvery)
+    auto simPl  = computeTask ? std::make_shared<RmacfPlugin> (state, name, cv->getName(), startTime, endTime, dumpEvery,
+                                                     numLevels, blockLength)
         : nullptr;
     auto postPl = computeTask ? nullptr : std::make_shared<RmacfDumper> (name, path);
     return { simPl, postPl };
@@ -511,9 +540,11 @@ PairPlugin createTemperaturizePlugin(bool computeTask, const MirState *state, st
 }
 
 PairPlugin createVacfPlugin(bool computeTask, const MirState *state, std::string name, ParticleVector *pv,
-                            MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery, std::string path)
+                            MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery, std::string path,
+                            int numLevels, int blockLength)
 {
-    auto simPl  = computeTask ? std::make_shared<VacfPlugin> (state, name, pv->getName(), startTime, endTime, dumpEvery)
+    auto simPl  = computeTask ? std::make_shared<VacfPlugin> (state, name, pv->getName(), startTime, endTime, dumpEvery,
+                                                     numLevels, blockLength)
         : nullptr;
     auto postPl = computeTask ? nullptr : std::make_shared<VacfDumper> (name, path);
     return { simPl, postPl };
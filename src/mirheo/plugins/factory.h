@@ -11,6 +11,7 @@
 
 #include <array>
 #include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -71,20 +72,23 @@ PairPlugin createRateOutletPlugin(bool computeTask, const MirState *state, std::
 
 PairPlugin createDumpAveragePlugin(bool computeTask, const MirState *state, std::string name,
                                    std::vector<ParticleVector*> pvs, int sampleEvery, int dumpEvery,
-                                   real3 binSize, std::vector<std::string> channelNames, std::string path);
+                                   real3 binSize, std::vector<std::string> channelNames, std::string path,
+                                   const std::map<std::string, std::string>& compression);
 
 PairPlugin createDumpAverageRelativePlugin(bool computeTask, const MirState *state, std::string name,
                                            std::vector<ParticleVector*> pvs,
                                            ObjectVector* relativeToOV, int relativeToId,
                                            int sampleEvery, int dumpEvery, real3 binSize,
-                                           std::vector<std::string> channelNames, std::string path);
+                                           std::vector<std::string> channelNames, std::string path,
+                                           const std::map<std::string, std::string>& compression);
 
 PairPlugin createDumpMeshPlugin(bool computeTask, const MirState *state, std::string name,
                                 ObjectVector* ov, int dumpEvery, std::string path);
 
 PairPlugin createDumpParticlesPlugin(bool computeTask, const MirState *state, std::string name,
                                      ParticleVector *pv, int dumpEvery,
-                                     const std::vector<std::string>& channelNames, std::string path);
+                                     const std::vector<std::string>& channelNames, std::string path,
+                                     const std::map<std::string, std::string>& compression);
 
 PairPlugin createDumpParticlesWithMeshPlugin(bool computeTask, const MirState *state, std::string name,
                                              ObjectVector *ov, int dumpEvery,
@@ -120,12 +124,14 @@ PairPlugin createImposeVelocityPlugin(bool computeTask,  const MirState *state,
                                       real3 low, real3 high, real3 velocity);
 
 PairPlugin createMagneticDipoleInteractionsPlugin(bool computeTask, const MirState *state, std::string name,
-                                                  RigidObjectVector *rov, real3 moment, real mu0, bool periodic);
+                                                  RigidObjectVector *rov, real3 moment, real mu0, bool periodic,
+                                                  const std::string& mode, real theta);
 
 PairPlugin createMembraneExtraForcePlugin(bool computeTask, const MirState *state, std::string name, ParticleVector *pv, const std::vector<real3>& forces);
 
 PairPlugin createMsdPlugin(bool computeTask, const MirState *state, std::string name, ParticleVector *pv,
-                           MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery, std::string path);
+                           MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery, std::string path,
+                           int numLevels, int blockLength);
 
 PairPlugin createParticleChannelAveragerPlugin(bool computeTask, const MirState *state, std::string name, ParticleVector *pv,
                                                std::string channelName, std::string averageName, real updateEvery);
@@ -157,7 +163,8 @@ PairPlugin createVelocityControlPlugin(bool computeTask, const MirState *state,
 PairPlugin createRdfPlugin(bool computeTask, const MirState *state, std::string name, ParticleVector *pv, real maxDist, int nbins, std::string basename, int every);
 
 PairPlugin createRmacfPlugin(bool computeTask, const MirState *state, std::string name, ChainVector *cv,
-                             MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery, std::string path);
+                             MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery, std::string path,
+                             int numLevels, int blockLength);
 
 PairPlugin createShearFieldPlugin(bool computeTask, const MirState *state, std::string name, ParticleVector *pv,
                                   std::array<real,9> shear, real3 origin, std::string sfChannelName);
@@ -170,7 +177,8 @@ PairPlugin createStatsPlugin(bool computeTask, const MirState *state, std::strin
 PairPlugin createTemperaturizePlugin(bool computeTask, const MirState *state, std::string name, ParticleVector* pv, real kBT, bool keepVelocity);
 
 PairPlugin createVacfPlugin(bool computeTask, const MirState *state, std::string name, ParticleVector *pv,
-                            MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery, std::string path);
+                            MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery, std::string path,
+                            int numLevels, int blockLength);
 
 PairPlugin createVirialPressurePlugin(bool computeTask, const MirState *state, std::string name, ParticleVector *pv,
                                       std::function<real(real3)> region, real3 h, int dumpEvery, std::string path);
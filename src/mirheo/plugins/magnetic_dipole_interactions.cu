@@ -1,5 +1,6 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #include "magnetic_dipole_interactions.h"
+#include "utils/magnetic_dipoles.h"
 
 #include <mirheo/core/pvs/rigid_object_vector.h>
 #include <mirheo/core/pvs/views/rov.h>
@@ -9,6 +10,8 @@
 #include <mirheo/core/utils/quaternion.h>
 #include <mirheo/core/utils/mpi_types.h>
 
+#include <algorithm>
+#include <cmath>
 #include <mpi.h>
 
 namespace mirheo {
@@ -27,30 +30,6 @@ __global__ void collectRigidInfo(const DomainInfo domain, const ROVview view, re
     rigidPosQuat[2*gid + 1] = make_real4(m.q.w, m.q.x, m.q.y, m.q.z);
 }
 
-/** Compute the difference between two points.
-    If periodic, returns the smallest difference between two points in the periodic domain.
- */
-__device__ inline real3 difference(real3 a, real3 b, real3 L, bool periodic)
-{
-    real3 d = a - b;
-
-    if (periodic)
-    {
-        const real3 h = 0.5_r * L;
-
-        if (d.x < -h.x) d.x += L.x;
-        if (d.x >  h.x) d.x -= L.x;
-
-        if (d.y < -h.y) d.y += L.y;
-        if (d.y >  h.y) d.y -= L.y;
-
-        if (d.z < -h.z) d.z += L.z;
-        if (d.z >  h.z) d.z -= L.z;
-    }
-
-    return d;
-}
-
 __global__ void computeInteractions(const DomainInfo domain, ROVview view,
                                     int numSources,  const real4 *rigidPosQuat,
                                     real mu0_4pi, real3 moment, bool periodic)
@@ -73,26 +52,8 @@ __global__ void computeInteractions(const DomainInfo domain, ROVview view,
         const auto qsrc = Quaternion<real>::createFromComponents(rigidPosQuat[2*i+1]);
         const auto msrc = qsrc.rotate(moment);
 
-        const real3 dr = difference(rdst, rsrc, domain.globalSize, periodic);
-        const real r2 = dot(dr, dr);
-
-        if (r2 < 1e-6_r)
-            continue;
-
-
-        const real r = math::sqrt(r2);
-        const real3 er = dr / r;
-
-        const real forceFactor = 3 * mu0_4pi / (r2 * r2);
-        const real torqueFactor = mu0_4pi / (r2 * r);
-
-        const real3 erXmdst = cross(er, mdst);
-        const real3 erXmsrc = cross(er, msrc);
-
-        force += forceFactor * (cross(erXmdst, msrc) + cross(erXmsrc, mdst)
-                                - 2 * dot(mdst, msrc) * er + 5 * dot(erXmdst, erXmsrc) * er);
-
-        torque += torqueFactor * (3 * dot(mdst, er) * cross(msrc, er) - cross(mdst, msrc));
+        const real3 dr = magnetic_dipoles::difference(rdst, rsrc, domain.globalSize, periodic);
+        magnetic_dipoles::addInteraction(dr, mdst, msrc, mu0_4pi, force, torque);
     }
 
     atomicAdd(&view.motions[gid].torque.x, static_cast<RigidReal>(torque.x));
@@ -103,17 +64,53 @@ __global__ void computeInteractions(const DomainInfo domain, ROVview view,
     atomicAdd(&view.motions[gid].force.y, static_cast<RigidReal>(force.y));
     atomicAdd(&view.motions[gid].force.z, static_cast<RigidReal>(force.z));
 }
+
+__global__ void collectDipoles(const DomainInfo domain, const ROVview view, real3 moment,
+                               magnetic_dipoles::Dipole *dipoles)
+{
+    const int gid = blockIdx.x * blockDim.x + threadIdx.x;
+    if (gid >= view.nObjects) return;
+
+    const auto m = view.motions[gid];
+    const auto q = static_cast<Quaternion<real>>(m.q);
+
+    dipoles[gid].r = domain.local2global(make_real3(m.r.x, m.r.y, m.r.z));
+    dipoles[gid].m = q.rotate(moment);
+}
+
+__global__ void addForcesAndTorques(ROVview view, const real3 *forces, const real3 *torques)
+{
+    const int gid = blockIdx.x * blockDim.x + threadIdx.x;
+    if (gid >= view.nObjects) return;
+
+    const real3 f = forces[gid];
+    const real3 t = torques[gid];
+
+    atomicAdd(&view.motions[gid].torque.x, static_cast<RigidReal>(t.x));
+    atomicAdd(&view.motions[gid].torque.y, static_cast<RigidReal>(t.y));
+    atomicAdd(&view.motions[gid].torque.z, static_cast<RigidReal>(t.z));
+
+    atomicAdd(&view.motions[gid].force.x, static_cast<RigidReal>(f.x));
+    atomicAdd(&view.motions[gid].force.y, static_cast<RigidReal>(f.y));
+    atomicAdd(&view.motions[gid].force.z, static_cast<RigidReal>(f.z));
+}
 } // namespace magnetic_dipole_interactions_plugin_kernels
 
 MagneticDipoleInteractionsPlugin::MagneticDipoleInteractionsPlugin(const MirState *state, std::string name,
                                                                    std::string rovName,
-                                                                   real3 moment, real mu0, bool periodic) :
+                                                                   real3 moment, real mu0, bool periodic,
+                                                                   Mode mode, real theta) :
     SimulationPlugin(state, name),
     rovName_(rovName),
     moment_(moment),
     mu0_(mu0),
-    periodic_(periodic)
-{}
+    periodic_(periodic),
+    mode_(mode),
+    theta_(theta)
+{
+    if (theta_ < 0.0_r)
+        die("Plugin '%s': the opening angle must be non negative, got %g", getCName(), theta_);
+}
 
 void MagneticDipoleInteractionsPlugin::setup(Simulation *simulation, const MPI_Comm& comm, const MPI_Comm& interComm)
 {
@@ -126,9 +123,89 @@ void MagneticDipoleInteractionsPlugin::setup(Simulation *simulation, const MPI_C
 
     recvCounts_.resize(nranks_);
     recvDispls_.resize(nranks_ + 1);
+
+    if (mode_ == Mode::Tree)
+        setupNeighbours();
+}
+
+void MagneticDipoleInteractionsPlugin::setupNeighbours()
+{
+    int dims[3], periods[3], coords[3];
+    MPI_Check( MPI_Cart_get(comm_, 3, dims, periods, coords) );
+
+    std::vector<int> neighbours;
+    for (int dz = -1; dz <= 1; ++dz)
+    for (int dy = -1; dy <= 1; ++dy)
+    for (int dx = -1; dx <= 1; ++dx)
+    {
+        int coordsNeigh[3] = {coords[0] + dx, coords[1] + dy, coords[2] + dz};
+        bool exists = true;
+        for (int d = 0; d < 3; ++d)
+            exists &= periods[d] || (coordsNeigh[d] >= 0 && coordsNeigh[d] < dims[d]);
+
+        if (!exists)
+            continue;
+
+        int rank;
+        MPI_Check( MPI_Cart_rank(comm_, coordsNeigh, &rank) );
+        if (rank != rank_)
+            neighbours.push_back(rank);
+    }
+
+    // small decompositions see the same rank in several directions
+    std::sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+    isNearRank_.assign(nranks_, false);
+    isNearRank_[rank_] = true;
+    for (int r : neighbours)
+        isNearRank_[r] = true;
+
+    const int numNeighbours = static_cast<int>(neighbours.size());
+    constexpr int reorder = 0;
+    MPI_Check( MPI_Dist_graph_create_adjacent(comm_,
+                                              numNeighbours, neighbours.data(), MPI_UNWEIGHTED,
+                                              numNeighbours, neighbours.data(), MPI_UNWEIGHTED,
+                                              MPI_INFO_NULL, reorder, neighbourComm_.reset_and_get_address()) );
+
+    recvDipoleCounts_.resize(numNeighbours);
+    recvDipoleDispls_.resize(numNeighbours + 1);
+    recvClusterCounts_.resize(nranks_);
+    recvClusterDispls_.resize(nranks_ + 1);
+
+    // The other ranks are at least one subdomain away from any local object, and the clusters at depth d
+    // are at most 2^-d times as large as the subdomain: choose d so that they satisfy the opening criterion.
+    constexpr int maxSummaryDepth = 32;
+    const real3 h = getState()->domain.localSize;
+    const real hmin = std::min(h.x, std::min(h.y, h.z));
+    const real hmax = std::max(h.x, std::max(h.y, h.z));
+
+    if (theta_ > 0.0_r)
+        summaryDepth_ = std::min(maxSummaryDepth, std::max(0, static_cast<int>(std::ceil(std::log2(hmax / (hmin * theta_))))));
+    else
+        summaryDepth_ = maxSummaryDepth;
+
+    debug("Plugin '%s': tree mode with %d neighbouring ranks, summaries of depth %d",
+          getCName(), numNeighbours, summaryDepth_);
 }
 
 void MagneticDipoleInteractionsPlugin::beforeCellLists(cudaStream_t stream)
+{
+    if (mode_ == Mode::Direct)
+        collectDirect(stream);
+    else
+        collectTree(stream);
+}
+
+void MagneticDipoleInteractionsPlugin::beforeForces(cudaStream_t stream)
+{
+    if (mode_ == Mode::Direct)
+        computeDirect(stream);
+    else
+        computeTree(stream);
+}
+
+void MagneticDipoleInteractionsPlugin::collectDirect(cudaStream_t stream)
 {
     const ROVview view(rov_, rov_->local());
     const int nthreads = 64;
@@ -173,7 +250,7 @@ void MagneticDipoleInteractionsPlugin::beforeCellLists(cudaStream_t stream)
 
 }
 
-void MagneticDipoleInteractionsPlugin::beforeForces(cudaStream_t stream)
+void MagneticDipoleInteractionsPlugin::computeDirect(cudaStream_t stream)
 {
     MPI_Wait(&reqObjInfo_, MPI_STATUS_IGNORE);
     recvRigidPosQuat_.uploadToDevice(stream);
@@ -193,4 +270,117 @@ void MagneticDipoleInteractionsPlugin::beforeForces(cudaStream_t stream)
             periodic_);
 }
 
+static void computeDisplacements(const std::vector<int>& counts, std::vector<int>& displs)
+{
+    displs[0] = 0;
+    for (size_t i = 0; i < counts.size(); ++i)
+        displs[i+1] = displs[i] + counts[i];
+}
+
+void MagneticDipoleInteractionsPlugin::collectTree(cudaStream_t stream)
+{
+    using magnetic_dipoles::Dipole;
+    using magnetic_dipoles::DipoleCluster;
+
+    const ROVview view(rov_, rov_->local());
+    const int nthreads = 64;
+
+    // share the number of objects with the neighbouring ranks while the tree is built
+    sendDipoleBytes_ = view.nObjects * static_cast<int>(sizeof(Dipole));
+    MPI_Check( MPI_Ineighbor_allgather(&sendDipoleBytes_, 1, MPI_INT,
+                                       recvDipoleCounts_.data(), 1, MPI_INT,
+                                       neighbourComm_, &reqDipoleCounts_) );
+
+    const auto domain = getState()->domain;
+    localDipoles_.resize_anew(view.nObjects);
+
+    SAFE_KERNEL_LAUNCH(
+        magnetic_dipole_interactions_plugin_kernels::collectDipoles,
+        getNblocks(view.nObjects, nthreads), nthreads, 0, stream,
+        domain, view, moment_, localDipoles_.devPtr());
+
+    localDipoles_.downloadFromDevice(stream, ContainersSynch::Synch);
+
+    localTree_.build(std::vector<Dipole>(localDipoles_.begin(), localDipoles_.end()));
+    sendClusters_ = localTree_.getClusters(summaryDepth_);
+
+    // share the number of summaries with all ranks; the summaries are sent in beforeForces,
+    // so that this exchange overlaps with the cell-lists build
+
+    sendClusterBytes_ = static_cast<int>(sendClusters_.size() * sizeof(DipoleCluster));
+    MPI_Check( MPI_Iallgather(&sendClusterBytes_, 1, MPI_INT,
+                              recvClusterCounts_.data(), 1, MPI_INT,
+                              comm_, &reqClusterCounts_) );
+
+    // send the objects to the neighbouring ranks
+
+    MPI_Check( MPI_Wait(&reqDipoleCounts_, MPI_STATUS_IGNORE) );
+    computeDisplacements(recvDipoleCounts_, recvDipoleDispls_);
+    recvDipoles_.resize(recvDipoleDispls_.back() / sizeof(Dipole));
+
+    MPI_Check( MPI_Ineighbor_allgatherv(localDipoles_.data(), sendDipoleBytes_, MPI_BYTE,
+                                        recvDipoles_.data(), recvDipoleCounts_.data(), recvDipoleDispls_.data(), MPI_BYTE,
+                                        neighbourComm_, &reqDipoles_) );
+}
+
+void MagneticDipoleInteractionsPlugin::computeTree(cudaStream_t stream)
+{
+    using magnetic_dipoles::Dipole;
+    using magnetic_dipoles::DipoleCluster;
+
+    // send the summaries to all ranks
+
+    MPI_Check( MPI_Wait(&reqClusterCounts_, MPI_STATUS_IGNORE) );
+    computeDisplacements(recvClusterCounts_, recvClusterDispls_);
+    recvClusters_.resize(recvClusterDispls_.back() / sizeof(DipoleCluster));
+
+    MPI_Check( MPI_Iallgatherv(sendClusters_.data(), sendClusterBytes_, MPI_BYTE,
+                               recvClusters_.data(), recvClusterCounts_.data(), recvClusterDispls_.data(), MPI_BYTE,
+                               comm_, &reqClusters_) );
+
+    // build the tree of the near objects while the summaries travel
+
+    MPI_Check( MPI_Wait(&reqDipoles_, MPI_STATUS_IGNORE) );
+
+    const std::vector<Dipole> targets(localDipoles_.begin(), localDipoles_.end());
+
+    std::vector<Dipole> nearDipoles = targets;
+    nearDipoles.insert(nearDipoles.end(), recvDipoles_.begin(), recvDipoles_.end());
+    nearTree_.build(std::move(nearDipoles));
+
+    MPI_Check( MPI_Wait(&reqClusters_, MPI_STATUS_IGNORE) );
+
+    farClusters_.clear();
+    for (int r = 0; r < nranks_; ++r)
+    {
+        if (isNearRank_[r])
+            continue;
+        const auto first = recvClusters_.begin() + recvClusterDispls_[r  ] / sizeof(DipoleCluster);
+        const auto last  = recvClusters_.begin() + recvClusterDispls_[r+1] / sizeof(DipoleCluster);
+        farClusters_.insert(farClusters_.end(), first, last);
+    }
+
+    const auto domain = getState()->domain;
+    const magnetic_dipoles::SumParameters params {static_cast<real>(mu0_ / (4 * M_PI)), theta_,
+                                                  domain.globalSize, periodic_};
+
+    const int n = static_cast<int>(targets.size());
+    forces_ .resize_anew(n);
+    torques_.resize_anew(n);
+
+    magnetic_dipoles::computeInteractions(targets, nearTree_, farClusters_, params,
+                                          forces_.hostPtr(), torques_.hostPtr());
+
+    forces_ .uploadToDevice(stream);
+    torques_.uploadToDevice(stream);
+
+    ROVview view(rov_, rov_->local());
+    const int nthreads = 128;
+
+    SAFE_KERNEL_LAUNCH(
+            magnetic_dipole_interactions_plugin_kernels::addForcesAndTorques,
+            getNblocks(view.nObjects, nthreads), nthreads, 0, stream,
+            view, forces_.devPtr(), torques_.devPtr());
+}
+
 } // namespace mirheo
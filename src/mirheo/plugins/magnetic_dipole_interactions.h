@@ -1,8 +1,11 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #pragma once
 
+#include "utils/dipole_tree.h"
+
 #include <mirheo/core/containers.h>
 #include <mirheo/core/plugins.h>
+#include <mirheo/core/utils/unique_mpi_comm.h>
 
 #include <string>
 #include <vector>
@@ -14,10 +17,23 @@ class RigidObjectVector;
 
 /** Compute the magnetic dipole-dipole forces and torques induced by the
     interactions between rigid objects that have a magnetic moment.
+
+    Two summation methods are available:
+    - Mode::Direct: every rank gathers all objects and sums all pairs on the GPU, in O(N^2).
+    - Mode::Tree: the objects of the neighbouring ranks are exchanged and summed on the host with a
+      Barnes-Hut tree, in O(N log N). The other ranks only send a summary of their objects, made of the
+      clusters of their tree that satisfy the opening criterion from any point outside the neighbouring
+      ranks. The accuracy is controlled by the opening angle theta; theta = 0 is equivalent to the direct sum.
  */
 class MagneticDipoleInteractionsPlugin : public SimulationPlugin
 {
 public:
+    /// Summation method of the interactions
+    enum class Mode
+    {
+        Direct, ///< all pairs, all objects gathered on every rank
+        Tree    ///< Barnes-Hut tree, objects of neighbouring ranks and clusters of the other ranks
+    };
 
     /** Create a MagneticDipoleInteractionsPlugin object.
         \param [in] state The global state of the simulation.
@@ -26,10 +42,13 @@ public:
         \param [in] moment The constant magnetic moment of one object, in its frame of reference.
         \param [in] mu0 The magnetic permeability of the medium.
         \param [in] periodic If true, computes interactions with the closest periodic image of the objects
+        \param [in] mode The summation method.
+        \param [in] theta The opening angle of the tree (only used with Mode::Tree).
      */
      MagneticDipoleInteractionsPlugin(const MirState *state, std::string name,
                                       std::string rovName,
-                                      real3 moment, real mu0, bool periodic);
+                                      real3 moment, real mu0, bool periodic,
+                                      Mode mode = Mode::Direct, real theta = 0.5_r);
 
     void setup(Simulation* simulation, const MPI_Comm& comm, const MPI_Comm& interComm) override;
 
@@ -38,12 +57,21 @@ public:
 
     bool needPostproc() override { return false; }
 
+private:
+    void setupNeighbours();
+    void collectDirect(cudaStream_t stream);
+    void collectTree(cudaStream_t stream);
+    void computeDirect(cudaStream_t stream);
+    void computeTree(cudaStream_t stream);
+
 private:
     std::string rovName_;
     RigidObjectVector *rov_;
     real3 moment_;
     real mu0_;
     bool periodic_;
+    Mode mode_;
+    real theta_;
 
     PinnedBuffer<real4> sendRigidPosQuat_;
     PinnedBuffer<real4> recvRigidPosQuat_;
@@ -51,6 +79,28 @@ private:
     std::vector<int> recvDispls_;
 
     MPI_Request reqObjInfo_;
+
+    // tree mode
+    UniqueMPIComm neighbourComm_;   ///< graph communicator over the neighbouring ranks
+    std::vector<bool> isNearRank_;  ///< true for the current rank and its neighbours
+    int summaryDepth_ {0};          ///< depth of the clusters sent to the other ranks
+
+    PinnedBuffer<magnetic_dipoles::Dipole> localDipoles_;
+    std::vector<magnetic_dipoles::Dipole> recvDipoles_;
+    int sendDipoleBytes_ {0};
+    std::vector<int> recvDipoleCounts_, recvDipoleDispls_;
+
+    magnetic_dipoles::DipoleTree localTree_, nearTree_;
+    std::vector<magnetic_dipoles::DipoleCluster> sendClusters_, recvClusters_, farClusters_;
+    int sendClusterBytes_ {0};
+    std::vector<int> recvClusterCounts_, recvClusterDispls_;
+
+    PinnedBuffer<real3> forces_, torques_;
+
+    MPI_Request reqDipoleCounts_;
+    MPI_Request reqDipoles_;
+    MPI_Request reqClusterCounts_;
+    MPI_Request reqClusters_;
 };
 
 } // namespace mirheo
@@ -45,6 +45,15 @@ __global__ void updatePositionsAndDisplacements(PVview view, real4 *prevPosition
     prevPositions[i] = r1;
 }
 
+__global__ void extractDisplacements(PVview view, const real4 *totalDisplacements, real3 *displacements, int64_t *ids)
+{
+    const int i = blockIdx.x * blockDim.x + threadIdx.x;
+    if (i >= view.size) return;
+
+    displacements[i] = Real3_int(totalDisplacements[i]).v;
+    ids[i] = view.readParticle(i).getId();
+}
+
 __global__ void computeLocalMsd(int n, const real4 *totalDisplacements, msd_plugin::ReductionType *dispSum)
 {
     const int i = blockIdx.x * blockDim.x + threadIdx.x;
@@ -64,12 +73,15 @@ __global__ void computeLocalMsd(int n, const real4 *totalDisplacements, msd_plug
 } // namespace msd_kernels
 
 MsdPlugin::MsdPlugin(const MirState *state, std::string name, std::string pvName,
-                       MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery) :
+                       MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery,
+                       int numLevels, int blockLength) :
     SimulationPlugin(state, name),
     pvName_(pvName),
     startTime_(startTime),
     endTime_(endTime),
-    dumpEvery_(dumpEvery)
+    dumpEvery_(dumpEvery),
+    numLevels_(numLevels),
+    blockLength_(blockLength)
 {}
 
 MsdPlugin::~MsdPlugin() = default;
@@ -85,12 +97,21 @@ void MsdPlugin::setup(Simulation *simulation, const MPI_Comm& comm, const MPI_Co
     pv_->requireDataPerParticle<real4>(previousPositionChannelName_, DataManager::PersistenceMode::Active, DataManager::ShiftMode::Active);
     pv_->requireDataPerParticle<real4>(totalDisplacementChannelName_, DataManager::PersistenceMode::Active);
 
+    if (numLevels_ > 0)
+    {
+        correlator_ = std::make_unique<MultipleTauCorrelator<multiple_tau::SquaredDifference>>
+            (multiple_tau::Layout(numLevels_, blockLength_), multiple_tau::CoarseGraining::Subsample,
+             this->getName() + "_mtau");
+        correlator_->requireDataPerParticle(pv_);
+    }
+
     info("Plugin %s initialized for the following particle vector: %s", getCName(), pvName_.c_str());
 }
 
 void MsdPlugin::handshake()
 {
-    SimpleSerializer::serialize(sendBuffer_, pvName_);
+    const bool multipleTau = correlator_ != nullptr;
+    SimpleSerializer::serialize(sendBuffer_, pvName_, multipleTau);
     _send(sendBuffer_);
 }
 
@@ -120,6 +141,33 @@ void MsdPlugin::afterIntegration(cudaStream_t stream)
         startStep_ = currentStep;
     }
 
+    if (correlator_)
+    {
+        // the correlator needs the displacements at every step
+        SAFE_KERNEL_LAUNCH(
+            msd_kernels::updatePositionsAndDisplacements,
+            nblocks, nthreads, 0, stream,
+            view, xPrev->devPtr(), disp->devPtr());
+
+        samples_.resize_anew(view.size);
+        sampleIds_.resize_anew(view.size);
+
+        SAFE_KERNEL_LAUNCH(
+            msd_kernels::extractDisplacements,
+            nblocks, nthreads, 0, stream,
+            view, disp->devPtr(), samples_.devPtr(), sampleIds_.devPtr());
+
+        correlator_->addSamples(view.size, sampleIds_.devPtr(), samples_.devPtr(),
+                                pv_->local()->dataPerParticle, stream);
+
+        if ((currentStep - startStep_) % dumpEvery_ == 0)
+        {
+            correlator_->downloadSums(stream);
+            needToSend_ = true;
+        }
+        return;
+    }
+
     if ((currentStep - startStep_) % dumpEvery_ != 0)
         return;
 
@@ -151,7 +199,16 @@ void MsdPlugin::serializeAndSend(__UNUSED cudaStream_t stream)
     debug2("Plugin %s is sending now data", getCName());
 
     _waitPrevSend();
-    SimpleSerializer::serialize(sendBuffer_, savedTime_, localMsd_[0], nparticles_);
+    if (correlator_)
+    {
+        const auto& sums = correlator_->getSums();
+        SimpleSerializer::serialize(sendBuffer_, correlator_->getLagTimes(getState()->getDt()),
+                                    std::vector<double>(sums.begin(), sums.end()), correlator_->getCounts());
+    }
+    else
+    {
+        SimpleSerializer::serialize(sendBuffer_, savedTime_, localMsd_[0], nparticles_);
+    }
     _send(sendBuffer_);
 
     needToSend_ = false;
@@ -177,9 +234,12 @@ void MsdDumper::handshake()
     recv();
 
     std::string pvName;
-    SimpleSerializer::deserialize(data_, pvName);
+    SimpleSerializer::deserialize(data_, pvName, multipleTau_);
 
-    if (activated_ && fdump_.get() == nullptr)
+    // with the multiple-tau correlator, the whole file is rewritten at every dump
+    if (multipleTau_)
+        fname_ = joinPaths(path_, setExtensionOrDie(pvName, "csv"));
+    else if (activated_ && fdump_.get() == nullptr)
     {
         auto fname = joinPaths(path_, setExtensionOrDie(pvName, "csv"));
         auto status = fdump_.open(fname, "w");
@@ -191,6 +251,18 @@ void MsdDumper::handshake()
 
 void MsdDumper::deserialize()
 {
+    if (multipleTau_)
+    {
+        std::vector<MirState::TimeType> lagTimes;
+        std::vector<double> localSums;
+        std::vector<long> localCounts;
+        SimpleSerializer::deserialize(data_, lagTimes, localSums, localCounts);
+
+        if (activated_)
+            multiple_tau::dumpCorrelations(comm_, fname_, "time,msd", lagTimes, {localSums}, localCounts);
+        return;
+    }
+
     MirState::TimeType curTime;
     msd_plugin::ReductionType localMsd, totalMsd;
     long localNumParticles, totalNumParticles;
@@ -1,10 +1,14 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #pragma once
 
+#include "utils/multiple_tau_correlator.h"
+
 #include <mirheo/core/containers.h>
 #include <mirheo/core/plugins.h>
 #include <mirheo/core/utils/file_wrapper.h>
 
+#include <memory>
+
 namespace mirheo
 {
 
@@ -21,6 +25,11 @@ using ReductionType = double;
 
     Each particle stores the total displacement from startTime.
     To compute this, it also stores its position at each step.
+
+    By default, the only time origin is startTime.
+    With a positive number of levels, the displacements are sampled at every step by a multiple-tau correlator
+    (see multiple_tau) that uses all time origins; the current estimate of the MSD is then sent every dumpEvery steps.
+    The levels are subsampled rather than averaged, so that the displacements at long lags are exact.
  */
 class MsdPlugin : public SimulationPlugin
 {
@@ -32,9 +41,12 @@ public:
         \param [in] startTime MSD will use this time as origin.
         \param [in] endTime The MSD will be reported only on [startTime, endTime].
         \param [in] dumpEvery Will send the MSD to the postprocess side every this number of steps, only during the valid time interval.
+        \param [in] numLevels Number of levels of the multiple-tau correlator; 0 to only use startTime as time origin.
+        \param [in] blockLength Number of lags per level of the multiple-tau correlator.
     */
     MsdPlugin(const MirState *state, std::string name, std::string pvName,
-              MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery);
+              MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery,
+              int numLevels = 0, int blockLength = 16);
 
     ~MsdPlugin();
 
@@ -63,6 +75,12 @@ private:
 
     std::string previousPositionChannelName_;  ///< Name of the channel that will contain the previous positions of the particles
     std::string totalDisplacementChannelName_; ///< Name of the channel that will contain the total displacements of the particles
+
+    int numLevels_;
+    int blockLength_;
+    std::unique_ptr<MultipleTauCorrelator<multiple_tau::SquaredDifference>> correlator_; ///< nullptr if only startTime is a time origin
+    DeviceBuffer<real3> samples_;
+    DeviceBuffer<int64_t> sampleIds_;
 };
 
 
@@ -86,6 +104,8 @@ private:
     std::string path_;
 
     bool activated_ = true;
+    bool multipleTau_ {false};
+    std::string fname_; ///< the csv file, rewritten at every dump with the multiple-tau correlator
     FileWrapper fdump_;
 };
 
@@ -72,12 +72,15 @@ __global__ void computeLocalRmacf(OVview view, int p, const real3 *rouse_modes_t
 } // namespace rmacf_kernels
 
 RmacfPlugin::RmacfPlugin(const MirState *state, std::string name, std::string cvName,
-                         MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery) :
+                         MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery,
+                         int numLevels, int blockLength) :
     SimulationPlugin(state, name),
     cvName_(cvName),
     startTime_(startTime),
     endTime_(endTime),
-    dumpEvery_(dumpEvery)
+    dumpEvery_(dumpEvery),
+    numLevels_(numLevels),
+    blockLength_(blockLength)
 {}
 
 RmacfPlugin::~RmacfPlugin() = default;
@@ -95,8 +98,19 @@ void RmacfPlugin::setup(Simulation *simulation, const MPI_Comm& comm, const MPI_
 
     for (int p = 1; p < cv_->getObjectSize(); ++p)
     {
-        cv_->requireDataPerObject<real3>(_channelName(p), DataManager::PersistenceMode::Active);
-        localRmacf_.emplace_back(1);
+        if (numLevels_ > 0)
+        {
+            correlators_.push_back(std::make_unique<MultipleTauCorrelator<multiple_tau::Product>>
+                                   (multiple_tau::Layout(numLevels_, blockLength_),
+                                    multiple_tau::CoarseGraining::Average,
+                                    _channelName(p) + "_mtau"));
+            correlators_.back()->requireDataPerObject(cv_);
+        }
+        else
+        {
+            cv_->requireDataPerObject<real3>(_channelName(p), DataManager::PersistenceMode::Active);
+            localRmacf_.emplace_back(1);
+        }
     }
 
     info("Plugin %s initialized for the following chain vector: %s", getCName(), cvName_.c_str());
@@ -105,7 +119,8 @@ void RmacfPlugin::setup(Simulation *simulation, const MPI_Comm& comm, const MPI_
 void RmacfPlugin::handshake()
 {
     const int numModes = cv_->getObjectSize() - 1;
-    SimpleSerializer::serialize(sendBuffer_, cvName_, numModes);
+    const bool multipleTau = !correlators_.empty();
+    SimpleSerializer::serialize(sendBuffer_, cvName_, numModes, multipleTau);
     _send(sendBuffer_);
 }
 
@@ -119,6 +134,36 @@ void RmacfPlugin::afterIntegration(cudaStream_t stream)
 
     OVview view(cv_, cv_->local());
 
+    if (!correlators_.empty())
+    {
+        if (startStep_ < 0)
+            startStep_ = currentStep;
+
+        samples_.resize_anew(view.nObjects);
+
+        for (int p = 1; p < cv_->getObjectSize(); ++p)
+        {
+            constexpr int nthreads = 128;
+            const int nblocks = getNblocks(view.nObjects, nthreads);
+
+            SAFE_KERNEL_LAUNCH(
+                rmacf_kernels::computeRouseMode,
+                nblocks, nthreads, 0, stream,
+                view, p, samples_.devPtr());
+
+            correlators_[p-1]->addSamples(view.nObjects, view.ids, samples_.devPtr(),
+                                          cv_->local()->dataPerObject, stream);
+        }
+
+        if ((currentStep - startStep_) % dumpEvery_ == 0)
+        {
+            for (auto& correlator : correlators_)
+                correlator->downloadSums(stream);
+            needToSend_ = true;
+        }
+        return;
+    }
+
     if (startStep_ < 0)
     {
         for (int p = 1; p < cv_->getObjectSize(); ++p)
@@ -168,6 +213,24 @@ void RmacfPlugin::serializeAndSend(__UNUSED cudaStream_t stream)
     if (!needToSend_)
         return;
 
+    if (!correlators_.empty())
+    {
+        std::vector<std::vector<double>> sums;
+        for (const auto& correlator : correlators_)
+            sums.emplace_back(correlator->getSums().begin(), correlator->getSums().end());
+
+        debug2("Plugin %s is now sending data", getCName());
+
+        // all modes are sampled together, hence share the lags and counts
+        _waitPrevSend();
+        SimpleSerializer::serialize(sendBuffer_, correlators_[0]->getLagTimes(getState()->getDt()),
+                                    sums, correlators_[0]->getCounts());
+        _send(sendBuffer_);
+
+        needToSend_ = false;
+        return;
+    }
+
     std::vector<rmacf_plugin::ReductionType> rmacf(localRmacf_.size());
 
     for (size_t i = 0; i < rmacf.size(); ++i)
@@ -207,9 +270,12 @@ void RmacfDumper::handshake()
     recv();
 
     std::string cvName;
-    SimpleSerializer::deserialize(data_, cvName, numModes_);
+    SimpleSerializer::deserialize(data_, cvName, numModes_, multipleTau_);
 
-    if (activated_ && fdump_.get() == nullptr)
+    // with the multiple-tau correlators, the whole file is rewritten at every dump
+    if (multipleTau_)
+        fname_ = joinPaths(path_, setExtensionOrDie(cvName, "csv"));
+    else if (activated_ && fdump_.get() == nullptr)
     {
         auto fname = joinPaths(path_, setExtensionOrDie(cvName, "csv"));
         auto status = fdump_.open(fname, "w");
@@ -228,6 +294,22 @@ void RmacfDumper::handshake()
 
 void RmacfDumper::deserialize()
 {
+    if (multipleTau_)
+    {
+        std::vector<MirState::TimeType> lagTimes;
+        std::vector<std::vector<double>> localSums;
+        std::vector<long> localCounts;
+        SimpleSerializer::deserialize(data_, lagTimes, localSums, localCounts);
+
+        std::string header = "time";
+        for (int p = 1; p <= numModes_; ++p)
+            header += ",rmacf" + std::to_string(p);
+
+        if (activated_)
+            multiple_tau::dumpCorrelations(comm_, fname_, header, lagTimes, localSums, localCounts);
+        return;
+    }
+
     MirState::TimeType curTime;
     std::vector<rmacf_plugin::ReductionType> localRmacf(numModes_, 0.0);
     auto totalRmacf = localRmacf;
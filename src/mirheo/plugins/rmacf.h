@@ -1,10 +1,14 @@
 // Copyright 2022 ETH Zurich. All Rights Reserved.
 #pragma once
 
+#include "utils/multiple_tau_correlator.h"
+
 #include <mirheo/core/containers.h>
 #include <mirheo/core/plugins.h>
 #include <mirheo/core/utils/file_wrapper.h>
 
+#include <memory>
+
 namespace mirheo {
 
 class ChainVector;
@@ -16,6 +20,10 @@ using ReductionType = double;
 
 /** Compute the Rouse modes autocorrelation function (RMACF) of a given ChainVector.
     The RMACF is computed every dumpEvery steps on the time interval [startTime, endTime].
+
+    By default, the only time origin is startTime.
+    With a positive number of levels, the Rouse modes are sampled at every step by one multiple-tau correlator per mode
+    (see multiple_tau) that uses all time origins; the current estimate of the RMACF is then sent every dumpEvery steps.
  */
 class RmacfPlugin : public SimulationPlugin
 {
@@ -27,9 +35,12 @@ public:
         \param [in] startTime RMACF will use this time as origin.
         \param [in] endTime The RMACF will be reported only on [startTime, endTime].
         \param [in] dumpEvery Will send the RMACF to the postprocess side every this number of steps, only during the valid time interval.
+        \param [in] numLevels Number of levels of the multiple-tau correlators; 0 to only use startTime as time origin.
+        \param [in] blockLength Number of lags per level of the multiple-tau correlators.
     */
     RmacfPlugin(const MirState *state, std::string name, std::string cvName,
-                MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery);
+                MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery,
+                int numLevels = 0, int blockLength = 16);
 
     ~RmacfPlugin();
 
@@ -59,6 +70,11 @@ private:
     std::vector<char> sendBuffer_;
 
     ChainVector *cv_{nullptr};
+
+    int numLevels_;
+    int blockLength_;
+    std::vector<std::unique_ptr<MultipleTauCorrelator<multiple_tau::Product>>> correlators_; ///< one per mode; empty if only startTime is a time origin
+    DeviceBuffer<real3> samples_;
 };
 
 
@@ -83,6 +99,8 @@ private:
 
     int numModes_{0};
     bool activated_ = true;
+    bool multipleTau_ {false};
+    std::string fname_; ///< the csv file, rewritten at every dump with the multiple-tau correlators
     FileWrapper fdump_;
 };
 
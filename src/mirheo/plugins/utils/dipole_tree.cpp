@@ -0,0 +1,308 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "dipole_tree.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace mirheo
+{
+
+namespace magnetic_dipoles
+{
+
+// beyond that depth the dipoles are (almost) at the same position and are kept in one leaf
+static constexpr int maxDepth = 32;
+
+static inline bool isInside(real3 r, real3 lo, real3 hi)
+{
+    return lo.x <= r.x && r.x <= hi.x &&
+           lo.y <= r.y && r.y <= hi.y &&
+           lo.z <= r.z && r.z <= hi.z;
+}
+
+static inline real3 matVec(const real Q[9], real3 v)
+{
+    return {Q[0] * v.x + Q[1] * v.y + Q[2] * v.z,
+            Q[3] * v.x + Q[4] * v.y + Q[5] * v.z,
+            Q[6] * v.x + Q[7] * v.y + Q[8] * v.z};
+}
+
+static inline real3 vecMat(real3 v, const real Q[9])
+{
+    return {v.x * Q[0] + v.y * Q[3] + v.z * Q[6],
+            v.x * Q[1] + v.y * Q[4] + v.z * Q[7],
+            v.x * Q[2] + v.y * Q[5] + v.z * Q[8]};
+}
+
+void addClusterInteraction(real3 dr, real3 mdst, const DipoleCluster& cluster, real mu0_4pi,
+                           real3& force, real3& torque)
+{
+    if (cluster.size == 0.0_r)
+    {
+        addInteraction(dr, mdst, cluster.m, mu0_4pi, force, torque);
+        return;
+    }
+
+    // B_a = k (M_b d_ab G - Q_bc d_abc G) and F_d = m_a d_d B_a, with G = 1/|dr|:
+    // the tensors of derivatives of G are contracted analytically.
+    // The pair torque of addInteraction() is k A(dr) x m_src, with A = -3 (m.x) x / r^5 - m / r^3;
+    // it is expanded to the same order: k (A x M - eps_kab (d_c A_a) Q_bc).
+    const real3 x = dr;
+    const real3 M = cluster.m;
+    const real3 m = mdst;
+    const real* Q = cluster.Q;
+
+    const real r2 = dot(x, x);
+    const real ir2 = 1.0_r / r2;
+    const real ir3 = ir2 / math::sqrt(r2);
+    const real ir5 = ir3 * ir2;
+    const real ir7 = ir5 * ir2;
+    const real ir9 = ir7 * ir2;
+
+    const real trQ = Q[0] + Q[4] + Q[8];
+    const real3 Qx = matVec(Q, x);
+    const real3 xQ = vecMat(x, Q);
+    const real3 Qm = matVec(Q, m);
+    const real3 mQ = vecMat(m, Q);
+    const real xQx = dot(x, Qx);
+    const real xQm = dot(x, Qm);
+    const real mQx = dot(m, Qx);
+
+    const real mx = dot(m, x);
+    const real Mx = dot(M, x);
+
+
+    const real3 fM = (-15 * mx * Mx * ir7) * x + (3 * ir5) * (mx * M + Mx * m + dot(m, M) * x);
+
+    const real3 fQ = (105 * mx * xQx * ir9) * x
+        - (15 * ir7) * (mx * xQ + mx * Qx + (mx * trQ + xQm + mQx) * x + xQx * m)
+        + (3 * ir5) * (mQ + Qm + trQ * m);
+
+    const real3 A = (-3 * mx * ir5) * x - ir3 * m;
+    const real3 q {Q[5] - Q[7], Q[6] - Q[2], Q[1] - Q[3]};
+
+    const real3 tQ = (3 * ir5) * (cross(m, Qx) - cross(x, Qm) + mx * q)
+        + (15 * mx * ir7) * cross(x, Qx);
+
+    force  += mu0_4pi * (fM - fQ);
+    torque += mu0_4pi * (cross(A, M) - tQ);
+}
+
+DipoleTree::DipoleTree(int leafSize) :
+    leafSize_(std::max(leafSize, 1))
+{}
+
+void DipoleTree::build(std::vector<Dipole> dipoles)
+{
+    dipoles_ = std::move(dipoles);
+    work_.resize(dipoles_.size());
+    nodes_.clear();
+
+    if (!dipoles_.empty())
+        buildNode(0, static_cast<int>(dipoles_.size()), 0);
+}
+
+int DipoleTree::getNumDipoles() const
+{
+    return static_cast<int>(dipoles_.size());
+}
+
+int DipoleTree::buildNode(int start, int end, int depth)
+{
+    const int id = static_cast<int>(nodes_.size());
+    nodes_.emplace_back();
+
+    real3 lo = dipoles_[start].r;
+    real3 hi = dipoles_[start].r;
+    real3 sumr = make_real3(0.0_r);
+    real3 summ = make_real3(0.0_r);
+
+    for (int i = start; i < end; ++i)
+    {
+        const auto& d = dipoles_[i];
+        lo = make_real3(std::min(lo.x, d.r.x), std::min(lo.y, d.r.y), std::min(lo.z, d.r.z));
+        hi = make_real3(std::max(hi.x, d.r.x), std::max(hi.y, d.r.y), std::max(hi.z, d.r.z));
+        sumr += d.r;
+        summ += d.m;
+    }
+
+    const real3 extent = hi - lo;
+    const real size = std::max(extent.x, std::max(extent.y, extent.z));
+    const int n = end - start;
+    const real3 center = sumr / static_cast<real>(n);
+
+    Node node;
+    node.cluster.r = center;
+    node.cluster.m = summ;
+    node.cluster.size = size;
+    std::fill(node.cluster.Q, node.cluster.Q + 9, 0.0_r);
+
+    for (int i = start; i < end; ++i)
+    {
+        const auto& d = dipoles_[i];
+        const real3 dr = d.r - center;
+        const real m[3]  {d.m.x, d.m.y, d.m.z};
+        const real rr[3] {dr.x, dr.y, dr.z};
+        for (int a = 0; a < 3; ++a)
+            for (int b = 0; b < 3; ++b)
+                node.cluster.Q[3*a + b] += m[a] * rr[b];
+    }
+
+    node.lo = lo;
+    node.hi = hi;
+    node.start = start;
+    node.end = end;
+    node.isLeaf = n <= leafSize_ || depth >= maxDepth || size == 0.0_r;
+    std::fill(node.children, node.children + 8, noChild);
+    nodes_[id] = node;
+
+    if (node.isLeaf)
+        return id;
+
+    // sort the dipoles by octant of the bounding box
+    const real3 mid = 0.5_r * (lo + hi);
+    auto getOctant = [mid](real3 r)
+    {
+        return (r.x >= mid.x ? 1 : 0) + (r.y >= mid.y ? 2 : 0) + (r.z >= mid.z ? 4 : 0);
+    };
+
+    int octantStarts[9] = {0};
+    for (int i = start; i < end; ++i)
+        ++octantStarts[getOctant(dipoles_[i].r) + 1];
+
+    octantStarts[0] = start;
+    for (int o = 0; o < 8; ++o)
+        octantStarts[o+1] += octantStarts[o];
+
+    int offsets[8];
+    std::copy(octantStarts, octantStarts + 8, offsets);
+    for (int i = start; i < end; ++i)
+        work_[offsets[getOctant(dipoles_[i].r)]++] = dipoles_[i];
+
+    std::copy(work_.begin() + start, work_.begin() + end, dipoles_.begin() + start);
+
+    for (int o = 0; o < 8; ++o)
+    {
+        if (octantStarts[o] == octantStarts[o+1])
+            continue;
+        const int child = buildNode(octantStarts[o], octantStarts[o+1], depth + 1);
+        nodes_[id].children[o] = child;
+    }
+
+    return id;
+}
+
+std::vector<DipoleCluster> DipoleTree::getClusters(int depth) const
+{
+    std::vector<DipoleCluster> clusters;
+
+    if (nodes_.empty())
+        return clusters;
+
+    std::vector<std::pair<int,int>> stack; // node id, depth
+    stack.push_back({0, 0});
+
+    while (!stack.empty())
+    {
+        const auto top = stack.back();
+        stack.pop_back();
+
+        const Node& node = nodes_[top.first];
+
+        if (top.second >= depth)
+        {
+            clusters.push_back(node.cluster);
+        }
+        else if (node.isLeaf)
+        {
+            for (int i = node.start; i < node.end; ++i)
+            {
+                DipoleCluster c;
+                c.r = dipoles_[i].r;
+                c.m = dipoles_[i].m;
+                std::fill(c.Q, c.Q + 9, 0.0_r);
+                c.size = 0.0_r;
+                clusters.push_back(c);
+            }
+        }
+        else
+        {
+            for (int child : node.children)
+                if (child != noChild)
+                    stack.push_back({child, top.second + 1});
+        }
+    }
+
+    return clusters;
+}
+
+void DipoleTree::addInteractions(const Dipole& target, const SumParameters& params, real3& force, real3& torque) const
+{
+    if (nodes_.empty())
+        return;
+
+    const real theta2 = params.theta * params.theta;
+
+    // depth-first traversal: at most 7 pending siblings per level
+    int stack[7 * maxDepth + 8];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const Node& node = nodes_[stack[--stackSize]];
+        const DipoleCluster& c = node.cluster;
+
+        const real3 dr = difference(target.r, c.r, params.L, params.periodic);
+
+        // the target may belong to the tree: never approximate a node that contains it
+        if (c.size * c.size < theta2 * dot(dr, dr) && !isInside(target.r, node.lo, node.hi))
+        {
+            addClusterInteraction(dr, target.m, c, params.mu0_4pi, force, torque);
+        }
+        else if (node.isLeaf)
+        {
+            for (int i = node.start; i < node.end; ++i)
+            {
+                const auto& src = dipoles_[i];
+                const real3 d = difference(target.r, src.r, params.L, params.periodic);
+                addInteraction(d, target.m, src.m, params.mu0_4pi, force, torque);
+            }
+        }
+        else
+        {
+            for (int child : node.children)
+                if (child != noChild)
+                    stack[stackSize++] = child;
+        }
+    }
+}
+
+void computeInteractions(const std::vector<Dipole>& targets, const DipoleTree& tree,
+                         const std::vector<DipoleCluster>& clusters, const SumParameters& params,
+                         real3 *forces, real3 *torques)
+{
+    const int n = static_cast<int>(targets.size());
+
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int i = 0; i < n; ++i)
+    {
+        const Dipole& target = targets[i];
+        real3 force  = make_real3(0.0_r);
+        real3 torque = make_real3(0.0_r);
+
+        tree.addInteractions(target, params, force, torque);
+
+        for (const auto& c : clusters)
+        {
+            const real3 dr = difference(target.r, c.r, params.L, params.periodic);
+            addClusterInteraction(dr, target.m, c, params.mu0_4pi, force, torque);
+        }
+
+        forces[i] = force;
+        torques[i] = torque;
+    }
+}
+
+} // namespace magnetic_dipoles
+} // namespace mirheo
@@ -0,0 +1,125 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include "magnetic_dipoles.h"
+
+#include <vector>
+
+namespace mirheo
+{
+
+namespace magnetic_dipoles
+{
+
+/** A group of dipoles replaced by its multipole expansion, used far from the group.
+    The expansion is made of the total moment of the group and of its first moment
+    Q_ab = sum_i m_ia (r_ib - r_b), both taken about the mean position r of the group.
+    The relative error of the field at distance d is then of order (size / d)^2.
+ */
+struct DipoleCluster
+{
+    real3 r;   ///< mean position of the dipoles of the cluster
+    real3 m;   ///< total moment of the cluster
+    real Q[9]; ///< first moment of the dipoles about r, row major (moment component, position component)
+    real size; ///< largest edge of the bounding box of the cluster; 0 for a single dipole
+};
+
+/// Parameters of the summation of the dipole-dipole interactions
+struct SumParameters
+{
+    real mu0_4pi;  ///< magnetic permeability of the medium divided by 4 pi
+    real theta;    ///< opening angle: a cluster of size s at distance d is used as a whole if s < theta * d
+    real3 L;       ///< global domain size
+    bool periodic; ///< if true, use the closest periodic image of the clusters and dipoles
+};
+
+/** \brief Barnes-Hut octree of magnetic dipoles.
+
+    The tree is built on the host over dipoles given in global coordinates.
+    Each node stores the cluster made of all its dipoles; the leaves hold at most \c leafSize dipoles.
+    The interactions with a node are computed from the expansion of its cluster when the opening criterion is satisfied,
+    otherwise from its children, so that the cost per target is O(log N) instead of O(N).
+    With theta = 0 the sum is exact.
+ */
+class DipoleTree
+{
+public:
+    /** Construct an empty DipoleTree.
+        \param [in] leafSize Maximum number of dipoles in a leaf.
+     */
+    DipoleTree(int leafSize = 8);
+
+    /** Build the tree over the given dipoles.
+        \param [in] dipoles Positions and moments of the dipoles in global coordinates.
+     */
+    void build(std::vector<Dipole> dipoles);
+
+    /// \return The number of dipoles in the tree.
+    int getNumDipoles() const;
+
+    /** Summarize the tree into a list of clusters.
+        \param [in] depth The depth of the nodes that are returned as clusters.
+        \return The clusters of all nodes at the given depth, and the dipoles of the leaves above this depth.
+
+        The clusters of the nodes at depth d have a size of at most 2^-d times the size of the root.
+     */
+    std::vector<DipoleCluster> getClusters(int depth) const;
+
+    /** Add the force and torque exerted by all dipoles of the tree on a target dipole.
+        \param [in] target The dipole on which the interactions act.
+        \param [in] params Parameters of the sum.
+        \param [in,out] force Force acting on the target.
+        \param [in,out] torque Torque acting on the target.
+     */
+    void addInteractions(const Dipole& target, const SumParameters& params, real3& force, real3& torque) const;
+
+private:
+    static constexpr int noChild = -1;
+
+    struct Node
+    {
+        DipoleCluster cluster;
+        real3 lo, hi;
+        int start, end;
+        int children[8];
+        bool isLeaf;
+    };
+
+    int buildNode(int start, int end, int depth);
+
+private:
+    int leafSize_;
+    std::vector<Dipole> dipoles_;
+    std::vector<Node> nodes_;
+    std::vector<Dipole> work_;
+};
+
+/** Add the force and torque exerted by a cluster on a dipole.
+    \param [in] dr Position of the dipole relative to the center of the cluster.
+    \param [in] mdst Moment of the dipole.
+    \param [in] cluster The source cluster.
+    \param [in] mu0_4pi Magnetic permeability of the medium divided by 4 pi.
+    \param [in,out] force Force acting on the dipole.
+    \param [in,out] torque Torque acting on the dipole.
+
+    Equivalent to addInteraction() for clusters of a single dipole.
+ */
+void addClusterInteraction(real3 dr, real3 mdst, const DipoleCluster& cluster, real mu0_4pi,
+                           real3& force, real3& torque);
+
+/** Compute the forces and torques acting on a set of dipoles.
+    \param [in] targets The dipoles on which the interactions act.
+    \param [in] tree Tree of the dipoles that are summed with the Barnes-Hut criterion; may contain the targets.
+    \param [in] clusters Additional clusters that are all used as a whole.
+    \param [in] params Parameters of the sum.
+    \param [out] forces Forces acting on the targets.
+    \param [out] torques Torques acting on the targets.
+
+    The targets are processed in parallel with OpenMP when it is available.
+ */
+void computeInteractions(const std::vector<Dipole>& targets, const DipoleTree& tree,
+                         const std::vector<DipoleCluster>& clusters, const SumParameters& params,
+                         real3 *forces, real3 *torques);
+
+} // namespace magnetic_dipoles
+} // namespace mirheo
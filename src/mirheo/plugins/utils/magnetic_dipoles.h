@@ -0,0 +1,80 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <mirheo/core/utils/cpu_gpu_defines.h>
+#include <mirheo/core/utils/helper_math.h>
+
+namespace mirheo
+{
+
+/** Helpers shared by the device and host implementations of the magnetic dipole-dipole interactions.
+ */
+namespace magnetic_dipoles
+{
+
+/// A magnetic dipole, in global coordinates
+struct Dipole
+{
+    real3 r; ///< position
+    real3 m; ///< magnetic moment, in the lab frame
+};
+
+/** Compute the difference between two points.
+    If periodic, returns the smallest difference between two points in the periodic domain.
+ */
+__HD__ inline real3 difference(real3 a, real3 b, real3 L, bool periodic)
+{
+    real3 d = a - b;
+
+    if (periodic)
+    {
+        const real3 h = 0.5_r * L;
+
+        if (d.x < -h.x) d.x += L.x;
+        if (d.x >  h.x) d.x -= L.x;
+
+        if (d.y < -h.y) d.y += L.y;
+        if (d.y >  h.y) d.y -= L.y;
+
+        if (d.z < -h.z) d.z += L.z;
+        if (d.z >  h.z) d.z -= L.z;
+    }
+
+    return d;
+}
+
+/** Add the force and torque exerted by the dipole \p msrc on the dipole \p mdst.
+    \param [in] dr Position of the destination dipole relative to the source dipole.
+    \param [in] mdst Moment of the destination dipole.
+    \param [in] msrc Moment of the source dipole.
+    \param [in] mu0_4pi Magnetic permeability of the medium divided by 4 pi.
+    \param [in,out] force Force acting on the destination dipole.
+    \param [in,out] torque Torque acting on the destination dipole.
+
+    Nothing is added if the two dipoles coincide.
+ */
+__HD__ inline void addInteraction(real3 dr, real3 mdst, real3 msrc, real mu0_4pi,
+                                  real3& force, real3& torque)
+{
+    const real r2 = dot(dr, dr);
+
+    if (r2 < 1e-6_r)
+        return;
+
+    const real r = math::sqrt(r2);
+    const real3 er = dr / r;
+
+    const real forceFactor = 3 * mu0_4pi / (r2 * r2);
+    const real torqueFactor = mu0_4pi / (r2 * r);
+
+    const real3 erXmdst = cross(er, mdst);
+    const real3 erXmsrc = cross(er, msrc);
+
+    force += forceFactor * (cross(erXmdst, msrc) + cross(erXmsrc, mdst)
+                            - 2 * dot(mdst, msrc) * er + 5 * dot(erXmdst, erXmsrc) * er);
+
+    torque += torqueFactor * (3 * dot(mdst, er) * cross(msrc, er) - cross(mdst, msrc));
+}
+
+} // namespace magnetic_dipoles
+} // namespace mirheo
@@ -0,0 +1,301 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include <mirheo/core/logger.h>
+#include <mirheo/core/utils/cpu_gpu_defines.h>
+#include <mirheo/core/utils/helper_math.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace mirheo
+{
+
+/** \brief Block-averaging multiple-tau correlator.
+
+    Estimate the time correlation of a signal of many items (e.g. the velocity of each particle)
+    on logarithmically spaced lags, using all time origins, with a memory that grows only logarithmically
+    with the longest lag, see Ramirez et al., J. Chem. Phys. 133, 154103 (2010).
+
+    The correlator is made of \c numLevels levels, each storing the last \c blockLength values of the signal of every item.
+    Level 0 receives every sample; level \c k+1 receives one value every \c averagingFactor values of level \c k,
+    which is either their mean (CoarseGraining::Average) or the first of them (CoarseGraining::Subsample).
+    Level \c k thus covers the lags \c j * averagingFactor^k, where \c j < \c blockLength.
+
+    All items are sampled at the same time, so they share the lags and the number of time origins of each lag.
+    The correlations are summed over all items; only the stored values are per item.
+ */
+namespace multiple_tau
+{
+
+/// How the values of a level are combined into one value of the next level
+enum class CoarseGraining
+{
+    Average,  ///< mean of the values; smooths the signal at long lags, suited to correlations of fluctuating quantities
+    Subsample ///< first value; exact at all lags but uses fewer time origins, suited to displacements
+};
+
+/// correlation of two values: product of the value at the time origin and at the lag
+struct Product
+{
+    /// \return the correlation of \p x0 and \p x1 as a double precision number
+    template <class T>
+    __HD__ static inline double apply(T x0, T x1)
+    {
+        return dot(make_double3(x0), make_double3(x1));
+    }
+};
+
+/// correlation of two values: square of their difference, e.g. for mean squared displacements
+struct SquaredDifference
+{
+    /// \return the squared norm of the difference of \p x1 and \p x0 as a double precision number
+    template <class T>
+    __HD__ static inline double apply(T x0, T x1)
+    {
+        const double3 d = make_double3(x1) - make_double3(x0);
+        return dot(d, d);
+    }
+};
+
+/// Lags of a multiple-tau correlator and number of values stored per item
+struct Layout
+{
+    /** \brief Construct a Layout.
+        \param [in] numLevels Number of levels; the longest lag is about blockLength * averagingFactor^(numLevels-1).
+        \param [in] blockLength Number of values stored per level; must be a multiple of \p averagingFactor.
+        \param [in] averagingFactor Number of values of a level combined into one value of the next level.
+     */
+    Layout(int numLevels, int blockLength, int averagingFactor = 2) :
+        numLevels(numLevels),
+        blockLength(blockLength),
+        averagingFactor(averagingFactor)
+    {
+        if (numLevels <= 0)
+            die("multiple tau correlator: expected a positive number of levels, got %d", numLevels);
+        if (averagingFactor < 2)
+            die("multiple tau correlator: expected an averaging factor of at least 2, got %d", averagingFactor);
+        if (blockLength < averagingFactor || blockLength % averagingFactor != 0)
+            die("multiple tau correlator: the block length (%d) must be a multiple of the averaging factor (%d)",
+                blockLength, averagingFactor);
+    }
+
+    /// \return the number of new lags of each level above the first one
+    __HD__ int numLagsPerLevel() const {return blockLength - blockLength / averagingFactor;}
+
+    /// \return the total number of lags
+    __HD__ int numLags() const {return blockLength + (numLevels - 1) * numLagsPerLevel();}
+
+    /// \return the number of values stored per item, in the registers of all levels
+    __HD__ int numRegisters() const {return numLevels * blockLength;}
+
+    /// \return the number of partial coarse-grained values stored per item, one per level but the last
+    __HD__ int numAccumulators() const {return numLevels - 1;}
+
+    /// \return the index of the lag \p j * averagingFactor^\p level; \p j must be in the range covered by the level
+    __HD__ int lagIndex(int level, int j) const
+    {
+        return level == 0 ? j : blockLength + (level - 1) * numLagsPerLevel() + j - blockLength / averagingFactor;
+    }
+
+    /// \return the lag, in number of samples, of the lag index \p lagId
+    long lag(int lagId) const
+    {
+        if (lagId < blockLength)
+            return lagId;
+
+        const int level = 1 + (lagId - blockLength) / numLagsPerLevel();
+        const int j = (lagId - blockLength) % numLagsPerLevel() + blockLength / averagingFactor;
+
+        long scale = 1;
+        for (int k = 0; k < level; ++k)
+            scale *= averagingFactor;
+        return j * scale;
+    }
+
+    int numLevels;       ///< number of levels
+    int blockLength;     ///< number of values stored per level
+    int averagingFactor; ///< number of values of a level combined into one value of the next level
+};
+
+/** \brief Add the sample of one item to the correlator.
+    \tparam Kernel The correlation of two values, Product or SquaredDifference
+    \param [in] layout The lags of the correlator
+    \param [in] coarseGraining How the values of a level are combined for the next level
+    \param [in] sampleIndex Index of the sample since the correlator started; the same for all items
+    \param [in] firstSample Index of the first sample of the item; the values of the blocks that start
+                before it are stored but not correlated, so that an item can join a running correlator.
+    \param [in] x The new value of the item
+    \param [in] valid If \c false, only call \p accumulate (with zero values) in the same order as for a valid item;
+                \p registers and \p accumulators are not accessed.
+    \param [in] i Index of the item in the registers and accumulators
+    \param [in,out] registers \c layout.numRegisters() arrays; value \c slot of level \c k of item \p i is registers[k * blockLength + slot][i]
+    \param [in,out] accumulators \c layout.numAccumulators() arrays holding the partial coarse-grained values of item \p i
+    \param [in] accumulate Called as \c accumulate(lagIndex, correlation, count) for every lag with a new time origin;
+                \c count is 1 if the item has this time origin and 0 otherwise (the correlation is then 0).
+
+    The lags are visited in the same order for all items, which allows to reduce the correlations over a warp on the device.
+ */
+template <class Kernel, class T, class Accumulate>
+__HD__ inline void addSample(const Layout& layout, CoarseGraining coarseGraining, long sampleIndex, long firstSample,
+                             T x, bool valid, int i, T *const *registers, T *const *accumulators,
+                             Accumulate accumulate)
+{
+    const int p = layout.blockLength;
+    const int m = layout.averagingFactor;
+
+    long levelPeriod = 1; // averagingFactor^k: number of samples per value of level k
+
+    for (int k = 0; k < layout.numLevels; ++k)
+    {
+        if ((sampleIndex + 1) % levelPeriod != 0)
+            break;
+
+        // index of the new value within level k
+        const long c = (sampleIndex + 1) / levelPeriod - 1;
+
+        if (valid)
+        {
+            if (k > 0)
+            {
+                x = accumulators[k-1][i];
+                if (coarseGraining == CoarseGraining::Average)
+                    x *= 1.0_r / m;
+            }
+
+            registers[k * p + c % p][i] = x;
+
+            if (k + 1 < layout.numLevels)
+            {
+                if (c % m == 0)
+                    accumulators[k][i] = x;
+                else if (coarseGraining == CoarseGraining::Average)
+                    accumulators[k][i] += x;
+            }
+        }
+
+        const int jStart = k == 0 ? 0 : p / m;
+        const int jEnd = c < p - 1 ? static_cast<int>(c) : p - 1;
+
+        for (int j = jStart; j <= jEnd; ++j)
+        {
+            const bool hasOrigin = valid && (c - j) * levelPeriod >= firstSample;
+            const double corr = hasOrigin ? Kernel::apply(registers[k * p + (c - j) % p][i], x) : 0.0;
+            accumulate(layout.lagIndex(k, j), corr, hasOrigin ? 1 : 0);
+        }
+
+        levelPeriod *= m;
+    }
+}
+
+/** \brief Add the sample of one item whose stored values travel with it, e.g. in persistent particle channels.
+    \tparam Kernel The correlation of two values, Product or SquaredDifference
+    \param [in] layout The lags of the correlator
+    \param [in] coarseGraining How the values of a level are combined for the next level
+    \param [in] sampleIndex Index of the sample since the correlator started; the same for all items
+    \param [in] id The global id of the item
+    \param [in] x The new value of the item
+    \param [in] valid If \c false, only call \p accumulate in the same order as for a valid item, see addSample()
+    \param [in] i Index of the item in the stored values
+    \param [in,out] values \c layout.numRegisters() registers followed by \c layout.numAccumulators() accumulators, see addSample()
+    \param [in,out] firstSamples Index of the first sample of each item
+    \param [in,out] owners Global id of the item that the stored values of each index belong to
+    \param [in] accumulate Called as in addSample()
+
+    The values stored at index \p i belong to the item only if \p owners[i] is its id; they were then moved there
+    together with the item, e.g. when it was reordered or migrated to another rank.
+    Otherwise, or at the first sample of the correlator, the values are garbage: the item was just created
+    and starts with its own time origins.
+ */
+template <class Kernel, class T, class Accumulate>
+__HD__ inline void addItemSample(const Layout& layout, CoarseGraining coarseGraining, long sampleIndex,
+                                 int64_t id, T x, bool valid, int i,
+                                 T *const *values, int64_t *firstSamples, int64_t *owners,
+                                 Accumulate accumulate)
+{
+    if (valid && (sampleIndex == 0 || owners[i] != id))
+    {
+        owners[i] = id;
+        firstSamples[i] = sampleIndex;
+    }
+
+    addSample<Kernel>(layout, coarseGraining, sampleIndex, valid ? firstSamples[i] : 0,
+                      x, valid, i, values, values + layout.numRegisters(), accumulate);
+}
+
+/** \brief Multiple-tau correlator of a fixed number of items on the host.
+    \tparam Kernel The correlation of two values, Product or SquaredDifference
+    \tparam T The type of the values (e.g. real3)
+ */
+template <class Kernel, class T>
+class HostCorrelator
+{
+public:
+    /** \brief Construct a HostCorrelator.
+        \param [in] layout The lags of the correlator
+        \param [in] coarseGraining How the values of a level are combined for the next level
+        \param [in] numItems The number of items sampled together
+     */
+    HostCorrelator(Layout layout, CoarseGraining coarseGraining, int numItems) :
+        layout_(layout),
+        coarseGraining_(coarseGraining),
+        numItems_(numItems),
+        registers_(layout.numRegisters(), std::vector<T>(numItems)),
+        accumulators_(layout.numAccumulators(), std::vector<T>(numItems)),
+        sums_(layout.numLags(), 0.0),
+        counts_(layout.numLags(), 0)
+    {
+        for (auto& r : registers_)
+            registerPtrs_.push_back(r.data());
+        for (auto& a : accumulators_)
+            accumulatorPtrs_.push_back(a.data());
+    }
+
+    /// add one sample of all items; \p values must contain numItems values
+    void addSamples(const T *values)
+    {
+        for (int i = 0; i < numItems_; ++i)
+            addSample<Kernel>(layout_, coarseGraining_, numSamples_, 0, values[i], true, i,
+                              registerPtrs_.data(), accumulatorPtrs_.data(),
+                              [this](int lagId, double corr, int count)
+            {
+                sums_[lagId] += corr;
+                counts_[lagId] += count;
+            });
+
+        ++numSamples_;
+    }
+
+    const Layout& getLayout() const {return layout_;} ///< \return the lags of the correlator
+    long getNumSamples() const {return numSamples_;} ///< \return the number of samples added so far
+
+    const std::vector<double>& getSums() const {return sums_;}  ///< \return the correlations summed over the items and the time origins, per lag
+    const std::vector<long>& getCounts() const {return counts_;} ///< \return the number of (item, time origin) pairs, per lag
+
+    /// \return the averaged correlation at each lag; zero for the lags that were not reached yet
+    std::vector<double> getCorrelation() const
+    {
+        std::vector<double> c(sums_.size(), 0.0);
+        for (size_t i = 0; i < c.size(); ++i)
+            if (counts_[i] > 0)
+                c[i] = sums_[i] / counts_[i];
+        return c;
+    }
+
+private:
+    Layout layout_;
+    CoarseGraining coarseGraining_;
+    int numItems_;
+    long numSamples_ {0};
+
+    std::vector<std::vector<T>> registers_;
+    std::vector<std::vector<T>> accumulators_;
+    std::vector<T*> registerPtrs_;
+    std::vector<T*> accumulatorPtrs_;
+
+    std::vector<double> sums_;
+    std::vector<long> counts_;
+};
+
+} // namespace multiple_tau
+} // namespace mirheo
@@ -0,0 +1,203 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#include "multiple_tau_correlator.h"
+
+#include <mirheo/core/pvs/object_vector.h>
+#include <mirheo/core/pvs/particle_vector.h>
+#include <mirheo/core/utils/cuda_common.h>
+#include <mirheo/core/utils/file_wrapper.h>
+#include <mirheo/core/utils/kernel_launch.h>
+
+#include <string>
+
+namespace mirheo
+{
+
+namespace multiple_tau_kernels
+{
+template <class Kernel>
+__global__ void addSamples(int n, const int64_t *ids, const real3 *values,
+                           multiple_tau::Layout layout, multiple_tau::CoarseGraining coarseGraining, long sampleIndex,
+                           real3 *const *storedValues, int64_t *firstSamples, int64_t *owners,
+                           double *sums, unsigned long long *counts)
+{
+    const int i = blockIdx.x * blockDim.x + threadIdx.x;
+    const bool valid = i < n;
+
+    // the lags are visited in the same order by all threads, including the invalid ones
+    multiple_tau::addItemSample<Kernel>(layout, coarseGraining, sampleIndex,
+                                        valid ? ids[i] : 0, valid ? values[i] : make_real3(0.0_r), valid, i,
+                                        storedValues, firstSamples, owners,
+                                        [sums, counts](int lagId, double corr, int count)
+    {
+        corr  = warpReduce(corr,  [](double a, double b) { return a+b; });
+        count = warpReduce(count, [](int a, int b) { return a+b; });
+
+        if (laneId() == 0)
+        {
+            atomicAdd(&sums[lagId], corr);
+            atomicAdd(&counts[lagId], static_cast<unsigned long long>(count));
+        }
+    });
+}
+} // namespace multiple_tau_kernels
+
+template <class Kernel>
+MultipleTauCorrelator<Kernel>::MultipleTauCorrelator(multiple_tau::Layout layout,
+                                                     multiple_tau::CoarseGraining coarseGraining,
+                                                     const std::string& channelPrefix) :
+    layout_(layout),
+    coarseGraining_(coarseGraining),
+    firstSampleChannelName_(channelPrefix + "_first_sample"),
+    ownerChannelName_(channelPrefix + "_owner"),
+    valuePtrs_(layout.numRegisters() + layout.numAccumulators()),
+    sums_(layout.numLags()),
+    deviceCounts_(layout.numLags()),
+    counts_(layout.numLags(), 0)
+{
+    for (int v = 0; v < layout.numRegisters(); ++v)
+        valueChannelNames_.push_back(channelPrefix + "_register_" + std::to_string(v));
+    for (int v = 0; v < layout.numAccumulators(); ++v)
+        valueChannelNames_.push_back(channelPrefix + "_accumulator_" + std::to_string(v));
+
+    for (auto& ptr : valuePtrs_)
+        ptr = nullptr;
+
+    sums_.clear(defaultStream);
+    deviceCounts_.clear(defaultStream);
+}
+
+template <class Kernel>
+void MultipleTauCorrelator<Kernel>::requireDataPerParticle(ParticleVector *pv) const
+{
+    for (const auto& name : valueChannelNames_)
+        pv->requireDataPerParticle<real3>(name, DataManager::PersistenceMode::Active);
+    pv->requireDataPerParticle<int64_t>(firstSampleChannelName_, DataManager::PersistenceMode::Active);
+    pv->requireDataPerParticle<int64_t>(ownerChannelName_, DataManager::PersistenceMode::Active);
+}
+
+template <class Kernel>
+void MultipleTauCorrelator<Kernel>::requireDataPerObject(ObjectVector *ov) const
+{
+    for (const auto& name : valueChannelNames_)
+        ov->requireDataPerObject<real3>(name, DataManager::PersistenceMode::Active);
+    ov->requireDataPerObject<int64_t>(firstSampleChannelName_, DataManager::PersistenceMode::Active);
+    ov->requireDataPerObject<int64_t>(ownerChannelName_, DataManager::PersistenceMode::Active);
+}
+
+template <class Kernel>
+void MultipleTauCorrelator<Kernel>::addSamples(int n, const int64_t *ids, const real3 *values,
+                                               DataManager& channels, cudaStream_t stream)
+{
+    // the channels are reallocated when the number of items grows
+    bool changed = false;
+    for (size_t v = 0; v < valueChannelNames_.size(); ++v)
+    {
+        real3 *ptr = channels.getData<real3>(valueChannelNames_[v])->devPtr();
+        changed = changed || ptr != valuePtrs_[v];
+        valuePtrs_[v] = ptr;
+    }
+    if (changed)
+        valuePtrs_.uploadToDevice(stream);
+
+    constexpr int nthreads = 128;
+    const int nblocks = getNblocks(n, nthreads);
+
+    if (n > 0)
+    {
+        SAFE_KERNEL_LAUNCH(
+            multiple_tau_kernels::addSamples<Kernel>,
+            nblocks, nthreads, 0, stream,
+            n, ids, values, layout_, coarseGraining_, numSamples_,
+            valuePtrs_.devPtr(),
+            channels.getData<int64_t>(firstSampleChannelName_)->devPtr(),
+            channels.getData<int64_t>(ownerChannelName_)->devPtr(),
+            sums_.devPtr(), deviceCounts_.devPtr() );
+    }
+
+    ++numSamples_;
+}
+
+template <class Kernel>
+void MultipleTauCorrelator<Kernel>::downloadSums(cudaStream_t stream)
+{
+    sums_.downloadFromDevice(stream, ContainersSynch::Asynch);
+    deviceCounts_.downloadFromDevice(stream, ContainersSynch::Synch);
+
+    for (size_t i = 0; i < counts_.size(); ++i)
+        counts_[i] = static_cast<long>(deviceCounts_[i]);
+}
+
+template <class Kernel>
+const multiple_tau::Layout& MultipleTauCorrelator<Kernel>::getLayout() const
+{
+    return layout_;
+}
+
+template <class Kernel>
+const PinnedBuffer<double>& MultipleTauCorrelator<Kernel>::getSums() const
+{
+    return sums_;
+}
+
+template <class Kernel>
+const std::vector<long>& MultipleTauCorrelator<Kernel>::getCounts() const
+{
+    return counts_;
+}
+
+template <class Kernel>
+std::vector<MirState::TimeType> MultipleTauCorrelator<Kernel>::getLagTimes(MirState::TimeType samplingPeriod) const
+{
+    std::vector<MirState::TimeType> lagTimes(layout_.numLags());
+    for (int i = 0; i < layout_.numLags(); ++i)
+        lagTimes[i] = static_cast<MirState::TimeType>(layout_.lag(i)) * samplingPeriod;
+    return lagTimes;
+}
+
+template class MultipleTauCorrelator<multiple_tau::Product>;
+template class MultipleTauCorrelator<multiple_tau::SquaredDifference>;
+
+namespace multiple_tau
+{
+void dumpCorrelations(MPI_Comm comm, const std::string& fname, const std::string& header,
+                      const std::vector<MirState::TimeType>& lagTimes,
+                      const std::vector<std::vector<double>>& localSums,
+                      const std::vector<long>& localCounts, double scale)
+{
+    const int numLags = static_cast<int>(localCounts.size());
+
+    std::vector<std::vector<double>> totalSums;
+    std::vector<long> totalCounts(numLags);
+
+    for (const auto& sums : localSums)
+    {
+        totalSums.emplace_back(numLags, 0.0);
+        MPI_Check( MPI_Reduce(sums.data(), totalSums.back().data(), numLags, MPI_DOUBLE, MPI_SUM, 0, comm) );
+    }
+    MPI_Check( MPI_Reduce(localCounts.data(), totalCounts.data(), numLags, MPI_LONG, MPI_SUM, 0, comm) );
+
+    int rank;
+    MPI_Check( MPI_Comm_rank(comm, &rank) );
+    if (rank != 0)
+        return;
+
+    FileWrapper f;
+    if (f.open(fname, "w") != FileWrapper::Status::Success)
+        die("Could not open file '%s'", fname.c_str());
+
+    fprintf(f.get(), "%s\n", header.c_str());
+
+    for (int i = 0; i < numLags; ++i)
+    {
+        if (totalCounts[i] == 0)
+            continue;
+
+        fprintf(f.get(), "%g", lagTimes[i]);
+        for (const auto& sums : totalSums)
+            fprintf(f.get(), ",%.6e", scale * sums[i] / totalCounts[i]);
+        fprintf(f.get(), "\n");
+    }
+}
+} // namespace multiple_tau
+
+} // namespace mirheo
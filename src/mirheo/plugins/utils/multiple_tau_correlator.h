@@ -0,0 +1,102 @@
+// Copyright 2020 ETH Zurich. All Rights Reserved.
+#pragma once
+
+#include "multiple_tau.h"
+
+#include <mirheo/core/containers.h>
+#include <mirheo/core/datatypes.h>
+#include <mirheo/core/mirheo_state.h>
+#include <mirheo/core/pvs/data_manager.h>
+
+#include <cstdint>
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace mirheo
+{
+
+class ParticleVector;
+class ObjectVector;
+
+/** \brief Multiple-tau correlator of a real3 quantity per particle or per object, on the device.
+    \tparam Kernel The correlation of two values, multiple_tau::Product or multiple_tau::SquaredDifference
+
+    The values stored for each item (registers and accumulators), its first sample and the id of its owner
+    are kept in persistent channels of the particle or object vector, see requireDataPerParticle() and requireDataPerObject().
+    They are thus reordered with the items and migrate with them to other ranks, so that every item keeps
+    its time origins during the whole run; only the items created after the correlator started use fewer time origins.
+    The correlations are summed over the local items; the sums and counts of all ranks must be added to get the average.
+ */
+template <class Kernel>
+class MultipleTauCorrelator
+{
+public:
+    /** \brief Construct a MultipleTauCorrelator.
+        \param [in] layout The lags of the correlator.
+        \param [in] coarseGraining How the values of a level are combined for the next level.
+        \param [in] channelPrefix Prefix of the names of the channels holding the stored values; must be unique per correlator.
+     */
+    MultipleTauCorrelator(multiple_tau::Layout layout, multiple_tau::CoarseGraining coarseGraining,
+                          const std::string& channelPrefix);
+
+    /// Register the persistent channels of the stored values as data per particle of \p pv.
+    void requireDataPerParticle(ParticleVector *pv) const;
+
+    /// Register the persistent channels of the stored values as data per object of \p ov.
+    void requireDataPerObject(ObjectVector *ov) const;
+
+    /** \brief Add one sample of all items.
+        \param [in] n The number of items.
+        \param [in] ids The global ids of the items, on the device.
+        \param [in] values The new values of the items, on the device.
+        \param [in,out] channels The data per particle or per object that holds the channels of the stored values.
+        \param [in] stream Execution stream.
+     */
+    void addSamples(int n, const int64_t *ids, const real3 *values, DataManager& channels, cudaStream_t stream);
+
+    /// Download the local sums and counts of the correlations; synchronizes \p stream.
+    void downloadSums(cudaStream_t stream);
+
+    const multiple_tau::Layout& getLayout() const; ///< \return the lags of the correlator
+    const PinnedBuffer<double>& getSums() const;   ///< \return the local sums of the correlations per lag, after downloadSums()
+    const std::vector<long>& getCounts() const;    ///< \return the local number of (item, time origin) pairs per lag, after downloadSums()
+
+    /// \return the lags in time units, given the time \p samplingPeriod between two samples
+    std::vector<MirState::TimeType> getLagTimes(MirState::TimeType samplingPeriod) const;
+
+private:
+    multiple_tau::Layout layout_;
+    multiple_tau::CoarseGraining coarseGraining_;
+    long numSamples_ {0};
+
+    std::vector<std::string> valueChannelNames_; ///< registers then accumulators
+    std::string firstSampleChannelName_;
+    std::string ownerChannelName_;
+    PinnedBuffer<real3*> valuePtrs_;             ///< device pointers of the value channels; uploaded when they change
+
+    PinnedBuffer<double> sums_;
+    PinnedBuffer<unsigned long long> deviceCounts_;
+    std::vector<long> counts_;
+};
+
+namespace multiple_tau
+{
+/** \brief Average the correlations of all ranks and write them in a csv file on rank 0.
+    \param [in] comm The communicator of the ranks that hold the correlations.
+    \param [in] fname The csv file; overwritten with the current estimate.
+    \param [in] header The header of the csv file, e.g. "time,vacf".
+    \param [in] lagTimes The lags in time units; first column.
+    \param [in] localSums The local sums of the correlations, one vector per column after the lag.
+    \param [in] localCounts The local number of (item, time origin) pairs per lag, common to all columns.
+    \param [in] scale Factor applied to the averaged correlations.
+
+    Collective over \p comm. The lags that were not reached yet are skipped.
+ */
+void dumpCorrelations(MPI_Comm comm, const std::string& fname, const std::string& header,
+                      const std::vector<MirState::TimeType>& lagTimes,
+                      const std::vector<std::vector<double>>& localSums,
+                      const std::vector<long>& localCounts, double scale = 1.0);
+} // namespace multiple_tau
+
+} // namespace mirheo
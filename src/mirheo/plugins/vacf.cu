@@ -36,15 +36,28 @@ __global__ void computeLocalVacf(PVview view, const real4 *velocities0, vacf_plu
     if (laneId() == 0)
         atomicAdd(vacfSum, vacf);
 }
+
+__global__ void extractVelocities(PVview view, real3 *velocities, int64_t *ids)
+{
+    const int i = blockIdx.x * blockDim.x + threadIdx.x;
+    if (i >= view.size) return;
+
+    const Particle p = view.readParticle(i);
+    velocities[i] = p.u;
+    ids[i] = p.getId();
+}
 } // namespace vacf_kernels
 
 VacfPlugin::VacfPlugin(const MirState *state, std::string name, std::string pvName,
-                       MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery) :
+                       MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery,
+                       int numLevels, int blockLength) :
     SimulationPlugin(state, name),
     pvName_(pvName),
     startTime_(startTime),
     endTime_(endTime),
-    dumpEvery_(dumpEvery)
+    dumpEvery_(dumpEvery),
+    numLevels_(numLevels),
+    blockLength_(blockLength)
 {}
 
 VacfPlugin::~VacfPlugin() = default;
@@ -56,14 +69,26 @@ void VacfPlugin::setup(Simulation *simulation, const MPI_Comm& comm, const MPI_C
     v0Channel_ = this->getName() + "_v0";
 
     pv_ = simulation->getPVbyNameOrDie(pvName_);
-    pv_->requireDataPerParticle<real4>(v0Channel_, DataManager::PersistenceMode::Active);
+
+    if (numLevels_ > 0)
+    {
+        correlator_ = std::make_unique<MultipleTauCorrelator<multiple_tau::Product>>
+            (multiple_tau::Layout(numLevels_, blockLength_), multiple_tau::CoarseGraining::Average,
+             this->getName() + "_mtau");
+        correlator_->requireDataPerParticle(pv_);
+    }
+    else
+    {
+        pv_->requireDataPerParticle<real4>(v0Channel_, DataManager::PersistenceMode::Active);
+    }
 
     info("Plugin %s initialized for the following particle vector: %s", getCName(), pvName_.c_str());
 }
 
 void VacfPlugin::handshake()
 {
-    SimpleSerializer::serialize(sendBuffer_, pvName_);
+    const bool multipleTau = correlator_ != nullptr;
+    SimpleSerializer::serialize(sendBuffer_, pvName_, multipleTau);
     _send(sendBuffer_);
 }
 
@@ -75,6 +100,32 @@ void VacfPlugin::afterIntegration(cudaStream_t stream)
     if (currentTime < startTime_ || currentTime > endTime_)
         return;
 
+    if (correlator_)
+    {
+        if (startStep_ < 0)
+            startStep_ = currentStep;
+
+        PVview view(pv_, pv_->local());
+        samples_.resize_anew(view.size);
+        sampleIds_.resize_anew(view.size);
+
+        constexpr int nthreads = 128;
+        SAFE_KERNEL_LAUNCH(
+            vacf_kernels::extractVelocities,
+            getNblocks(view.size, nthreads), nthreads, 0, stream,
+            view, samples_.devPtr(), sampleIds_.devPtr() );
+
+        correlator_->addSamples(view.size, sampleIds_.devPtr(), samples_.devPtr(),
+                                pv_->local()->dataPerParticle, stream);
+
+        if ((currentStep - startStep_) % dumpEvery_ == 0)
+        {
+            correlator_->downloadSums(stream);
+            needToSend_ = true;
+        }
+        return;
+    }
+
     auto v0 = pv_->local()->dataPerParticle.getData<real4>(v0Channel_);
 
     if (startStep_ < 0)
@@ -112,7 +163,16 @@ void VacfPlugin::serializeAndSend(__UNUSED cudaStream_t stream)
     debug2("Plugin %s is sending now data", getCName());
 
     _waitPrevSend();
-    SimpleSerializer::serialize(sendBuffer_, savedTime_, localVacf_[0], nparticles_);
+    if (correlator_)
+    {
+        const auto& sums = correlator_->getSums();
+        SimpleSerializer::serialize(sendBuffer_, correlator_->getLagTimes(getState()->getDt()),
+                                    std::vector<double>(sums.begin(), sums.end()), correlator_->getCounts());
+    }
+    else
+    {
+        SimpleSerializer::serialize(sendBuffer_, savedTime_, localVacf_[0], nparticles_);
+    }
     _send(sendBuffer_);
 
     needToSend_ = false;
@@ -138,9 +198,12 @@ void VacfDumper::handshake()
     recv();
 
     std::string pvName;
-    SimpleSerializer::deserialize(data_, pvName);
+    SimpleSerializer::deserialize(data_, pvName, multipleTau_);
 
-    if (activated_ && fdump_.get() == nullptr)
+    // with the multiple-tau correlator, the whole file is rewritten at every dump
+    if (multipleTau_)
+        fname_ = joinPaths(path_, setExtensionOrDie(pvName, "csv"));
+    else if (activated_ && fdump_.get() == nullptr)
     {
         auto fname = joinPaths(path_, setExtensionOrDie(pvName, "csv"));
         auto status = fdump_.open(fname, "w");
@@ -152,6 +215,19 @@ void VacfDumper::handshake()
 
 void VacfDumper::deserialize()
 {
+    if (multipleTau_)
+    {
+        std::vector<MirState::TimeType> lagTimes;
+        std::vector<double> localSums;
+        std::vector<long> localCounts;
+        SimpleSerializer::deserialize(data_, lagTimes, localSums, localCounts);
+
+        // the correlator sums the products of the three components
+        if (activated_)
+            multiple_tau::dumpCorrelations(comm_, fname_, "time,vacf", lagTimes, {localSums}, localCounts, 1.0 / 3.0);
+        return;
+    }
+
     MirState::TimeType curTime;
     vacf_plugin::ReductionType localVacf, totalVacf;
     long localNumParticles, totalNumParticles;
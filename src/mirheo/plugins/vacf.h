@@ -1,10 +1,14 @@
 // Copyright 2020 ETH Zurich. All Rights Reserved.
 #pragma once
 
+#include "utils/multiple_tau_correlator.h"
+
 #include <mirheo/core/containers.h>
 #include <mirheo/core/plugins.h>
 #include <mirheo/core/utils/file_wrapper.h>
 
+#include <memory>
+
 namespace mirheo
 {
 
@@ -18,6 +22,10 @@ using ReductionType = double;
 
 /** Compute the velocity autocorrelation function (VACF) of a given ParticleVector.
     The VACF is computed every dumpEvery steps on the time interval [startTime, endTime].
+
+    By default, the only time origin is startTime.
+    With a positive number of levels, the velocities are sampled at every step by a multiple-tau correlator
+    (see multiple_tau) that uses all time origins; the current estimate of the VACF is then sent every dumpEvery steps.
  */
 class VacfPlugin : public SimulationPlugin
 {
@@ -29,9 +37,12 @@ public:
         \param [in] startTime VACF will use this time as origin.
         \param [in] endTime The VACF will be reported only on [startTime, endTime].
         \param [in] dumpEvery Will send the VACF to the postprocess side every this number of steps, only during the valid time interval.
+        \param [in] numLevels Number of levels of the multiple-tau correlator; 0 to only use startTime as time origin.
+        \param [in] blockLength Number of lags per level of the multiple-tau correlator.
     */
     VacfPlugin(const MirState *state, std::string name, std::string pvName,
-               MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery);
+               MirState::TimeType startTime, MirState::TimeType endTime, int dumpEvery,
+               int numLevels = 0, int blockLength = 16);
 
     ~VacfPlugin();
 
@@ -59,6 +70,12 @@ private:
 
     std::string v0Channel_; ///< the channel name that will contain the initial velocities of particles
     ParticleVector *pv_{nullptr};
+
+    int numLevels_;
+    int blockLength_;
+    std::unique_ptr<MultipleTauCorrelator<multiple_tau::Product>> correlator_; ///< nullptr if only startTime is a time origin
+    DeviceBuffer<real3> samples_;
+    DeviceBuffer<int64_t> sampleIds_;
 };
 
 
@@ -82,6 +99,8 @@ private:
     std::string path_;
 
     bool activated_ = true;
+    bool multipleTau_ {false};
+    std::string fname_; ///< the csv file, rewritten at every dump with the multiple-tau correlator
     FileWrapper fdump_;
 };
 
@@ -0,0 +1,448 @@
+#include <mirheo/core/celllist.h>
+#include <mirheo/core/datatypes.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace mirheo;
+
+namespace
+{
+/// Host version of the full and incremental builds of a PrimaryCellList
+class HostCellList
+{
+public:
+    HostCellList(real rc, real3 L) :
+        cinfo(rc, L),
+        cellStarts(cinfo.totcells + 1, 0),
+        cellSizes(cinfo.totcells + 1, 0),
+        oldCellStarts(cinfo.totcells + 1, 0),
+        arrivals(cinfo.totcells, 0)
+    {}
+
+    /// sort the particles from scratch; reorders \p positions and \p velocities and removes the marked particles
+    void fullBuild(std::vector<real4>& positions, std::vector<real4>& velocities)
+    {
+        const int n = static_cast<int>(positions.size());
+        std::fill(cellSizes.begin(), cellSizes.end(), 0);
+
+        for (const auto& r : positions)
+            if (!isLeaving(r))
+                ++cellSizes[cinfo.getCellId(make_real3(r))];
+
+        scanCellSizes();
+        std::fill(cellSizes.begin(), cellSizes.end(), 0);
+
+        order.resize(n);
+        for (int pid = 0; pid < n; ++pid)
+        {
+            if (isLeaving(positions[pid]))
+            {
+                order[pid] = invalid;
+                continue;
+            }
+            const int cid = cinfo.getCellId(make_real3(positions[pid]));
+            order[pid] = cellStarts[cid] + cellSizes[cid]++;
+        }
+
+        applyOrder(positions);
+        applyOrder(velocities);
+        computeSlotCells();
+    }
+
+    /** move only the particles that changed cell, or sort from scratch if there are more than
+        \p maxMigration * n of them.
+        The particles appended since the last build are arrivals, the marked ones are leaving.
+        \return the number of particles that changed cell
+     */
+    int incrementalBuild(std::vector<real4>& positions, std::vector<real4>& velocities, real maxMigration)
+    {
+        const int n = static_cast<int>(positions.size());
+        const int numOldSlots = static_cast<int>(slotCells.size());
+        if (n < numOldSlots)
+        {
+            fullBuild(positions, velocities);
+            return -1;
+        }
+
+        newCells.resize(n);
+        leaving.assign(numOldSlots + 1, 0);
+        int numMigrated = 0;
+
+        for (int pid = 0; pid < n; ++pid)
+        {
+            newCells[pid] = isLeaving(positions[pid]) ? invalid : cinfo.getCellId(make_real3(positions[pid]));
+            const int oldSlot = cell_list_incremental::getOldSlot(nullptr, numOldSlots, pid);
+
+            if (oldSlot != invalid && newCells[pid] == slotCells[oldSlot])
+                continue;
+            if (oldSlot != invalid)
+                leaving[oldSlot] = 1;
+            ++numMigrated;
+        }
+
+        if (numMigrated == 0)
+            return 0;
+
+        if (numMigrated > maxMigration * n)
+        {
+            fullBuild(positions, velocities);
+            return numMigrated;
+        }
+
+        leavingScan.resize(numOldSlots + 1);
+        leavingScan[0] = 0;
+        for (int i = 0; i < numOldSlots; ++i)
+            leavingScan[i+1] = leavingScan[i] + leaving[i];
+
+        oldCellStarts = cellStarts;
+        for (int pid = 0; pid < n; ++pid)
+        {
+            const int oldCell = oldCellOf(numOldSlots, pid);
+            if (newCells[pid] == oldCell) continue;
+            if (oldCell   != invalid) --cellSizes[oldCell];
+            if (newCells[pid] != invalid) ++cellSizes[newCells[pid]];
+        }
+        scanCellSizes();
+
+        std::fill(arrivals.begin(), arrivals.end(), 0);
+        order.resize(n);
+        for (int pid = 0; pid < n; ++pid)
+        {
+            const int cid = newCells[pid];
+            if (cid == invalid)
+                order[pid] = invalid;
+            else if (cid == oldCellOf(numOldSlots, pid))
+                order[pid] = cell_list_incremental::getStayingSlot(cid, pid, oldCellStarts.data(),
+                                                                   cellStarts.data(), leavingScan.data());
+            else
+                order[pid] = cell_list_incremental::getArrivingSlot(cid, arrivals[cid]++, oldCellStarts.data(),
+                                                                    cellStarts.data(), leavingScan.data());
+        }
+
+        applyOrder(positions);
+        applyOrder(velocities);
+        computeSlotCells();
+        return numMigrated;
+    }
+
+    CellListInfo cinfo;
+    std::vector<int> cellStarts, cellSizes;
+
+private:
+    static constexpr int invalid = -1;
+
+    static bool isLeaving(real4 r)
+    {
+        return Real3_int(r).isMarked();
+    }
+
+    int oldCellOf(int numOldSlots, int pid) const
+    {
+        const int oldSlot = cell_list_incremental::getOldSlot(nullptr, numOldSlots, pid);
+        return oldSlot == invalid ? invalid : slotCells[oldSlot];
+    }
+
+    void scanCellSizes()
+    {
+        cellStarts[0] = 0;
+        for (int i = 0; i < cinfo.totcells; ++i)
+            cellStarts[i+1] = cellStarts[i] + cellSizes[i];
+    }
+
+    void computeSlotCells()
+    {
+        slotCells.resize(cellStarts[cinfo.totcells]);
+        for (int cid = 0; cid < cinfo.totcells; ++cid)
+            for (int i = cellStarts[cid]; i < cellStarts[cid+1]; ++i)
+                slotCells[i] = cid;
+    }
+
+    /// reorder a channel as a PrimaryCellList does: the leaving particles are removed
+    void applyOrder(std::vector<real4>& channel)
+    {
+        buffer.resize(cellStarts[cinfo.totcells]);
+        for (size_t pid = 0; pid < channel.size(); ++pid)
+            if (order[pid] != invalid)
+                buffer[order[pid]] = channel[pid];
+        std::swap(channel, buffer);
+    }
+
+    std::vector<int> order, slotCells, newCells, leaving, leavingScan, oldCellStarts, arrivals;
+    std::vector<real4> buffer;
+};
+
+struct System
+{
+    System(real3 L_, real density, long seed) :
+        L(L_),
+        gen(seed)
+    {
+        const int n = static_cast<int>(density * L.x * L.y * L.z);
+        for (int i = 0; i < n; ++i)
+            addParticle();
+    }
+
+    /// append a particle at a random position, with the next id
+    void addParticle()
+    {
+        std::uniform_real_distribution<real> u(-0.5_r, 0.5_r);
+        Particle p;
+        p.r = make_real3(u(gen), u(gen), u(gen)) * L;
+        p.u = make_real3(static_cast<real>(nextId), u(gen), u(gen));
+        p.setId(nextId++);
+        positions .push_back(p.r2Real4());
+        velocities.push_back(p.u2Real4());
+    }
+
+    /** emulate a ParticleRedistributor: mark a fraction \p exchanged of the particles as leaving
+        and append as many new particles.
+     */
+    void redistribute(real exchanged)
+    {
+        std::bernoulli_distribution leave(exchanged);
+        int numLeaving = 0;
+
+        for (auto& pos : positions)
+        {
+            if (!leave(gen)) continue;
+            Particle p;
+            p.readCoordinate(&pos, 0);
+            p.mark();
+            pos = p.r2Real4();
+            ++numLeaving;
+        }
+
+        for (int i = 0; i < numLeaving; ++i)
+            addParticle();
+    }
+
+    /// displace all particles by at most \p displacement along each direction, with periodic boundaries
+    void move(real displacement)
+    {
+        std::uniform_real_distribution<real> u(-displacement, displacement);
+
+        for (auto& pos : positions)
+        {
+            Particle p;
+            p.readCoordinate(&pos, 0);
+            p.r += make_real3(u(gen), u(gen), u(gen));
+
+            if (p.r.x < -0.5_r * L.x) p.r.x += L.x;
+            if (p.r.y < -0.5_r * L.y) p.r.y += L.y;
+            if (p.r.z < -0.5_r * L.z) p.r.z += L.z;
+            if (p.r.x >= 0.5_r * L.x) p.r.x -= L.x;
+            if (p.r.y >= 0.5_r * L.y) p.r.y -= L.y;
+            if (p.r.z >= 0.5_r * L.z) p.r.z -= L.z;
+
+            pos = p.r2Real4();
+        }
+    }
+
+    real3 L;
+    std::mt19937 gen;
+    int64_t nextId {0};
+    std::vector<real4> positions, velocities;
+};
+
+/// check that the particles are sorted by cells and that the velocities follow the positions
+void checkSorted(const HostCellList& cl, const std::vector<real4>& positions, const std::vector<real4>& velocities)
+{
+    const int n = static_cast<int>(positions.size());
+    ASSERT_EQ(cl.cellStarts[cl.cinfo.totcells], n);
+
+    for (int cid = 0; cid < cl.cinfo.totcells; ++cid)
+    {
+        for (int i = cl.cellStarts[cid]; i < cl.cellStarts[cid+1]; ++i)
+        {
+            const Particle p(positions[i], velocities[i]);
+            ASSERT_EQ(cl.cinfo.getCellId(p.r), cid);
+            // the velocities were generated with the id of the particle along x
+            ASSERT_EQ(p.u.x, static_cast<real>(p.getId()));
+        }
+    }
+}
+
+/// \return the ids of the particles of each cell, sorted
+std::vector<std::vector<int64_t>> idsPerCell(const HostCellList& cl, const std::vector<real4>& positions)
+{
+    std::vector<std::vector<int64_t>> ids(cl.cinfo.totcells);
+    for (int cid = 0; cid < cl.cinfo.totcells; ++cid)
+    {
+        for (int i = cl.cellStarts[cid]; i < cl.cellStarts[cid+1]; ++i)
+            ids[cid].push_back(Particle(positions[i], make_real4(0.0_r, 0.0_r, 0.0_r, 0.0_r)).getId());
+        std::sort(ids[cid].begin(), ids[cid].end());
+    }
+    return ids;
+}
+} // anonymous namespace
+
+TEST (CELLLISTS_INCREMENTAL, same_cells_as_full_build)
+{
+    const real3 L {16, 12, 10};
+    const real rc = 1.0_r;
+    const int nsteps = 20;
+
+    for (real displacement : {0.0_r, 0.02_r, 0.1_r, 0.5_r})
+    {
+        System sysFull(L, 6.0_r, 4242);
+        System sysIncr(L, 6.0_r, 4242);
+        HostCellList clFull(rc, L), clIncr(rc, L);
+
+        clFull.fullBuild(sysFull.positions, sysFull.velocities);
+        clIncr.fullBuild(sysIncr.positions, sysIncr.velocities);
+
+        for (int step = 0; step < nsteps; ++step)
+        {
+            sysFull.move(displacement);
+
+            // apply the same displacements to the incremental system; the particles are stored in a different order
+            std::vector<int> slotOfId(sysIncr.positions.size());
+            for (size_t i = 0; i < sysIncr.positions.size(); ++i)
+                slotOfId[Real3_int(sysIncr.positions[i]).i] = static_cast<int>(i);
+            for (const auto& r : sysFull.positions)
+                sysIncr.positions[slotOfId[Real3_int(r).i]] = r;
+
+            clFull.fullBuild(sysFull.positions, sysFull.velocities);
+            const int numMigrated = clIncr.incrementalBuild(sysIncr.positions, sysIncr.velocities, 0.1_r);
+
+            if (displacement == 0.0_r)
+            {
+                ASSERT_EQ(numMigrated, 0);
+            }
+
+            checkSorted(clIncr, sysIncr.positions, sysIncr.velocities);
+            ASSERT_EQ(clFull.cellStarts, clIncr.cellStarts);
+            ASSERT_EQ(idsPerCell(clFull, sysFull.positions), idsPerCell(clIncr, sysIncr.positions));
+        }
+    }
+}
+
+TEST (CELLLISTS_INCREMENTAL, same_cells_as_full_build_with_redistribution)
+{
+    const real3 L {16, 12, 10};
+    const real rc = 1.0_r;
+    const int nsteps = 20;
+
+    for (real exchanged : {0.001_r, 0.01_r, 0.2_r})
+    {
+        System sys(L, 6.0_r, 4242);
+        HostCellList clIncr(rc, L);
+        clIncr.fullBuild(sys.positions, sys.velocities);
+
+        for (int step = 0; step < nsteps; ++step)
+        {
+            sys.move(0.02_r);
+            sys.redistribute(exchanged);
+
+            System ref = sys;
+            HostCellList clFull(rc, L);
+            clFull.fullBuild(ref.positions, ref.velocities);
+
+            const int numAppended = static_cast<int>(sys.positions.size()) - clIncr.cellStarts[clIncr.cinfo.totcells];
+            const int numMigrated = clIncr.incrementalBuild(sys.positions, sys.velocities, 0.1_r);
+            ASSERT_GE(numMigrated, numAppended);
+
+            checkSorted(clIncr, sys.positions, sys.velocities);
+            ASSERT_EQ(clFull.cellStarts, clIncr.cellStarts);
+            ASSERT_EQ(idsPerCell(clFull, ref.positions), idsPerCell(clIncr, sys.positions));
+        }
+    }
+}
+
+TEST (CELLLISTS_INCREMENTAL, staying_particles_keep_their_order)
+{
+    const real3 L {12, 12, 12};
+    System sys(L, 8.0_r, 12);
+    HostCellList cl(1.0_r, L);
+    cl.fullBuild(sys.positions, sys.velocities);
+
+    const auto before = sys.positions;
+    sys.move(0.05_r);
+    const auto moved = sys.positions;
+
+    const int numMigrated = cl.incrementalBuild(sys.positions, sys.velocities, 1.0_r);
+    ASSERT_GT(numMigrated, 0);
+
+    // ids of the particles that did not change cell, in their order before and after the build
+    for (int cid = 0; cid < cl.cinfo.totcells; ++cid)
+    {
+        std::vector<int64_t> idsBefore, idsAfter;
+        for (size_t i = 0; i < before.size(); ++i)
+        {
+            const int oldCell = cl.cinfo.getCellId(make_real3(before[i]));
+            const int newCell = cl.cinfo.getCellId(make_real3(moved [i]));
+            if (oldCell == cid && newCell == cid)
+                idsBefore.push_back(Real3_int(before[i]).i);
+        }
+        for (int i = cl.cellStarts[cid]; i < cl.cellStarts[cid+1]; ++i)
+            idsAfter.push_back(Real3_int(sys.positions[i]).i);
+
+        ASSERT_LE(idsBefore.size(), idsAfter.size());
+        idsAfter.resize(idsBefore.size());
+        ASSERT_EQ(idsBefore, idsAfter);
+    }
+}
+
+TEST (CELLLISTS_INCREMENTAL, benchmark)
+{
+    const real3 L {48, 48, 48};
+    const real rc = 1.0_r;
+    const int nsteps = 10;
+    const real maxMigration = 0.1_r;
+
+    // typical displacements per time step of DPD particles are of the order of 0.01 rc;
+    // the exchanged fraction is the fraction of particles that leave the subdomain at every step
+    for (real exchanged : {0.0_r, 0.001_r, 0.01_r})
+    {
+        for (real displacement : {0.0_r, 0.005_r, 0.02_r, 0.1_r})
+        {
+            System sysFull(L, 8.0_r, 1234);
+            System sysIncr(L, 8.0_r, 1234);
+            HostCellList clFull(rc, L), clIncr(rc, L);
+            clFull.fullBuild(sysFull.positions, sysFull.velocities);
+            clIncr.fullBuild(sysIncr.positions, sysIncr.velocities);
+
+            double tFull = 0, tIncr = 0;
+            long numMigrated = 0;
+            int numFallbacks = 0;
+
+            for (int step = 0; step < nsteps; ++step)
+            {
+                sysFull.move(displacement);
+                sysIncr.move(displacement);
+                sysFull.redistribute(exchanged);
+                sysIncr.redistribute(exchanged);
+
+                auto start = std::chrono::high_resolution_clock::now();
+                clFull.fullBuild(sysFull.positions, sysFull.velocities);
+                auto end = std::chrono::high_resolution_clock::now();
+                tFull += std::chrono::duration<double>(end - start).count();
+
+                const size_t n = sysIncr.positions.size();
+                start = std::chrono::high_resolution_clock::now();
+                const int nmigrated = clIncr.incrementalBuild(sysIncr.positions, sysIncr.velocities, maxMigration);
+                end = std::chrono::high_resolution_clock::now();
+                tIncr += std::chrono::duration<double>(end - start).count();
+
+                numMigrated += nmigrated;
+                if (nmigrated > maxMigration * n)
+                    ++numFallbacks;
+            }
+
+            checkSorted(clIncr, sysIncr.positions, sysIncr.velocities);
+
+            printf("%zu particles, displacement %g, exchanged %g%%: %.1f particles (%.3f%%) changed cell per step, "
+                   "full build %g ms, incremental build %g ms (%d full rebuilds), speedup %.2f\n",
+                   sysIncr.positions.size(), displacement, 100.0 * exchanged,
+                   static_cast<double>(numMigrated) / nsteps,
+                   100.0 * numMigrated / (nsteps * sysIncr.positions.size()),
+                   tFull * 1e3 / nsteps, tIncr * 1e3 / nsteps, numFallbacks, tFull / tIncr);
+        }
+    }
+}
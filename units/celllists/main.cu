@@ -6,6 +6,8 @@
 #include <cuda.h>
 #include <cassert>
 #include <algorithm>
+#include <random>
+#include <vector>
 
 #include <mirheo/core/pvs/particle_vector.h>
 #include <mirheo/core/celllist.h>
@@ -18,12 +20,13 @@ using namespace mirheo;
 
 bool verbose = false;
 
-void test_domain(real3 length, real rc, real density, int nbuilds)
+void test_domain(real3 length, real rc, real density, int nbuilds, CellOrdering ordering = CellOrdering::RowMajor)
 {
     bool success = true;
     DomainInfo domain{length, {0,0,0}, length};
     real dt = 0; // dummy dt
     MirState state(domain, dt);
+    state.cellOrdering = ordering;
 
     ParticleVector dpds(&state, "dpd", 1.0f);
     std::unique_ptr<CellList> cells = std::make_unique<PrimaryCellList>(&dpds, rc, length);
@@ -151,6 +154,139 @@ TEST (CELLLISTS, DensityVaries)
     test_domain(domain, rc, 8.0, ncalls);
 }
 
+TEST (CELLLISTS, OrderingVaries)
+{
+    real rc = 1.0, density = 7.5;
+    int ncalls = 1;
+
+    for (auto ordering : {CellOrdering::Morton, CellOrdering::Hilbert})
+    {
+        test_domain(make_real3(64, 64, 64), rc, density, ncalls, ordering);
+        test_domain(make_real3(32, 20, 13), rc, density, ncalls, ordering);
+    }
+}
+
+/// move the particles by small random displacements between the builds and check that the cells stay valid
+template <class CellListType>
+void test_incremental(real3 length, real rc, real density, real displacement, int nsteps, bool deterministic = false)
+{
+    DomainInfo domain{length, {0,0,0}, length};
+    real dt = 0; // dummy dt
+    MirState state(domain, dt);
+    state.incrementalCellLists = true;
+    state.incrementalCellListsMaxMigration = 0.5_r;
+    state.deterministicForces = deterministic;
+
+    ParticleVector dpds(&state, "dpd", 1.0f);
+    auto cells = std::make_unique<CellListType>(&dpds, rc, length);
+
+    UniformIC ic(density);
+    ic.exec(MPI_COMM_WORLD, &dpds, 0);
+
+    const int np = dpds.local()->size();
+    auto& pvPositions  = dpds.local()->positions();
+    auto& pvVelocities = dpds.local()->velocities();
+
+    // reference positions and velocities by particle id
+    pvPositions .downloadFromDevice(defaultStream, ContainersSynch::Asynch);
+    pvVelocities.downloadFromDevice(defaultStream, ContainersSynch::Synch);
+    std::vector<real4> refPos(np), refVel(np);
+    for (int i = 0; i < np; ++i)
+    {
+        const Particle p(pvPositions[i], pvVelocities[i]);
+        refPos[p.getId()] = pvPositions[i];
+        refVel[p.getId()] = pvVelocities[i];
+    }
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<real> u(-displacement, displacement);
+
+    for (int step = 0; step <= nsteps; ++step)
+    {
+        cells->build(defaultStream);
+        dpds.cellListStamp++;
+
+        auto lpv = cells->getLocalParticleVector();
+        auto& positions  = lpv->positions();
+        auto& velocities = lpv->velocities();
+        positions .downloadFromDevice(defaultStream, ContainersSynch::Asynch);
+        velocities.downloadFromDevice(defaultStream, ContainersSynch::Synch);
+
+        HostBuffer<int> hcellsStart(cells->totcells+1);
+        hcellsStart.copy(cells->cellStarts, defaultStream);
+        ASSERT_EQ(hcellsStart[cells->totcells], np);
+
+        std::vector<int> seen(np, 0);
+        for (int cid = 0; cid < cells->totcells; ++cid)
+        {
+            for (int pid = hcellsStart[cid]; pid < hcellsStart[cid+1]; ++pid)
+            {
+                const Particle p(positions[pid], velocities[pid]);
+                const auto id = p.getId();
+                const Particle pRef(refPos[id], refVel[id]);
+
+                ASSERT_EQ(cells->template getCellId<CellListsProjection::NoClamp>(p.r), cid);
+                ASSERT_EQ(p.r.x, pRef.r.x);
+                ASSERT_EQ(p.r.y, pRef.r.y);
+                ASSERT_EQ(p.r.z, pRef.r.z);
+                ASSERT_EQ(p.u.x, pRef.u.x);
+                ASSERT_EQ(p.u.y, pRef.u.y);
+                ASSERT_EQ(p.u.z, pRef.u.z);
+                ++seen[id];
+            }
+        }
+        for (int id = 0; id < np; ++id)
+            ASSERT_EQ(seen[id], 1);
+
+        // move the particles of the attached particle vector
+        pvPositions.downloadFromDevice(defaultStream, ContainersSynch::Synch);
+        for (int i = 0; i < np; ++i)
+        {
+            Particle p;
+            p.readCoordinate(pvPositions.hostPtr(), i);
+            p.r += make_real3(u(gen), u(gen), u(gen));
+            p.r.x = math::min(math::max(p.r.x, -0.5_r * length.x), 0.499_r * length.x);
+            p.r.y = math::min(math::max(p.r.y, -0.5_r * length.y), 0.499_r * length.y);
+            p.r.z = math::min(math::max(p.r.z, -0.5_r * length.z), 0.499_r * length.z);
+            pvPositions[i] = p.r2Real4();
+            refPos[p.getId()] = pvPositions[i];
+        }
+        pvPositions.uploadToDevice(defaultStream);
+    }
+
+    const auto& stats = cells->getBuildStatistics();
+    ASSERT_EQ(stats.numBuilds, nsteps + 1);
+    ASSERT_EQ(stats.numChecks, nsteps);
+
+    if (displacement == 0.0_r)
+    {
+        ASSERT_EQ(stats.numSkippedReorders, nsteps);
+    }
+    else if (!deterministic)
+    {
+        ASSERT_GT(stats.numIncrementalBuilds, 0);
+    }
+
+    if (verbose)
+        printf("%ld builds: %ld full, %ld incremental, %ld without reordering; %ld particles changed cell\n",
+               stats.numBuilds, stats.numFullBuilds, stats.numIncrementalBuilds,
+               stats.numSkippedReorders, stats.numMigratedTotal);
+}
+
+TEST (CELLLISTS, Incremental)
+{
+    const real3 domain = make_real3(24, 16, 12);
+    const real rc = 1.0, density = 8.0;
+    const int nsteps = 5;
+
+    for (real displacement : {0.0_r, 0.01_r, 0.1_r})
+    {
+        test_incremental<PrimaryCellList>(domain, rc, density, displacement, nsteps);
+        test_incremental<CellList>       (domain, rc, density, displacement, nsteps);
+    }
+    test_incremental<PrimaryCellList>(domain, rc, density, 0.01_r, nsteps, true);
+}
+
 int main(int argc, char **argv)
 {
     MPI_Init(&argc, &argv);
@@ -0,0 +1,365 @@
+#include <mirheo/core/celllist.h>
+#include <mirheo/core/interactions/pairwise/host_drivers.h>
+#include <mirheo/core/interactions/pairwise/kernels/norandom_dpd.h>
+#include <mirheo/core/pvs/particle_vector.h>
+#include <mirheo/core/pvs/views/pv.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace mirheo;
+
+namespace
+{
+const CellOrdering allOrderings[] = {CellOrdering::RowMajor, CellOrdering::Morton, CellOrdering::Hilbert};
+
+const char* orderingName(CellOrdering ordering)
+{
+    switch (ordering)
+    {
+    case CellOrdering::RowMajor: return "row_major";
+    case CellOrdering::Morton:   return "morton";
+    case CellOrdering::Hilbert:  return "hilbert";
+    }
+    return "unknown";
+}
+
+CellListInfo makeCellListInfo(int3 ncells, CellOrdering ordering)
+{
+    CellListInfo cinfo(1.0_r, make_real3(ncells));
+    cinfo.ordering = ordering;
+    return cinfo;
+}
+
+std::vector<real4> generatePositions(real3 L, real density, long seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<real> u(-0.5_r, 0.5_r);
+    const int n = static_cast<int>(density * L.x * L.y * L.z);
+
+    std::vector<real4> pos(n);
+    for (int i = 0; i < n; ++i)
+    {
+        Particle p;
+        p.r = make_real3(u(gen), u(gen), u(gen)) * L;
+        p.setId(i);
+        pos[i] = p.r2Real4();
+    }
+    return pos;
+}
+
+/// Particles sorted by cells in host memory
+struct SortedParticles
+{
+    SortedParticles(const CellListInfo& cinfo_, const std::vector<real4>& pos) :
+        cinfo(cinfo_),
+        positions(pos.size()),
+        cellStarts(cinfo.totcells + 1, 0),
+        cellSizes(cinfo.totcells + 1, 0)
+    {
+        for (const auto& r : pos)
+            ++cellSizes[cinfo.getCellId(make_real3(r))];
+
+        for (int i = 0; i < cinfo.totcells; ++i)
+            cellStarts[i+1] = cellStarts[i] + cellSizes[i];
+
+        std::vector<int> offsets(cellStarts);
+        for (const auto& r : pos)
+            positions[offsets[cinfo.getCellId(make_real3(r))]++] = r;
+
+        cinfo.cellStarts = cellStarts.data();
+        cinfo.cellSizes  = cellSizes.data();
+    }
+
+    CellListInfo cinfo;
+    std::vector<real4> positions;
+    std::vector<int> cellStarts, cellSizes;
+};
+
+/// LRU set-associative cache model
+class CacheModel
+{
+public:
+    CacheModel(size_t sizeBytes, int ways, int lineBytes = 64) :
+        ways_(ways),
+        lineBytes_(lineBytes),
+        sets_(sizeBytes / (ways * lineBytes))
+    {}
+
+    void access(const void *ptr)
+    {
+        const size_t line = reinterpret_cast<size_t>(ptr) / lineBytes_;
+        auto& set = sets_[line % sets_.size()];
+
+        for (auto it = set.begin(); it != set.end(); ++it)
+        {
+            if (*it == line)
+            {
+                set.splice(set.begin(), set, it);
+                return;
+            }
+        }
+        ++misses;
+        set.push_front(line);
+        if (static_cast<int>(set.size()) > ways_)
+            set.pop_back();
+    }
+
+    long misses {0};
+
+private:
+    int ways_;
+    size_t lineBytes_;
+    std::vector<std::list<size_t>> sets_;
+};
+
+/// Hardware cache miss counter of the calling thread; invalid if the system does not allow it
+class CacheMissCounter
+{
+public:
+    CacheMissCounter()
+    {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter()
+    {
+#ifdef __linux__
+        if (valid())
+            close(fd_);
+#endif
+    }
+
+    bool valid() const {return fd_ >= 0;}
+
+    void start()
+    {
+#ifdef __linux__
+        if (!valid()) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    long stop()
+    {
+        long long count = 0;
+#ifdef __linux__
+        if (!valid()) return -1;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd_, &count, sizeof(count)) != sizeof(count))
+            return -1;
+#endif
+        return static_cast<long>(count);
+    }
+
+private:
+    int fd_ {-1};
+};
+
+/** Visit all pairs within rc of the half stencil, in memory order.
+    \return the number of pairs within rc
+ */
+template <typename OnAccess>
+long traverseNeighbours(const CellListInfo& cinfo, const real4 *positions, int n, OnAccess&& onAccess)
+{
+    long npairs = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        const real3 r0 = make_real3(positions[i]);
+        const int3 c = cinfo.getCellIdAlongAxes(r0);
+
+        auto visitRow = [&](int xs, int xe, int y, int z, int pendMax)
+        {
+            const int2 range = pairwise_host::details::getRowRange(cinfo, xs, xe, y, z);
+            const int pend = math::min(range.y, pendMax);
+            for (int j = range.x; j < pend; ++j)
+            {
+                onAccess(positions + j);
+                const real3 dr = make_real3(positions[j]) - r0;
+                npairs += dot(dr, dr) < 1.0_r;
+            }
+        };
+
+        for (int dz = -1; dz <= 1; ++dz)
+            visitRow(c.x-1, c.x+1, c.y-1, c.z+dz, n);
+        visitRow(c.x-1, c.x+1, c.y, c.z-1, n);
+        visitRow(c.x-1, c.x, c.y, c.z, i);
+    }
+    return npairs;
+}
+} // anonymous namespace
+
+TEST (CELLLISTS_ORDERING, encode_decode_are_inverse)
+{
+    for (const int3 ncells : {int3{5, 7, 9}, int3{16, 16, 16}, int3{3, 13, 20}, int3{8, 8, 8}, int3{1, 1, 1}, int3{4, 24, 17}})
+    {
+        for (auto ordering : allOrderings)
+        {
+            const auto cinfo = makeCellListInfo(ncells, ordering);
+            std::vector<int> visited(cinfo.totcells, 0);
+
+            for (int iz = 0; iz < ncells.z; ++iz)
+            for (int iy = 0; iy < ncells.y; ++iy)
+            for (int ix = 0; ix < ncells.x; ++ix)
+            {
+                const int cid = cinfo.encode(ix, iy, iz);
+                ASSERT_GE(cid, 0);
+                ASSERT_LT(cid, cinfo.totcells);
+                ++visited[cid];
+
+                const int3 c = cinfo.decode(cid);
+                ASSERT_EQ(c.x, ix);
+                ASSERT_EQ(c.y, iy);
+                ASSERT_EQ(c.z, iz);
+
+                // the rows are contiguous
+                if (ix > 0)
+                {
+                    ASSERT_EQ(cid, cinfo.encode(ix-1, iy, iz) + 1);
+                }
+            }
+
+            for (auto v : visited)
+                ASSERT_EQ(v, 1);
+        }
+    }
+}
+
+TEST (CELLLISTS_ORDERING, hilbert_rows_are_adjacent_inside_tiles)
+{
+    const int n = 4 * CellListInfo::rowTileSize;
+    const auto cinfo = makeCellListInfo({2, n, n}, CellOrdering::Hilbert);
+
+    for (int row = 0; row + 1 < n * n; ++row)
+    {
+        const int3 a = cinfo.decode(row       * cinfo.ncells.x);
+        const int3 b = cinfo.decode((row + 1) * cinfo.ncells.x);
+        const int dist = std::abs(a.y - b.y) + std::abs(a.z - b.z);
+
+        if ((row + 1) % (CellListInfo::rowTileSize * CellListInfo::rowTileSize) != 0)
+        {
+            ASSERT_EQ(dist, 1);
+        }
+    }
+}
+
+TEST (CELLLISTS_ORDERING, forces_do_not_depend_on_ordering)
+{
+    const real rc = 1.0_r;
+    const real3 L {12, 20, 18};
+    DomainInfo domain {L, {0, 0, 0}, L};
+    MirState state(domain, 0.001_r);
+
+    PairwiseNoRandomDPD dpd(rc, NoRandomDPDParams {50.0_r, 20.0_r, 1.0_r, 1.0_r});
+    dpd.setup(nullptr, nullptr, nullptr, nullptr, &state);
+
+    const auto pos = generatePositions(L, 4.0_r, 42);
+    const std::vector<real4> vel(pos.size(), make_real4(0.1_r, -0.2_r, 0.3_r, 0.0_r));
+
+    std::vector<std::vector<real3>> forcesById;
+
+    for (auto ordering : allOrderings)
+    {
+        CellListInfo cinfo(rc, L);
+        cinfo.ordering = ordering;
+        SortedParticles sorted(cinfo, pos);
+
+        ParticleVector pv(&state, "pv", 1.0_r);
+        auto lpv = pv.local();
+        lpv->resize_anew(static_cast<int>(pos.size()));
+        std::copy(sorted.positions.begin(), sorted.positions.end(), lpv->positions().begin());
+        std::copy(vel.begin(), vel.end(), lpv->velocities().begin());
+        for (auto& f : lpv->forces())
+            f = Force(make_real3(0.0_r), 0);
+
+        PVview view(&pv, lpv);
+        view.positions  = lpv->positions ().hostPtr();
+        view.velocities = lpv->velocities().hostPtr();
+        view.forces     = reinterpret_cast<real4*>(lpv->forces().hostPtr());
+
+        pairwise_host::computeSelfInteractions(sorted.cinfo, view, dpd.handler(), rc);
+
+        std::vector<real3> forces(pos.size());
+        for (int i = 0; i < lpv->size(); ++i)
+        {
+            const Particle p(lpv->positions()[i], make_real4(0.0_r));
+            forces[p.getId()] = lpv->forces()[i].f;
+        }
+        forcesById.push_back(forces);
+    }
+
+    for (size_t k = 1; k < forcesById.size(); ++k)
+    {
+        for (size_t i = 0; i < pos.size(); ++i)
+        {
+            const real3 d = forcesById[k][i] - forcesById[0][i];
+            ASSERT_LE(math::max(math::abs(d.x), math::max(math::abs(d.y), math::abs(d.z))), 1e-3_r);
+        }
+    }
+}
+
+TEST (CELLLISTS_ORDERING, benchmark)
+{
+    const real3 L {48, 48, 48};
+    const auto pos = generatePositions(L, 8.0_r, 1234);
+    const int n = static_cast<int>(pos.size());
+    const int nrepeat = 3;
+
+    // simulated caches of the sizes of L1, L2 and part of a L3 cache
+    const size_t cacheSizes[] = {64 * 1024, 256 * 1024, 1024 * 1024};
+    const int cacheWays = 16;
+
+    for (auto ordering : allOrderings)
+    {
+        CellListInfo cinfo(1.0_r, L);
+        cinfo.ordering = ordering;
+        SortedParticles sorted(cinfo, pos);
+
+        CacheMissCounter counter;
+        long npairs = 0;
+        counter.start();
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < nrepeat; ++i)
+            npairs += traverseNeighbours(sorted.cinfo, sorted.positions.data(), n, [](const real4*) {});
+        const auto end = std::chrono::high_resolution_clock::now();
+        const long hwMisses = counter.stop();
+        const double t = std::chrono::duration<double>(end - start).count() / nrepeat;
+
+        printf("%d particles, %s ordering: %ld pairs, traversal %g ms, hardware cache misses %s\n",
+               n, orderingName(ordering), npairs / nrepeat, t * 1e3,
+               hwMisses >= 0 ? std::to_string(hwMisses / nrepeat).c_str() : "unavailable");
+
+        for (auto cacheSize : cacheSizes)
+        {
+            CacheModel cache(cacheSize, cacheWays);
+            traverseNeighbours(sorted.cinfo, sorted.positions.data(), n,
+                               [&cache](const real4 *ptr) {cache.access(ptr);});
+            printf("    simulated %zu KiB cache: %ld misses\n", cacheSize / 1024, cache.misses);
+        }
+    }
+}
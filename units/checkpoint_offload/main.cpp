@@ -0,0 +1,230 @@
+#include <mirheo/core/analytical_shapes/api.h>
+#include <mirheo/core/initial_conditions/rigid.h>
+#include <mirheo/core/initial_conditions/uniform.h>
+#include <mirheo/core/logger.h>
+#include <mirheo/core/pvs/checkpoint/writer.h>
+#include <mirheo/core/pvs/particle_vector.h>
+#include <mirheo/core/pvs/rigid_ashape_object_vector.h>
+#include <mirheo/core/utils/cuda_common.h>
+#include <mirheo/core/utils/path.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+using namespace mirheo;
+
+// The first half of the ranks is the simulation, the second half the postprocess.
+// Checkpoints written directly and offloaded to the postprocess must be identical.
+
+const std::string directPath  = "direct/";
+const std::string offloadPath = "offload/";
+constexpr real mass = 1;
+
+struct Comms
+{
+    Comms()
+    {
+        int rank, size;
+        MPI_Check( MPI_Comm_rank(MPI_COMM_WORLD, &rank) );
+        MPI_Check( MPI_Comm_size(MPI_COMM_WORLD, &size) );
+
+        isSimulation = rank < size / 2;
+        MPI_Check( MPI_Comm_split(MPI_COMM_WORLD, isSimulation, rank, &local) );
+
+        const int localLeader = 0;
+        const int remoteLeader = isSimulation ? size / 2 : 0;
+        const int tag = 42;
+        MPI_Check( MPI_Intercomm_create(local, localLeader, MPI_COMM_WORLD, remoteLeader, tag, &inter) );
+
+        if (isSimulation)
+        {
+            int nranks;
+            MPI_Check( MPI_Comm_size(local, &nranks) );
+            int dims[3] = {0, 0, 0};
+            const int periods[] = {1, 1, 1};
+            MPI_Check( MPI_Dims_create(nranks, 3, dims) );
+            MPI_Check( MPI_Cart_create(local, 3, dims, periods, 0, &cart) );
+        }
+    }
+
+    ~Comms()
+    {
+        if (cart != MPI_COMM_NULL)
+            MPI_Check( MPI_Comm_free(&cart) );
+        MPI_Check( MPI_Comm_free(&inter) );
+        MPI_Check( MPI_Comm_free(&local) );
+    }
+
+    bool isSimulation;
+    MPI_Comm local, inter;
+    MPI_Comm cart {MPI_COMM_NULL};
+};
+
+using CheckpointFunc = std::function<void(MPI_Comm, const std::string&, CheckpointWriter&)>;
+
+// write the same checkpoint directly and through the postprocess ranks
+static void checkpointBothWays(const Comms& comms, const CheckpointFunc& checkpoint)
+{
+    if (comms.isSimulation)
+    {
+        createFoldersCollective(comms.cart, directPath);
+        createFoldersCollective(comms.cart, offloadPath);
+
+        DirectCheckpointWriter direct;
+        checkpoint(comms.cart, directPath, direct);
+
+        OffloadCheckpointWriter offload(comms.inter);
+        checkpoint(comms.cart, offloadPath, offload);
+        offload.send(comms.cart);
+        offload.wait();
+    }
+    else
+    {
+        int rank;
+        int64_t header[2];
+        MPI_Check( MPI_Comm_rank(comms.local, &rank) );
+        MPI_Check( MPI_Recv(header, 2, MPI_INT64_T, rank, checkpointDataTag, comms.inter, MPI_STATUS_IGNORE) );
+        receiveAndWriteCheckpoint(comms.local, comms.inter, header);
+    }
+    MPI_Check( MPI_Barrier(MPI_COMM_WORLD) );
+}
+
+template <class T>
+static void compare(const std::string& name, PinnedBuffer<T>& a, PinnedBuffer<T>& b)
+{
+    ASSERT_EQ(a.size(), b.size()) << "channel " << name << " have different sizes";
+    a.downloadFromDevice(defaultStream, ContainersSynch::Synch);
+    b.downloadFromDevice(defaultStream, ContainersSynch::Synch);
+    ASSERT_EQ(0, memcmp(a.hostPtr(), b.hostPtr(), a.size() * sizeof(T))) << "channel " << name << " differs";
+}
+
+static void compare(const DataManager& a, const DataManager& b)
+{
+    const auto& sca = a.getSortedChannels();
+    const auto& scb = b.getSortedChannels();
+
+    ASSERT_EQ(sca.size(), scb.size()) << "different number of channels";
+
+    for (size_t i = 0; i < sca.size(); ++i)
+    {
+        ASSERT_EQ(sca[i].first, scb[i].first);
+        std::visit([&](auto aPtr)
+        {
+            using T = typename std::remove_pointer<decltype(aPtr)>::type::value_type;
+            auto bPtr = std::get<PinnedBuffer<T>*>(scb[i].second->varDataPtr);
+            compare(sca[i].first, *aPtr, *bPtr);
+        }, sca[i].second->varDataPtr);
+    }
+}
+
+static std::vector<char> readFile(const std::string& fname)
+{
+    std::ifstream f(fname, std::ios::binary);
+    return {std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>()};
+}
+
+TEST (CHECKPOINT_OFFLOAD, pv)
+{
+    Comms comms;
+    const std::string pvName = "pv";
+    const real L = 32.0_r;
+    const real density = 4.0_r;
+    const int checkpointId = 3;
+
+    std::unique_ptr<MirState> state;
+    std::unique_ptr<ParticleVector> pv;
+
+    if (comms.isSimulation)
+    {
+        state = std::make_unique<MirState>(createDomainInfo(comms.cart, {L, L, L}), 0.0_r);
+        pv = std::make_unique<ParticleVector>(state.get(), pvName, mass);
+        UniformIC ic(density);
+        ic.exec(comms.cart, pv.get(), defaultStream);
+    }
+
+    checkpointBothWays(comms, [&](MPI_Comm comm, const std::string& path, CheckpointWriter& writer)
+    {
+        pv->checkpoint(comm, path, checkpointId, writer);
+    });
+
+    if (comms.isSimulation)
+    {
+        ParticleVector pvDirect (state.get(), pvName, mass);
+        ParticleVector pvOffload(state.get(), pvName, mass);
+        pvDirect .restart(comms.cart, directPath);
+        pvOffload.restart(comms.cart, offloadPath);
+
+        compare(pvDirect.local()->dataPerParticle, pvOffload.local()->dataPerParticle);
+    }
+}
+
+TEST (CHECKPOINT_OFFLOAD, rov)
+{
+    Comms comms;
+    const std::string rovName = "rov";
+    const real L = 32.0_r;
+    const int objSize = 42;
+    const Ellipsoid ellipsoid({1.0_r, 2.0_r, 1.5_r});
+    const int checkpointId = 1;
+
+    std::unique_ptr<MirState> state;
+    std::unique_ptr<RigidShapedObjectVector<Ellipsoid>> rov;
+
+    if (comms.isSimulation)
+    {
+        state = std::make_unique<MirState>(createDomainInfo(comms.cart, {L, L, L}), 0.0_r);
+        rov = std::make_unique<RigidShapedObjectVector<Ellipsoid>>(state.get(), rovName, mass, objSize, ellipsoid);
+
+        std::vector<ComQ> comQ;
+        for (int i = 0; i < 64; ++i)
+            comQ.push_back({{(i % 4 + 0.5_r) * L / 4, (i / 4 % 4 + 0.5_r) * L / 4, (i / 16 + 0.5_r) * L / 4},
+                            {1.0_r, 0.0_r, 0.0_r, 0.0_r}});
+
+        std::vector<real3> coords;
+        for (int i = 0; i < objSize; ++i)
+            coords.push_back({0.01_r * i, -0.02_r * i, 0.005_r * i});
+
+        RigidIC ic(comQ, coords);
+        ic.exec(comms.cart, rov.get(), defaultStream);
+    }
+
+    checkpointBothWays(comms, [&](MPI_Comm comm, const std::string& path, CheckpointWriter& writer)
+    {
+        rov->checkpoint(comm, path, checkpointId, writer);
+    });
+
+    if (comms.isSimulation)
+    {
+        RigidShapedObjectVector<Ellipsoid> rovDirect (state.get(), rovName, mass, objSize, ellipsoid);
+        RigidShapedObjectVector<Ellipsoid> rovOffload(state.get(), rovName, mass, objSize, ellipsoid);
+        rovDirect .restart(comms.cart, directPath);
+        rovOffload.restart(comms.cart, offloadPath);
+
+        compare(rovDirect.local()->dataPerParticle, rovOffload.local()->dataPerParticle);
+        compare(rovDirect.local()->dataPerObject,   rovOffload.local()->dataPerObject);
+
+        const auto ipDirect  = readFile(directPath  + rovName + ".ROV.TEMPLATE.coords");
+        const auto ipOffload = readFile(offloadPath + rovName + ".ROV.TEMPLATE.coords");
+        ASSERT_EQ(ipDirect.size(), objSize * sizeof(real4));
+        ASSERT_EQ(ipDirect, ipOffload);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+
+    logger.init(MPI_COMM_WORLD, "checkpoint_offload.log", 3);
+
+    testing::InitGoogleTest(&argc, argv);
+    auto retval = RUN_ALL_TESTS();
+
+    MPI_Finalize();
+    return retval;
+}
@@ -0,0 +1,15 @@
+#include "host_reference.h"
+
+#include <mirheo/core/interactions/pairwise/gather.h>
+#include <mirheo/core/interactions/pairwise/kernels/norandom_dpd.h>
+
+namespace mirheo
+{
+void computeNoRandomDPDGatherHost(const CellListInfo& cinfo, PVview view, real rc,
+                                  const NoRandomDPDParams& params, const MirState *state)
+{
+    PairwiseNoRandomDPD kernel(rc, params);
+    kernel.setup(nullptr, nullptr, nullptr, nullptr, state);
+    pairwise_gather::computeSelfInteractionsGatherHost(cinfo, view, kernel.handler());
+}
+} // namespace mirheo
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <mirheo/core/celllist.h>
+#include <mirheo/core/interactions/pairwise/kernels/parameters.h>
+#include <mirheo/core/pvs/views/pv.h>
+
+namespace mirheo
+{
+/** Compute the NoRandomDPD self interactions on the host, in the same order as the deterministic GPU driver.
+    Compiled by the host compiler, where the pairwise kernels are host functions.
+ */
+void computeNoRandomDPDGatherHost(const CellListInfo& cinfo, PVview view, real rc,
+                                  const NoRandomDPDParams& params, const MirState *state);
+} // namespace mirheo
@@ -0,0 +1,293 @@
+#include <mirheo/core/celllist.h>
+#include <mirheo/core/containers.h>
+#include <mirheo/core/initial_conditions/uniform.h>
+#include <mirheo/core/interactions/pairwise/kernels/norandom_dpd.h>
+#include <mirheo/core/interactions/pairwise/norandom_dpd.h>
+#include <mirheo/core/logger.h>
+#include <mirheo/core/pvs/particle_vector.h>
+#include <mirheo/core/pvs/views/pv.h>
+
+#include "host_reference.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace mirheo;
+
+static const real rc = 1.0_r;
+static const NoRandomDPDParams dpdParams {50.0_r, 20.0_r, 1.0_r, 0.5_r};
+
+/// The particles of a ParticleVector, in an arbitrary order
+struct ParticleSet
+{
+    std::vector<real4> positions, velocities;
+};
+
+using ForcesById = std::map<int64_t, real3>;
+
+static ParticleSet generateParticles(MirState *state, real density, long seed)
+{
+    ParticleVector pv(state, "tmp", 1.0_r);
+    UniformIC ic(density);
+    ic.exec(MPI_COMM_WORLD, &pv, defaultStream);
+
+    auto& pos = pv.local()->positions();
+    auto& vel = pv.local()->velocities();
+    pos.downloadFromDevice(defaultStream, ContainersSynch::Asynch);
+    vel.downloadFromDevice(defaultStream);
+
+    ParticleSet set {{pos.begin(), pos.end()}, {vel.begin(), vel.end()}};
+
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<real> u(-1.0_r, 1.0_r);
+    for (auto& v : set.velocities)
+    {
+        v.x = u(gen);
+        v.y = u(gen);
+        v.z = u(gen);
+    }
+    return set;
+}
+
+static ParticleSet shuffled(const ParticleSet& set, long seed)
+{
+    std::vector<size_t> perm(set.positions.size());
+    for (size_t i = 0; i < perm.size(); ++i)
+        perm[i] = i;
+    std::shuffle(perm.begin(), perm.end(), std::mt19937(seed));
+
+    ParticleSet s;
+    for (auto i : perm)
+    {
+        s.positions .push_back(set.positions [i]);
+        s.velocities.push_back(set.velocities[i]);
+    }
+    return s;
+}
+
+static void setParticles(ParticleVector *pv, const ParticleSet& set)
+{
+    const int n = static_cast<int>(set.positions.size());
+    auto lpv = pv->local();
+    lpv->resize_anew(n);
+    std::copy(set.positions .begin(), set.positions .end(), lpv->positions ().begin());
+    std::copy(set.velocities.begin(), set.velocities.end(), lpv->velocities().begin());
+    lpv->positions ().uploadToDevice(defaultStream);
+    lpv->velocities().uploadToDevice(defaultStream);
+    pv->cellListStamp++;
+}
+
+static ForcesById getForcesById(ParticleVector *pv)
+{
+    auto lpv = pv->local();
+    lpv->positions().downloadFromDevice(defaultStream, ContainersSynch::Asynch);
+    lpv->forces()   .downloadFromDevice(defaultStream);
+
+    ForcesById forces;
+    for (int i = 0; i < lpv->size(); ++i)
+    {
+        const Particle p(lpv->positions()[i], make_real4(0.0_r));
+        forces[p.getId()] = lpv->forces()[i].f;
+    }
+    return forces;
+}
+
+/// Compute the forces of the particles of pv1 due to the particles of pv1 and pv2
+static std::pair<ForcesById, ForcesById> computeForces(MirState *state, const ParticleSet& set1, const ParticleSet& set2)
+{
+    const real3 L = state->domain.localSize;
+    ParticleVector pv1(state, "pv1", 1.0_r);
+    ParticleVector pv2(state, "pv2", 1.0_r);
+    setParticles(&pv1, set1);
+    setParticles(&pv2, set2);
+
+    PrimaryCellList cl1(&pv1, rc, L);
+    PrimaryCellList cl2(&pv2, rc, L);
+    cl1.build(defaultStream);
+    cl2.build(defaultStream);
+
+    PairwiseNoRandomDPDInteraction dpd(state, "dpd", rc, dpdParams);
+    dpd.setPrerequisites(&pv1, &pv1, &cl1, &cl1);
+    dpd.setPrerequisites(&pv1, &pv2, &cl1, &cl2);
+
+    pv1.local()->forces().clear(defaultStream);
+    pv2.local()->forces().clear(defaultStream);
+
+    dpd.local(&pv1, &pv1, &cl1, &cl1, defaultStream);
+    dpd.local(&pv1, &pv2, &cl1, &cl2, defaultStream);
+
+    CUDA_Check( cudaDeviceSynchronize() );
+
+    return {getForcesById(&pv1), getForcesById(&pv2)};
+}
+
+static bool bitwiseEqual(const ForcesById& a, const ForcesById& b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    for (const auto& fa : a)
+    {
+        const auto it = b.find(fa.first);
+        if (it == b.end())
+            return false;
+
+        const real3 fb = it->second;
+        if (fa.second.x != fb.x || fa.second.y != fb.y || fa.second.z != fb.z)
+            return false;
+    }
+    return true;
+}
+
+static real maxDifference(const ForcesById& a, const ForcesById& b)
+{
+    real err = 0;
+    for (const auto& fa : a)
+    {
+        const real3 d = fa.second - b.at(fa.first);
+        err = std::max(err, std::max(math::abs(d.x), std::max(math::abs(d.y), math::abs(d.z))));
+    }
+    return err;
+}
+
+class DeterministicForces : public ::testing::Test
+{
+protected:
+    DeterministicForces() :
+        domain {L, {0, 0, 0}, L},
+        state(domain, 0.001_r)
+    {}
+
+    const real3 L {16, 12, 10};
+    DomainInfo domain;
+    MirState state;
+};
+
+TEST_F(DeterministicForces, forces_do_not_depend_on_particle_order)
+{
+    state.deterministicForces = true;
+    const auto set1 = generateParticles(&state, 8.0_r, 42);
+    const auto set2 = generateParticles(&state, 2.0_r, 43);
+
+    const auto ref = computeForces(&state, set1, set2);
+
+    for (long seed = 0; seed < 3; ++seed)
+    {
+        const auto f = computeForces(&state, shuffled(set1, seed), shuffled(set2, 10 + seed));
+        ASSERT_TRUE(bitwiseEqual(ref.first,  f.first));
+        ASSERT_TRUE(bitwiseEqual(ref.second, f.second));
+    }
+}
+
+TEST_F(DeterministicForces, same_as_atomic_accumulation)
+{
+    const auto set1 = generateParticles(&state, 8.0_r, 42);
+    const auto set2 = generateParticles(&state, 2.0_r, 43);
+
+    state.deterministicForces = false;
+    const auto atomic = computeForces(&state, set1, set2);
+
+    state.deterministicForces = true;
+    const auto deterministic = computeForces(&state, set1, set2);
+
+    const real tol = 1e-3_r;
+    ASSERT_LE(maxDifference(atomic.first,  deterministic.first),  tol);
+    ASSERT_LE(maxDifference(atomic.second, deterministic.second), tol);
+}
+
+TEST_F(DeterministicForces, same_as_host_reference)
+{
+    state.deterministicForces = true;
+    const auto set = generateParticles(&state, 8.0_r, 42);
+
+    ParticleVector pv(&state, "pv", 1.0_r);
+    setParticles(&pv, set);
+    PrimaryCellList cl(&pv, rc, L);
+    cl.build(defaultStream);
+
+    PairwiseNoRandomDPDInteraction dpd(&state, "dpd", rc, dpdParams);
+    pv.local()->forces().clear(defaultStream);
+    dpd.local(&pv, &pv, &cl, &cl, defaultStream);
+
+    auto lpv = pv.local();
+    CellListInfo cinfo = cl.cellInfo();
+    std::vector<int> cellStarts(cinfo.totcells + 1);
+    CUDA_Check( cudaMemcpy(cellStarts.data(), cinfo.cellStarts, cellStarts.size() * sizeof(int), cudaMemcpyDeviceToHost) );
+    cinfo.cellStarts = cellStarts.data();
+
+    lpv->positions() .downloadFromDevice(defaultStream, ContainersSynch::Asynch);
+    lpv->velocities().downloadFromDevice(defaultStream, ContainersSynch::Asynch);
+    lpv->forces()    .downloadFromDevice(defaultStream);
+
+    const std::vector<Force> gpuForces(lpv->forces().begin(), lpv->forces().end());
+
+    // same data, pointing to host memory
+    PVview view(&pv, lpv);
+    view.positions  = lpv->positions ().hostPtr();
+    view.velocities = lpv->velocities().hostPtr();
+    view.forces     = reinterpret_cast<real4*>(lpv->forces().hostPtr());
+    std::fill(lpv->forces().begin(), lpv->forces().end(), Force(make_real3(0.0_r), 0));
+
+    computeNoRandomDPDGatherHost(cinfo, view, rc, dpdParams, &state);
+
+    real err = 0;
+    for (int i = 0; i < lpv->size(); ++i)
+    {
+        const real3 d = gpuForces[i].f - lpv->forces()[i].f;
+        err = std::max(err, std::max(math::abs(d.x), std::max(math::abs(d.y), math::abs(d.z))));
+    }
+    ASSERT_LE(err, 1e-4_r);
+}
+
+TEST_F(DeterministicForces, benchmark)
+{
+    const auto set = generateParticles(&state, 8.0_r, 42);
+    const int nrepeat = 20;
+
+    for (bool deterministic : {false, true})
+    {
+        state.deterministicForces = deterministic;
+
+        ParticleVector pv(&state, "pv", 1.0_r);
+        setParticles(&pv, set);
+        PrimaryCellList cl(&pv, rc, L);
+        cl.build(defaultStream);
+
+        PairwiseNoRandomDPDInteraction dpd(&state, "dpd", rc, dpdParams);
+
+        CUDA_Check( cudaDeviceSynchronize() );
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        for (int i = 0; i < nrepeat; ++i)
+        {
+            pv.local()->forces().clear(defaultStream);
+            dpd.local(&pv, &pv, &cl, &cl, defaultStream);
+        }
+
+        CUDA_Check( cudaDeviceSynchronize() );
+        const auto end = std::chrono::high_resolution_clock::now();
+        const double t = std::chrono::duration<double>(end - start).count() / nrepeat;
+
+        printf("%s accumulation: %d particles, %g ms per evaluation, %g Mparticles/s\n",
+               deterministic ? "deterministic" : "atomic", pv.local()->size(),
+               t * 1e3, pv.local()->size() / t * 1e-6);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+    logger.init(MPI_COMM_WORLD, "deterministic_forces.log", 0);
+
+    testing::InitGoogleTest(&argc, argv);
+    auto ret = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return ret;
+}
@@ -0,0 +1,200 @@
+#include <mirheo/core/ensemble.h>
+#include <mirheo/core/initial_conditions/uniform.h>
+#include <mirheo/core/integrators/factory.h>
+#include <mirheo/core/interactions/factory.h>
+#include <mirheo/core/interactions/pairwise/base_pairwise.h>
+#include <mirheo/core/logger.h>
+#include <mirheo/core/mirheo.h>
+#include <mirheo/core/pvs/particle_vector.h>
+#include <mirheo/core/utils/cuda_common.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace mirheo;
+
+static const int3 nranks3D {1, 1, 1};
+static const real3 domain {8.0_r, 8.0_r, 8.0_r};
+static const real numberDensity = 4.0_r;
+static const real rc = 1.0_r;
+static const real dt = 0.005_r;
+
+/// set up a DPD fluid in a periodic box; the conservative coefficient distinguishes the replicas
+static std::shared_ptr<ParticleVector> setupDPD(Mirheo *u, real a)
+{
+    const MirState *state = u->getState();
+
+    auto pv = std::make_shared<ParticleVector>(state, "pv", 1.0_r);
+    u->registerParticleVector(pv, std::make_shared<UniformIC>(numberDensity));
+
+    auto dpd = interaction_factory::createPairwiseInteraction(
+        state, "dpd", rc, "DPD", {{"a", a}, {"gamma", 20.0_r}, {"kBT", 1.0_r}, {"power", 0.5_r}});
+    u->registerInteraction(dpd);
+    u->setInteraction(dpd.get(), pv.get(), pv.get());
+
+    auto vv = integrator_factory::createVV(state, "vv");
+    u->registerIntegrator(vv);
+    u->setIntegrator(vv.get(), pv.get());
+
+    u->setDeterministicForces(true);
+    return pv;
+}
+
+static std::vector<real4> downloadPositions(ParticleVector *pv)
+{
+    auto& pos = pv->local()->positions();
+    pos.downloadFromDevice(defaultStream, ContainersSynch::Synch);
+    return {pos.begin(), pos.end()};
+}
+
+static bool sameBits(const std::vector<real4>& a, const std::vector<real4>& b)
+{
+    return a.size() == b.size() &&
+        0 == memcmp(a.data(), b.data(), a.size() * sizeof(real4));
+}
+
+TEST (ENSEMBLE, replicas_match_single_simulations)
+{
+    const MirState::StepType nsteps = 50;
+    const real a0 = 10.0_r;
+    const real a1 = 20.0_r;
+
+    std::vector<real4> reference0, reference1;
+    {
+        Mirheo u(MPI_COMM_WORLD, nranks3D, domain, LogInfo("ensemble_single", 3, true), CheckpointInfo{}, 0.0_r);
+        auto pv = setupDPD(&u, a0);
+        u.run(nsteps, dt);
+        reference0 = downloadPositions(pv.get());
+    }
+    {
+        Mirheo u(MPI_COMM_WORLD, nranks3D, domain, LogInfo("ensemble_single", 3, true), CheckpointInfo{}, 0.0_r);
+        auto pv = setupDPD(&u, a1);
+        u.run(nsteps, dt);
+        reference1 = downloadPositions(pv.get());
+    }
+
+    Ensemble ens(MPI_COMM_WORLD, 3, nranks3D, domain, LogInfo("ensemble", 3, true), CheckpointInfo{}, 0.0_r);
+    ASSERT_EQ(ens.getNumReplicas(), 3);
+
+    auto pv0 = setupDPD(ens.getReplica(0), a0);
+    auto pv1 = setupDPD(ens.getReplica(1), a1);
+    auto pv2 = setupDPD(ens.getReplica(2), a0);
+
+    ens.run(nsteps, dt);
+
+    const auto pos0 = downloadPositions(pv0.get());
+    const auto pos1 = downloadPositions(pv1.get());
+    const auto pos2 = downloadPositions(pv2.get());
+
+    // interleaving the steps of the replicas does not change their trajectories
+    ASSERT_TRUE(sameBits(pos0, reference0));
+    ASSERT_TRUE(sameBits(pos1, reference1));
+    ASSERT_TRUE(sameBits(pos2, reference0));
+    ASSERT_FALSE(sameBits(pos0, pos1));
+
+    for (int i = 0; i < ens.getNumReplicas(); ++i)
+        ASSERT_EQ(ens.getReplica(i)->getState()->currentStep, nsteps);
+}
+
+/// run one simulation, as one job of the separate jobs benchmark
+static void runSingleJob(MirState::StepType nsteps)
+{
+    Mirheo u(MPI_COMM_WORLD, nranks3D, domain, LogInfo("ensemble_single_job", 3, true), CheckpointInfo{}, 0.0_r);
+    setupDPD(&u, 10.0_r);
+    u.run(nsteps, dt);
+}
+
+static std::string getExecutablePath()
+{
+    char path[4096];
+    const ssize_t n = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (n < 0)
+        die("Could not find the path of the executable");
+    path[n] = '\0';
+    return path;
+}
+
+/// \return the wall time of \p njobs instances of this executable running one simulation each, all at the same time
+static double timeSeparateJobs(int njobs, MirState::StepType nsteps)
+{
+    // a clean environment, so that the jobs do not join the MPI job of this process
+    const std::string job = "env -i PATH=\"$PATH\" LD_LIBRARY_PATH=\"$LD_LIBRARY_PATH\" "
+        "CUDA_VISIBLE_DEVICES=\"$CUDA_VISIBLE_DEVICES\" " + getExecutablePath() +
+        " --single-job " + std::to_string(nsteps) + " > /dev/null 2>&1 &";
+
+    std::string cmd;
+    for (int i = 0; i < njobs; ++i)
+        cmd += job + "\n";
+    cmd += "wait";
+
+    const double start = MPI_Wtime();
+    if (std::system(cmd.c_str()) != 0)
+        die("The separate jobs failed");
+    return MPI_Wtime() - start;
+}
+
+TEST (ENSEMBLE, benchmark)
+{
+    const MirState::StepType nsteps = 200;
+    const real a = 10.0_r;
+
+    for (int nreplicas = 1; nreplicas <= 64; nreplicas *= 2)
+    {
+        // one simulation after the other in the same process
+        double tSequential = 0;
+        for (int i = 0; i < nreplicas; ++i)
+        {
+            const double start = MPI_Wtime();
+            Mirheo u(MPI_COMM_WORLD, nranks3D, domain, LogInfo("ensemble_benchmark", 3, true), CheckpointInfo{}, 0.0_r);
+            setupDPD(&u, a);
+            u.run(nsteps, dt);
+            tSequential += MPI_Wtime() - start;
+        }
+
+        // as many independent jobs sharing the GPU, including their startup
+        const double tJobs = timeSeparateJobs(nreplicas, nsteps);
+
+        const double start = MPI_Wtime();
+        {
+            Ensemble ens(MPI_COMM_WORLD, nreplicas, nranks3D, domain,
+                         LogInfo("ensemble_benchmark", 3, true), CheckpointInfo{}, 0.0_r);
+            for (int i = 0; i < nreplicas; ++i)
+                setupDPD(ens.getReplica(i), a);
+            ens.run(nsteps, dt);
+        }
+        const double tEnsemble = MPI_Wtime() - start;
+
+        const double replicaSteps = static_cast<double>(nreplicas) * nsteps;
+        printf("%2d replicas of %g particles, %lld steps, in replica-steps/s: sequential %.0f, separate jobs %.0f, "
+               "ensemble %.0f (x%.2f over separate jobs)\n",
+               nreplicas, numberDensity * domain.x * domain.y * domain.z, nsteps,
+               replicaSteps / tSequential, replicaSteps / tJobs, replicaSteps / tEnsemble, tJobs / tEnsemble);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+
+    if (argc == 3 && std::string(argv[1]) == "--single-job")
+    {
+        logger.init(MPI_COMM_WORLD, "ensemble_single_job.log", 3);
+        runSingleJob(std::stoll(argv[2]));
+        MPI_Finalize();
+        return 0;
+    }
+
+    logger.init(MPI_COMM_WORLD, "ensemble.log", 3);
+
+    testing::InitGoogleTest(&argc, argv);
+    auto ret = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return ret;
+}
@@ -0,0 +1,129 @@
+#include <mirheo/core/domain.h>
+#include <mirheo/core/field/from_file_io.h>
+#include <mirheo/core/logger.h>
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace mirheo;
+
+const std::string fileName = "field_from_file.sdf";
+
+template <class T> static T makeValue(int i, int j, int k);
+template <> float  makeValue<float> (int i, int j, int k) {return (float) (i + 100 * j + 10000 * k);}
+template <> float4 makeValue<float4>(int i, int j, int k) {return {(float) i, (float) j, (float) k, (float) (i + j + k)};}
+
+// write a grid file on the root rank, in the format expected by ScalarFieldFromFile
+template <class T>
+static std::vector<T> writeField(MPI_Comm comm, float3 extents, int3 resolution)
+{
+    std::vector<T> data;
+    for (int k = 0; k < resolution.z; ++k)
+        for (int j = 0; j < resolution.y; ++j)
+            for (int i = 0; i < resolution.x; ++i)
+                data.push_back(makeValue<T>(i, j, k));
+
+    int rank;
+    MPI_Check( MPI_Comm_rank(comm, &rank) );
+
+    if (rank == 0)
+    {
+        std::ofstream f(fileName, std::ios::binary);
+        f << extents.x << " " << extents.y << " " << extents.z << "\n"
+          << resolution.x << " " << resolution.y << " " << resolution.z << "\n";
+        f.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(T));
+    }
+    MPI_Check( MPI_Barrier(comm) );
+
+    return data;
+}
+
+inline bool areEqual(float a, float b) {return a == b;}
+inline bool areEqual(float4 a, float4 b) {return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;}
+
+// compare the piece read directly from the file with the piece cropped from the whole grid
+template <class T>
+static void checkPiece(MPI_Comm cart, real3 globalSize, int3 resolution, real margin)
+{
+    const float3 extents = make_float3(globalSize);
+    const auto fullData = writeField<T>(cart, extents, resolution);
+    const auto domain = createDomainInfo(cart, globalSize);
+
+    const auto header = from_file_io::readHeader<T>(fileName, cart);
+    ASSERT_EQ(header.resolution.x, resolution.x);
+    ASSERT_EQ(header.resolution.y, resolution.y);
+    ASSERT_EQ(header.resolution.z, resolution.z);
+
+    const float3 initialH = make_float3(globalSize) / make_float3(header.resolution - 1);
+    const float3 start = make_float3(domain.globalStart) - margin;
+    const float3 size  = make_float3(domain.localSize) + 2 * margin;
+
+    auto piece = from_file_io::readFieldPiece<T>(fileName, cart, header, start, size, initialH);
+    auto ref   = from_file_io::cropFieldPiece<T>(fullData, start, size, initialH, resolution);
+
+    ASSERT_EQ(piece.resolution.x, ref.resolution.x);
+    ASSERT_EQ(piece.resolution.y, ref.resolution.y);
+    ASSERT_EQ(piece.resolution.z, ref.resolution.z);
+    ASSERT_EQ(piece.offset.x, ref.offset.x);
+    ASSERT_EQ(piece.offset.y, ref.offset.y);
+    ASSERT_EQ(piece.offset.z, ref.offset.z);
+    ASSERT_EQ(piece.data.size(), ref.data.size());
+
+    for (size_t i = 0; i < ref.data.size(); ++i)
+        ASSERT_TRUE(areEqual(piece.data[i], ref.data[i])) << "wrong value at index " << i;
+
+    // the whole grid must never be stored
+    ASSERT_LE(piece.peakMemory_byte, ref.peakMemory_byte);
+}
+
+static MPI_Comm createCart(MPI_Comm comm)
+{
+    int nranks;
+    MPI_Check( MPI_Comm_size(comm, &nranks) );
+
+    int dims[3] = {0, 0, 0};
+    const int periods[] = {1, 1, 1};
+    MPI_Check( MPI_Dims_create(nranks, 3, dims) );
+
+    MPI_Comm cart;
+    MPI_Check( MPI_Cart_create(comm, 3, dims, periods, 0, &cart) );
+    return cart;
+}
+
+TEST (FIELD_FROM_FILE, scalar_field_distributed)
+{
+    MPI_Comm cart = createCart(MPI_COMM_WORLD);
+    checkPiece<float>(cart, {32.0_r, 24.0_r, 16.0_r}, {65, 49, 33}, 2.0_r);
+    MPI_Check( MPI_Comm_free(&cart) );
+}
+
+TEST (FIELD_FROM_FILE, scalar_field_coarse_grid)
+{
+    // the pieces cover the whole grid along some directions
+    MPI_Comm cart = createCart(MPI_COMM_WORLD);
+    checkPiece<float>(cart, {32.0_r, 24.0_r, 16.0_r}, {9, 7, 5}, 2.0_r);
+    MPI_Check( MPI_Comm_free(&cart) );
+}
+
+TEST (FIELD_FROM_FILE, vector_field_distributed)
+{
+    MPI_Comm cart = createCart(MPI_COMM_WORLD);
+    checkPiece<float4>(cart, {16.0_r, 16.0_r, 16.0_r}, {33, 33, 33}, 1.0_r);
+    MPI_Check( MPI_Comm_free(&cart) );
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+
+    logger.init(MPI_COMM_WORLD, "field_from_file.log", 3);
+
+    testing::InitGoogleTest(&argc, argv);
+    auto retval = RUN_ALL_TESTS();
+
+    MPI_Finalize();
+    return retval;
+}
@@ -0,0 +1,247 @@
+#include <mirheo/core/frozen_particles_cache.h>
+#include <mirheo/core/initial_conditions/helpers.h>
+#include <mirheo/core/integrators/factory.h>
+#include <mirheo/core/interactions/factory.h>
+#include <mirheo/core/interactions/pairwise/base_pairwise.h>
+#include <mirheo/core/logger.h>
+#include <mirheo/core/mirheo.h>
+#include <mirheo/core/mirheo_state.h>
+#include <mirheo/core/pvs/particle_vector.h>
+#include <mirheo/core/utils/cuda_common.h>
+#include <mirheo/core/utils/path.h>
+#include <mirheo/core/walls/factory.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <tuple>
+#include <vector>
+
+using namespace mirheo;
+
+static const int3 nranks3D {1, 1, 1};
+static const real3 domain {8.0_r, 8.0_r, 8.0_r};
+static const real numberDensity = 4.0_r;
+static const real rc = 1.0_r;
+static const real dt = 0.005_r;
+static const int nsteps = 20;
+static const DomainInfo domainInfo {domain, {0.0_r, 0.0_r, 0.0_r}, domain};
+
+using Positions = std::vector<std::tuple<real, real, real>>;
+
+static void removeFolder(const std::string& folder)
+{
+    const std::string cmd = "rm -rf " + folder;
+    if (std::system(cmd.c_str()) != 0)
+        die("Could not remove '%s'", folder.c_str());
+}
+
+static std::shared_ptr<Interaction> makeDPD(const MirState *state, real a)
+{
+    return interaction_factory::createPairwiseInteraction(
+        state, "dpd", rc, "DPD", {{"a", a}, {"gamma", 20.0_r}, {"kBT", 1.0_r}, {"power", 0.5_r}});
+}
+
+static std::unique_ptr<ParticleVector> makeUniformParticles(const MirState *state)
+{
+    auto pv = std::make_unique<ParticleVector>(state, "frozen", 1.0_r);
+    setUniformParticles(numberDensity, MPI_COMM_WORLD, pv.get(), [](real3) {return true;}, defaultStream);
+    return pv;
+}
+
+static Positions getSortedPositions(ParticleVector *pv)
+{
+    auto& pos = pv->local()->positions();
+    pos.downloadFromDevice(defaultStream, ContainersSynch::Synch);
+
+    Positions positions;
+    for (const auto& r : pos)
+        positions.emplace_back(r.x, r.y, r.z);
+    std::sort(positions.begin(), positions.end());
+    return positions;
+}
+
+/// \return the modification time of a file in nanoseconds, or -1 if it does not exist
+static long long getModificationTime(const std::string& fname)
+{
+    struct stat st;
+    if (stat(fname.c_str(), &st) != 0)
+        return -1;
+    return static_cast<long long>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+}
+
+TEST (FROZEN_PARTICLES_CACHE, store_then_hit)
+{
+    const std::string folder = "cache_store_then_hit";
+    removeFolder(folder);
+
+    MirState state(domainInfo, dt);
+    auto dpd = makeDPD(&state, 10.0_r);
+    auto vv = integrator_factory::createVV(&state, "vv");
+
+    auto pv = makeUniformParticles(&state);
+    const FrozenParticlesCache cache(MPI_COMM_WORLD, folder, pv.get(), {dpd}, vv.get(), numberDensity, dt, nsteps);
+    ASSERT_TRUE(cache.isEnabled());
+
+    ASSERT_FALSE(cache.load(pv.get()));
+    cache.store(pv.get());
+
+    auto loaded = std::make_unique<ParticleVector>(&state, "frozen", 1.0_r);
+    ASSERT_TRUE(cache.load(loaded.get()));
+    ASSERT_EQ(getSortedPositions(loaded.get()), getSortedPositions(pv.get()));
+}
+
+TEST (FROZEN_PARTICLES_CACHE, disabled_without_folder)
+{
+    MirState state(domainInfo, dt);
+    auto dpd = makeDPD(&state, 10.0_r);
+    auto vv = integrator_factory::createVV(&state, "vv");
+    auto pv = makeUniformParticles(&state);
+
+    const FrozenParticlesCache cache(MPI_COMM_WORLD, "", pv.get(), {dpd}, vv.get(), numberDensity, dt, nsteps);
+    ASSERT_FALSE(cache.isEnabled());
+    ASSERT_FALSE(cache.load(pv.get()));
+}
+
+TEST (FROZEN_PARTICLES_CACHE, parameter_change_invalidates)
+{
+    const std::string folder = "cache_parameter_change";
+    removeFolder(folder);
+
+    MirState state(domainInfo, dt);
+    auto dpd      = makeDPD(&state, 10.0_r);
+    auto dpdOther = makeDPD(&state, 20.0_r);
+    auto vv       = integrator_factory::createVV(&state, "vv");
+    auto vvOther  = integrator_factory::createVV_constDP(&state, "vv", {0.1_r, 0.0_r, 0.0_r});
+    auto pv = makeUniformParticles(&state);
+
+    const FrozenParticlesCache stored(MPI_COMM_WORLD, folder, pv.get(), {dpd}, vv.get(), numberDensity, dt, nsteps);
+    stored.store(pv.get());
+
+    const FrozenParticlesCache same(MPI_COMM_WORLD, folder, pv.get(), {dpd}, vv.get(), numberDensity, dt, nsteps);
+    ASSERT_EQ(same.getPath(), stored.getPath());
+    ASSERT_TRUE(same.load(pv.get()));
+
+    const std::vector<FrozenParticlesCache> changed {
+        {MPI_COMM_WORLD, folder, pv.get(), {dpdOther}, vv.get(), numberDensity, dt, nsteps},
+        {MPI_COMM_WORLD, folder, pv.get(), {dpd}, vvOther.get(), numberDensity, dt, nsteps},
+        {MPI_COMM_WORLD, folder, pv.get(), {dpd}, vv.get(), 2 * numberDensity, dt, nsteps},
+        {MPI_COMM_WORLD, folder, pv.get(), {dpd}, vv.get(), numberDensity, 2 * dt, nsteps},
+        {MPI_COMM_WORLD, folder, pv.get(), {dpd}, vv.get(), numberDensity, dt, 2 * nsteps}};
+
+    for (const auto& cache : changed)
+    {
+        ASSERT_TRUE(cache.isEnabled());
+        ASSERT_NE(cache.getPath(), stored.getPath());
+        ASSERT_FALSE(cache.load(pv.get()));
+    }
+}
+
+TEST (FROZEN_PARTICLES_CACHE, incomplete_entry_is_a_miss)
+{
+    const std::string folder = "cache_incomplete_entry";
+    removeFolder(folder);
+
+    MirState state(domainInfo, dt);
+    auto dpd = makeDPD(&state, 10.0_r);
+    auto vv = integrator_factory::createVV(&state, "vv");
+    auto pv = makeUniformParticles(&state);
+
+    const FrozenParticlesCache cache(MPI_COMM_WORLD, folder, pv.get(), {dpd}, vv.get(), numberDensity, dt, nsteps);
+    cache.store(pv.get());
+    ASSERT_TRUE(cache.load(pv.get()));
+
+    // an interrupted store leaves the particles without the definition
+    std::remove(joinPaths(cache.getPath(), "definition.txt").c_str());
+    ASSERT_FALSE(cache.load(pv.get()));
+}
+
+
+/// create frozen particles on one half of the domain, with an optional cache
+static Positions makeFrozenWall(const std::string& folder, bool refreshCache, int numSteps)
+{
+    Mirheo u(MPI_COMM_WORLD, nranks3D, domain, LogInfo("frozen_particles_cache", 3, true), CheckpointInfo{}, 0.0_r);
+    const MirState *state = u.getState();
+
+    auto wall = wall_factory::createPlaneWall(state, "plate", {0.0_r, 0.0_r, 1.0_r}, {0.0_r, 0.0_r, 0.5_r * domain.z});
+    u.registerWall(wall);
+
+    auto dpd = makeDPD(state, 10.0_r);
+    auto vv = integrator_factory::createVV(state, "vv");
+
+    auto pv = u.makeFrozenWallParticles("frozen", {wall}, {dpd}, vv, numberDensity, 1.0_r, dt, numSteps,
+                                        folder, refreshCache);
+    return getSortedPositions(pv.get());
+}
+
+TEST (FROZEN_PARTICLES_CACHE, refresh_overwrites_entry)
+{
+    const std::string folder = "cache_refresh";
+    removeFolder(folder);
+
+    const auto first = makeFrozenWall(folder, false, nsteps);
+
+    MirState state(domainInfo, dt);
+    auto pv = std::make_unique<ParticleVector>(&state, "frozen", 1.0_r);
+    auto dpd = makeDPD(&state, 10.0_r);
+    auto vv = integrator_factory::createVV(&state, "vv");
+    const FrozenParticlesCache cache(MPI_COMM_WORLD, folder, pv.get(), {dpd}, vv.get(), numberDensity, dt, nsteps);
+    const std::string definitionFile = joinPaths(cache.getPath(), "definition.txt");
+
+    const long long tStored = getModificationTime(definitionFile);
+    ASSERT_GE(tStored, 0);
+
+    // a hit does not touch the entry
+    const auto hit = makeFrozenWall(folder, false, nsteps);
+    ASSERT_EQ(hit, first);
+    ASSERT_EQ(getModificationTime(definitionFile), tStored);
+
+    // a refresh runs the equilibration again and rewrites the entry
+    const auto refreshed = makeFrozenWall(folder, true, nsteps);
+    ASSERT_EQ(refreshed.size(), first.size());
+    ASSERT_GT(getModificationTime(definitionFile), tStored);
+}
+
+TEST (FROZEN_PARTICLES_CACHE, benchmark_startup)
+{
+    const std::string folder = "cache_benchmark";
+    const int numSteps = 1000;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        removeFolder(folder);
+
+        double start = MPI_Wtime();
+        makeFrozenWall("", false, numSteps);
+        const double tNoCache = MPI_Wtime() - start;
+
+        start = MPI_Wtime();
+        makeFrozenWall(folder, false, numSteps);
+        const double tMiss = MPI_Wtime() - start;
+
+        start = MPI_Wtime();
+        makeFrozenWall(folder, false, numSteps);
+        const double tHit = MPI_Wtime() - start;
+
+        // the first round includes the device initialization
+        if (i > 0)
+            printf("frozen wall of %g particles, %d equilibration steps: no cache %.3f s, miss %.3f s, hit %.3f s (x%.1f)\n",
+                   numberDensity * domain.x * domain.y * domain.z, numSteps, tNoCache, tMiss, tHit, tNoCache / tHit);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+    logger.init(MPI_COMM_WORLD, "frozen_particles_cache.log", 3);
+
+    testing::InitGoogleTest(&argc, argv);
+    auto ret = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return ret;
+}
@@ -0,0 +1,292 @@
+#include <mirheo/core/interactions/pairwise/kernels/accumulators/force.h>
+#include <mirheo/core/logger.h>
+#include <mirheo/core/utils/compile_options.h>
+#include <mirheo/core/utils/vec_traits.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace mirheo;
+
+namespace
+{
+template <typename T>
+using Vec3 = typename vec_traits::Vec<T, 3>::Type;
+
+/// Plain sum in double precision, used by the double precision reference
+class DoubleReferenceSum3
+{
+public:
+    void add(double3 v) {sum_ += v;}
+    double3 get() const {return sum_;}
+
+private:
+    double3 sum_ {0.0, 0.0, 0.0};
+};
+
+template <class Sum>
+double3 sumWith(const std::vector<real3>& terms)
+{
+    BasicForceAccumulator<Sum> acc;
+    for (const auto& t : terms)
+        acc.add(t);
+    return make_double3(acc.get());
+}
+
+double maxAbsDiff(double3 a, double3 b)
+{
+    return std::max({std::abs(a.x - b.x), std::abs(a.y - b.y), std::abs(a.z - b.z)});
+}
+
+/** Soft repulsive particles (conservative part of DPD) in a periodic cube, integrated with velocity Verlet.
+    \tparam T The precision of the positions, velocities and pair forces
+    \tparam Sum The sum of the pair forces of one particle
+
+    The forces of each particle are summed over all its neighbours, as done by the per-particle accumulators.
+    Each pair is evaluated once per particle, with exactly opposite results: the sum of all forces only differs
+    from zero through the rounding of the sums.
+ */
+template <typename T, class Sum>
+class SoftSpheres
+{
+public:
+    SoftSpheres(const std::vector<double3>& r0, const std::vector<double3>& v0, double L, double a, double dt) :
+        L_(static_cast<T>(L)),
+        a_(static_cast<T>(a)),
+        dt_(static_cast<T>(dt)),
+        r_(r0.size()),
+        v_(v0.size()),
+        f_(r0.size())
+    {
+        for (size_t i = 0; i < r0.size(); ++i)
+        {
+            r_[i] = {static_cast<T>(r0[i].x), static_cast<T>(r0[i].y), static_cast<T>(r0[i].z)};
+            v_[i] = {static_cast<T>(v0[i].x), static_cast<T>(v0[i].y), static_cast<T>(v0[i].z)};
+        }
+        computeForces();
+    }
+
+    void step()
+    {
+        const T halfDt = static_cast<T>(0.5) * dt_;
+        for (size_t i = 0; i < r_.size(); ++i)
+        {
+            v_[i] += halfDt * f_[i];
+            r_[i] += dt_ * v_[i];
+            r_[i].x -= L_ * std::floor(r_[i].x / L_);
+            r_[i].y -= L_ * std::floor(r_[i].y / L_);
+            r_[i].z -= L_ * std::floor(r_[i].z / L_);
+        }
+        computeForces();
+        for (size_t i = 0; i < r_.size(); ++i)
+            v_[i] += halfDt * f_[i];
+    }
+
+    /// \return the total energy, computed in double precision
+    double energy() const
+    {
+        const double L = L_;
+        double e = 0;
+        for (size_t i = 0; i < r_.size(); ++i)
+        {
+            e += 0.5 * dot(make_double3(v_[i]), make_double3(v_[i]));
+            for (size_t j = i + 1; j < r_.size(); ++j)
+            {
+                double3 dr = make_double3(r_[i]) - make_double3(r_[j]);
+                dr.x -= L * std::round(dr.x / L);
+                dr.y -= L * std::round(dr.y / L);
+                dr.z -= L * std::round(dr.z / L);
+                const double r = std::sqrt(dot(dr, dr));
+                if (r < 1.0)
+                    e += 0.5 * static_cast<double>(a_) * (1.0 - r) * (1.0 - r);
+            }
+        }
+        return e;
+    }
+
+    /// \return the largest component of the sum of the forces, computed in double precision; zero without rounding errors
+    double netForce() const
+    {
+        double3 f {0.0, 0.0, 0.0};
+        for (const auto& fi : f_)
+            f += make_double3(fi);
+        return std::max({std::abs(f.x), std::abs(f.y), std::abs(f.z)});
+    }
+
+    /// \return the total momentum, computed in double precision
+    double3 momentum() const
+    {
+        double3 p {0.0, 0.0, 0.0};
+        for (const auto& v : v_)
+            p += make_double3(v);
+        return p;
+    }
+
+private:
+    void computeForces()
+    {
+        const T one = static_cast<T>(1);
+        for (size_t i = 0; i < r_.size(); ++i)
+        {
+            Sum sum;
+            for (size_t j = 0; j < r_.size(); ++j)
+            {
+                if (i == j) continue;
+                Vec3<T> dr = r_[i] - r_[j];
+                dr.x -= L_ * std::round(dr.x / L_);
+                dr.y -= L_ * std::round(dr.y / L_);
+                dr.z -= L_ * std::round(dr.z / L_);
+
+                const T r2 = dot(dr, dr);
+                if (r2 >= one || r2 == 0) continue;
+
+                const T r = std::sqrt(r2);
+                sum.add((a_ * (one - r) / r) * dr);
+            }
+            f_[i] = sum.get();
+        }
+    }
+
+    T L_, a_, dt_;
+    std::vector<Vec3<T>> r_, v_, f_;
+};
+
+struct DriftResult
+{
+    double energyDrift;   ///< relative change of the total energy
+    double momentumDrift; ///< largest component of the total momentum (initially zero)
+    double netForce;      ///< largest component of the sum of the forces, averaged over the steps
+    double timePerStep;   ///< seconds
+};
+
+template <typename T, class Sum>
+DriftResult measureDrift(const std::vector<double3>& r0, const std::vector<double3>& v0,
+                         double L, double a, double dt, int nsteps)
+{
+    SoftSpheres<T, Sum> system(r0, v0, L, a, dt);
+    const double e0 = system.energy();
+    const double3 p0 = system.momentum();
+
+    double netForce = 0;
+    double time = 0;
+    for (int i = 0; i < nsteps; ++i)
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+        system.step();
+        const auto end = std::chrono::high_resolution_clock::now();
+        time += std::chrono::duration<double>(end - start).count();
+        netForce += system.netForce();
+    }
+
+    return {std::abs(system.energy() - e0) / std::abs(e0),
+            maxAbsDiff(system.momentum(), p0),
+            netForce / nsteps,
+            time / nsteps};
+}
+} // anonymous namespace
+
+TEST(Interactions_accumulation, compensated_and_double_sums_are_more_accurate)
+{
+    // forces of similar magnitude and random signs, as in a dense fluid, plus a few large ones
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<real> u(-1.0_r, 1.0_r);
+    const int n = 100000;
+
+    std::vector<real3> terms(n);
+    for (int i = 0; i < n; ++i)
+    {
+        const real scale = (i % 1000 == 0) ? 1000.0_r : 1.0_r;
+        terms[i] = scale * make_real3(u(gen), u(gen), u(gen));
+    }
+
+    double3 exact {0.0, 0.0, 0.0};
+    for (const auto& t : terms)
+        exact += make_double3(t);
+
+    const double errPlain  = maxAbsDiff(sumWith<PlainSum3> (terms), exact);
+    const double errKahan  = maxAbsDiff(sumWith<KahanSum3> (terms), exact);
+    const double errDouble = maxAbsDiff(sumWith<DoubleSum3>(terms), exact);
+
+    printf("sum of %d terms: error plain %g, Kahan %g, double %g\n", n, errPlain, errKahan, errDouble);
+
+    // the last two are limited by the rounding of the result to the working precision
+    const double resultRounding = 2 * std::numeric_limits<real>::epsilon()
+        * std::max({std::abs(exact.x), std::abs(exact.y), std::abs(exact.z), 1.0});
+
+    ASSERT_LE(errKahan,  resultRounding);
+    ASSERT_LE(errDouble, resultRounding);
+    if (!CompileOptions::useDouble)
+    {
+        ASSERT_LT(errKahan,  errPlain);
+        ASSERT_LT(errDouble, errPlain);
+    }
+}
+
+TEST(Interactions_accumulation, energy_and_momentum_drift)
+{
+    const double L = 5.0;
+    const double density = 3.0;
+    const double a = 25.0;
+    const double dt = 0.005;
+    const int nsteps = 1000;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> ur(0.0, L);
+    std::normal_distribution<double> uv(0.0, 1.0);
+
+    const int n = static_cast<int>(density * L * L * L);
+    std::vector<double3> r0(n), v0(n);
+    double3 mean {0.0, 0.0, 0.0};
+    for (int i = 0; i < n; ++i)
+    {
+        r0[i] = {ur(gen), ur(gen), ur(gen)};
+        v0[i] = {uv(gen), uv(gen), uv(gen)};
+        mean += v0[i];
+    }
+    for (auto& v : v0)
+        v -= (1.0 / n) * mean;
+
+    const DriftResult results[] = {
+        measureDrift<real,   PlainSum3>          (r0, v0, L, a, dt, nsteps),
+        measureDrift<real,   KahanSum3>          (r0, v0, L, a, dt, nsteps),
+        measureDrift<real,   DoubleSum3>         (r0, v0, L, a, dt, nsteps),
+        measureDrift<double, DoubleReferenceSum3>(r0, v0, L, a, dt, nsteps)
+    };
+    const char *names[] = {"working precision", "mixed (Kahan sums)", "mixed (double sums)", "double"};
+
+    for (int i = 0; i < 4; ++i)
+    {
+        printf("%d particles, %d steps, %-20s: relative energy drift %.3e, momentum drift %.3e, "
+               "net force %.3e, %.3f ms per step\n",
+               n, nsteps, names[i], results[i].energyDrift, results[i].momentumDrift,
+               results[i].netForce, results[i].timePerStep * 1e3);
+
+        ASSERT_TRUE(std::isfinite(results[i].energyDrift));
+        ASSERT_LT(results[i].energyDrift, 0.1);
+    }
+
+    // the pair forces are exactly opposite: only the rounding of the sums gives a non zero net force
+    if (!CompileOptions::useDouble)
+    {
+        ASSERT_LT(results[1].netForce, results[0].netForce);
+        ASSERT_LT(results[2].netForce, results[0].netForce);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+    logger.init(MPI_COMM_WORLD, "accumulation.log", 0);
+
+    testing::InitGoogleTest(&argc, argv);
+    auto ret = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return ret;
+}
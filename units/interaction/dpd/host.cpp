@@ -0,0 +1,239 @@
+#include <mirheo/core/celllist.h>
+#include <mirheo/core/interactions/pairwise/host_drivers.h>
+#include <mirheo/core/interactions/pairwise/kernels/norandom_dpd.h>
+#include <mirheo/core/pvs/particle_vector.h>
+#include <mirheo/core/pvs/views/pv.h>
+
+#include "reference.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace mirheo;
+
+namespace
+{
+const real rc = 1.0_r;
+const real dt = 0.002_r;
+const NoRandomDPDParams dpdParams {50.0_r, 20.0_r, 1.0_r, 1.0_r};
+
+/// Particles in host memory, in arbitrary order
+struct HostParticles
+{
+    std::vector<real4> pos, vel;
+};
+
+HostParticles generateParticles(real3 L, real density, int64_t firstId, long seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<real> ux(-0.5_r * L.x, 0.5_r * L.x);
+    std::uniform_real_distribution<real> uy(-0.5_r * L.y, 0.5_r * L.y);
+    std::uniform_real_distribution<real> uz(-0.5_r * L.z, 0.5_r * L.z);
+    std::uniform_real_distribution<real> uv(-1.0_r, 1.0_r);
+
+    const int n = static_cast<int>(density * L.x * L.y * L.z);
+    HostParticles p;
+    for (int i = 0; i < n; ++i)
+    {
+        Particle q;
+        q.r = {ux(gen), uy(gen), uz(gen)};
+        q.u = {uv(gen), uv(gen), uv(gen)};
+        q.setId(firstId + i);
+        p.pos.push_back(q.r2Real4());
+        p.vel.push_back(q.u2Real4());
+    }
+    return p;
+}
+
+/// Particles stored in cell-list order in a ParticleVector, with a view pointing to host memory
+class HostCells
+{
+public:
+    HostCells(MirState *state, const HostParticles& p, const CellListInfo& cinfo) :
+        pv_(state, "pv", 1.0_r),
+        cinfo_(cinfo),
+        cellStarts_(cinfo.totcells + 1),
+        cellSizes_(cinfo.totcells + 1),
+        order_(p.pos.size())
+    {
+        const int n = static_cast<int>(p.pos.size());
+        auto lpv = pv_.local();
+        lpv->resize_anew(n);
+
+        makeCells(p.pos.data(), p.vel.data(),
+                  lpv->positions().hostPtr(), lpv->velocities().hostPtr(),
+                  cellStarts_.data(), cellSizes_.data(), order_.data(), n, cinfo_);
+
+        cinfo_.cellStarts = cellStarts_.data();
+        cinfo_.cellSizes  = cellSizes_.data();
+        clearForces();
+    }
+
+    PVview view()
+    {
+        auto lpv = pv_.local();
+        PVview v(&pv_, lpv);
+        v.positions  = lpv->positions ().hostPtr();
+        v.velocities = lpv->velocities().hostPtr();
+        v.forces     = reinterpret_cast<real4*>(lpv->forces().hostPtr());
+        return v;
+    }
+
+    const CellListInfo& cellInfo() const {return cinfo_;}
+
+    void clearForces()
+    {
+        for (auto& f : pv_.local()->forces())
+            f = Force(make_real3(0.0_r), 0);
+    }
+
+    /// add the forces to \p forces, in the order of the input particles
+    void addForces(std::vector<real3>& forces, int offset)
+    {
+        auto& f = pv_.local()->forces();
+        for (size_t i = 0; i < order_.size(); ++i)
+            forces[offset + order_[i]] += f[i].f;
+    }
+
+private:
+    ParticleVector pv_;
+    CellListInfo cinfo_;
+    std::vector<int> cellStarts_, cellSizes_, order_;
+};
+
+PairwiseNoRandomDPD createKernel(const MirState *state)
+{
+    PairwiseNoRandomDPD dpd(rc, dpdParams);
+    dpd.setup(nullptr, nullptr, nullptr, nullptr, state);
+    return dpd;
+}
+
+std::vector<Force> computeReference(const HostParticles& p, const CellListInfo& cinfo)
+{
+    const real sigma_dt = math::sqrt(2 * dpdParams.gamma * dpdParams.kBT / dt);
+    return computeReferenceForces(p.pos, p.vel, cinfo, {dpdParams.a, dpdParams.gamma, sigma_dt});
+}
+
+real maxError(const std::vector<real3>& forces, const std::vector<Force>& ref)
+{
+    real err = 0.0_r;
+    for (size_t i = 0; i < ref.size(); ++i)
+    {
+        const real3 d = forces[i] - ref[i].f;
+        err = math::max(err, math::max(math::abs(d.x), math::max(math::abs(d.y), math::abs(d.z))));
+    }
+    return err;
+}
+
+HostParticles concatenate(const HostParticles& a, const HostParticles& b)
+{
+    HostParticles c = a;
+    c.pos.insert(c.pos.end(), b.pos.begin(), b.pos.end());
+    c.vel.insert(c.vel.end(), b.vel.begin(), b.vel.end());
+    return c;
+}
+} // anonymous namespace
+
+class InteractionsHost : public ::testing::Test
+{
+protected:
+    InteractionsHost() :
+        domain {L, {0, 0, 0}, L},
+        state(domain, dt),
+        cinfo(rc, L)
+    {}
+
+    const real3 L {13, 10, 8};
+    DomainInfo domain;
+    MirState state;
+    CellListInfo cinfo;
+};
+
+TEST_F(InteractionsHost, self_interactions_same_as_reference)
+{
+    const auto p = generateParticles(L, 6.0_r, 0, 424242);
+    const auto ref = computeReference(p, cinfo);
+
+    HostCells cells(&state, p, cinfo);
+    const auto dpd = createKernel(&state);
+    pairwise_host::computeSelfInteractions(cells.cellInfo(), cells.view(), dpd.handler(), rc);
+
+    std::vector<real3> forces(p.pos.size(), make_real3(0.0_r));
+    cells.addForces(forces, 0);
+
+    ASSERT_LE(maxError(forces, ref), 0.002_r);
+}
+
+TEST_F(InteractionsHost, external_interactions_same_as_reference)
+{
+    const auto p1 = generateParticles(L, 4.0_r, 0,       1234);
+    const auto p2 = generateParticles(L, 2.0_r, 1000000, 5678);
+    const auto ref = computeReference(concatenate(p1, p2), cinfo);
+
+    HostCells cells1(&state, p1, cinfo);
+    HostCells cells2(&state, p2, cinfo);
+    const auto dpd = createKernel(&state);
+
+    pairwise_host::computeSelfInteractions(cells1.cellInfo(), cells1.view(), dpd.handler(), rc);
+    pairwise_host::computeSelfInteractions(cells2.cellInfo(), cells2.view(), dpd.handler(), rc);
+    pairwise_host::computeExternalInteractions(cells1.cellInfo(), cells2.cellInfo(),
+                                               cells1.view(), cells2.view(), dpd.handler(), rc);
+
+    std::vector<real3> forces(p1.pos.size() + p2.pos.size(), make_real3(0.0_r));
+    cells1.addForces(forces, 0);
+    cells2.addForces(forces, static_cast<int>(p1.pos.size()));
+
+    ASSERT_LE(maxError(forces, ref), 0.002_r);
+}
+
+TEST_F(InteractionsHost, benchmark)
+{
+    const real3 Lbench {32, 32, 16};
+    const CellListInfo cinfoBench(rc, Lbench);
+    const auto p = generateParticles(Lbench, 8.0_r, 0, 42);
+    const int nrepeat = 5;
+
+    auto measure = [&](auto&& f)
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < nrepeat; ++i)
+            f();
+        const auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(end - start).count() / nrepeat;
+    };
+
+    const double tref = measure([&]() {computeReference(p, cinfoBench);});
+    printf("%d particles; reference (full stencil): %g ms\n", static_cast<int>(p.pos.size()), tref * 1e3);
+
+    HostCells cells(&state, p, cinfoBench);
+    const auto dpd = createKernel(&state);
+
+    auto runDriver = [&]()
+    {
+        cells.clearForces();
+        pairwise_host::computeSelfInteractions(cells.cellInfo(), cells.view(), dpd.handler(), rc);
+    };
+
+#ifdef _OPENMP
+    const int maxThreads = omp_get_max_threads();
+    for (int nthreads : {1, maxThreads})
+    {
+        omp_set_num_threads(nthreads);
+        const double t = measure(runDriver);
+        printf("host driver (half stencil), %d threads: %g ms, speedup over reference %g\n",
+               nthreads, t * 1e3, tref / t);
+    }
+    omp_set_num_threads(maxThreads);
+#else
+    const double t = measure(runDriver);
+    printf("host driver (half stencil), no OpenMP: %g ms, speedup over reference %g\n", t * 1e3, tref / t);
+#endif
+}
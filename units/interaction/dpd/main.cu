@@ -6,6 +6,8 @@
 #include <mirheo/core/logger.h>
 #include <mirheo/core/pvs/particle_vector.h>
 
+#include "reference.h"
+
 #include <gtest/gtest.h>
 
 #include <unistd.h>
@@ -50,35 +52,6 @@ TEST(Interactions_dpd, is_not_nan_at_zero_distance)
 }
 
 
-static void makeCells(const real4 *inputPos, const real4 *inputVel,
-                      real4 *outputPos, real4 *outputVel,
-                      int *cellsStartSize, int *cellsSize,
-                      int *order, int np, CellListInfo cinfo)
-{
-    for (int i = 0; i < cinfo.totcells+1; i++)
-        cellsSize[i] = 0;
-
-    for (int i = 0; i < np; i++)
-        cellsSize[cinfo.getCellId(make_real3(inputPos[i]))]++;
-
-    cellsStartSize[0] = 0;
-    for (int i = 1; i <= cinfo.totcells; i++)
-        cellsStartSize[i] = cellsSize[i-1] + cellsStartSize[i-1];
-
-    for (int i = 0; i < np; i++)
-    {
-        const int cid = cinfo.getCellId(make_real3(inputPos[i]));
-        outputPos[cellsStartSize[cid]] = inputPos[i];
-        outputVel[cellsStartSize[cid]] = inputVel[i];
-        order[cellsStartSize[cid]] = i;
-
-        cellsStartSize[cid]++;
-    }
-
-    for (int i = 0; i < cinfo.totcells; i++)
-        cellsStartSize[i] -= cellsSize[i];
-}
-
 static void execute(MPI_Comm comm, real3 length)
 {
     DomainInfo domain{length, {0,0,0}, length};
@@ -135,7 +108,7 @@ static void execute(MPI_Comm comm, real3 length)
     vel1.uploadToDevice(defaultStream);
     vel2.uploadToDevice(defaultStream);
 
-    std::vector<real4> initialPos(np), initialVel(np), rearrangedPos(np), rearrangedVel(np);
+    std::vector<real4> initialPos(np), initialVel(np);
     for (int i = 0; i < np; i++)
     {
         bool from1 = i < static_cast<int>(pos1.size());
@@ -180,10 +153,6 @@ static void execute(MPI_Comm comm, real3 length)
             frcs1[i] :
             frcs2[i - dpds1.local()->size()];
 
-    std::vector<int> hcellsstart(cells1->totcells+1);
-    std::vector<int> hcellssize(cells1->totcells);
-    std::vector<int> order(np);
-
     cudaDeviceSynchronize();
 
     fprintf(stderr, "finished, reducing acc\n");
@@ -198,94 +167,11 @@ static void execute(MPI_Comm comm, real3 length)
 
     fprintf(stderr, "Checking (this is not necessarily a cubic domain)......\n");
 
-    makeCells(initialPos.data(), initialVel.data(),
-              rearrangedPos.data(), rearrangedVel.data(),
-              hcellsstart.data(), hcellssize.data(),
-              order.data(), np, cells1->cellInfo());
-
-    std::vector<Force> refAcc(hacc.size());
-
-    auto addForce = [&](int dstId, int srcId, Force& a)
-    {
-        Particle pdst(rearrangedPos[dstId], rearrangedVel[dstId]);
-        Particle psrc(rearrangedPos[srcId], rearrangedVel[srcId]);
-        const real _xr = pdst.r.x - psrc.r.x;
-        const real _yr = pdst.r.y - psrc.r.y;
-        const real _zr = pdst.r.z - psrc.r.z;
-
-        const real rij2 = _xr * _xr + _yr * _yr + _zr * _zr;
-
-        if (rij2 > 1.0f) return;
-        //assert(rij2 < 1);
-
-        const real invrij = 1.0f / math::sqrt(rij2);
-        const real rij = rij2 * invrij;
-        const real argwr = 1.0f - rij;
-        const real wr = argwr;
-
-        const real xr = _xr * invrij;
-        const real yr = _yr * invrij;
-        const real zr = _zr * invrij;
-
-        const real rdotv =
-        xr * (pdst.u.x - psrc.u.x) +
-        yr * (pdst.u.y - psrc.u.y) +
-        zr * (pdst.u.z - psrc.u.z);
-
-        int sid = psrc.i1;
-        int did = pdst.i1;
-        const real myrandnr = ((min(sid, did) ^ max(sid, did)) % 13) - 6;
-
-        const real strength = adpd * argwr - (gammadpd * wr * rdotv + sigma_dt * myrandnr) * wr;
-
-        a.f.x += strength * xr;
-        a.f.y += strength * yr;
-        a.f.z += strength * zr;
-    };
-
-#pragma omp parallel for collapse(3)
-    for (int cx = 0; cx < cells1->ncells.x; cx++)
-        for (int cy = 0; cy < cells1->ncells.y; cy++)
-            for (int cz = 0; cz < cells1->ncells.z; cz++)
-            {
-                const int cid = cells1->encode(cx, cy, cz);
-
-                const int2 start_size = make_int2(hcellsstart[cid], hcellssize[cid]);
-
-                for (int dstId = start_size.x; dstId < start_size.x + start_size.y; dstId++)
-                {
-                    Force a {{0,0,0},0};
-
-                    for (int dx = -1; dx <= 1; dx++)
-                        for (int dy = -1; dy <= 1; dy++)
-                            for (int dz = -1; dz <= 1; dz++)
-                            {
-                                const int srcCid = cells1->encode(cx+dx, cy+dy, cz+dz);
-                                if (srcCid >= cells1->totcells || srcCid < 0) continue;
-
-                                const int2 srcStart_size = make_int2(hcellsstart[srcCid], hcellssize[srcCid]);
-
-                                for (int srcId = srcStart_size.x; srcId < srcStart_size.x + srcStart_size.y; srcId++)
-                                {
-                                    if (dstId != srcId)
-                                        addForce(dstId, srcId, a);
-                                }
-                            }
-
-                    refAcc[dstId].f.x = a.f.x;
-                    refAcc[dstId].f.y = a.f.y;
-                    refAcc[dstId].f.z = a.f.z;
-                }
-            }
+    const std::vector<Force> finalFrcs = computeReferenceForces(initialPos, initialVel, cells1->cellInfo(),
+                                                                {adpd, gammadpd, sigma_dt});
 
     double l2 = 0, linf = -1;
 
-    std::vector<Force> finalFrcs(np);
-    for (int i = 0; i < np; i++)
-    {
-        finalFrcs[order[i]] = refAcc[i];
-    }
-
     for (int i = 0; i < np; i++)
     {
         double perr = -1;
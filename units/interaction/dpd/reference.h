@@ -0,0 +1,154 @@
+#pragma once
+
+#include <mirheo/core/celllist.h>
+#include <mirheo/core/datatypes.h>
+#include <mirheo/core/utils/cuda_common.h>
+
+#include <vector>
+
+namespace mirheo
+{
+
+static void makeCells(const real4 *inputPos, const real4 *inputVel,
+                      real4 *outputPos, real4 *outputVel,
+                      int *cellsStartSize, int *cellsSize,
+                      int *order, int np, CellListInfo cinfo)
+{
+    for (int i = 0; i < cinfo.totcells+1; i++)
+        cellsSize[i] = 0;
+
+    for (int i = 0; i < np; i++)
+        cellsSize[cinfo.getCellId(make_real3(inputPos[i]))]++;
+
+    cellsStartSize[0] = 0;
+    for (int i = 1; i <= cinfo.totcells; i++)
+        cellsStartSize[i] = cellsSize[i-1] + cellsStartSize[i-1];
+
+    for (int i = 0; i < np; i++)
+    {
+        const int cid = cinfo.getCellId(make_real3(inputPos[i]));
+        outputPos[cellsStartSize[cid]] = inputPos[i];
+        outputVel[cellsStartSize[cid]] = inputVel[i];
+        order[cellsStartSize[cid]] = i;
+
+        cellsStartSize[cid]++;
+    }
+
+    for (int i = 0; i < cinfo.totcells; i++)
+        cellsStartSize[i] -= cellsSize[i];
+}
+
+/// Parameters of the DPD forces computed by computeReferenceForces()
+struct ReferenceDPDParams
+{
+    real adpd;     ///< conservative force coefficient
+    real gammadpd; ///< dissipative force coefficient
+    real sigma_dt; ///< random force coefficient
+};
+
+/** Compute the DPD forces of all particles (cut-off radius 1) by traversing all neighbouring cells of each particle.
+    The random number is a deterministic function of the particle ids.
+    \return The forces, in the order of the input particles
+ */
+static std::vector<Force> computeReferenceForces(const std::vector<real4>& initialPos, const std::vector<real4>& initialVel,
+                                                 const CellListInfo& cinfo, ReferenceDPDParams params)
+{
+    const int np = static_cast<int>(initialPos.size());
+    const real adpd     = params.adpd;
+    const real gammadpd = params.gammadpd;
+    const real sigma_dt = params.sigma_dt;
+
+    std::vector<real4> rearrangedPos(np), rearrangedVel(np);
+    std::vector<int> hcellsstart(cinfo.totcells+1);
+    std::vector<int> hcellssize(cinfo.totcells+1);
+    std::vector<int> order(np);
+
+    makeCells(initialPos.data(), initialVel.data(),
+              rearrangedPos.data(), rearrangedVel.data(),
+              hcellsstart.data(), hcellssize.data(),
+              order.data(), np, cinfo);
+
+    std::vector<Force> refAcc(np);
+
+    auto addForce = [&](int dstId, int srcId, Force& a)
+    {
+        Particle pdst(rearrangedPos[dstId], rearrangedVel[dstId]);
+        Particle psrc(rearrangedPos[srcId], rearrangedVel[srcId]);
+        const real _xr = pdst.r.x - psrc.r.x;
+        const real _yr = pdst.r.y - psrc.r.y;
+        const real _zr = pdst.r.z - psrc.r.z;
+
+        const real rij2 = _xr * _xr + _yr * _yr + _zr * _zr;
+
+        if (rij2 > 1.0f) return;
+        //assert(rij2 < 1);
+
+        const real invrij = 1.0f / math::sqrt(rij2);
+        const real rij = rij2 * invrij;
+        const real argwr = 1.0f - rij;
+        const real wr = argwr;
+
+        const real xr = _xr * invrij;
+        const real yr = _yr * invrij;
+        const real zr = _zr * invrij;
+
+        const real rdotv =
+        xr * (pdst.u.x - psrc.u.x) +
+        yr * (pdst.u.y - psrc.u.y) +
+        zr * (pdst.u.z - psrc.u.z);
+
+        int sid = psrc.i1;
+        int did = pdst.i1;
+        const real myrandnr = ((math::min(sid, did) ^ math::max(sid, did)) % 13) - 6;
+
+        const real strength = adpd * argwr - (gammadpd * wr * rdotv + sigma_dt * myrandnr) * wr;
+
+        a.f.x += strength * xr;
+        a.f.y += strength * yr;
+        a.f.z += strength * zr;
+    };
+
+#pragma omp parallel for collapse(3)
+    for (int cx = 0; cx < cinfo.ncells.x; cx++)
+        for (int cy = 0; cy < cinfo.ncells.y; cy++)
+            for (int cz = 0; cz < cinfo.ncells.z; cz++)
+            {
+                const int cid = cinfo.encode(cx, cy, cz);
+
+                const int2 start_size = make_int2(hcellsstart[cid], hcellssize[cid]);
+
+                for (int dstId = start_size.x; dstId < start_size.x + start_size.y; dstId++)
+                {
+                    Force a {{0,0,0},0};
+
+                    for (int dx = -1; dx <= 1; dx++)
+                        for (int dy = -1; dy <= 1; dy++)
+                            for (int dz = -1; dz <= 1; dz++)
+                            {
+                                const int srcCid = cinfo.encode(cx+dx, cy+dy, cz+dz);
+                                if (srcCid >= cinfo.totcells || srcCid < 0) continue;
+
+                                const int2 srcStart_size = make_int2(hcellsstart[srcCid], hcellssize[srcCid]);
+
+                                for (int srcId = srcStart_size.x; srcId < srcStart_size.x + srcStart_size.y; srcId++)
+                                {
+                                    if (dstId != srcId)
+                                        addForce(dstId, srcId, a);
+                                }
+                            }
+
+                    refAcc[dstId].f.x = a.f.x;
+                    refAcc[dstId].f.y = a.f.y;
+                    refAcc[dstId].f.z = a.f.z;
+                }
+            }
+
+    std::vector<Force> finalFrcs(np);
+    for (int i = 0; i < np; i++)
+    {
+        finalFrcs[order[i]] = refAcc[i];
+    }
+    return finalFrcs;
+}
+
+} // namespace mirheo
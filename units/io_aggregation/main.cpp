@@ -0,0 +1,187 @@
+#include <mirheo/core/logger.h>
+#include <mirheo/core/utils/io_aggregator.h>
+#include <mirheo/core/xdmf/type_map.h>
+#include <mirheo/core/xdmf/xdmf.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace mirheo;
+
+// Run with more ranks (e.g. mpirun -n 16, files on a tmpfs) to benchmark the aggregated writes.
+
+static int getRank(MPI_Comm comm)
+{
+    int rank;
+    MPI_Check( MPI_Comm_rank(comm, &rank) );
+    return rank;
+}
+
+static int getSize(MPI_Comm comm)
+{
+    int size;
+    MPI_Check( MPI_Comm_size(comm, &size) );
+    return size;
+}
+
+static const std::vector<int> ranksPerWriterList = {1, 2, 3, 4, IOAggregator::onePerNode};
+
+static std::string ranksPerWriterStr(int ranksPerWriter)
+{
+    return ranksPerWriter == IOAggregator::onePerNode ? "node" : std::to_string(ranksPerWriter);
+}
+
+// rank r has r+1 elements, so that the groups have different sizes
+static std::vector<int2> makeLocalData(int rank)
+{
+    std::vector<int2> data;
+    for (int i = 0; i <= rank; ++i)
+        data.push_back({rank, i});
+    return data;
+}
+
+TEST (IO_AGGREGATION, gather_keeps_rank_order)
+{
+    const MPI_Comm comm = MPI_COMM_WORLD;
+    const int rank = getRank(comm);
+    const int size = getSize(comm);
+
+    for (int ranksPerWriter : ranksPerWriterList)
+    {
+        const IOAggregator aggregator(comm, ranksPerWriter);
+        const auto gathered = aggregator.gather(makeLocalData(rank));
+
+        if (ranksPerWriter == 1)
+        {
+            ASSERT_FALSE(aggregator.isActive());
+        }
+        if (ranksPerWriter > 1)
+        {
+            ASSERT_EQ(aggregator.isWriter(), rank % ranksPerWriter == 0);
+        }
+
+        if (!aggregator.isWriter())
+        {
+            ASSERT_TRUE(gathered.empty());
+            ASSERT_EQ(aggregator.getWriterComm(), MPI_COMM_NULL);
+            continue;
+        }
+
+        // each writer holds the data of consecutive ranks, starting with its own
+        size_t i = 0;
+        int lastRank = rank - 1;
+        for (int r = rank; r < size && i < gathered.size(); ++r)
+        {
+            for (const auto& ref : makeLocalData(r))
+            {
+                ASSERT_LT(i, gathered.size());
+                ASSERT_EQ(gathered[i].x, ref.x) << "ranks per writer " << ranksPerWriterStr(ranksPerWriter);
+                ASSERT_EQ(gathered[i].y, ref.y) << "ranks per writer " << ranksPerWriterStr(ranksPerWriter);
+                ++i;
+            }
+            lastRank = r;
+        }
+        ASSERT_EQ(i, gathered.size());
+
+        // the groups cover all the ranks
+        const MPI_Comm writerComm = aggregator.getWriterComm();
+        const int range[2] = {rank, lastRank};
+        std::vector<int> ranges(2 * getSize(writerComm));
+        MPI_Check( MPI_Allgather(range, 2, MPI_INT, ranges.data(), 2, MPI_INT, writerComm) );
+
+        ASSERT_EQ(ranges.front(), 0);
+        ASSERT_EQ(ranges.back(), size - 1);
+        for (size_t w = 1; w < ranges.size() / 2; ++w)
+            ASSERT_EQ(ranges[2 * w], ranges[2 * w - 1] + 1);
+    }
+}
+
+TEST (IO_AGGREGATION, particles_identical_to_direct_writes)
+{
+    const MPI_Comm comm = MPI_COMM_WORLD;
+    const int rank = getRank(comm);
+    const long nLocal = 100000 + 5000 * (rank % 3);
+
+    long offset {0};
+    MPI_Check( MPI_Exscan(&nLocal, &offset, 1, MPI_LONG, MPI_SUM, comm) );
+    if (rank == 0) offset = 0;
+
+    auto positions = std::make_shared<std::vector<real3>>(nLocal);
+    std::vector<real3> velocities(nLocal);
+    std::vector<int64_t> ids(nLocal);
+
+    for (long i = 0; i < nLocal; ++i)
+    {
+        const auto id = offset + i;
+        ids[i] = id;
+        (*positions)[i] = {0.001_r * id, 0.5_r, 2.0_r};
+        velocities[i] = {1.0_r, -0.0001_r * id, 3.0_r};
+    }
+
+    std::vector<XDMF::Channel> channels {
+        {"velocity", velocities.data(), XDMF::Channel::Vector{}, XDMF::getNumberType<real>(),
+         DataTypeWrapper<real>(), XDMF::Channel::NeedShift::False},
+        {"id", ids.data(), XDMF::Channel::Scalar{}, XDMF::Channel::NumberType::Int64,
+         DataTypeWrapper<int64_t>(), XDMF::Channel::NeedShift::False}
+    };
+
+    long globalBytes = nLocal * static_cast<long>(2 * sizeof(real3) + sizeof(int64_t));
+    MPI_Check( MPI_Allreduce(MPI_IN_PLACE, &globalBytes, 1, MPI_LONG, MPI_SUM, comm) );
+
+    for (int ranksPerWriter : ranksPerWriterList)
+    {
+        const std::string rpw = ranksPerWriterStr(ranksPerWriter);
+        setenv("MIRHEO_IO_RANKS_PER_WRITER", rpw.c_str(), 1);
+        const std::string fname = "particles_rpw_" + rpw;
+
+        XDMF::VertexGrid grid(positions, comm);
+
+        MPI_Check( MPI_Barrier(comm) );
+        const double start = MPI_Wtime();
+        XDMF::write(fname, &grid, channels, comm);
+        const double seconds = MPI_Wtime() - start;
+
+        if (rank == 0)
+            printf("%2d ranks, %4s ranks per writer: %8.2f ms, %8.1f MB/s\n", getSize(comm), rpw.c_str(),
+                   1e3 * seconds, 1e-6 * static_cast<double>(globalBytes) / seconds);
+
+        unsetenv("MIRHEO_IO_RANKS_PER_WRITER");
+
+        const auto read = XDMF::readVertexData(fname + ".xmf", comm, 1);
+        ASSERT_EQ(read.descriptions.size(), 2u);
+        const auto *readVel = reinterpret_cast<const real3*>(read.data[0].data());
+        const auto *readIds = reinterpret_cast<const int64_t*>(read.data[1].data());
+
+        // the particles must be in the global rank order
+        long readOffset {0};
+        long nRead = static_cast<long>(read.positions.size());
+        MPI_Check( MPI_Exscan(&nRead, &readOffset, 1, MPI_LONG, MPI_SUM, comm) );
+        if (rank == 0) readOffset = 0;
+
+        for (long i = 0; i < nRead; ++i)
+        {
+            const int64_t id = readOffset + i;
+            ASSERT_EQ(readIds[i], id) << "ranks per writer " << rpw;
+            ASSERT_EQ(read.positions[i].x, 0.001_r * id);
+            ASSERT_EQ(readVel[i].y, -0.0001_r * id);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+
+    logger.init(MPI_COMM_WORLD, "io_aggregation.log", 3);
+
+    testing::InitGoogleTest(&argc, argv);
+    auto retval = RUN_ALL_TESTS();
+
+    MPI_Finalize();
+    return retval;
+}
@@ -0,0 +1,216 @@
+#include <mirheo/core/logger.h>
+#include <mirheo/plugins/utils/dipole_tree.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace mirheo;
+using namespace mirheo::magnetic_dipoles;
+
+namespace
+{
+const real3 L {64.0_r, 64.0_r, 64.0_r};
+const real mu0_4pi = 1.0_r;
+
+std::vector<Dipole> generateDipoles(int n, real3 lo, real3 hi, long seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<real> ux(lo.x, hi.x), uy(lo.y, hi.y), uz(lo.z, hi.z);
+    std::normal_distribution<real> normal(0.0_r, 1.0_r);
+
+    std::vector<Dipole> dipoles(n);
+    for (auto& d : dipoles)
+    {
+        d.r = make_real3(ux(gen), uy(gen), uz(gen));
+        d.m = normalize(make_real3(normal(gen), normal(gen), normal(gen)));
+    }
+    return dipoles;
+}
+
+struct Result
+{
+    std::vector<real3> forces, torques;
+};
+
+/// reference: all pairs
+Result directSum(const std::vector<Dipole>& targets, const std::vector<Dipole>& sources, bool periodic)
+{
+    Result res {std::vector<real3>(targets.size()), std::vector<real3>(targets.size())};
+    const int n = static_cast<int>(targets.size());
+
+#pragma omp parallel for
+    for (int i = 0; i < n; ++i)
+    {
+        real3 f = make_real3(0.0_r), t = make_real3(0.0_r);
+        for (const auto& src : sources)
+            addInteraction(difference(targets[i].r, src.r, L, periodic), targets[i].m, src.m, mu0_4pi, f, t);
+
+        res.forces[i] = f;
+        res.torques[i] = t;
+    }
+    return res;
+}
+
+Result treeSum(const std::vector<Dipole>& targets, const DipoleTree& tree,
+               const std::vector<DipoleCluster>& clusters, real theta, bool periodic)
+{
+    Result res {std::vector<real3>(targets.size()), std::vector<real3>(targets.size())};
+    const SumParameters params {mu0_4pi, theta, L, periodic};
+    computeInteractions(targets, tree, clusters, params, res.forces.data(), res.torques.data());
+    return res;
+}
+
+/// relative L2 error of a with respect to the reference b
+double relativeError(const std::vector<real3>& a, const std::vector<real3>& b)
+{
+    double num = 0, den = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        const real3 d = a[i] - b[i];
+        num += dot(d, d);
+        den += dot(b[i], b[i]);
+    }
+    return std::sqrt(num / den);
+}
+
+double elapsedSince(std::chrono::high_resolution_clock::time_point start)
+{
+    const auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+} // anonymous namespace
+
+TEST (MAGNETIC_DIPOLES, tree_with_zero_opening_angle_is_exact)
+{
+    for (bool periodic : {false, true})
+    {
+        const auto dipoles = generateDipoles(2000, make_real3(0.0_r), L, 42);
+
+        DipoleTree tree;
+        tree.build(dipoles);
+        ASSERT_EQ(tree.getNumDipoles(), 2000);
+
+        const auto ref = directSum(dipoles, dipoles, periodic);
+        const auto res = treeSum(dipoles, tree, {}, 0.0_r, periodic);
+
+        ASSERT_LT(relativeError(res.forces,  ref.forces),  1e-5);
+        ASSERT_LT(relativeError(res.torques, ref.torques), 1e-5);
+    }
+}
+
+TEST (MAGNETIC_DIPOLES, tree_error_decreases_with_opening_angle)
+{
+    const auto dipoles = generateDipoles(4000, make_real3(0.0_r), L, 1234);
+    const bool periodic = true;
+
+    DipoleTree tree;
+    tree.build(dipoles);
+
+    const auto ref = directSum(dipoles, dipoles, periodic);
+
+    double previousError = 1.0;
+    for (real theta : {0.8_r, 0.5_r, 0.3_r, 0.1_r})
+    {
+        const auto res = treeSum(dipoles, tree, {}, theta, periodic);
+        const double errForces  = relativeError(res.forces,  ref.forces);
+        const double errTorques = relativeError(res.torques, ref.torques);
+
+        printf("theta = %.1f: relative error of forces %.2e, torques %.2e\n", theta, errForces, errTorques);
+
+        ASSERT_LT(errForces, previousError);
+        ASSERT_LT(errForces, theta * 0.1);
+        ASSERT_LT(errTorques, theta * 0.1);
+        previousError = errForces;
+    }
+}
+
+// mimic the plugin: the sources of one "far rank" are only known through their clusters
+TEST (MAGNETIC_DIPOLES, far_clusters_match_direct_sum)
+{
+    const real3 h {16.0_r, 16.0_r, 16.0_r};
+    const bool periodic = false;
+
+    const auto targets = generateDipoles(500, make_real3(0.0_r), h, 7);
+    const auto sources = generateDipoles(3000, make_real3(2 * h.x, 0.0_r, 0.0_r), make_real3(3 * h.x, h.y, h.z), 8);
+
+    const auto ref = directSum(targets, sources, periodic);
+
+    DipoleTree empty;
+    DipoleTree sourceTree;
+    sourceTree.build(sources);
+
+    double previousError = 1.0;
+    for (real theta : {1.0_r, 0.5_r, 0.25_r})
+    {
+        const int depth = static_cast<int>(std::ceil(std::log2(1.0_r / theta)));
+        const auto clusters = sourceTree.getClusters(depth);
+
+        const auto res = treeSum(targets, empty, clusters, theta, periodic);
+        const double err = relativeError(res.forces, ref.forces);
+
+        printf("summary depth %d: %zu clusters for %zu dipoles, relative error of forces %.2e\n",
+               depth, clusters.size(), sources.size(), err);
+
+        ASSERT_LE(clusters.size(), sources.size());
+        ASSERT_LT(err, previousError);
+        previousError = err;
+    }
+
+    // all leaves expanded: exact
+    const auto res = treeSum(targets, empty, sourceTree.getClusters(64), 0.0_r, periodic);
+    ASSERT_LT(relativeError(res.forces, ref.forces), 1e-5);
+}
+
+TEST (MAGNETIC_DIPOLES, scaling_benchmark)
+{
+    const real theta = 0.5_r;
+    constexpr int maxDirect = 16000;
+
+    for (int n : {1000, 4000, 16000, 64000})
+    {
+        // constant density
+        const real scale = std::cbrt(static_cast<real>(n) / 64000.0_r);
+        const real3 size = scale * L;
+        const auto dipoles = generateDipoles(n, make_real3(0.0_r), size, n);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        DipoleTree tree;
+        tree.build(dipoles);
+        const double tBuild = elapsedSince(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        const auto res = treeSum(dipoles, tree, {}, theta, false);
+        const double tTree = elapsedSince(start);
+
+        if (n <= maxDirect)
+        {
+            start = std::chrono::high_resolution_clock::now();
+            const auto ref = directSum(dipoles, dipoles, false);
+            const double tDirect = elapsedSince(start);
+
+            printf("N = %6d: direct %8.4f s, tree build %8.4f s + sum %8.4f s, relative error %.2e\n",
+                   n, tDirect, tBuild, tTree, relativeError(res.forces, ref.forces));
+        }
+        else
+        {
+            printf("N = %6d: direct        -  , tree build %8.4f s + sum %8.4f s\n", n, tBuild, tTree);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+    logger.init(MPI_COMM_WORLD, "magnetic_dipoles.log", 0);
+
+    testing::InitGoogleTest(&argc, argv);
+    auto ret = RUN_ALL_TESTS();
+
+    MPI_Finalize();
+    return ret;
+}
@@ -0,0 +1,385 @@
+#include <mirheo/core/initial_conditions/membrane.h>
+#include <mirheo/core/interactions/membrane/base_membrane.h>
+#include <mirheo/core/interactions/membrane/element_forces.h>
+#include <mirheo/core/interactions/membrane/factory.h>
+#include <mirheo/core/interactions/membrane/force_kernels/dihedral/juelicher.h>
+#include <mirheo/core/interactions/membrane/force_kernels/dihedral/kantor.h>
+#include <mirheo/core/interactions/membrane/force_kernels/triangle/lim.h>
+#include <mirheo/core/interactions/membrane/force_kernels/triangle/wlc.h>
+#include <mirheo/core/logger.h>
+#include <mirheo/core/mesh/membrane.h>
+#include <mirheo/core/mesh/membrane_elements.h>
+#include <mirheo/core/pvs/membrane_vector.h>
+#include <mirheo/core/pvs/views/ov.h>
+#include <mirheo/core/utils/common.h>
+#include <mirheo/core/utils/cuda_common.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace mirheo;
+
+static const std::string rbc_off = "../../data/rbc_mesh.off";
+
+static CommonMembraneParameters commonParameters(real gammaC, real kBT)
+{
+    CommonMembraneParameters p;
+    p.totArea0   = 135.0_r;
+    p.totVolume0 = 94.0_r;
+    p.ka = 5000.0_r;
+    p.kv = 5000.0_r;
+    p.gammaC = gammaC;
+    p.kBT = kBT;
+    return p;
+}
+
+static WLCParameters wlcParameters()
+{
+    WLCParameters p;
+    p.x0 = 0.457_r;
+    p.ks = 22.3_r;
+    p.mpow = 2.0_r;
+    p.kd = 5.0_r;
+    p.totArea0 = 135.0_r;
+    return p;
+}
+
+static LimParameters limParameters()
+{
+    LimParameters p;
+    p.ka = 5.0_r;
+    p.a3 = -2.0_r;
+    p.a4 = 8.0_r;
+    p.mu = 30.0_r;
+    p.b1 = 0.7_r;
+    p.b2 = 0.75_r;
+    p.totArea0 = 135.0_r;
+    return p;
+}
+
+static KantorBendingParameters kantorParameters()
+{
+    KantorBendingParameters p;
+    p.kb = 10.0_r;
+    p.theta = 0.0_r;
+    return p;
+}
+
+static JuelicherBendingParameters juelicherParameters()
+{
+    JuelicherBendingParameters p;
+    p.kb = 10.0_r;
+    p.C0 = 0.0_r;
+    p.kad = 5.0_r;
+    p.DA0 = 0.0_r;
+    return p;
+}
+
+/// membranes on a regular grid, with random perturbations of the vertices and random velocities
+static void initializeMembranes(MembraneVector *mv, int nObjects, long seed)
+{
+    const real spacing = 10.0_r;
+    const int n = static_cast<int>(std::ceil(std::cbrt(static_cast<double>(nObjects))));
+
+    std::vector<ComQ> comQ;
+    for (int i = 0; i < nObjects; ++i)
+    {
+        const real3 r {spacing * (0.5_r + static_cast<real>(i % n)),
+                       spacing * (0.5_r + static_cast<real>((i / n) % n)),
+                       spacing * (0.5_r + static_cast<real>(i / (n * n)))};
+        comQ.push_back({r, {1.0_r, 0.0_r, 0.0_r, 0.0_r}});
+    }
+
+    MembraneIC ic(comQ);
+    ic.exec(MPI_COMM_WORLD, mv, defaultStream);
+
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<real> noise(-0.05_r, 0.05_r);
+
+    auto& pos = mv->local()->positions();
+    auto& vel = mv->local()->velocities();
+    for (size_t i = 0; i < pos.size(); ++i)
+    {
+        pos[i].x += noise(gen);
+        pos[i].y += noise(gen);
+        pos[i].z += noise(gen);
+        vel[i].x = noise(gen);
+        vel[i].y = noise(gen);
+        vel[i].z = noise(gen);
+    }
+    pos.uploadToDevice(defaultStream);
+    vel.uploadToDevice(defaultStream);
+}
+
+static std::vector<real3> computeForces(BaseMembraneInteraction *interaction, MembraneVector *mv)
+{
+    mv->local()->forces().clear(defaultStream);
+    interaction->local(mv, mv, nullptr, nullptr, defaultStream);
+
+    auto& forces = mv->local()->forces();
+    forces.downloadFromDevice(defaultStream);
+
+    std::vector<real3> f;
+    for (const auto& force : forces)
+        f.push_back(force.f);
+    return f;
+}
+
+/// \return max |a - b| / max |a|
+static double relativeError(const std::vector<real3>& a, const std::vector<real3>& b)
+{
+    double maxDiff = 0, maxNorm = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        maxDiff = std::max(maxDiff, static_cast<double>(length(a[i] - b[i])));
+        maxNorm = std::max(maxNorm, static_cast<double>(length(a[i])));
+    }
+    return maxDiff / maxNorm;
+}
+
+static void makeHostView(OVview& view, LocalObjectVector *lov)
+{
+    lov->positions ().downloadFromDevice(defaultStream);
+    lov->velocities().downloadFromDevice(defaultStream);
+    view.positions  = lov->positions ().hostPtr();
+    view.velocities = lov->velocities().hostPtr();
+}
+
+static void makeHostView(OVviewWithAreaVolume& view, LocalObjectVector *lov)
+{
+    makeHostView(static_cast<OVview&>(view), lov);
+    auto areaVolumes = lov->dataPerObject.getData<real2>(channel_names::areaVolumes);
+    areaVolumes->downloadFromDevice(defaultStream);
+    view.area_volumes = areaVolumes->hostPtr();
+}
+
+static void makeHostView(OVviewWithJuelicherQuants& view, LocalObjectVector *lov)
+{
+    makeHostView(static_cast<OVviewWithAreaVolume&>(view), lov);
+
+    auto areas          = lov->dataPerParticle.getData<real>(channel_names::areas);
+    auto meanCurvatures = lov->dataPerParticle.getData<real>(channel_names::meanCurvatures);
+    auto lenThetaTot    = lov->dataPerObject  .getData<real>(channel_names::lenThetaTot);
+    areas         ->downloadFromDevice(defaultStream);
+    meanCurvatures->downloadFromDevice(defaultStream);
+    lenThetaTot   ->downloadFromDevice(defaultStream);
+    view.vertexAreas          = areas         ->hostPtr();
+    view.vertexMeanCurvatures = meanCurvatures->hostPtr();
+    view.lenThetaTot          = lenThetaTot   ->hostPtr();
+}
+
+/// The membrane forces of the host reference, which does not include the viscous and random forces
+template <class ShearParams, class BendingParams>
+static std::vector<real3> computeHostReference(ShearParams shear, BendingParams bending, CommonMembraneParameters common,
+                                               MembraneVector *mv)
+{
+    using TriangleForce = typename ShearParams::template TriangleForce<StressFreeState::Active>;
+    using DihedralForce = typename BendingParams::DihedralForce;
+
+    auto mesh = static_cast<MembraneMesh*>(mv->mesh.get());
+    const MembraneMeshElements elements(mesh);
+
+    OVviewWithAreaVolume view(mv, mv->local());
+    typename DihedralForce::ViewType dihedralView(mv, mv->local());
+    makeHostView(view, mv->local());
+    makeHostView(dihedralView, mv->local());
+
+    membrane_forces_kernels::GPUConstraintMembraneParameters constraints;
+    constraints.totArea0   = common.totArea0;
+    constraints.totVolume0 = common.totVolume0;
+    constraints.ka0 = common.ka / common.totArea0;
+    constraints.kv0 = common.kv / (6.0_r * common.totVolume0);
+
+    std::vector<mReal3> forces(mv->local()->size());
+    membrane_forces_kernels::computeMembraneForcesPerElementHost
+        (TriangleForce(shear, mesh, 1.0_r), DihedralForce(bending, 1.0_r), dihedralView, view,
+         MembraneMeshView(mesh, false), MembraneMeshElementsView(&elements, false), constraints, forces.data());
+
+    std::vector<real3> f;
+    for (const auto& force : forces)
+        f.push_back(make_real3(force));
+    return f;
+}
+
+template <class ShearParams, class BendingParams>
+static void checkElementAssembly(ShearParams shear, BendingParams bending, real gammaC, real kBT)
+{
+    const real L = 64.0_r;
+    DomainInfo domain;
+    domain.globalSize  = {L, L, L};
+    domain.globalStart = {0.0_r, 0.0_r, 0.0_r};
+    domain.localSize   = {L, L, L};
+    MirState state(domain, 1e-3_r);
+
+    auto mesh = std::make_shared<MembraneMesh>(rbc_off);
+    const auto common = commonParameters(gammaC, kBT);
+
+    auto vertexInteraction = createInteractionMembrane(&state, "vertex", common, bending, shear, true, 1.0_r, 0.0_r,
+                                                       FilterKeepAll{}, MembraneForceAssembly::Vertex);
+    auto elementInteraction = createInteractionMembrane(&state, "element", common, bending, shear, true, 1.0_r, 0.0_r,
+                                                        FilterKeepAll{}, MembraneForceAssembly::Element);
+
+    MembraneVector mv(&state, "rbc", 1.0_r, mesh);
+    vertexInteraction ->setPrerequisites(&mv, &mv, nullptr, nullptr);
+    elementInteraction->setPrerequisites(&mv, &mv, nullptr, nullptr);
+    initializeMembranes(&mv, 8, 4242);
+
+    const auto vertexForces   = computeForces(vertexInteraction .get(), &mv);
+    const auto elementForces  = computeForces(elementInteraction.get(), &mv);
+    const auto elementForces2 = computeForces(elementInteraction.get(), &mv);
+
+    // the element assembly does not depend on the scheduling of the threads
+    ASSERT_EQ(elementForces.size(), elementForces2.size());
+    ASSERT_EQ(0, std::memcmp(elementForces.data(), elementForces2.data(), elementForces.size() * sizeof(real3)));
+
+    ASSERT_LE(relativeError(vertexForces, elementForces), 1e-4);
+
+    if (gammaC == 0 && kBT == 0)
+    {
+        // the same order of summation as on the device; differences come from the floating point instructions only
+        const auto hostForces = computeHostReference(shear, bending, common, &mv);
+        ASSERT_LE(relativeError(hostForces, elementForces), 1e-4);
+    }
+}
+
+TEST (MEMBRANE_FORCES, element_assembly_wlc_kantor)
+{
+    checkElementAssembly(wlcParameters(), kantorParameters(), 0.0_r, 0.0_r);
+}
+
+TEST (MEMBRANE_FORCES, element_assembly_wlc_juelicher)
+{
+    checkElementAssembly(wlcParameters(), juelicherParameters(), 0.0_r, 0.0_r);
+}
+
+TEST (MEMBRANE_FORCES, element_assembly_lim_kantor)
+{
+    checkElementAssembly(limParameters(), kantorParameters(), 0.0_r, 0.0_r);
+}
+
+TEST (MEMBRANE_FORCES, element_assembly_lim_juelicher)
+{
+    checkElementAssembly(limParameters(), juelicherParameters(), 0.0_r, 0.0_r);
+}
+
+TEST (MEMBRANE_FORCES, element_assembly_viscous_and_random_forces)
+{
+    checkElementAssembly(wlcParameters(), kantorParameters(), 10.0_r, 0.01_r);
+}
+
+TEST (MEMBRANE_FORCES, elements_have_distinct_vertices_per_color)
+{
+    MembraneMesh mesh(rbc_off);
+    const MembraneMeshElements elements(&mesh);
+    const MembraneMeshElementsView view(&elements, false);
+
+    const int nedges = 3 * mesh.getNtriangles() / 2;
+    ASSERT_EQ(view.triangleColorStarts[view.nTriangleColors], mesh.getNtriangles());
+    ASSERT_EQ(view.dihedralColorStarts[view.nDihedralColors], nedges);
+    ASSERT_EQ(view.edgeColorStarts    [view.nEdgeColors],     nedges);
+
+    auto checkColors = [](int nColors, const int *starts, auto getVertices)
+    {
+        for (int color = 0; color < nColors; ++color)
+        {
+            std::set<int> vertices;
+            int n = 0;
+            for (int i = starts[color]; i < starts[color + 1]; ++i)
+            {
+                for (int v : getVertices(i))
+                {
+                    vertices.insert(v);
+                    ++n;
+                }
+            }
+            ASSERT_EQ(static_cast<int>(vertices.size()), n) << "color " << color;
+        }
+    };
+
+    checkColors(view.nTriangleColors, view.triangleColorStarts, [&](int i)
+    {
+        const int3 t = view.triangles[i].vertices;
+        return std::vector<int>{t.x, t.y, t.z};
+    });
+    checkColors(view.nDihedralColors, view.dihedralColorStarts, [&](int i)
+    {
+        const int4 d = view.dihedrals[i];
+        return std::vector<int>{d.x, d.y, d.z, d.w};
+    });
+    checkColors(view.nEdgeColors, view.edgeColorStarts, [&](int i)
+    {
+        const int2 e = view.edges[i];
+        return std::vector<int>{e.x, e.y};
+    });
+}
+
+template <class ShearParams, class BendingParams>
+static void benchmarkAssembly(const char *name, ShearParams shear, BendingParams bending)
+{
+    const int nObjects = 1000;
+    const int nIterations = 50;
+    const real L = 100.0_r;
+
+    DomainInfo domain;
+    domain.globalSize  = {L, L, L};
+    domain.globalStart = {0.0_r, 0.0_r, 0.0_r};
+    domain.localSize   = {L, L, L};
+    MirState state(domain, 1e-3_r);
+
+    auto mesh = std::make_shared<MembraneMesh>(rbc_off);
+    const auto common = commonParameters(10.0_r, 0.01_r);
+
+    for (auto assembly : {MembraneForceAssembly::Vertex, MembraneForceAssembly::Element})
+    {
+        auto interaction = createInteractionMembrane(&state, "membrane", common, bending, shear, true, 1.0_r, 0.0_r,
+                                                     FilterKeepAll{}, assembly);
+        MembraneVector mv(&state, "rbc", 1.0_r, mesh);
+        interaction->setPrerequisites(&mv, &mv, nullptr, nullptr);
+        initializeMembranes(&mv, nObjects, 4242);
+
+        // warm up; also builds the elements
+        interaction->local(&mv, &mv, nullptr, nullptr, defaultStream);
+        CUDA_Check( cudaDeviceSynchronize() );
+
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < nIterations; ++i)
+            interaction->local(&mv, &mv, nullptr, nullptr, defaultStream);
+        CUDA_Check( cudaDeviceSynchronize() );
+        const auto end = std::chrono::high_resolution_clock::now();
+
+        const double ms = std::chrono::duration<double, std::milli>(end - start).count() / nIterations;
+        printf("%-16s %-7s assembly: %8.3f ms per step (%d membranes)\n", name,
+               assembly == MembraneForceAssembly::Vertex ? "vertex" : "element", ms, nObjects);
+    }
+}
+
+TEST (MEMBRANE_FORCES, benchmark_assembly)
+{
+    benchmarkAssembly("wlc + kantor",    wlcParameters(), kantorParameters());
+    benchmarkAssembly("wlc + juelicher", wlcParameters(), juelicherParameters());
+    benchmarkAssembly("lim + kantor",    limParameters(), kantorParameters());
+    benchmarkAssembly("lim + juelicher", limParameters(), juelicherParameters());
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+
+    logger.init(MPI_COMM_WORLD, "membrane_forces.log", 3);
+    setenv("MIRHEO_MESH_CACHE_DIR", ".", 1);
+
+    testing::InitGoogleTest(&argc, argv);
+    auto retval = RUN_ALL_TESTS();
+
+    MPI_Finalize();
+    return retval;
+}
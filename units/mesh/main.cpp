@@ -2,11 +2,17 @@
 #include <mirheo/core/mesh/mesh.h>
 #include <mirheo/core/mesh/membrane.h>
 #include <mirheo/core/mesh/edge_colors.h>
+#include <mirheo/core/mesh/mesh_cache.h>
+#include <mirheo/core/mesh/off.h>
+#include <mirheo/core/utils/path.h>
 
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <cmath>
 #include <set>
 #include <string>
+#include <sys/stat.h>
 #include <gtest/gtest.h>
 
 using namespace mirheo;
@@ -127,12 +133,173 @@ TEST (MESH, edgeSets)
     ASSERT_EQ(numUsedEdges, numEdges);
 }
 
+template <class ContA, class ContB>
+static void assertSame(const ContA& a, const ContB& b)
+{
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i)
+        ASSERT_EQ(a[i], b[i]) << "at " << i;
+}
+
+static void assertSameMeshes(const MembraneMesh& a, const MembraneMesh& b)
+{
+    ASSERT_EQ(a.getNvertices(), b.getNvertices());
+    ASSERT_EQ(a.getNtriangles(), b.getNtriangles());
+    ASSERT_EQ(a.getMaxDegree(), b.getMaxDegree());
+
+    for (int i = 0; i < a.getNvertices(); ++i)
+    {
+        ASSERT_EQ(a.getVertices()[i].x, b.getVertices()[i].x);
+        ASSERT_EQ(a.getVertices()[i].y, b.getVertices()[i].y);
+        ASSERT_EQ(a.getVertices()[i].z, b.getVertices()[i].z);
+    }
+    for (int i = 0; i < a.getNtriangles(); ++i)
+    {
+        ASSERT_EQ(a.getFaces()[i].x, b.getFaces()[i].x);
+        ASSERT_EQ(a.getFaces()[i].y, b.getFaces()[i].y);
+        ASSERT_EQ(a.getFaces()[i].z, b.getFaces()[i].z);
+    }
+    assertSame(a.getAdjacents(), b.getAdjacents());
+    assertSame(a.getDegrees(), b.getDegrees());
+    assertSame(a.getEdgeColors(), b.getEdgeColors());
+}
+
+// torus made of a periodic n x m grid; every vertex has degree 6
+static void writeTorusOff(int n, int m, const std::string& fileName)
+{
+    std::vector<real3> vertices;
+    std::vector<int3> faces;
+    const real R = 4.0_r, r = 1.0_r;
+
+    for (int i = 0; i < n; ++i)
+    {
+        for (int j = 0; j < m; ++j)
+        {
+            const real theta = 2 * M_PI * i / n;
+            const real phi   = 2 * M_PI * j / m;
+            vertices.push_back({(R + r * std::cos(phi)) * std::cos(theta),
+                                (R + r * std::cos(phi)) * std::sin(theta),
+                                r * std::sin(phi)});
+
+            const int a = i * m + j;
+            const int b = ((i + 1) % n) * m + j;
+            const int c = ((i + 1) % n) * m + (j + 1) % m;
+            const int d = i * m + (j + 1) % m;
+            faces.push_back({a, b, c});
+            faces.push_back({a, c, d});
+        }
+    }
+    writeOff(vertices, faces, fileName);
+}
+
+TEST (MESH, cache_gives_same_mesh)
+{
+    unsetenv("MIRHEO_MESH_CACHE_DIR");
+    ASSERT_EQ(mesh_cache::getFileName(mesh_cache::Content::Membrane, rbc_off, rbc_off), "");
+    MembraneMesh ref(rbc_off);
+    setenv("MIRHEO_MESH_CACHE_DIR", ".", 1);
+
+    std::remove(mesh_cache::getFileName(mesh_cache::Content::Membrane, rbc_off, rbc_off).c_str());
+
+    MembraneMesh first(rbc_off);  // writes the cache
+    MembraneMesh second(rbc_off); // reads the cache
+    Mesh geometry(rbc_off);
+
+    assertSameMeshes(ref, first);
+    assertSameMeshes(ref, second);
+    ASSERT_EQ(geometry.getNvertices(), ref.getNvertices());
+    ASSERT_EQ(geometry.getNtriangles(), ref.getNtriangles());
+    checkColors(&second);
+}
 
+TEST (MESH, cache_is_written_in_cache_folder)
+{
+    const std::string fileName = "folder_torus.off";
+    const std::string folder = "mesh_cache_folder";
+    writeTorusOff(8, 6, fileName);
+
+    const auto entry = mesh_cache::getEntry(mesh_cache::Content::Membrane, fileName, fileName, folder);
+    ASSERT_EQ(getParentPath(entry.fileName), joinPaths(folder, ""));
+    ASSERT_EQ(getBaseName(entry.fileName).find(fileName), 0u);
+    std::remove(entry.fileName.c_str());
+
+    MembraneMesh mesh(fileName, fileName, folder);
+    const mesh_cache::Reader cache(entry.fileName, entry.key);
+    ASSERT_TRUE(cache.isValid());
+    ASSERT_EQ(cache.getMaxDegree(), mesh.getMaxDegree());
+}
+
+TEST (MESH, cache_names_are_unique)
+{
+    const std::string folder = "mesh_cache_unique";
+    const std::string fileA = "torus_unique.off";
+    const std::string fileB = joinPaths(folder, fileA);
+    mkdir(folder.c_str(), 0755);
+    writeTorusOff(8, 6, fileA);
+    writeTorusOff(10, 6, fileB);
+
+    using mesh_cache::Content;
 
+    // same file name in two folders
+    ASSERT_NE(mesh_cache::getFileName(Content::Membrane, fileA, fileA, folder),
+              mesh_cache::getFileName(Content::Membrane, fileB, fileB, folder));
+
+    // the geometry and the membrane caches of the same file
+    const auto geometryEntry = mesh_cache::getEntry(Content::Geometry, fileA, fileA, folder);
+    const auto membraneEntry = mesh_cache::getEntry(Content::Membrane, fileA, fileA, folder);
+    ASSERT_NE(geometryEntry.fileName, membraneEntry.fileName);
+
+    Mesh geometry(fileA, folder);
+    MembraneMesh membrane(fileA, fileA, folder);
+    MembraneMesh other(fileB, fileB, folder);
+    ASSERT_EQ(other.getNvertices(), 10 * 6);
+
+    // loading one does not invalidate the others
+    ASSERT_TRUE(mesh_cache::Reader(geometryEntry.fileName, geometryEntry.key).isValid());
+    ASSERT_TRUE(mesh_cache::Reader(membraneEntry.fileName, membraneEntry.key).has(mesh_cache::Section::Adjacent));
+}
+
+TEST (MESH, cache_detects_modified_file)
+{
+    const std::string fileName = "modified.off";
+
+    writeTorusOff(8, 6, fileName);
+    MembraneMesh a(fileName);
+    ASSERT_EQ(a.getNvertices(), 8 * 6);
+
+    writeTorusOff(10, 6, fileName);
+    MembraneMesh b(fileName);
+    ASSERT_EQ(b.getNvertices(), 10 * 6);
+}
+
+TEST (MESH, cache_benchmark)
+{
+    const std::string fileName = "torus.off";
+    writeTorusOff(400, 250, fileName);
+    std::remove(mesh_cache::getFileName(mesh_cache::Content::Membrane, fileName, fileName).c_str());
+
+    auto time = [](auto&& f)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    const double tParse  = time([&]() {readOff(fileName);});
+    const double tFirst  = time([&]() {MembraneMesh mesh(fileName); MeshDistinctEdgeSets sets(&mesh);});
+    const double tCached = time([&]() {MembraneMesh mesh(fileName); MeshDistinctEdgeSets sets(&mesh);});
+
+    printf("text off parsing: %.3f s; membrane mesh + edge sets: %.3f s (first load), %.3f s (cached)\n",
+           tParse, tFirst, tCached);
+}
 
 int main(int argc, char **argv)
 {
     logger.init(MPI_COMM_NULL, "mesh.log", 0);
+
+    // keep the mesh cache files in the working directory rather than next to the data
+    setenv("MIRHEO_MESH_CACHE_DIR", ".", 1);
+
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
 }
@@ -0,0 +1,232 @@
+#include <mirheo/core/logger.h>
+#include <mirheo/core/mesh/mesh.h>
+#include <mirheo/core/object_belonging/mesh_bvh.h>
+#include <mirheo/core/utils/cuda_common.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace mirheo;
+
+static const std::string rbc_off = "../../data/rbc_mesh.off";
+
+using Vertices = std::vector<real3>;
+using Faces = std::vector<int3>;
+
+// unit icosphere with 20 * 4^nsubdivisions triangles
+static std::tuple<Vertices, Faces> makeIcosphere(int nsubdivisions)
+{
+    const real t = (1.0_r + std::sqrt(5.0_r)) / 2.0_r;
+    Vertices vertices {{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+                       {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+                       {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+    Faces faces {{0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+                 {1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+                 {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+                 {4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}};
+
+    for (auto& v : vertices)
+        v = normalize(v);
+
+    for (int s = 0; s < nsubdivisions; ++s)
+    {
+        std::map<std::pair<int, int>, int> midpoints;
+        auto midpoint = [&](int a, int b)
+        {
+            const auto key = std::make_pair(std::min(a, b), std::max(a, b));
+            auto it = midpoints.find(key);
+            if (it != midpoints.end())
+                return it->second;
+            vertices.push_back(normalize(0.5_r * (vertices[a] + vertices[b])));
+            const int id = static_cast<int>(vertices.size()) - 1;
+            midpoints[key] = id;
+            return id;
+        };
+
+        Faces refined;
+        for (auto f : faces)
+        {
+            const int a = midpoint(f.x, f.y);
+            const int b = midpoint(f.y, f.z);
+            const int c = midpoint(f.z, f.x);
+            refined.push_back({f.x, a, c});
+            refined.push_back({f.y, b, a});
+            refined.push_back({f.z, c, b});
+            refined.push_back({a, b, c});
+        }
+        faces = std::move(refined);
+    }
+    return {vertices, faces};
+}
+
+// objects deformed and moved with respect to the reference shape used to build the tree
+static std::vector<real4> makeObjects(const Vertices& reference, int nObjects)
+{
+    std::vector<real4> vertices;
+    for (int obj = 0; obj < nObjects; ++obj)
+    {
+        const real3 shift {3.0_r * obj, 0.5_r * obj, -1.0_r * obj};
+        const real3 stretch {1.0_r + 0.3_r * obj, 1.0_r, 1.0_r - 0.2_r * obj};
+        for (auto r : reference)
+        {
+            r = stretch * r;
+            r.z += 0.3_r * r.x * r.x; // bend
+            r += shift;
+            vertices.push_back({r.x, r.y, r.z, 0.0_r});
+        }
+    }
+    return vertices;
+}
+
+static std::vector<real3> makePoints(const std::vector<real4>& vertices, int n, long seed)
+{
+    real3 lo {+1e9_r, +1e9_r, +1e9_r}, hi {-1e9_r, -1e9_r, -1e9_r};
+    for (auto v : vertices)
+    {
+        lo = math::min(lo, make_real3(v));
+        hi = math::max(hi, make_real3(v));
+    }
+
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<real> u(0.0_r, 1.0_r);
+    std::vector<real3> points(n);
+    for (auto& p : points)
+        p = lo + (hi - lo) * real3{u(gen), u(gen), u(gen)};
+    return points;
+}
+
+static std::vector<int> bruteForce(const Faces& faces, int nObjects, int nv,
+                                   const std::vector<real4>& vertices, const std::vector<real3>& points)
+{
+    std::vector<int> inside(points.size(), -1);
+    for (size_t i = 0; i < points.size(); ++i)
+        for (int obj = 0; obj < nObjects && inside[i] < 0; ++obj)
+            if (mesh_bvh::isInsideBruteForce(static_cast<int>(faces.size()), faces.data(),
+                                             vertices.data() + obj * nv, points[i]))
+                inside[i] = obj;
+    return inside;
+}
+
+static void checkAgainstBruteForce(const Vertices& reference, const Faces& faces, int nObjects, int nPoints)
+{
+    const MeshBVH bvh(reference, faces, defaultStream);
+    const int nv = static_cast<int>(reference.size());
+    const auto vertices = makeObjects(reference, nObjects);
+    const auto points = makePoints(vertices, nPoints, 4242);
+
+    std::vector<int> inside(points.size());
+    mesh_bvh::tagInsideHost(bvh, nObjects, vertices.data(), nPoints, points.data(), inside.data());
+    const auto ref = bruteForce(faces, nObjects, nv, vertices, points);
+
+    int nInside = 0;
+    for (int i = 0; i < nPoints; ++i)
+    {
+        ASSERT_EQ(inside[i], ref[i]) << "point " << i;
+        nInside += inside[i] >= 0;
+    }
+    ASSERT_GT(nInside, 0);
+}
+
+TEST (MESH_BELONGING, sphere_volume)
+{
+    const auto sphere = makeIcosphere(4);
+    const auto& faces = std::get<1>(sphere);
+    const MeshBVH bvh(std::get<0>(sphere), faces, defaultStream);
+    std::vector<real4> vertices;
+    for (auto r : std::get<0>(sphere))
+        vertices.push_back({r.x, r.y, r.z, 0.0_r});
+
+    const int n = 20000;
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<real> u(-1.0_r, 1.0_r);
+    std::vector<real3> points(n);
+    for (auto& p : points)
+        p = {u(gen), u(gen), u(gen)};
+
+    std::vector<int> inside(n);
+    mesh_bvh::tagInsideHost(bvh, 1, vertices.data(), n, points.data(), inside.data());
+
+    int nInside = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        nInside += inside[i] == 0;
+        // far enough from the discretized surface
+        if (length(points[i]) < 0.99_r)
+        {
+            ASSERT_EQ(inside[i], 0);
+        }
+        if (length(points[i]) > 1.00_r)
+        {
+            ASSERT_EQ(inside[i], -1);
+        }
+    }
+
+    const real fraction = static_cast<real>(nInside) / n;
+    ASSERT_NEAR(fraction, M_PI / 6.0, 0.02);
+}
+
+TEST (MESH_BELONGING, rbc_same_as_brute_force)
+{
+    const Mesh mesh(rbc_off);
+    Vertices reference;
+    for (auto v : mesh.getVertices())
+        reference.push_back(make_real3(v));
+    const Faces faces(mesh.getFaces().begin(), mesh.getFaces().end());
+
+    checkAgainstBruteForce(reference, faces, 3, 5000);
+}
+
+TEST (MESH_BELONGING, icospheres_same_as_brute_force)
+{
+    for (int nsub = 1; nsub <= 4; ++nsub)
+    {
+        const auto sphere = makeIcosphere(nsub);
+        checkAgainstBruteForce(std::get<0>(sphere), std::get<1>(sphere), 2, 2000);
+    }
+}
+
+TEST (MESH_BELONGING, benchmark)
+{
+    auto time = [](auto&& f)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // 320 to 20k triangles
+    for (int nsub : {2, 3, 4, 5})
+    {
+        const auto sphere = makeIcosphere(nsub);
+        const auto& reference = std::get<0>(sphere);
+        const auto& faces = std::get<1>(sphere);
+        const int nv = static_cast<int>(reference.size());
+        const auto vertices = makeObjects(reference, 1);
+        const auto points = makePoints(vertices, 2000, 7);
+
+        std::vector<int> inside(points.size());
+        const double tBuild = time([&]() {MeshBVH bvh(reference, faces, defaultStream);});
+        const MeshBVH bvh(reference, faces, defaultStream);
+
+        const double tBVH = time([&]()
+        {
+            mesh_bvh::tagInsideHost(bvh, 1, vertices.data(), static_cast<int>(points.size()), points.data(), inside.data());
+        });
+        const double tBrute = time([&]() {bruteForce(faces, 1, nv, vertices, points);});
+
+        printf("%6zu triangles: build %8.3f ms, bvh (all threads) %8.3f ms, brute force (1 thread) %8.3f ms\n",
+               faces.size(), 1e3 * tBuild, 1e3 * tBVH, 1e3 * tBrute);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    logger.init(MPI_COMM_NULL, "mesh_belonging.log", 0);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,540 @@
+#include <mirheo/core/logger.h>
+#include <mirheo/plugins/utils/multiple_tau.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mpi.h>
+#include <random>
+#include <vector>
+
+using namespace mirheo;
+using namespace mirheo::multiple_tau;
+
+namespace
+{
+/// trajectories of several items: x[t][i]
+using Trajectories = std::vector<std::vector<real3>>;
+
+/// velocities following an Ornstein-Uhlenbeck process with the given correlation time (in samples), and unit variance
+Trajectories generateVelocities(int numItems, int numSamples, double correlationTime, long seed)
+{
+    std::mt19937 gen(seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+
+    const double a = std::exp(-1.0 / correlationTime);
+    const double b = std::sqrt(1.0 - a * a);
+
+    std::vector<double3> v(numItems);
+    for (auto& vi : v)
+        vi = {normal(gen), normal(gen), normal(gen)};
+
+    Trajectories x(numSamples, std::vector<real3>(numItems));
+    for (int t = 0; t < numSamples; ++t)
+    {
+        for (int i = 0; i < numItems; ++i)
+        {
+            x[t][i] = make_real3(static_cast<real>(v[i].x), static_cast<real>(v[i].y), static_cast<real>(v[i].z));
+            v[i] = a * v[i] + b * double3{normal(gen), normal(gen), normal(gen)};
+        }
+    }
+    return x;
+}
+
+/// positions obtained by integrating the given velocities
+Trajectories integrate(const Trajectories& v)
+{
+    Trajectories x(v.size(), std::vector<real3>(v[0].size()));
+    std::vector<double3> r(v[0].size(), double3{0.0, 0.0, 0.0});
+    for (size_t t = 0; t < v.size(); ++t)
+    {
+        for (size_t i = 0; i < r.size(); ++i)
+        {
+            x[t][i] = make_real3(static_cast<real>(r[i].x), static_cast<real>(r[i].y), static_cast<real>(r[i].z));
+            r[i] += make_double3(v[t][i]);
+        }
+    }
+    return x;
+}
+
+/** Brute force correlation at the given lag, averaged over all items and over the time origins
+    t0 = a * originStride, a = firstOrigin, firstOrigin + 1, ..., firstOrigin + numOrigins-1.
+ */
+template <class Kernel>
+double bruteForce(const Trajectories& x, long lag, long originStride, long numOrigins, long firstOrigin = 0)
+{
+    double sum = 0;
+    long count = 0;
+    for (long a = firstOrigin; a < firstOrigin + numOrigins; ++a)
+    {
+        const long t0 = a * originStride;
+        for (size_t i = 0; i < x[0].size(); ++i)
+        {
+            sum += Kernel::apply(x[t0][i], x[t0 + lag][i]);
+            ++count;
+        }
+    }
+    return sum / count;
+}
+
+/// brute force correlation at the given lag, using all time origins
+template <class Kernel>
+double bruteForce(const Trajectories& x, long lag)
+{
+    return bruteForce<Kernel>(x, lag, 1, static_cast<long>(x.size()) - lag);
+}
+
+template <class Kernel>
+HostCorrelator<Kernel, real3> correlate(const Trajectories& x, Layout layout, CoarseGraining coarseGraining)
+{
+    HostCorrelator<Kernel, real3> correlator(layout, coarseGraining, static_cast<int>(x[0].size()));
+    for (const auto& sample : x)
+        correlator.addSamples(sample.data());
+    return correlator;
+}
+
+/// \return averagingFactor^level
+long levelPeriod(const Layout& layout, int level)
+{
+    long period = 1;
+    for (int k = 0; k < level; ++k)
+        period *= layout.averagingFactor;
+    return period;
+}
+} // anonymous namespace
+
+TEST(MultipleTau, layout_lags_are_increasing_and_unique)
+{
+    const Layout layout(6, 16, 2);
+    ASSERT_EQ(layout.numLags(), 16 + 5 * 8);
+
+    for (int i = 1; i < layout.numLags(); ++i)
+        ASSERT_GT(layout.lag(i), layout.lag(i-1));
+
+    for (int k = 0; k < layout.numLevels; ++k)
+    {
+        const int jStart = k == 0 ? 0 : layout.blockLength / layout.averagingFactor;
+        for (int j = jStart; j < layout.blockLength; ++j)
+            ASSERT_EQ(layout.lag(layout.lagIndex(k, j)), j * levelPeriod(layout, k));
+    }
+}
+
+TEST(MultipleTau, first_level_matches_brute_force)
+{
+    const int numItems = 20;
+    const int numSamples = 1000;
+    const auto v = generateVelocities(numItems, numSamples, 10.0, 1234);
+    const auto r = integrate(v);
+    const Layout layout(5, 16, 2);
+
+    for (auto coarseGraining : {CoarseGraining::Average, CoarseGraining::Subsample})
+    {
+        const auto vacf = correlate<Product>          (v, layout, coarseGraining).getCorrelation();
+        const auto msd  = correlate<SquaredDifference>(r, layout, coarseGraining).getCorrelation();
+
+        for (int j = 0; j < layout.blockLength; ++j)
+        {
+            const double refVacf = bruteForce<Product>(v, j);
+            const double refMsd  = bruteForce<SquaredDifference>(r, j);
+            ASSERT_NEAR(vacf[j], refVacf, 1e-9 * std::abs(bruteForce<Product>(v, 0)));
+            ASSERT_NEAR(msd [j], refMsd,  1e-9 * std::max(refMsd, 1.0));
+        }
+    }
+}
+
+TEST(MultipleTau, subsampled_levels_match_brute_force_on_the_same_origins)
+{
+    const int numItems = 10;
+    const int numSamples = 3000; // not a power of 2: some levels have incomplete blocks
+    const auto v = generateVelocities(numItems, numSamples, 50.0, 42);
+    const auto r = integrate(v);
+    const Layout layout(7, 8, 2);
+
+    const auto correlator = correlate<SquaredDifference>(r, layout, CoarseGraining::Subsample);
+    const auto msd = correlator.getCorrelation();
+    const auto& counts = correlator.getCounts();
+
+    for (int k = 0; k < layout.numLevels; ++k)
+    {
+        const long period = levelPeriod(layout, k);
+        const long numValues = numSamples / period; // complete values of level k
+        const int jStart = k == 0 ? 0 : layout.blockLength / layout.averagingFactor;
+
+        for (int j = jStart; j < layout.blockLength; ++j)
+        {
+            const int lagId = layout.lagIndex(k, j);
+            const long numOrigins = numValues - j;
+
+            if (numOrigins <= 0)
+            {
+                ASSERT_EQ(counts[lagId], 0);
+                continue;
+            }
+            ASSERT_EQ(counts[lagId], numOrigins * numItems);
+
+            const double ref = bruteForce<SquaredDifference>(r, j * period, period, numOrigins);
+            ASSERT_NEAR(msd[lagId], ref, 1e-9 * std::max(ref, 1.0)) << "level " << k << " j " << j;
+        }
+    }
+}
+
+TEST(MultipleTau, late_items_only_use_their_own_time_origins)
+{
+    const int numItems = 10;
+    const int numSamples = 3000;
+    const long firstSample = 333; // e.g. the items were created at that sample
+    const auto v = generateVelocities(numItems, numSamples, 50.0, 43);
+    const auto r = integrate(v);
+    const Layout layout(7, 8, 2);
+
+    std::vector<std::vector<real3>> registers(layout.numRegisters(), std::vector<real3>(numItems));
+    std::vector<std::vector<real3>> accumulators(layout.numAccumulators(), std::vector<real3>(numItems));
+    std::vector<real3*> registerPtrs, accumulatorPtrs;
+    for (auto& reg : registers)
+        registerPtrs.push_back(reg.data());
+    for (auto& acc : accumulators)
+        accumulatorPtrs.push_back(acc.data());
+
+    std::vector<double> sums(layout.numLags(), 0.0);
+    std::vector<long> counts(layout.numLags(), 0);
+
+    // the values before the first sample are garbage that must never be correlated
+    for (long t = 0; t < numSamples; ++t)
+        for (int i = 0; i < numItems; ++i)
+            addSample<SquaredDifference>(layout, CoarseGraining::Subsample, t, firstSample,
+                                         t < firstSample ? make_real3(1e30_r) : r[t][i], true, i,
+                                         registerPtrs.data(), accumulatorPtrs.data(),
+                                         [&](int lagId, double corr, int count)
+            {
+                sums[lagId] += corr;
+                counts[lagId] += count;
+            });
+
+    for (int k = 0; k < layout.numLevels; ++k)
+    {
+        const long period = levelPeriod(layout, k);
+        const long numValues = numSamples / period;
+        const long firstOrigin = (firstSample + period - 1) / period;
+        const int jStart = k == 0 ? 0 : layout.blockLength / layout.averagingFactor;
+
+        for (int j = jStart; j < layout.blockLength; ++j)
+        {
+            const int lagId = layout.lagIndex(k, j);
+            const long numOrigins = numValues - j - firstOrigin;
+
+            if (numOrigins <= 0)
+            {
+                ASSERT_EQ(counts[lagId], 0);
+                continue;
+            }
+            ASSERT_EQ(counts[lagId], numOrigins * numItems);
+
+            const double ref = bruteForce<SquaredDifference>(r, j * period, period, numOrigins, firstOrigin);
+            ASSERT_NEAR(sums[lagId] / counts[lagId], ref, 1e-9 * std::max(ref, 1.0)) << "level " << k << " j " << j;
+        }
+    }
+}
+
+namespace
+{
+/// items of one rank, with their stored values laid out as in the persistent channels of a particle vector
+struct LocalItems
+{
+    LocalItems(int numValues) :
+        values(numValues)
+    {}
+
+    int size() const {return static_cast<int>(ids.size());}
+
+    std::vector<real3*> valuePtrs()
+    {
+        std::vector<real3*> ptrs;
+        for (auto& v : values)
+            ptrs.push_back(v.data());
+        return ptrs;
+    }
+
+    std::vector<int64_t> ids;
+    std::vector<std::vector<real3>> values;
+    std::vector<int64_t> firstSamples;
+    std::vector<int64_t> owners;
+};
+
+/// one item and its stored values, as packed for the redistribution
+struct PackedItem
+{
+    int64_t id, firstSample, owner;
+};
+
+std::vector<char> pack(const LocalItems& items, int i)
+{
+    const PackedItem header {items.ids[i], items.firstSamples[i], items.owners[i]};
+    std::vector<char> buffer(sizeof(header) + items.values.size() * sizeof(real3));
+    memcpy(buffer.data(), &header, sizeof(header));
+    for (size_t v = 0; v < items.values.size(); ++v)
+        memcpy(buffer.data() + sizeof(header) + v * sizeof(real3), &items.values[v][i], sizeof(real3));
+    return buffer;
+}
+
+void unpackAndAppend(const char *buffer, LocalItems& items)
+{
+    PackedItem header;
+    memcpy(&header, buffer, sizeof(header));
+    items.ids.push_back(header.id);
+    items.firstSamples.push_back(header.firstSample);
+    items.owners.push_back(header.owner);
+    for (size_t v = 0; v < items.values.size(); ++v)
+    {
+        real3 x;
+        memcpy(&x, buffer + sizeof(header) + v * sizeof(real3), sizeof(real3));
+        items.values[v].push_back(x);
+    }
+}
+
+/// keep the items for which \p keep is true, in the order given by \p order
+void reorder(LocalItems& items, const std::vector<int>& order, const std::vector<bool>& keep)
+{
+    LocalItems result(static_cast<int>(items.values.size()));
+    for (int i : order)
+    {
+        if (!keep[i])
+            continue;
+        result.ids.push_back(items.ids[i]);
+        result.firstSamples.push_back(items.firstSamples[i]);
+        result.owners.push_back(items.owners[i]);
+        for (size_t v = 0; v < items.values.size(); ++v)
+            result.values[v].push_back(items.values[v][i]);
+    }
+    items = std::move(result);
+}
+
+/// send the items whose new rank is not the current one, as the redistribution of a particle vector
+void redistribute(MPI_Comm comm, LocalItems& items, const std::vector<int>& itemRanks, std::mt19937& localGen)
+{
+    int rank, nranks;
+    MPI_Check( MPI_Comm_rank(comm, &rank) );
+    MPI_Check( MPI_Comm_size(comm, &nranks) );
+
+    const int itemBytes = static_cast<int>(sizeof(PackedItem) + items.values.size() * sizeof(real3));
+
+    std::vector<std::vector<char>> sendBuffers(nranks);
+    std::vector<bool> keep(items.size());
+
+    for (int i = 0; i < items.size(); ++i)
+    {
+        const int dst = itemRanks[items.ids[i]];
+        keep[i] = dst == rank;
+        if (!keep[i])
+        {
+            const auto buffer = pack(items, i);
+            sendBuffers[dst].insert(sendBuffers[dst].end(), buffer.begin(), buffer.end());
+        }
+    }
+
+    // the items that stay are reordered, e.g. by the cell-lists
+    std::vector<int> order(items.size());
+    for (int i = 0; i < items.size(); ++i)
+        order[i] = i;
+    std::shuffle(order.begin(), order.end(), localGen);
+    reorder(items, order, keep);
+
+    std::vector<int> sendCounts(nranks), recvCounts(nranks), sendDispls(nranks), recvDispls(nranks);
+    std::vector<char> sendBuffer;
+    for (int r = 0; r < nranks; ++r)
+    {
+        sendCounts[r] = static_cast<int>(sendBuffers[r].size());
+        sendDispls[r] = static_cast<int>(sendBuffer.size());
+        sendBuffer.insert(sendBuffer.end(), sendBuffers[r].begin(), sendBuffers[r].end());
+    }
+
+    MPI_Check( MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, comm) );
+
+    int recvSize = 0;
+    for (int r = 0; r < nranks; ++r)
+    {
+        recvDispls[r] = recvSize;
+        recvSize += recvCounts[r];
+    }
+    std::vector<char> recvBuffer(recvSize);
+
+    MPI_Check( MPI_Alltoallv(sendBuffer.data(), sendCounts.data(), sendDispls.data(), MPI_BYTE,
+                             recvBuffer.data(), recvCounts.data(), recvDispls.data(), MPI_BYTE, comm) );
+
+    for (int offset = 0; offset < recvSize; offset += itemBytes)
+        unpackAndAppend(recvBuffer.data() + offset, items);
+}
+} // anonymous namespace
+
+TEST(MultipleTau, items_migrating_between_ranks_keep_their_time_origins)
+{
+    const MPI_Comm comm = MPI_COMM_WORLD;
+    int rank, nranks;
+    MPI_Check( MPI_Comm_rank(comm, &rank) );
+    MPI_Check( MPI_Comm_size(comm, &nranks) );
+
+    const int numInitialItems = 30;
+    const int numCreatedItems = 10;
+    const int numItems = numInitialItems + numCreatedItems;
+    const long creationSample = 517; // the last items are created while the correlator runs
+    const int numSamples = 2000;
+    const double migrationProbability = 0.1;
+
+    const auto v = generateVelocities(numItems, numSamples, 50.0, 44);
+    const Layout layout(7, 8, 2);
+    const int numValues = layout.numRegisters() + layout.numAccumulators();
+
+    auto isCreated = [&](int64_t id, long t) {return id < numInitialItems || t >= creationSample;};
+
+    // reference: all items stay in place on a single rank
+    std::vector<double> refSums(layout.numLags(), 0.0);
+    std::vector<long> refCounts(layout.numLags(), 0);
+    {
+        LocalItems items(numValues);
+        for (int i = 0; i < numItems; ++i)
+        {
+            items.ids.push_back(i);
+            items.firstSamples.push_back(0);
+            items.owners.push_back(-1);
+        }
+        for (auto& values : items.values)
+            values.resize(numItems);
+        auto ptrs = items.valuePtrs();
+
+        for (long t = 0; t < numSamples; ++t)
+            for (int i = 0; i < numItems; ++i)
+                addItemSample<Product>(layout, CoarseGraining::Average, t, i, v[t][i], isCreated(i, t), i,
+                                       ptrs.data(), items.firstSamples.data(), items.owners.data(),
+                                       [&](int lagId, double corr, int count)
+                {
+                    refSums[lagId] += corr;
+                    refCounts[lagId] += count;
+                });
+    }
+
+    // the items hop between the ranks at random; all ranks draw the same sequence of ranks
+    std::mt19937 sharedGen(1234);
+    std::mt19937 localGen(42 + rank);
+    std::uniform_real_distribution<double> udistr(0.0, 1.0);
+    std::uniform_int_distribution<int> rankDistr(0, nranks - 1);
+
+    std::vector<int> itemRanks(numItems);
+    for (auto& r : itemRanks)
+        r = rankDistr(sharedGen);
+
+    LocalItems items(numValues);
+    std::vector<double> localSums(layout.numLags(), 0.0);
+    std::vector<long> localCounts(layout.numLags(), 0);
+
+    for (long t = 0; t < numSamples; ++t)
+    {
+        // new items start with garbage in their channels
+        for (int64_t id = 0; id < numItems; ++id)
+        {
+            const bool justCreated = t == 0 ? id < numInitialItems : (id >= numInitialItems && t == creationSample);
+            if (justCreated && itemRanks[id] == rank)
+            {
+                items.ids.push_back(id);
+                items.firstSamples.push_back(-12345);
+                items.owners.push_back(id + 1);
+                for (auto& values : items.values)
+                    values.push_back(make_real3(1e30_r));
+            }
+        }
+
+        auto ptrs = items.valuePtrs();
+        for (int i = 0; i < items.size(); ++i)
+            addItemSample<Product>(layout, CoarseGraining::Average, t, items.ids[i], v[t][items.ids[i]], true, i,
+                                   ptrs.data(), items.firstSamples.data(), items.owners.data(),
+                                   [&](int lagId, double corr, int count)
+            {
+                localSums[lagId] += corr;
+                localCounts[lagId] += count;
+            });
+
+        for (int64_t id = 0; id < numItems; ++id)
+            if (udistr(sharedGen) < migrationProbability)
+                itemRanks[id] = rankDistr(sharedGen);
+
+        redistribute(comm, items, itemRanks, localGen);
+    }
+
+    std::vector<double> sums(layout.numLags());
+    std::vector<long> counts(layout.numLags());
+    MPI_Check( MPI_Allreduce(localSums.data(), sums.data(), layout.numLags(), MPI_DOUBLE, MPI_SUM, comm) );
+    MPI_Check( MPI_Allreduce(localCounts.data(), counts.data(), layout.numLags(), MPI_LONG, MPI_SUM, comm) );
+
+    // every item has all its time origins
+    ASSERT_EQ(counts[1], numInitialItems * (numSamples - 1L) + numCreatedItems * (numSamples - creationSample - 1L));
+
+    for (int lagId = 0; lagId < layout.numLags(); ++lagId)
+    {
+        ASSERT_EQ(counts[lagId], refCounts[lagId]) << "lag " << layout.lag(lagId);
+        ASSERT_NEAR(sums[lagId], refSums[lagId], 1e-9 * std::abs(refSums[0])) << "lag " << layout.lag(lagId);
+    }
+}
+
+TEST(MultipleTau, averaged_levels_approximate_brute_force)
+{
+    const int numItems = 50;
+    const int numSamples = 1 << 14;
+    const double correlationTime = 20.0;
+    const auto v = generateVelocities(numItems, numSamples, correlationTime, 7);
+    const Layout layout(10, 16, 2);
+
+    const auto correlator = correlate<Product>(v, layout, CoarseGraining::Average);
+    const auto vacf = correlator.getCorrelation();
+    const double c0 = bruteForce<Product>(v, 0);
+
+    double maxErr = 0;
+    for (int lagId = 0; lagId < layout.numLags(); ++lagId)
+    {
+        const long lag = layout.lag(lagId);
+        if (lag >= numSamples / 4)
+            break;
+
+        const double ref = bruteForce<Product>(v, lag);
+        maxErr = std::max(maxErr, std::abs(vacf[lagId] - ref) / c0);
+    }
+    printf("largest difference with the brute force VACF, relative to VACF(0): %g\n", maxErr);
+    ASSERT_LT(maxErr, 0.02);
+}
+
+TEST(MultipleTau, benchmark)
+{
+    const int numItems = 10000;
+    const int numSamples = 1 << 10;
+    const auto v = generateVelocities(numItems, 1, 1.0, 3)[0];
+    const Layout layout(10, 16, 2);
+
+    HostCorrelator<Product, real3> correlator(layout, CoarseGraining::Average, numItems);
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (int t = 0; t < numSamples; ++t)
+        correlator.addSamples(v.data());
+    const auto end = std::chrono::high_resolution_clock::now();
+    const double time = std::chrono::duration<double>(end - start).count();
+
+    const long longestLag = layout.lag(layout.numLags() - 1);
+    const size_t bytesPerItem = (layout.numRegisters() + layout.numAccumulators()) * sizeof(real3);
+    const size_t bytesPerItemFull = longestLag * sizeof(real3);
+
+    printf("%d levels of %d values: %d lags up to %ld samples, %zu bytes per item (%zu to store all lags)\n",
+           layout.numLevels, layout.blockLength, layout.numLags(), longestLag, bytesPerItem, bytesPerItemFull);
+    printf("%d items, %d samples: %.3g item-samples/s on the host\n",
+           numItems, numSamples, static_cast<double>(numItems) * numSamples / time);
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+    logger.init(MPI_COMM_WORLD, "multiple_tau.log", 0);
+
+    testing::InitGoogleTest(&argc, argv);
+    auto ret = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return ret;
+}
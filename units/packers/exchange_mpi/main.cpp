@@ -0,0 +1,258 @@
+#include "../common.h"
+#include "../../timer.h"
+
+#include <mirheo/core/celllist.h>
+#include <mirheo/core/containers.h>
+#include <mirheo/core/domain.h>
+#include <mirheo/core/exchangers/api.h>
+#include <mirheo/core/logger.h>
+#include <mirheo/core/pvs/particle_vector.h>
+#include <mirheo/core/utils/cuda_common.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <gtest/gtest.h>
+#include <vector>
+
+// This test must be run with 8 ranks (2x2x2 domain decomposition)
+
+constexpr int cartMaxdims = 3;
+const int cartDims[] = {2, 2, 2};
+
+static MPI_Comm createCart(MPI_Comm comm, const int dims[cartMaxdims])
+{
+    const int periods[] = {1, 1, 1};
+    constexpr int reorder = 0;
+
+    MPI_Comm cart;
+    MPI_Check( MPI_Cart_create(comm, cartMaxdims, dims, periods, reorder, &cart) );
+    return cart;
+}
+
+using EngineFactory = std::function<std::unique_ptr<ExchangeEngine>(std::unique_ptr<Exchanger>&&, MPI_Comm)>;
+
+static std::unique_ptr<ExchangeEngine> makeSizesThenData(std::unique_ptr<Exchanger>&& exch, MPI_Comm comm)
+{
+    return std::make_unique<MPIExchangeEngine>(std::move(exch), comm, false);
+}
+
+static EngineFactory makePersistent(size_t initialCapacity)
+{
+    return [initialCapacity](std::unique_ptr<Exchanger>&& exch, MPI_Comm comm)
+    {
+        return std::make_unique<MPIExchangeEngine>(std::move(exch), comm, false,
+                                                   MPIExchangeEngine::Protocol::Persistent,
+                                                   initialCapacity);
+    };
+}
+
+static std::unique_ptr<ExchangeEngine> makeNeighborCollective(std::unique_ptr<Exchanger>&& exch, MPI_Comm comm)
+{
+    return std::make_unique<NeighborCollectiveExchangeEngine>(std::move(exch), comm, false);
+}
+
+struct Comp // for sorting particles
+{
+    bool inline operator()(real4 a_, real4 b_) const
+    {
+        Real3_int a(a_), b(b_);
+        return
+            (a.i < b.i) ||
+            (a.i == b.i && a.v.x  < b.v.x) ||
+            (a.i == b.i && a.v.x == b.v.x && a.v.y  < b.v.y) ||
+            (a.i == b.i && a.v.x == b.v.x && a.v.y == b.v.y && a.v.z < b.v.z);
+    }
+};
+
+/// Halo exchange of a uniform particle vector over a given cartesian communicator
+struct HaloSetup
+{
+    HaloSetup(MPI_Comm cart, real3 localSize, real density, real rc) :
+        domain(createDomainInfo(cart, localSize * getDims(cart))),
+        state(domain, 0.0_r)
+    {
+        pv = initializeRandomPV(cart, &state, density);
+        cl = std::make_unique<PrimaryCellList>(pv.get(), rc, domain.localSize);
+        cl->build(defaultStream);
+    }
+
+    std::unique_ptr<ExchangeEngine> createEngine(MPI_Comm cart, const EngineFactory& factory)
+    {
+        auto exch = std::make_unique<ParticleHaloExchanger>();
+        exch->attach(pv.get(), cl.get(), {});
+        return factory(std::move(exch), cart);
+    }
+
+    std::vector<real4> getSortedHalo()
+    {
+        auto& hpos = pv->halo()->positions();
+        hpos.downloadFromDevice(defaultStream);
+        std::vector<real4> sorted(hpos.begin(), hpos.end());
+        std::sort(sorted.begin(), sorted.end(), Comp());
+        return sorted;
+    }
+
+    static real3 getDims(MPI_Comm cart)
+    {
+        int dims[3], periods[3], coords[3];
+        MPI_Check( MPI_Cart_get(cart, 3, dims, periods, coords) );
+        return {(real) dims[0], (real) dims[1], (real) dims[2]};
+    }
+
+    DomainInfo domain;
+    MirState state;
+    std::unique_ptr<ParticleVector> pv;
+    std::unique_ptr<PrimaryCellList> cl;
+};
+
+static void checkSameHalo(MPI_Comm cart, const EngineFactory& factory)
+{
+    const real rc = 1.0_r;
+    const real3 localSize {8.0_r, 8.0_r, 8.0_r};
+    const real density = 8.0_r;
+    const int nsteps = 3;
+
+    HaloSetup setup(cart, localSize, density, rc);
+
+    auto refEngine = setup.createEngine(cart, makeSizesThenData);
+    auto engine    = setup.createEngine(cart, factory);
+
+    // several steps to go through the overflow and the regrown links
+    for (int step = 0; step < nsteps; ++step)
+    {
+        refEngine->init(defaultStream);
+        refEngine->finalize(defaultStream);
+        const auto ref = setup.getSortedHalo();
+
+        engine->init(defaultStream);
+        engine->finalize(defaultStream);
+        const auto halo = setup.getSortedHalo();
+
+        ASSERT_EQ(ref.size(), halo.size()) << "step " << step;
+        ASSERT_GT(halo.size(), 0);
+
+        for (size_t i = 0; i < ref.size(); ++i)
+            ASSERT_TRUE(areEquals(ref[i], halo[i])) << "step " << step << ", particle " << i;
+    }
+}
+
+TEST (PACKERS_EXCHANGE_MPI, persistent_same_as_sizes_then_data)
+{
+    MPI_Comm cart = createCart(MPI_COMM_WORLD, cartDims);
+    checkSameHalo(cart, makePersistent(MPIExchangeEngine::defaultInitialCapacity));
+    MPI_Check( MPI_Comm_free(&cart) );
+}
+
+TEST (PACKERS_EXCHANGE_MPI, persistent_overflow)
+{
+    MPI_Comm cart = createCart(MPI_COMM_WORLD, cartDims);
+    // tiny capacity: the first step goes through the overflow path on every link
+    checkSameHalo(cart, makePersistent(64));
+    MPI_Check( MPI_Comm_free(&cart) );
+}
+
+TEST (PACKERS_EXCHANGE_MPI, neighbor_collective_same_as_sizes_then_data)
+{
+    MPI_Comm cart = createCart(MPI_COMM_WORLD, cartDims);
+    checkSameHalo(cart, makeNeighborCollective);
+    MPI_Check( MPI_Comm_free(&cart) );
+}
+
+TEST (PACKERS_EXCHANGE_MPI, neighbor_collective_multiple_edges)
+{
+    // 8 ranks along x: the two neighbours along y and z are the rank itself
+    const int dims[] = {8, 1, 1};
+    MPI_Comm cart = createCart(MPI_COMM_WORLD, dims);
+    checkSameHalo(cart, makeNeighborCollective);
+    MPI_Check( MPI_Comm_free(&cart) );
+}
+
+TEST (PACKERS_EXCHANGE_MPI, grown_capacity)
+{
+    ASSERT_GE(MPIExchangeEngine::computeGrownCapacity(64, 1000), 1000);
+    ASSERT_GE(MPIExchangeEngine::computeGrownCapacity(1024, 1000), 2048);
+    ASSERT_EQ(MPIExchangeEngine::computeGrownCapacity(1024, 1000) % 64, 0);
+}
+
+// returns the mean time per step in ms, max over all ranks
+static double measureLatency(MPI_Comm cart, const EngineFactory& factory, real3 localSize)
+{
+    const real rc = 1.0_r;
+    const real density = 8.0_r;
+    const int nwarmup = 10;
+    const int nsteps = 200;
+
+    HaloSetup setup(cart, localSize, density, rc);
+    auto engine = setup.createEngine(cart, factory);
+
+    auto step = [&]()
+    {
+        engine->init(defaultStream);
+        engine->finalize(defaultStream);
+        CUDA_Check( cudaStreamSynchronize(defaultStream) );
+    };
+
+    for (int i = 0; i < nwarmup; ++i)
+        step();
+
+    MPI_Check( MPI_Barrier(cart) );
+
+    Timer timer;
+    timer.start();
+    for (int i = 0; i < nsteps; ++i)
+        step();
+    timer.stop();
+
+    double ms = static_cast<double>(timer.elapsed()) * 1e-6 / nsteps;
+    MPI_Check( MPI_Allreduce(MPI_IN_PLACE, &ms, 1, MPI_DOUBLE, MPI_MAX, cart) );
+    return ms;
+}
+
+TEST (PACKERS_EXCHANGE_MPI, latency_benchmark)
+{
+    int rank;
+    MPI_Check( MPI_Comm_rank(MPI_COMM_WORLD, &rank) );
+
+    MPI_Comm cart = createCart(MPI_COMM_WORLD, cartDims);
+
+    const int oneRankDims[] = {1, 1, 1};
+    MPI_Comm selfCart = createCart(MPI_COMM_SELF, oneRankDims);
+
+    auto singleNode = [](std::unique_ptr<Exchanger>&& exch, MPI_Comm)
+    {
+        return std::unique_ptr<ExchangeEngine>(std::make_unique<SingleNodeExchangeEngine>(std::move(exch)));
+    };
+
+    // small subdomains: the exchange is latency bound
+    for (real L : {4.0_r, 8.0_r, 16.0_r})
+    {
+        const real3 localSize {L, L, L};
+
+        const double tSizesThenData = measureLatency(cart, makeSizesThenData, localSize);
+        const double tPersistent    = measureLatency(cart, makePersistent(MPIExchangeEngine::defaultInitialCapacity), localSize);
+        const double tNeighbor      = measureLatency(cart, makeNeighborCollective, localSize);
+        const double tSingleNode    = measureLatency(selfCart, singleNode, localSize);
+
+        if (rank == 0)
+            printf("subdomain %gx%gx%g: per step halo exchange: sizes then data %.4f ms, "
+                   "persistent %.4f ms, neighbourhood collective %.4f ms, single node engine (1 rank) %.4f ms\n",
+                   L, L, L, tSizesThenData, tPersistent, tNeighbor, tSingleNode);
+    }
+
+    MPI_Check( MPI_Comm_free(&selfCart) );
+    MPI_Check( MPI_Comm_free(&cart) );
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+
+    logger.init(MPI_COMM_WORLD, "packers_exchange_mpi.log", 3);
+
+    testing::InitGoogleTest(&argc, argv);
+    auto retval = RUN_ALL_TESTS();
+
+    MPI_Finalize();
+    return retval;
+}
@@ -0,0 +1,438 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+#include <mirheo/core/logger.h>
+#include <mirheo/core/task_scheduler.h>
+
+#include "../timer.h"
+
+#define private public
+
+using namespace mirheo;
+
+void verifyDep(const std::string& before, const std::string& after,
+               const std::vector<std::string>& messages)
+{
+    auto itb = std::find(messages.begin(), messages.end(), before);
+    auto ita = std::find(messages.begin(), messages.end(), after);
+
+    ASSERT_NE(itb, messages.end());
+    ASSERT_NE(ita, messages.end());
+    ASSERT_LT(itb, ita);
+}
+
+static bool hasGPU()
+{
+    int n {0};
+    if (cudaGetDeviceCount(&n) != cudaSuccess)
+        n = 0;
+    // clear the error state in case there is no device
+    cudaGetLastError();
+    return n > 0;
+}
+
+/// the schedulers to test: the thread pool ones do not need a GPU
+static std::vector<std::unique_ptr<TaskScheduler>> createSchedulers()
+{
+    std::vector<std::unique_ptr<TaskScheduler>> schedulers;
+
+    if (hasGPU())
+        schedulers.push_back(std::make_unique<TaskScheduler>());
+    else
+        fprintf(stderr, "No GPU found: skipping the tests with CudaStreamBackend\n");
+
+    schedulers.push_back(std::make_unique<TaskScheduler>(std::make_unique<ThreadPoolBackend>(1)));
+    schedulers.push_back(std::make_unique<TaskScheduler>(std::make_unique<ThreadPoolBackend>(4)));
+    return schedulers;
+}
+
+static void testOrder(TaskScheduler& scheduler)
+{
+    /*
+      A1,A2 - B -----------
+                  \        \
+                    D1,D2 - E
+              C - /
+                  \ F
+                            G
+    */
+
+    std::vector<std::string> messages;
+    std::mutex mutex;
+    auto push = [&](const char *msg)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        messages.push_back(msg);
+    };
+
+    auto A1 = scheduler.createTask("A1");
+    auto A2 = scheduler.createTask("A2");
+    auto B  = scheduler.createTask("B");
+    auto C  = scheduler.createTask("C");
+    auto D1 = scheduler.createTask("D1");
+    auto D2 = scheduler.createTask("D2");
+    auto E  = scheduler.createTask("E");
+    auto F  = scheduler.createTask("F");
+    auto G  = scheduler.createTask("G");
+
+    scheduler.addTask(A1, [&](__UNUSED cudaStream_t s){ push("a1"); });
+    scheduler.addTask(A2, [&](__UNUSED cudaStream_t s){ push("a2"); });
+    scheduler.addTask(B , [&](__UNUSED cudaStream_t s){ push("b" ); });
+    scheduler.addTask(C , [&](__UNUSED cudaStream_t s){ push("c" ); });
+    scheduler.addTask(D1, [&](__UNUSED cudaStream_t s){ push("d1"); });
+    scheduler.addTask(D2, [&](__UNUSED cudaStream_t s){ push("d2"); });
+    scheduler.addTask(E , [&](__UNUSED cudaStream_t s){ push("e" ); });
+    scheduler.addTask(F , [&](__UNUSED cudaStream_t s){ push("f" ); });
+    scheduler.addTask(G , [&](__UNUSED cudaStream_t s){ push("g" ); });
+
+    scheduler.addDependency(B, {}, {A1, A2});
+    scheduler.addDependency(D1, {}, {B, C});
+    scheduler.addDependency(D2, {}, {B, C});
+    scheduler.addDependency(F, {}, {C});
+    scheduler.addDependency(E, {}, {D1, D2, B});
+
+    scheduler.compile();
+    scheduler.run();
+
+    ASSERT_EQ(messages.size(), 9);
+
+    verifyDep("a1", "b", messages);
+    verifyDep("a2", "b", messages);
+
+    verifyDep("b", "d1", messages);
+    verifyDep("c", "d1", messages);
+
+    verifyDep("b", "d2", messages);
+    verifyDep("c", "d2", messages);
+
+    verifyDep("c", "f", messages);
+
+    verifyDep("d1", "e", messages);
+    verifyDep("d2", "e", messages);
+    verifyDep("b" , "e", messages);
+}
+
+TEST(Scheduler, Order)
+{
+    for (auto& scheduler : createSchedulers())
+        testOrder(*scheduler);
+}
+
+TEST(Scheduler, Benchmark)
+{
+    if (!hasGPU())
+        return;
+
+    TaskScheduler scheduler;
+
+    float a, b, c, d, e, f, g;
+    a = b = c = d = e = f = g = 0;
+
+    auto A1 = scheduler.createTask("A1");
+    auto A2 = scheduler.createTask("A2");
+    auto B  = scheduler.createTask("B");
+    auto C  = scheduler.createTask("C");
+    auto D1 = scheduler.createTask("D1");
+    auto D2 = scheduler.createTask("D2");
+    auto E  = scheduler.createTask("E");
+    auto F  = scheduler.createTask("F");
+    auto G  = scheduler.createTask("G");
+
+    scheduler.addTask(C,  [&](__UNUSED cudaStream_t s){ c++; });
+    scheduler.addTask(G,  [&](__UNUSED cudaStream_t s){ g--; });
+    scheduler.addTask(D1, [&](__UNUSED cudaStream_t s){ d+=2; });
+    scheduler.addTask(A1, [&](__UNUSED cudaStream_t s){ a-=3; });
+    scheduler.addTask(E,  [&](__UNUSED cudaStream_t s){ e*=1.001; });
+    scheduler.addTask(A2, [&](__UNUSED cudaStream_t s){ a*=0.9999; });
+    scheduler.addTask(B,  [&](__UNUSED cudaStream_t s){ b+=5; });
+    scheduler.addTask(D2, [&](__UNUSED cudaStream_t s){ d-=42; });
+    scheduler.addTask(F,  [&](__UNUSED cudaStream_t s){ f*=2; });
+
+    scheduler.addDependency(B, {}, {A1, A2});
+    scheduler.addDependency(D1, {}, {B, C});
+    scheduler.addDependency(D2, {}, {B, C});
+    scheduler.addDependency(F, {}, {C});
+    scheduler.addDependency(E, {}, {D1, D2, B});
+
+    scheduler.compile();
+
+    Timer timer;
+    timer.start();
+
+    int n = 10000;
+    for (int i=0; i<n; i++)
+        scheduler.run();
+
+    int64_t tm = timer.elapsed();
+
+    double tus = (double)tm / (1000.0*n);
+    fprintf(stderr, "Per run: %f us\n", tus);
+
+    EXPECT_LE(tus, 500.0);
+}
+
+TEST(Scheduler, Profiling)
+{
+    // without GPU, use the host-only stand-in for the streams
+    const bool useStreams = hasGPU();
+    auto scheduler = useStreams ?
+        std::make_unique<TaskScheduler>() :
+        std::make_unique<TaskScheduler>(std::make_unique<ThreadPoolBackend>(2));
+
+    auto A = scheduler->createTask("A");
+    auto B = scheduler->createTask("B");
+    auto C = scheduler->createTask("C");
+
+    scheduler->addTask(A, [&](__UNUSED cudaStream_t s){});
+    scheduler->addTask(B, [&](__UNUSED cudaStream_t s){}, 2);
+    scheduler->addTask(C, [&](__UNUSED cudaStream_t s){});
+
+    scheduler->addDependency(B, {}, {A});
+    scheduler->addDependency(C, {}, {B});
+
+    scheduler->compile();
+    scheduler->enableProfiling(useStreams);
+
+    const int n = 10;
+    for (int i = 0; i < n; ++i)
+        scheduler->run();
+
+    const auto& profiler = scheduler->getProfiler();
+
+    ASSERT_EQ(profiler.getStepStats().count, n);
+    ASSERT_EQ(profiler.getStats(A).wall.count, n);
+    ASSERT_EQ(profiler.getStats(B).wall.count, n/2); // executed every 2 runs
+    ASSERT_EQ(profiler.getStats(C).wall.count, n);
+    ASSERT_EQ(profiler.getStats(C).device.count, useStreams ? n : 0);
+    ASSERT_GE(profiler.getStats(C).wall.min, 0.0);
+
+    scheduler->dumpProfile("scheduler_profile");
+}
+
+TEST(Scheduler, ThreadPoolPriorities)
+{
+    // single worker: all ready high priority tasks must be executed before the low priority ones
+    TaskScheduler scheduler(std::make_unique<ThreadPoolBackend>(1));
+    std::vector<std::string> messages;
+
+    const std::vector<std::string> labels {"l1", "h1", "l2", "h2", "l3"};
+    for (const auto& label : labels)
+    {
+        auto id = scheduler.createTask(label);
+        scheduler.addTask(id, [&messages, label](__UNUSED cudaStream_t s){ messages.push_back(label); });
+        if (label[0] == 'h')
+            scheduler.setHighPriority(id);
+    }
+
+    scheduler.compile();
+    scheduler.run();
+
+    ASSERT_EQ(messages.size(), labels.size());
+    verifyDep("h1", "l1", messages);
+    verifyDep("h1", "l2", messages);
+    verifyDep("h1", "l3", messages);
+    verifyDep("h2", "l1", messages);
+    verifyDep("h2", "l2", messages);
+    verifyDep("h2", "l3", messages);
+}
+
+TEST(Scheduler, ThreadPoolConcurrency)
+{
+    // two independent tasks that wait for each other: deadlock unless executed concurrently
+    TaskScheduler scheduler(std::make_unique<ThreadPoolBackend>(2));
+    std::atomic<int> arrived {0};
+
+    auto waitForOther = [&arrived](__UNUSED cudaStream_t s)
+    {
+        ++arrived;
+        while (arrived.load() < 2)
+            std::this_thread::yield();
+    };
+
+    scheduler.addTask(scheduler.createTask("A"), waitForOther);
+    scheduler.addTask(scheduler.createTask("B"), waitForOther);
+    scheduler.compile();
+    scheduler.run();
+
+    ASSERT_EQ(arrived.load(), 2);
+}
+
+TEST(Scheduler, SeveralSchedulersConcurrently)
+{
+    // the same as ThreadPoolConcurrency, with the two tasks in different schedulers run together
+    TaskScheduler scheduler0(std::make_unique<ThreadPoolBackend>(1));
+    TaskScheduler scheduler1(std::make_unique<ThreadPoolBackend>(1));
+    std::atomic<int> arrived {0};
+    std::atomic<int> numAfter {0};
+
+    auto waitForOther = [&arrived](__UNUSED cudaStream_t s)
+    {
+        ++arrived;
+        while (arrived.load() < 2)
+            std::this_thread::yield();
+    };
+
+    for (auto scheduler : {&scheduler0, &scheduler1})
+    {
+        auto A = scheduler->createTask("A");
+        auto B = scheduler->createTask("B");
+        scheduler->addTask(A, waitForOther);
+        scheduler->addTask(B, [&](__UNUSED cudaStream_t s){ ASSERT_EQ(arrived.load(), 2); ++numAfter; });
+        scheduler->addDependency(B, {}, {A});
+        scheduler->compile();
+    }
+
+    TaskScheduler::run({&scheduler0, &scheduler1});
+
+    ASSERT_EQ(arrived.load(), 2);
+    ASSERT_EQ(numAfter.load(), 2);
+}
+
+TEST(Scheduler, ThreadPoolException)
+{
+    TaskScheduler scheduler(std::make_unique<ThreadPoolBackend>(2));
+    bool afterExecuted = false;
+
+    auto A = scheduler.createTask("A");
+    auto B = scheduler.createTask("B");
+    scheduler.addTask(A, [](__UNUSED cudaStream_t s){ throw std::runtime_error("failure in A"); });
+    scheduler.addTask(B, [&](__UNUSED cudaStream_t s){ afterExecuted = true; });
+    scheduler.addDependency(B, {}, {A});
+    scheduler.compile();
+
+    ASSERT_THROW(scheduler.run(), std::runtime_error);
+    ASSERT_FALSE(afterExecuted);
+}
+
+static void spin(std::chrono::microseconds duration)
+{
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end);
+}
+
+/// Number of executions of each task of a synthetic graph, and number of tasks that started before one of their dependencies
+struct SyntheticGraphCounters
+{
+    SyntheticGraphCounters(int ntasks) : executions(ntasks) {}
+
+    std::vector<std::atomic<int>> executions;
+    std::atomic<int> violations {0};
+};
+
+/// Layered random DAG: every task of a layer depends on a few tasks of the previous layer.
+static void createSyntheticGraph(TaskScheduler& scheduler, int nlayers, int width, std::chrono::microseconds work,
+                                 SyntheticGraphCounters& counters)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, width-1);
+    std::vector<TaskScheduler::TaskID> previous;
+    std::vector<int> previousIndices;
+
+    for (int l = 0; l < nlayers; ++l)
+    {
+        std::vector<TaskScheduler::TaskID> current;
+        std::vector<int> currentIndices;
+        for (int i = 0; i < width; ++i)
+        {
+            const int index = l * width + i;
+
+            std::vector<TaskScheduler::TaskID> after;
+            std::vector<int> afterIndices;
+            if (!previous.empty())
+            {
+                for (int d = 0; d < 2; ++d)
+                {
+                    const int j = dist(gen);
+                    after.push_back(previous[j]);
+                    afterIndices.push_back(previousIndices[j]);
+                }
+            }
+
+            auto id = scheduler.createTask("task_" + std::to_string(l) + "_" + std::to_string(i));
+            scheduler.addTask(id, [work, index, afterIndices, &counters](__UNUSED cudaStream_t s)
+            {
+                // the dependencies must have been executed once more than this task
+                const int run = counters.executions[index].load();
+                for (auto dep : afterIndices)
+                    if (counters.executions[dep].load() != run + 1)
+                        ++counters.violations;
+
+                spin(work);
+                ++counters.executions[index];
+            });
+
+            scheduler.addDependency(id, {}, after);
+            current.push_back(id);
+            currentIndices.push_back(index);
+        }
+        previous = current;
+        previousIndices = currentIndices;
+    }
+    scheduler.compile();
+}
+
+static double timeRuns(TaskScheduler& scheduler, int nruns)
+{
+    Timer timer;
+    timer.start();
+    for (int i = 0; i < nruns; ++i)
+        scheduler.run();
+    return (double)timer.elapsed() / (1000.0 * nruns);
+}
+
+TEST(Scheduler, ThreadPoolBenchmark)
+{
+    const int nlayers = 8;
+    const int width = 8;
+    const int nruns = 20;
+    const std::chrono::microseconds work(100);
+    const int nthreads = std::max(1, std::min(8, (int) std::thread::hardware_concurrency()));
+
+    TaskScheduler serial(std::make_unique<ThreadPoolBackend>(1));
+    TaskScheduler parallel(std::make_unique<ThreadPoolBackend>(nthreads));
+
+    SyntheticGraphCounters serialCounters(nlayers * width), parallelCounters(nlayers * width);
+    createSyntheticGraph(serial,   nlayers, width, work, serialCounters);
+    createSyntheticGraph(parallel, nlayers, width, work, parallelCounters);
+
+    const double tSerial   = timeRuns(serial,   nruns);
+    const double tParallel = timeRuns(parallel, nruns);
+
+    // the timings depend on the machine load: only report them
+    fprintf(stderr, "Synthetic DAG of %d x %d tasks of %d us: per run %f us with 1 thread, %f us with %d threads (speedup %.2f)\n",
+            nlayers, width, (int) work.count(), tSerial, tParallel, nthreads, tSerial / tParallel);
+
+    for (const auto *counters : {&serialCounters, &parallelCounters})
+    {
+        ASSERT_EQ(counters->violations.load(), 0);
+        for (const auto& n : counters->executions)
+            ASSERT_EQ(n.load(), nruns);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    if (provided < MPI_THREAD_MULTIPLE) {
+        fprintf(stderr, "ERROR: The MPI library does not have full thread support\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    MPI_Errhandler_set(MPI_COMM_WORLD, MPI_ERRORS_RETURN);
+    logger.init(MPI_COMM_WORLD, "scheduler.log", 9);
+
+    testing::InitGoogleTest(&argc, argv);
+
+    auto ret = RUN_ALL_TESTS();
+
+    MPI_Finalize();
+    return ret;
+}
@@ -0,0 +1,153 @@
+#include <mirheo/core/logger.h>
+#include <mirheo/core/task_profiler.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+using namespace mirheo;
+
+using Sample = TaskProfiler::Sample;
+using Metric = TaskProfiler::Metric;
+
+TEST (TaskProfiler, Stats)
+{
+    TaskProfiler profiler;
+    profiler.registerTask(0, "A");
+
+    profiler.addSample(0, Sample{1.0, 2.0, -1.0});
+    profiler.addSample(0, Sample{3.0, 6.0, -1.0});
+    profiler.addSample(0, Sample{2.0, 4.0, -1.0});
+
+    const auto& stats = profiler.getStats(0);
+    ASSERT_EQ(stats.label, "A");
+    ASSERT_EQ(stats.wall.count, 3);
+    ASSERT_DOUBLE_EQ(stats.launch.min,    1.0);
+    ASSERT_DOUBLE_EQ(stats.launch.mean(), 2.0);
+    ASSERT_DOUBLE_EQ(stats.launch.max,    3.0);
+    ASSERT_DOUBLE_EQ(stats.wall.min,      2.0);
+    ASSERT_DOUBLE_EQ(stats.wall.mean(),   4.0);
+    ASSERT_DOUBLE_EQ(stats.wall.max,      6.0);
+
+    // negative device timings mean "not available"
+    ASSERT_EQ(stats.device.count, 0);
+    ASSERT_FALSE(profiler.hasDeviceTimings());
+    ASSERT_EQ(profiler.getDefaultMetric(), Metric::Wall);
+
+    profiler.clear();
+    ASSERT_EQ(profiler.getStats(0).wall.count, 0);
+    ASSERT_EQ(profiler.getStats(0).label, "A");
+}
+
+/*
+  Same graph as in the scheduler test:
+
+  A1,A2 - B -----------
+              \        \
+                D1,D2 - E
+          C - /
+              \ F
+                        G
+*/
+struct TestGraph
+{
+    enum {A1, A2, B, C, D1, D2, E, F, G, N};
+    std::vector<TaskProfiler::TaskID> nodes {A1, A2, B, C, D1, D2, E, F, G};
+    std::vector<std::pair<TaskProfiler::TaskID, TaskProfiler::TaskID>> edges {
+        {A1, B}, {A2, B},
+        {B, D1}, {C, D1},
+        {B, D2}, {C, D2},
+        {C, F},
+        {D1, E}, {D2, E}, {B, E}
+    };
+
+    void fill(TaskProfiler& profiler, const std::vector<double>& durations) const
+    {
+        const char *labels[] = {"A1", "A2", "B", "C", "D1", "D2", "E", "F", "G"};
+        for (auto id : nodes)
+            profiler.registerTask(id, labels[id]);
+
+        // host-only stand-in for the streams: a fake execution with known durations
+        for (int step = 0; step < 10; ++step)
+            for (auto id : nodes)
+                profiler.addSample(id, Sample{0.0, durations[id], -1.0});
+    }
+};
+
+TEST (TaskProfiler, CriticalPath)
+{
+    TestGraph g;
+    TaskProfiler profiler;
+    //                       A1   A2   B    C    D1   D2   E    F    G
+    g.fill(profiler, {1.0, 3.0, 1.0, 2.0, 1.0, 5.0, 1.0, 9.0, 1.0});
+
+    auto path = profiler.computeCriticalPath(g.nodes, g.edges, Metric::Wall);
+
+    // C -> F = 2 + 9 is longer than A2 -> B -> D2 -> E = 3 + 1 + 5 + 1
+    ASSERT_DOUBLE_EQ(path.length, 11.0);
+    ASSERT_EQ(path.ids, (std::vector<TaskProfiler::TaskID>{TestGraph::C, TestGraph::F}));
+
+    TaskProfiler profiler2;
+    g.fill(profiler2, {1.0, 3.0, 1.0, 2.0, 1.0, 5.0, 1.0, 1.0, 1.0});
+    path = profiler2.computeCriticalPath(g.nodes, g.edges, Metric::Wall);
+
+    ASSERT_DOUBLE_EQ(path.length, 10.0);
+    ASSERT_EQ(path.ids, (std::vector<TaskProfiler::TaskID>{TestGraph::A2, TestGraph::B, TestGraph::D2, TestGraph::E}));
+}
+
+TEST (TaskProfiler, CriticalPathUsesDeviceTimings)
+{
+    TaskProfiler profiler;
+    profiler.registerTask(0, "host heavy");
+    profiler.registerTask(1, "device heavy");
+
+    profiler.addSample(0, Sample{0.1, 10.0, 1.0});
+    profiler.addSample(1, Sample{0.1,  1.0, 8.0});
+
+    ASSERT_TRUE(profiler.hasDeviceTimings());
+    ASSERT_EQ(profiler.getDefaultMetric(), Metric::Device);
+
+    const auto path = profiler.computeCriticalPath({0, 1}, {}, profiler.getDefaultMetric());
+    ASSERT_EQ(path.ids, (std::vector<TaskProfiler::TaskID>{1}));
+    ASSERT_DOUBLE_EQ(path.length, 8.0);
+}
+
+static std::string readFile(const std::string& fname)
+{
+    std::ifstream f(fname);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    return ss.str();
+}
+
+TEST (TaskProfiler, Reports)
+{
+    TestGraph g;
+    TaskProfiler profiler;
+    g.fill(profiler, {1.0, 3.0, 1.0, 2.0, 1.0, 5.0, 1.0, 1.0, 1.0});
+    profiler.addStep(12.0);
+
+    profiler.dumpCSV("profile.csv");
+    profiler.dumpJSON("profile.json", g.nodes, g.edges);
+
+    const std::string csv = readFile("profile.csv");
+    const std::string json = readFile("profile.json");
+
+    // header + one line per task
+    ASSERT_EQ(std::count(csv.begin(), csv.end(), '\n'), 1 + TestGraph::N);
+    ASSERT_NE(csv.find("\"D2\",10,0,0,0,5,5,5,0,,,"), std::string::npos);
+
+    ASSERT_NE(json.find("\"critical_path\": {\"metric\": \"wall\", \"length_ms\": 10, \"tasks\": [\"A2\", \"B\", \"D2\", \"E\"]}"),
+              std::string::npos);
+    ASSERT_NE(json.find("\"steps\": {\"count\": 1"), std::string::npos);
+}
+
+int main(int argc, char **argv)
+{
+    logger.init(MPI_COMM_NULL, "task_profiler.log", 0);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,106 @@
+#include <mirheo/core/initial_conditions/helpers.h>
+#include <mirheo/core/logger.h>
+#include <mirheo/core/mirheo_state.h>
+#include <mirheo/core/pvs/particle_vector.h>
+#include <mirheo/core/utils/cuda_common.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <tuple>
+#include <vector>
+
+using namespace mirheo;
+
+using Positions = std::vector<std::tuple<real, real, real>>;
+
+static Positions generate(const DomainInfo& domain, real density, int numThreads,
+                          PositionFilter filter = [](real3) {return true;})
+{
+    MirState state(domain, 0.0_r);
+    ParticleVector pv(&state, "pv", 1.0_r);
+
+    setUniformParticles(density, MPI_COMM_WORLD, &pv, filter, defaultStream, true, numThreads);
+
+    Positions positions;
+    const auto& pos = pv.local()->positions();
+    for (int i = 0; i < pv.local()->size(); ++i)
+    {
+        const real3 r = domain.local2global(make_real3(pos[i]));
+        positions.emplace_back(r.x, r.y, r.z);
+    }
+    return positions;
+}
+
+static const real3 globalSize {32.0_r, 24.0_r, 16.5_r};
+static const real density = 8.5_r;
+
+TEST (UNIFORM_IC, independent_of_number_of_threads)
+{
+    const DomainInfo domain {globalSize, {0.0_r, 0.0_r, 0.0_r}, globalSize};
+    const auto ref = generate(domain, density, 1);
+
+    ASSERT_GT(ref.size(), 0u);
+
+    for (int numThreads : {2, 3, 7})
+        ASSERT_EQ(ref, generate(domain, density, numThreads)) << numThreads << " threads";
+}
+
+TEST (UNIFORM_IC, filter)
+{
+    const DomainInfo domain {globalSize, {0.0_r, 0.0_r, 0.0_r}, globalSize};
+    const real3 center = 0.5_r * globalSize;
+    const real radius = 6.0_r;
+
+    auto inSphere = [center, radius](real3 r)
+    {
+        return length(r - center) < radius;
+    };
+
+    const auto all = generate(domain, density, 1);
+    const auto filtered = generate(domain, density, 4, inSphere);
+
+    Positions ref;
+    for (const auto& r : all)
+        if (inSphere({std::get<0>(r), std::get<1>(r), std::get<2>(r)}))
+            ref.push_back(r);
+
+    ASSERT_EQ(ref, filtered);
+
+    const real volume = 4.0_r / 3.0_r * static_cast<real>(M_PI) * radius * radius * radius;
+    ASSERT_NEAR(static_cast<real>(filtered.size()) / volume, density, 0.05_r * density);
+}
+
+TEST (UNIFORM_IC, startup_benchmark)
+{
+    const real3 size {128.0_r, 128.0_r, 64.0_r};
+    const DomainInfo domain {size, {0.0_r, 0.0_r, 0.0_r}, size};
+    MirState state(domain, 0.0_r);
+
+    for (int numThreads : {1, 0})
+    {
+        ParticleVector pv(&state, "pv", 1.0_r);
+
+        const double start = MPI_Wtime();
+        setUniformParticles(density, MPI_COMM_WORLD, &pv, [](real3) {return true;}, defaultStream, true, numThreads);
+        const double seconds = MPI_Wtime() - start;
+
+        printf("%s: %d particles in %.3f s, %.2f M particles per second\n",
+               numThreads == 1 ? "serial  " : "threaded", pv.local()->size(), seconds,
+               1e-6 * pv.local()->size() / seconds);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+
+    logger.init(MPI_COMM_WORLD, "uniform_ic.log", 3);
+
+    testing::InitGoogleTest(&argc, argv);
+    auto retval = RUN_ALL_TESTS();
+
+    MPI_Finalize();
+    return retval;
+}
@@ -0,0 +1,335 @@
+#include <mirheo/core/logger.h>
+#include <mirheo/core/utils/cuda_common.h>
+#include <mirheo/core/xdmf/hdf5_helpers.h>
+#include <mirheo/core/xdmf/type_map.h>
+#include <mirheo/core/xdmf/xdmf.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace mirheo;
+
+// Writes particle-like and uniform grid data with different storage settings,
+// reports the file size and the write bandwidth, and checks the data read back.
+
+struct Setting
+{
+    std::string name;
+    std::string compression;
+};
+
+static const std::vector<Setting> settings = {
+    {"none",                        ""},
+    {"shuffle+deflate1",            "shuffle,deflate=1"},
+    {"shuffle+deflate6",            "shuffle,deflate=6"},
+    {"mantissa12+shuffle+deflate4", "mantissa=12,shuffle,deflate=4"},
+};
+
+static int getRank(MPI_Comm comm)
+{
+    int rank;
+    MPI_Check( MPI_Comm_rank(comm, &rank) );
+    return rank;
+}
+
+static long fileSize(const std::string& fname)
+{
+    std::ifstream f(fname, std::ios::binary | std::ios::ate);
+    return static_cast<long>(f.tellg());
+}
+
+static void report(MPI_Comm comm, const std::string& what, const Setting& setting,
+                   long rawBytes, long fileBytes, double seconds)
+{
+    long globalRawBytes {0};
+    MPI_Check( MPI_Reduce(&rawBytes, &globalRawBytes, 1, MPI_LONG, MPI_SUM, 0, comm) );
+
+    if (getRank(comm) == 0)
+        printf("%-10s %-28s: %10ld bytes in file (ratio %5.2f), %8.2f ms, %8.1f MB/s\n",
+               what.c_str(), setting.name.c_str(), fileBytes,
+               static_cast<double>(globalRawBytes) / static_cast<double>(fileBytes),
+               1e3 * seconds, 1e-6 * static_cast<double>(globalRawBytes) / seconds);
+}
+
+// deterministic pseudo random number in [0, 1) from an integer
+static real hashToReal(int64_t i, int64_t seed)
+{
+    uint64_t x = static_cast<uint64_t>(i) * 6364136223846793005ULL + static_cast<uint64_t>(seed) * 1442695040888963407ULL;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    return static_cast<real>(static_cast<double>(x >> 11) / static_cast<double>(1ULL << 53));
+}
+
+static real3 makePosition(int64_t id, real L) {return {L * hashToReal(id, 1), L * hashToReal(id, 2), L * hashToReal(id, 3)};}
+static real3 makeVelocity(int64_t id)
+{
+    return {hashToReal(id, 4) - 0.5_r, hashToReal(id, 5) - 0.5_r, hashToReal(id, 6) - 0.5_r};
+}
+
+static bool closeEnough(real ref, real val, int mantissaBits)
+{
+    if (mantissaBits < 0)
+        return ref == val;
+    return std::abs(ref - val) <= std::abs(ref) * std::ldexp(1.0_r, -mantissaBits);
+}
+
+static bool closeEnough(real3 ref, real3 val, int mantissaBits)
+{
+    return closeEnough(ref.x, val.x, mantissaBits)
+        && closeEnough(ref.y, val.y, mantissaBits)
+        && closeEnough(ref.z, val.z, mantissaBits);
+}
+
+TEST (XDMF_COMPRESSION, parse)
+{
+    const auto none = XDMF::stringToCompression("none");
+    ASSERT_TRUE(none.isNone());
+    ASSERT_TRUE(XDMF::stringToCompression("").isNone());
+
+    const auto c = XDMF::stringToCompression("mantissa=10,shuffle,deflate=4");
+    ASSERT_FALSE(c.isNone());
+    ASSERT_EQ(c.deflateLevel, 4);
+    ASSERT_EQ(c.mantissaBits, 10);
+    ASSERT_TRUE(c.shuffle);
+}
+
+TEST (XDMF_COMPRESSION, round_mantissa)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const float big = std::numeric_limits<float>::max();
+
+    std::vector<float> ref {0.0f, -0.0f, 1.0f, -1.0f, 3.14159265f, 1e-30f, -2.71828e20f, 1e-40f, big, inf, -inf, nan};
+    for (int i = 0; i < 1000; ++i)
+        ref.push_back(static_cast<float>(hashToReal(i, 7) - 0.5_r) * 1000.0f);
+
+    for (int bits : {0, 1, 7, 12, 22, 23})
+    {
+        auto data = ref;
+        XDMF::HDF5::roundMantissa(XDMF::Channel::NumberType::Float, data.data(), data.size(), bits);
+
+        for (size_t i = 0; i < ref.size(); ++i)
+        {
+            if (std::isnan(ref[i]))
+            {
+                ASSERT_TRUE(std::isnan(data[i]));
+                continue;
+            }
+            ASSERT_FALSE(std::isinf(data[i]) && !std::isinf(ref[i])) << "value " << ref[i] << " rounded to inf";
+            ASSERT_LE(std::abs(data[i] - ref[i]), std::abs(ref[i]) * std::ldexp(1.0f, -bits - 1))
+                << "value " << ref[i] << " with " << bits << " bits";
+
+            uint32_t u;
+            memcpy(&u, &data[i], sizeof(u));
+            if (!std::isinf(data[i]))
+            {
+                ASSERT_EQ(u & ((1u << (23 - bits)) - 1), 0u) << "dropped bits are not zero";
+            }
+        }
+    }
+
+    std::vector<double> d {1.0 / 3.0, -1e300, 0.1};
+    const auto dref = d;
+    XDMF::HDF5::roundMantissa(XDMF::Channel::NumberType::Double, d.data(), d.size(), 20);
+    for (size_t i = 0; i < d.size(); ++i)
+        ASSERT_LE(std::abs(d[i] - dref[i]), std::abs(dref[i]) * std::ldexp(1.0, -21));
+}
+
+TEST (XDMF_COMPRESSION, particles)
+{
+    const MPI_Comm comm = MPI_COMM_WORLD;
+    const int rank = getRank(comm);
+    const real L = 64.0_r;
+    const long nLocal = 200000 + 1000 * rank;
+
+    long offset {0};
+    MPI_Check( MPI_Exscan(&nLocal, &offset, 1, MPI_LONG, MPI_SUM, comm) );
+    if (rank == 0) offset = 0;
+
+    auto positions = std::make_shared<std::vector<real3>>(nLocal);
+    std::vector<real3> velocities(nLocal);
+    std::vector<int64_t> ids(nLocal);
+
+    for (long i = 0; i < nLocal; ++i)
+    {
+        ids[i] = offset + i;
+        (*positions)[i] = makePosition(ids[i], L);
+        velocities[i] = makeVelocity(ids[i]);
+    }
+
+    const long rawBytes = nLocal * static_cast<long>(2 * sizeof(real3) + sizeof(int64_t));
+
+    for (const auto& setting : settings)
+    {
+        const auto compression = XDMF::stringToCompression(setting.compression);
+        const std::string fname = "particles_" + setting.name;
+
+        std::vector<XDMF::Channel> channels {
+            {"velocity", velocities.data(), XDMF::Channel::Vector{}, XDMF::getNumberType<real>(),
+             DataTypeWrapper<real>(), XDMF::Channel::NeedShift::False, compression},
+            // the ids are always stored losslessly
+            {"id", ids.data(), XDMF::Channel::Scalar{}, XDMF::Channel::NumberType::Int64,
+             DataTypeWrapper<int64_t>(), XDMF::Channel::NeedShift::False,
+             {compression.deflateLevel, compression.shuffle, -1}}
+        };
+
+        XDMF::VertexGrid grid(positions, comm);
+        // positions are stored losslessly: the trimming error would depend on the domain size
+        grid.setPositionsCompression({compression.deflateLevel, compression.shuffle, -1});
+
+        MPI_Check( MPI_Barrier(comm) );
+        const double start = MPI_Wtime();
+        XDMF::write(fname, &grid, channels, comm);
+        MPI_Check( MPI_Barrier(comm) );
+        const double seconds = MPI_Wtime() - start;
+
+        report(comm, "particles", setting, rawBytes, fileSize(fname + ".h5"), seconds);
+
+        const auto read = XDMF::readVertexData(fname + ".xmf", comm, 1);
+        ASSERT_EQ(read.descriptions.size(), 2u);
+        ASSERT_EQ(read.descriptions[0].name, "velocity");
+        ASSERT_EQ(read.descriptions[1].name, "id");
+
+        const auto *readVel = reinterpret_cast<const real3*>(read.data[0].data());
+        const auto *readIds = reinterpret_cast<const int64_t*>(read.data[1].data());
+
+        for (size_t i = 0; i < read.positions.size(); ++i)
+        {
+            const int64_t id = readIds[i];
+            ASSERT_TRUE(closeEnough(makePosition(id, L), read.positions[i], -1)) << "wrong position of particle " << id;
+            ASSERT_TRUE(closeEnough(makeVelocity(id), readVel[i], compression.mantissaBits))
+                << "wrong velocity of particle " << id << " with setting " << setting.name;
+        }
+    }
+}
+
+TEST (XDMF_COMPRESSION, uniform_grid)
+{
+    int nranks;
+    MPI_Check( MPI_Comm_size(MPI_COMM_WORLD, &nranks) );
+    int dims[3] = {0, 0, 0};
+    const int periods[] = {0, 0, 0};
+    MPI_Check( MPI_Dims_create(nranks, 3, dims) );
+    MPI_Comm cart;
+    MPI_Check( MPI_Cart_create(MPI_COMM_WORLD, 3, dims, periods, 0, &cart) );
+
+    int coords[3];
+    MPI_Check( MPI_Cart_coords(cart, getRank(cart), 3, coords) );
+
+    const int3 localSize {64, 64, 64};
+    const real3 h {0.5_r, 0.5_r, 0.5_r};
+    const int3 globalSize {localSize.x * dims[0], localSize.y * dims[1], localSize.z * dims[2]};
+    const long n = localSize.x * localSize.y * localSize.z;
+
+    // smooth fields, as produced by time averages
+    auto density = [&](int ix, int iy, int iz)
+    {
+        return 8.0_r + std::sin(0.1_r * ix) * std::cos(0.07_r * iy) + 0.01_r * iz;
+    };
+    auto velocity = [&](int ix, int iy, int iz) -> real3
+    {
+        return {std::sin(0.05_r * iz), 0.1_r * std::cos(0.03_r * ix), 1e-3_r * iy};
+    };
+
+    std::vector<real> densities(n);
+    std::vector<real3> velocities(n);
+
+    for (int iz = 0; iz < localSize.z; ++iz)
+        for (int iy = 0; iy < localSize.y; ++iy)
+            for (int ix = 0; ix < localSize.x; ++ix)
+            {
+                const long i = ix + localSize.x * (iy + localSize.y * iz);
+                const int gx = ix + coords[0] * localSize.x;
+                const int gy = iy + coords[1] * localSize.y;
+                const int gz = iz + coords[2] * localSize.z;
+                densities [i] = density (gx, gy, gz);
+                velocities[i] = velocity(gx, gy, gz);
+            }
+
+    const long rawBytes = n * static_cast<long>(sizeof(real) + sizeof(real3));
+    long uncompressedFileSize {0};
+
+    for (const auto& setting : settings)
+    {
+        const auto compression = XDMF::stringToCompression(setting.compression);
+        const std::string fname = "grid_" + setting.name;
+
+        std::vector<XDMF::Channel> channels {
+            {"number_densities", densities.data(), XDMF::Channel::Scalar{}, XDMF::getNumberType<real>(),
+             DataTypeWrapper<real>(), XDMF::Channel::NeedShift::False, compression},
+            {"velocities", velocities.data(), XDMF::Channel::Vector{}, XDMF::getNumberType<real>(),
+             DataTypeWrapper<real>(), XDMF::Channel::NeedShift::False, compression}
+        };
+
+        XDMF::UniformGrid grid(localSize, h, cart);
+
+        MPI_Check( MPI_Barrier(cart) );
+        const double start = MPI_Wtime();
+        XDMF::write(fname, &grid, channels, cart);
+        MPI_Check( MPI_Barrier(cart) );
+        const double seconds = MPI_Wtime() - start;
+
+        const long size = fileSize(fname + ".h5");
+        report(cart, "grid", setting, rawBytes, size, seconds);
+
+        if (compression.isNone())
+            uncompressedFileSize = size;
+        else
+            ASSERT_LT(size, uncompressedFileSize) << "setting " << setting.name << " does not reduce the file size";
+
+        // read the whole grid back on one rank with the serial interface
+        if (getRank(cart) == 0)
+        {
+            hid_t file_id = H5Fopen((fname + ".h5").c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+            ASSERT_GE(file_id, 0);
+
+            const long ntot = static_cast<long>(globalSize.x) * globalSize.y * globalSize.z;
+            std::vector<real> readDensities(ntot);
+            std::vector<real3> readVelocities(ntot);
+
+            const auto type = XDMF::numberTypeToHDF5type(XDMF::getNumberType<real>());
+            hid_t dset_id = H5Dopen(file_id, "number_densities", H5P_DEFAULT);
+            H5Dread(dset_id, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, readDensities.data());
+            H5Dclose(dset_id);
+            dset_id = H5Dopen(file_id, "velocities", H5P_DEFAULT);
+            H5Dread(dset_id, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, readVelocities.data());
+            H5Dclose(dset_id);
+            H5Fclose(file_id);
+
+            for (int iz = 0; iz < globalSize.z; ++iz)
+                for (int iy = 0; iy < globalSize.y; ++iy)
+                    for (int ix = 0; ix < globalSize.x; ++ix)
+                    {
+                        const long i = ix + globalSize.x * (iy + globalSize.y * static_cast<long>(iz));
+                        ASSERT_TRUE(closeEnough(density(ix, iy, iz), readDensities[i], compression.mantissaBits))
+                            << "wrong density at " << ix << " " << iy << " " << iz;
+                        ASSERT_TRUE(closeEnough(velocity(ix, iy, iz), readVelocities[i], compression.mantissaBits))
+                            << "wrong velocity at " << ix << " " << iy << " " << iz;
+                    }
+        }
+    }
+
+    MPI_Check( MPI_Comm_free(&cart) );
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+
+    logger.init(MPI_COMM_WORLD, "xdmf_compression.log", 3);
+
+    testing::InitGoogleTest(&argc, argv);
+    auto retval = RUN_ALL_TESTS();
+
+    MPI_Finalize();
+    return retval;
+}